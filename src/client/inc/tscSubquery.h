@@ -54,6 +54,10 @@ void doCleanupSubqueries(SSqlObj *pSql, int32_t numOfSubs);
 
 void tscFreeRetrieveSup(void **param);
 
+char* tscGetQueryProfile(char* pRsp, int32_t rspLen, int32_t* profLen);
+
+void tscMergeQueryProfile(SSqlObj* pRootSql, char* pProfile, int32_t profLen);
+
 
 
 #ifdef __cplusplus
@@ -185,6 +185,8 @@ int32_t tscSetTableFullName(SName* pName, SStrToken* pzTableName, SSqlObj* pSql,
 void    tscClearInterpInfo(SQueryInfo* pQueryInfo);
 
 bool tscIsInsertData(char* sqlstr);
+bool tscIsExplainSql(char* sqlstr);
+bool tscIsExplainQuery(SSqlObj* pSql);
 
 // the memory is not reset in case of fast allocate payload function
 int32_t tscAllocPayloadFast(SSqlCmd *pCmd, size_t size);
@@ -292,6 +292,7 @@ typedef struct {
   SQueryInfo  *active;         // current active query info
   int32_t      batchSize;      // for parameter ('?') binding and batch processing
   int32_t      resColumnId;
+  bool         explain;        // collect the execution profile at vnodes, for explain analyze
 } SSqlCmd;
 
 typedef struct {
@@ -299,6 +300,7 @@ typedef struct {
   int64_t        numOfTotal;                 // num of total results
   int64_t        numOfClauseTotal;           // num of total result in current subclause
   char *         pRsp;
+  bool           rspCont; // pRsp is the content of the received rpc message, released by rpcFreeCont
   int32_t        rspType;
   int32_t        rspLen;
   uint64_t       qId;     // query id of SQInfo
@@ -358,6 +360,11 @@ typedef struct SSubqueryState {
   uint64_t numOfRetrievedRows;  // total number of points in this query
 } SSubqueryState;
 
+typedef struct SExplainOperator {
+  int32_t               numOfVnodes;  // number of vnodes that report the same operator
+  SQueryProfileOperator prof;         // counters summed up across vnodes, in host byte order
+} SExplainOperator;
+
 typedef struct SSqlObj {
   void            *signature;
   int64_t          owner;        // owner of sql object, by which it is executed
@@ -391,6 +398,7 @@ typedef struct SSqlObj {
 
   int64_t          squeryLock;
   int32_t          retryReason;  // previous error code
+  SArray          *pExplain;     // SArray<SExplainOperator>, profile of the query merged from all vnodes
   struct SSqlObj  *prev, *next;
   int64_t          self;
 } SSqlObj;
@@ -460,6 +468,12 @@ void destroyTableNameList(SInsertStatementParam* pInsertParam);
 
 void tscResetSqlCmd(SSqlCmd *pCmd, bool removeMeta, uint64_t id);
 
+/**
+ * free the response buffer of the sql object
+ * @param pRes
+ */
+void tscFreeRspBuf(SSqlRes *pRes);
+
 /**
  * free query result of the sql object
  * @param pObj
@@ -505,6 +519,7 @@ int32_t tscInvalidOperationMsg(char *msg, const char *additionalInfo, const char
 int32_t tscSQLSyntaxErrMsg(char* msg, const char* additionalInfo,  const char* sql);
 
 int32_t tscValidateSqlInfo(SSqlObj *pSql, struct SSqlInfo *pInfo);
+int32_t tscValidateExplainSql(SSqlObj *pSql);
 
 int32_t tsSetBlockInfo(SSubmitBlk *pBlocks, const STableMeta *pTableMeta, int32_t numOfRows);
 extern int32_t    sentinel;
@@ -377,22 +377,21 @@ static int32_t createOrderDescriptor(tOrderDescriptor **pOrderDesc, SQueryInfo*
       }
     } else {
       /*
-       * 1. the orderby ts asc/desc projection query for the super table
+       * 1. the orderby ts/column asc/desc projection query for the super table
        * 2. interval query without groupby clause
        */
       if (pQueryInfo->interval.interval != 0) {
         orderColIndexList[0] = PRIMARYKEY_TIMESTAMP_COL_INDEX;
+        assert(pQueryInfo->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
       } else {
         size_t size = tscNumOfExprs(pQueryInfo);
         for (int32_t i = 0; i < size; ++i) {
           SExprInfo *pExpr = tscExprGet(pQueryInfo, i);
-          if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == pQueryInfo->order.orderColId) {
             orderColIndexList[0] = i;
           }
         }
       }
-
-      assert(pQueryInfo->order.orderColId == PRIMARYKEY_TIMESTAMP_COL_INDEX);
     }
   }
 
@@ -742,6 +742,180 @@ static int32_t tscProcessShowCreateDatabase(SSqlObj *pSql) {
   doAsyncQuery(pSql->pTscObj, pInterSql, tscSCreateCallBack, param, query, strlen(query));
   return TSDB_CODE_TSC_ACTION_IN_PROGRESS;
 }
+// support 'explain analyze select ...'
+typedef struct SExplainBuilder {
+  SSqlObj *pParentSql;
+  SSqlObj *pInterSql;
+  Stage    callStage;
+} SExplainBuilder;
+
+#define EXPLAIN_OPERATOR_COL_LEN (TSDB_OPERATOR_NAME_LEN * 2)
+
+static const char* explainCounterNames[] = {
+    "calls", "rows_in", "rows_out", "elapsed_us", "self_us", "data_blocks", "last_blocks", "cache_blocks",
+    "decomp_bytes", "sma_hits", "queue_wait_us",
+};
+
+static int32_t tscExplainBuildResultFields(SSqlObj *pSql) {
+  SColumnIndex index = {0};
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfo(&pSql->cmd);
+  pQueryInfo->order.order = TSDB_ORDER_ASC;
+  pSql->cmd.numOfCols = 2 + tListLen(explainCounterNames);
+
+  TAOS_FIELD f = tscCreateField(TSDB_DATA_TYPE_BINARY, "operator", EXPLAIN_OPERATOR_COL_LEN + VARSTR_HEADER_SIZE);
+  SInternalField* pInfo = tscFieldInfoAppend(&pQueryInfo->fieldsInfo, &f);
+  pInfo->pExpr = tscExprAppend(pQueryInfo, TSDB_FUNC_TS_DUMMY, &index, TSDB_DATA_TYPE_BINARY, f.bytes, -1000,
+                               EXPLAIN_OPERATOR_COL_LEN, false);
+  int32_t rowLen = f.bytes;
+
+  f = tscCreateField(TSDB_DATA_TYPE_INT, "vnodes", sizeof(int32_t));
+  pInfo = tscFieldInfoAppend(&pQueryInfo->fieldsInfo, &f);
+  pInfo->pExpr = tscExprAppend(pQueryInfo, TSDB_FUNC_TS_DUMMY, &index, TSDB_DATA_TYPE_INT, sizeof(int32_t), -1000,
+                               sizeof(int32_t), false);
+  rowLen += sizeof(int32_t);
+
+  for (int32_t i = 0; i < tListLen(explainCounterNames); ++i) {
+    f = tscCreateField(TSDB_DATA_TYPE_BIGINT, explainCounterNames[i], sizeof(int64_t));
+    pInfo = tscFieldInfoAppend(&pQueryInfo->fieldsInfo, &f);
+    pInfo->pExpr = tscExprAppend(pQueryInfo, TSDB_FUNC_TS_DUMMY, &index, TSDB_DATA_TYPE_BIGINT, sizeof(int64_t), -1000,
+                                 sizeof(int64_t), false);
+    rowLen += sizeof(int64_t);
+  }
+
+  tscFieldInfoUpdateOffset(pQueryInfo);
+  return rowLen;
+}
+
+// the time spent in the operator itself, excluding the time of its direct upstream operators
+static int64_t tscExplainGetSelfTime(SArray* pExplain, int32_t index) {
+  SExplainOperator* pOp = taosArrayGet(pExplain, index);
+  int64_t selfTime = pOp->prof.elapsedTime;
+
+  for (int32_t i = index + 1; i < taosArrayGetSize(pExplain); ++i) {
+    SExplainOperator* p = taosArrayGet(pExplain, i);
+    if (p->prof.level <= pOp->prof.level) {
+      break;
+    }
+
+    if (p->prof.level == pOp->prof.level + 1) {
+      selfTime -= p->prof.elapsedTime;
+    }
+  }
+
+  return MAX(selfTime, 0);
+}
+
+static int32_t tscExplainSetValueToResObj(SSqlObj *pSql, int32_t rowLen) {
+  SSqlRes *pRes = &pSql->res;
+  SArray  *pExplain = pSql->pExplain;
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfo(&pSql->cmd);
+  int32_t numOfRows = (int32_t)taosArrayGetSize(pExplain);
+
+  pRes->pMerger = tscInitResObjForLocalQuery(numOfRows, rowLen, pSql->self);
+  if (pRes->pMerger == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  tscInitResForMerge(pRes);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    SExplainOperator* pOp = taosArrayGet(pExplain, i);
+
+    char name[EXPLAIN_OPERATOR_COL_LEN + 1] = {0};
+    if (pOp->prof.level == 0) {
+      tstrncpy(name, pOp->prof.name, sizeof(name));
+    } else {
+      snprintf(name, sizeof(name), "%*s-> %s", (pOp->prof.level - 1) * 2, "", pOp->prof.name);
+    }
+
+    TAOS_FIELD *pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, 0);
+    char* dst = pRes->data + tscFieldInfoGetOffset(pQueryInfo, 0) * numOfRows + pField->bytes * i;
+    STR_WITH_MAXSIZE_TO_VARSTR(dst, name, pField->bytes);
+
+    pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, 1);
+    *(int32_t*)(pRes->data + tscFieldInfoGetOffset(pQueryInfo, 1) * numOfRows + pField->bytes * i) = pOp->numOfVnodes;
+
+    int64_t counters[] = {
+        pOp->prof.numOfCalls, pOp->prof.rowsIn,      pOp->prof.rowsOut,     pOp->prof.elapsedTime,
+        tscExplainGetSelfTime(pExplain, i),           pOp->prof.dataBlocks,  pOp->prof.lastBlocks,
+        pOp->prof.cacheBlocks, pOp->prof.decompSize,  pOp->prof.smaHits,     pOp->prof.queueWaitTime,
+    };
+
+    for (int32_t j = 0; j < tListLen(counters); ++j) {
+      pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, j + 2);
+      *(int64_t*)(pRes->data + tscFieldInfoGetOffset(pQueryInfo, j + 2) * numOfRows + pField->bytes * i) = counters[j];
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void tscExplainCallBack(void *param, TAOS_RES *tres, int code) {
+  if (param == NULL || tres == NULL) {
+    return;
+  }
+
+  SExplainBuilder *builder = (SExplainBuilder *)param;
+  SSqlObj *pParentSql = builder->pParentSql;
+  SSqlObj *pSql = (SSqlObj *)tres;
+
+  SSqlRes *pRes = &pParentSql->res;
+  pRes->code = (code < 0)? code:taos_errno(pSql);
+
+  if (pRes->code == TSDB_CODE_SUCCESS) {
+    if (builder->callStage == SCREATE_CALLBACK_QUERY || code > 0) {
+      // the results are discarded, only the profile of the query is returned
+      builder->callStage = SCREATE_CALLBACK_RETRIEVE;
+      taos_fetch_rows_a(tres, tscExplainCallBack, param);
+      return;
+    }
+
+    // all results are retrieved, the profile of all vnodes is merged into the inter sql object
+    pParentSql->pExplain = pSql->pExplain;
+    pSql->pExplain = NULL;
+
+    int32_t rowLen = tscExplainBuildResultFields(pParentSql);
+    pRes->code = tscExplainSetValueToResObj(pParentSql, rowLen);
+  } else {
+    // report the error message of the explained query
+    tstrncpy(tscGetErrorMsgPayload(&pParentSql->cmd), tscGetErrorMsgPayload(&pSql->cmd), pParentSql->cmd.allocSize);
+  }
+
+  taos_free_result(pSql);
+  free(builder);
+
+  if (pRes->code == TSDB_CODE_SUCCESS) {
+    (*pParentSql->fp)(pParentSql->param, pParentSql, 0);
+  } else {
+    tscAsyncResultOnError(pParentSql);
+  }
+}
+
+static int32_t tscProcessExplain(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  SSqlObj *pInterSql = (SSqlObj *)calloc(1, sizeof(SSqlObj));
+  if (pInterSql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  SExplainBuilder *param = (SExplainBuilder *)calloc(1, sizeof(SExplainBuilder));
+  if (param == NULL) {
+    free(pInterSql);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  param->pParentSql = pSql;
+  param->pInterSql  = pInterSql;
+  param->callStage  = SCREATE_CALLBACK_QUERY;
+
+  pInterSql->cmd.explain = true;
+  doAsyncQuery(pSql->pTscObj, pInterSql, tscExplainCallBack, param, pCmd->payload, pCmd->payloadLen);
+  return TSDB_CODE_TSC_ACTION_IN_PROGRESS;
+}
+
 static int32_t tscProcessCurrentUser(SSqlObj *pSql) {
   SQueryInfo* pQueryInfo = tscGetQueryInfo(&pSql->cmd);
 
@@ -932,6 +1106,8 @@ int tscProcessLocalCmd(SSqlObj *pSql) {
     pRes->code = tscProcessShowCreateTable(pSql); 
   } else if (pCmd->command == TSDB_SQL_SHOW_CREATE_DATABASE) {
     pRes->code = tscProcessShowCreateDatabase(pSql); 
+  } else if (pCmd->command == TSDB_SQL_EXPLAIN) {
+    pRes->code = tscProcessExplain(pSql);
   } else if (pCmd->command == TSDB_SQL_RESET_CACHE) {
     taosHashClear(UTIL_GET_TABLEMETA(pSql));
     taosCacheEmpty(UTIL_GET_VGROUPLIST(pSql));
@@ -1638,6 +1638,8 @@ int tsParseSql(SSqlObj *pSql, bool initial) {
     if (ret != TSDB_CODE_SUCCESS) {
       strncpy(pCmd->payload, pCmd->insertParam.msg, TSDB_DEFAULT_PAYLOAD_SIZE);
     }
+  } else if (tscIsExplainSql(pSql->sqlstr)) {
+    ret = tscValidateExplainSql(pSql);
   } else {
     SSqlInfo sqlInfo = qSqlParse(pSql->sqlstr);
     ret = tscValidateSqlInfo(pSql, &sqlInfo);
@@ -538,6 +538,52 @@ int32_t handleUserDefinedFunc(SSqlObj* pSql, struct SSqlInfo* pInfo) {
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * explain analyze select ...
+ * the select statement is kept in the payload, and executed with the execution profile collected at vnodes
+ */
+int32_t tscValidateExplainSql(SSqlObj* pSql) {
+  const char* msg1 = "keyword ANALYZE is expected";
+  const char* msg2 = "only select statement is supported by explain analyze";
+
+  SSqlCmd* pCmd = &pSql->cmd;
+  int32_t  index = 0;
+
+  SStrToken t = tStrGetToken(pSql->sqlstr, &index, false);
+  assert(t.type == TK_EXPLAIN);
+
+  t = tStrGetToken(pSql->sqlstr, &index, false);
+  if (t.type != TK_ID || t.n != strlen("analyze") || strncasecmp(t.z, "analyze", t.n) != 0) {
+    return tscSQLSyntaxErrMsg(tscGetErrorMsgPayload(pCmd), msg1, t.z);
+  }
+
+  t = tStrGetToken(pSql->sqlstr, &index, false);
+  if (t.type != TK_SELECT) {
+    return invalidOperationMsg(tscGetErrorMsgPayload(pCmd), msg2);
+  }
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfoS(pCmd);
+  if (pQueryInfo == NULL) {
+    return terrno;
+  }
+
+  if (tscAddEmptyMetaInfo(pQueryInfo) == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t len = (int32_t)strlen(t.z);
+  int32_t code = tscAllocPayload(pCmd, len + 1);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  memcpy(pCmd->payload, t.z, len);
+  pCmd->payloadLen = len;
+  pCmd->command    = TSDB_SQL_EXPLAIN;
+
+  return TSDB_CODE_SUCCESS;
+}
+
 int32_t tscValidateSqlInfo(SSqlObj* pSql, struct SSqlInfo* pInfo) {
   if (pInfo == NULL || pSql == NULL) {
     return TSDB_CODE_TSC_APP_ERROR;
@@ -5754,6 +5800,7 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
   const char* msg10 = "not support distinct mixed with order by";
   const char* msg11 = "not support order with udf";
   const char* msg12 = "order by tags not supported with diff/derivative/csum/mavg";
+  const char* msg13 = "only projected column allowed as order column in super table projection query";
 
   setDefaultOrderInfo(pQueryInfo);
   STableMetaInfo* pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
@@ -5815,6 +5862,7 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
     bool orderByTags = false;
     bool orderByTS = false;
     bool orderByGroupbyCol = false;
+    bool orderByPrjCol = false;
 
     if (index.columnIndex >= tscGetNumOfColumns(pTableMetaInfo->pTableMeta)) {
       int32_t relTagIndex = index.columnIndex - tscGetNumOfColumns(pTableMetaInfo->pTableMeta);
@@ -5843,7 +5891,24 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
       }
     }
 
-    if (!(orderByTags || orderByTS || orderByGroupbyCol) && !isTopBottomQuery(pQueryInfo)) {
+    // projection query on super table with limit, ordered by a normal column, each vnode returns only its top rows
+    if (!(orderByTags || orderByTS || orderByGroupbyCol) && index.columnIndex > PRIMARYKEY_TIMESTAMP_COL_INDEX &&
+        index.columnIndex < tscGetNumOfColumns(pTableMetaInfo->pTableMeta) && size == 1 &&
+        pSqlNode->limit.limit > 0 && tscIsProjectionQueryOnSTable(pQueryInfo, 0)) {
+      for (int32_t i = 0; i < tscNumOfExprs(pQueryInfo); ++i) {
+        SExprInfo* pExpr = tscExprGet(pQueryInfo, i);
+        if (pExpr->base.functionId == TSDB_FUNC_PRJ && pExpr->base.colInfo.colId == pSchema[index.columnIndex].colId) {
+          orderByPrjCol = true;
+          break;
+        }
+      }
+
+      if (!orderByPrjCol) {
+        return invalidOperationMsg(pMsgBuf, msg13);
+      }
+    }
+
+    if (!(orderByTags || orderByTS || orderByGroupbyCol || orderByPrjCol) && !isTopBottomQuery(pQueryInfo)) {
       return invalidOperationMsg(pMsgBuf, msg3);
     } else {  // order by top/bottom result value column is not supported in case of interval query.
       assert(!(orderByTags && orderByTS && orderByGroupbyCol));
@@ -5867,6 +5932,16 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
         if (udf) {
           return invalidOperationMsg(pMsgBuf, msg11);
         }
+      } else if (orderByPrjCol) {
+        tVariantListItem* p1 = taosArrayGet(pSqlNode->pSortOrder, 0);
+        if (udf) {
+          return invalidOperationMsg(pMsgBuf, msg11);
+        }
+
+        // the global merge on the client sorts the results of vnodes by the column in the same order
+        pQueryInfo->order.order = p1->sortOrder;
+        pQueryInfo->order.orderColId = pSchema[index.columnIndex].colId;
+        pQueryInfo->groupbyExpr.orderType = p1->sortOrder;
       } else if (isTopBottomQuery(pQueryInfo)) {
         /* order of top/bottom query in interval is not valid  */
 
@@ -5957,6 +6032,16 @@ int32_t validateOrderbyNode(SSqlCmd* pCmd, SQueryInfo* pQueryInfo, SSqlNode* pSq
       if (columnInfo != NULL && taosArrayGetSize(columnInfo) > 0) {
         SColIndex* pColIndex = taosArrayGet(columnInfo, 0);
         validOrder = (pColIndex->colIndex == index.columnIndex);
+      } else if (UTIL_TABLE_IS_TMP_TABLE(pTableMetaInfo) && tscIsProjectionQuery(pQueryInfo)) {
+        // the projection on the temp table, created by inner subquery, is sorted by any single column on the client
+        if (udf) {
+          return invalidOperationMsg(pMsgBuf, msg11);
+        }
+
+        tVariantListItem* pItem = taosArrayGet(pSqlNode->pSortOrder, 0);
+        pQueryInfo->order.order = pItem->sortOrder;
+        pQueryInfo->order.orderColId = pSchema[index.columnIndex].colId;
+        return TSDB_CODE_SUCCESS;
       }
 
       if (!validOrder) {
@@ -23,6 +23,7 @@
 #include "tscGlobalmerge.h"
 #include "tscLog.h"
 #include "tscProfile.h"
+#include "tscSubquery.h"
 #include "tscUtil.h"
 #include "tsclient.h"
 #include "ttimer.h"
@@ -475,15 +476,27 @@ void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcEpSet *pEpSet) {
     pRes->rspLen  = rpcMsg->contLen;
 
     if (pRes->rspLen > 0 && rpcMsg->pCont) {
-      char *tmp = (char *)realloc(pRes->pRsp, pRes->rspLen);
-      if (tmp == NULL) {
-        pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      if (pRes->rspCont) {
+        tscFreeRspBuf(pRes);
+      }
+
+      if (rpcMsg->msgType == TSDB_MSG_TYPE_FETCH_RSP) {
+        // the retrieved rows are used in place, instead of being copied out of the rpc message
+        tfree(pRes->pRsp);
+        pRes->pRsp = rpcMsg->pCont;
+        pRes->rspCont = true;
+        rpcMsg->pCont = NULL;
       } else {
-        pRes->pRsp = tmp;
-        memcpy(pRes->pRsp, rpcMsg->pCont, pRes->rspLen);
+        char *tmp = (char *)realloc(pRes->pRsp, pRes->rspLen);
+        if (tmp == NULL) {
+          pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+        } else {
+          pRes->pRsp = tmp;
+          memcpy(pRes->pRsp, rpcMsg->pCont, pRes->rspLen);
+        }
       }
     } else {
-      tfree(pRes->pRsp);
+      tscFreeRspBuf(pRes);
     }
 
     /*
@@ -922,6 +935,7 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   pQueryMsg->fillType       = htons(query.fillType);
   pQueryMsg->limit          = htobe64(query.limit.limit);
   pQueryMsg->offset         = htobe64(query.limit.offset);
+  pQueryMsg->vgroupLimit    = htobe64(query.prjInfo.vgroupLimit);
   pQueryMsg->numOfCols      = htons(query.numOfCols);
 
   pQueryMsg->interval.interval     = htobe64(query.interval.interval);
@@ -952,7 +966,7 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   pQueryMsg->numOfOutput    = htons((int16_t)query.numOfOutput);  // this is the stage one output column number
 
   pQueryMsg->numOfGroupCols = htons(pQueryInfo->groupbyExpr.numOfGroupCols);
-  pQueryMsg->queryType      = htonl(pQueryInfo->type);
+  pQueryMsg->queryType      = htonl(pQueryInfo->type | (tscIsExplainQuery(pSql)? TSDB_QUERY_TYPE_EXPLAIN:0));
   pQueryMsg->prevResultLen  = htonl(pQueryInfo->bufLen);
 
   // set column list ids
@@ -2652,6 +2666,10 @@ int tscProcessShowCreateRsp(SSqlObj *pSql) {
   return tscLocalResultCommonBuilder(pSql, 1);
 }
 
+int tscProcessExplainRsp(SSqlObj *pSql) {
+  return tscLocalResultCommonBuilder(pSql, (int32_t)taosArrayGetSize(pSql->pExplain));
+}
+
 int tscProcessQueryRsp(SSqlObj *pSql) {
   SSqlRes *pRes = &pSql->res;
 
@@ -2666,51 +2684,85 @@ int tscProcessQueryRsp(SSqlObj *pSql) {
   return 0;
 }
 
-static void decompressQueryColData(SSqlObj *pSql, SSqlRes *pRes, SQueryInfo* pQueryInfo, char **data, int8_t compressed, int32_t compLen) {
-  int32_t decompLen = 0;
+static int32_t decompressQueryColData(SSqlObj *pSql, SSqlRes *pRes, SQueryInfo* pQueryInfo, char **data, int8_t compressed, int32_t compLen) {
   int32_t numOfCols = pQueryInfo->fieldsInfo.numOfOutput;
-  int32_t *compSizes;
-  char    *pData = *data;
-  compSizes = (int32_t *)(pData + compLen);
+  char   *pData = *data;
+  int32_t *compSizes = (int32_t *)(pData + compLen);
 
   TAOS_FIELD *pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, numOfCols - 1);
   int16_t     offset = tscFieldInfoGetOffset(pQueryInfo, numOfCols - 1);
-  char       *outputBuf = tcalloc(pRes->numOfRows, (pField->bytes + offset));
+  int32_t     origLen = (pField->bytes + offset) * pRes->numOfRows;
+
+  // the columns are decompressed into the new response buffer directly, followed by the rest of the message
+  char   *pTail = pData + compLen + numOfCols * sizeof(int32_t);
+  int32_t tailLen = pRes->rspLen - sizeof(SRetrieveTableRsp) - (compLen + numOfCols * sizeof(int32_t));
+  if (compLen < 0 || tailLen < 0) {
+    tscError("0x%"PRIx64" invalid compressed col data, compressed size:%d, rsp len:%d", pSql->self, compLen,
+             pRes->rspLen);
+    pRes->code = TSDB_CODE_TSC_INVALID_MSG;
+    return pRes->code;
+  }
+
+  int32_t totalCompLen = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int32_t colCompLen = htonl(compSizes[i]);
+    if (colCompLen <= 0 || colCompLen > compLen - totalCompLen) {
+      tscError("0x%"PRIx64" invalid compressed size:%d of col:%d, compressed size:%d", pSql->self, colCompLen, i, compLen);
+      pRes->code = TSDB_CODE_TSC_INVALID_MSG;
+      return pRes->code;
+    }
+
+    totalCompLen += colCompLen;
+  }
+
+  // a column that is not compressed is copied as is, the extra compLen bytes keep a corrupted one in the buffer
+  int32_t rspLen = sizeof(SRetrieveTableRsp) + origLen + tailLen;
+  char   *pRsp = malloc(rspLen + compLen);
+  if (pRsp == NULL) {
+    pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    return pRes->code;
+  }
+
+  memcpy(pRsp, pRes->pRsp, sizeof(SRetrieveTableRsp));
 
-  char *p = outputBuf;
-  int32_t bufOffset;
+  char   *p = ((SRetrieveTableRsp *)pRsp)->data;
+  int32_t decompLen = 0;
   for (int32_t i = 0; i < numOfCols; ++i) {
     SInternalField* pInfo = (SInternalField*)TARRAY_GET_ELEM(pQueryInfo->fieldsInfo.internalField, i);
-    bufOffset = pInfo->field.bytes * pRes->numOfRows;
+    int32_t bufOffset = pInfo->field.bytes * pRes->numOfRows;
 
     int32_t flen = (*(tDataTypes[pInfo->field.type].decompFunc))(pData, htonl(compSizes[i]), pRes->numOfRows, p, bufOffset,
                                                                compressed, NULL, 0);
+    if (flen != bufOffset) {
+      tscError("0x%"PRIx64" failed to decompress col:%d, decompressed size:%d, expected:%d", pSql->self, i, flen,
+               bufOffset);
+      free(pRsp);
+      pRes->code = TSDB_CODE_TSC_INVALID_MSG;
+      return pRes->code;
+    }
 
     p += flen;
-    decompLen +=flen;
+    decompLen += flen;
     pData += htonl(compSizes[i]);
   }
 
-  /* Resize rsp as decompressed data will occupy more space */
-  pRes->rspLen = pRes->rspLen - (compLen + numOfCols * sizeof(int32_t)) + decompLen;
-  char *new_rsp = (char *)realloc(pRes->pRsp, pRes->rspLen);
-  if (new_rsp == NULL) {
-    pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
-    return;
-  } else {
-    pRes->pRsp = new_rsp;
-    *data = ((SRetrieveTableRsp *)pRes->pRsp)->data;
-    pData = *data + compLen + numOfCols * sizeof(int32_t);
+  if (decompLen != origLen) {
+    tscError("0x%"PRIx64" decompressed size:%d mismatch, expected:%d", pSql->self, decompLen, origLen);
+    free(pRsp);
+    pRes->code = TSDB_CODE_TSC_INVALID_MSG;
+    return pRes->code;
   }
 
+  memcpy(p, pTail, tailLen);
+
   tscDebug("0x%"PRIx64" decompress col data, compressed size:%d, decompressed size:%d",
       pSql->self, (int32_t)(compLen + numOfCols * sizeof(int32_t)), decompLen);
 
-  int32_t tailLen = pRes->rspLen - sizeof(SRetrieveTableRsp) - decompLen;
-  memmove(*data + decompLen, pData, tailLen);
-  memmove(*data, outputBuf, decompLen);
-
-  tfree(outputBuf);
+  tscFreeRspBuf(pRes);
+  pRes->pRsp   = pRsp;
+  pRes->rspLen = rspLen;
+  *data = ((SRetrieveTableRsp *)pRes->pRsp)->data;
+  return TSDB_CODE_SUCCESS;
 }
 
 int tscProcessRetrieveRspFromNode(SSqlObj *pSql) {
@@ -2732,6 +2784,15 @@ int tscProcessRetrieveRspFromNode(SSqlObj *pSql) {
   pRes->completed  = (pRetrieve->completed == 1);
   pRes->data       = pRetrieve->data;
 
+  // the query profile is appended at the end of the last response of a vnode, for explain analyze
+  if (pRes->completed && tscIsExplainQuery(pSql)) {
+    int32_t profLen = 0;
+    char*   pProfile = tscGetQueryProfile(pRes->pRsp, pRes->rspLen, &profLen);
+    if (pProfile != NULL) {
+      tscMergeQueryProfile(pSql->rootObj, pProfile, profLen);
+    }
+  }
+
   SQueryInfo* pQueryInfo = tscGetQueryInfo(pCmd);
   if (tscCreateResPointerInfo(pRes, pQueryInfo) != TSDB_CODE_SUCCESS) {
     return pRes->code;
@@ -2740,7 +2801,9 @@ int tscProcessRetrieveRspFromNode(SSqlObj *pSql) {
   //Decompress col data if compressed from server
   if (pRetrieve->compressed) {
     int32_t compLen = htonl(pRetrieve->compLen);
-    decompressQueryColData(pSql, pRes, pQueryInfo, &pRes->data, pRetrieve->compressed, compLen);
+    if (decompressQueryColData(pSql, pRes, pQueryInfo, &pRes->data, pRetrieve->compressed, compLen) != TSDB_CODE_SUCCESS) {
+      return pRes->code;
+    }
   }
 
   STableMetaInfo *pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
@@ -3217,6 +3280,7 @@ void tscInitMsgsFp() {
   tscProcessMsgRsp[TSDB_SQL_SHOW_CREATE_TABLE] = tscProcessShowCreateRsp;
   tscProcessMsgRsp[TSDB_SQL_SHOW_CREATE_STABLE] = tscProcessShowCreateRsp;
   tscProcessMsgRsp[TSDB_SQL_SHOW_CREATE_DATABASE] = tscProcessShowCreateRsp;
+  tscProcessMsgRsp[TSDB_SQL_EXPLAIN] = tscProcessExplainRsp;
 
   tscKeepConn[TSDB_SQL_SHOW] = 1;
   tscKeepConn[TSDB_SQL_RETRIEVE] = 1;
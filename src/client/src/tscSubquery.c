@@ -3517,6 +3517,10 @@ static void doBuildResFromSubqueries(SSqlObj* pSql) {
   int32_t rowSize = tscGetResRowLength(pQueryInfo->exprList);
 
   assert(numOfRes * rowSize > 0);
+  if (pRes->rspCont) {
+    tscFreeRspBuf(pRes);
+  }
+
   char* tmp = realloc(pRes->pRsp, numOfRes * rowSize + sizeof(tFilePage));
   if (tmp == NULL) {
     pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
@@ -3867,3 +3871,111 @@ void* createQInfoFromQueryNode(SQueryInfo* pQueryInfo, STableGroupInfo* pTableGr
   freeQInfo(pQInfo);
   return NULL;
 }
+
+static pthread_mutex_t tscExplainMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static bool isSameQueryProfile(SArray* pExplain, int32_t start, SQueryProfileOperator* pProf, int32_t num) {
+  if (start + num > taosArrayGetSize(pExplain)) {
+    return false;
+  }
+
+  // the operator tree of a vnode is matched only if it is the whole tree starting from the root at the position
+  if (start + num < taosArrayGetSize(pExplain) && ((SExplainOperator*)taosArrayGet(pExplain, start + num))->prof.level != 0) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    SExplainOperator* p = taosArrayGet(pExplain, start + i);
+    if (p->prof.level != htons(pProf[i].level) || strncmp(p->prof.name, pProf[i].name, tListLen(p->prof.name)) != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * the query profile at the end of a retrieve response, NULL if the response does not end with a valid one, e.g. it is
+ * sent by a vnode not supporting explain analyze
+ */
+char* tscGetQueryProfile(char* pRsp, int32_t rspLen, int32_t* profLen) {
+  if (pRsp == NULL || rspLen < (int32_t)(sizeof(SRetrieveTableRsp) + sizeof(SQueryProfileTail))) {
+    return NULL;
+  }
+
+  SQueryProfileTail* pTail = (SQueryProfileTail*)(pRsp + rspLen - sizeof(SQueryProfileTail));
+  if (htonl(pTail->magic) != TSDB_QUERY_PROFILE_MAGIC) {
+    return NULL;
+  }
+
+  int32_t len = htonl(pTail->profLen);
+  int32_t maxLen = rspLen - (int32_t)(sizeof(SRetrieveTableRsp) + sizeof(SQueryProfileTail));
+  if (len <= 0 || len > maxLen || len % sizeof(SQueryProfileOperator) != 0) {
+    return NULL;
+  }
+
+  *profLen = len;
+  return (char*)pTail - len;
+}
+
+/*
+ * merge the query profile of a vnode into the profile of the root sql object. The operator trees from different vnodes
+ * are merged if they have the same shape, with the counters summed up, otherwise the tree is added as a new one.
+ */
+void tscMergeQueryProfile(SSqlObj* pRootSql, char* pProfile, int32_t profLen) {
+  SQueryProfileOperator* pProf = (SQueryProfileOperator*) pProfile;
+  int32_t num = profLen / sizeof(SQueryProfileOperator);
+  if (num <= 0) {
+    return;
+  }
+
+  pthread_mutex_lock(&tscExplainMutex);
+
+  if (pRootSql->pExplain == NULL) {
+    pRootSql->pExplain = taosArrayInit(num, sizeof(SExplainOperator));
+    if (pRootSql->pExplain == NULL) {
+      pthread_mutex_unlock(&tscExplainMutex);
+      return;
+    }
+  }
+
+  SArray* pExplain = pRootSql->pExplain;
+
+  int32_t start = 0;
+  size_t  size = taosArrayGetSize(pExplain);
+  for (; start < size; ++start) {
+    SExplainOperator* p = taosArrayGet(pExplain, start);
+    if (p->prof.level == 0 && isSameQueryProfile(pExplain, start, pProf, num)) {
+      break;
+    }
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    SExplainOperator* p = NULL;
+    if (start < size) {
+      p = taosArrayGet(pExplain, start + i);
+    } else {
+      SExplainOperator op = {0};
+      tstrncpy(op.prof.name, pProf[i].name, tListLen(op.prof.name));
+      op.prof.level = htons(pProf[i].level);
+      p = taosArrayPush(pExplain, &op);
+    }
+
+    p->numOfVnodes += 1;
+    p->prof.numOfCalls    += htobe64(pProf[i].numOfCalls);
+    p->prof.rowsIn        += htobe64(pProf[i].rowsIn);
+    p->prof.rowsOut       += htobe64(pProf[i].rowsOut);
+    p->prof.elapsedTime   += htobe64(pProf[i].elapsedTime);
+    p->prof.dataBlocks    += htobe64(pProf[i].dataBlocks);
+    p->prof.lastBlocks    += htobe64(pProf[i].lastBlocks);
+    p->prof.cacheBlocks   += htobe64(pProf[i].cacheBlocks);
+    p->prof.decompSize    += htobe64(pProf[i].decompSize);
+    p->prof.smaHits       += htobe64(pProf[i].smaHits);
+    p->prof.queueWaitTime += htobe64(pProf[i].queueWaitTime);
+  }
+
+  pthread_mutex_unlock(&tscExplainMutex);
+
+  tscDebug("0x%"PRIx64" query profile of %d operators merged, total operators:%d", pRootSql->self, num,
+           (int32_t)taosArrayGetSize(pExplain));
+}
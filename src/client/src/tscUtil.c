@@ -1412,7 +1412,7 @@ static void tscDestroyResPointerInfo(SSqlRes* pRes) {
     pRes->numOfCols = 0;
   }
 
-  tfree(pRes->pRsp);
+  tscFreeRspBuf(pRes);
 
   tfree(pRes->tsrow);
   tfree(pRes->length);
@@ -1521,6 +1521,16 @@ void* tscCleanupTableMetaMap(SHashObj* pTableMetaMap) {
   return NULL;
 }
 
+void tscFreeRspBuf(SSqlRes* pRes) {
+  if (pRes->rspCont) {
+    rpcFreeCont(pRes->pRsp);
+    pRes->pRsp = NULL;
+    pRes->rspCont = false;
+  } else {
+    tfree(pRes->pRsp);
+  }
+}
+
 void tscFreeSqlResult(SSqlObj* pSql) {
   SSqlRes* pRes = &pSql->res;
 
@@ -1623,6 +1633,9 @@ void tscFreeSqlObj(SSqlObj* pSql) {
   pSql->subState.numOfSub = 0;
   pSql->self = 0;
 
+  taosArrayDestroy(pSql->pExplain);
+  pSql->pExplain = NULL;
+
   tscFreeSqlResult(pSql);
   tscResetSqlCmd(pCmd, false, pSql->self);
 
@@ -2164,6 +2177,17 @@ bool tscIsInsertData(char* sqlstr) {
   } while (1);
 }
 
+bool tscIsExplainSql(char* sqlstr) {
+  int32_t index = 0;
+
+  SStrToken t0 = tStrGetToken(sqlstr, &index, false);
+  return t0.type == TK_EXPLAIN;
+}
+
+bool tscIsExplainQuery(SSqlObj* pSql) {
+  return pSql->rootObj != NULL && pSql->rootObj->cmd.explain;
+}
+
 int32_t tscAllocPayloadFast(SSqlCmd *pCmd, size_t size) {
   if (pCmd->payload == NULL) {
     assert(pCmd->allocSize == 0);
@@ -5025,6 +5049,7 @@ int32_t tscCreateQueryFromQueryInfo(SQueryInfo* pQueryInfo, SQueryAttr* pQueryAt
   pQueryAttr->numOfOutput       = numOfOutput;
   pQueryAttr->limit             = pQueryInfo->limit;
   pQueryAttr->slimit            = pQueryInfo->slimit;
+  pQueryAttr->prjInfo.vgroupLimit = pQueryInfo->vgroupLimit;
   pQueryAttr->order             = pQueryInfo->order;
   pQueryAttr->fillType          = pQueryInfo->fillType;
   pQueryAttr->havingNum         = pQueryInfo->havingFieldNum;
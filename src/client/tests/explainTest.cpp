@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "os.h"
+#include "taos.h"
+#include "tsclient.h"
+#include "tscSubquery.h"
+#include "tscUtil.h"
+
+namespace {
+SQueryProfileOperator createProfile(const char* name, int16_t level, int64_t rows, int64_t elapsed) {
+  SQueryProfileOperator p = {{0}};
+  tstrncpy(p.name, name, tListLen(p.name));
+  p.level = htons(level);
+  p.numOfCalls = htobe64(1);
+  p.rowsOut = htobe64(rows);
+  p.elapsedTime = htobe64(elapsed);
+  p.dataBlocks = htobe64(2);
+  return p;
+}
+
+// a retrieve response with no rows, ending with the given profile
+std::vector<char> createRsp(const std::vector<SQueryProfileOperator>& prof, uint32_t magic) {
+  int32_t profLen = (int32_t)(prof.size() * sizeof(SQueryProfileOperator));
+
+  std::vector<char> rsp(sizeof(SRetrieveTableRsp) + profLen + sizeof(SQueryProfileTail));
+  if (profLen > 0) {
+    memcpy(&rsp[sizeof(SRetrieveTableRsp)], &prof[0], profLen);
+  }
+
+  SQueryProfileTail* pTail = (SQueryProfileTail*)&rsp[rsp.size() - sizeof(SQueryProfileTail)];
+  pTail->profLen = htonl(profLen);
+  pTail->magic = htonl(magic);
+  return rsp;
+}
+
+SSqlObj* createSqlObj(const char* sql) {
+  SSqlObj* pSql = (SSqlObj*)calloc(1, sizeof(SSqlObj));
+  pSql->signature = pSql;
+  pSql->sqlstr = strdup(sql);
+  return pSql;
+}
+
+void destroySqlObj(SSqlObj* pSql) {
+  tscResetSqlCmd(&pSql->cmd, false, 0);
+  tfree(pSql->cmd.payload);
+  taosArrayDestroy(pSql->pExplain);
+  free(pSql->sqlstr);
+  free(pSql);
+}
+
+SExplainOperator* getOperator(SSqlObj* pSql, int32_t index) {
+  return (SExplainOperator*)taosArrayGet(pSql->pExplain, index);
+}
+}  // namespace
+
+TEST(explainTest, getQueryProfile) {
+  std::vector<SQueryProfileOperator> prof;
+  prof.push_back(createProfile("Project", 0, 10, 100));
+  prof.push_back(createProfile("TableScan", 1, 10, 50));
+
+  std::vector<char> rsp = createRsp(prof, TSDB_QUERY_PROFILE_MAGIC);
+  int32_t profLen = 0;
+  char*   pProfile = tscGetQueryProfile(&rsp[0], (int32_t)rsp.size(), &profLen);
+  ASSERT_EQ(pProfile, &rsp[sizeof(SRetrieveTableRsp)]);
+  EXPECT_EQ(profLen, (int32_t)(2 * sizeof(SQueryProfileOperator)));
+
+  // a response of a vnode not supporting explain analyze has no tail
+  std::vector<char> noTail = createRsp(prof, 0);
+  EXPECT_EQ(tscGetQueryProfile(&noTail[0], (int32_t)noTail.size(), &profLen), nullptr);
+
+  // a length beyond the response or not of whole operators is rejected
+  SQueryProfileTail* pTail = (SQueryProfileTail*)&rsp[rsp.size() - sizeof(SQueryProfileTail)];
+  pTail->profLen = htonl(3 * sizeof(SQueryProfileOperator));
+  EXPECT_EQ(tscGetQueryProfile(&rsp[0], (int32_t)rsp.size(), &profLen), nullptr);
+  pTail->profLen = htonl(sizeof(SQueryProfileOperator) + 1);
+  EXPECT_EQ(tscGetQueryProfile(&rsp[0], (int32_t)rsp.size(), &profLen), nullptr);
+  pTail->profLen = 0;
+  EXPECT_EQ(tscGetQueryProfile(&rsp[0], (int32_t)rsp.size(), &profLen), nullptr);
+
+  EXPECT_EQ(tscGetQueryProfile(&rsp[0], (int32_t)sizeof(SRetrieveTableRsp), &profLen), nullptr);
+}
+
+TEST(explainTest, mergeSameTree) {
+  SSqlObj* pSql = createSqlObj("explain analyze select * from t");
+
+  SQueryProfileOperator prof[2] = {createProfile("Project", 0, 10, 100), createProfile("TableScan", 1, 20, 50)};
+  tscMergeQueryProfile(pSql, (char*)prof, sizeof(prof));
+
+  prof[0] = createProfile("Project", 0, 5, 30);
+  prof[1] = createProfile("TableScan", 1, 6, 20);
+  tscMergeQueryProfile(pSql, (char*)prof, sizeof(prof));
+
+  ASSERT_EQ(taosArrayGetSize(pSql->pExplain), 2u);
+
+  SExplainOperator* p0 = getOperator(pSql, 0);
+  EXPECT_STREQ(p0->prof.name, "Project");
+  EXPECT_EQ(p0->prof.level, 0);
+  EXPECT_EQ(p0->numOfVnodes, 2);
+  EXPECT_EQ(p0->prof.rowsOut, 15);
+  EXPECT_EQ(p0->prof.elapsedTime, 130);
+
+  SExplainOperator* p1 = getOperator(pSql, 1);
+  EXPECT_EQ(p1->prof.level, 1);
+  EXPECT_EQ(p1->numOfVnodes, 2);
+  EXPECT_EQ(p1->prof.rowsOut, 26);
+  EXPECT_EQ(p1->prof.numOfCalls, 2);
+  EXPECT_EQ(p1->prof.dataBlocks, 4);
+
+  destroySqlObj(pSql);
+}
+
+TEST(explainTest, mergeDifferentTree) {
+  SSqlObj* pSql = createSqlObj("explain analyze select * from t");
+
+  SQueryProfileOperator prof1[2] = {createProfile("Project", 0, 10, 100), createProfile("TableScan", 1, 20, 50)};
+  tscMergeQueryProfile(pSql, (char*)prof1, sizeof(prof1));
+
+  // a tree of a different shape is added as a new one
+  SQueryProfileOperator prof2[3] = {createProfile("Project", 0, 1, 10), createProfile("Filter", 1, 2, 8),
+                                    createProfile("TableScan", 2, 3, 5)};
+  tscMergeQueryProfile(pSql, (char*)prof2, sizeof(prof2));
+
+  // a prefix of a larger tree does not match it
+  SQueryProfileOperator prof3[1] = {createProfile("Project", 0, 7, 7)};
+  tscMergeQueryProfile(pSql, (char*)prof3, sizeof(prof3));
+
+  // the same as the second one
+  tscMergeQueryProfile(pSql, (char*)prof2, sizeof(prof2));
+
+  ASSERT_EQ(taosArrayGetSize(pSql->pExplain), 6u);
+  EXPECT_EQ(getOperator(pSql, 0)->numOfVnodes, 1);
+  EXPECT_EQ(getOperator(pSql, 2)->numOfVnodes, 2);
+  EXPECT_STREQ(getOperator(pSql, 3)->prof.name, "Filter");
+  EXPECT_EQ(getOperator(pSql, 4)->prof.rowsOut, 6);
+  EXPECT_EQ(getOperator(pSql, 5)->numOfVnodes, 1);
+  EXPECT_EQ(getOperator(pSql, 5)->prof.rowsOut, 7);
+
+  // nothing to merge
+  tscMergeQueryProfile(pSql, (char*)prof1, 0);
+  EXPECT_EQ(taosArrayGetSize(pSql->pExplain), 6u);
+
+  destroySqlObj(pSql);
+}
+
+TEST(explainTest, parseExplainSql) {
+  EXPECT_TRUE(tscIsExplainSql((char*)"explain analyze select * from t"));
+  EXPECT_TRUE(tscIsExplainSql((char*)"  EXPLAIN ANALYZE select * from t"));
+  EXPECT_FALSE(tscIsExplainSql((char*)"select * from t"));
+  EXPECT_FALSE(tscIsExplainSql((char*)"insert into t values(now, 1)"));
+
+  SSqlObj* pSql = createSqlObj("explain analyze select avg(v) from meters interval(1h)");
+  ASSERT_EQ(tsParseSql(pSql, true), TSDB_CODE_SUCCESS);
+  EXPECT_EQ(pSql->cmd.command, TSDB_SQL_EXPLAIN);
+  EXPECT_EQ(std::string(pSql->cmd.payload, pSql->cmd.payloadLen), "select avg(v) from meters interval(1h)");
+  destroySqlObj(pSql);
+
+  pSql = createSqlObj("explain select * from t");
+  EXPECT_EQ(tsParseSql(pSql, true), TSDB_CODE_TSC_SQL_SYNTAX_ERROR);
+  destroySqlObj(pSql);
+
+  pSql = createSqlObj("explain analyze show databases");
+  EXPECT_EQ(tsParseSql(pSql, true), TSDB_CODE_TSC_INVALID_OPERATION);
+  destroySqlObj(pSql);
+}
@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "os.h"
+#include "taos.h"
+#include "taoserror.h"
+#include "tsclient.h"
+#include "tscompression.h"
+#include "tscUtil.h"
+#include "trpc.h"
+
+extern "C" int tscProcessRetrieveRspFromNode(SSqlObj* pSql);
+
+namespace {
+const int32_t numOfRows = 100;
+const int16_t binBytes = 10 + VARSTR_HEADER_SIZE;
+
+// select of an int column and a binary column
+class RetrieveRspTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pSql = (SSqlObj*)calloc(1, sizeof(SSqlObj));
+    pSql->signature = pSql;
+    pSql->cmd.command = TSDB_SQL_RETRIEVE;
+
+    SQueryInfo* pQueryInfo = tscGetQueryInfoS(&pSql->cmd);
+    ASSERT_NE(pQueryInfo, nullptr);
+
+    TAOS_FIELD f1 = {{0}};
+    tstrncpy(f1.name, "a", sizeof(f1.name));
+    f1.type = TSDB_DATA_TYPE_INT;
+    f1.bytes = sizeof(int32_t);
+    tscFieldInfoAppend(&pQueryInfo->fieldsInfo, &f1)->pExpr = &expr[0];
+
+    TAOS_FIELD f2 = {{0}};
+    tstrncpy(f2.name, "b", sizeof(f2.name));
+    f2.type = TSDB_DATA_TYPE_BINARY;
+    f2.bytes = binBytes;
+    tscFieldInfoAppend(&pQueryInfo->fieldsInfo, &f2)->pExpr = &expr[1];
+
+    memset(expr, 0, sizeof(expr));
+    expr[0].base.offset = 0;
+    expr[1].base.offset = sizeof(int32_t);
+
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      ints.push_back(i * 3 - 50);
+
+      std::vector<char> bin(binBytes, 0);
+      varDataSetLen(&bin[0], snprintf((char*)varDataVal(&bin[0]), binBytes - VARSTR_HEADER_SIZE, "b%d", i));
+      bins.insert(bins.end(), bin.begin(), bin.end());
+    }
+  }
+
+  void TearDown() override {
+    tscFreeSqlResult(pSql);
+    tscResetSqlCmd(&pSql->cmd, false, 0);
+    tfree(pSql->cmd.payload);
+    free(pSql);
+  }
+
+  // a fetch response of the rows compressed as the vnode does, followed by an empty table list
+  std::vector<char> createRsp(bool compressed) {
+    std::vector<char> cols;
+    std::vector<int32_t> compSizes;
+    if (compressed) {
+      std::vector<char> buf(ints.size() * sizeof(int32_t) + COMP_OVERFLOW_BYTES);
+      int32_t len = tDataTypes[TSDB_DATA_TYPE_INT].compFunc((char*)&ints[0], (int)(ints.size() * sizeof(int32_t)),
+                                                            numOfRows, &buf[0], (int)buf.size(), ONE_STAGE_COMP, NULL, 0);
+      cols.insert(cols.end(), buf.begin(), buf.begin() + len);
+      compSizes.push_back(htonl(len));
+
+      buf.resize(bins.size() + COMP_OVERFLOW_BYTES);
+      len = tDataTypes[TSDB_DATA_TYPE_BINARY].compFunc(&bins[0], (int)bins.size(), numOfRows, &buf[0], (int)buf.size(),
+                                                        ONE_STAGE_COMP, NULL, 0);
+      cols.insert(cols.end(), buf.begin(), buf.begin() + len);
+      compSizes.push_back(htonl(len));
+    } else {
+      cols.insert(cols.end(), (char*)&ints[0], (char*)&ints[0] + ints.size() * sizeof(int32_t));
+      cols.insert(cols.end(), bins.begin(), bins.end());
+    }
+
+    std::vector<char> rsp(sizeof(SRetrieveTableRsp), 0);
+    SRetrieveTableRsp* pRetrieve = (SRetrieveTableRsp*)&rsp[0];
+    pRetrieve->numOfRows = htonl(numOfRows);
+    pRetrieve->compressed = compressed ? ONE_STAGE_COMP : 0;
+    pRetrieve->compLen = htonl(compressed ? (int32_t)cols.size() : 0);
+
+    rsp.insert(rsp.end(), cols.begin(), cols.end());
+    rsp.insert(rsp.end(), (char*)compSizes.data(), (char*)compSizes.data() + compSizes.size() * sizeof(int32_t));
+
+    int32_t numOfTables = 0;
+    rsp.insert(rsp.end(), (char*)&numOfTables, (char*)&numOfTables + sizeof(int32_t));
+    return rsp;
+  }
+
+  // the response is received in an rpc buffer, which the result keeps as is
+  void setRpcRsp(const std::vector<char>& rsp) {
+    pSql->res.pRsp = (char*)rpcMallocCont((int)rsp.size());
+    memcpy(pSql->res.pRsp, &rsp[0], rsp.size());
+    pSql->res.rspLen = (int32_t)rsp.size();
+    pSql->res.rspCont = true;
+  }
+
+  void checkRows() {
+    SSqlRes* pRes = &pSql->res;
+    ASSERT_EQ(pRes->numOfRows, numOfRows);
+    EXPECT_EQ(memcmp(pRes->urow[0], &ints[0], ints.size() * sizeof(int32_t)), 0);
+    EXPECT_EQ(memcmp(pRes->urow[1], &bins[0], bins.size()), 0);
+  }
+
+  SSqlObj*             pSql = NULL;
+  SExprInfo            expr[2];
+  std::vector<int32_t> ints;
+  std::vector<char>    bins;
+};
+}  // namespace
+
+TEST_F(RetrieveRspTest, rpcBufferUsedInPlace) {
+  setRpcRsp(createRsp(false));
+  char* pCont = pSql->res.pRsp;
+
+  ASSERT_EQ(tscProcessRetrieveRspFromNode(pSql), TSDB_CODE_SUCCESS);
+  EXPECT_EQ(pSql->res.pRsp, pCont);
+  EXPECT_TRUE(pSql->res.rspCont);
+  EXPECT_EQ(pSql->res.data, ((SRetrieveTableRsp*)pCont)->data);
+  checkRows();
+
+  // the rpc buffer is released by rpcFreeCont
+  tscFreeRspBuf(&pSql->res);
+  EXPECT_EQ(pSql->res.pRsp, nullptr);
+  EXPECT_FALSE(pSql->res.rspCont);
+}
+
+TEST_F(RetrieveRspTest, decompressReleasesRpcBuffer) {
+  setRpcRsp(createRsp(true));
+  char* pCont = pSql->res.pRsp;
+
+  ASSERT_EQ(tscProcessRetrieveRspFromNode(pSql), TSDB_CODE_SUCCESS);
+
+  // the columns are decompressed into a new buffer owned by the result, the rpc buffer is released
+  EXPECT_NE(pSql->res.pRsp, pCont);
+  EXPECT_FALSE(pSql->res.rspCont);
+  EXPECT_EQ(pSql->res.rspLen, (int32_t)(sizeof(SRetrieveTableRsp) + ints.size() * sizeof(int32_t) + bins.size() +
+                                        sizeof(int32_t)));
+  checkRows();
+}
+
+TEST_F(RetrieveRspTest, decompressLengthMismatch) {
+  // the binary column claims fewer bytes than its rows, and is not compressed, so it is copied short
+  std::vector<char> rsp = createRsp(false);
+  std::vector<char> intCol(ints.size() * sizeof(int32_t) + COMP_OVERFLOW_BYTES);
+  int32_t intLen = tDataTypes[TSDB_DATA_TYPE_INT].compFunc((char*)&ints[0], (int)(ints.size() * sizeof(int32_t)),
+                                                           numOfRows, &intCol[0], (int)intCol.size(), ONE_STAGE_COMP,
+                                                           NULL, 0);
+  std::vector<char> binCol(1, 0);
+  binCol.insert(binCol.end(), bins.begin(), bins.end() - binBytes);
+
+  std::vector<char> bad(rsp.begin(), rsp.begin() + sizeof(SRetrieveTableRsp));
+  bad.insert(bad.end(), intCol.begin(), intCol.begin() + intLen);
+  bad.insert(bad.end(), binCol.begin(), binCol.end());
+  int32_t compSizes[2] = {(int32_t)htonl(intLen), (int32_t)htonl((int32_t)binCol.size())};
+  bad.insert(bad.end(), (char*)compSizes, (char*)compSizes + sizeof(compSizes));
+  int32_t numOfTables = 0;
+  bad.insert(bad.end(), (char*)&numOfTables, (char*)&numOfTables + sizeof(int32_t));
+
+  SRetrieveTableRsp* pRetrieve = (SRetrieveTableRsp*)&bad[0];
+  pRetrieve->compressed = ONE_STAGE_COMP;
+  pRetrieve->compLen = htonl(intLen + (int32_t)binCol.size());
+
+  setRpcRsp(bad);
+  char* pCont = pSql->res.pRsp;
+
+  EXPECT_EQ(tscProcessRetrieveRspFromNode(pSql), TSDB_CODE_TSC_INVALID_MSG);
+  EXPECT_EQ(pSql->res.code, TSDB_CODE_TSC_INVALID_MSG);
+
+  // the received buffer is kept by the result, and released with it
+  EXPECT_EQ(pSql->res.pRsp, pCont);
+  EXPECT_TRUE(pSql->res.rspCont);
+}
+
+TEST_F(RetrieveRspTest, invalidCompressedSize) {
+  std::vector<char> rsp = createRsp(true);
+
+  // the compressed length of the columns is larger than the message
+  SRetrieveTableRsp* pRetrieve = (SRetrieveTableRsp*)&rsp[0];
+  pRetrieve->compLen = htonl((int32_t)rsp.size());
+
+  setRpcRsp(rsp);
+  EXPECT_EQ(tscProcessRetrieveRspFromNode(pSql), TSDB_CODE_TSC_INVALID_MSG);
+}
+
+TEST(tscFreeRspBufTest, mallocBuffer) {
+  SSqlRes res = {0};
+  res.pRsp = (char*)malloc(64);
+  res.rspCont = false;
+
+  tscFreeRspBuf(&res);
+  EXPECT_EQ(res.pRsp, nullptr);
+  EXPECT_FALSE(res.rspCont);
+
+  // freeing twice is safe
+  tscFreeRspBuf(&res);
+  EXPECT_EQ(res.pRsp, nullptr);
+}
+
+TEST(tscFreeRspBufTest, rpcBuffer) {
+  SSqlRes res = {0};
+  res.pRsp = (char*)rpcMallocCont(64);
+  res.rspCont = true;
+
+  tscFreeRspBuf(&res);
+  EXPECT_EQ(res.pRsp, nullptr);
+  EXPECT_FALSE(res.rspCont);
+
+  // a later malloc'ed buffer is freed by free
+  res.pRsp = (char*)malloc(32);
+  tscFreeRspBuf(&res);
+  EXPECT_EQ(res.pRsp, nullptr);
+}
@@ -25,6 +25,15 @@ typedef void (*_arithmetic_operator_fn_t)(void *left, int32_t numLeft, int32_t l
 
 _arithmetic_operator_fn_t getArithmeticOperatorFn(int32_t arithmeticOptr);
 
+/*
+ * Batch kernels of the compiled arithmetic program. Operands are converted to double vectors once and null values
+ * are tracked in a separate mask of one byte per row, so the loops carry neither type dispatch nor null checks.
+ */
+int32_t vectorLoadDouble(const void *src, int32_t type, int32_t numOfRows, int32_t order, double *output,
+                         uint8_t *nullMask);
+int32_t vectorArithmeticDouble(int32_t optr, const double *left, double lval, const double *right, double rval,
+                               int32_t numOfRows, double *output, uint8_t *nullMask);
+
 #ifdef __cplusplus
 }
 #endif
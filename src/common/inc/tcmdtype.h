@@ -87,6 +87,7 @@ enum {
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_SHOW_CREATE_TABLE, "show-create-table")
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_SHOW_CREATE_STABLE, "show-create-stable")
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_SHOW_CREATE_DATABASE, "show-create-database")
+  TSDB_DEFINE_SQL_TYPE( TSDB_SQL_EXPLAIN, "explain-analyze")
 
   // build empty result instead of accessing dnode to fetch result reset the client cache
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_RETRIEVE_EMPTY_RESULT, "retrieve-empty-result" )
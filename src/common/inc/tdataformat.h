@@ -342,6 +342,8 @@ void dataColInit(SDataCol *pDataCol, STColumn *pCol, int maxPoints);
 
 int dataColAppendVal(SDataCol *pCol, const void *value, int numOfRows, int maxPoints, int rowOffset);
 
+int dataColAppendRange(SDataCol *pCol, SDataCol *pSrc, int offset, int nEle, int numOfRows, int maxPoints);
+
 void dataColSetOffset(SDataCol *pCol, int nEle);
 
 bool isNEleNull(SDataCol *pCol, int nEle);
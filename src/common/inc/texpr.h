@@ -97,6 +97,18 @@ bool exprTreeApplyFilter(tExprNode *pExpr, const void *pItem, SExprTraverseSupp
 void arithmeticTreeTraverse(tExprNode *pExprs, int32_t numOfRows, char *pOutput, void *param, int32_t order,
                             char *(*cb)(void *, const char*, int32_t));
 
+/*
+ * An arithmetic expression tree compiled into a flat program of batch kernels, which evaluates a block of rows
+ * column by column instead of dispatching per row. Compiling returns NULL if the tree is not supported, in which
+ * case arithmeticTreeTraverse should be used.
+ */
+typedef struct SArithmeticProgram SArithmeticProgram;
+
+SArithmeticProgram *arithmeticProgramCompile(tExprNode *pExprs);
+int32_t arithmeticProgramExec(SArithmeticProgram *pProgram, int32_t numOfRows, char *pOutput, void *param,
+                              int32_t order, char *(*cb)(void *, const char *, int32_t));
+void arithmeticProgramDestroy(SArithmeticProgram *pProgram);
+
 void buildFilterSetFromBinary(void **q, const char *buf, int32_t len);
 
 #ifdef __cplusplus
@@ -47,12 +47,18 @@ extern int64_t  tsDnodeStartTime;
 extern int      tsRpcTimer;
 extern int      tsRpcMaxTime;
 extern int      tsRpcForceTcp;  // all commands go to tcp protocol if this is enabled
+extern int32_t  tsRpcMuxConns;  // all requests to an end point share these TCP connections if it is not 0
 extern int32_t  tsMaxConnections;
 extern int32_t  tsMaxShellConns;
 extern int32_t  tsShellActivityTimer;
 extern uint32_t tsMaxTmrCtrl;
 extern float    tsNumOfThreadsPerCore;
 extern int32_t  tsNumOfCommitThreads;
+extern int32_t  tsNumOfFSetCommitThreads;
+extern int8_t   tsColumnarMemTable;
+extern int32_t  tsBlockCacheSize;
+extern int32_t  tsQueryPrefetchBlocks;
+extern int32_t  tsMaxTagIndexes;
 extern float    tsRatioOfQueryCores;
 extern int8_t   tsDaylight;
 extern char     tsTimezone[];
@@ -60,6 +66,9 @@ extern char     tsLocale[];
 extern char     tsCharset[];  // default encode string
 extern int8_t   tsEnableCoreFile;
 extern int32_t  tsCompressMsgSize;
+extern int32_t  tsRpcCompressAlgo;
+extern int32_t  tsRpcCompressLevel;
+extern int32_t  tsRpcCompressMinSpeed;
 extern int32_t  tsCompressColData;
 extern int32_t  tsMaxNumOfDistinctResults;
 extern char     tsTempDir[];
@@ -69,6 +78,11 @@ extern int32_t tsQueryBufferSize;  // maximum allowed usage buffer size in MB fo
 extern int64_t
     tsQueryBufferSizeBytes;  // maximum allowed usage buffer size in byte for each data node during query processing
 extern int32_t tsRetrieveBlockingModel;  // retrieve threads will be blocked
+extern int32_t tsRetrievePrefetchBlocks; // result blocks built ahead of the retrieve requests of one query
+extern int32_t tsQueryParallelThreads;   // worker threads for the aggregation of one super table query
+extern int32_t tsGroupbySpillBufferSize; // memory in MB for the groups of a super table group by query before spilling
+extern int32_t tsSortBufferSize;         // memory in MB for the rows of an order by query before sorting into runs on disk
+extern int32_t tsSortParallelThreads;    // threads that sort the rows of an order by query
 
 extern int8_t tsKeepOriginalColumnName;
 
@@ -103,6 +117,7 @@ extern int32_t tsTimePrecision;
 extern int8_t  tsCompression;
 extern int8_t  tsWAL;
 extern int32_t tsFsyncPeriod;
+extern int32_t tsWalGroupCommitSize;
 extern int32_t tsReplications;
 extern int16_t tsPartitons;
 extern int32_t tsQuorum;
@@ -114,6 +129,13 @@ extern bool    tsdbForceKeepFile;
 extern bool    tsdbForceCompactFile;
 extern int32_t tsdbWalFlushSize;
 
+// sync
+extern int32_t tsSyncFwdBatchSize;
+extern int32_t tsSyncFwdWindow;
+extern int32_t tsSyncRecoveryNum;
+extern int32_t tsSyncFileRate;
+extern int32_t tsSyncWalRate;
+
 // balance
 extern int8_t  tsEnableBalance;
 extern int8_t  tsAlternativeRole;
@@ -410,3 +410,132 @@ _arithmetic_operator_fn_t getArithmeticOperatorFn(int32_t arithmeticOptr) {
       return NULL;
   }
 }
+
+#define VECTOR_LOAD_DOUBLE(_type, _bits, _null)                                      \
+  do {                                                                               \
+    const _type *pData = (const _type *)src;                                         \
+    const _bits *pBits = (const _bits *)src;                                         \
+    if (order == TSDB_ORDER_ASC) {                                                   \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+        output[i] = (double)pData[i];                                                \
+        nullMask[i] = (pBits[i] == (_bits)(_null));                                  \
+        numOfNull += nullMask[i];                                                    \
+      }                                                                              \
+    } else {                                                                         \
+      for (int32_t i = 0, j = numOfRows - 1; i < numOfRows; ++i, --j) {              \
+        output[i] = (double)pData[j];                                                \
+        nullMask[i] = (pBits[j] == (_bits)(_null));                                  \
+        numOfNull += nullMask[i];                                                    \
+      }                                                                              \
+    }                                                                                \
+  } while (0)
+
+/*
+ * Convert one column into a double vector in ascending order and mark its null values, return the number of null
+ * values found, or -1 if the type is not numeric.
+ */
+int32_t vectorLoadDouble(const void *src, int32_t type, int32_t numOfRows, int32_t order, double *output,
+                         uint8_t *nullMask) {
+  int32_t numOfNull = 0;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   VECTOR_LOAD_DOUBLE(int8_t,   uint8_t,  TSDB_DATA_TINYINT_NULL);   break;
+    case TSDB_DATA_TYPE_UTINYINT:  VECTOR_LOAD_DOUBLE(uint8_t,  uint8_t,  TSDB_DATA_UTINYINT_NULL);  break;
+    case TSDB_DATA_TYPE_SMALLINT:  VECTOR_LOAD_DOUBLE(int16_t,  uint16_t, TSDB_DATA_SMALLINT_NULL);  break;
+    case TSDB_DATA_TYPE_USMALLINT: VECTOR_LOAD_DOUBLE(uint16_t, uint16_t, TSDB_DATA_USMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_INT:       VECTOR_LOAD_DOUBLE(int32_t,  uint32_t, TSDB_DATA_INT_NULL);       break;
+    case TSDB_DATA_TYPE_UINT:      VECTOR_LOAD_DOUBLE(uint32_t, uint32_t, TSDB_DATA_UINT_NULL);      break;
+    case TSDB_DATA_TYPE_BIGINT:    VECTOR_LOAD_DOUBLE(int64_t,  uint64_t, TSDB_DATA_BIGINT_NULL);    break;
+    case TSDB_DATA_TYPE_UBIGINT:   VECTOR_LOAD_DOUBLE(uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL);   break;
+    case TSDB_DATA_TYPE_FLOAT:     VECTOR_LOAD_DOUBLE(float,    uint32_t, TSDB_DATA_FLOAT_NULL);     break;
+    case TSDB_DATA_TYPE_DOUBLE:    VECTOR_LOAD_DOUBLE(double,   uint64_t, TSDB_DATA_DOUBLE_NULL);    break;
+    default:
+      return -1;
+  }
+
+  return numOfNull;
+}
+
+// a NULL vector operand means the constant value is used for all rows
+#define VECTOR_ARITHMETIC_DOUBLE(_expr)                                              \
+  do {                                                                               \
+    if (left != NULL && right != NULL) {                                             \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+        double l = left[i], r = right[i];                                            \
+        output[i] = (_expr);                                                         \
+      }                                                                              \
+    } else if (left != NULL) {                                                       \
+      double r = rval;                                                               \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+        double l = left[i];                                                          \
+        output[i] = (_expr);                                                         \
+      }                                                                              \
+    } else if (right != NULL) {                                                      \
+      double l = lval;                                                               \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+        double r = right[i];                                                         \
+        output[i] = (_expr);                                                         \
+      }                                                                              \
+    } else {                                                                         \
+      double l = lval, r = rval, v = (_expr);                                        \
+      for (int32_t i = 0; i < numOfRows; ++i) {                                      \
+        output[i] = v;                                                               \
+      }                                                                              \
+    }                                                                                \
+  } while (0)
+
+#define IS_ZERO_DIVISOR(_r) FLT_EQUAL((_r), 0.0)
+
+static int32_t markZeroDivisor(const double *right, double rval, int32_t numOfRows, uint8_t *nullMask) {
+  if (right == NULL) {
+    if (!IS_ZERO_DIVISOR(rval)) {
+      return 0;
+    }
+
+    memset(nullMask, 1, numOfRows);
+    return numOfRows;
+  }
+
+  int32_t num = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    uint8_t z = IS_ZERO_DIVISOR(right[i]);
+    nullMask[i] |= z;
+    num += z;
+  }
+
+  return num;
+}
+
+/*
+ * Apply the operator to two double vectors, either one may be replaced by a constant. A divisor of zero yields a
+ * null value as the per-row operators above do, so the rows are marked in nullMask, which must be initialized by
+ * the caller. Return the number of rows marked.
+ */
+int32_t vectorArithmeticDouble(int32_t optr, const double *left, double lval, const double *right, double rval,
+                               int32_t numOfRows, double *output, uint8_t *nullMask) {
+  int32_t num = 0;
+
+  // the output may share the buffer of an operand, so the divisors are checked before they are overwritten
+  switch (optr) {
+    case TSDB_BINARY_OP_ADD:
+      VECTOR_ARITHMETIC_DOUBLE(l + r);
+      return 0;
+    case TSDB_BINARY_OP_SUBTRACT:
+      VECTOR_ARITHMETIC_DOUBLE(l - r);
+      return 0;
+    case TSDB_BINARY_OP_MULTIPLY:
+      VECTOR_ARITHMETIC_DOUBLE(l * r);
+      return 0;
+    case TSDB_BINARY_OP_DIVIDE:
+      num = markZeroDivisor(right, rval, numOfRows, nullMask);
+      VECTOR_ARITHMETIC_DOUBLE(l / r);
+      return num;
+    case TSDB_BINARY_OP_REMAINDER:
+      num = markZeroDivisor(right, rval, numOfRows, nullMask);
+      VECTOR_ARITHMETIC_DOUBLE(IS_ZERO_DIVISOR(r) ? 0 : l - ((int64_t)(l / r)) * r);
+      return num;
+    default:
+      assert(0);
+      return 0;
+  }
+}
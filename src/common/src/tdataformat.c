@@ -327,6 +327,46 @@ static void dataColSetNEleNull(SDataCol *pCol, int nEle) {
   }
 }
 
+/**
+ * Append nEle values of pSrc from row offset to pCol, which holds numOfRows values now. The values of a column with
+ * fixed length are copied in one block, binary and nchar values are copied in one block with their offsets rebased.
+ */
+int dataColAppendRange(SDataCol *pCol, SDataCol *pSrc, int offset, int nEle, int numOfRows, int maxPoints) {
+  ASSERT(pCol->type == pSrc->type && nEle > 0 && numOfRows + nEle <= maxPoints);
+
+  if (isAllRowsNull(pSrc)) {
+    if (isAllRowsNull(pCol)) return 0;
+    for (int i = 0; i < nEle; i++) {
+      dataColSetNullAt(pCol, numOfRows + i);
+    }
+    return 0;
+  }
+
+  if (isAllRowsNull(pCol)) {
+    if (tdAllocMemForCol(pCol, maxPoints) < 0) return -1;
+    if (numOfRows > 0) dataColSetNEleNull(pCol, numOfRows);
+  }
+
+  if (IS_VAR_DATA_TYPE(pCol->type)) {
+    VarDataOffsetT start = pSrc->dataOff[offset];
+    VarDataOffsetT last = pSrc->dataOff[offset + nEle - 1];
+    int            len = last - start + varDataTLen(POINTER_SHIFT(pSrc->pData, last));
+
+    for (int i = 0; i < nEle; i++) {
+      pCol->dataOff[numOfRows + i] = pCol->len + (pSrc->dataOff[offset + i] - start);
+    }
+    memcpy(POINTER_SHIFT(pCol->pData, pCol->len), POINTER_SHIFT(pSrc->pData, start), len);
+    pCol->len += len;
+  } else {
+    ASSERT(pCol->len == TYPE_BYTES[pCol->type] * numOfRows);
+    memcpy(POINTER_SHIFT(pCol->pData, pCol->len), POINTER_SHIFT(pSrc->pData, TYPE_BYTES[pCol->type] * offset),
+           TYPE_BYTES[pCol->type] * nEle);
+    pCol->len += TYPE_BYTES[pCol->type] * nEle;
+  }
+
+  return 0;
+}
+
 void dataColSetOffset(SDataCol *pCol, int nEle) {
   ASSERT(((pCol->type == TSDB_DATA_TYPE_BINARY) || (pCol->type == TSDB_DATA_TYPE_NCHAR)));
 
@@ -281,6 +281,222 @@ void arithmeticTreeTraverse(tExprNode *pExprs, int32_t numOfRows, char *pOutput,
   tfree(pRightOutput);
 }
 
+typedef struct SArithmeticStep {
+  int16_t     optr;    // 0 for loading a column into the output register
+  int16_t     type;    // column type of the load step
+  int16_t     colId;
+  const char *name;
+  int16_t     output;  // register of the result
+  int16_t     left;    // register of the left operand, -1 for the constant lval
+  int16_t     right;   // register of the right operand, -1 for the constant rval
+  double      lval;
+  double      rval;
+} SArithmeticStep;
+
+struct SArithmeticProgram {
+  SArithmeticStep *steps;
+  int32_t          numOfSteps;
+  int32_t          numOfRegs;
+  int32_t          capacity;  // number of rows each register can hold
+  double          *regs;
+  uint8_t         *nullMasks;
+  bool            *hasNull;
+};
+
+/*
+ * Emit the steps of a subtree in post order. The registers are used as a stack: the result of a subtree evaluated
+ * at depth d is kept in register d, so the program needs as many registers as the depth of the tree.
+ * Return 1 if the result is in a register, 0 if the subtree is a constant kept in val, or -1 if it is not supported.
+ */
+static int32_t compileArithmeticNode(SArithmeticProgram *pProgram, tExprNode *pNode, int16_t depth, double *val) {
+  if (pNode->nodeType == TSQL_NODE_VALUE) {
+    if (!IS_NUMERIC_TYPE(pNode->pVal->nType)) {
+      return -1;
+    }
+
+    GET_TYPED_DATA(*val, double, pNode->pVal->nType, &pNode->pVal->i64);
+    return 0;
+  }
+
+  SArithmeticStep step = {0};
+  step.output = depth;
+
+  if (pNode->nodeType == TSQL_NODE_COL) {
+    if (!IS_NUMERIC_TYPE(pNode->pSchema->type)) {
+      return -1;
+    }
+
+    step.type  = pNode->pSchema->type;
+    step.colId = pNode->pSchema->colId;
+    step.name  = pNode->pSchema->name;
+  } else if (pNode->nodeType == TSQL_NODE_EXPR && IS_ARITHMETIC_OPTR(pNode->_node.optr)) {
+    int32_t ret = compileArithmeticNode(pProgram, pNode->_node.pLeft, depth, &step.lval);
+    if (ret < 0) {
+      return -1;
+    }
+
+    step.left = (ret == 1) ? depth : -1;
+
+    int16_t rdepth = (ret == 1) ? depth + 1 : depth;
+    ret = compileArithmeticNode(pProgram, pNode->_node.pRight, rdepth, &step.rval);
+    if (ret < 0) {
+      return -1;
+    }
+
+    step.right = (ret == 1) ? rdepth : -1;
+    step.optr  = pNode->_node.optr;
+  } else {
+    return -1;
+  }
+
+  SArithmeticStep *steps = realloc(pProgram->steps, (pProgram->numOfSteps + 1) * sizeof(SArithmeticStep));
+  if (steps == NULL) {
+    return -1;
+  }
+
+  pProgram->steps = steps;
+  pProgram->steps[pProgram->numOfSteps++] = step;
+  pProgram->numOfRegs = MAX(pProgram->numOfRegs, depth + 1);
+  return 1;
+}
+
+SArithmeticProgram *arithmeticProgramCompile(tExprNode *pExprs) {
+  if (pExprs == NULL || pExprs->nodeType != TSQL_NODE_EXPR) {
+    return NULL;
+  }
+
+  SArithmeticProgram *pProgram = calloc(1, sizeof(SArithmeticProgram));
+  if (pProgram == NULL) {
+    return NULL;
+  }
+
+  double val = 0;
+  if (compileArithmeticNode(pProgram, pExprs, 0, &val) != 1) {
+    arithmeticProgramDestroy(pProgram);
+    return NULL;
+  }
+
+  pProgram->hasNull = calloc(pProgram->numOfRegs, sizeof(bool));
+  if (pProgram->hasNull == NULL) {
+    arithmeticProgramDestroy(pProgram);
+    return NULL;
+  }
+
+  return pProgram;
+}
+
+static int32_t ensureArithmeticRegs(SArithmeticProgram *pProgram, int32_t numOfRows) {
+  if (numOfRows <= pProgram->capacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  double  *regs = realloc(pProgram->regs, (size_t)pProgram->numOfRegs * numOfRows * sizeof(double));
+  if (regs == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+  pProgram->regs = regs;
+
+  uint8_t *masks = realloc(pProgram->nullMasks, (size_t)pProgram->numOfRegs * numOfRows);
+  if (masks == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+  pProgram->nullMasks = masks;
+
+  pProgram->capacity = numOfRows;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * Evaluate the program on a block of rows, the result is a double vector in ascending order, the same as what
+ * arithmeticTreeTraverse produces. The null masks of the operands are merged separately from the arithmetic and the
+ * null values are only written into the output at the end.
+ */
+int32_t arithmeticProgramExec(SArithmeticProgram *pProgram, int32_t numOfRows, char *pOutput, void *param,
+                              int32_t order, char *(*getSourceDataBlock)(void *, const char *, int32_t)) {
+  if (numOfRows <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = ensureArithmeticRegs(pProgram, numOfRows);
+  if (code != TSDB_CODE_SUCCESS) {
+    terrno = code;
+    return -1;
+  }
+
+  for (int32_t i = 0; i < pProgram->numOfSteps; ++i) {
+    SArithmeticStep *pStep = &pProgram->steps[i];
+
+    // the last step writes into the output buffer directly
+    double  *out = (i == pProgram->numOfSteps - 1) ? (double *)pOutput : pProgram->regs + (size_t)pStep->output * numOfRows;
+    uint8_t *mask = pProgram->nullMasks + (size_t)pStep->output * numOfRows;
+
+    if (pStep->optr == 0) {
+      char *pInputData = getSourceDataBlock(param, pStep->name, pStep->colId);
+      pProgram->hasNull[pStep->output] = vectorLoadDouble(pInputData, pStep->type, numOfRows, order, out, mask) > 0;
+      continue;
+    }
+
+    const double *left = NULL, *right = NULL;
+    bool          leftNull = false, rightNull = false;
+
+    if (pStep->left >= 0) {
+      left = pProgram->regs + (size_t)pStep->left * numOfRows;
+      leftNull = pProgram->hasNull[pStep->left];
+    }
+
+    if (pStep->right >= 0) {
+      right = pProgram->regs + (size_t)pStep->right * numOfRows;
+      rightNull = pProgram->hasNull[pStep->right];
+    }
+
+    if (leftNull && rightNull) {
+      const uint8_t *lmask = pProgram->nullMasks + (size_t)pStep->left * numOfRows;
+      const uint8_t *rmask = pProgram->nullMasks + (size_t)pStep->right * numOfRows;
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        mask[j] = lmask[j] | rmask[j];
+      }
+    } else if (leftNull) {
+      if (pStep->left != pStep->output) {
+        memcpy(mask, pProgram->nullMasks + (size_t)pStep->left * numOfRows, numOfRows);
+      }
+    } else if (rightNull) {
+      if (pStep->right != pStep->output) {
+        memcpy(mask, pProgram->nullMasks + (size_t)pStep->right * numOfRows, numOfRows);
+      }
+    } else {
+      memset(mask, 0, numOfRows);
+    }
+
+    int32_t num = vectorArithmeticDouble(pStep->optr, left, pStep->lval, right, pStep->rval, numOfRows, out, mask);
+    pProgram->hasNull[pStep->output] = leftNull || rightNull || num > 0;
+  }
+
+  int16_t result = pProgram->steps[pProgram->numOfSteps - 1].output;
+  if (pProgram->hasNull[result]) {
+    const uint8_t *mask = pProgram->nullMasks + (size_t)result * numOfRows;
+    double        *out = (double *)pOutput;
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      if (mask[j]) {
+        SET_DOUBLE_NULL(&out[j]);
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+void arithmeticProgramDestroy(SArithmeticProgram *pProgram) {
+  if (pProgram == NULL) {
+    return;
+  }
+
+  tfree(pProgram->steps);
+  tfree(pProgram->regs);
+  tfree(pProgram->nullMasks);
+  tfree(pProgram->hasNull);
+  tfree(pProgram);
+}
+
 static void exprTreeToBinaryImpl(SBufferWriter* bw, tExprNode* expr) {
   tbufWriteUint8(bw, expr->nodeType);
   
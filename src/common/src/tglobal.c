@@ -52,11 +52,17 @@ int64_t  tsDnodeStartTime = 0;
 int32_t tsRpcTimer = 300;
 int32_t tsRpcMaxTime = 600;  // seconds;
 int32_t tsRpcForceTcp = 0;   // disable this, means query, show command use udp protocol as default
+int32_t tsRpcMuxConns = 0;   // number of TCP connections shared by all requests to an end point, 0: disabled
 int32_t tsMaxShellConns = 50000;
 int32_t tsMaxConnections = 5000;
 int32_t tsShellActivityTimer = 3;  // second
 float   tsNumOfThreadsPerCore = 1.0f;
 int32_t tsNumOfCommitThreads = 4;
+int32_t tsNumOfFSetCommitThreads = 1;
+int8_t  tsColumnarMemTable = 0;
+int32_t tsBlockCacheSize = 0;  // MB per vnode
+int32_t tsQueryPrefetchBlocks = 4;
+int32_t tsMaxTagIndexes = 4;
 float   tsRatioOfQueryCores = 1.0f;
 int8_t  tsDaylight = 0;
 char    tsTimezone[TSDB_TIMEZONE_LEN] = {0};
@@ -75,6 +81,11 @@ int32_t tsMaxBinaryDisplayWidth = 30;
  */
 int32_t tsCompressMsgSize = -1;
 
+// codec of the compressed rpc messages, 1: lz4, 2: deflate, 3: adaptive by message type
+int32_t tsRpcCompressAlgo = 1;
+int32_t tsRpcCompressLevel = 1;      // compression level of deflate
+int32_t tsRpcCompressMinSpeed = 32;  // MB/s, the adaptive codec does not choose a slower codec
+
 /* denote if server needs to compress the retrieved column data before adding to the rpc response message body.
  * 0: all data are compressed
  * -1: all data are not compressed
@@ -127,6 +138,24 @@ int64_t tsQueryBufferSizeBytes = -1;
 // in retrieve blocking model, the retrieve threads will wait for the completion of the query processing.
 int32_t tsRetrieveBlockingModel = 0;
 
+// number of result blocks that the query thread builds ahead of the retrieve requests of a query, 0 disables it.
+// It is ignored in retrieve blocking model.
+int32_t tsRetrievePrefetchBlocks = 0;
+
+// number of worker threads that aggregate the table groups of one super table query in parallel, 1 disables it
+int32_t tsQueryParallelThreads = 1;
+
+// memory in MB for the groups of a group by query on a super table, the rows of the groups that do not fit in are
+// partitioned into disk files and aggregated afterwards one partition at a time, 0 disables it
+int32_t tsGroupbySpillBufferSize = 10;
+
+// memory in MB for the rows of an order by query on the client, the rows beyond it are sorted into runs on disk and
+// merged afterwards, 0 disables it
+int32_t tsSortBufferSize = 64;
+
+// number of threads that sort the rows of an order by query in parallel
+int32_t tsSortParallelThreads = 4;
+
 // last_row(*), first(*), last_row(ts, col1, col2) query, the result fields will be the original column name
 int8_t tsKeepOriginalColumnName = 0;
 
@@ -142,6 +171,7 @@ int32_t tsTimePrecision = TSDB_DEFAULT_PRECISION;
 int8_t  tsCompression = TSDB_DEFAULT_COMP_LEVEL;
 int8_t  tsWAL = TSDB_DEFAULT_WAL_LEVEL;
 int32_t tsFsyncPeriod = TSDB_DEFAULT_FSYNC_PERIOD;
+int32_t tsWalGroupCommitSize = 0;  // KB per vnode
 int32_t tsReplications = TSDB_DEFAULT_DB_REPLICA_OPTION;
 int32_t tsQuorum = TSDB_DEFAULT_DB_QUORUM_OPTION;
 int16_t tsPartitons = TSDB_DEFAULT_DB_PARTITON_OPTION;
@@ -159,6 +189,13 @@ bool    tsdbForceKeepFile = false;
 bool    tsdbForceCompactFile = false;                    // compact TSDB fileset forcibly
 int32_t tsdbWalFlushSize = TSDB_DEFAULT_WAL_FLUSH_SIZE;  // MB
 
+// sync
+int32_t tsSyncFwdBatchSize = 262144;  // forwards to a peer are coalesced into one write up to this size
+int32_t tsSyncFwdWindow = 8;       // number of unacknowledged forward batches in flight to a peer
+int32_t tsSyncRecoveryNum = 2;     // number of vnodes restored from their masters at the same time on a dnode
+int32_t tsSyncFileRate = 0;        // MB/s, files streamed to the vnodes restored on a dnode, 0 for no limit
+int32_t tsSyncWalRate = 0;         // MB/s, wal streamed to the vnodes restored on a dnode, 0 for no limit
+
 // balance
 int8_t  tsEnableBalance = 1;
 int8_t  tsAlternativeRole = 0;
@@ -567,6 +604,56 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "numOfFSetCommitThreads";
+  cfg.ptr = &tsNumOfFSetCommitThreads;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG;
+  cfg.minValue = 1;
+  cfg.maxValue = 100;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "columnarMemTable";
+  cfg.ptr = &tsColumnarMemTable;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 1;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "blockCacheSize";
+  cfg.ptr = &tsBlockCacheSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "queryPrefetchBlocks";
+  cfg.ptr = &tsQueryPrefetchBlocks;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 256;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "maxTagIndexes";
+  cfg.ptr = &tsMaxTagIndexes;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = TSDB_MAX_TAGS;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "ratioOfQueryCores";
   cfg.ptr = &tsRatioOfQueryCores;
   cfg.valType = TAOS_CFG_VTYPE_FLOAT;
@@ -709,6 +796,16 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "rpcMuxConns";
+  cfg.ptr = &tsRpcMuxConns;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "statusInterval";
   cfg.ptr = &tsStatusInterval;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -930,6 +1027,16 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "walGroupCommitSize";
+  cfg.ptr = &tsWalGroupCommitSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 65536;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "replica";
   cfg.ptr = &tsReplications;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -1020,6 +1127,36 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "rpcCompressAlgo";
+  cfg.ptr = &tsRpcCompressAlgo;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 3;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "rpcCompressLevel";
+  cfg.ptr = &tsRpcCompressLevel;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 9;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "rpcCompressMinSpeed";
+  cfg.ptr = &tsRpcCompressMinSpeed;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 100000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
   cfg.option = "compressColData";
   cfg.ptr = &tsCompressColData;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -1090,6 +1227,56 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "retrievePrefetchBlocks";
+  cfg.ptr = &tsRetrievePrefetchBlocks;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "queryParallelThreads";
+  cfg.ptr = &tsQueryParallelThreads;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "groupbySpillBufferSize";
+  cfg.ptr = &tsGroupbySpillBufferSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 2047;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "sortBufferSize";
+  cfg.ptr = &tsSortBufferSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 2047;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "sortParallelThreads";
+  cfg.ptr = &tsSortParallelThreads;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 1;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "keepColumnName";
   cfg.ptr = &tsKeepOriginalColumnName;
   cfg.valType = TAOS_CFG_VTYPE_INT8;
@@ -1701,6 +1888,56 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_MB;
   taosInitConfigOption(cfg);
 
+  cfg.option = "syncFwdBatchSize";
+  cfg.ptr = &tsSyncFwdBatchSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 67108864;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_BYTE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "syncFwdWindow";
+  cfg.ptr = &tsSyncFwdWindow;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "syncRecoveryNum";
+  cfg.ptr = &tsSyncRecoveryNum;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "syncFileRate";
+  cfg.ptr = &tsSyncFileRate;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 4000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "syncWalRate";
+  cfg.ptr = &tsSyncWalRate;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 4000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
 #ifdef TD_TSZ
   // lossy compress
   cfg.option = "lossyColumns";
@@ -214,12 +214,18 @@ static void *dnodeProcessVWriteQueue(void *wparam) {
       dTrace("msg:%p is processed in vwrite queue, code:0x%x", pWrite, pWrite->code);
     }
 
-    walFsync(vnodeGetWal(pVnode), forceFsync);
+    // the forwards of the batch go to the replicas together, while the records are synced locally
+    vnodeFlushForward(pVnode);
+
+    // the records of the batch are written out and synced together, on failure those from failedVer on are not durable
+    uint64_t failedVer = 0;
+    int32_t  walCode = walFsync(vnodeGetWal(pVnode), forceFsync, &failedVer);
 
     // browse all items, and process them one by one
     taosResetQitems(pWorker->qall);
     for (int32_t i = 0; i < numOfMsgs; ++i) {
       taosGetQitem(pWorker->qall, &qtype, (void **)&pWrite);
+      if (walCode != 0 && pWrite->code == 0 && pWrite->walHead.version >= failedVer) pWrite->code = walCode;
       if (qtype == TAOS_QTYPE_RPC) {
         dnodeSendRpcVWriteRsp(pVnode, pWrite, pWrite->code);
       } else {
@@ -243,7 +243,8 @@ static void dnodeSendStatusMsg(void *handle, void *tmrId) {
     return;
   }
 
-  int32_t contLen = sizeof(SStatusMsg) + TSDB_MAX_VNODES * sizeof(SVnodeLoad);
+  int32_t contLen =
+      sizeof(SStatusMsg) + TSDB_MAX_VNODES * (sizeof(SVnodeLoad) + sizeof(SVnodeStat)) + sizeof(SVnodeStatMsg);
   SStatusMsg *pStatus = rpcMallocCont(contLen);
   if (pStatus == NULL) {
     taosTmrReset(dnodeSendStatusMsg, tsStatusInterval * 1000, NULL, tsDnodeTmr, &tsStatusTimer);
@@ -282,6 +283,7 @@ static void dnodeSendStatusMsg(void *handle, void *tmrId) {
 
   vnodeBuildStatusMsg(pStatus);
   contLen = sizeof(SStatusMsg) + pStatus->openVnodes * sizeof(SVnodeLoad);
+  contLen += vnodeBuildStatMsg(pStatus);
   pStatus->openVnodes = htons(pStatus->openVnodes);
 
   SRpcMsg rpcMsg = {
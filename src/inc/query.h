@@ -54,13 +54,28 @@ int32_t qRetrieveQueryResultInfo(qinfo_t qinfo, bool* buildRes, void* pRspContex
  *
  * Retrieve the actual results to fill the response message payload.
  * Note that this function must be executed after qRetrieveQueryResultInfo is invoked.
+ * The result prefetched by the query thread is returned first if there is any.
  *
  * @param qinfo  qinfo object
  * @param pRsp    response message
  * @param contLen payload length
+ * @param continueExec the qhandle needs to be put into the read queue to continue the query
+ * @param completed    no more results to retrieve, the qhandle can be freed
  * @return
  */
-int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp** pRsp, int32_t* contLen, bool* continueExec);
+int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp** pRsp, int32_t* contLen, bool* continueExec,
+                            bool* completed);
+
+/**
+ * Build the result of the paused query into the prefetch queue if no retrieve request is waiting for it,
+ * the query thread goes on to produce the next result ahead of the retrieve requests.
+ *
+ * @param qinfo
+ * @param buildRes     a retrieve request reaches during the building, the prefetched result should be returned to it
+ * @param continueExec the prefetch queue is not full, the qhandle needs to be put into the read queue again
+ * @return  true if the result is built into the prefetch queue
+ */
+bool qPrefetchQueryResult(qinfo_t qinfo, bool* buildRes, bool* continueExec);
 
 /**
  *
@@ -83,6 +98,13 @@ bool qSolveCommitNoBlock(void* pRepo, void* pMgmt);
 
 int32_t qQueryCompleted(qinfo_t qinfo);
 
+/**
+ * add the time that the query messages spent in the vnode read queue to the cost of query
+ * @param qinfo
+ * @param waitTime  in microseconds
+ */
+void qAddReadQueueWaitTime(qinfo_t qinfo, int64_t waitTime);
+
 /**
  * destroy query info structure
  * @param qHandle
@@ -235,6 +235,7 @@ do { \
 #define TSDB_SHOW_SQL_LEN         512
 #define TSDB_SHOW_SUBQUERY_LEN    1000
 #define TSDB_SLOW_QUERY_SQL_LEN   512
+#define TSDB_OPERATOR_NAME_LEN    64
 
 #define TSDB_STEP_NAME_LEN        32
 #define TSDB_STEP_DESC_LEN        128
@@ -382,6 +383,7 @@ do { \
 #define TSDB_QUERY_TYPE_FILE_INSERT            0x400u    // insert data from file
 #define TSDB_QUERY_TYPE_STMT_INSERT            0x800u    // stmt insert type
 #define TSDB_QUERY_TYPE_NEST_SUBQUERY          0x1000u   // nested sub query
+#define TSDB_QUERY_TYPE_EXPLAIN                0x2000u   // collect the execution profile, for explain analyze
 
 #define TSDB_QUERY_HAS_TYPE(x, _type)          (((x) & (_type)) != 0)
 #define TSDB_QUERY_SET_TYPE(x, _type)          ((x) |= (_type))
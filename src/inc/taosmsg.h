@@ -490,7 +490,7 @@ typedef struct {
   int16_t     numOfGroupCols;   // num of group by columns
   int16_t     orderByIdx;
   int16_t     orderType;        // used in group by xx order by xxx
-  int64_t     vgroupLimit;      // limit the number of rows for each table, used in order by + limit in stable projection query.
+  int64_t     vgroupLimit;      // limit the number of rows for each vgroup, used in order by + limit in stable projection query.
   int16_t     prjOrder;         // global order in super table projection query.
   int64_t     limit;
   int64_t     offset;
@@ -534,6 +534,31 @@ typedef struct SRetrieveTableRsp {
   char    data[];
 } SRetrieveTableRsp;
 
+// the execution profile of one operator, the operators of a query are sent in the pre-order of the operator tree
+typedef struct SQueryProfileOperator {
+  char    name[TSDB_OPERATOR_NAME_LEN];
+  int16_t level;          // depth in the operator tree, 0 for the root operator
+  int64_t numOfCalls;
+  int64_t rowsIn;
+  int64_t rowsOut;
+  int64_t elapsedTime;    // in us, including the time spent in the upstream operators
+  int64_t dataBlocks;     // blocks loaded from the .data files
+  int64_t lastBlocks;     // blocks loaded from the .last files
+  int64_t cacheBlocks;    // blocks built from the rows in cache
+  int64_t decompSize;     // bytes of column data decompressed
+  int64_t smaHits;        // blocks answered or discarded by the block statistics without loading data
+  int64_t queueWaitTime;  // in us, spent by the query messages in the vnode read queue
+} SQueryProfileOperator;
+
+#define TSDB_QUERY_PROFILE_MAGIC 0x464f5250  // "PROF"
+
+// ends the last retrieve response of an explain analyze query, right after the SQueryProfileOperator array, so that
+// the layout of SRetrieveTableRsp is left unchanged
+typedef struct SQueryProfileTail {
+  int32_t  profLen;  // length of the SQueryProfileOperator array before the tail
+  uint32_t magic;    // TSDB_QUERY_PROFILE_MAGIC
+} SQueryProfileTail;
+
 typedef struct {
   int32_t  vgId;
   int32_t  dbCfgVersion;
@@ -548,6 +573,26 @@ typedef struct {
   uint8_t  compact;
 } SVnodeLoad;
 
+// Statistics of the vnodes, appended to SStatusMsg after load[] in the same order. A receiver takes the first
+// MIN(statLen, sizeof(SVnodeStat)) bytes of each, so that dnodes and mnodes of different builds can talk.
+typedef struct {
+  int32_t  vgId;
+  int64_t  blkCacheSize;
+  int64_t  blkCacheHits;
+  int64_t  blkCacheMisses;
+  int64_t  blkCacheEvicts;
+  int8_t   syncState;  // ESyncRecovery
+  int32_t  syncRank;
+  int64_t  syncLag;
+} SVnodeStat;
+
+typedef struct {
+  uint16_t statLen;     // size of each stat of the sender
+  uint16_t numOfStats;
+  int32_t  reserved;
+  char     stats[];
+} SVnodeStatMsg;
+
 typedef struct {
   char     db[TSDB_ACCT_ID_LEN + TSDB_DB_NAME_LEN];
   int32_t  cacheBlockSize; //MB
@@ -193,6 +193,7 @@ typedef struct {
   SList *      bufBlockList;
   int64_t      pointsAdd;   // TODO
   int64_t      storageAdd;  // TODO
+  int64_t      colBufSize;  // bytes of the column buffers of the tables, allocated out of the buffer pool
 } SMemTable;
 
 typedef struct {
@@ -245,6 +246,13 @@ typedef struct {
   SArray   *dataBlockInfos;
 } STableBlockDist;
 
+typedef struct {
+  int64_t dataBlocks;   // blocks loaded from the .data files
+  int64_t lastBlocks;   // blocks loaded from the .last files
+  int64_t cacheBlocks;  // blocks built from the rows in mem/imem
+  int64_t decompSize;   // bytes of column data decompressed from the loaded file blocks
+} STsdbQueryCost;
+
 /**
  * Get the data block iterator, starting from position according to the query condition
  *
@@ -385,6 +393,13 @@ int32_t tsdbGetTableGroupFromIdList(STsdbRepo *tsdb, SArray *pTableIdList, STabl
  */
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle);
 
+/**
+ * add the io cost of the query handle to pCost, used by the EXPLAIN ANALYZE query
+ * @param queryHandle
+ * @param pCost
+ */
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost *pCost);
+
 void tsdbResetQueryHandle(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond);
 
 void tsdbResetQueryHandleForNewTable(TsdbQueryHandleT queryHandle, STsdbQueryCond *pCond, STableGroupInfo* groupList);
@@ -400,6 +415,26 @@ int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist
  */
 void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int64_t *compStorage);
 
+/**
+ * get the bytes of data files in the tsdb
+ * @param repo. point to the tsdbrepo
+ */
+int64_t tsdbGetDataSize(STsdbRepo *repo);
+
+typedef struct {
+  int64_t size;  // bytes of decompressed columns cached
+  int64_t hits;
+  int64_t misses;
+  int64_t evicts;
+} STsdbBlkCacheStat;
+
+/**
+ * get the statistics of the decompressed block cache of repo, all zero if the cache is disabled
+ * @param repo. point to the tsdbrepo
+ * @param pStat. the statistics returned
+ */
+void tsdbReportBlkCacheStat(void *repo, STsdbBlkCacheStat *pStat);
+
 int  tsdbInitCommitQueue();
 void tsdbDestroyCommitQueue();
 int  tsdbSyncCommit(STsdbRepo *repo);
@@ -408,7 +443,7 @@ void tsdbDecCommitRef(int vgId);
 
 // For TSDB file sync
 int tsdbSyncSend(void *pRepo, SOCKET socketFd);
-int tsdbSyncRecv(void *pRepo, SOCKET socketFd);
+int tsdbSyncRecv(void *pRepo, SOCKET socketFd, int32_t caps);
 
 // For TSDB Compact
 int tsdbCompact(STsdbRepo *pRepo);
@@ -38,6 +38,15 @@ typedef enum {
   TAOS_SYNC_STATUS_CACHE = 3
 } ESyncStatus;
 
+typedef enum {
+  TAOS_SYNC_RECOVERY_NONE   = 0,
+  TAOS_SYNC_RECOVERY_QUEUED = 1,
+  TAOS_SYNC_RECOVERY_START  = 2,
+  TAOS_SYNC_RECOVERY_FILE   = 3,
+  TAOS_SYNC_RECOVERY_WAL    = 4,
+  TAOS_SYNC_RECOVERY_CACHE  = 5
+} ESyncRecovery;
+
 typedef struct {
   uint32_t  nodeId;    // node ID assigned by TDengine
   uint16_t  nodePort;  // node sync Port
@@ -50,6 +59,12 @@ typedef struct {
   SNodeInfo  nodeInfo[TAOS_SYNC_MAX_REPLICA];
 } SSyncCfg;
 
+typedef struct {
+  int8_t   state;  // ESyncRecovery
+  int32_t  rank;   // position in the recovery queue, 0 if not queued
+  uint64_t lag;    // versions still to be recovered from master
+} SSyncRecoveryInfo;
+
 typedef struct {
   int32_t  selfIndex;
   uint32_t nodeId[TAOS_SYNC_MAX_REPLICA];
@@ -79,8 +94,14 @@ typedef void     (*FStopSyncFile)(int32_t vgId, uint64_t fversion);
 // get file version
 typedef int32_t  (*FGetVersion)(int32_t vgId, uint64_t *fver, uint64_t *vver);
 
+// get the size of local data, used to order the recoveries, may be NULL
+typedef int64_t  (*FGetDataSize)(int32_t vgId);
+
+// capabilities of the master sending the files, an old master announces none
+#define TAOS_SYNC_CAP_FILE_DIFF 0x1  // able to send the blocks of a file not found in the local file of the slave
+
 typedef int32_t  (*FSendFile)(void *tsdb, SOCKET socketFd);
-typedef int32_t  (*FRecvFile)(void *tsdb, SOCKET socketFd);
+typedef int32_t  (*FRecvFile)(void *tsdb, SOCKET socketFd, int32_t caps);
 
 typedef struct {
   int32_t  vgId;       // vgroup ID
@@ -96,6 +117,7 @@ typedef struct {
   FStartSyncFile    startSyncFileFp;
   FStopSyncFile     stopSyncFileFp;
   FGetVersion       getVersionFp;
+  FGetDataSize      getDataSizeFp;
   FSendFile         sendFileFp;
   FRecvFile         recvFileFp;
 } SSyncInfo;
@@ -109,11 +131,14 @@ int64_t syncStart(const SSyncInfo *);
 void    syncStop(int64_t rid);
 int32_t syncReconfig(int64_t rid, const SSyncCfg *);
 int32_t syncForwardToPeer(int64_t rid, void *pHead, void *mhandle, int32_t qtype, bool force);
+void    syncFlushForward(int64_t rid);  // send the forwards coalesced by syncForwardToPeer
 void    syncConfirmForward(int64_t rid, uint64_t version, int32_t code, bool force);
 void    syncRecover(int64_t rid);  // recover from other nodes:
 int32_t syncGetNodesRole(int64_t rid, SNodesRole *);
+int32_t syncGetRecoveryInfo(int64_t rid, SSyncRecoveryInfo *);
 
 extern char *syncRole[];
+extern char *syncRecovery[];
 
 //global configurable parameters
 extern int32_t  sDebugFlag;
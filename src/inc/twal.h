@@ -43,11 +43,22 @@ typedef struct {
 
 typedef struct {
   int32_t  vgId;
-  int32_t  fsyncPeriod;  // millisecond
-  EWalType walLevel;     // wal level
-  EWalKeep keep;         // keep the wal file when closed
+  int32_t  fsyncPeriod;      // millisecond
+  EWalType walLevel;         // wal level
+  EWalKeep keep;             // keep the wal file when closed
+  int32_t  groupCommitSize;  // bytes to gather the records until walFsync, 0 to write each record through
 } SWalCfg;
 
+// progress of walRestore, the records are read and validated ahead of being applied
+typedef struct {
+  int64_t totalBytes;    // size of the wal files to restore
+  int64_t readBytes;     // bytes of the records read and validated
+  int64_t appliedBytes;  // bytes of the records applied
+  int64_t records;       // number of the records applied
+  int64_t startMs;
+  int64_t elapsedMs;
+} SWalRestoreStat;
+
 typedef void *  twalh;  // WAL HANDLE
 typedef int32_t FWalWrite(void *ahandle, void *pHead, int32_t qtype, void *pMsg);
 
@@ -61,12 +72,13 @@ int32_t  walRenew(twalh);
 void     walRemoveOneOldFile(twalh);
 void     walRemoveAllOldFiles(twalh);
 int32_t  walWrite(twalh, SWalHead *);
-void     walFsync(twalh, bool forceFsync);
+int32_t  walFsync(twalh, bool forceFsync, uint64_t *pFailedVer);
 int32_t  walRestore(twalh, void *pVnode, FWalWrite writeFp);
 int32_t  walGetWalFile(twalh, char *fileName, int64_t *fileId);
 uint64_t walGetVersion(twalh);
 void     walResetVersion(twalh, uint64_t newVer);
 int64_t  walGetFSize(twalh);
+void     walGetRestoreStat(twalh, SWalRestoreStat *pStat);
 
 #ifdef __cplusplus
 }
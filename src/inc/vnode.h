@@ -37,6 +37,7 @@ typedef struct {
   void *  pVnode;
   int8_t  qtype;
   int8_t  msgType;
+  int64_t enqueueTs;  // in us, the time when the msg is put into the read queue
   SRspRet rspRet;
   char    pCont[];
 } SVReadMsg;
@@ -73,6 +74,7 @@ void*   vnodeAcquireNotClose(int32_t vgId);
 void*   vnodeGetWal(void *pVnode);
 int32_t vnodeGetVnodeList(int32_t vnodeList[], int32_t *numOfVnodes);
 void    vnodeBuildStatusMsg(void *pStatus);
+int32_t vnodeBuildStatMsg(void *pStatus);
 void    vnodeSetAccess(SVgroupAccess *pAccess, int32_t numOfVnodes);
 
 // vnodeWrite
@@ -82,6 +84,7 @@ int32_t vnodeProcessWrite(void *pVnode, void *pHead, int32_t qtype, void *pRspRe
 
 // vnodeSync
 void    vnodeConfirmForward(void *pVnode, uint64_t version, int32_t code, bool force);
+void    vnodeFlushForward(void *pVnode);
 
 // vnodeRead
 int32_t vnodeWriteToRQueue(void *pVnode, void *pCont, int32_t contLen, int8_t qtype, void *rparam);
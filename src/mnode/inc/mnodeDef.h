@@ -132,6 +132,19 @@ typedef struct {
   SDnodeObj *pDnode;
 } SVnodeGid;
 
+typedef struct {
+  int64_t size;
+  int64_t hits;
+  int64_t misses;
+  int64_t evicts;
+} SVnodeBlkCacheStat;
+
+typedef struct {
+  int8_t  state;  // ESyncRecovery
+  int32_t rank;
+  int64_t lag;
+} SVnodeRecoveryStat;
+
 typedef struct SVgObj {
   uint32_t       vgId;
   int32_t        numOfVnodes;
@@ -153,6 +166,8 @@ typedef struct SVgObj {
   int64_t        totalStorage;
   int64_t        compStorage;
   int64_t        pointsWritten;
+  SVnodeBlkCacheStat blkCacheStat[TSDB_MAX_REPLICA];  // reported by each vnode of the group
+  SVnodeRecoveryStat recoveryStat[TSDB_MAX_REPLICA];  // reported by each vnode of the group
   struct SDbObj *pDb;
   void *         idPool;
 } SVgObj;
@@ -521,6 +521,39 @@ static void mnodeUpdateDnodeEps() {
   pthread_mutex_unlock(&tsDnodeEpsMutex);
 }
 
+// The vnode stats appended after load[], NULL if the dnode does not send them
+static SVnodeStatMsg *mnodeGetVnodeStatMsg(SMnodeMsg *pMsg, int32_t openVnodes) {
+  int32_t offset = (int32_t)(sizeof(SStatusMsg) + openVnodes * sizeof(SVnodeLoad));
+  if (pMsg->rpcMsg.contLen < offset + (int32_t)sizeof(SVnodeStatMsg)) return NULL;
+
+  SVnodeStatMsg *pStatMsg = (SVnodeStatMsg *)((char *)pMsg->rpcMsg.pCont + offset);
+  pStatMsg->statLen = htons(pStatMsg->statLen);
+  pStatMsg->numOfStats = htons(pStatMsg->numOfStats);
+
+  if (pStatMsg->statLen < sizeof(int32_t) || pStatMsg->numOfStats != openVnodes ||
+      pMsg->rpcMsg.contLen < offset + (int32_t)sizeof(SVnodeStatMsg) + openVnodes * pStatMsg->statLen) {
+    mDebug("msg:%p, invalid vnode stats, statLen:%d numOfStats:%d openVnodes:%d contLen:%d", pMsg,
+           pStatMsg->statLen, pStatMsg->numOfStats, openVnodes, pMsg->rpcMsg.contLen);
+    return NULL;
+  }
+
+  return pStatMsg;
+}
+
+// Fields the sender does not know are left 0
+static void mnodeGetVnodeStat(SVnodeStatMsg *pStatMsg, int32_t index, SVnodeStat *pStat) {
+  memset(pStat, 0, sizeof(SVnodeStat));
+  memcpy(pStat, pStatMsg->stats + index * pStatMsg->statLen, MIN(pStatMsg->statLen, (int32_t)sizeof(SVnodeStat)));
+
+  pStat->vgId = htonl(pStat->vgId);
+  pStat->blkCacheSize = htobe64(pStat->blkCacheSize);
+  pStat->blkCacheHits = htobe64(pStat->blkCacheHits);
+  pStat->blkCacheMisses = htobe64(pStat->blkCacheMisses);
+  pStat->blkCacheEvicts = htobe64(pStat->blkCacheEvicts);
+  pStat->syncRank = htonl(pStat->syncRank);
+  pStat->syncLag = htobe64(pStat->syncLag);
+}
+
 static int32_t mnodeProcessDnodeStatusMsg(SMnodeMsg *pMsg) {
   SDnodeObj *pDnode     = NULL;
   SStatusMsg *pStatus   = pMsg->rpcMsg.pCont;
@@ -595,6 +628,7 @@ static int32_t mnodeProcessDnodeStatusMsg(SMnodeMsg *pMsg) {
   pRsp->dnodeCfg.numOfVnodes = htonl(openVnodes);
   tstrncpy(pRsp->dnodeCfg.clusterId, mnodeGetClusterId(), TSDB_CLUSTER_ID_LEN);
   SVgroupAccess *pAccess = (SVgroupAccess *)((char *)pRsp + sizeof(SStatusRsp));
+  SVnodeStatMsg *pStatMsg = mnodeGetVnodeStatMsg(pMsg, openVnodes);
   
   for (int32_t j = 0; j < openVnodes; ++j) {
     SVnodeLoad *pVload = &pStatus->load[j];
@@ -603,13 +637,20 @@ static int32_t mnodeProcessDnodeStatusMsg(SMnodeMsg *pMsg) {
     pVload->vgCfgVersion = htonl(pVload->vgCfgVersion);
     pVload->vnodeVersion = htobe64(pVload->vnodeVersion);
 
+    SVnodeStat  vstat;
+    SVnodeStat *pVstat = NULL;
+    if (pStatMsg != NULL) {
+      mnodeGetVnodeStat(pStatMsg, j, &vstat);
+      if (vstat.vgId == pVload->vgId) pVstat = &vstat;
+    }
+
     SVgObj *pVgroup = mnodeGetVgroup(pVload->vgId);
     if (pVgroup == NULL) {
       SRpcEpSet epSet = mnodeGetEpSetFromIp(pDnode->dnodeEp);
       mInfo("dnode:%d, vgId:%d not exist in mnode, drop it", pDnode->dnodeId, pVload->vgId);
       mnodeSendDropVnodeMsg(pVload->vgId, &epSet, NULL);
     } else {
-      mnodeUpdateVgroupStatus(pVgroup, pDnode, pVload);
+      mnodeUpdateVgroupStatus(pVgroup, pDnode, pVload, pVstat);
       pAccess->vgId = htonl(pVload->vgId);
       pAccess->accessState = pVgroup->accessState;
       pAccess++;
@@ -1197,6 +1238,48 @@ static int32_t mnodeGetVnodeMeta(STableMetaMsg *pMeta, SShowObj *pShow, void *pC
   pSchema[cols].bytes = htons(pShow->bytes[cols]);
   cols++;
 
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "blk_cache_size");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "blk_cache_hits");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "blk_cache_misses");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "blk_cache_evicts");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 8 + VARSTR_HEADER_SIZE;
+  pSchema[cols].type = TSDB_DATA_TYPE_BINARY;
+  strcpy(pSchema[cols].name, "sync_state");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 4;
+  pSchema[cols].type = TSDB_DATA_TYPE_INT;
+  strcpy(pSchema[cols].name, "sync_rank");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
+  pShow->bytes[cols] = 8;
+  pSchema[cols].type = TSDB_DATA_TYPE_BIGINT;
+  strcpy(pSchema[cols].name, "sync_lag");
+  pSchema[cols].bytes = htons(pShow->bytes[cols]);
+  cols++;
+
   pMeta->numOfColumns = htons(cols);
   pShow->numOfColumns = cols;
 
@@ -1255,6 +1338,38 @@ static int32_t mnodeRetrieveVnodes(SShowObj *pShow, char *data, int32_t rows, vo
           pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
           STR_TO_VARSTR(pWrite, syncRole[pVgid->role]);
           cols++;
+
+          SVnodeBlkCacheStat *pStat = &pVgroup->blkCacheStat[i];
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int64_t *)pWrite = pStat->size;
+          cols++;
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int64_t *)pWrite = pStat->hits;
+          cols++;
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int64_t *)pWrite = pStat->misses;
+          cols++;
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int64_t *)pWrite = pStat->evicts;
+          cols++;
+
+          SVnodeRecoveryStat *pRecovery = &pVgroup->recoveryStat[i];
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          STR_TO_VARSTR(pWrite, syncRecovery[pRecovery->state]);
+          cols++;
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int32_t *)pWrite = pRecovery->rank;
+          cols++;
+
+          pWrite = data + pShow->offset[cols] * rows + pShow->bytes[cols] * numOfRows;
+          *(int64_t *)pWrite = pRecovery->lag;
+          cols++;
           numOfRows++;
           
         }
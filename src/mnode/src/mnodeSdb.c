@@ -1134,7 +1134,8 @@ static void *sdbWorkerFp(void *pWorker) {
       sdbTrace("vgId:1, msg:%p is processed in sdb queue, code:%x", pRow->pMsg, pRow->code);
     }
 
-    walFsync(tsSdbMgmt.wal, true);
+    syncFlushForward(tsSdbMgmt.sync);
+    walFsync(tsSdbMgmt.wal, true, NULL);
 
     // browse all items, and process them one by one
     taosResetQitems(tsSdbWQall);
@@ -1166,7 +1167,7 @@ int32_t mnodeCompactWal() {
   sdbInfo("vgId:1, start compact mnode wal...");
 
   // close old wal
-  walFsync(tsSdbMgmt.wal, true);
+  walFsync(tsSdbMgmt.wal, true, NULL);
   walClose(tsSdbMgmt.wal);
 
   // reset version,then compacted wal log can start from version 1
@@ -1186,7 +1187,7 @@ int32_t mnodeCompactWal() {
   }
 
   // close sdb and sync to disk
-  //walFsync(tsSdbMgmt.wal, true);
+  //walFsync(tsSdbMgmt.wal, true, NULL);
   //walClose(tsSdbMgmt.wal);
   sdbCleanUp();
 
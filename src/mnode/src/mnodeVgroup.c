@@ -315,7 +315,7 @@ void mnodeCheckUnCreatedVgroup(SDnodeObj *pDnode, SVnodeLoad *pVloads, int32_t o
   mnodeCancelGetNextVgroup(pIter);
 }
 
-void mnodeUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVload) {
+void mnodeUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVload, SVnodeStat *pVstat) {
   bool dnodeExist = false;
   for (int32_t i = 0; i < pVgroup->numOfVnodes; ++i) {
     SVnodeGid *pVgid = &pVgroup->vnodeGid[i];
@@ -324,6 +324,18 @@ void mnodeUpdateVgroupStatus(SVgObj *pVgroup, SDnodeObj *pDnode, SVnodeLoad *pVl
              pDnode->dnodeId, syncRole[pVload->role], syncRole[pVgid->role], pVload->vnodeVersion);
       pVgid->role = pVload->role;
       mnodeSetVgidVer(pVgid->vver, pVload->vnodeVersion);
+      if (pVstat != NULL) {
+        pVgroup->blkCacheStat[i].size = pVstat->blkCacheSize;
+        pVgroup->blkCacheStat[i].hits = pVstat->blkCacheHits;
+        pVgroup->blkCacheStat[i].misses = pVstat->blkCacheMisses;
+        pVgroup->blkCacheStat[i].evicts = pVstat->blkCacheEvicts;
+        pVgroup->recoveryStat[i].state = pVstat->syncState;
+        pVgroup->recoveryStat[i].rank = pVstat->syncRank;
+        pVgroup->recoveryStat[i].lag = pVstat->syncLag;
+      } else {
+        memset(&pVgroup->blkCacheStat[i], 0, sizeof(SVnodeBlkCacheStat));
+        memset(&pVgroup->recoveryStat[i], 0, sizeof(SVnodeRecoveryStat));
+      }
       if (pVload->role == TAOS_SYNC_ROLE_MASTER) {
         pVgroup->inUse = i;
       }
@@ -371,6 +371,8 @@ int32_t taosFsync(FileFd fd) {
   return FlushFileBuffers(h);
 }
 
+int32_t taosReadAhead(FileFd fd, int64_t offset, int64_t count) { return 0; }
+
 int32_t taosRename(char *oldName, char *newName) {
   int32_t code = MoveFileEx(oldName, newName, MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED);
   if (code < 0) {
@@ -387,6 +389,16 @@ int32_t taosRename(char *oldName, char *newName) {
 int32_t taosFtruncate(FileFd fd, int64_t length) { return ftruncate(fd, length); }
 int32_t taosFsync(FileFd fd) { return fsync(fd); }
 
+// Start reading the range into the page cache in background, without waiting for the io
+int32_t taosReadAhead(FileFd fd, int64_t offset, int64_t count) {
+#if defined(_TD_DARWIN_64)
+  struct radvisory ra = {.ra_offset = offset, .ra_count = (int)count};
+  return fcntl(fd, F_RDADVISE, &ra);
+#else
+  return posix_fadvise(fd, offset, count, POSIX_FADV_WILLNEED);
+#endif
+}
+
 int32_t taosRename(char *oldName, char *newName) {
   int32_t code = rename(oldName, newName);
   if (code < 0) {
@@ -135,6 +135,9 @@ typedef struct SArithmeticSupport {
   void        *exprList;   // client side used
   int32_t      offset;
   char**       data;
+
+  struct SArithmeticProgram *pProgram;  // compiled from pProgramSrc on first use, NULL if not supported
+  struct tExprNode          *pProgramSrc;
 } SArithmeticSupport;
 
 typedef struct SQLPreAggVal {
@@ -229,6 +232,9 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
                           int16_t *len, int32_t *interBytes, int16_t extLength, bool isSuperTable, SUdfInfo* pUdfInfo);
 int32_t isValidFunction(const char* name, int32_t len);
 
+bool isMergeableSTableResult(int32_t functionId);
+void mergeSTableResult(int32_t functionId, int16_t colType, int16_t colBytes, char *pDst, const char *pSrc);
+
 #define IS_STREAM_QUERY_VALID(x)  (((x)&TSDB_FUNCSTATE_STREAM) != 0)
 #define IS_MULTIOUTPUT(x)         (((x)&TSDB_FUNCSTATE_MO) != 0)
 #define IS_SINGLEOUTPUT(x)        (((x)&TSDB_FUNCSTATE_SO) != 0)
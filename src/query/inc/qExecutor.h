@@ -18,9 +18,12 @@
 #include "os.h"
 
 #include "hash.h"
+#include "tfixedhash.h"
 #include "qAggMain.h"
 #include "qFill.h"
 #include "qResultbuf.h"
+#include "qSort.h"
+#include "qSpillbuf.h"
 #include "qSqlparser.h"
 #include "qTableMeta.h"
 #include "qTsbuf.h"
@@ -182,12 +185,15 @@ typedef struct SQueryCostInfo {
   uint32_t loadBlocks;
   uint32_t loadBlockStatis;
   uint32_t discardBlocks;
+  uint32_t statisHitBlocks;  // blocks answered or discarded by the block statistics (SMA) without loading data
   uint64_t elapsedTime;
   uint64_t firstStageMergeTime;
   uint64_t winInfoSize;
   uint64_t tableInfoSize;
   uint64_t hashSize;
   uint64_t numOfTimeWindows;
+  uint64_t queueWaitTime;   // time spent by the query messages waiting in the vnode read queue, in us
+  STsdbQueryCost ioCost;    // io cost of the tsdb query handles already released, e.g., of the query workers
 
   SArray*   queryProfEvents;  //SArray<SQueryProfEvent>
   SHashObj* operatorProfResults; //map<operator_type, SQueryProfEvent>
@@ -281,6 +287,13 @@ typedef void (*__optr_cleanup_fn_t)(void* param, int32_t num);
 
 struct SOperatorInfo;
 
+typedef struct SOperatorCost {
+  __operator_fn_t exec;         // the original exec function of the operator that is being profiled
+  int64_t         numOfCalls;
+  int64_t         rowsOut;
+  int64_t         elapsedTime;  // in us, including the time spent in the upstream operators
+} SOperatorCost;
+
 typedef struct SQueryRuntimeEnv {
   jmp_buf               env;
   SQueryAttr*           pQueryAttr;
@@ -351,6 +364,8 @@ enum OPERATOR_TYPE_E {
   OP_AllTimeWindow     = 23,
   OP_AllMultiTableTimeInterval = 24,
   OP_Order             = 25,
+  OP_ParallelAggregate = 26,   // table groups of a super table aggregated by several worker threads
+  OP_TopN              = 27,   // top rows of the ordered projection on a vnode, kept in a bounded heap
 };
 
 typedef struct SOperatorInfo {
@@ -367,13 +382,21 @@ typedef struct SOperatorInfo {
   int32_t               numOfUpstream;  // number of upstream. The value is always ONE expect for join operator
   __operator_fn_t       exec;
   __optr_cleanup_fn_t   cleanup;
+  SOperatorCost         cost;           // execution profile, only collected for explain analyze
 } SOperatorInfo;
 
 enum {
   QUERY_RESULT_NOT_READY = 1,
   QUERY_RESULT_READY     = 2,
+  QUERY_RESULT_PREFETCH  = 3,  // the result is being built into the prefetch queue by the query thread
 };
 
+typedef struct SPrefetchRsp {
+  SRetrieveTableRsp *pRsp;
+  int32_t            contLen;
+  bool               continueExec;  // more results are produced after this one
+} SPrefetchRsp;
+
 typedef struct {
   int32_t      numOfTags;
   int32_t      numOfCols;
@@ -394,6 +417,9 @@ typedef struct SQInfo {
   tsem_t           ready;
   int32_t          dataReady;   // denote if query result is ready or not
   void*            rspContext;  // response context
+  SArray*          pPrefetchRsp;   // SPrefetchRsp, results built ahead of the retrieve requests, NULL if disabled
+  bool             prefetchPaused; // query is paused since the prefetch queue is full
+  bool             explain;     // collect the execution profile of operators for explain analyze
   int64_t          startExecTs; // start to exec timestamp
   int64_t          lastRetrieveTs; // last retrieve timestamp  
   char*            sql;         // query sql string
@@ -471,6 +497,32 @@ typedef struct SAggOperatorInfo {
   uint32_t       seed;
 } SAggOperatorInfo;
 
+struct SParallelAggOperatorInfo;
+
+typedef struct SQueryWorker {
+  SQInfo       qinfo;        // private query info of the worker, the runtime env inside it owns the tsdb query handle
+  pthread_t    thread;
+  bool         started;
+  int32_t      code;
+  int32_t      startGroup;   // table groups [startGroup, endGroup) are aggregated by the worker
+  int32_t      endGroup;
+  int32_t      startTable;   // tables [startTable, endTable) of the group, if the only group of the query is split
+  int32_t      endTable;
+  SArray      *pTableList;   // SArray<STableQueryInfo*>, tables of the split group aggregated by the worker
+  SArray      *pResBlocks;   // SArray<SSDataBlock*>, results of the worker copied out of its result buffer
+  struct SParallelAggOperatorInfo *pParent;
+} SQueryWorker;
+
+typedef struct SParallelAggOperatorInfo {
+  int32_t          opType;        // operator run by each worker, OP_MultiTableAggregate or OP_MultiTableTimeInterval
+  bool             splitGroup;    // the tables of the only group are split, the results of workers need to be merged
+  int32_t          numOfRunning;  // number of workers not finished yet
+  pthread_mutex_t  mutex;
+  pthread_cond_t   finished;
+  SArray          *pResBlocks;    // SArray<SSDataBlock*>, results of all workers in the order of table groups
+  int32_t          resIndex;
+} SParallelAggOperatorInfo;
+
 typedef struct SProjectOperatorInfo {
   SOptrBasicInfo binfo;
   int32_t        bufCapacity;
@@ -518,10 +570,20 @@ typedef struct SFillOperatorInfo {
   bool         multigroupResult;
 } SFillOperatorInfo;
 
+typedef struct SGroupbySpill {
+  SSpillBuf     *pSpillBuf;
+  int32_t        partition;  // next partition to aggregate
+} SGroupbySpill;
+
 typedef struct SGroupbyOperatorInfo {
   SOptrBasicInfo binfo;
   int32_t        colIndex;
   char          *prevData;   // previous group by value
+  SFixedHashObj *pGroupSet;  // result rows of the groups if the group by column is of a fixed width
+  int32_t        maxGroups;  // groups aggregated in memory at the same time, 0 for no limit, -1 if not decided yet
+  int32_t        spillLevel; // partition level of the rows that are spilled in current round
+  SSpillBuf     *pSpillBuf;  // rows of the groups beyond maxGroups in current round
+  SArray        *pSpillList; // SArray<SGroupbySpill>, the spilled rows to aggregate, NULL until the input is exhausted
 } SGroupbyOperatorInfo;
 
 typedef struct SSWindowOperatorInfo {
@@ -550,7 +612,7 @@ typedef struct SDistinctDataInfo {
 } SDistinctDataInfo; 
 
 typedef struct SDistinctOperatorInfo {
-  SHashObj         *pSet;
+  SFixedHashObj    *pSet;
   SSDataBlock      *pRes;
   bool              recordNullVal;  //has already record the null value, no need to try again
   int64_t           threshold;
@@ -582,13 +644,29 @@ typedef struct SMultiwayMergeInfo {
   bool                 multiGroupResults;
 } SMultiwayMergeInfo;
 
-// todo support the disk-based sort
 typedef struct SOrderOperatorInfo {
   int32_t      colIndex;
   int32_t      order;
-  SSDataBlock *pDataBlock;
+  SSDataBlock *pDataBlock;   // rows that are not sorted yet
+  int32_t      maxRows;      // rows kept in memory before sorted into a run on disk, 0 if no limit
+  int32_t     *pIndex;       // rows of pDataBlock in sorted order
+  SArray      *pSources;     // SSortSource, the runs to merge
+  SSortMerger *pMerger;
+  SSDataBlock *pRes;
 } SOrderOperatorInfo;
 
+typedef struct STopNOperatorInfo {
+  int32_t      colIndex;
+  int32_t      order;
+  int64_t      limit;        // rows to keep at most
+  SSDataBlock *pDataBlock;   // rows in the heap
+  int32_t      capacity;     // rows allocated in pDataBlock, grows up to the limit
+  int32_t     *pHeap;        // row index of pDataBlock, the root is the last one in order
+  int32_t      numOfRows;    // rows in the heap
+  int32_t      outputIdx;    // rows in pHeap that are returned, pHeap is in order after the heap sort
+  SSDataBlock *pRes;
+} STopNOperatorInfo;
+
 void appendUpstream(SOperatorInfo* p, SOperatorInfo* pUpstream);
 
 SOperatorInfo* createDataBlocksOptScanInfo(void* pTsdbQueryHandle, SQueryRuntimeEnv* pRuntimeEnv, int32_t repeatTime, int32_t reverseTime);
@@ -605,6 +683,7 @@ SOperatorInfo* createFillOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorIn
 SOperatorInfo* createGroupbyOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput);
 SOperatorInfo* createMultiTableAggOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput);
 SOperatorInfo* createMultiTableTimeIntervalOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput);
+SOperatorInfo* createParallelAggOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, int32_t opType);
 SOperatorInfo* createAllMultiTableTimeIntervalOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput);
 SOperatorInfo* createTagScanOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SExprInfo* pExpr, int32_t numOfOutput);
 SOperatorInfo* createDistinctOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput);
@@ -619,6 +698,7 @@ SOperatorInfo* createFilterOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperator
 
 SOperatorInfo* createJoinOperatorInfo(SOperatorInfo** pUpstream, int32_t numOfUpstream, SSchema* pSchema, int32_t numOfOutput);
 SOperatorInfo* createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal);
+SOperatorInfo* createTopNOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal, int64_t limit);
 
 SSDataBlock* doGlobalAggregate(void* param, bool* newgroup);
 SSDataBlock* doMultiwayMergeSort(void* param, bool* newgroup);
@@ -686,6 +766,8 @@ void publishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType e
 void publishQueryAbortEvent(SQInfo* pQInfo, int32_t code);
 void calculateOperatorProfResults(SQInfo* pQInfo);
 void queryCostStatis(SQInfo *pQInfo);
+void setQueryExplain(SQInfo *pQInfo);
+SArray* createQueryProfile(SQInfo *pQInfo);
 
 void freeQInfo(SQInfo *pQInfo);
 void freeQueryAttr(SQueryAttr *pQuery);
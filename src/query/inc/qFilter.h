@@ -22,6 +22,7 @@ extern "C" {
 
 #include "texpr.h"
 #include "hash.h"
+#include "tbitmap.h"
 #include "tname.h"
 
 #define FILTER_DEFAULT_GROUP_SIZE 4
@@ -113,6 +114,8 @@ typedef bool (*rangeCompFunc) (const void *, const void *, const void *, const v
 typedef int32_t(*filter_desc_compare_func)(const void *, const void *);
 typedef bool(*filter_exec_func)(void *, int32_t, int8_t**, SDataStatis *, int16_t);
 typedef int32_t (*filer_get_col_from_id)(void *, int32_t, void **);
+// Look up the ids whose column colId is val in an index, set *ids to NULL if none. Return false if not indexed.
+typedef bool (*filter_index_lookup_func)(void *param, int16_t colId, const void *val, const SBitmap **ids);
 
 typedef struct SFilterRangeCompare {
   int64_t s;
@@ -340,6 +343,7 @@ extern void filterFreeInfo(SFilterInfo *info);
 extern bool filterRangeExecute(SFilterInfo *info, SDataStatis *pDataStatis, int32_t numOfCols, int32_t numOfRows);
 extern int32_t filterIsIndexedColumnQuery(SFilterInfo* info, int32_t idxId, bool *res);
 extern int32_t filterGetIndexedColumnInfo(SFilterInfo* info, char** val, int32_t *order, int32_t *flag);
+extern int32_t filterGetIndexCandidates(SFilterInfo* info, void *param, filter_index_lookup_func fp, SBitmap **res);
 
 #ifdef __cplusplus
 }
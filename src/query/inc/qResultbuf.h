@@ -31,6 +31,7 @@ typedef struct SArray* SIDList;
 typedef struct SPageDiskInfo {
   int32_t offset;
   int32_t length;
+  bool    compressed;     // the page is written in compressed form
 } SPageDiskInfo;
 
 typedef struct SPageInfo {
@@ -47,11 +48,13 @@ typedef struct SFreeListItem {
 } SFreeListItem;
 
 typedef struct SResultBufStatis {
-  int32_t flushBytes;
-  int32_t loadBytes;
+  int64_t flushBytes;     // bytes of the pages flushed to disk, before compression
+  int64_t writeBytes;     // bytes written to disk
+  int64_t loadBytes;
   int32_t getPages;
   int32_t releasePages;
   int32_t flushPages;
+  int32_t compPages;      // pages written in compressed form
 } SResultBufStatis;
 
 typedef struct SDiskbasedResultBuf {
@@ -70,6 +73,7 @@ typedef struct SDiskbasedResultBuf {
   void*     assistBuf;           // assistant buffer for compress/decompress data
   SArray*   pFree;               // free area in file
   bool      comp;                // compressed before flushed to disk
+  int32_t   compSkip;            // pages flushed without compression before trying it again
   int32_t   nextPos;             // next page flush position
 
   uint64_t  qId;                 // for debug purpose
@@ -77,7 +81,7 @@ typedef struct SDiskbasedResultBuf {
 } SDiskbasedResultBuf;
 
 #define DEFAULT_INTERN_BUF_PAGE_SIZE  (1024L)                          // in bytes
-#define PAGE_INFO_INITIALIZER         (SPageDiskInfo){-1, -1}
+#define PAGE_INFO_INITIALIZER         (SPageDiskInfo){-1, -1, false}
 
 /**
  * create disk-based result buffer
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QSORT_H
+#define TDENGINE_QSORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+#include "qSpillbuf.h"
+#include "tarray.h"
+#include "tlosertree.h"
+
+struct SSDataBlock;
+
+/*
+ * External merge sort of data blocks by a single key column.
+ * The rows that fit in memory are split into slices that are sorted in parallel, a radix sort is used for the
+ * fixed width keys. When the rows are more than the memory allows, the sorted slices are merged into a run that is
+ * written to disk, and all the runs are merged at last by a loser tree, one output block at a time.
+ */
+typedef struct SSortSource {
+  SSpillBuf          *pSpillBuf;  // the run on disk, NULL if the run is in memory
+  struct SSDataBlock *pBlock;     // rows of the in memory run, or the block of the run that is read from disk
+  int32_t            *pIndex;     // rows of the in memory run in sorted order, NULL for the run on disk
+  int32_t             numOfRows;  // rows in pIndex, or in pBlock
+  int32_t             rowIdx;     // the current row, -1 if the source is exhausted
+} SSortSource;
+
+typedef struct SSortMerger {
+  SArray          *pSources;      // SSortSource
+  SLoserTreeInfo  *pTree;
+  int32_t          colIndex;
+  __compar_fn_t    comparFn;
+} SSortMerger;
+
+/**
+ * number of the slices that are sorted in parallel for the given rows
+ * @param numOfRows
+ * @param numOfThreads
+ * @return
+ */
+int32_t sortGetNumOfSlices(int32_t numOfRows, int32_t numOfThreads);
+
+/**
+ * sort the rows of the block by the key column. The rows are split into numOfSlices slices with about the same
+ * number of rows, slice i covers [numOfRows * i / numOfSlices, numOfRows * (i + 1) / numOfSlices) of pIndex, and the
+ * slices are sorted each in its own thread. pIndex keeps the row index of the block in sorted order of every slice.
+ * @param pBlock
+ * @param colIndex
+ * @param order
+ * @param numOfSlices
+ * @param pIndex
+ * @return
+ */
+int32_t sortBlockSlices(struct SSDataBlock* pBlock, int32_t colIndex, int32_t order, int32_t numOfSlices,
+                        int32_t* pIndex);
+
+/**
+ * add the sorted slices of the block as in memory sources
+ * @param pSources
+ * @param pBlock
+ * @param numOfSlices
+ * @param pIndex
+ */
+void sortAddSliceSources(SArray* pSources, struct SSDataBlock* pBlock, int32_t numOfSlices, int32_t* pIndex);
+
+/**
+ * add the run on disk as a source, the source owns the run afterwards
+ * @param pSources
+ * @param pSpillBuf
+ * @return
+ */
+int32_t sortAddRunSource(SArray* pSources, SSpillBuf* pSpillBuf);
+
+/**
+ * create the merger of the sources, the merger owns the sources and the runs on disk
+ * @param pMerger
+ * @param pSources
+ * @param colIndex
+ * @param order
+ * @param type     data type of the key column
+ * @return
+ */
+int32_t sortMergerCreate(SSortMerger** pMerger, SArray* pSources, int32_t colIndex, int32_t order, int32_t type);
+
+/**
+ * append the rows in sorted order to pDest until it has capacity rows or all the sources are exhausted
+ * @param pMerger
+ * @param pDest    the columns are the same as the sources
+ * @param capacity
+ * @return
+ */
+int32_t sortMergerNext(SSortMerger* pMerger, struct SSDataBlock* pDest, int32_t capacity);
+
+/**
+ * merge the sources into a new run on disk, the sources are destroyed afterwards
+ * @param pSources
+ * @param pBuf     block to stage the rows, the columns are the same as the sources
+ * @param capacity rows of pBuf
+ * @param colIndex
+ * @param order
+ * @param type
+ * @param qId
+ * @param pRun
+ * @return
+ */
+int32_t sortMergeToRun(SArray* pSources, struct SSDataBlock* pBuf, int32_t capacity, int32_t colIndex, int32_t order,
+                       int32_t type, uint64_t qId, SSpillBuf** pRun);
+
+void sortMergerDestroy(SSortMerger* pMerger);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QSORT_H
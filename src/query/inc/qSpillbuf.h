@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QSPILLBUF_H
+#define TDENGINE_QSPILLBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+#include "taosmsg.h"
+
+struct SSDataBlock;
+
+/*
+ * Rows of the input data blocks that are partitioned by the hash value of the group by key and written
+ * into one temporary file per partition, so a partition can be aggregated later on its own.
+ * Rows are buffered column by column for each partition and flushed as a run, every run keeps the rows of
+ * a single tag (the table that the rows come from), which is handed back when the run is read again.
+ * If comp is set, each column of a run is compressed by LZ4 before written.
+ */
+typedef struct SSpillPartition {
+  FILE    *file;
+  char    *path;
+  int64_t  numOfRows;     // rows in this partition, including the rows in the write buffer
+  int32_t  numOfBufRows;  // rows in the write buffer
+  int64_t  bufTag;        // tag of the rows in the write buffer
+  char    *pBuf;          // write buffer, capacity rows for each column
+} SSpillPartition;
+
+typedef struct SSpillBuf {
+  int32_t             level;            // partition level, a partition that overflows again is split into the next level
+  int32_t             numOfPartitions;
+  int32_t             numOfCols;
+  int32_t             capacity;         // rows of a run
+  SColumnInfo        *pCols;
+  int32_t            *offset;           // offset of each column in the write buffer
+  SSpillPartition    *pPartitions;
+  struct SSDataBlock *pBlock;           // data block for the runs that are read back
+  int64_t             numOfRows;        // total rows spilled
+  int64_t             fileSize;         // total bytes written to the disk files
+  bool                comp;             // compress the runs
+  char               *pCompBuf;         // buffer for the compressed column of a run
+  uint64_t            qId;
+} SSpillBuf;
+
+/**
+ * create the spill buffer, the columns of all the appended blocks are the same as the template block
+ * @param pTemplate
+ * @param numOfPartitions
+ * @param level
+ * @param qId
+ * @return
+ */
+SSpillBuf* createSpillBuf(struct SSDataBlock* pTemplate, int32_t numOfPartitions, int32_t level, uint64_t qId);
+
+/**
+ * append the rows in [start, start + num) of the block to the partition
+ * @param pSpillBuf
+ * @param partition
+ * @param pBlock
+ * @param start
+ * @param num
+ * @param tag
+ * @return
+ */
+int32_t spillBufAppend(SSpillBuf* pSpillBuf, int32_t partition, struct SSDataBlock* pBlock, int32_t start, int32_t num,
+                       int64_t tag);
+
+/**
+ * flush the write buffer of the partition and rewind it to read the runs from the beginning
+ * @param pSpillBuf
+ * @param partition
+ * @return
+ */
+int32_t spillBufBeginRead(SSpillBuf* pSpillBuf, int32_t partition);
+
+/**
+ * read the next run of the partition, the returned block is owned by the spill buffer and valid until next call
+ * @param pSpillBuf
+ * @param partition
+ * @param tag      the tag of the run
+ * @param pBlock   the run, or NULL if no run is left
+ * @return
+ */
+int32_t spillBufReadNext(SSpillBuf* pSpillBuf, int32_t partition, int64_t* tag, struct SSDataBlock** pBlock);
+
+/**
+ * remove the disk file of the partition, when all its runs have been read
+ * @param pSpillBuf
+ * @param partition
+ */
+void spillBufRemovePartition(SSpillBuf* pSpillBuf, int32_t partition);
+
+/**
+ *
+ * @param pSpillBuf
+ * @param partition
+ * @return
+ */
+static FORCE_INLINE int64_t spillBufGetNumOfRows(SSpillBuf* pSpillBuf, int32_t partition) {
+  return pSpillBuf->pPartitions[partition].numOfRows;
+}
+
+/**
+ * remove all the disk files and release the memory
+ * @param pSpillBuf
+ */
+void destroySpillBuf(SSpillBuf* pSpillBuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QSPILLBUF_H
@@ -83,6 +83,7 @@ SResultRowPool* initResultRowPool(size_t size);
 SResultRow* getNewResultRow(SResultRowPool* p);
 int64_t getResultRowPoolMemSize(SResultRowPool* p);
 void* destroyResultRowPool(SResultRowPool* p);
+void resetResultRowPool(SResultRowPool* p);
 int32_t getNumOfAllocatedResultRows(SResultRowPool* p);
 int32_t getNumOfUsedResultRows(SResultRowPool* p);
 
@@ -466,6 +466,110 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * The super table results of a vnode are the intermediate results of the functions. Those of the functions below are
+ * small fixed structures, so the results of the same group computed from different tables of the group can be merged
+ * into one on the vnode, before the secondary merge at the client.
+ */
+bool isMergeableSTableResult(int32_t functionId) {
+  return functionId == TSDB_FUNC_COUNT || functionId == TSDB_FUNC_SUM || functionId == TSDB_FUNC_AVG ||
+         functionId == TSDB_FUNC_MIN || functionId == TSDB_FUNC_MAX || functionId == TSDB_FUNC_SPREAD;
+}
+
+#define MERGE_MINMAX_VAL(_t, _dst, _src, _isMin)                      \
+  do {                                                                \
+    _t _v = *(_t *)(_src);                                            \
+    if ((_isMin) ? (_v < *(_t *)(_dst)) : (_v > *(_t *)(_dst))) {     \
+      *(_t *)(_dst) = _v;                                             \
+    }                                                                 \
+  } while (0)
+
+static void mergeMinMaxSTableResult(int16_t colType, int16_t colBytes, char *pDst, const char *pSrc, bool isMin) {
+  if (pSrc[colBytes] != DATA_SET_FLAG) {
+    return;
+  }
+
+  if (pDst[colBytes] != DATA_SET_FLAG) {
+    memcpy(pDst, pSrc, colBytes + DATA_SET_FLAG_SIZE);
+    return;
+  }
+
+  switch (colType) {
+    case TSDB_DATA_TYPE_TINYINT:   MERGE_MINMAX_VAL(int8_t, pDst, pSrc, isMin);   break;
+    case TSDB_DATA_TYPE_SMALLINT:  MERGE_MINMAX_VAL(int16_t, pDst, pSrc, isMin);  break;
+    case TSDB_DATA_TYPE_INT:       MERGE_MINMAX_VAL(int32_t, pDst, pSrc, isMin);  break;
+    case TSDB_DATA_TYPE_BIGINT:    MERGE_MINMAX_VAL(int64_t, pDst, pSrc, isMin);  break;
+    case TSDB_DATA_TYPE_UTINYINT:  MERGE_MINMAX_VAL(uint8_t, pDst, pSrc, isMin);  break;
+    case TSDB_DATA_TYPE_USMALLINT: MERGE_MINMAX_VAL(uint16_t, pDst, pSrc, isMin); break;
+    case TSDB_DATA_TYPE_UINT:      MERGE_MINMAX_VAL(uint32_t, pDst, pSrc, isMin); break;
+    case TSDB_DATA_TYPE_UBIGINT:   MERGE_MINMAX_VAL(uint64_t, pDst, pSrc, isMin); break;
+    case TSDB_DATA_TYPE_FLOAT:     MERGE_MINMAX_VAL(float, pDst, pSrc, isMin);    break;
+    case TSDB_DATA_TYPE_DOUBLE:    MERGE_MINMAX_VAL(double, pDst, pSrc, isMin);   break;
+    default:
+      assert(0);
+  }
+}
+
+/*
+ * merge the intermediate super table result in pSrc into the one in pDst, the colType and colBytes are those of the
+ * column that the function applies on
+ */
+void mergeSTableResult(int32_t functionId, int16_t colType, int16_t colBytes, char *pDst, const char *pSrc) {
+  switch (functionId) {
+    case TSDB_FUNC_COUNT: {
+      *(int64_t *)pDst += *(int64_t *)pSrc;
+      break;
+    }
+    case TSDB_FUNC_SUM: {
+      SSumInfo *pDstInfo = (SSumInfo *)pDst;
+      SSumInfo *pSrcInfo = (SSumInfo *)pSrc;
+      if (pSrcInfo->hasResult != DATA_SET_FLAG) {
+        break;
+      }
+
+      if (pDstInfo->hasResult != DATA_SET_FLAG) {
+        *pDstInfo = *pSrcInfo;
+      } else if (IS_SIGNED_NUMERIC_TYPE(colType)) {
+        pDstInfo->isum += pSrcInfo->isum;
+      } else if (IS_UNSIGNED_NUMERIC_TYPE(colType)) {
+        pDstInfo->usum += pSrcInfo->usum;
+      } else {
+        SET_DOUBLE_VAL(&pDstInfo->dsum, pDstInfo->dsum + pSrcInfo->dsum);
+      }
+      break;
+    }
+    case TSDB_FUNC_AVG: {
+      SAvgInfo *pDstInfo = (SAvgInfo *)pDst;
+      SAvgInfo *pSrcInfo = (SAvgInfo *)pSrc;
+      SET_DOUBLE_VAL(&pDstInfo->sum, pDstInfo->sum + pSrcInfo->sum);
+      pDstInfo->num += pSrcInfo->num;
+      break;
+    }
+    case TSDB_FUNC_MIN:
+    case TSDB_FUNC_MAX: {
+      mergeMinMaxSTableResult(colType, colBytes, pDst, pSrc, functionId == TSDB_FUNC_MIN);
+      break;
+    }
+    case TSDB_FUNC_SPREAD: {
+      SSpreadInfo *pDstInfo = (SSpreadInfo *)pDst;
+      SSpreadInfo *pSrcInfo = (SSpreadInfo *)pSrc;
+      if (pSrcInfo->hasResult != DATA_SET_FLAG) {
+        break;
+      }
+
+      if (pDstInfo->hasResult != DATA_SET_FLAG) {
+        *pDstInfo = *pSrcInfo;
+      } else {
+        SET_DOUBLE_VAL(&pDstInfo->min, MIN(pDstInfo->min, pSrcInfo->min));
+        SET_DOUBLE_VAL(&pDstInfo->max, MAX(pDstInfo->max, pSrcInfo->max));
+      }
+      break;
+    }
+    default:
+      assert(0);
+  }
+}
+
 // TODO use hash table
 int32_t isValidFunction(const char* name, int32_t len) {
   for(int32_t i = 0; i <= TSDB_FUNC_BLKINFO; ++i) {
@@ -3390,8 +3494,19 @@ char *getArithColumnData(void *param, const char* name, int32_t colId) {
 static void arithmetic_function(SQLFunctionCtx *pCtx) {
   GET_RES_INFO(pCtx)->numOfRes += pCtx->size;
   SArithmeticSupport *sas = (SArithmeticSupport *)pCtx->param[1].pz;
-  
-  arithmeticTreeTraverse(sas->pExprInfo->pExpr, pCtx->size, pCtx->pOutput, sas, pCtx->order, getArithColumnData);
+  tExprNode          *pExpr = sas->pExprInfo->pExpr;
+
+  // the same support object may serve expressions of different operators, so compile again once the tree changes
+  if (sas->pProgramSrc != pExpr) {
+    arithmeticProgramDestroy(sas->pProgram);
+    sas->pProgram = arithmeticProgramCompile(pExpr);
+    sas->pProgramSrc = pExpr;
+  }
+
+  if (sas->pProgram == NULL ||
+      arithmeticProgramExec(sas->pProgram, pCtx->size, pCtx->pOutput, sas, pCtx->order, getArithColumnData) != 0) {
+    arithmeticTreeTraverse(pExpr, pCtx->size, pCtx->pOutput, sas, pCtx->order, getArithColumnData);
+  }
 }
 
 #define LIST_MINMAX_N(ctx, minOutput, maxOutput, elemCnt, data, type, tsdbType, numOfNotNullElem) \
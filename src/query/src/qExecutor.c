@@ -44,6 +44,10 @@
 
 #define MULTI_KEY_DELIM  "-"
 
+#define GROUPBY_SPILL_BITS       5   // bits of the hash value used to choose a partition in each level
+#define GROUPBY_SPILL_PARTITIONS (1 << GROUPBY_SPILL_BITS)
+#define GROUPBY_SPILL_MAX_LEVEL  4
+
 #define TIME_WINDOW_COPY(_dst, _src)  do {\
    (_dst).skey = (_src).skey;\
    (_dst).ekey = (_src).ekey;\
@@ -218,6 +222,7 @@ static STableIdInfo createTableIdInfo(STableQueryInfo* pTableQueryInfo);
 static void setTableScanFilterOperatorInfo(STableScanInfo* pTableScanInfo, SOperatorInfo* pDownstream);
 
 static int32_t getNumOfScanTimes(SQueryAttr* pQueryAttr);
+static bool isParallelAggQuery(SQueryRuntimeEnv* pRuntimeEnv);
 
 static void destroyBasicOperatorInfo(void* param, int32_t numOfOutput);
 static void destroySFillOperatorInfo(void* param, int32_t numOfOutput);
@@ -225,9 +230,11 @@ static void destroyGroupbyOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyProjectOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyTagScanOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyOrderOperatorInfo(void* param, int32_t numOfOutput);
+static void destroyTopNOperatorInfo(void* param, int32_t numOfOutput);
 static void destroySWindowOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyStateWindowOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyAggOperatorInfo(void* param, int32_t numOfOutput);
+static void destroyParallelAggOperatorInfo(void* param, int32_t numOfOutput);
 static void destroyOperatorInfo(SOperatorInfo* pOperator);
 
 static void doSetOperatorCompleted(SOperatorInfo* pOperator) {
@@ -240,7 +247,7 @@ static void doSetOperatorCompleted(SOperatorInfo* pOperator) {
 static int32_t doCopyToSDataBlock(SQueryRuntimeEnv* pRuntimeEnv, SGroupResInfo* pGroupResInfo, int32_t orderType, SSDataBlock* pBlock);
 
 static int32_t getGroupbyColumnIndex(SGroupbyExpr *pGroupbyExpr, SSDataBlock* pDataBlock);
-static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SOptrBasicInfo *binf, int32_t numOfCols, char *pData, int16_t type, int16_t bytes, int32_t groupIndex);
+static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SGroupbyOperatorInfo *pInfo, int32_t numOfCols, char *pData, int16_t type, int16_t bytes, int32_t groupIndex);
 
 static void initCtxOutputBuffer(SQLFunctionCtx* pCtx, int32_t size);
 static void getAlignQueryTimeWindow(SQueryAttr *pQueryAttr, int64_t key, int64_t keyFirst, int64_t keyLast, STimeWindow *win);
@@ -353,6 +360,19 @@ void* destroyOutputBuf(SSDataBlock* pBlock) {
   return NULL;
 }
 
+static void destroyOutputBufList(SArray* pBlocks) {
+  if (pBlocks == NULL) {
+    return;
+  }
+
+  size_t num = taosArrayGetSize(pBlocks);
+  for (int32_t i = 0; i < num; ++i) {
+    destroyOutputBuf(taosArrayGetP(pBlocks, i));
+  }
+
+  taosArrayDestroy(pBlocks);
+}
+
 int32_t getNumOfResult(SQueryRuntimeEnv *pRuntimeEnv, SQLFunctionCtx* pCtx, int32_t numOfOutput) {
   SQueryAttr *pQueryAttr = pRuntimeEnv->pQueryAttr;
   bool    hasMainFunction = hasMainOutput(pQueryAttr);
@@ -586,6 +606,47 @@ static SResultRow* doSetResultOutBufByKey(SQueryRuntimeEnv* pRuntimeEnv, SResult
   return pResultRowInfo->pResult[pResultRowInfo->curPos];
 }
 
+/*
+ * Find the result row of a group by column of a fixed width in the open addressing table of the group by operator,
+ * which costs one probe and no allocation. The group by query has no time window, so a new group is only appended to
+ * the result row list.
+ */
+static SResultRow* doSetFixedGroupResultRow(SQueryRuntimeEnv* pRuntimeEnv, SResultRowInfo* pResultRowInfo,
+                                            SFixedHashObj* pGroupSet, char* pData, int16_t bytes, uint64_t tableGroupId) {
+  SET_RES_WINDOW_KEY(pRuntimeEnv->keyBuf, pData, bytes, tableGroupId);
+
+  bool         exist = false;
+  SResultRow **p1 = taosFixedHashPut(pGroupSet, pRuntimeEnv->keyBuf, NULL, &exist);
+  if (p1 == NULL) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  if (exist) {
+    return *p1;
+  }
+
+  prepareResultListBuffer(pResultRowInfo, pRuntimeEnv);
+
+  SResultRow *pResult = getNewResultRow(pRuntimeEnv->pool);
+  int32_t ret = initResultRow(pResult);
+  if (ret != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  *p1 = pResult;
+  SResultRowCell cell = {.groupId = tableGroupId, .pRow = pResult};
+  taosArrayPush(pRuntimeEnv->pResultRowArrayList, &cell);
+
+  pResultRowInfo->curPos = pResultRowInfo->size;
+  pResultRowInfo->pResult[pResultRowInfo->size++] = pResult;
+
+  if (pResultRowInfo->size > MAX_INTERVAL_TIME_WINDOW) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_TOO_MANY_TIMEWINDOW);
+  }
+
+  return pResult;
+}
+
 static void getInitialStartTimeWindow(SQueryAttr* pQueryAttr, TSKEY ts, STimeWindow* w) {
   if (QUERY_IS_ASC_QUERY(pQueryAttr)) {
     getAlignQueryTimeWindow(pQueryAttr, ts, ts, pQueryAttr->window.ekey, w);
@@ -706,7 +767,8 @@ static int32_t addNewWindowResultBuf(SResultRow *pWindowRes, SDiskbasedResultBuf
     pData = getResBufPage(pResultBuf, pi->pageId);
     pageId = pi->pageId;
 
-    if (pData->num + size > pResultBuf->pageSize) {
+    // the page header is part of the page, the last row must not run over the end of the page
+    if (sizeof(tFilePage) + pData->num + size > pResultBuf->pageSize) {
       // release current page first, and prepare the next one
       releaseResBufPageInfo(pResultBuf, pi);
       pData = getNewDataBuf(pResultBuf, tid, &pageId);
@@ -1705,10 +1767,78 @@ static void hashAllIntervalAgg(SOperatorInfo* pOperatorInfo, SResultRowInfo* pRe
 
 
 
-static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo, SSDataBlock *pSDataBlock) {
+// check if the result row of the group is in memory in current round, the key is left in pRuntimeEnv->keyBuf
+static bool isGroupResultRowInMem(SQueryRuntimeEnv *pRuntimeEnv, SGroupbyOperatorInfo *pInfo, char *pData, int16_t type,
+                                  int16_t bytes, uint64_t groupIndex) {
+  char* d = pData;
+  int16_t len = bytes;
+  if (IS_VAR_DATA_TYPE(type)) {
+    d = varDataVal(pData);
+    len = varDataLen(pData);
+  }
+
+  SET_RES_WINDOW_KEY(pRuntimeEnv->keyBuf, d, len, groupIndex);
+  if (pInfo->pGroupSet != NULL) {
+    return taosFixedHashGet(pInfo->pGroupSet, pRuntimeEnv->keyBuf) != NULL;
+  } else {
+    return taosHashGet(pRuntimeEnv->pResultRowHashTable, pRuntimeEnv->keyBuf, GET_RES_WINDOW_KEY_LEN(len)) != NULL;
+  }
+}
+
+// write the rows of a group that is not in memory into the partition chosen by the hash value of the group key
+static void doSpillGroupRows(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo, SSDataBlock *pSDataBlock,
+                             int32_t keyLen, int32_t start, int32_t num) {
+  SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  if (pInfo->pSpillBuf == NULL) {
+    pInfo->pSpillBuf = createSpillBuf(pSDataBlock, GROUPBY_SPILL_PARTITIONS, pInfo->spillLevel, GET_QID(pRuntimeEnv));
+    if (pInfo->pSpillBuf == NULL) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+    }
+
+    qDebug("QInfo:0x%"PRIx64" groups exceed the limit:%d, spill the rows of new groups, level:%d", GET_QID(pRuntimeEnv),
+           pInfo->maxGroups, pInfo->spillLevel);
+  }
+
+  // each level takes the next bits from the top of the hash value, the bottom bits are left for the hash tables
+  uint32_t hashVal = MurmurHash3_32(pRuntimeEnv->keyBuf, GET_RES_WINDOW_KEY_LEN(keyLen));
+  int32_t  partition = (hashVal >> (32 - GROUPBY_SPILL_BITS * (pInfo->spillLevel + 1))) & (GROUPBY_SPILL_PARTITIONS - 1);
+
+  int32_t code = spillBufAppend(pInfo->pSpillBuf, partition, pSDataBlock, start, num, (int64_t)(intptr_t)pRuntimeEnv->current);
+  if (code != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, code);
+  }
+}
+
+static void doAggregateGroupRows(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo, SSDataBlock *pSDataBlock, char *val,
+                                 int16_t type, int16_t bytes, int32_t start, int32_t num, int64_t *tsList) {
   SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+  SQueryAttr*       pQueryAttr = pRuntimeEnv->pQueryAttr;
   STableQueryInfo*  item = pRuntimeEnv->current;
 
+  // the memory is used up, the rows of the groups that are not in memory yet are aggregated in the following rounds
+  if (pInfo->maxGroups > 0 && pInfo->binfo.resultRowInfo.size >= pInfo->maxGroups &&
+      pInfo->spillLevel < GROUPBY_SPILL_MAX_LEVEL && !isGroupResultRowInMem(pRuntimeEnv, pInfo, val, type, bytes, item->groupIndex)) {
+    doSpillGroupRows(pOperator, pInfo, pSDataBlock, IS_VAR_DATA_TYPE(type)? varDataLen(val):bytes, start, num);
+    return;
+  }
+
+  if (pQueryAttr->stableQuery && pQueryAttr->stabledev && (pRuntimeEnv->prevResult != NULL)) {
+    setParamForStableStddevByColData(pRuntimeEnv, pInfo->binfo.pCtx, pOperator->numOfOutput, pOperator->pExpr, val, bytes);
+  }
+
+  int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, pInfo, pOperator->numOfOutput, val, type, bytes, item->groupIndex);
+  if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
+  }
+
+  STimeWindow w = TSWINDOW_INITIALIZER;
+  doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, start, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
+}
+
+static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo, SSDataBlock *pSDataBlock) {
+  SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+
   SColumnInfoData* pColInfoData = taosArrayGet(pSDataBlock->pDataBlock, pInfo->colIndex);
 
   SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
@@ -1720,68 +1850,67 @@ static void doHashGroupbyAgg(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pIn
     return;
   }
 
+  if (pInfo->pGroupSet == NULL && !IS_VAR_DATA_TYPE(type)) {
+    pInfo->pGroupSet = taosFixedHashInit((int32_t)GET_RES_WINDOW_KEY_LEN(bytes), POINTER_BYTES, 4096);
+    if (pInfo->pGroupSet == NULL) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+    }
+  }
+
+  // the results of a super table query are merged again by the client, so they can be returned in several rounds
+  if (pInfo->maxGroups < 0) {
+    pInfo->maxGroups = 0;
+
+    if (pQueryAttr->stableQuery && tsGroupbySpillBufferSize > 0) {
+      int64_t groupSize = pQueryAttr->resultRowSize + pRuntimeEnv->pool->elemSize + GET_RES_WINDOW_KEY_LEN(bytes) + POINTER_BYTES * 2;
+      int64_t maxGroups = MAX(tsGroupbySpillBufferSize * 1048576LL / groupSize, 1);
+      pInfo->maxGroups = (int32_t) MIN(maxGroups, MAX_INTERVAL_TIME_WINDOW);
+    }
+  }
+
   SColumnInfoData* pFirstColData = taosArrayGet(pSDataBlock->pDataBlock, 0);
   int64_t* tsList = (pFirstColData->info.type == TSDB_DATA_TYPE_TIMESTAMP)? (int64_t*) pFirstColData->pData:NULL;
 
-  STimeWindow w = TSWINDOW_INITIALIZER;
-
+  // the rows in [start, start + num) have the same group by value, a null value ends the current run
   int32_t num = 0;
+  int32_t start = 0;
   for (int32_t j = 0; j < pSDataBlock->info.rows; ++j) {
     char* val = ((char*)pColInfoData->pData) + bytes * j;
     if (isNull(val, type)) {
+      if (num > 0) {
+        doAggregateGroupRows(pOperator, pInfo, pSDataBlock, pInfo->prevData, type, bytes, start, num, tsList);
+        num = 0;
+      }
       continue;
     }
 
     // Compare with the previous row of this column, and do not set the output buffer again if they are identical.
     if (pInfo->prevData == NULL) {
       pInfo->prevData = malloc(bytes);
-      memcpy(pInfo->prevData, val, bytes);
-      num++;
-      continue;
-    }
-
-    if (IS_VAR_DATA_TYPE(type)) {
-      int32_t len = varDataLen(val);
-      if(len == varDataLen(pInfo->prevData) && memcmp(varDataVal(pInfo->prevData), varDataVal(val), len) == 0) {
-        num++;
-        continue;
-      }
-    } else {
-      if (memcmp(pInfo->prevData, val, bytes) == 0) {
-        num++;
-        continue;
+    } else if (num > 0) {
+      if (IS_VAR_DATA_TYPE(type)) {
+        int32_t len = varDataLen(val);
+        if(len == varDataLen(pInfo->prevData) && memcmp(varDataVal(pInfo->prevData), varDataVal(val), len) == 0) {
+          num++;
+          continue;
+        }
+      } else {
+        if (memcmp(pInfo->prevData, val, bytes) == 0) {
+          num++;
+          continue;
+        }
       }
-    }
-
-    if (pQueryAttr->stableQuery && pQueryAttr->stabledev && (pRuntimeEnv->prevResult != NULL)) {
-      setParamForStableStddevByColData(pRuntimeEnv, pInfo->binfo.pCtx, pOperator->numOfOutput, pOperator->pExpr, pInfo->prevData, bytes);
-    }
 
-    int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, &(pInfo->binfo), pOperator->numOfOutput, pInfo->prevData, type, bytes, item->groupIndex);
-    if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
-      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
+      doAggregateGroupRows(pOperator, pInfo, pSDataBlock, pInfo->prevData, type, bytes, start, num, tsList);
     }
 
-    doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, j - num, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
-
-    num = 1;
     memcpy(pInfo->prevData, val, bytes);
+    start = j;
+    num = 1;
   }
 
   if (num > 0) {
-    char* val = ((char*)pColInfoData->pData) + bytes * (pSDataBlock->info.rows - num);
-    memcpy(pInfo->prevData, val, bytes);
-
-    if (pQueryAttr->stableQuery && pQueryAttr->stabledev && (pRuntimeEnv->prevResult != NULL)) {
-      setParamForStableStddevByColData(pRuntimeEnv, pInfo->binfo.pCtx, pOperator->numOfOutput, pOperator->pExpr, val, bytes);
-    }
-
-    int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, &(pInfo->binfo), pOperator->numOfOutput, val, type, bytes, item->groupIndex);
-    if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
-      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_APP_ERROR);
-    }
-
-    doApplyFunctions(pRuntimeEnv, pInfo->binfo.pCtx, &w, pSDataBlock->info.rows - num, num, tsList, pSDataBlock->info.rows, pOperator->numOfOutput);
+    doAggregateGroupRows(pOperator, pInfo, pSDataBlock, pInfo->prevData, type, bytes, start, num, tsList);
   }
 
   tfree(pInfo->prevData);
@@ -1873,8 +2002,9 @@ static void setResultRowKey(SResultRow* pResultRow, char* pData, int16_t type) {
   }
 }
 
-static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SOptrBasicInfo *binfo, int32_t numOfCols, char *pData, int16_t type, int16_t bytes, int32_t groupIndex) {
+static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SGroupbyOperatorInfo *pInfo, int32_t numOfCols, char *pData, int16_t type, int16_t bytes, int32_t groupIndex) {
   SDiskbasedResultBuf *pResultBuf = pRuntimeEnv->pResultBuf;
+  SOptrBasicInfo      *binfo      = &pInfo->binfo;
 
   int32_t        *rowCellInfoOffset = binfo->rowCellInfoOffset;
   SResultRowInfo *pResultRowInfo    = &binfo->resultRowInfo;
@@ -1889,7 +2019,12 @@ static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SOptrBasic
   }
 
   int64_t tid = 0;
-  SResultRow *pResultRow = doSetResultOutBufByKey(pRuntimeEnv, pResultRowInfo, tid, d, len, true, groupIndex);
+  SResultRow *pResultRow = NULL;
+  if (pInfo->pGroupSet != NULL) {
+    pResultRow = doSetFixedGroupResultRow(pRuntimeEnv, pResultRowInfo, pInfo->pGroupSet, d, len, groupIndex);
+  } else {
+    pResultRow = doSetResultOutBufByKey(pRuntimeEnv, pResultRowInfo, tid, d, len, true, groupIndex);
+  }
   assert (pResultRow != NULL);
 
   setResultRowKey(pResultRow, pData, type);
@@ -2197,6 +2332,11 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
         break;
       }
       case OP_MultiTableTimeInterval: {
+        if (isParallelAggQuery(pRuntimeEnv)) {
+          pRuntimeEnv->proot = createParallelAggOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, *op);
+          break;
+        }
+
         pRuntimeEnv->proot =
             createMultiTableTimeIntervalOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput);
         setTableScanFilterOperatorInfo(pRuntimeEnv->proot->upstream[0]->info, pRuntimeEnv->proot);
@@ -2246,6 +2386,11 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
         break;
       }
       case OP_MultiTableAggregate: {
+        if (isParallelAggQuery(pRuntimeEnv)) {
+          pRuntimeEnv->proot = createParallelAggOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, *op);
+          break;
+        }
+
         pRuntimeEnv->proot =
             createMultiTableAggOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput);
         setTableScanFilterOperatorInfo(pRuntimeEnv->proot->upstream[0]->info, pRuntimeEnv->proot);
@@ -2349,6 +2494,13 @@ static int32_t setupQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv, int32_t numOf
         break;
       }
 
+      case OP_TopN: {
+        pRuntimeEnv->proot = createTopNOperatorInfo(pRuntimeEnv, pRuntimeEnv->proot, pQueryAttr->pExpr1,
+                                                    pQueryAttr->numOfOutput, &pQueryAttr->order,
+                                                    pQueryAttr->prjInfo.vgroupLimit);
+        break;
+      }
+
       default: {
         assert(0);
       }
@@ -2370,6 +2522,11 @@ _clean:
 static void doFreeQueryHandle(SQueryRuntimeEnv* pRuntimeEnv) {
   SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
 
+  // the handle of a parallel aggregate worker is released as soon as the worker completes
+  if (pRuntimeEnv->pQueryHandle == NULL) {
+    return;
+  }
+
   tsdbCleanupQueryHandle(pRuntimeEnv->pQueryHandle);
   pRuntimeEnv->pQueryHandle = NULL;
 
@@ -2400,6 +2557,7 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
     for(int32_t i = 0; i < pQueryAttr->numOfOutput; ++i) {
       tfree(pRuntimeEnv->sasArray[i].data);
       tfree(pRuntimeEnv->sasArray[i].colList);
+      arithmeticProgramDestroy(pRuntimeEnv->sasArray[i].pProgram);
     }
 
     tfree(pRuntimeEnv->sasArray);
@@ -2441,6 +2599,11 @@ static bool needBuildResAfterQueryComplete(SQInfo* pQInfo) {
   return pQInfo->rspContext != NULL;
 }
 
+static bool needPrefetchResult(SQInfo* pQInfo) {
+  return pQInfo->pPrefetchRsp != NULL && pQInfo->code == TSDB_CODE_SUCCESS && !IS_QUERY_KILLED(pQInfo) &&
+         taosArrayGetSize(pQInfo->pPrefetchRsp) < tsRetrievePrefetchBlocks;
+}
+
 bool isQueryKilled(SQInfo *pQInfo) {
   if (IS_QUERY_KILLED(pQInfo)) {
     return true;
@@ -3223,6 +3386,8 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTa
     if (pBlock->pBlockStatis == NULL) {  // data block statistics does not exist, load data block
       pBlock->pDataBlock = tsdbRetrieveDataBlock(pTableScanInfo->pQueryHandle, NULL);
       pCost->totalCheckedRows += pBlock->info.rows;
+    } else {
+      pCost->statisHitBlocks += 1;
     }
   } else {
     assert((*status) == BLK_DATA_ALL_NEEDED);
@@ -3255,6 +3420,7 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTa
                                          (char*)&(pBlock->pBlockStatis[i].max));
           if (!load) { // current block has been discard due to filter applied
             pCost->discardBlocks += 1;
+            pCost->statisHitBlocks += 1;
             qDebug("QInfo:0x%"PRIx64" data block discard, brange:%" PRId64 "-%" PRId64 ", rows:%d", pQInfo->qId,
                    pBlockInfo->window.skey, pBlockInfo->window.ekey, pBlockInfo->rows);
             (*status) = BLK_DATA_DISCARD;
@@ -3267,6 +3433,7 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTa
     // current block has been discard due to filter applied
     if (!doFilterByBlockStatistics(pRuntimeEnv, pBlock->pBlockStatis, pTableScanInfo->pCtx, pBlockInfo->rows)) {
       pCost->discardBlocks += 1;
+      pCost->statisHitBlocks += 1;
       qDebug("QInfo:0x%"PRIx64" data block discard, brange:%" PRId64 "-%" PRId64 ", rows:%d", pQInfo->qId, pBlockInfo->window.skey,
              pBlockInfo->window.ekey, pBlockInfo->rows);
       (*status) = BLK_DATA_DISCARD;
@@ -4547,6 +4714,118 @@ void queryCostStatis(SQInfo *pQInfo) {
   }
 }
 
+static SSDataBlock* doExplainOperatorExec(void* param, bool* newgroup) {
+  SOperatorInfo* pOperator = (SOperatorInfo*) param;
+  SOperatorCost* pCost = &pOperator->cost;
+
+  int64_t st = taosGetTimestampUs();
+  SSDataBlock* pBlock = pCost->exec(param, newgroup);
+
+  pCost->elapsedTime += (taosGetTimestampUs() - st);
+  pCost->numOfCalls  += 1;
+  if (pBlock != NULL) {
+    pCost->rowsOut += pBlock->info.rows;
+  }
+
+  return pBlock;
+}
+
+static void doSetOperatorExplain(SOperatorInfo* pOperator) {
+  for (int32_t i = 0; i < pOperator->numOfUpstream; ++i) {
+    doSetOperatorExplain(pOperator->upstream[i]);
+  }
+
+  if (pOperator->exec != doExplainOperatorExec) {
+    pOperator->cost.exec = pOperator->exec;
+    pOperator->exec      = doExplainOperatorExec;
+  }
+}
+
+void setQueryExplain(SQInfo *pQInfo) {
+  pQInfo->explain = true;
+
+  SOperatorInfo* proot = pQInfo->runtimeEnv.proot;
+  if (proot != NULL) {
+    doSetOperatorExplain(proot);
+  }
+}
+
+static void doBuildOperatorProfile(SOperatorInfo* pOperator, int16_t level, SArray* pProfile) {
+  SQueryProfileOperator p = {0};
+
+  tstrncpy(p.name, (pOperator->name != NULL)? pOperator->name:"UnknownOperator", tListLen(p.name));
+  p.level       = level;
+  p.numOfCalls  = pOperator->cost.numOfCalls;
+  p.rowsOut     = pOperator->cost.rowsOut;
+  p.elapsedTime = pOperator->cost.elapsedTime;
+
+  for (int32_t i = 0; i < pOperator->numOfUpstream; ++i) {
+    p.rowsIn += pOperator->upstream[i]->cost.rowsOut;
+  }
+
+  taosArrayPush(pProfile, &p);
+
+  for (int32_t i = 0; i < pOperator->numOfUpstream; ++i) {
+    doBuildOperatorProfile(pOperator->upstream[i], level + 1, pProfile);
+  }
+}
+
+SArray* createQueryProfile(SQInfo *pQInfo) {
+  SArray* pProfile = taosArrayInit(8, sizeof(SQueryProfileOperator));
+  if (pProfile == NULL) {
+    return NULL;
+  }
+
+  if (pQInfo->runtimeEnv.proot != NULL) {
+    doBuildOperatorProfile(pQInfo->runtimeEnv.proot, 0, pProfile);
+  }
+
+  size_t num = taosArrayGetSize(pProfile);
+  if (num == 0) {
+    return pProfile;
+  }
+
+  SQueryCostInfo* pSummary = &pQInfo->summary;
+
+  STsdbQueryCost ioCost = pSummary->ioCost;
+  tsdbGetQueryCost(pQInfo->runtimeEnv.pQueryHandle, &ioCost);
+
+  // the io cost is attributed to the first leaf operator in pre-order, which is the table scan operator
+  for (int32_t i = 0; i < num; ++i) {
+    SQueryProfileOperator* p = taosArrayGet(pProfile, i);
+    if (i < num - 1 && ((SQueryProfileOperator*)taosArrayGet(pProfile, i + 1))->level > p->level) {
+      continue;
+    }
+
+    p->rowsIn      = pSummary->totalRows;
+    p->dataBlocks  = ioCost.dataBlocks;
+    p->lastBlocks  = ioCost.lastBlocks;
+    p->cacheBlocks = ioCost.cacheBlocks;
+    p->decompSize  = ioCost.decompSize;
+    p->smaHits     = pSummary->statisHitBlocks;
+    break;
+  }
+
+  ((SQueryProfileOperator*)taosArrayGet(pProfile, 0))->queueWaitTime = pSummary->queueWaitTime;
+
+  for (int32_t i = 0; i < num; ++i) {
+    SQueryProfileOperator* p = taosArrayGet(pProfile, i);
+    p->level         = htons(p->level);
+    p->numOfCalls    = htobe64(p->numOfCalls);
+    p->rowsIn        = htobe64(p->rowsIn);
+    p->rowsOut       = htobe64(p->rowsOut);
+    p->elapsedTime   = htobe64(p->elapsedTime);
+    p->dataBlocks    = htobe64(p->dataBlocks);
+    p->lastBlocks    = htobe64(p->lastBlocks);
+    p->cacheBlocks   = htobe64(p->cacheBlocks);
+    p->decompSize    = htobe64(p->decompSize);
+    p->smaHits       = htobe64(p->smaHits);
+    p->queueWaitTime = htobe64(p->queueWaitTime);
+  }
+
+  return pProfile;
+}
+
 //static void updateOffsetVal(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pBlockInfo) {
 //  SQueryAttr *pQueryAttr = pRuntimeEnv->pQueryAttr;
 //  STableQueryInfo* pTableQueryInfo = pRuntimeEnv->current;
@@ -4878,6 +5157,18 @@ static SFillColInfo* createFillColInfo(SExprInfo* pExpr, int32_t numOfOutput, in
   return pFillCol;
 }
 
+static int32_t getResultBufInMemSize(SQueryAttr* pQueryAttr) {
+  int32_t TENMB = 1024*1024*10;
+  int32_t inMemSize = TENMB;
+
+  // the groups that are kept in memory by a super table group by query stay in the in-memory pages
+  if (pQueryAttr->stableQuery && pQueryAttr->groupbyColumn && tsGroupbySpillBufferSize > 0) {
+    inMemSize = MAX(TENMB, tsGroupbySpillBufferSize * 1024 * 1024);
+  }
+
+  return inMemSize;
+}
+
 int32_t doInitQInfo(SQInfo* pQInfo, STSBuf* pTsBuf, void* tsdb, void* sourceOptr, int32_t tbScanner, SArray* pOperator,
     void* param) {
   SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
@@ -4937,8 +5228,7 @@ int32_t doInitQInfo(SQInfo* pQInfo, STSBuf* pTsBuf, void* tsdb, void* sourceOptr
   int32_t ps = DEFAULT_PAGE_SIZE;
   getIntermediateBufInfo(pRuntimeEnv, &ps, &pQueryAttr->intermediateResultRowSize);
 
-  int32_t TENMB = 1024*1024*10;
-  int32_t code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, ps, TENMB, pQInfo->qId);
+  int32_t code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, ps, getResultBufInMemSize(pQueryAttr), pQInfo->qId);
   if (code != TSDB_CODE_SUCCESS) {
     return code;
   }
@@ -5582,6 +5872,77 @@ static int32_t doMergeSDatablock(SSDataBlock* pDest, SSDataBlock* pSrc) {
   return TSDB_CODE_SUCCESS;
 }
 
+static int32_t getOrderColumnType(SOrderOperatorInfo* pInfo) {
+  SColumnInfoData* pColInfo = taosArrayGet(pInfo->pDataBlock->pDataBlock, pInfo->colIndex);
+  return pColInfo->info.type;
+}
+
+static int32_t doSortRowsInMemory(SOrderOperatorInfo* pInfo, int32_t* numOfSlices) {
+  SSDataBlock* pBlock = pInfo->pDataBlock;
+
+  int32_t* p = realloc(pInfo->pIndex, sizeof(int32_t) * pBlock->info.rows);
+  if (p == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  pInfo->pIndex = p;
+  *numOfSlices = sortGetNumOfSlices(pBlock->info.rows, tsSortParallelThreads);
+  return sortBlockSlices(pBlock, pInfo->colIndex, pInfo->order, *numOfSlices, pInfo->pIndex);
+}
+
+// sort the rows in memory by parallel threads, and merge them into a run on disk
+static int32_t doSpillSortedRun(SOperatorInfo* pOperator) {
+  SOrderOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*   pRuntimeEnv = pOperator->pRuntimeEnv;
+  SSDataBlock*        pBlock = pInfo->pDataBlock;
+
+  int32_t numOfSlices = 0;
+  int32_t code = doSortRowsInMemory(pInfo, &numOfSlices);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SArray* pSources = taosArrayInit(numOfSlices, sizeof(SSortSource));
+  if (pSources == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  sortAddSliceSources(pSources, pBlock, numOfSlices, pInfo->pIndex);
+
+  SSpillBuf* pRun = NULL;
+  code = sortMergeToRun(pSources, pInfo->pRes, (int32_t) pRuntimeEnv->resultInfo.capacity, pInfo->colIndex,
+                        pInfo->order, getOrderColumnType(pInfo), GET_QID(pRuntimeEnv), &pRun);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  qDebug("QInfo:0x%"PRIx64" %d rows sorted by %d threads into run %d on disk, file size:%.2f Kb", GET_QID(pRuntimeEnv),
+         pBlock->info.rows, numOfSlices, (int32_t) taosArrayGetSize(pInfo->pSources), pRun->fileSize / 1024.0);
+
+  pBlock->info.rows = 0;
+  return sortAddRunSource(pInfo->pSources, pRun);
+}
+
+static int32_t doCreateSortMerger(SOperatorInfo* pOperator) {
+  SOrderOperatorInfo* pInfo = pOperator->info;
+  SSDataBlock*        pBlock = pInfo->pDataBlock;
+
+  if (pBlock->info.rows > 0) {
+    // the rows of the last run are kept in memory
+    int32_t numOfSlices = 0;
+    int32_t code = doSortRowsInMemory(pInfo, &numOfSlices);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    sortAddSliceSources(pInfo->pSources, pBlock, numOfSlices, pInfo->pIndex);
+  }
+
+  SArray* pSources = pInfo->pSources;
+  pInfo->pSources = NULL;
+  return sortMergerCreate(&pInfo->pMerger, pSources, pInfo->colIndex, pInfo->order, getOrderColumnType(pInfo));
+}
+
 static SSDataBlock* doSort(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
@@ -5589,45 +5950,53 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
   }
 
   SOrderOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*   pRuntimeEnv = pOperator->pRuntimeEnv;
 
-  SSDataBlock* pBlock = NULL;
-  while(1) {
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
-    pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+  if (pOperator->status == OP_IN_EXECUTING) {
+    while (1) {
+      publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
+      SSDataBlock* pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
+      publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
 
-    // start to flush data into disk and try do multiway merge sort
-    if (pBlock == NULL) {
-      doSetOperatorCompleted(pOperator);
-      break;
+      // start to do multiway merge sort of all runs
+      if (pBlock == NULL) {
+        break;
+      }
+
+      int32_t code = doMergeSDatablock(pInfo->pDataBlock, pBlock);
+      if (code != TSDB_CODE_SUCCESS) {
+        longjmp(pRuntimeEnv->env, code);
+      }
+
+      // the rows of the current run are more than the memory allows, flush them into a sorted run on disk
+      if (pInfo->maxRows > 0 && pInfo->pDataBlock->info.rows >= pInfo->maxRows) {
+        code = doSpillSortedRun(pOperator);
+        if (code != TSDB_CODE_SUCCESS) {
+          longjmp(pRuntimeEnv->env, code);
+        }
+      }
     }
 
-    int32_t code = doMergeSDatablock(pInfo->pDataBlock, pBlock);
+    int32_t code = doCreateSortMerger(pOperator);
     if (code != TSDB_CODE_SUCCESS) {
-      // todo handle error
+      longjmp(pRuntimeEnv->env, code);
     }
-  }
 
-  int32_t numOfCols = pInfo->pDataBlock->info.numOfCols;
-  void** pCols     = calloc(numOfCols, POINTER_BYTES);
-  SSchema* pSchema = calloc(numOfCols, sizeof(SSchema));
+    pOperator->status = OP_RES_TO_RETURN;
+  }
 
-  for(int32_t i = 0; i < numOfCols; ++i) {
-    SColumnInfoData* p1 = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
-    pCols[i] = p1->pData;
-    pSchema[i].colId = p1->info.colId;
-    pSchema[i].bytes = p1->info.bytes;
-    pSchema[i].type  = (uint8_t) p1->info.type;
+  pInfo->pRes->info.rows = 0;
+  int32_t code = sortMergerNext(pInfo->pMerger, pInfo->pRes, (int32_t) pRuntimeEnv->resultInfo.capacity);
+  if (code != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, code);
   }
 
-  __compar_fn_t  comp = getKeyComparFunc(pSchema[pInfo->colIndex].type, pInfo->order);
-  if (pInfo->pDataBlock->info.rows) {
-    taoscQSort(pCols, pSchema, numOfCols, pInfo->pDataBlock->info.rows, pInfo->colIndex, comp);
+  if (pInfo->pRes->info.rows == 0) {
+    doSetOperatorCompleted(pOperator);
+    return NULL;
   }
-  
-  tfree(pCols);
-  tfree(pSchema);
-  return (pInfo->pDataBlock->info.rows > 0)? pInfo->pDataBlock:NULL;
+
+  return pInfo->pRes;
 }
 
 SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput, SOrderVal* pOrderVal) {
@@ -5653,8 +6022,28 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
       pInfo->pDataBlock = pDataBlock;
   }
 
+  // the output block, which also stages the rows that are merged into a run on disk
+  int32_t rowSize = 0;
+  pInfo->pRes = calloc(1, sizeof(SSDataBlock));
+  pInfo->pRes->info.numOfCols = numOfOutput;
+  pInfo->pRes->pDataBlock = taosArrayInit(numOfOutput, sizeof(SColumnInfoData));
+  for(int32_t i = 0; i < numOfOutput; ++i) {
+    SColumnInfoData col = {.info = ((SColumnInfoData*) taosArrayGet(pInfo->pDataBlock->pDataBlock, i))->info};
+    col.pData = calloc(pRuntimeEnv->resultInfo.capacity, col.info.bytes);
+    taosArrayPush(pInfo->pRes->pDataBlock, &col);
+    rowSize += col.info.bytes;
+  }
+
+  pInfo->pSources = taosArrayInit(4, sizeof(SSortSource));
+
+  if (tsSortBufferSize > 0) {
+    int64_t maxRows = ((int64_t) tsSortBufferSize) * 1024 * 1024 / (rowSize + sizeof(int32_t));
+    pInfo->maxRows = (int32_t) MIN(maxRows, INT32_MAX / 2);
+    pInfo->maxRows = MAX(pInfo->maxRows, (int32_t) pRuntimeEnv->resultInfo.capacity);
+  }
+
   SOperatorInfo* pOperator = calloc(1, sizeof(SOperatorInfo));
-  pOperator->name          = "InMemoryOrder";
+  pOperator->name          = "ExternalOrder";
   pOperator->operatorType  = OP_Order;
   pOperator->blockingOptr  = true;
   pOperator->status        = OP_IN_EXECUTING;
@@ -5667,12 +6056,230 @@ SOperatorInfo *createOrderOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorI
   return pOperator;
 }
 
-static int32_t getTableScanOrder(STableScanInfo* pTableScanInfo) {
-  return pTableScanInfo->order;
+static int32_t compareTopNKey(STopNOperatorInfo* pInfo, char* f1, char* f2) {
+  SColumnInfoData* pColInfo = taosArrayGet(pInfo->pDataBlock->pDataBlock, pInfo->colIndex);
+
+  // the same order as the global merge of the results of all vnodes on the client
+  int32_t ret = 0;
+  if (pColInfo->info.type == TSDB_DATA_TYPE_TIMESTAMP) {
+    int64_t k1 = GET_INT64_VAL(f1);
+    int64_t k2 = GET_INT64_VAL(f2);
+    ret = (k1 == k2) ? 0 : ((k1 < k2) ? -1 : 1);
+  } else {
+    ret = columnValueAscendingComparator(f1, f2, pColInfo->info.type, pColInfo->info.bytes);
+  }
+
+  return (pInfo->order == TSDB_ORDER_DESC) ? -ret : ret;
 }
 
-// this is a blocking operator
-static SSDataBlock* doAggregate(void* param, bool* newgroup) {
+static char* getTopNKey(STopNOperatorInfo* pInfo, int32_t rowIndex) {
+  SColumnInfoData* pColInfo = taosArrayGet(pInfo->pDataBlock->pDataBlock, pInfo->colIndex);
+  return pColInfo->pData + pColInfo->info.bytes * rowIndex;
+}
+
+static void copyTopNRow(SSDataBlock* pDest, int32_t destIndex, SSDataBlock* pSrc, int32_t srcIndex) {
+  for (int32_t i = 0; i < pDest->info.numOfCols; ++i) {
+    SColumnInfoData* pDestCol = taosArrayGet(pDest->pDataBlock, i);
+    SColumnInfoData* pSrcCol = taosArrayGet(pSrc->pDataBlock, i);
+    memcpy(pDestCol->pData + destIndex * pDestCol->info.bytes, pSrcCol->pData + srcIndex * pSrcCol->info.bytes,
+           pDestCol->info.bytes);
+  }
+}
+
+// the root of the heap is the last row in order, i.e., the first one to be replaced
+static void topNHeapSiftDown(STopNOperatorInfo* pInfo, int32_t index, int32_t numOfRows) {
+  int32_t* pHeap = pInfo->pHeap;
+
+  while (1) {
+    int32_t last = index;
+    int32_t left = index * 2 + 1;
+    int32_t right = left + 1;
+
+    if (left < numOfRows && compareTopNKey(pInfo, getTopNKey(pInfo, pHeap[left]), getTopNKey(pInfo, pHeap[last])) > 0) {
+      last = left;
+    }
+
+    if (right < numOfRows && compareTopNKey(pInfo, getTopNKey(pInfo, pHeap[right]), getTopNKey(pInfo, pHeap[last])) > 0) {
+      last = right;
+    }
+
+    if (last == index) {
+      break;
+    }
+
+    SWAP(pHeap[index], pHeap[last], int32_t);
+    index = last;
+  }
+}
+
+static void topNHeapSiftUp(STopNOperatorInfo* pInfo, int32_t index) {
+  int32_t* pHeap = pInfo->pHeap;
+
+  while (index > 0) {
+    int32_t parent = (index - 1) / 2;
+    if (compareTopNKey(pInfo, getTopNKey(pInfo, pHeap[index]), getTopNKey(pInfo, pHeap[parent])) <= 0) {
+      break;
+    }
+
+    SWAP(pHeap[index], pHeap[parent], int32_t);
+    index = parent;
+  }
+}
+
+static int32_t ensureTopNCapacity(STopNOperatorInfo* pInfo) {
+  if (pInfo->numOfRows < pInfo->capacity) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t capacity = (int32_t) MIN(((int64_t) pInfo->capacity) * 2, pInfo->limit);
+
+  int32_t* p = realloc(pInfo->pHeap, sizeof(int32_t) * capacity);
+  if (p == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+  pInfo->pHeap = p;
+
+  for (int32_t i = 0; i < pInfo->pDataBlock->info.numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pInfo->pDataBlock->pDataBlock, i);
+
+    char* tmp = realloc(pColInfo->pData, ((size_t) capacity) * pColInfo->info.bytes);
+    if (tmp == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+    pColInfo->pData = tmp;
+  }
+
+  pInfo->capacity = capacity;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doAddTopNRows(STopNOperatorInfo* pInfo, SSDataBlock* pBlock) {
+  SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, pInfo->colIndex);
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    char* key = pColInfo->pData + pColInfo->info.bytes * i;
+
+    if (pInfo->numOfRows < pInfo->limit) {
+      int32_t code = ensureTopNCapacity(pInfo);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+
+      copyTopNRow(pInfo->pDataBlock, pInfo->numOfRows, pBlock, i);
+      pInfo->pHeap[pInfo->numOfRows] = pInfo->numOfRows;
+      topNHeapSiftUp(pInfo, pInfo->numOfRows);
+      pInfo->numOfRows += 1;
+    } else if (compareTopNKey(pInfo, key, getTopNKey(pInfo, pInfo->pHeap[0])) < 0) {
+      // replace the last row in the heap
+      copyTopNRow(pInfo->pDataBlock, pInfo->pHeap[0], pBlock, i);
+      topNHeapSiftDown(pInfo, 0, pInfo->numOfRows);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static SSDataBlock* doTopN(void* param, bool* newgroup) {
+  SOperatorInfo* pOperator = (SOperatorInfo*) param;
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  STopNOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*  pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  if (pOperator->status == OP_IN_EXECUTING) {
+    int64_t numOfTotal = 0;
+
+    while (1) {
+      publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
+      SSDataBlock* pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
+      publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+
+      if (pBlock == NULL) {
+        break;
+      }
+
+      int32_t code = doAddTopNRows(pInfo, pBlock);
+      if (code != TSDB_CODE_SUCCESS) {
+        longjmp(pRuntimeEnv->env, code);
+      }
+
+      numOfTotal += pBlock->info.rows;
+    }
+
+    // heap sort, the rows are in order in pHeap afterwards
+    for (int32_t n = pInfo->numOfRows - 1; n > 0; --n) {
+      SWAP(pInfo->pHeap[0], pInfo->pHeap[n], int32_t);
+      topNHeapSiftDown(pInfo, 0, n);
+    }
+
+    qDebug("QInfo:0x%"PRIx64" top %d rows of %"PRId64" rows are kept", GET_QID(pRuntimeEnv), pInfo->numOfRows,
+           numOfTotal);
+    pOperator->status = OP_RES_TO_RETURN;
+  }
+
+  SSDataBlock* pRes = pInfo->pRes;
+  pRes->info.rows = 0;
+
+  while (pInfo->outputIdx < pInfo->numOfRows && pRes->info.rows < pRuntimeEnv->resultInfo.capacity) {
+    copyTopNRow(pRes, pRes->info.rows, pInfo->pDataBlock, pInfo->pHeap[pInfo->outputIdx]);
+    pRes->info.rows += 1;
+    pInfo->outputIdx += 1;
+  }
+
+  if (pRes->info.rows == 0) {
+    doSetOperatorCompleted(pOperator);
+    return NULL;
+  }
+
+  return pRes;
+}
+
+SOperatorInfo *createTopNOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr,
+                                      int32_t numOfOutput, SOrderVal* pOrderVal, int64_t limit) {
+  STopNOperatorInfo* pInfo = calloc(1, sizeof(STopNOperatorInfo));
+
+  pInfo->colIndex = -1;
+  for (int32_t i = 0; i < numOfOutput; ++i) {
+    if (pExpr[i].base.functionId == TSDB_FUNC_PRJ && pExpr[i].base.colInfo.colId == pOrderVal->orderColId) {
+      pInfo->colIndex = i;
+      break;
+    }
+  }
+
+  assert(pInfo->colIndex >= 0 && limit > 0);
+
+  pInfo->order    = pOrderVal->order;
+  pInfo->limit    = MIN(limit, INT32_MAX);
+  pInfo->capacity = (int32_t) MIN(pInfo->limit, pRuntimeEnv->resultInfo.capacity);
+  pInfo->pHeap    = calloc(pInfo->capacity, sizeof(int32_t));
+
+  pInfo->pDataBlock = createOutputBuf(pExpr, numOfOutput, pInfo->capacity);
+  pInfo->pRes       = createOutputBuf(pExpr, numOfOutput, (int32_t) pRuntimeEnv->resultInfo.capacity);
+
+  SOperatorInfo* pOperator = calloc(1, sizeof(SOperatorInfo));
+  pOperator->name          = "TopNOperator";
+  pOperator->operatorType  = OP_TopN;
+  pOperator->blockingOptr  = true;
+  pOperator->status        = OP_IN_EXECUTING;
+  pOperator->info          = pInfo;
+  pOperator->exec          = doTopN;
+  pOperator->cleanup       = destroyTopNOperatorInfo;
+  pOperator->pRuntimeEnv   = pRuntimeEnv;
+  pOperator->numOfOutput   = numOfOutput;
+  pOperator->pExpr         = pExpr;
+
+  appendUpstream(pOperator, upstream);
+  return pOperator;
+}
+
+static int32_t getTableScanOrder(STableScanInfo* pTableScanInfo) {
+  return pTableScanInfo->order;
+}
+
+// this is a blocking operator
+static SSDataBlock* doAggregate(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
     return NULL;
@@ -6420,6 +7027,99 @@ static SSDataBlock* doSessionWindowAgg(void* param, bool* newgroup) {
   return pBInfo->pRes->info.rows == 0? NULL:pBInfo->pRes;
 }
 
+// release the result rows of the groups that have been returned before the next partition is aggregated
+static void resetGroupbyResultRows(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo) {
+  SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  cleanupResultRowInfo(&pInfo->binfo.resultRowInfo);
+  if (initResultRowInfo(&pInfo->binfo.resultRowInfo, 8, TSDB_DATA_TYPE_INT) != TSDB_CODE_SUCCESS) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  taosFixedHashCleanup(pInfo->pGroupSet);
+  pInfo->pGroupSet = NULL;
+
+  taosHashClear(pRuntimeEnv->pResultRowHashTable);
+  taosHashClear(pRuntimeEnv->pResultRowListSet);
+  taosArrayClear(pRuntimeEnv->pResultRowArrayList);
+  resetResultRowPool(pRuntimeEnv->pool);
+  cleanupGroupResInfo(&pRuntimeEnv->groupResInfo);
+
+  SDiskbasedResultBuf* pResultBuf = pRuntimeEnv->pResultBuf;
+  int32_t pageSize = pResultBuf->pageSize;
+  int32_t inMemSize = pResultBuf->inMemPages * pageSize;
+
+  destroyResultBuf(pResultBuf);
+  int32_t code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, pageSize, inMemSize, GET_QID(pRuntimeEnv));
+  if (code != TSDB_CODE_SUCCESS) {
+    pRuntimeEnv->pResultBuf = NULL;
+    longjmp(pRuntimeEnv->env, code);
+  }
+}
+
+// aggregate the rows of the next spilled partition, return false if all partitions are done
+static bool doAggregateSpilledPartition(SOperatorInfo* pOperator, SGroupbyOperatorInfo *pInfo) {
+  SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  // the partitions of a lower level are aggregated before the remain partitions of the upper level
+  while (taosArrayGetSize(pInfo->pSpillList) > 0) {
+    SGroupbySpill* pSpill = taosArrayGetLast(pInfo->pSpillList);
+    SSpillBuf*     pSpillBuf = pSpill->pSpillBuf;
+
+    if (pSpill->partition >= pSpillBuf->numOfPartitions) {
+      destroySpillBuf(pSpillBuf);
+      taosArrayPop(pInfo->pSpillList);
+      continue;
+    }
+
+    int32_t partition = pSpill->partition++;
+    if (spillBufGetNumOfRows(pSpillBuf, partition) == 0) {
+      continue;
+    }
+
+    qDebug("QInfo:0x%"PRIx64" aggregate spilled partition:%d, level:%d, rows:%"PRId64, GET_QID(pRuntimeEnv), partition,
+           pSpillBuf->level, spillBufGetNumOfRows(pSpillBuf, partition));
+
+    resetGroupbyResultRows(pOperator, pInfo);
+    pInfo->spillLevel = pSpillBuf->level + 1;
+
+    int32_t code = spillBufBeginRead(pSpillBuf, partition);
+    if (code != TSDB_CODE_SUCCESS) {
+      longjmp(pRuntimeEnv->env, code);
+    }
+
+    STableQueryInfo* current = pRuntimeEnv->current;
+    while (1) {
+      if (isQueryKilled(pRuntimeEnv->qinfo)) {
+        longjmp(pRuntimeEnv->env, TSDB_CODE_TSC_QUERY_CANCELLED);
+      }
+
+      int64_t      tag = 0;
+      SSDataBlock* pBlock = NULL;
+      code = spillBufReadNext(pSpillBuf, partition, &tag, &pBlock);
+      if (code != TSDB_CODE_SUCCESS) {
+        longjmp(pRuntimeEnv->env, code);
+      }
+
+      if (pBlock == NULL) {
+        break;
+      }
+
+      // the rows of a run are from the same table
+      pRuntimeEnv->current = (STableQueryInfo*)(intptr_t)tag;
+      setInputDataBlock(pOperator, pInfo->binfo.pCtx, pBlock, pRuntimeEnv->pQueryAttr->order.order);
+      setTagValue(pOperator, pRuntimeEnv->current->pTable, pInfo->binfo.pCtx, pOperator->numOfOutput);
+      doHashGroupbyAgg(pOperator, pInfo, pBlock);
+    }
+
+    pRuntimeEnv->current = current;
+    spillBufRemovePartition(pSpillBuf, partition);
+    return true;
+  }
+
+  return false;
+}
+
 static SSDataBlock* hashGroupbyAggregate(void* param, bool* newgroup) {
   SOperatorInfo* pOperator = (SOperatorInfo*) param;
   if (pOperator->status == OP_EXEC_DONE) {
@@ -6433,30 +7133,48 @@ static SSDataBlock* hashGroupbyAggregate(void* param, bool* newgroup) {
     toSSDataBlock(&pRuntimeEnv->groupResInfo, pRuntimeEnv, pInfo->binfo.pRes);
 
     if (pInfo->binfo.pRes->info.rows == 0 || !hasRemainDataInCurrentGroup(&pRuntimeEnv->groupResInfo)) {
-      pOperator->status = OP_EXEC_DONE;
+      pOperator->status = (taosArrayGetSize(pInfo->pSpillList) > 0)? OP_IN_EXECUTING:OP_EXEC_DONE;
     }
 
-    return pInfo->binfo.pRes;
+    if (pInfo->binfo.pRes->info.rows > 0 || pOperator->status == OP_EXEC_DONE) {
+      return pInfo->binfo.pRes;
+    }
   }
 
-  SOperatorInfo* upstream = pOperator->upstream[0];
+  if (pInfo->pSpillList == NULL) {
+    SOperatorInfo* upstream = pOperator->upstream[0];
 
-  while(1) {
-    publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
-    SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
-    if (pBlock == NULL) {
-      break;
+    while(1) {
+      publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
+      SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
+      publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+      if (pBlock == NULL) {
+        break;
+      }
+
+      // the pDataBlock are always the same one, no need to call this again
+      setInputDataBlock(pOperator, pInfo->binfo.pCtx, pBlock, pRuntimeEnv->pQueryAttr->order.order);
+      setTagValue(pOperator, pRuntimeEnv->current->pTable, pInfo->binfo.pCtx, pOperator->numOfOutput);
+      if (pInfo->colIndex == -1) {
+        pInfo->colIndex = getGroupbyColumnIndex(pRuntimeEnv->pQueryAttr->pGroupbyExpr, pBlock);
+      }
+
+      doHashGroupbyAgg(pOperator, pInfo, pBlock);
     }
 
-    // the pDataBlock are always the same one, no need to call this again
-    setInputDataBlock(pOperator, pInfo->binfo.pCtx, pBlock, pRuntimeEnv->pQueryAttr->order.order);
-    setTagValue(pOperator, pRuntimeEnv->current->pTable, pInfo->binfo.pCtx, pOperator->numOfOutput);
-    if (pInfo->colIndex == -1) {
-      pInfo->colIndex = getGroupbyColumnIndex(pRuntimeEnv->pQueryAttr->pGroupbyExpr, pBlock);
+    pInfo->pSpillList = taosArrayInit(4, sizeof(SGroupbySpill));
+    if (pInfo->pSpillList == NULL) {
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
     }
+  } else if (!doAggregateSpilledPartition(pOperator, pInfo)) {
+    pOperator->status = OP_EXEC_DONE;
+    return NULL;
+  }
 
-    doHashGroupbyAgg(pOperator, pInfo, pBlock);
+  if (pInfo->pSpillBuf != NULL) {
+    SGroupbySpill spill = {.pSpillBuf = pInfo->pSpillBuf, .partition = 0};
+    taosArrayPush(pInfo->pSpillList, &spill);
+    pInfo->pSpillBuf = NULL;
   }
 
   pOperator->status = OP_RES_TO_RETURN;
@@ -6477,7 +7195,7 @@ static SSDataBlock* hashGroupbyAggregate(void* param, bool* newgroup) {
   toSSDataBlock(&pRuntimeEnv->groupResInfo, pRuntimeEnv, pInfo->binfo.pRes);
 
   if (pInfo->binfo.pRes->info.rows == 0 || !hasRemainDataInCurrentGroup(&pRuntimeEnv->groupResInfo)) {
-    pOperator->status = OP_EXEC_DONE;
+    pOperator->status = (taosArrayGetSize(pInfo->pSpillList) > 0)? OP_IN_EXECUTING:OP_EXEC_DONE;
   }
 
   return pInfo->binfo.pRes;
@@ -6689,6 +7407,18 @@ static void destroyGroupbyOperatorInfo(void* param, int32_t numOfOutput) {
   SGroupbyOperatorInfo* pInfo = (SGroupbyOperatorInfo*) param;
   doDestroyBasicInfo(&pInfo->binfo, numOfOutput);
   tfree(pInfo->prevData);
+  taosFixedHashCleanup(pInfo->pGroupSet);
+  destroySpillBuf(pInfo->pSpillBuf);
+
+  if (pInfo->pSpillList != NULL) {
+    size_t num = taosArrayGetSize(pInfo->pSpillList);
+    for (int32_t i = 0; i < num; ++i) {
+      SGroupbySpill* pSpill = taosArrayGet(pInfo->pSpillList, i);
+      destroySpillBuf(pSpill->pSpillBuf);
+    }
+
+    taosArrayDestroy(pInfo->pSpillList);
+  }
 }
 
 static void destroyProjectOperatorInfo(void* param, int32_t numOfOutput) {
@@ -6704,6 +7434,27 @@ static void destroyTagScanOperatorInfo(void* param, int32_t numOfOutput) {
 static void destroyOrderOperatorInfo(void* param, int32_t numOfOutput) {
   SOrderOperatorInfo* pInfo = (SOrderOperatorInfo*) param;
   pInfo->pDataBlock = destroyOutputBuf(pInfo->pDataBlock);
+  pInfo->pRes = destroyOutputBuf(pInfo->pRes);
+
+  sortMergerDestroy(pInfo->pMerger);
+  if (pInfo->pSources != NULL) {
+    size_t num = taosArrayGetSize(pInfo->pSources);
+    for (int32_t i = 0; i < num; ++i) {
+      SSortSource* pSource = taosArrayGet(pInfo->pSources, i);
+      destroySpillBuf(pSource->pSpillBuf);
+    }
+
+    taosArrayDestroy(pInfo->pSources);
+  }
+
+  tfree(pInfo->pIndex);
+}
+
+static void destroyTopNOperatorInfo(void* param, int32_t numOfOutput) {
+  STopNOperatorInfo* pInfo = (STopNOperatorInfo*) param;
+  pInfo->pDataBlock = destroyOutputBuf(pInfo->pDataBlock);
+  pInfo->pRes = destroyOutputBuf(pInfo->pRes);
+  tfree(pInfo->pHeap);
 }
 
 static void destroyConditionOperatorInfo(void* param, int32_t numOfOutput) {
@@ -6711,9 +7462,18 @@ static void destroyConditionOperatorInfo(void* param, int32_t numOfOutput) {
   doDestroyFilterInfo(pInfo->pFilterInfo, pInfo->numOfFilterCols);
 }
 
+static void destroyParallelAggOperatorInfo(void* param, int32_t numOfOutput) {
+  SParallelAggOperatorInfo* pInfo = (SParallelAggOperatorInfo*) param;
+  destroyOutputBufList(pInfo->pResBlocks);
+  pInfo->pResBlocks = NULL;
+
+  pthread_mutex_destroy(&pInfo->mutex);
+  pthread_cond_destroy(&pInfo->finished);
+}
+
 static void destroyDistinctOperatorInfo(void* param, int32_t numOfOutput) {
   SDistinctOperatorInfo* pInfo = (SDistinctOperatorInfo*) param;
-  taosHashCleanup(pInfo->pSet);
+  taosFixedHashCleanup(pInfo->pSet);
   tfree(pInfo->buf);
   taosArrayDestroy(pInfo->pDistinctDataInfo);
   pInfo->pRes = destroyOutputBuf(pInfo->pRes);
@@ -6745,6 +7505,629 @@ SOperatorInfo* createMultiTableAggOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SO
   return pOperator;
 }
 
+// the results of a group aggregated from different parts of its tables can be merged into one, if all the output
+// functions have small fixed intermediate results, and the windows are identified by the ts column
+static bool isMergeableSTableQuery(SQueryAttr* pQueryAttr) {
+  if (!pQueryAttr->stableQuery) {
+    return false;
+  }
+
+  bool hasTs = false;
+  for (int32_t i = 0; i < pQueryAttr->numOfOutput; ++i) {
+    int32_t functionId = pQueryAttr->pExpr1[i].base.functionId;
+    if (functionId == TSDB_FUNC_TS && QUERY_IS_INTERVAL_QUERY(pQueryAttr)) {
+      hasTs = true;
+      continue;
+    }
+
+    if (!isMergeableSTableResult(functionId)) {
+      return false;
+    }
+  }
+
+  return hasTs || !QUERY_IS_INTERVAL_QUERY(pQueryAttr);
+}
+
+// The table groups of a super table query are independent from each other, so they can be aggregated by several
+// workers at the same time, each one with its own tsdb query handle, result row hash table and result buffer. A
+// query of only one group has its tables split across the workers instead, if the results can be merged.
+// Everything kept in SQueryAttr is shared by the workers, so the queries that update it during the scan, e.g. the
+// column filters, the ts join, the repeat/reverse scan or udf, are executed by a single thread as before.
+static bool isParallelAggQuery(SQueryRuntimeEnv* pRuntimeEnv) {
+  SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  size_t numOfGroups = GET_NUM_OF_TABLEGROUP(pRuntimeEnv);
+  if (tsQueryParallelThreads <= 1 || pQueryAttr->tsdb == NULL || numOfGroups == 0) {
+    return false;
+  }
+
+  if (numOfGroups == 1 &&
+      (pRuntimeEnv->tableqinfoGroupInfo.numOfTables <= 1 || !isMergeableSTableQuery(pQueryAttr))) {
+    return false;
+  }
+
+  if (pRuntimeEnv->proot == NULL || pRuntimeEnv->proot->operatorType != OP_TableScan ||
+      getNumOfScanTimes(pQueryAttr) != 1) {
+    return false;
+  }
+
+  return pQueryAttr->pFilters == NULL && pRuntimeEnv->pTsBuf == NULL && pRuntimeEnv->pUdfInfo == NULL &&
+         !pQueryAttr->pointInterpQuery && !isFirstLastRowQuery(pQueryAttr) && !isCachedLastQuery(pQueryAttr);
+}
+
+static SSDataBlock* copyOutputBuf(SOperatorInfo* pOperator, SSDataBlock* pBlock) {
+  SSDataBlock* pDst = createOutputBuf(pOperator->pExpr, pOperator->numOfOutput, pBlock->info.rows);
+  pDst->info = pBlock->info;
+
+  for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData* pSrcCol = taosArrayGet(pBlock->pDataBlock, i);
+    SColumnInfoData* pDstCol = taosArrayGet(pDst->pDataBlock, i);
+    memcpy(pDstCol->pData, pSrcCol->pData, (size_t)pSrcCol->info.bytes * pBlock->info.rows);
+  }
+
+  return pDst;
+}
+
+// the in-memory pages of the workers share the query buffer of the dnode if it is limited, or those of the query
+static int32_t getQueryWorkerBufSize(SQueryAttr* pQueryAttr, int32_t pageSize, int32_t numOfWorkers) {
+  int64_t size = getResultBufInMemSize(pQueryAttr);
+  if (tsQueryBufferSize > 0) {
+    size = ((int64_t)tsQueryBufferSize) * 1048576L;
+  }
+
+  size = MIN(size / numOfWorkers, INT32_MAX);
+  return (int32_t)MAX(size, pageSize);
+}
+
+// the tables of the worker in a split group, both the key list for tsdb and the query info list are created
+static int32_t createQueryWorkerTableList(SQueryRuntimeEnv* pRuntimeEnv, SQueryWorker* pWorker, SArray** pKeyList) {
+  SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  SArray* group = GET_TABLEGROUP(pRuntimeEnv, pWorker->startGroup);
+  SArray* pKeyInfo = taosArrayGetP(pQueryAttr->tableGroupInfo.pGroupList, pWorker->startGroup);
+  int32_t num = pWorker->endTable - pWorker->startTable;
+
+  pWorker->pTableList = taosArrayInit(num, POINTER_BYTES);
+  *pKeyList = taosArrayInit(num, sizeof(STableKeyInfo));
+  if (pWorker->pTableList == NULL || *pKeyList == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = pWorker->startTable; i < pWorker->endTable; ++i) {
+    taosArrayPush(pWorker->pTableList, taosArrayGet(group, i));
+    taosArrayPush(*pKeyList, taosArrayGet(pKeyInfo, i));
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// the groups [startGroup, endGroup) are aggregated by the worker, or a part of the tables of the only group if the
+// group is split. The runtime env of a worker is set up in the same way as doInitQInfo does for the query, and it is
+// done in the query thread, since creating the tsdb query handle takes a reference of the mem snapshot of the query.
+static int32_t initQueryWorker(SQueryRuntimeEnv* pRuntimeEnv, SQueryWorker* pWorker, int32_t opType,
+                               int32_t numOfWorkers) {
+  SQInfo*     pQInfo = pRuntimeEnv->qinfo;
+  SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
+  int32_t     startGroup = pWorker->startGroup;
+  int32_t     endGroup = pWorker->endGroup;
+
+  SQInfo* pWorkerInfo = &pWorker->qinfo;
+  pWorkerInfo->signature = pWorkerInfo;
+  pWorkerInfo->qId       = pQInfo->qId;
+  pWorkerInfo->owner     = 0;   // the idle check of the query is done by the query thread
+
+  SQueryRuntimeEnv* pEnv = &pWorkerInfo->runtimeEnv;
+  pEnv->qinfo      = pWorkerInfo;
+  pEnv->pQueryAttr = pQueryAttr;
+  pEnv->prevResult = pRuntimeEnv->prevResult;
+  pEnv->udfIsCopy  = true;
+  pEnv->cur.vgroupIndex = -1;
+  setResultBufSize(pQueryAttr, &pEnv->resultInfo);
+
+  pWorker->pResBlocks = taosArrayInit(4, POINTER_BYTES);
+
+  STableGroupInfo* pTableqinfoGroupInfo = &pEnv->tableqinfoGroupInfo;
+  pTableqinfoGroupInfo->map = pRuntimeEnv->tableqinfoGroupInfo.map;
+  pTableqinfoGroupInfo->pGroupList = taosArrayInit(endGroup - startGroup, POINTER_BYTES);
+
+  STableGroupInfo groupInfo = {.pGroupList = taosArrayInit(endGroup - startGroup, POINTER_BYTES)};
+  if (pWorker->pResBlocks == NULL || pTableqinfoGroupInfo->pGroupList == NULL || groupInfo.pGroupList == NULL) {
+    taosArrayDestroy(groupInfo.pGroupList);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  SArray* pKeyList = NULL;
+  if (pWorker->pParent->splitGroup) {
+    int32_t code = createQueryWorkerTableList(pRuntimeEnv, pWorker, &pKeyList);
+    if (code != TSDB_CODE_SUCCESS) {
+      taosArrayDestroy(pKeyList);
+      taosArrayDestroy(groupInfo.pGroupList);
+      return code;
+    }
+
+    taosArrayPush(pTableqinfoGroupInfo->pGroupList, &pWorker->pTableList);
+    taosArrayPush(groupInfo.pGroupList, &pKeyList);
+    pTableqinfoGroupInfo->numOfTables = (uint32_t)taosArrayGetSize(pWorker->pTableList);
+  } else {
+    for (int32_t i = startGroup; i < endGroup; ++i) {
+      SArray* group = GET_TABLEGROUP(pRuntimeEnv, i);
+      taosArrayPush(pTableqinfoGroupInfo->pGroupList, &group);
+      pTableqinfoGroupInfo->numOfTables += (uint32_t)taosArrayGetSize(group);
+
+      SArray* pKeyInfo = taosArrayGetP(pQueryAttr->tableGroupInfo.pGroupList, i);
+      taosArrayPush(groupInfo.pGroupList, &pKeyInfo);
+    }
+  }
+
+  groupInfo.numOfTables = pTableqinfoGroupInfo->numOfTables;
+
+  // the result rows are identified by the index of table group in the whole query
+  pEnv->groupResInfo.currentGroup = startGroup;
+  pEnv->groupResInfo.totalGroup   = endGroup;
+
+  terrno = TSDB_CODE_SUCCESS;
+  STsdbQueryCond cond = createTsdbQueryCond(pQueryAttr, &pQueryAttr->window);
+  pEnv->pQueryHandle = tsdbQueryTables(pQueryAttr->tsdb, &cond, &groupInfo, pQInfo->qId, &pQueryAttr->memRef);
+  taosArrayDestroy(groupInfo.pGroupList);
+  taosArrayDestroy(pKeyList);
+
+  if (pEnv->pQueryHandle == NULL) {
+    return (terrno != TSDB_CODE_SUCCESS)? terrno:TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  int32_t ps = DEFAULT_PAGE_SIZE;
+  int32_t rowSize = 0;
+  getIntermediateBufInfo(pEnv, &ps, &rowSize);
+
+  int32_t code = createDiskbasedResultBuffer(&pEnv->pResultBuf, ps, getQueryWorkerBufSize(pQueryAttr, ps, numOfWorkers),
+                                             pQInfo->qId);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SArray* pOperator = taosArrayInit(1, sizeof(int32_t));
+  code = setupQueryRuntimeEnv(pEnv, (int32_t)pTableqinfoGroupInfo->numOfTables, pOperator, NULL);
+  taosArrayDestroy(pOperator);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  pEnv->proot = createTableScanOperator(pEnv->pQueryHandle, pEnv, 1);
+  if (opType == OP_MultiTableAggregate) {
+    pEnv->proot = createMultiTableAggOperatorInfo(pEnv, pEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput);
+  } else {
+    assert(opType == OP_MultiTableTimeInterval);
+    pEnv->proot = createMultiTableTimeIntervalOperatorInfo(pEnv, pEnv->proot, pQueryAttr->pExpr1, pQueryAttr->numOfOutput);
+  }
+
+  setTableScanFilterOperatorInfo(pEnv->proot->upstream[0]->info, pEnv->proot);
+  setQueryStatus(pEnv, QUERY_NOT_COMPLETED);
+
+  qDebug("QInfo:0x%"PRIx64" worker:%p created for table group %d-%d, numOfTables:%u", pQInfo->qId, pWorker,
+         startGroup, endGroup - 1, pTableqinfoGroupInfo->numOfTables);
+  return TSDB_CODE_SUCCESS;
+}
+
+// the table query info is owned by the query, but the result rows it refers to are allocated from the result row pool
+// of the worker, so they are released before the pool is destroyed along with the worker
+static void cleanupQueryWorkerTableRes(SQueryRuntimeEnv* pEnv) {
+  size_t numOfGroups = GET_NUM_OF_TABLEGROUP(pEnv);
+  for (int32_t i = 0; i < numOfGroups; ++i) {
+    SArray* group = GET_TABLEGROUP(pEnv, i);
+
+    size_t num = taosArrayGetSize(group);
+    for (int32_t j = 0; j < num; ++j) {
+      STableQueryInfo* item = taosArrayGetP(group, j);
+      cleanupResultRowInfo(&item->resInfo);
+      item->resInfo.size = 0;
+      item->resInfo.capacity = 0;
+      item->resInfo.curPos = -1;
+    }
+  }
+}
+
+static void destroyQueryWorker(SQueryWorker* pWorker) {
+  SQueryRuntimeEnv* pEnv = &pWorker->qinfo.runtimeEnv;
+
+  if (pEnv->pQueryAttr != NULL) {
+    cleanupQueryWorkerTableRes(pEnv);
+    tsdbCleanupQueryHandle(pEnv->pQueryHandle);
+    pEnv->pQueryHandle = NULL;
+    pEnv->prevResult = NULL;  // owned by the runtime env of the query
+
+    teardownQueryRuntimeEnv(pEnv);
+    cleanupGroupResInfo(&pEnv->groupResInfo);
+    taosArrayDestroy(pEnv->tableqinfoGroupInfo.pGroupList);
+  }
+
+  taosArrayDestroy(pWorker->pTableList);
+  pWorker->pTableList = NULL;
+
+  destroyOutputBufList(pWorker->pResBlocks);
+  pWorker->pResBlocks = NULL;
+}
+
+static void addQueryWorkerCost(SQueryCostInfo* pCost, SQueryCostInfo* pWorkerCost) {
+  pCost->loadStatisTime      += pWorkerCost->loadStatisTime;
+  pCost->loadFileBlockTime   += pWorkerCost->loadFileBlockTime;
+  pCost->loadDataInCacheTime += pWorkerCost->loadDataInCacheTime;
+  pCost->loadStatisSize      += pWorkerCost->loadStatisSize;
+  pCost->loadFileBlockSize   += pWorkerCost->loadFileBlockSize;
+  pCost->loadDataInCacheSize += pWorkerCost->loadDataInCacheSize;
+  pCost->loadDataTime        += pWorkerCost->loadDataTime;
+  pCost->totalRows           += pWorkerCost->totalRows;
+  pCost->totalCheckedRows    += pWorkerCost->totalCheckedRows;
+  pCost->totalBlocks         += pWorkerCost->totalBlocks;
+  pCost->loadBlocks          += pWorkerCost->loadBlocks;
+  pCost->loadBlockStatis     += pWorkerCost->loadBlockStatis;
+  pCost->discardBlocks       += pWorkerCost->discardBlocks;
+  pCost->statisHitBlocks     += pWorkerCost->statisHitBlocks;
+  pCost->firstStageMergeTime += pWorkerCost->firstStageMergeTime;
+  pCost->numOfTimeWindows    += pWorkerCost->numOfTimeWindows;
+}
+
+static void* parallelAggWorkerFunc(void* param) {
+  SQueryWorker*     pWorker = param;
+  SQueryRuntimeEnv* pEnv = &pWorker->qinfo.runtimeEnv;
+  SOperatorInfo*    pOperator = pEnv->proot;
+
+  setThreadName("queryWorker");
+
+  int32_t code = setjmp(pEnv->env);
+  if (code != TSDB_CODE_SUCCESS) {
+    pWorker->code = code;
+    qDebug("QInfo:0x%"PRIx64" worker:%p abort due to error/cancel occurs, code:%s", pWorker->qinfo.qId, pWorker,
+           tstrerror(code));
+  } else {
+    bool newgroup = false;
+
+    SSDataBlock* pBlock = NULL;
+    while ((pBlock = pOperator->exec(pOperator, &newgroup)) != NULL) {
+      if (pBlock->info.rows > 0) {
+        SSDataBlock* pRes = copyOutputBuf(pOperator, pBlock);
+        taosArrayPush(pWorker->pResBlocks, &pRes);
+      }
+    }
+  }
+
+  SParallelAggOperatorInfo* pInfo = pWorker->pParent;
+  pthread_mutex_lock(&pInfo->mutex);
+  pInfo->numOfRunning -= 1;
+  pthread_cond_signal(&pInfo->finished);
+  pthread_mutex_unlock(&pInfo->mutex);
+
+  return NULL;
+}
+
+// wait for the completion of the workers, the cancellation of the query is passed to the workers in the meanwhile
+static void waitForQueryWorkers(SParallelAggOperatorInfo* pInfo, SQInfo* pQInfo, SQueryWorker* pWorkers,
+                                int32_t numOfWorkers) {
+  pthread_mutex_lock(&pInfo->mutex);
+  while (pInfo->numOfRunning > 0) {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += 100 * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec += 1;
+      ts.tv_nsec -= 1000000000L;
+    }
+
+    pthread_cond_timedwait(&pInfo->finished, &pInfo->mutex, &ts);
+
+    if (isQueryKilled(pQInfo)) {
+      for (int32_t i = 0; i < numOfWorkers; ++i) {
+        setQueryKilled(&pWorkers[i].qinfo);
+      }
+    }
+  }
+  pthread_mutex_unlock(&pInfo->mutex);
+
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    if (pWorkers[i].started) {
+      pthread_join(pWorkers[i].thread, NULL);
+    }
+  }
+}
+
+// each worker gets a range of consecutive table groups with about the same number of tables, so the results of
+// workers are concatenated in the order of table group, the same as the single thread aggregation
+static void splitQueryWorkerGroups(SQueryRuntimeEnv* pRuntimeEnv, SQueryWorker* pWorkers, int32_t numOfWorkers) {
+  int32_t numOfGroups = (int32_t)GET_NUM_OF_TABLEGROUP(pRuntimeEnv);
+  int32_t numOfTables = (int32_t)pRuntimeEnv->tableqinfoGroupInfo.numOfTables;
+
+  int32_t start = 0;
+  int64_t total = 0;
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    int32_t end = start;
+    int32_t maxEnd = numOfGroups - (numOfWorkers - i - 1);
+    int64_t expected = ((int64_t)numOfTables) * (i + 1) / numOfWorkers;
+
+    do {
+      total += taosArrayGetSize(GET_TABLEGROUP(pRuntimeEnv, end));
+      end += 1;
+    } while (end < maxEnd && (total < expected || i == numOfWorkers - 1));
+
+    pWorkers[i].startGroup = start;
+    pWorkers[i].endGroup   = end;
+    start = end;
+  }
+}
+
+// each worker gets about the same number of tables of the only group
+static void splitQueryWorkerTables(SQueryRuntimeEnv* pRuntimeEnv, SQueryWorker* pWorkers, int32_t numOfWorkers) {
+  int32_t numOfTables = (int32_t)taosArrayGetSize(GET_TABLEGROUP(pRuntimeEnv, 0));
+
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    pWorkers[i].startGroup = 0;
+    pWorkers[i].endGroup   = 1;
+    pWorkers[i].startTable = (int32_t)(((int64_t)numOfTables) * i / numOfWorkers);
+    pWorkers[i].endTable   = (int32_t)(((int64_t)numOfTables) * (i + 1) / numOfWorkers);
+  }
+}
+
+static TSKEY getQueryWorkerResKey(SSDataBlock* pBlock, int32_t tsIndex, int32_t rowIndex) {
+  if (tsIndex < 0) {
+    return 0;  // only one result row of the group without interval
+  }
+
+  SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, tsIndex);
+  return ((TSKEY*)pColInfo->pData)[rowIndex];
+}
+
+static void mergeQueryWorkerResRow(SOperatorInfo* pOperator, SSDataBlock* pDst, int32_t dstIndex, SSDataBlock* pSrc,
+                                   int32_t srcIndex) {
+  for (int32_t i = 0; i < pOperator->numOfOutput; ++i) {
+    SSqlExpr*        pExpr = &pOperator->pExpr[i].base;
+    SColumnInfoData* pDstCol = taosArrayGet(pDst->pDataBlock, i);
+    SColumnInfoData* pSrcCol = taosArrayGet(pSrc->pDataBlock, i);
+
+    char* pDstData = pDstCol->pData + pDstCol->info.bytes * dstIndex;
+    char* pSrcData = pSrcCol->pData + pSrcCol->info.bytes * srcIndex;
+    if (pExpr->functionId == TSDB_FUNC_TS) {
+      continue;
+    }
+
+    mergeSTableResult(pExpr->functionId, pExpr->colType, pExpr->colBytes, pDstData, pSrcData);
+  }
+}
+
+static void copyQueryWorkerResRow(SSDataBlock* pDst, int32_t dstIndex, SSDataBlock* pSrc, int32_t srcIndex) {
+  for (int32_t i = 0; i < pDst->info.numOfCols; ++i) {
+    SColumnInfoData* pDstCol = taosArrayGet(pDst->pDataBlock, i);
+    SColumnInfoData* pSrcCol = taosArrayGet(pSrc->pDataBlock, i);
+    memcpy(pDstCol->pData + pDstCol->info.bytes * dstIndex, pSrcCol->pData + pSrcCol->info.bytes * srcIndex,
+           pDstCol->info.bytes);
+  }
+}
+
+// The results of workers on a split group are sorted by the time window in the query order. They are merged by a
+// k-way merge, the rows of the same window from different workers are merged into one.
+static int32_t mergeQueryWorkerRes(SOperatorInfo* pOperator, SQueryWorker* pWorkers, int32_t numOfWorkers) {
+  SParallelAggOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*         pRuntimeEnv = pOperator->pRuntimeEnv;
+  SQueryAttr*               pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  int32_t tsIndex = -1;
+  for (int32_t i = 0; i < pOperator->numOfOutput && QUERY_IS_INTERVAL_QUERY(pQueryAttr); ++i) {
+    if (pOperator->pExpr[i].base.functionId == TSDB_FUNC_TS) {
+      tsIndex = i;
+      break;
+    }
+  }
+
+  int32_t* blockIndex = calloc(numOfWorkers, sizeof(int32_t));
+  int32_t* rowIndex   = calloc(numOfWorkers, sizeof(int32_t));
+  if (blockIndex == NULL || rowIndex == NULL) {
+    tfree(blockIndex);
+    tfree(rowIndex);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  bool         asc = QUERY_IS_ASC_QUERY(pQueryAttr);
+  int32_t      capacity = MAX(pRuntimeEnv->resultInfo.capacity, 1);
+  SSDataBlock* pRes = NULL;
+  TSKEY        lastKey = 0;
+
+  while (1) {
+    int32_t next = -1;
+    TSKEY   nextKey = 0;
+    for (int32_t i = 0; i < numOfWorkers; ++i) {
+      if (blockIndex[i] >= taosArrayGetSize(pWorkers[i].pResBlocks)) {
+        continue;
+      }
+
+      SSDataBlock* pBlock = taosArrayGetP(pWorkers[i].pResBlocks, blockIndex[i]);
+      TSKEY        key = getQueryWorkerResKey(pBlock, tsIndex, rowIndex[i]);
+      if (next < 0 || (asc && key < nextKey) || (!asc && key > nextKey)) {
+        next = i;
+        nextKey = key;
+      }
+    }
+
+    if (next < 0) {
+      break;
+    }
+
+    SSDataBlock* pSrc = taosArrayGetP(pWorkers[next].pResBlocks, blockIndex[next]);
+    if (pRes != NULL && pRes->info.rows > 0 && lastKey == nextKey) {
+      mergeQueryWorkerResRow(pOperator, pRes, pRes->info.rows - 1, pSrc, rowIndex[next]);
+    } else {
+      if (pRes == NULL || pRes->info.rows >= capacity) {
+        pRes = createOutputBuf(pOperator->pExpr, pOperator->numOfOutput, capacity);
+        pRes->info = pSrc->info;
+        pRes->info.rows = 0;
+        taosArrayPush(pInfo->pResBlocks, &pRes);
+      }
+
+      copyQueryWorkerResRow(pRes, pRes->info.rows, pSrc, rowIndex[next]);
+      pRes->info.rows += 1;
+      lastKey = nextKey;
+    }
+
+    if (++rowIndex[next] >= pSrc->info.rows) {
+      blockIndex[next] += 1;
+      rowIndex[next] = 0;
+    }
+  }
+
+  tfree(blockIndex);
+  tfree(rowIndex);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doParallelAggregateImpl(SOperatorInfo* pOperator) {
+  SParallelAggOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv*         pRuntimeEnv = pOperator->pRuntimeEnv;
+  SQInfo*                   pQInfo = pRuntimeEnv->qinfo;
+
+  int32_t numOfGroups  = (int32_t)GET_NUM_OF_TABLEGROUP(pRuntimeEnv);
+  int32_t numOfWorkers = 0;
+  if (pInfo->splitGroup) {
+    numOfWorkers = MIN(tsQueryParallelThreads, (int32_t)taosArrayGetSize(GET_TABLEGROUP(pRuntimeEnv, 0)));
+  } else {
+    numOfWorkers = MIN(tsQueryParallelThreads, numOfGroups);
+  }
+
+  SQueryWorker* pWorkers = calloc(numOfWorkers, sizeof(SQueryWorker));
+  if (pWorkers == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  if (pInfo->splitGroup) {
+    splitQueryWorkerTables(pRuntimeEnv, pWorkers, numOfWorkers);
+  } else {
+    splitQueryWorkerGroups(pRuntimeEnv, pWorkers, numOfWorkers);
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < numOfWorkers && code == TSDB_CODE_SUCCESS; ++i) {
+    pWorkers[i].pParent = pInfo;
+    code = initQueryWorker(pRuntimeEnv, &pWorkers[i], pInfo->opType, numOfWorkers);
+  }
+
+  int64_t st = taosGetTimestampUs();
+  pInfo->numOfRunning = 0;
+
+  for (int32_t i = 0; i < numOfWorkers && code == TSDB_CODE_SUCCESS; ++i) {
+    pthread_mutex_lock(&pInfo->mutex);
+    pInfo->numOfRunning += 1;
+    pthread_mutex_unlock(&pInfo->mutex);
+
+    if (pthread_create(&pWorkers[i].thread, NULL, parallelAggWorkerFunc, &pWorkers[i]) != 0) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      qError("QInfo:0x%"PRIx64" failed to create query worker thread, reason:%s", pQInfo->qId, strerror(errno));
+
+      pthread_mutex_lock(&pInfo->mutex);
+      pInfo->numOfRunning -= 1;
+      pthread_mutex_unlock(&pInfo->mutex);
+
+      // let the started workers stop as soon as possible
+      for (int32_t j = 0; j < i; ++j) {
+        setQueryKilled(&pWorkers[j].qinfo);
+      }
+    } else {
+      pWorkers[i].started = true;
+    }
+  }
+
+  waitForQueryWorkers(pInfo, pQInfo, pWorkers, numOfWorkers);
+
+  for (int32_t i = 0; i < numOfWorkers && code == TSDB_CODE_SUCCESS; ++i) {
+    code = pWorkers[i].code;
+  }
+
+  if (code == TSDB_CODE_SUCCESS && pInfo->splitGroup) {
+    code = mergeQueryWorkerRes(pOperator, pWorkers, numOfWorkers);
+  }
+
+  for (int32_t i = 0; i < numOfWorkers; ++i) {
+    SQueryWorker* pWorker = &pWorkers[i];
+
+    if (code == TSDB_CODE_SUCCESS && !pInfo->splitGroup) {
+      taosArrayAddAll(pInfo->pResBlocks, pWorker->pResBlocks);
+      taosArrayClear(pWorker->pResBlocks);
+    }
+
+    addQueryWorkerCost(&pQInfo->summary, &pWorker->qinfo.summary);
+    tsdbGetQueryCost(pWorker->qinfo.runtimeEnv.pQueryHandle, &pQInfo->summary.ioCost);
+    destroyQueryWorker(pWorker);
+  }
+
+  tfree(pWorkers);
+
+  qDebug("QInfo:0x%"PRIx64" %d workers completed on %d table groups, %"PRIzu" result blocks, elapsed time:%"PRId64"us, code:%s",
+         pQInfo->qId, numOfWorkers, numOfGroups, taosArrayGetSize(pInfo->pResBlocks), taosGetTimestampUs() - st,
+         tstrerror(code));
+  return code;
+}
+
+static SSDataBlock* doParallelAggregate(void* param, bool* newgroup) {
+  SOperatorInfo* pOperator = (SOperatorInfo*) param;
+  if (pOperator->status == OP_EXEC_DONE) {
+    return NULL;
+  }
+
+  SParallelAggOperatorInfo* pInfo = pOperator->info;
+  SQueryRuntimeEnv* pRuntimeEnv = pOperator->pRuntimeEnv;
+
+  *newgroup = false;
+
+  if (pOperator->status == OP_IN_EXECUTING) {
+    int32_t code = doParallelAggregateImpl(pOperator);
+    if (code != TSDB_CODE_SUCCESS) {
+      longjmp(pRuntimeEnv->env, code);
+    }
+
+    pOperator->status = OP_RES_TO_RETURN;
+  }
+
+  int32_t numOfBlocks = (int32_t)taosArrayGetSize(pInfo->pResBlocks);
+  if (pInfo->resIndex >= numOfBlocks) {
+    doSetOperatorCompleted(pOperator);
+    return NULL;
+  }
+
+  SSDataBlock* pBlock = taosArrayGetP(pInfo->pResBlocks, pInfo->resIndex);
+  if (++pInfo->resIndex >= numOfBlocks) {
+    doSetOperatorCompleted(pOperator);
+  }
+
+  return pBlock;
+}
+
+SOperatorInfo* createParallelAggOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, int32_t opType) {
+  SParallelAggOperatorInfo* pInfo = calloc(1, sizeof(SParallelAggOperatorInfo));
+
+  pInfo->opType     = opType;
+  pInfo->splitGroup = (GET_NUM_OF_TABLEGROUP(pRuntimeEnv) == 1);
+  pInfo->pResBlocks = taosArrayInit(4, POINTER_BYTES);
+  pthread_mutex_init(&pInfo->mutex, NULL);
+  pthread_cond_init(&pInfo->finished, NULL);
+
+  SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  SOperatorInfo* pOperator = calloc(1, sizeof(SOperatorInfo));
+  pOperator->name         = "ParallelAggregate";
+  pOperator->operatorType = OP_ParallelAggregate;
+  pOperator->blockingOptr = true;
+  pOperator->status       = OP_IN_EXECUTING;
+  pOperator->info         = pInfo;
+  pOperator->pExpr        = pQueryAttr->pExpr1;
+  pOperator->numOfOutput  = pQueryAttr->numOfOutput;
+  pOperator->pRuntimeEnv  = pRuntimeEnv;
+
+  pOperator->exec         = doParallelAggregate;
+  pOperator->cleanup      = destroyParallelAggOperatorInfo;
+
+  // the table scan operator of the query is kept only to be released along with this operator, each worker scans
+  // its own tables
+  appendUpstream(pOperator, upstream);
+
+  qDebug("QInfo:0x%"PRIx64" aggregate %"PRIzu" table groups by at most %d threads, split group:%d", GET_QID(pRuntimeEnv),
+         GET_NUM_OF_TABLEGROUP(pRuntimeEnv), tsQueryParallelThreads, pInfo->splitGroup);
+  return pOperator;
+}
+
 SOperatorInfo* createProjectOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput) {
   SProjectOperatorInfo* pInfo = calloc(1, sizeof(SProjectOperatorInfo));
 
@@ -6998,6 +8381,7 @@ SOperatorInfo* createAllMultiTableTimeIntervalOperatorInfo(SQueryRuntimeEnv* pRu
 SOperatorInfo* createGroupbyOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperatorInfo* upstream, SExprInfo* pExpr, int32_t numOfOutput) {
   SGroupbyOperatorInfo* pInfo = calloc(1, sizeof(SGroupbyOperatorInfo));
   pInfo->colIndex = -1;  // group by column index
+  pInfo->maxGroups = -1;
 
 
   pInfo->binfo.pCtx = createSQLFunctionCtx(pRuntimeEnv, pExpr, numOfOutput, &pInfo->binfo.rowCellInfoOffset);
@@ -7272,8 +8656,16 @@ static bool initMultiDistinctInfo(SDistinctOperatorInfo *pInfo, SOperatorInfo* p
      // distinct info already inited  
     return true;
   }
+
+  // a previous block did not have all the columns, start over without leaking what was set up for it
+  pInfo->totalBytes = 0;
+  taosArrayClear(pInfo->pDistinctDataInfo);
+  tfree(pInfo->buf);
+  taosFixedHashCleanup(pInfo->pSet);
+  pInfo->pSet = NULL;
+
   for (int i = 0; i < pOperator->numOfOutput; i++) {
-    pInfo->totalBytes += pOperator->pExpr[i].base.colBytes;      
+    pInfo->totalBytes += pOperator->pExpr[i].base.colBytes;
   }
   for (int i = 0; i < pOperator->numOfOutput; i++) {
     int numOfBlock = (int)(taosArrayGetSize(pBlock->pDataBlock));
@@ -7288,6 +8680,12 @@ static bool initMultiDistinctInfo(SDistinctOperatorInfo *pInfo, SOperatorInfo* p
   }
   pInfo->totalBytes += (int32_t)strlen(MULTI_KEY_DELIM) * (pOperator->numOfOutput);
   pInfo->buf        =  calloc(1, pInfo->totalBytes);
+
+  // the key is padded to totalBytes, so the distinct values of any type have a fixed width
+  pInfo->pSet = taosFixedHashInit(pInfo->totalBytes, 0, 64);
+  if (pInfo->buf == NULL || pInfo->pSet == NULL) {
+    longjmp(pOperator->pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
   return  taosArrayGetSize(pInfo->pDistinctDataInfo) == pOperator->numOfOutput ? true : false;
 }
 
@@ -7358,9 +8756,13 @@ static SSDataBlock* hashDistinct(void* param, bool* newgroup) {
 
     for (int32_t i = 0; i < pBlock->info.rows; i++) {
       buildMultiDistinctKey(pInfo, pBlock, i);
-      if (taosHashGet(pInfo->pSet, pInfo->buf, pInfo->totalBytes) == NULL) {
-        int32_t dummy;
-        taosHashPut(pInfo->pSet, pInfo->buf, pInfo->totalBytes, &dummy, sizeof(dummy));
+
+      bool exist = false;
+      if (taosFixedHashPut(pInfo->pSet, pInfo->buf, NULL, &exist) == NULL) {
+        longjmp(pOperator->pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+      }
+
+      if (!exist) {
         for (int j = 0; j < taosArrayGetSize(pRes->pDataBlock); j++) {
           SDistinctDataInfo* pDistDataInfo = taosArrayGet(pInfo->pDistinctDataInfo, j);  // distinct meta info
           SColumnInfoData*   pColInfoData = taosArrayGet(pBlock->pDataBlock, pDistDataInfo->index); //src
@@ -7388,7 +8790,6 @@ SOperatorInfo* createDistinctOperatorInfo(SQueryRuntimeEnv* pRuntimeEnv, SOperat
   pInfo->threshold       = tsMaxNumOfDistinctResults; // distinct result threshold
   pInfo->outputCapacity  = 4096;
   pInfo->pDistinctDataInfo = taosArrayInit(numOfOutput, sizeof(SDistinctDataInfo)); 
-  pInfo->pSet = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false, HASH_NO_LOCK);
   pInfo->pRes = createOutputBuf(pExpr, numOfOutput, (int32_t) pInfo->outputCapacity);
   
 
@@ -8629,6 +10030,14 @@ SQInfo* createQInfoImpl(SQueryTableMsg* pQueryMsg, SGroupbyExpr* pGroupbyExpr, S
   pQInfo->dataReady = QUERY_RESULT_NOT_READY;
   pQInfo->rspContext = NULL;
   pQInfo->sql = sql;
+
+  if (tsRetrievePrefetchBlocks > 0 && !tsRetrieveBlockingModel) {
+    pQInfo->pPrefetchRsp = taosArrayInit(tsRetrievePrefetchBlocks, sizeof(SPrefetchRsp));
+    if (pQInfo->pPrefetchRsp == NULL) {
+      goto _cleanup;
+    }
+  }
+
   pthread_mutex_init(&pQInfo->lock, NULL);
   tsem_init(&pQInfo->ready, 0, 0);
 
@@ -8888,6 +10297,18 @@ void freeQInfo(SQInfo *pQInfo) {
   taosHashCleanup(pQInfo->summary.operatorProfResults);
 
   taosArrayDestroy(pRuntimeEnv->groupResInfo.pRows);
+
+  // the results that are built ahead but never retrieved
+  if (pQInfo->pPrefetchRsp != NULL) {
+    size_t numOfPrefetched = taosArrayGetSize(pQInfo->pPrefetchRsp);
+    for (int32_t i = 0; i < numOfPrefetched; ++i) {
+      SPrefetchRsp* pPrefetch = taosArrayGet(pQInfo->pPrefetchRsp, i);
+      rpcFreeCont(pPrefetch->pRsp);
+    }
+
+    taosArrayDestroy(pQInfo->pPrefetchRsp);
+  }
+
   pQInfo->signature = 0;
 
   qDebug("QInfo:0x%"PRIx64" QInfo is freed", pQInfo->qId);
@@ -8960,6 +10381,11 @@ bool doBuildResCheck(SQInfo* pQInfo) {
   pQInfo->dataReady = QUERY_RESULT_READY;
   buildRes = needBuildResAfterQueryComplete(pQInfo);
 
+  // no retrieve request is waiting, the query thread builds the result into the prefetch queue by itself
+  if (!buildRes && needPrefetchResult(pQInfo)) {
+    pQInfo->dataReady = QUERY_RESULT_PREFETCH;
+  }
+
   // clear qhandle owner, it must be in the secure area. other thread may run ahead before current, after it is
   // put into task to be executed.
   assert(pQInfo->owner == taosGetSelfPthreadId());
@@ -3474,6 +3474,126 @@ _return:
 }
 
 
+// Get the ids of a "column = value" or "column in (...)" unit from the index, NULL if the column is not indexed
+static SBitmap* filterGetUnitIndexIds(SFilterComUnit *cunit, void *param, filter_index_lookup_func fp) {
+  const SBitmap *ids = NULL;
+
+  if (cunit->optr == TSDB_RELATION_EQUAL) {
+    if (!(*fp)(param, cunit->colId, cunit->valData, &ids)) {
+      return NULL;
+    }
+
+    return ids ? tBitmapDup(ids) : tBitmapCreate();
+  }
+
+  // only the set of var types is kept as a hash, the others are split into equal units
+  if (cunit->optr != TSDB_RELATION_IN || !IS_VAR_DATA_TYPE(cunit->dataType)) {
+    return NULL;
+  }
+
+  SBitmap *res = tBitmapCreate();
+  char    *val = malloc(cunit->dataSize + VARSTR_HEADER_SIZE);
+  if (res == NULL || val == NULL) {
+    goto _return;
+  }
+
+  void *p = taosHashIterate((SHashObj *)cunit->valData, NULL);
+  while (p) {
+    size_t len = taosHashGetDataKeyLen((SHashObj *)cunit->valData, p);
+    if (len > cunit->dataSize) {
+      // longer than the column, no table has it
+      p = taosHashIterate((SHashObj *)cunit->valData, p);
+      continue;
+    }
+
+    varDataSetLen(val, len);
+    memcpy(varDataVal(val), taosHashGetDataKey((SHashObj *)cunit->valData, p), len);
+
+    if (!(*fp)(param, cunit->colId, val, &ids) || (ids && tBitmapOr(res, ids) < 0)) {
+      taosHashCancelIterate((SHashObj *)cunit->valData, p);
+      goto _return;
+    }
+
+    p = taosHashIterate((SHashObj *)cunit->valData, p);
+  }
+
+  tfree(val);
+  return res;
+
+_return:
+  tfree(val);
+  tBitmapDestroy(res);
+  return NULL;
+}
+
+// Resolve the filter to the ids that may satisfy it with the indexes of the columns: the ids of the equal and in units
+// of a group are intersected, and the groups are united. The other units are left to filterExecute, so the result is
+// a superset of the qualified ids. *res is NULL if some group has no unit to resolve.
+int32_t filterGetIndexCandidates(SFilterInfo* info, void *param, filter_index_lookup_func fp, SBitmap **res) {
+  CHK_LRET(info == NULL, TSDB_CODE_QRY_APP_ERROR, "null parameter");
+
+  *res = NULL;
+
+  if (FILTER_ALL_RES(info) || FILTER_EMPTY_RES(info) || info->groupNum <= 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SBitmap *ids = tBitmapCreate();
+  CHK_RET(ids == NULL, TSDB_CODE_QRY_OUT_OF_MEMORY);
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+    SBitmap      *gids = NULL;
+
+    for (uint32_t u = 0; u < group->unitNum; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+      SBitmap        *uids = NULL;
+
+      if (cunit->optr == FILTER_DUMMY_EMPTY_OPTR) {
+        uids = tBitmapCreate();
+      } else {
+        uids = filterGetUnitIndexIds(cunit, param, fp);
+      }
+
+      if (uids == NULL) {
+        continue;
+      }
+
+      if (gids == NULL) {
+        gids = uids;
+      } else {
+        int32_t code = tBitmapAnd(gids, uids);
+        tBitmapDestroy(uids);
+        if (code < 0) {
+          tBitmapDestroy(gids);
+          goto _return;
+        }
+      }
+
+      if (tBitmapCardinality(gids) == 0) {
+        break;
+      }
+    }
+
+    CHK_JMP(gids == NULL);
+
+    int32_t code = tBitmapOr(ids, gids);
+    tBitmapDestroy(gids);
+    CHK_JMP(code < 0);
+  }
+
+  qDebug("filter resolved by index, %" PRIu64 " candidates", tBitmapCardinality(ids));
+
+  *res = ids;
+  return TSDB_CODE_SUCCESS;
+
+_return:
+  tBitmapDestroy(ids);
+
+  return TSDB_CODE_SUCCESS;
+}
+
+
 int32_t filterGetIndexedColumnInfo(SFilterInfo* info, char** val, int32_t *order, int32_t *flag) {
   SFilterComUnit *cunit = info->cunits;
   uint8_t optr = cunit->optr;
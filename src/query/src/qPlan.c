@@ -659,7 +659,13 @@ SArray* createExecOperatorPlan(SQueryAttr* pQueryAttr) {
 
     // outer query order by support
     int32_t orderColId = pQueryAttr->order.orderColId;
-    if (pQueryAttr->vgId == 0 && orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX && orderColId != INT32_MIN) {
+    if (pQueryAttr->stableQuery) {
+      // super table projection ordered by a column with limit, each vnode only returns its top rows
+      if (orderColId > PRIMARYKEY_TIMESTAMP_COL_INDEX && pQueryAttr->prjInfo.vgroupLimit > 0) {
+        op = OP_TopN;
+        taosArrayPush(plan, &op);
+      }
+    } else if (pQueryAttr->vgId == 0 && orderColId != PRIMARYKEY_TIMESTAMP_COL_INDEX && orderColId != INT32_MIN) {
       op = OP_Order;
       taosArrayPush(plan, &op);
     }
@@ -59,29 +59,37 @@ static int32_t createDiskFile(SDiskbasedResultBuf* pResultBuf) {
   return TSDB_CODE_SUCCESS;
 }
 
-static char* doCompressData(void* data, int32_t srcSize, int32_t *dst, SDiskbasedResultBuf* pResultBuf) { // do nothing
+/*
+ * A page is kept in compressed form only if it shrinks below this ratio, otherwise it is written as it is, since
+ * the decompression is not free when the page is loaded again. Pages of the same buffer tend to compress alike,
+ * so after a page that does not compress well the next COMP_BACKOFF_PAGES pages are written without trying.
+ */
+#define COMP_RATIO_THRESHOLD  0.8
+#define COMP_BACKOFF_PAGES    32
+
+static char* doCompressData(void* data, int32_t srcSize, int32_t *dst, SDiskbasedResultBuf* pResultBuf) {
+  *dst = srcSize;
   if (!pResultBuf->comp) {
-    *dst = srcSize;
     return data;
   }
 
-  *dst = tsCompressString(data, srcSize, 1, pResultBuf->assistBuf, srcSize, ONE_STAGE_COMP, NULL, 0);
-
-  memcpy(data, pResultBuf->assistBuf, *dst);
-  return data;
-}
-
-static char* doDecompressData(void* data, int32_t srcSize, int32_t *dst, SDiskbasedResultBuf* pResultBuf) { // do nothing
-  if (!pResultBuf->comp) {
-    *dst = srcSize;
+  if (pResultBuf->compSkip > 0) {
+    pResultBuf->compSkip -= 1;
     return data;
   }
 
-  *dst = tsDecompressString(data, srcSize, 1, pResultBuf->assistBuf, pResultBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
-  if (*dst > 0) {
-    memcpy(data, pResultBuf->assistBuf, *dst);
+  int32_t len = tsCompressString(data, srcSize, 1, pResultBuf->assistBuf, srcSize, ONE_STAGE_COMP, NULL, 0);
+  if (len <= 0 || len > srcSize * COMP_RATIO_THRESHOLD) {
+    pResultBuf->compSkip = COMP_BACKOFF_PAGES;
+    return data;
   }
-  return data;
+
+  *dst = len;
+  return pResultBuf->assistBuf;
+}
+
+static int32_t doDecompressData(void* data, int32_t srcSize, SDiskbasedResultBuf* pResultBuf) {
+  return tsDecompressString(pResultBuf->assistBuf, srcSize, 1, data, pResultBuf->pageSize, ONE_STAGE_COMP, NULL, 0);
 }
 
 static int32_t allocatePositionInFile(SDiskbasedResultBuf* pResultBuf, size_t size) {
@@ -112,57 +120,45 @@ static char* doFlushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
 
   int32_t size = -1;
   char* t = doCompressData(GET_DATA_PAYLOAD(pg), pResultBuf->pageSize, &size, pResultBuf);
+  bool  compressed = (t != GET_DATA_PAYLOAD(pg));
 
   // this page is flushed to disk for the first time
   if (pg->info.offset == -1) {
     pg->info.offset = allocatePositionInFile(pResultBuf, size);
     pResultBuf->nextPos += size;
+  } else if (pg->info.length < size) {
+    // length becomes greater, current space is not enough, allocate new place, otherwise, overwrite it
+    // 1. add current space to free list
+    SFreeListItem item = {.offset = pg->info.offset, .len = pg->info.length};
+    taosArrayPush(pResultBuf->pFree, &item);
 
-    int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-    assert(ret == 0);
-
-    ret = (int32_t) fwrite(t, 1, size, pResultBuf->file);
-    assert(ret == size);
-
-    if (pResultBuf->fileSize < pg->info.offset + pg->info.length) {
-      pResultBuf->fileSize = pg->info.offset + pg->info.length;
-    }
-  } else {
-    // length becomes greater, current space is not enough, allocate new place, otherwise, do nothing
-    if (pg->info.length < size) {
-      // 1. add current space to free list
-      taosArrayPush(pResultBuf->pFree, &pg->info);
-
-      // 2. allocate new position, and update the info
-      pg->info.offset = allocatePositionInFile(pResultBuf, size);
-      pResultBuf->nextPos += size;
-    }
-
-    //3. write to disk.
-    int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-    if (ret != 0) {  // todo handle the error case
-
-    }
+    // 2. allocate new position, and update the info
+    pg->info.offset = allocatePositionInFile(pResultBuf, size);
+    pResultBuf->nextPos += size;
+  }
 
-    ret = (int32_t)fwrite(t, size, 1, pResultBuf->file);
-    if (ret != size) {  // todo handle the error case
+  int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
+  assert(ret == 0);
 
-    }
+  ret = (int32_t) fwrite(t, 1, size, pResultBuf->file);
+  assert(ret == size);
 
-    if (pResultBuf->fileSize < pg->info.offset + pg->info.length) {
-      pResultBuf->fileSize = pg->info.offset + pg->info.length;
-    }
+  if (pResultBuf->fileSize < pg->info.offset + size) {
+    pResultBuf->fileSize = pg->info.offset + size;
   }
 
-  char* ret = pg->pData;
-  memset(ret, 0, pResultBuf->pageSize);
+  char* p = pg->pData;
+  memset(p, 0, POINTER_BYTES + pResultBuf->pageSize);
 
   pg->pData = NULL;
   pg->info.length = size;
+  pg->info.compressed = compressed;
 
-  pResultBuf->statis.flushBytes += pg->info.length;
+  pResultBuf->statis.flushBytes += pResultBuf->pageSize;
+  pResultBuf->statis.writeBytes += size;
+  pResultBuf->statis.compPages += compressed ? 1 : 0;
 
-  return ret;
+  return p;
 }
 
 static char* flushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
@@ -181,8 +177,10 @@ static char* flushPageToDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
 
 // load file block data in disk
 static char* loadPageFromDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
+  char* p = pg->info.compressed ? pResultBuf->assistBuf : GET_DATA_PAYLOAD(pg);
+
   int32_t ret = fseek(pResultBuf->file, pg->info.offset, SEEK_SET);
-  ret = (int32_t)fread(GET_DATA_PAYLOAD(pg), 1, pg->info.length, pResultBuf->file);
+  ret = (int32_t)fread(p, 1, pg->info.length, pResultBuf->file);
   if (ret != pg->info.length) {
     terrno = errno;
     return NULL;
@@ -190,8 +188,11 @@ static char* loadPageFromDisk(SDiskbasedResultBuf* pResultBuf, SPageInfo* pg) {
 
   pResultBuf->statis.loadBytes += pg->info.length;
 
-  int32_t fullSize = 0;
-  doDecompressData(GET_DATA_PAYLOAD(pg), pg->info.length, &fullSize, pResultBuf);
+  if (pg->info.compressed && doDecompressData(GET_DATA_PAYLOAD(pg), pg->info.length, pResultBuf) != pResultBuf->pageSize) {
+    qError("QInfo:0x%"PRIx64" failed to decompress page:%d, length:%d", pResultBuf->qId, pg->pageId, pg->info.length);
+    terrno = TSDB_CODE_QRY_SYS_ERROR;
+    return NULL;
+  }
 
   return (char*)GET_DATA_PAYLOAD(pg);
 }
@@ -411,9 +412,12 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf) {
   }
 
   if (pResultBuf->file != NULL) {
-    qDebug("QInfo:0x%"PRIx64" res output buffer closed, total:%.2f Kb, inmem size:%.2f Kb, file size:%.2f Kb",
+    SResultBufStatis* ps = &pResultBuf->statis;
+    qDebug("QInfo:0x%"PRIx64" res output buffer closed, total:%.2f Kb, inmem size:%.2f Kb, file size:%.2f Kb, "
+        "flush pages:%d, compressed:%d, flush:%.2f Kb, written:%.2f Kb, load:%.2f Kb",
         pResultBuf->qId, pResultBuf->totalBufSize/1024.0, listNEles(pResultBuf->lruList) * pResultBuf->pageSize / 1024.0,
-        pResultBuf->fileSize/1024.0);
+        pResultBuf->fileSize/1024.0, ps->flushPages, ps->compPages, ps->flushBytes/1024.0, ps->writeBytes/1024.0,
+        ps->loadBytes/1024.0);
 
     fclose(pResultBuf->file);
   } else {
@@ -0,0 +1,444 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qSort.h"
+#include "qExecutor.h"
+#include "queryLog.h"
+#include "taoserror.h"
+#include "tcompare.h"
+
+#define SORT_MIN_ROWS_OF_SLICE  65536  // fewer rows are not worth a thread
+
+typedef struct SRadixEntry {
+  uint64_t key;
+  int32_t  index;
+} SRadixEntry;
+
+typedef struct SSortSlice {
+  SColumnInfoData *pColInfo;
+  int32_t          order;
+  int32_t          start;
+  int32_t          end;
+  int32_t         *pIndex;
+  int32_t          code;
+  pthread_t        thread;
+  bool             started;
+} SSortSlice;
+
+static bool isRadixSortType(int32_t type) {
+  return IS_NUMERIC_TYPE(type) || type == TSDB_DATA_TYPE_TIMESTAMP || type == TSDB_DATA_TYPE_BOOL;
+}
+
+/*
+ * map the value to an unsigned key of the same width that keeps the order of getKeyComparFunc: the sign bit of the
+ * integers is flipped, the floating point values are mapped by their bits, and NaN, the null value, is the smallest.
+ */
+static uint64_t getRadixKey(const char* p, int32_t type) {
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+    case TSDB_DATA_TYPE_TINYINT:    return (uint8_t)(*(int8_t*)p) ^ 0x80u;
+    case TSDB_DATA_TYPE_SMALLINT:   return (uint16_t)(*(int16_t*)p) ^ 0x8000u;
+    case TSDB_DATA_TYPE_INT:        return (uint32_t)(*(int32_t*)p) ^ 0x80000000u;
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP:  return (uint64_t)(*(int64_t*)p) ^ 0x8000000000000000ull;
+    case TSDB_DATA_TYPE_UTINYINT:   return *(uint8_t*)p;
+    case TSDB_DATA_TYPE_USMALLINT:  return *(uint16_t*)p;
+    case TSDB_DATA_TYPE_UINT:       return *(uint32_t*)p;
+    case TSDB_DATA_TYPE_UBIGINT:    return *(uint64_t*)p;
+    case TSDB_DATA_TYPE_FLOAT: {
+      float v = GET_FLOAT_VAL(p);
+      if (isnan(v)) {
+        return 0;
+      }
+
+      uint32_t u = 0;
+      memcpy(&u, &v, sizeof(u));
+      return (u & 0x80000000u) ? (uint32_t)~u : (u | 0x80000000u);
+    }
+    case TSDB_DATA_TYPE_DOUBLE: {
+      double v = GET_DOUBLE_VAL(p);
+      if (isnan(v)) {
+        return 0;
+      }
+
+      uint64_t u = 0;
+      memcpy(&u, &v, sizeof(u));
+      return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+    }
+    default:
+      assert(0);
+      return 0;
+  }
+}
+
+// least significant byte first, the bytes that are the same for all keys are skipped
+static int32_t doRadixSort(SSortSlice* pSlice) {
+  SColumnInfoData* pColInfo = pSlice->pColInfo;
+  int32_t          bytes = pColInfo->info.bytes;
+  int32_t          num = pSlice->end - pSlice->start;
+
+  SRadixEntry* pEntry = malloc(sizeof(SRadixEntry) * num * 2);
+  if (pEntry == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  uint64_t mask = (bytes == sizeof(uint64_t)) ? UINT64_MAX : ((1ull << (bytes * 8)) - 1);
+  for (int32_t i = 0; i < num; ++i) {
+    int32_t  index = pSlice->start + i;
+    uint64_t key = getRadixKey(pColInfo->pData + (size_t)bytes * index, pColInfo->info.type);
+
+    pEntry[i].key = (pSlice->order == TSDB_ORDER_ASC) ? key : (~key & mask);
+    pEntry[i].index = index;
+  }
+
+  SRadixEntry* pSrc = pEntry;
+  SRadixEntry* pDst = pEntry + num;
+
+  for (int32_t b = 0; b < bytes; ++b) {
+    int32_t count[256] = {0};
+    int32_t shift = b * 8;
+
+    for (int32_t i = 0; i < num; ++i) {
+      count[(pSrc[i].key >> shift) & 0xFF] += 1;
+    }
+
+    if (count[(pSrc[0].key >> shift) & 0xFF] == num) {
+      continue;
+    }
+
+    int32_t pos = 0;
+    for (int32_t i = 0; i < 256; ++i) {
+      int32_t c = count[i];
+      count[i] = pos;
+      pos += c;
+    }
+
+    for (int32_t i = 0; i < num; ++i) {
+      pDst[count[(pSrc[i].key >> shift) & 0xFF]++] = pSrc[i];
+    }
+
+    SRadixEntry* t = pSrc;
+    pSrc = pDst;
+    pDst = t;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    pSlice->pIndex[pSlice->start + i] = pSrc[i].index;
+  }
+
+  free(pEntry);
+  return TSDB_CODE_SUCCESS;
+}
+
+// the keys of variable length are sorted together with their row index, the same as taoscQSort
+static int32_t doQuickSort(SSortSlice* pSlice) {
+  SColumnInfoData* pColInfo = pSlice->pColInfo;
+  int32_t          bytes = pColInfo->info.bytes;
+  int32_t          size = bytes + sizeof(int32_t);
+  int32_t          num = pSlice->end - pSlice->start;
+
+  char* buf = malloc((size_t)size * num);
+  if (buf == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    int32_t index = pSlice->start + i;
+    char*   dest = buf + (size_t)size * i;
+
+    memcpy(dest, pColInfo->pData + (size_t)bytes * index, bytes);
+    *(int32_t*)(dest + bytes) = index;
+  }
+
+  qsort(buf, num, size, getKeyComparFunc(pColInfo->info.type, pSlice->order));
+
+  for (int32_t i = 0; i < num; ++i) {
+    pSlice->pIndex[pSlice->start + i] = *(int32_t*)(buf + (size_t)size * i + bytes);
+  }
+
+  free(buf);
+  return TSDB_CODE_SUCCESS;
+}
+
+static void* sortSliceFunc(void* param) {
+  SSortSlice* pSlice = param;
+
+  if (isRadixSortType(pSlice->pColInfo->info.type)) {
+    pSlice->code = doRadixSort(pSlice);
+  } else {
+    pSlice->code = doQuickSort(pSlice);
+  }
+
+  return NULL;
+}
+
+int32_t sortGetNumOfSlices(int32_t numOfRows, int32_t numOfThreads) {
+  int32_t n = numOfRows / SORT_MIN_ROWS_OF_SLICE;
+  n = MIN(n, numOfThreads);
+  return MAX(n, 1);
+}
+
+int32_t sortBlockSlices(SSDataBlock* pBlock, int32_t colIndex, int32_t order, int32_t numOfSlices, int32_t* pIndex) {
+  int32_t numOfRows = pBlock->info.rows;
+  assert(numOfSlices > 0 && numOfRows >= 0);
+
+  SSortSlice* pSlices = calloc(numOfSlices, sizeof(SSortSlice));
+  if (pSlices == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfSlices; ++i) {
+    pSlices[i].pColInfo = taosArrayGet(pBlock->pDataBlock, colIndex);
+    pSlices[i].order = order;
+    pSlices[i].start = (int32_t)(((int64_t)numOfRows) * i / numOfSlices);
+    pSlices[i].end = (int32_t)(((int64_t)numOfRows) * (i + 1) / numOfSlices);
+    pSlices[i].pIndex = pIndex;
+  }
+
+  // the first slice is sorted in the caller thread, and so is a slice whose thread fails to start
+  for (int32_t i = 1; i < numOfSlices; ++i) {
+    if (pthread_create(&pSlices[i].thread, NULL, sortSliceFunc, &pSlices[i]) == 0) {
+      pSlices[i].started = true;
+    } else {
+      qWarn("failed to create sort thread, reason:%s", strerror(errno));
+    }
+  }
+
+  for (int32_t i = 0; i < numOfSlices; ++i) {
+    if (!pSlices[i].started && pSlices[i].end > pSlices[i].start) {
+      sortSliceFunc(&pSlices[i]);
+    }
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < numOfSlices; ++i) {
+    if (pSlices[i].started) {
+      pthread_join(pSlices[i].thread, NULL);
+    }
+
+    if (pSlices[i].code != TSDB_CODE_SUCCESS) {
+      code = pSlices[i].code;
+    }
+  }
+
+  free(pSlices);
+  return code;
+}
+
+void sortAddSliceSources(SArray* pSources, SSDataBlock* pBlock, int32_t numOfSlices, int32_t* pIndex) {
+  int32_t numOfRows = pBlock->info.rows;
+
+  for (int32_t i = 0; i < numOfSlices; ++i) {
+    int32_t start = (int32_t)(((int64_t)numOfRows) * i / numOfSlices);
+    int32_t end = (int32_t)(((int64_t)numOfRows) * (i + 1) / numOfSlices);
+    if (end == start) {
+      continue;
+    }
+
+    SSortSource source = {.pBlock = pBlock, .pIndex = pIndex + start, .numOfRows = end - start};
+    taosArrayPush(pSources, &source);
+  }
+}
+
+int32_t sortAddRunSource(SArray* pSources, SSpillBuf* pSpillBuf) {
+  SSortSource source = {.pSpillBuf = pSpillBuf};
+  if (taosArrayPush(pSources, &source) == NULL) {
+    destroySpillBuf(pSpillBuf);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t loadNextRunBlock(SSortSource* pSource) {
+  int64_t tag = 0;
+  int32_t code = spillBufReadNext(pSource->pSpillBuf, 0, &tag, &pSource->pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  pSource->numOfRows = (pSource->pBlock != NULL) ? pSource->pBlock->info.rows : 0;
+  pSource->rowIdx = (pSource->numOfRows > 0) ? 0 : -1;
+  return TSDB_CODE_SUCCESS;
+}
+
+static FORCE_INLINE int32_t getSourceRow(SSortSource* pSource) {
+  return (pSource->pIndex != NULL) ? pSource->pIndex[pSource->rowIdx] : pSource->rowIdx;
+}
+
+static FORCE_INLINE char* getSourceKey(SSortMerger* pMerger, SSortSource* pSource) {
+  SColumnInfoData* pColInfo = taosArrayGet(pSource->pBlock->pDataBlock, pMerger->colIndex);
+  return pColInfo->pData + (size_t)pColInfo->info.bytes * getSourceRow(pSource);
+}
+
+static int32_t sourceComparator(const void* pLeft, const void* pRight, void* param) {
+  SSortMerger* pMerger = param;
+
+  SSortSource* pLeftSource = taosArrayGet(pMerger->pSources, *(int32_t*)pLeft);
+  SSortSource* pRightSource = taosArrayGet(pMerger->pSources, *(int32_t*)pRight);
+
+  // the exhausted source is always the loser
+  if (pLeftSource->rowIdx == -1) {
+    return 1;
+  }
+
+  if (pRightSource->rowIdx == -1) {
+    return -1;
+  }
+
+  return pMerger->comparFn(getSourceKey(pMerger, pLeftSource), getSourceKey(pMerger, pRightSource));
+}
+
+static void destroySources(SArray* pSources) {
+  size_t num = taosArrayGetSize(pSources);
+  for (int32_t i = 0; i < num; ++i) {
+    SSortSource* pSource = taosArrayGet(pSources, i);
+    destroySpillBuf(pSource->pSpillBuf);
+  }
+
+  taosArrayDestroy(pSources);
+}
+
+int32_t sortMergerCreate(SSortMerger** pMerger, SArray* pSources, int32_t colIndex, int32_t order, int32_t type) {
+  *pMerger = calloc(1, sizeof(SSortMerger));
+  if (*pMerger == NULL) {
+    destroySources(pSources);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  SSortMerger* p = *pMerger;
+  p->pSources = pSources;
+  p->colIndex = colIndex;
+  p->comparFn = getKeyComparFunc(type, order);
+
+  int32_t numOfSources = (int32_t)taosArrayGetSize(pSources);
+  for (int32_t i = 0; i < numOfSources; ++i) {
+    SSortSource* pSource = taosArrayGet(pSources, i);
+    if (pSource->pSpillBuf == NULL) {
+      pSource->rowIdx = (pSource->numOfRows > 0) ? 0 : -1;
+      continue;
+    }
+
+    int32_t code = spillBufBeginRead(pSource->pSpillBuf, 0);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = loadNextRunBlock(pSource);
+    }
+
+    if (code != TSDB_CODE_SUCCESS) {
+      sortMergerDestroy(p);
+      *pMerger = NULL;
+      return code;
+    }
+  }
+
+  if (numOfSources > 0) {
+    uint32_t code = tLoserTreeCreate(&p->pTree, numOfSources, p, sourceComparator);
+    if (code != TSDB_CODE_SUCCESS) {
+      sortMergerDestroy(p);
+      *pMerger = NULL;
+      return code;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t sortMergerNext(SSortMerger* pMerger, SSDataBlock* pDest, int32_t capacity) {
+  if (pMerger->pTree == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t numOfCols = pDest->info.numOfCols;
+  int32_t numOfSources = pMerger->pTree->numOfEntries;
+
+  while (pDest->info.rows < capacity) {
+    int32_t      winner = pMerger->pTree->pNode[0].index;
+    SSortSource* pSource = taosArrayGet(pMerger->pSources, winner);
+    if (pSource->rowIdx == -1) {  // all sources are exhausted
+      break;
+    }
+
+    int32_t row = getSourceRow(pSource);
+    for (int32_t i = 0; i < numOfCols; ++i) {
+      SColumnInfoData* pSrc = taosArrayGet(pSource->pBlock->pDataBlock, i);
+      SColumnInfoData* pDst = taosArrayGet(pDest->pDataBlock, i);
+
+      int16_t bytes = pDst->info.bytes;
+      memcpy(pDst->pData + (size_t)bytes * pDest->info.rows, pSrc->pData + (size_t)bytes * row, bytes);
+    }
+
+    pDest->info.rows += 1;
+
+    pSource->rowIdx += 1;
+    if (pSource->rowIdx >= pSource->numOfRows) {
+      if (pSource->pSpillBuf != NULL) {
+        int32_t code = loadNextRunBlock(pSource);
+        if (code != TSDB_CODE_SUCCESS) {
+          return code;
+        }
+      } else {
+        pSource->rowIdx = -1;
+      }
+    }
+
+    tLoserTreeAdjust(pMerger->pTree, winner + numOfSources);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t sortMergeToRun(SArray* pSources, SSDataBlock* pBuf, int32_t capacity, int32_t colIndex, int32_t order,
+                       int32_t type, uint64_t qId, SSpillBuf** pRun) {
+  *pRun = createSpillBuf(pBuf, 1, 0, qId);
+  if (*pRun == NULL) {
+    destroySources(pSources);
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  (*pRun)->comp = true;
+
+  SSortMerger* pMerger = NULL;
+  int32_t      code = sortMergerCreate(&pMerger, pSources, colIndex, order, type);
+
+  while (code == TSDB_CODE_SUCCESS) {
+    pBuf->info.rows = 0;
+    code = sortMergerNext(pMerger, pBuf, capacity);
+    if (code != TSDB_CODE_SUCCESS || pBuf->info.rows == 0) {
+      break;
+    }
+
+    code = spillBufAppend(*pRun, 0, pBuf, 0, pBuf->info.rows, 0);
+  }
+
+  pBuf->info.rows = 0;
+  sortMergerDestroy(pMerger);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    destroySpillBuf(*pRun);
+    *pRun = NULL;
+  }
+
+  return code;
+}
+
+void sortMergerDestroy(SSortMerger* pMerger) {
+  if (pMerger == NULL) {
+    return;
+  }
+
+  destroySources(pMerger->pSources);
+  tfree(pMerger->pTree);
+  tfree(pMerger);
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qSpillbuf.h"
+#include "qExecutor.h"
+#include "queryLog.h"
+#include "taoserror.h"
+#include "tscompression.h"
+#include "tutil.h"
+
+#define SPILL_RUN_SIZE (64 * 1024)  // bytes of the write buffer of a partition
+
+typedef struct SSpillRunHead {
+  int32_t rows;
+  int32_t compressed;  // each column is preceded by its compressed length
+  int64_t tag;
+} SSpillRunHead;
+
+static int32_t getMaxColumnSize(SSpillBuf* pSpillBuf) {
+  int32_t size = 0;
+  for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+    size = MAX(size, pSpillBuf->pCols[i].bytes * pSpillBuf->capacity);
+  }
+
+  return size;
+}
+
+SSpillBuf* createSpillBuf(SSDataBlock* pTemplate, int32_t numOfPartitions, int32_t level, uint64_t qId) {
+  SSpillBuf* pSpillBuf = calloc(1, sizeof(SSpillBuf));
+  if (pSpillBuf == NULL) {
+    return NULL;
+  }
+
+  pSpillBuf->level = level;
+  pSpillBuf->numOfPartitions = numOfPartitions;
+  pSpillBuf->numOfCols = pTemplate->info.numOfCols;
+  pSpillBuf->qId = qId;
+
+  pSpillBuf->pCols = calloc(pSpillBuf->numOfCols, sizeof(SColumnInfo));
+  pSpillBuf->offset = calloc(pSpillBuf->numOfCols, sizeof(int32_t));
+  pSpillBuf->pPartitions = calloc(numOfPartitions, sizeof(SSpillPartition));
+  if (pSpillBuf->pCols == NULL || pSpillBuf->offset == NULL || pSpillBuf->pPartitions == NULL) {
+    destroySpillBuf(pSpillBuf);
+    return NULL;
+  }
+
+  int32_t rowSize = 0;
+  for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pTemplate->pDataBlock, i);
+    pSpillBuf->pCols[i] = pColInfo->info;
+    rowSize += pColInfo->info.bytes;
+  }
+
+  rowSize = MAX(rowSize, 1);
+  pSpillBuf->capacity = MAX(SPILL_RUN_SIZE / rowSize, 16);
+  for (int32_t i = 1; i < pSpillBuf->numOfCols; ++i) {
+    pSpillBuf->offset[i] = pSpillBuf->offset[i - 1] + pSpillBuf->pCols[i - 1].bytes * pSpillBuf->capacity;
+  }
+
+  SSDataBlock* pBlock = calloc(1, sizeof(SSDataBlock));
+  if (pBlock == NULL) {
+    destroySpillBuf(pSpillBuf);
+    return NULL;
+  }
+
+  pSpillBuf->pBlock = pBlock;
+  pBlock->info.numOfCols = pSpillBuf->numOfCols;
+  pBlock->pDataBlock = taosArrayInit(pSpillBuf->numOfCols, sizeof(SColumnInfoData));
+  for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+    SColumnInfoData idata = {.info = pSpillBuf->pCols[i]};
+    idata.pData = calloc(pSpillBuf->capacity, pSpillBuf->pCols[i].bytes);
+    taosArrayPush(pBlock->pDataBlock, &idata);
+
+    if (idata.pData == NULL) {
+      destroySpillBuf(pSpillBuf);
+      return NULL;
+    }
+  }
+
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    char path[PATH_MAX] = {0};
+    taosGetTmpfilePath("qspill", path);
+
+    SSpillPartition* pPartition = &pSpillBuf->pPartitions[i];
+    pPartition->path = strdup(path);
+    pPartition->pBuf = malloc((size_t)rowSize * pSpillBuf->capacity);
+    if (pPartition->path == NULL || pPartition->pBuf == NULL) {
+      destroySpillBuf(pSpillBuf);
+      return NULL;
+    }
+  }
+
+  qDebug("QInfo:0x%" PRIx64 " create spill buffer, level:%d, partitions:%d, rows of a run:%d", qId, level,
+         numOfPartitions, pSpillBuf->capacity);
+  return pSpillBuf;
+}
+
+static int32_t doFlushRun(SSpillBuf* pSpillBuf, SSpillPartition* pPartition) {
+  if (pPartition->numOfBufRows == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  if (pPartition->file == NULL) {
+    pPartition->file = fopen(pPartition->path, "wb+");
+    if (pPartition->file == NULL) {
+      qError("QInfo:0x%" PRIx64 " failed to create tmp file:%s on disk. %s", pSpillBuf->qId, pPartition->path,
+             strerror(errno));
+      return TAOS_SYSTEM_ERROR(errno);
+    }
+  }
+
+  if (pSpillBuf->comp && pSpillBuf->pCompBuf == NULL) {
+    pSpillBuf->pCompBuf = malloc(getMaxColumnSize(pSpillBuf) + 2);  // extra bytes for the data that is not compressed
+    if (pSpillBuf->pCompBuf == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  }
+
+  SSpillRunHead head = {.rows = pPartition->numOfBufRows, .compressed = pSpillBuf->comp, .tag = pPartition->bufTag};
+  if (fwrite(&head, sizeof(head), 1, pPartition->file) != 1) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  pSpillBuf->fileSize += sizeof(head);
+  for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+    int32_t size = pSpillBuf->pCols[i].bytes * pPartition->numOfBufRows;
+    char*   data = pPartition->pBuf + pSpillBuf->offset[i];
+
+    if (head.compressed) {
+      size = tsCompressString(data, size, 1, pSpillBuf->pCompBuf, size + 1, ONE_STAGE_COMP, NULL, 0);
+      data = pSpillBuf->pCompBuf;
+
+      if (fwrite(&size, sizeof(size), 1, pPartition->file) != 1) {
+        return TAOS_SYSTEM_ERROR(errno);
+      }
+
+      pSpillBuf->fileSize += sizeof(size);
+    }
+
+    if (fwrite(data, 1, size, pPartition->file) != size) {
+      return TAOS_SYSTEM_ERROR(errno);
+    }
+
+    pSpillBuf->fileSize += size;
+  }
+
+  pPartition->numOfBufRows = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t spillBufAppend(SSpillBuf* pSpillBuf, int32_t partition, SSDataBlock* pBlock, int32_t start, int32_t num,
+                       int64_t tag) {
+  assert(partition >= 0 && partition < pSpillBuf->numOfPartitions && pBlock->info.numOfCols == pSpillBuf->numOfCols);
+
+  SSpillPartition* pPartition = &pSpillBuf->pPartitions[partition];
+  if (pPartition->numOfBufRows > 0 && pPartition->bufTag != tag) {
+    int32_t code = doFlushRun(pSpillBuf, pPartition);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  pPartition->bufTag = tag;
+  pPartition->numOfRows += num;
+  pSpillBuf->numOfRows += num;
+
+  while (num > 0) {
+    int32_t rows = MIN(num, pSpillBuf->capacity - pPartition->numOfBufRows);
+
+    for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+      SColumnInfoData* pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+      int16_t          bytes = pSpillBuf->pCols[i].bytes;
+
+      char* dst = pPartition->pBuf + pSpillBuf->offset[i] + bytes * pPartition->numOfBufRows;
+      memcpy(dst, pColInfo->pData + bytes * start, (size_t)bytes * rows);
+    }
+
+    pPartition->numOfBufRows += rows;
+    start += rows;
+    num -= rows;
+
+    if (pPartition->numOfBufRows == pSpillBuf->capacity) {
+      int32_t code = doFlushRun(pSpillBuf, pPartition);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t spillBufBeginRead(SSpillBuf* pSpillBuf, int32_t partition) {
+  SSpillPartition* pPartition = &pSpillBuf->pPartitions[partition];
+
+  int32_t code = doFlushRun(pSpillBuf, pPartition);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (pPartition->file != NULL) {
+    fflush(pPartition->file);
+    rewind(pPartition->file);
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t spillBufReadNext(SSpillBuf* pSpillBuf, int32_t partition, int64_t* tag, SSDataBlock** pBlock) {
+  SSpillPartition* pPartition = &pSpillBuf->pPartitions[partition];
+  *pBlock = NULL;
+
+  SSpillRunHead head = {0};
+  if (pPartition->file == NULL || fread(&head, sizeof(head), 1, pPartition->file) != 1) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  assert(head.rows > 0 && head.rows <= pSpillBuf->capacity);
+
+  SSDataBlock* pRes = pSpillBuf->pBlock;
+  for (int32_t i = 0; i < pSpillBuf->numOfCols; ++i) {
+    SColumnInfoData* pColInfo = taosArrayGet(pRes->pDataBlock, i);
+
+    int32_t size = pSpillBuf->pCols[i].bytes * head.rows;
+    if (head.compressed) {
+      int32_t len = 0;
+      if (fread(&len, sizeof(len), 1, pPartition->file) != 1 || len <= 0 || len > size + 1 ||
+          fread(pSpillBuf->pCompBuf, 1, len, pPartition->file) != len) {
+        qError("QInfo:0x%" PRIx64 " failed to read tmp file:%s, %s", pSpillBuf->qId, pPartition->path, strerror(errno));
+        return TSDB_CODE_QRY_SYS_ERROR;
+      }
+
+      if (tsDecompressString(pSpillBuf->pCompBuf, len, 1, pColInfo->pData, size, ONE_STAGE_COMP, NULL, 0) != size) {
+        qError("QInfo:0x%" PRIx64 " failed to decompress tmp file:%s", pSpillBuf->qId, pPartition->path);
+        return TSDB_CODE_QRY_SYS_ERROR;
+      }
+    } else if (fread(pColInfo->pData, 1, size, pPartition->file) != size) {
+      qError("QInfo:0x%" PRIx64 " failed to read tmp file:%s, %s", pSpillBuf->qId, pPartition->path, strerror(errno));
+      return TSDB_CODE_QRY_SYS_ERROR;
+    }
+  }
+
+  pRes->info.rows = head.rows;
+  pRes->info.window = (STimeWindow) TSWINDOW_INITIALIZER;
+
+  SColumnInfoData* pTsCol = taosArrayGet(pRes->pDataBlock, 0);
+  if (pTsCol->info.type == TSDB_DATA_TYPE_TIMESTAMP) {
+    TSKEY* tsList = (TSKEY*) pTsCol->pData;
+    pRes->info.window.skey = MIN(tsList[0], tsList[head.rows - 1]);
+    pRes->info.window.ekey = MAX(tsList[0], tsList[head.rows - 1]);
+  }
+
+  *tag = head.tag;
+  *pBlock = pRes;
+  return TSDB_CODE_SUCCESS;
+}
+
+void spillBufRemovePartition(SSpillBuf* pSpillBuf, int32_t partition) {
+  SSpillPartition* pPartition = &pSpillBuf->pPartitions[partition];
+  if (pPartition->file != NULL) {
+    fclose(pPartition->file);
+    pPartition->file = NULL;
+    unlink(pPartition->path);
+  }
+
+  pPartition->numOfRows = 0;
+  pPartition->numOfBufRows = 0;
+}
+
+void destroySpillBuf(SSpillBuf* pSpillBuf) {
+  if (pSpillBuf == NULL) {
+    return;
+  }
+
+  if (pSpillBuf->pPartitions != NULL) {
+    for (int32_t i = 0; i < pSpillBuf->numOfPartitions; ++i) {
+      spillBufRemovePartition(pSpillBuf, i);
+      tfree(pSpillBuf->pPartitions[i].path);
+      tfree(pSpillBuf->pPartitions[i].pBuf);
+    }
+  }
+
+  qDebug("QInfo:0x%" PRIx64 " destroy spill buffer, level:%d, rows:%" PRId64 ", file size:%.2f Kb", pSpillBuf->qId,
+         pSpillBuf->level, pSpillBuf->numOfRows, pSpillBuf->fileSize / 1024.0);
+
+  if (pSpillBuf->pBlock != NULL) {
+    pSpillBuf->pBlock->info.numOfCols = (int32_t) taosArrayGetSize(pSpillBuf->pBlock->pDataBlock);
+    destroyOutputBuf(pSpillBuf->pBlock);
+  }
+
+  tfree(pSpillBuf->pPartitions);
+  tfree(pSpillBuf->pCompBuf);
+  tfree(pSpillBuf->offset);
+  tfree(pSpillBuf->pCols);
+  tfree(pSpillBuf);
+}
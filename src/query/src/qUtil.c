@@ -252,6 +252,21 @@ void* destroyResultRowPool(SResultRowPool* p) {
   return NULL;
 }
 
+void resetResultRowPool(SResultRowPool* p) {
+  if (p == NULL) {
+    return;
+  }
+
+  size_t size = taosArrayGetSize(p->pData);
+  for(int32_t i = 0; i < size; ++i) {
+    void** ptr = taosArrayGet(p->pData, i);
+    tfree(*ptr);
+  }
+
+  taosArrayClear(p->pData);
+  p->position.pos = 0;
+}
+
 void interResToBinary(SBufferWriter* bw, SArray* pRes, int32_t tagLen) {
   uint32_t numOfGroup = (uint32_t) taosArrayGetSize(pRes);
   tbufWriteUint32(bw, numOfGroup);
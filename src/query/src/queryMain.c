@@ -183,6 +183,9 @@ int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qi
   param.pUdfInfo = NULL;
 
   code = initQInfo(&pQueryMsg->tsBuf, tsdb, NULL, *pQInfo, &param, (char*)pQueryMsg, pQueryMsg->prevResultLen, NULL);
+  if (code == TSDB_CODE_SUCCESS && TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_EXPLAIN)) {
+    setQueryExplain(*pQInfo);
+  }
 
   _over:
   if (param.pGroupbyExpr != NULL) {
@@ -353,7 +356,11 @@ int32_t qRetrieveQueryResultInfo(qinfo_t qinfo, bool* buildRes, void* pRspContex
     pthread_mutex_lock(&pQInfo->lock);
 
     assert(pQInfo->rspContext == NULL);
-    if (pQInfo->dataReady == QUERY_RESULT_READY) {
+    if (pQInfo->pPrefetchRsp != NULL && taosArrayGetSize(pQInfo->pPrefetchRsp) > 0) {
+      *buildRes = true;
+      qDebug("QInfo:0x%"PRIx64" retrieve result info, %d results are prefetched", pQInfo->qId,
+             (int32_t) taosArrayGetSize(pQInfo->pPrefetchRsp));
+    } else if (pQInfo->dataReady == QUERY_RESULT_READY) {
       *buildRes = true;
       qDebug("QInfo:0x%"PRIx64" retrieve result info, rowsize:%d, rows:%d, code:%s", pQInfo->qId, pQueryAttr->resultRowSize,
              GET_NUM_OF_RESULTS(pRuntimeEnv), tstrerror(pQInfo->code));
@@ -371,14 +378,37 @@ int32_t qRetrieveQueryResultInfo(qinfo_t qinfo, bool* buildRes, void* pRspContex
   return code;
 }
 
-int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *contLen, bool* continueExec) {
-  SQInfo *pQInfo = (SQInfo *)qinfo;
-  int32_t compLen = 0;
+// the profile of operators is appended to the last response of the query, the client merges the profiles of all vnodes
+static void doAppendQueryProfile(SQInfo *pQInfo, SRetrieveTableRsp **pRsp, int32_t *contLen) {
+  SArray* pProfile = createQueryProfile(pQInfo);
+  if (pProfile == NULL) {
+    qError("QInfo:0x%"PRIx64" failed to create query profile, out of memory", pQInfo->qId);
+    return;
+  }
 
-  if (pQInfo == NULL || !isValidQInfo(pQInfo)) {
-    return TSDB_CODE_QRY_INVALID_QHANDLE;
+  int32_t profLen = (int32_t)(taosArrayGetSize(pProfile) * sizeof(SQueryProfileOperator));
+  SRetrieveTableRsp* p = rpcReallocCont(*pRsp, *contLen + profLen + sizeof(SQueryProfileTail));
+  if (p == NULL) {
+    qError("QInfo:0x%"PRIx64" failed to append query profile, out of memory", pQInfo->qId);
+  } else {
+    memcpy((char*)p + *contLen, TARRAY_GET_START(pProfile), profLen);
+
+    SQueryProfileTail* pTail = (SQueryProfileTail*)((char*)p + *contLen + profLen);
+    pTail->profLen = htonl(profLen);
+    pTail->magic   = htonl(TSDB_QUERY_PROFILE_MAGIC);
+
+    *pRsp    = p;
+    *contLen += profLen + sizeof(SQueryProfileTail);
+    qDebug("QInfo:0x%"PRIx64" query profile appended, operators:%d, queue wait:%"PRIu64" us", pQInfo->qId,
+           (int32_t)taosArrayGetSize(pProfile), pQInfo->summary.queueWaitTime);
   }
 
+  taosArrayDestroy(pProfile);
+}
+
+static int32_t doBuildRetrieveRsp(SQInfo *pQInfo, SRetrieveTableRsp **pRsp, int32_t *contLen, bool* continueExec) {
+  int32_t compLen = 0;
+
   SQueryAttr *pQueryAttr = pQInfo->runtimeEnv.pQueryAttr;
   SQueryRuntimeEnv* pRuntimeEnv = &pQInfo->runtimeEnv;
 
@@ -415,7 +445,6 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
   }
 
   RESET_NUM_OF_RESULTS(&(pQInfo->runtimeEnv));
-  pQInfo->lastRetrieveTs = taosGetTimestampMs();
 
   if ((*pRsp)->compressed && compLen != 0) {
     int32_t numOfCols = pQueryAttr->pExpr2 ? pQueryAttr->numOfExpr2 : pQueryAttr->numOfOutput;
@@ -428,14 +457,15 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
   }
   (*pRsp)->compLen = htonl(compLen);
 
-  pQInfo->rspContext = NULL;
-  pQInfo->dataReady  = QUERY_RESULT_NOT_READY;
-
   if (IS_QUERY_KILLED(pQInfo) || Q_STATUS_EQUAL(pRuntimeEnv->status, QUERY_OVER)) {
     // here current thread hold the refcount, so it is safe to free tsdbQueryHandle.
     *continueExec = false;
     (*pRsp)->completed = 1;  // notify no more result to client
     qDebug("QInfo:0x%"PRIx64" no more results to retrieve", pQInfo->qId);
+
+    if (pQInfo->explain && pQInfo->code == TSDB_CODE_SUCCESS) {
+      doAppendQueryProfile(pQInfo, pRsp, contLen);
+    }
   } else {
     *continueExec = true;
     qDebug("QInfo:0x%"PRIx64" has more results to retrieve", pQInfo->qId);
@@ -450,6 +480,103 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
   return pQInfo->code;
 }
 
+static bool doPopPrefetchedRsp(SQInfo *pQInfo, SRetrieveTableRsp **pRsp, int32_t *contLen, bool* continueExec,
+                               bool* completed) {
+  bool ret = false;
+
+  pthread_mutex_lock(&pQInfo->lock);
+  if (taosArrayGetSize(pQInfo->pPrefetchRsp) > 0) {
+    SPrefetchRsp* pPrefetch = taosArrayGet(pQInfo->pPrefetchRsp, 0);
+    *pRsp    = pPrefetch->pRsp;
+    *contLen = pPrefetch->contLen;
+
+    // the query that is paused by the full prefetch queue is resumed once there is room for the next result
+    *completed = !pPrefetch->continueExec;
+    *continueExec = pPrefetch->continueExec && pQInfo->prefetchPaused;
+    if (*continueExec) {
+      pQInfo->prefetchPaused = false;
+    }
+
+    taosArrayRemove(pQInfo->pPrefetchRsp, 0);
+    pQInfo->rspContext = NULL;
+    ret = true;
+
+    qDebug("QInfo:0x%"PRIx64" prefetched result retrieved, remain:%d, resume query:%d", pQInfo->qId,
+           (int32_t) taosArrayGetSize(pQInfo->pPrefetchRsp), *continueExec);
+  }
+  pthread_mutex_unlock(&pQInfo->lock);
+
+  return ret;
+}
+
+int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *contLen, bool* continueExec,
+                            bool* completed) {
+  SQInfo *pQInfo = (SQInfo *)qinfo;
+
+  if (pQInfo == NULL || !isValidQInfo(pQInfo)) {
+    return TSDB_CODE_QRY_INVALID_QHANDLE;
+  }
+
+  pQInfo->lastRetrieveTs = taosGetTimestampMs();
+  if (pQInfo->pPrefetchRsp != NULL && doPopPrefetchedRsp(pQInfo, pRsp, contLen, continueExec, completed)) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = doBuildRetrieveRsp(pQInfo, pRsp, contLen, continueExec);
+  *completed = !(*continueExec);
+
+  pQInfo->rspContext = NULL;
+  pQInfo->dataReady  = QUERY_RESULT_NOT_READY;
+  return code;
+}
+
+bool qPrefetchQueryResult(qinfo_t qinfo, bool* buildRes, bool* continueExec) {
+  SQInfo *pQInfo = (SQInfo *)qinfo;
+
+  *buildRes = false;
+  *continueExec = false;
+
+  pthread_mutex_lock(&pQInfo->lock);
+  bool prefetch = (pQInfo->dataReady == QUERY_RESULT_PREFETCH);
+  pthread_mutex_unlock(&pQInfo->lock);
+
+  if (!prefetch) {
+    return false;
+  }
+
+  SPrefetchRsp rsp = {0};
+  int32_t code = doBuildRetrieveRsp(pQInfo, &rsp.pRsp, &rsp.contLen, &rsp.continueExec);
+
+  pthread_mutex_lock(&pQInfo->lock);
+  if (code != TSDB_CODE_SUCCESS) {
+    // nothing is built, leave the result to the next retrieve request which reports the error
+    pQInfo->dataReady = QUERY_RESULT_READY;
+    *buildRes = (pQInfo->rspContext != NULL);
+    pthread_mutex_unlock(&pQInfo->lock);
+    return false;
+  }
+
+  taosArrayPush(pQInfo->pPrefetchRsp, &rsp);
+  pQInfo->dataReady = QUERY_RESULT_NOT_READY;
+
+  // the retrieve request that reaches here during the building of the result takes it immediately, and the query
+  // is resumed once the result is taken away
+  *buildRes = (pQInfo->rspContext != NULL);
+  if (rsp.continueExec) {
+    if (*buildRes || taosArrayGetSize(pQInfo->pPrefetchRsp) >= tsRetrievePrefetchBlocks) {
+      pQInfo->prefetchPaused = true;
+    } else {
+      *continueExec = true;
+    }
+  }
+
+  qDebug("QInfo:0x%"PRIx64" result prefetched, rows:%d, prefetched:%d, paused:%d", pQInfo->qId,
+         ntohl(rsp.pRsp->numOfRows), (int32_t) taosArrayGetSize(pQInfo->pPrefetchRsp), pQInfo->prefetchPaused);
+  pthread_mutex_unlock(&pQInfo->lock);
+
+  return true;
+}
+
 void* qGetResultRetrieveMsg(qinfo_t qinfo) {
   SQInfo* pQInfo = (SQInfo*) qinfo;
   assert(pQInfo != NULL);
@@ -486,6 +613,16 @@ int32_t qQueryCompleted(qinfo_t qinfo) {
   return isQueryKilled(pQInfo) || Q_STATUS_EQUAL(pQInfo->runtimeEnv.status, QUERY_OVER);
 }
 
+void qAddReadQueueWaitTime(qinfo_t qinfo, int64_t waitTime) {
+  SQInfo *pQInfo = (SQInfo *)qinfo;
+
+  if (pQInfo == NULL || !isValidQInfo(pQInfo) || waitTime <= 0) {
+    return;
+  }
+
+  pQInfo->summary.queueWaitTime += waitTime;
+}
+
 void qDestroyQueryInfo(qinfo_t qHandle) {
   SQInfo* pQInfo = (SQInfo*) qHandle;
   if (!isValidQInfo(pQInfo)) {
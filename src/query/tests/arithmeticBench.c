@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "tutil.h"
+
+/*
+ * Rows per second of the compiled arithmetic program and of arithmeticTreeTraverse, on blocks of float, int and
+ * bigint columns with null values. usage: arithmeticBench [-l loops]
+ */
+
+#define BENCH_ROWS 4096
+
+typedef struct {
+  int16_t colId[3];
+  char   *data[3];
+} SBenchBlock;
+
+static char *getBlockColumn(void *param, const char *name, int32_t colId) {
+  SBenchBlock *pBlock = param;
+  for (int32_t i = 0; i < 3; ++i) {
+    if (pBlock->colId[i] == colId) {
+      return pBlock->data[i];
+    }
+  }
+
+  assert(0);
+  return NULL;
+}
+
+// v: float, a: int, b: bigint, each column has null values
+static void initBlock(SBenchBlock *pBlock) {
+  float   *v = calloc(BENCH_ROWS, sizeof(float));
+  int32_t *a = calloc(BENCH_ROWS, sizeof(int32_t));
+  int64_t *b = calloc(BENCH_ROWS, sizeof(int64_t));
+
+  for (int32_t i = 0; i < BENCH_ROWS; ++i) {
+    v[i] = (float)(i * 0.25 - 100);
+    a[i] = i * 7 - 5000;
+    b[i] = i % 10;
+
+    if (i % 13 == 0) {
+      *(uint32_t *)&v[i] = TSDB_DATA_FLOAT_NULL;
+    }
+    if (i % 17 == 0) {
+      *(uint32_t *)&a[i] = TSDB_DATA_INT_NULL;
+    }
+    if (i % 19 == 0) {
+      *(uint64_t *)&b[i] = TSDB_DATA_BIGINT_NULL;
+    }
+  }
+
+  pBlock->colId[0] = 1;
+  pBlock->colId[1] = 2;
+  pBlock->colId[2] = 3;
+  pBlock->data[0] = (char *)v;
+  pBlock->data[1] = (char *)a;
+  pBlock->data[2] = (char *)b;
+}
+
+static tExprNode *createCol(int16_t colId, int16_t type, const char *name) {
+  tExprNode *pNode = calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = calloc(1, sizeof(SSchema));
+  pNode->pSchema->colId = colId;
+  pNode->pSchema->type = (uint8_t)type;
+  pNode->pSchema->bytes = tDataTypes[type].bytes;
+  tstrncpy(pNode->pSchema->name, name, sizeof(pNode->pSchema->name));
+  return pNode;
+}
+
+static tExprNode *createValue(double v) {
+  tExprNode *pNode = calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = TSDB_DATA_TYPE_DOUBLE;
+  pNode->pVal->dKey = v;
+  return pNode;
+}
+
+static tExprNode *createOp(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+static void benchmark(tExprNode *pExpr, const char *name, SBenchBlock *pBlock, int32_t loops) {
+  char *expected = calloc(BENCH_ROWS, sizeof(double));
+  char *output = calloc(BENCH_ROWS, sizeof(double));
+
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    arithmeticTreeTraverse(pExpr, BENCH_ROWS, expected, pBlock, TSDB_ORDER_ASC, getBlockColumn);
+  }
+  int64_t treeCost = MAX(taosGetTimestampUs() - st, 1);
+
+  SArithmeticProgram *pProgram = arithmeticProgramCompile(pExpr);
+  if (pProgram == NULL) {
+    printf("%-16s is not compiled\n", name);
+    free(expected);
+    free(output);
+    return;
+  }
+
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    arithmeticProgramExec(pProgram, BENCH_ROWS, output, pBlock, TSDB_ORDER_ASC, getBlockColumn);
+  }
+  int64_t programCost = MAX(taosGetTimestampUs() - st, 1);
+
+  if (memcmp(expected, output, BENCH_ROWS * sizeof(double)) != 0) {
+    printf("%-16s result mismatch between the tree traverse and the compiled program\n", name);
+  }
+
+  double rows = (double)BENCH_ROWS * loops;
+  printf("%-16s %14.2f %16.2f %8.2fx\n", name, rows / treeCost, rows / programCost, treeCost / (double)programCost);
+
+  arithmeticProgramDestroy(pProgram);
+  free(expected);
+  free(output);
+}
+
+int main(int argc, char *argv[]) {
+  int loops = 2000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options]\n", argv[0]);
+      printf("  [-l loops]: number of blocks of %d rows, default:%d\n", BENCH_ROWS, loops);
+      exit(0);
+    }
+  }
+
+  if (loops <= 0) {
+    printf("invalid number of loops\n");
+    exit(1);
+  }
+
+  SBenchBlock block = {{0}};
+  initBlock(&block);
+
+  // v * 1.8 + 32
+  tExprNode *pScale = createOp(TSDB_BINARY_OP_ADD,
+                               createOp(TSDB_BINARY_OP_MULTIPLY, createCol(1, TSDB_DATA_TYPE_FLOAT, "v"), createValue(1.8)),
+                               createValue(32));
+  // a - b
+  tExprNode *pSub = createOp(TSDB_BINARY_OP_SUBTRACT, createCol(2, TSDB_DATA_TYPE_INT, "a"),
+                             createCol(3, TSDB_DATA_TYPE_BIGINT, "b"));
+  // (a + v) / b - 100 % b, b is zero in every tenth row
+  tExprNode *pDivide = createOp(
+      TSDB_BINARY_OP_SUBTRACT,
+      createOp(TSDB_BINARY_OP_DIVIDE,
+               createOp(TSDB_BINARY_OP_ADD, createCol(2, TSDB_DATA_TYPE_INT, "a"), createCol(1, TSDB_DATA_TYPE_FLOAT, "v")),
+               createCol(3, TSDB_DATA_TYPE_BIGINT, "b")),
+      createOp(TSDB_BINARY_OP_REMAINDER, createValue(100), createCol(3, TSDB_DATA_TYPE_BIGINT, "b")));
+
+  printf("%d blocks of %d rows\n", loops, BENCH_ROWS);
+  printf("%-16s %14s %16s %9s\n", "expr", "tree(Mrows/s)", "program(Mrows/s)", "speedup");
+  benchmark(pScale, "v*1.8+32", &block, loops);
+  benchmark(pSub, "a-b", &block, loops);
+  benchmark(pDivide, "(a+v)/b-100%b", &block, loops);
+
+  tExprTreeDestroy(pScale, NULL);
+  tExprTreeDestroy(pSub, NULL);
+  tExprTreeDestroy(pDivide, NULL);
+
+  for (int32_t i = 0; i < 3; ++i) {
+    free(block.data[i]);
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "tutil.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+// compare the compiled arithmetic program with arithmeticTreeTraverse on the same blocks
+
+const int32_t numOfRows = 4096;
+
+struct SBlock {
+  int16_t colId[3];
+  char*   data[3];
+};
+
+char* getBlockColumn(void* param, const char* name, int32_t colId) {
+  SBlock* pBlock = (SBlock*)param;
+  for (int32_t i = 0; i < 3; ++i) {
+    if (pBlock->colId[i] == colId) {
+      return pBlock->data[i];
+    }
+  }
+
+  assert(0);
+  return NULL;
+}
+
+// v: float, a: int, b: bigint, each column has null values
+void initBlock(SBlock* pBlock, bool withNull) {
+  pBlock->colId[0] = 1;
+  pBlock->colId[1] = 2;
+  pBlock->colId[2] = 3;
+
+  auto* v = (float*)calloc(numOfRows, sizeof(float));
+  auto* a = (int32_t*)calloc(numOfRows, sizeof(int32_t));
+  auto* b = (int64_t*)calloc(numOfRows, sizeof(int64_t));
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    v[i] = (float)(i * 0.25 - 100);
+    a[i] = i * 7 - 5000;
+    b[i] = i % 10;
+
+    if (withNull && i % 13 == 0) {
+      *(uint32_t*)&v[i] = TSDB_DATA_FLOAT_NULL;
+    }
+    if (withNull && i % 17 == 0) {
+      *(uint32_t*)&a[i] = TSDB_DATA_INT_NULL;
+    }
+    if (withNull && i % 19 == 0) {
+      *(uint64_t*)&b[i] = TSDB_DATA_BIGINT_NULL;
+    }
+  }
+
+  pBlock->data[0] = (char*)v;
+  pBlock->data[1] = (char*)a;
+  pBlock->data[2] = (char*)b;
+}
+
+void destroyBlock(SBlock* pBlock) {
+  for (int32_t i = 0; i < 3; ++i) {
+    free(pBlock->data[i]);
+  }
+}
+
+tExprNode* createCol(int16_t colId, int16_t type, const char* name) {
+  auto* pNode = (tExprNode*)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema*)calloc(1, sizeof(SSchema));
+  pNode->pSchema->colId = colId;
+  pNode->pSchema->type = type;
+  pNode->pSchema->bytes = tDataTypes[type].bytes;
+  strcpy(pNode->pSchema->name, name);
+  return pNode;
+}
+
+tExprNode* createValue(double v) {
+  auto* pNode = (tExprNode*)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant*)calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = TSDB_DATA_TYPE_DOUBLE;
+  pNode->pVal->dKey = v;
+  return pNode;
+}
+
+tExprNode* createOp(uint8_t optr, tExprNode* pLeft, tExprNode* pRight) {
+  auto* pNode = (tExprNode*)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+// v * 1.8 + 32
+tExprNode* createExprScale() {
+  tExprNode* p = createOp(TSDB_BINARY_OP_MULTIPLY, createCol(1, TSDB_DATA_TYPE_FLOAT, "v"), createValue(1.8));
+  return createOp(TSDB_BINARY_OP_ADD, p, createValue(32));
+}
+
+// a - b
+tExprNode* createExprSub() {
+  return createOp(TSDB_BINARY_OP_SUBTRACT, createCol(2, TSDB_DATA_TYPE_INT, "a"),
+                  createCol(3, TSDB_DATA_TYPE_BIGINT, "b"));
+}
+
+// (a + v) / b - 100 % b, b is zero in every tenth row
+tExprNode* createExprDivide() {
+  tExprNode* p1 = createOp(TSDB_BINARY_OP_ADD, createCol(2, TSDB_DATA_TYPE_INT, "a"),
+                           createCol(1, TSDB_DATA_TYPE_FLOAT, "v"));
+  tExprNode* p2 = createOp(TSDB_BINARY_OP_DIVIDE, p1, createCol(3, TSDB_DATA_TYPE_BIGINT, "b"));
+  tExprNode* p3 = createOp(TSDB_BINARY_OP_REMAINDER, createValue(100), createCol(3, TSDB_DATA_TYPE_BIGINT, "b"));
+  return createOp(TSDB_BINARY_OP_SUBTRACT, p2, p3);
+}
+
+void compareWithTreeTraverse(tExprNode* pExpr, bool withNull, int32_t order) {
+  SBlock block = {0};
+  initBlock(&block, withNull);
+
+  auto* expected = (char*)calloc(numOfRows, sizeof(double));
+  auto* output = (char*)calloc(numOfRows, sizeof(double));
+
+  SArithmeticProgram* pProgram = arithmeticProgramCompile(pExpr);
+  ASSERT_TRUE(pProgram != NULL);
+
+  arithmeticTreeTraverse(pExpr, numOfRows, expected, &block, order, getBlockColumn);
+  ASSERT_EQ(arithmeticProgramExec(pProgram, numOfRows, output, &block, order, getBlockColumn), 0);
+  ASSERT_EQ(memcmp(expected, output, numOfRows * sizeof(double)), 0);
+
+  // a smaller block reuses the registers
+  arithmeticTreeTraverse(pExpr, 100, expected, &block, order, getBlockColumn);
+  ASSERT_EQ(arithmeticProgramExec(pProgram, 100, output, &block, order, getBlockColumn), 0);
+  ASSERT_EQ(memcmp(expected, output, 100 * sizeof(double)), 0);
+
+  arithmeticProgramDestroy(pProgram);
+  free(expected);
+  free(output);
+  destroyBlock(&block);
+}
+
+}  // namespace
+
+TEST(testCase, arithmeticProgramTest) {
+  tExprNode* pExprs[] = {createExprScale(), createExprSub(), createExprDivide()};
+
+  for (auto* pExpr : pExprs) {
+    compareWithTreeTraverse(pExpr, false, TSDB_ORDER_ASC);
+    compareWithTreeTraverse(pExpr, true, TSDB_ORDER_ASC);
+    compareWithTreeTraverse(pExpr, true, TSDB_ORDER_DESC);
+  }
+
+  for (auto* pExpr : pExprs) {
+    tExprTreeDestroy(pExpr, NULL);
+  }
+}
+
+TEST(testCase, arithmeticProgramUnsupported) {
+  // a tree of a single column, or a column of binary type, is left to arithmeticTreeTraverse
+  tExprNode* p1 = createCol(1, TSDB_DATA_TYPE_FLOAT, "v");
+  ASSERT_TRUE(arithmeticProgramCompile(p1) == NULL);
+
+  tExprNode* p2 = createOp(TSDB_BINARY_OP_ADD, createCol(4, TSDB_DATA_TYPE_BINARY, "c"), createValue(1));
+  ASSERT_TRUE(arithmeticProgramCompile(p2) == NULL);
+
+  tExprTreeDestroy(p1, NULL);
+  tExprTreeDestroy(p2, NULL);
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+extern "C" {
+#include "qExecutor.h"
+}
+#include "taos.h"
+#include "tsdb.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+SOperatorInfo* createOperator(const char* name, int64_t calls, int64_t rows, int64_t elapsed) {
+  SOperatorInfo* pOperator = (SOperatorInfo*)calloc(1, sizeof(SOperatorInfo));
+  pOperator->name = (char*)name;
+  pOperator->cost.numOfCalls = calls;
+  pOperator->cost.rowsOut = rows;
+  pOperator->cost.elapsedTime = elapsed;
+  return pOperator;
+}
+
+void addUpstream(SOperatorInfo* pOperator, SOperatorInfo* pUpstream) {
+  pOperator->upstream = (SOperatorInfo**)realloc(pOperator->upstream, sizeof(SOperatorInfo*) * (pOperator->numOfUpstream + 1));
+  pOperator->upstream[pOperator->numOfUpstream++] = pUpstream;
+}
+
+void destroyOperator(SOperatorInfo* pOperator) {
+  for (int32_t i = 0; i < pOperator->numOfUpstream; ++i) {
+    destroyOperator(pOperator->upstream[i]);
+  }
+
+  free(pOperator->upstream);
+  free(pOperator);
+}
+
+SQueryProfileOperator getProfile(SArray* pProfile, int32_t index) {
+  SQueryProfileOperator p = *(SQueryProfileOperator*)taosArrayGet(pProfile, index);
+  p.level = htons(p.level);
+  p.numOfCalls = htobe64(p.numOfCalls);
+  p.rowsIn = htobe64(p.rowsIn);
+  p.rowsOut = htobe64(p.rowsOut);
+  p.elapsedTime = htobe64(p.elapsedTime);
+  p.dataBlocks = htobe64(p.dataBlocks);
+  p.lastBlocks = htobe64(p.lastBlocks);
+  p.cacheBlocks = htobe64(p.cacheBlocks);
+  p.decompSize = htobe64(p.decompSize);
+  p.smaHits = htobe64(p.smaHits);
+  p.queueWaitTime = htobe64(p.queueWaitTime);
+  return p;
+}
+}  // namespace
+
+// the operator tree is sent in pre-order, with the io cost attributed to the first leaf
+TEST(queryProfileTest, preOrderTree) {
+  SQInfo* pQInfo = (SQInfo*)calloc(1, sizeof(SQInfo));
+
+  SOperatorInfo* pRoot = createOperator("Project", 3, 10, 900);
+  SOperatorInfo* pJoin = createOperator("Join", 3, 10, 800);
+  addUpstream(pRoot, pJoin);
+  addUpstream(pJoin, createOperator("TableScan", 5, 40, 300));
+  addUpstream(pJoin, createOperator("TableScan", 4, 30, 200));
+  pQInfo->runtimeEnv.proot = pRoot;
+
+  pQInfo->summary.totalRows = 1000;
+  pQInfo->summary.statisHitBlocks = 2;
+  pQInfo->summary.queueWaitTime = 77;
+  pQInfo->summary.ioCost.dataBlocks = 6;
+  pQInfo->summary.ioCost.lastBlocks = 1;
+  pQInfo->summary.ioCost.cacheBlocks = 3;
+  pQInfo->summary.ioCost.decompSize = 4096;
+
+  SArray* pProfile = createQueryProfile(pQInfo);
+  ASSERT_NE(pProfile, nullptr);
+  ASSERT_EQ(taosArrayGetSize(pProfile), 4u);
+
+  SQueryProfileOperator p0 = getProfile(pProfile, 0);
+  EXPECT_STREQ(p0.name, "Project");
+  EXPECT_EQ(p0.level, 0);
+  EXPECT_EQ(p0.rowsIn, 10);
+  EXPECT_EQ(p0.elapsedTime, 900);
+  EXPECT_EQ(p0.queueWaitTime, 77);
+  EXPECT_EQ(p0.dataBlocks, 0);
+
+  SQueryProfileOperator p1 = getProfile(pProfile, 1);
+  EXPECT_STREQ(p1.name, "Join");
+  EXPECT_EQ(p1.level, 1);
+  EXPECT_EQ(p1.rowsIn, 70);
+  EXPECT_EQ(p1.rowsOut, 10);
+  EXPECT_EQ(p1.queueWaitTime, 0);
+
+  SQueryProfileOperator p2 = getProfile(pProfile, 2);
+  EXPECT_EQ(p2.level, 2);
+  EXPECT_EQ(p2.numOfCalls, 5);
+  EXPECT_EQ(p2.rowsIn, 1000);
+  EXPECT_EQ(p2.rowsOut, 40);
+  EXPECT_EQ(p2.dataBlocks, 6);
+  EXPECT_EQ(p2.lastBlocks, 1);
+  EXPECT_EQ(p2.cacheBlocks, 3);
+  EXPECT_EQ(p2.decompSize, 4096);
+  EXPECT_EQ(p2.smaHits, 2);
+
+  SQueryProfileOperator p3 = getProfile(pProfile, 3);
+  EXPECT_EQ(p3.level, 2);
+  EXPECT_EQ(p3.numOfCalls, 4);
+  EXPECT_EQ(p3.rowsIn, 0);
+  EXPECT_EQ(p3.dataBlocks, 0);
+
+  taosArrayDestroy(pProfile);
+  destroyOperator(pRoot);
+  free(pQInfo);
+}
+
+TEST(queryProfileTest, noOperator) {
+  SQInfo* pQInfo = (SQInfo*)calloc(1, sizeof(SQInfo));
+
+  SArray* pProfile = createQueryProfile(pQInfo);
+  ASSERT_NE(pProfile, nullptr);
+  EXPECT_EQ(taosArrayGetSize(pProfile), 0u);
+
+  taosArrayDestroy(pProfile);
+  free(pQInfo);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <cassert>
 #include <iostream>
+#include <vector>
 
 #include "qResultbuf.h"
 #include "taos.h"
@@ -152,6 +153,46 @@ void recyclePageTest() {
 
   destroyResultBuf(pResultBuf);
 }
+// compressible pages are written in compressed form, the random ones are written as they are
+void compressPageTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 4096, 4*4096, 1);
+
+  const int32_t numOfPages = 64;
+  const int32_t size = 4096 - sizeof(tFilePage);
+  int32_t groupId = 0;
+
+  std::vector<std::vector<char>> expected(numOfPages);
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    int32_t pageId = 0;
+    tFilePage* pBufPage = getNewDataBuf(pResultBuf, groupId, &pageId);
+    ASSERT_EQ(pageId, i);
+
+    bool random = (i >= 16 && i < 24);
+    for (int32_t j = 0; j < size; ++j) {
+      pBufPage->data[j] = random ? (char)rand() : (char)((j % 64 == 0) ? i : 0);
+    }
+
+    pBufPage->num = i;
+    expected[i].assign(pBufPage->data, pBufPage->data + size);
+    releaseResBufPage(pResultBuf, pBufPage);
+  }
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage* pBufPage = getResBufPage(pResultBuf, i);
+    ASSERT_EQ(pBufPage->num, i);
+    ASSERT_EQ(memcmp(pBufPage->data, expected[i].data(), size), 0);
+    releaseResBufPage(pResultBuf, pBufPage);
+  }
+
+  SResultBufStatis* ps = &pResultBuf->statis;
+  ASSERT_GT(ps->compPages, 16);
+  ASSERT_LT(ps->compPages, ps->flushPages);
+  ASSERT_LT(ps->writeBytes, ps->flushBytes);
+  ASSERT_EQ(ps->flushBytes, (int64_t)ps->flushPages * 4096);
+
+  destroyResultBuf(pResultBuf);
+}
 } // namespace
 
 
@@ -160,4 +201,5 @@ TEST(testCase, resultBufferTest) {
   simpleTest();
   writeDownTest();
   recyclePageTest();
+  compressPageTest();
 }
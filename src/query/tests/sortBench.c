@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "qExecutor.h"
+#include "qExtbuffer.h"
+#include "qSort.h"
+#include "tcompare.h"
+
+/*
+ * Sort time of the columnwise quick sort of the in memory order operator, and of the radix sort of slices and the
+ * merge of them by the external merge sort, on random bigint keys. usage: sortBench [-n rows] [-t max threads]
+ */
+
+// the bigint key column, and an int column that keeps the row number
+static SSDataBlock *createBlock(int32_t rows, int32_t numOfCols) {
+  SSDataBlock *pBlock = calloc(1, sizeof(SSDataBlock));
+  pBlock->info.numOfCols = numOfCols;
+  pBlock->pDataBlock = taosArrayInit(numOfCols, sizeof(SColumnInfoData));
+
+  int16_t types[] = {TSDB_DATA_TYPE_BIGINT, TSDB_DATA_TYPE_INT};
+  int16_t bytes[] = {sizeof(int64_t), sizeof(int32_t)};
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SColumnInfoData idata = {{0}};
+    idata.info.colId = i + 1;
+    idata.info.type = types[i];
+    idata.info.bytes = bytes[i];
+    idata.pData = calloc(rows, bytes[i]);
+    taosArrayPush(pBlock->pDataBlock, &idata);
+  }
+
+  return pBlock;
+}
+
+static void destroyBlock(SSDataBlock *pBlock) {
+  for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData *pColInfo = taosArrayGet(pBlock->pDataBlock, i);
+    free(pColInfo->pData);
+  }
+
+  taosArrayDestroy(pBlock->pDataBlock);
+  free(pBlock);
+}
+
+int main(int argc, char *argv[]) {
+  int rows = 4000000;
+  int maxThreads = 4;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      rows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+      maxThreads = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options]\n", argv[0]);
+      printf("  [-n rows]: number of rows, default:%d\n", rows);
+      printf("  [-t threads]: max number of sort threads, default:%d\n", maxThreads);
+      exit(0);
+    }
+  }
+
+  if (rows <= 0 || maxThreads <= 0) {
+    printf("invalid number of rows or threads\n");
+    exit(1);
+  }
+
+  SSDataBlock     *pBlock = createBlock(rows, 2);
+  SColumnInfoData *pKey = taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData *pNo = taosArrayGet(pBlock->pDataBlock, 1);
+
+  srand(7);
+  for (int32_t i = 0; i < rows; ++i) {
+    ((int64_t *)pKey->pData)[i] = (int64_t)(((uint64_t)rand() << 32) | (uint64_t)rand());
+    ((int32_t *)pNo->pData)[i] = i;
+  }
+  pBlock->info.rows = rows;
+
+  char *key = malloc(sizeof(int64_t) * (size_t)rows);
+  char *no = malloc(sizeof(int32_t) * (size_t)rows);
+  memcpy(key, pKey->pData, sizeof(int64_t) * (size_t)rows);
+  memcpy(no, pNo->pData, sizeof(int32_t) * (size_t)rows);
+
+  // the columnwise quick sort of the in memory order operator
+  void   *pCols[2] = {key, no};
+  SSchema schema[2] = {{0}};
+  schema[0].type = TSDB_DATA_TYPE_BIGINT;
+  schema[0].bytes = sizeof(int64_t);
+  schema[1].type = TSDB_DATA_TYPE_INT;
+  schema[1].bytes = sizeof(int32_t);
+
+  int64_t st = taosGetTimestampUs();
+  taoscQSort(pCols, schema, 2, rows, 0, getKeyComparFunc(TSDB_DATA_TYPE_BIGINT, TSDB_ORDER_ASC));
+  int64_t qsortCost = taosGetTimestampUs() - st;
+
+  printf("sort %d bigint rows\n", rows);
+  printf("%-24s %8s %10s\n", "method", "slices", "time(s)");
+  printf("%-24s %8d %10.3f\n", "columnwise quick sort", 1, qsortCost / 1e6);
+
+  for (int32_t threads = 1; threads <= maxThreads; threads *= 2) {
+    SSDataBlock *pRes = createBlock(rows, 2);
+    int32_t     *pIndex = malloc(sizeof(int32_t) * (size_t)rows);
+
+    st = taosGetTimestampUs();
+    int32_t numOfSlices = sortGetNumOfSlices(rows, threads);
+    int32_t code = sortBlockSlices(pBlock, 0, TSDB_ORDER_ASC, numOfSlices, pIndex);
+
+    SArray      *pSources = taosArrayInit(numOfSlices, sizeof(SSortSource));
+    SSortMerger *pMerger = NULL;
+    if (code == TSDB_CODE_SUCCESS) {
+      sortAddSliceSources(pSources, pBlock, numOfSlices, pIndex);
+      code = sortMergerCreate(&pMerger, pSources, 0, TSDB_ORDER_ASC, TSDB_DATA_TYPE_BIGINT);
+    } else {
+      taosArrayDestroy(pSources);
+    }
+    if (code == TSDB_CODE_SUCCESS) {
+      code = sortMergerNext(pMerger, pRes, rows);
+    }
+    int64_t cost = taosGetTimestampUs() - st;
+
+    if (code != TSDB_CODE_SUCCESS) {
+      printf("failed to sort by %d threads, code:0x%x\n", threads, code);
+    } else if (pRes->info.rows != rows ||
+               memcmp(((SColumnInfoData *)taosArrayGet(pRes->pDataBlock, 0))->pData, key, sizeof(int64_t) * (size_t)rows) != 0) {
+      printf("result mismatch of the radix sort by %d threads\n", threads);
+    } else {
+      printf("%-24s %8d %10.3f\n", "radix sort and merge", numOfSlices, cost / 1e6);
+    }
+
+    sortMergerDestroy(pMerger);
+    destroyBlock(pRes);
+    free(pIndex);
+  }
+
+  free(key);
+  free(no);
+  destroyBlock(pBlock);
+  return 0;
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+#include <random>
+
+#include "qExecutor.h"
+#include "qExtbuffer.h"
+#include "qSort.h"
+#include "taos.h"
+#include "tcompare.h"
+#include "tsdb.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+// the key column of the given type, and an int column that keeps the row number
+SSDataBlock* createBlock(int32_t rows, int16_t type, int16_t bytes, uint32_t seed) {
+  SSDataBlock* pBlock = (SSDataBlock*)calloc(1, sizeof(SSDataBlock));
+  pBlock->info.numOfCols = 2;
+  pBlock->info.rows = rows;
+  pBlock->pDataBlock = (SArray*)taosArrayInit(2, sizeof(SColumnInfoData));
+
+  int16_t types[] = {type, TSDB_DATA_TYPE_INT};
+  int16_t size[] = {bytes, 4};
+  for (int32_t i = 0; i < 2; ++i) {
+    SColumnInfoData idata = {{0}};
+    idata.info.colId = i + 1;
+    idata.info.type = types[i];
+    idata.info.bytes = size[i];
+    idata.pData = (char*)calloc(rows, size[i]);
+    taosArrayPush(pBlock->pDataBlock, &idata);
+  }
+
+  std::mt19937     rng(seed);
+  SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pNo = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  for (int32_t i = 0; i < rows; ++i) {
+    char* p = pKey->pData + bytes * i;
+    bool  isNull = (rng() % 50 == 0);
+
+    switch (type) {
+      case TSDB_DATA_TYPE_INT:
+        *(int32_t*)p = (int32_t)(rng() % 100000) - 50000;
+        break;
+      case TSDB_DATA_TYPE_BIGINT:
+        *(int64_t*)p = (int64_t)(((uint64_t)rng() << 32) | rng());
+        break;
+      case TSDB_DATA_TYPE_FLOAT:
+        *(float*)p = (float)((int32_t)(rng() % 20000) - 10000) / 7;
+        break;
+      case TSDB_DATA_TYPE_DOUBLE:
+        *(double*)p = (double)((int32_t)(rng() % 2000000) - 1000000) / 13;
+        break;
+      case TSDB_DATA_TYPE_UTINYINT:
+        *(uint8_t*)p = (uint8_t)rng();
+        break;
+      case TSDB_DATA_TYPE_BINARY:
+        varDataSetLen(p, snprintf((char*)varDataVal(p), bytes - VARSTR_HEADER_SIZE, "k%u", rng() % 30000));
+        break;
+      default:
+        assert(0);
+    }
+
+    if (isNull && type != TSDB_DATA_TYPE_BINARY) {
+      setNull(p, type, bytes);
+    }
+
+    ((int32_t*)pNo->pData)[i] = i;
+  }
+
+  return pBlock;
+}
+
+void destroyBlock(SSDataBlock* pBlock) {
+  for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData* pColInfo = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, i);
+    free(pColInfo->pData);
+  }
+
+  taosArrayDestroy(pBlock->pDataBlock);
+  free(pBlock);
+}
+
+SSDataBlock* createEmptyBlock(SSDataBlock* pTemplate, int32_t rows) {
+  SSDataBlock* pBlock = (SSDataBlock*)calloc(1, sizeof(SSDataBlock));
+  pBlock->info.numOfCols = pTemplate->info.numOfCols;
+  pBlock->pDataBlock = (SArray*)taosArrayInit(pBlock->info.numOfCols, sizeof(SColumnInfoData));
+  for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData idata = *(SColumnInfoData*)taosArrayGet(pTemplate->pDataBlock, i);
+    idata.pData = (char*)calloc(rows, idata.info.bytes);
+    taosArrayPush(pBlock->pDataBlock, &idata);
+  }
+
+  return pBlock;
+}
+
+// the rows of pRes are sorted, and are the rows of pSrc with the row number in the second column
+void verifySorted(SSDataBlock* pSrc, SSDataBlock* pRes, int32_t order) {
+  SColumnInfoData* pSrcKey = (SColumnInfoData*)taosArrayGet(pSrc->pDataBlock, 0);
+  SColumnInfoData* pKey = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+  SColumnInfoData* pNo = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+  __compar_fn_t    comparFn = getKeyComparFunc(pKey->info.type, order);
+
+  int16_t           bytes = pKey->info.bytes;
+  std::vector<bool> found(pSrc->info.rows, false);
+  ASSERT_EQ(pRes->info.rows, pSrc->info.rows);
+
+  for (int32_t i = 0; i < pRes->info.rows; ++i) {
+    int32_t no = ((int32_t*)pNo->pData)[i];
+    ASSERT_TRUE(no >= 0 && no < pSrc->info.rows && !found[no]);
+    found[no] = true;
+
+    ASSERT_EQ(memcmp(pKey->pData + bytes * i, pSrcKey->pData + bytes * no, bytes), 0);
+    if (i > 0) {
+      ASSERT_LE(comparFn(pKey->pData + bytes * (i - 1), pKey->pData + bytes * i), 0);
+    }
+  }
+}
+
+// sort the block in slices, merge every two slices into a run on disk and keep the odd slice in memory
+void sortAndMerge(int16_t type, int16_t bytes, int32_t order, int32_t numOfSlices) {
+  const int32_t rows = 300000;
+  const int32_t capacity = 4096;
+
+  SSDataBlock* pBlock = createBlock(rows, type, bytes, type * 10 + order);
+  int32_t*     pIndex = (int32_t*)malloc(sizeof(int32_t) * rows);
+  ASSERT_EQ(sortBlockSlices(pBlock, 0, order, numOfSlices, pIndex), 0);
+
+  SSDataBlock* pBuf = createEmptyBlock(pBlock, capacity);
+  SArray*      pSources = (SArray*)taosArrayInit(4, sizeof(SSortSource));
+
+  // the runs on disk, each of them is merged from two slices
+  for (int32_t i = 0; i + 1 < numOfSlices; i += 2) {
+    SArray* pRunSources = (SArray*)taosArrayInit(2, sizeof(SSortSource));
+    for (int32_t j = i; j < i + 2; ++j) {
+      int32_t     start = (int32_t)(((int64_t)rows) * j / numOfSlices);
+      int32_t     end = (int32_t)(((int64_t)rows) * (j + 1) / numOfSlices);
+      SSortSource source = {0};
+      source.pBlock = pBlock;
+      source.pIndex = pIndex + start;
+      source.numOfRows = end - start;
+      taosArrayPush(pRunSources, &source);
+    }
+
+    SSpillBuf* pRun = NULL;
+    ASSERT_EQ(sortMergeToRun(pRunSources, pBuf, capacity, 0, order, type, 1, &pRun), 0);
+    int64_t expected = ((int64_t)rows) * (i + 2) / numOfSlices - ((int64_t)rows) * i / numOfSlices;
+    ASSERT_EQ(spillBufGetNumOfRows(pRun, 0), expected);
+    ASSERT_EQ(sortAddRunSource(pSources, pRun), 0);
+  }
+
+  // the last slice stays in memory if the number of slices is odd
+  if (numOfSlices % 2 == 1) {
+    int32_t     start = (int32_t)(((int64_t)rows) * (numOfSlices - 1) / numOfSlices);
+    SSortSource source = {0};
+    source.pBlock = pBlock;
+    source.pIndex = pIndex + start;
+    source.numOfRows = rows - start;
+    taosArrayPush(pSources, &source);
+  }
+
+  SSortMerger* pMerger = NULL;
+  ASSERT_EQ(sortMergerCreate(&pMerger, pSources, 0, order, type), 0);
+
+  SSDataBlock* pRes = createEmptyBlock(pBlock, rows);
+  while (1) {
+    int32_t prev = pRes->info.rows;
+    ASSERT_EQ(sortMergerNext(pMerger, pRes, MIN(prev + capacity, rows)), 0);
+    if (pRes->info.rows == prev) {
+      break;
+    }
+  }
+
+  verifySorted(pBlock, pRes, order);
+
+  sortMergerDestroy(pMerger);
+  destroyBlock(pRes);
+  destroyBlock(pBuf);
+  destroyBlock(pBlock);
+  free(pIndex);
+}
+}  // namespace
+
+TEST(testCase, sortMergeTest) {
+  sortAndMerge(TSDB_DATA_TYPE_INT, 4, TSDB_ORDER_ASC, 3);
+  sortAndMerge(TSDB_DATA_TYPE_INT, 4, TSDB_ORDER_DESC, 4);
+  sortAndMerge(TSDB_DATA_TYPE_BIGINT, 8, TSDB_ORDER_ASC, 5);
+  sortAndMerge(TSDB_DATA_TYPE_FLOAT, 4, TSDB_ORDER_DESC, 1);
+  sortAndMerge(TSDB_DATA_TYPE_DOUBLE, 8, TSDB_ORDER_ASC, 2);
+  sortAndMerge(TSDB_DATA_TYPE_UTINYINT, 1, TSDB_ORDER_DESC, 3);
+  sortAndMerge(TSDB_DATA_TYPE_BINARY, 12, TSDB_ORDER_ASC, 3);
+  sortAndMerge(TSDB_DATA_TYPE_BINARY, 12, TSDB_ORDER_DESC, 2);
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "qExecutor.h"
+#include "qSpillbuf.h"
+#include "taos.h"
+#include "tsdb.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+// ts, int and binary(10) column, the int column keeps the row number
+SSDataBlock* createBlock(int32_t rows, int32_t base) {
+  SSDataBlock* pBlock = (SSDataBlock*)calloc(1, sizeof(SSDataBlock));
+  pBlock->info.numOfCols = 3;
+  pBlock->info.rows = rows;
+  pBlock->pDataBlock = (SArray*)taosArrayInit(3, sizeof(SColumnInfoData));
+
+  int16_t types[] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_BINARY};
+  int16_t bytes[] = {8, 4, 10 + VARSTR_HEADER_SIZE};
+  for (int32_t i = 0; i < 3; ++i) {
+    SColumnInfoData idata = {{0}};
+    idata.info.colId = i + 1;
+    idata.info.type = types[i];
+    idata.info.bytes = bytes[i];
+    idata.pData = (char*)calloc(rows, bytes[i]);
+    taosArrayPush(pBlock->pDataBlock, &idata);
+  }
+
+  SColumnInfoData* pTs = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pInt = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pBin = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+  for (int32_t i = 0; i < rows; ++i) {
+    ((int64_t*)pTs->pData)[i] = 1600000000000L + base + i;
+    ((int32_t*)pInt->pData)[i] = base + i;
+
+    char* p = pBin->pData + bytes[2] * i;
+    varDataSetLen(p, snprintf((char*)varDataVal(p), 10, "r%d", base + i));
+  }
+
+  return pBlock;
+}
+
+void destroyBlock(SSDataBlock* pBlock) {
+  for (int32_t i = 0; i < pBlock->info.numOfCols; ++i) {
+    SColumnInfoData* pColInfo = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, i);
+    free(pColInfo->pData);
+  }
+
+  taosArrayDestroy(pBlock->pDataBlock);
+  free(pBlock);
+}
+
+void verifyRun(SSDataBlock* pBlock, int32_t expectedFirst) {
+  SColumnInfoData* pTs = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+  SColumnInfoData* pInt = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+  SColumnInfoData* pBin = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 2);
+
+  for (int32_t i = 0; i < pBlock->info.rows; ++i) {
+    int32_t v = expectedFirst + i;
+    ASSERT_EQ(((int32_t*)pInt->pData)[i], v);
+    ASSERT_EQ(((int64_t*)pTs->pData)[i], 1600000000000L + v);
+
+    char  buf[16] = {0};
+    char* p = pBin->pData + pBin->info.bytes * i;
+    snprintf(buf, sizeof(buf), "r%d", v);
+    ASSERT_EQ(varDataLen(p), strlen(buf));
+    ASSERT_EQ(memcmp(varDataVal(p), buf, varDataLen(p)), 0);
+  }
+
+  ASSERT_EQ(pBlock->info.window.skey, 1600000000000L + expectedFirst);
+  ASSERT_EQ(pBlock->info.window.ekey, 1600000000000L + expectedFirst + pBlock->info.rows - 1);
+}
+}  // namespace
+
+TEST(testCase, spillBufTest) {
+  SSDataBlock* pBlock = createBlock(4096, 0);
+
+  SSpillBuf* pSpillBuf = createSpillBuf(pBlock, 4, 0, 1);
+  ASSERT_TRUE(pSpillBuf != NULL);
+
+  // partition 0 gets two tables, the rows of a table are kept in their own runs
+  ASSERT_EQ(spillBufAppend(pSpillBuf, 0, pBlock, 0, 10, 100), 0);
+  ASSERT_EQ(spillBufAppend(pSpillBuf, 0, pBlock, 10, 5, 100), 0);
+  ASSERT_EQ(spillBufAppend(pSpillBuf, 0, pBlock, 20, 3, 200), 0);
+
+  // partition 1 gets more rows than a run can hold
+  ASSERT_EQ(spillBufAppend(pSpillBuf, 1, pBlock, 0, 4096, 300), 0);
+
+  ASSERT_EQ(spillBufGetNumOfRows(pSpillBuf, 0), 18);
+  ASSERT_EQ(spillBufGetNumOfRows(pSpillBuf, 1), 4096);
+  ASSERT_EQ(spillBufGetNumOfRows(pSpillBuf, 2), 0);
+
+  int64_t      tag = 0;
+  SSDataBlock* pRun = NULL;
+
+  ASSERT_EQ(spillBufBeginRead(pSpillBuf, 0), 0);
+  ASSERT_EQ(spillBufReadNext(pSpillBuf, 0, &tag, &pRun), 0);
+  ASSERT_TRUE(pRun != NULL);
+  ASSERT_EQ(tag, 100);
+  ASSERT_EQ(pRun->info.rows, 15);
+  verifyRun(pRun, 0);
+
+  ASSERT_EQ(spillBufReadNext(pSpillBuf, 0, &tag, &pRun), 0);
+  ASSERT_EQ(tag, 200);
+  ASSERT_EQ(pRun->info.rows, 3);
+  verifyRun(pRun, 20);
+
+  ASSERT_EQ(spillBufReadNext(pSpillBuf, 0, &tag, &pRun), 0);
+  ASSERT_TRUE(pRun == NULL);
+  spillBufRemovePartition(pSpillBuf, 0);
+
+  ASSERT_EQ(spillBufBeginRead(pSpillBuf, 1), 0);
+  int32_t total = 0;
+  while (1) {
+    ASSERT_EQ(spillBufReadNext(pSpillBuf, 1, &tag, &pRun), 0);
+    if (pRun == NULL) {
+      break;
+    }
+
+    ASSERT_EQ(tag, 300);
+    ASSERT_LE(pRun->info.rows, pSpillBuf->capacity);
+    verifyRun(pRun, total);
+    total += pRun->info.rows;
+  }
+  ASSERT_EQ(total, 4096);
+
+  // an empty partition has no run at all
+  ASSERT_EQ(spillBufBeginRead(pSpillBuf, 2), 0);
+  ASSERT_EQ(spillBufReadNext(pSpillBuf, 2, &tag, &pRun), 0);
+  ASSERT_TRUE(pRun == NULL);
+
+  destroySpillBuf(pSpillBuf);
+  destroyBlock(pBlock);
+}
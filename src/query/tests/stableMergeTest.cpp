@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "qAggMain.h"
+#include "taos.h"
+#include "tsdb.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+// the layout of the intermediate results in qAggMain.c
+typedef struct {
+  union {
+    int64_t  isum;
+    uint64_t usum;
+    double   dsum;
+  };
+  int8_t hasResult;
+} SSumRes;
+
+typedef struct {
+  double  sum;
+  int64_t num;
+} SAvgRes;
+
+typedef struct {
+  double min;
+  double max;
+  int8_t hasResult;
+} SSpreadRes;
+
+// the value of min/max followed by the data set flag
+template <typename T>
+std::vector<char> createMinMaxRes(T val, bool hasResult) {
+  std::vector<char> buf(sizeof(T) + DATA_SET_FLAG_SIZE, 0);
+  *(T*)&buf[0] = val;
+  if (hasResult) {
+    buf[sizeof(T)] = DATA_SET_FLAG;
+  }
+  return buf;
+}
+}  // namespace
+
+TEST(stableMergeTest, mergeableFunction) {
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_COUNT));
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_SUM));
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_AVG));
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_MIN));
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_MAX));
+  EXPECT_TRUE(isMergeableSTableResult(TSDB_FUNC_SPREAD));
+
+  // the intermediate result of these functions are not of a fixed small size, or depend on the row order
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_FIRST));
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_LAST));
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_TOP));
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_PERCT));
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_STDDEV));
+  EXPECT_FALSE(isMergeableSTableResult(TSDB_FUNC_TS));
+
+  int16_t type = 0, bytes = 0;
+  int32_t interBytes = 0;
+  getResultDataInfo(TSDB_DATA_TYPE_INT, sizeof(int32_t), TSDB_FUNC_SUM, 0, &type, &bytes, &interBytes, 0, true, NULL);
+  EXPECT_EQ(bytes, (int16_t)sizeof(SSumRes));
+  getResultDataInfo(TSDB_DATA_TYPE_INT, sizeof(int32_t), TSDB_FUNC_AVG, 0, &type, &bytes, &interBytes, 0, true, NULL);
+  EXPECT_EQ(bytes, (int16_t)sizeof(SAvgRes));
+  getResultDataInfo(TSDB_DATA_TYPE_INT, sizeof(int32_t), TSDB_FUNC_SPREAD, 0, &type, &bytes, &interBytes, 0, true, NULL);
+  EXPECT_EQ(bytes, (int16_t)sizeof(SSpreadRes));
+}
+
+TEST(stableMergeTest, countSumAvg) {
+  int64_t c1 = 10, c2 = 32;
+  mergeSTableResult(TSDB_FUNC_COUNT, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&c1, (char*)&c2);
+  EXPECT_EQ(c1, 42);
+
+  SSumRes s1 = {}, s2 = {};
+  s2.isum = -5;
+  s2.hasResult = DATA_SET_FLAG;
+  mergeSTableResult(TSDB_FUNC_SUM, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&s2);
+  EXPECT_EQ(s1.isum, -5);
+  EXPECT_EQ(s1.hasResult, DATA_SET_FLAG);
+
+  s2.isum = 7;
+  mergeSTableResult(TSDB_FUNC_SUM, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&s2);
+  EXPECT_EQ(s1.isum, 2);
+
+  // a worker with no rows does not change the result
+  SSumRes empty = {};
+  mergeSTableResult(TSDB_FUNC_SUM, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&empty);
+  EXPECT_EQ(s1.isum, 2);
+
+  SSumRes u1 = {}, u2 = {};
+  u1.usum = UINT64_MAX - 1;
+  u1.hasResult = DATA_SET_FLAG;
+  u2.usum = 1;
+  u2.hasResult = DATA_SET_FLAG;
+  mergeSTableResult(TSDB_FUNC_SUM, TSDB_DATA_TYPE_UBIGINT, sizeof(uint64_t), (char*)&u1, (char*)&u2);
+  EXPECT_EQ(u1.usum, UINT64_MAX);
+
+  SSumRes d1 = {}, d2 = {};
+  d1.dsum = 1.5;
+  d1.hasResult = DATA_SET_FLAG;
+  d2.dsum = 2.25;
+  d2.hasResult = DATA_SET_FLAG;
+  mergeSTableResult(TSDB_FUNC_SUM, TSDB_DATA_TYPE_DOUBLE, sizeof(double), (char*)&d1, (char*)&d2);
+  EXPECT_DOUBLE_EQ(d1.dsum, 3.75);
+
+  SAvgRes a1 = {10.0, 4}, a2 = {26.0, 4};
+  mergeSTableResult(TSDB_FUNC_AVG, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&a1, (char*)&a2);
+  EXPECT_DOUBLE_EQ(a1.sum, 36.0);
+  EXPECT_EQ(a1.num, 8);
+}
+
+TEST(stableMergeTest, minMax) {
+  std::vector<char> dst = createMinMaxRes<int32_t>(0, false);
+  std::vector<char> src = createMinMaxRes<int32_t>(-3, true);
+
+  // the value is taken as is when the result is not set yet, even if it is larger than the initial value
+  std::vector<char> big = createMinMaxRes<int32_t>(100, true);
+  mergeSTableResult(TSDB_FUNC_MIN, TSDB_DATA_TYPE_INT, sizeof(int32_t), &dst[0], &big[0]);
+  EXPECT_EQ(*(int32_t*)&dst[0], 100);
+  EXPECT_EQ(dst[sizeof(int32_t)], DATA_SET_FLAG);
+
+  mergeSTableResult(TSDB_FUNC_MIN, TSDB_DATA_TYPE_INT, sizeof(int32_t), &dst[0], &src[0]);
+  EXPECT_EQ(*(int32_t*)&dst[0], -3);
+
+  // a source without result is skipped
+  std::vector<char> none = createMinMaxRes<int32_t>(-100, false);
+  mergeSTableResult(TSDB_FUNC_MIN, TSDB_DATA_TYPE_INT, sizeof(int32_t), &dst[0], &none[0]);
+  EXPECT_EQ(*(int32_t*)&dst[0], -3);
+
+  mergeSTableResult(TSDB_FUNC_MAX, TSDB_DATA_TYPE_INT, sizeof(int32_t), &dst[0], &big[0]);
+  EXPECT_EQ(*(int32_t*)&dst[0], 100);
+
+  std::vector<char> u1 = createMinMaxRes<uint64_t>(1, true);
+  std::vector<char> u2 = createMinMaxRes<uint64_t>(UINT64_MAX, true);
+  mergeSTableResult(TSDB_FUNC_MAX, TSDB_DATA_TYPE_UBIGINT, sizeof(uint64_t), &u1[0], &u2[0]);
+  EXPECT_EQ(*(uint64_t*)&u1[0], UINT64_MAX);
+
+  std::vector<char> d1 = createMinMaxRes<double>(0.5, true);
+  std::vector<char> d2 = createMinMaxRes<double>(-0.25, true);
+  mergeSTableResult(TSDB_FUNC_MIN, TSDB_DATA_TYPE_DOUBLE, sizeof(double), &d1[0], &d2[0]);
+  EXPECT_DOUBLE_EQ(*(double*)&d1[0], -0.25);
+}
+
+TEST(stableMergeTest, spread) {
+  SSpreadRes s1 = {}, s2 = {2.0, 8.0, DATA_SET_FLAG};
+  mergeSTableResult(TSDB_FUNC_SPREAD, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&s2);
+  EXPECT_DOUBLE_EQ(s1.min, 2.0);
+  EXPECT_DOUBLE_EQ(s1.max, 8.0);
+
+  SSpreadRes s3 = {-1.0, 5.0, DATA_SET_FLAG};
+  mergeSTableResult(TSDB_FUNC_SPREAD, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&s3);
+  EXPECT_DOUBLE_EQ(s1.min, -1.0);
+  EXPECT_DOUBLE_EQ(s1.max, 8.0);
+
+  SSpreadRes empty = {-100.0, 100.0, 0};
+  mergeSTableResult(TSDB_FUNC_SPREAD, TSDB_DATA_TYPE_INT, sizeof(int32_t), (char*)&s1, (char*)&empty);
+  EXPECT_DOUBLE_EQ(s1.min, -1.0);
+  EXPECT_DOUBLE_EQ(s1.max, 8.0);
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "qExecutor.h"
+}
+#include "taos.h"
+#include "tsdb.h"
+
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+namespace {
+const int32_t kValColId = 1;
+
+// the rows of (ts, val) returned by the fake upstream operator, one block per call
+typedef struct SUpstreamInfo {
+  std::vector<SSDataBlock*> blocks;
+  size_t                    next;
+} SUpstreamInfo;
+
+SSDataBlock* doUpstream(void* param, bool* newgroup) {
+  SOperatorInfo* pOperator = (SOperatorInfo*)param;
+  SUpstreamInfo* pInfo = (SUpstreamInfo*)pOperator->info;
+  *newgroup = false;
+  if (pInfo->next >= pInfo->blocks.size()) {
+    return NULL;
+  }
+
+  return pInfo->blocks[pInfo->next++];
+}
+
+void setExpr(SExprInfo* pExpr, int16_t colId, int16_t type, int16_t bytes) {
+  memset(pExpr, 0, sizeof(SExprInfo));
+  pExpr->base.functionId = TSDB_FUNC_PRJ;
+  pExpr->base.colInfo.colId = colId;
+  pExpr->base.resType = type;
+  pExpr->base.resBytes = bytes;
+  pExpr->base.resColId = colId;
+}
+
+class TopNTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pQInfo = (SQInfo*)calloc(1, sizeof(SQInfo));
+    pQInfo->runtimeEnv.qinfo = pQInfo;
+    pQInfo->runtimeEnv.resultInfo.capacity = 4;
+
+    setExpr(&expr[0], PRIMARYKEY_TIMESTAMP_COL_INDEX, TSDB_DATA_TYPE_TIMESTAMP, sizeof(int64_t));
+    setExpr(&expr[1], kValColId, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+
+    upstream.next = 0;
+    pUpstream = (SOperatorInfo*)calloc(1, sizeof(SOperatorInfo));
+    pUpstream->name = (char*)"Upstream";
+    pUpstream->info = &upstream;
+    pUpstream->exec = doUpstream;
+  }
+
+  void TearDown() override {
+    for (size_t i = 0; i < upstream.blocks.size(); ++i) {
+      destroyOutputBuf(upstream.blocks[i]);
+    }
+
+    if (pOperator != NULL) {
+      pOperator->cleanup(pOperator->info, pOperator->numOfOutput);
+      free(pOperator->info);
+      free(pOperator->upstream);
+      free(pOperator);
+    }
+
+    free(pUpstream);
+    free(pQInfo);
+  }
+
+  // the value of the row ts in the upstream is vals[ts]
+  void addBlock(const std::vector<int32_t>& vals, int32_t ts0) {
+    SSDataBlock* pBlock = createOutputBuf(expr, 2, (int32_t)vals.size());
+    SColumnInfoData* pTs = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 0);
+    SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pBlock->pDataBlock, 1);
+    for (size_t i = 0; i < vals.size(); ++i) {
+      ((int64_t*)pTs->pData)[i] = ts0 + (int64_t)i;
+      ((int32_t*)pVal->pData)[i] = vals[i];
+    }
+
+    pBlock->info.rows = (int32_t)vals.size();
+    upstream.blocks.push_back(pBlock);
+  }
+
+  // all rows returned by the TopN operator, each one as (ts, val)
+  std::vector<std::pair<int64_t, int32_t> > run(uint32_t order, int64_t limit, int32_t* numOfBlocks) {
+    SOrderVal orderVal = {order, kValColId};
+    pOperator = createTopNOperatorInfo(&pQInfo->runtimeEnv, pUpstream, expr, 2, &orderVal, limit);
+
+    std::vector<std::pair<int64_t, int32_t> > res;
+    *numOfBlocks = 0;
+
+    bool newgroup = false;
+    while (1) {
+      SSDataBlock* pRes = pOperator->exec(pOperator, &newgroup);
+      if (pRes == NULL) {
+        break;
+      }
+
+      EXPECT_LE(pRes->info.rows, pQInfo->runtimeEnv.resultInfo.capacity);
+      SColumnInfoData* pTs = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 0);
+      SColumnInfoData* pVal = (SColumnInfoData*)taosArrayGet(pRes->pDataBlock, 1);
+      for (int32_t i = 0; i < pRes->info.rows; ++i) {
+        res.push_back(std::make_pair(((int64_t*)pTs->pData)[i], ((int32_t*)pVal->pData)[i]));
+      }
+      *numOfBlocks += 1;
+    }
+
+    EXPECT_EQ(pOperator->status, OP_EXEC_DONE);
+    return res;
+  }
+
+  SQInfo*        pQInfo = NULL;
+  SExprInfo      expr[2];
+  SUpstreamInfo  upstream;
+  SOperatorInfo* pUpstream = NULL;
+  SOperatorInfo* pOperator = NULL;
+};
+
+// the values of the first n rows in order, the same as sorting all rows
+std::vector<int32_t> expectedTop(const std::vector<int32_t>& vals, bool asc, size_t n) {
+  std::vector<int32_t> sorted(vals);
+  if (asc) {
+    std::sort(sorted.begin(), sorted.end());
+  } else {
+    std::sort(sorted.begin(), sorted.end(), std::greater<int32_t>());
+  }
+
+  sorted.resize(std::min(n, sorted.size()));
+  return sorted;
+}
+}  // namespace
+
+TEST_F(TopNTest, descAcrossBlocks) {
+  std::vector<int32_t> vals = {5, 17, -3, 42, 8, 0, 23, 11, 99, -50, 7, 64, 31, 2, 18};
+  addBlock(std::vector<int32_t>(vals.begin(), vals.begin() + 6), 0);
+  addBlock(std::vector<int32_t>(vals.begin() + 6, vals.begin() + 10), 6);
+  addBlock(std::vector<int32_t>(vals.begin() + 10, vals.end()), 10);
+
+  // the heap grows from the capacity of one output block up to the limit
+  int32_t numOfBlocks = 0;
+  std::vector<std::pair<int64_t, int32_t> > res = run(TSDB_ORDER_DESC, 10, &numOfBlocks);
+
+  std::vector<int32_t> expected = expectedTop(vals, false, 10);
+  ASSERT_EQ(res.size(), expected.size());
+  for (size_t i = 0; i < res.size(); ++i) {
+    EXPECT_EQ(res[i].second, expected[i]);
+    // each row keeps its own timestamp
+    EXPECT_EQ(vals[res[i].first], res[i].second);
+  }
+  EXPECT_EQ(numOfBlocks, 3);
+}
+
+TEST_F(TopNTest, ascFewerRowsThanLimit) {
+  std::vector<int32_t> vals = {9, 4, 7, 1, 6};
+  addBlock(vals, 0);
+
+  int32_t numOfBlocks = 0;
+  std::vector<std::pair<int64_t, int32_t> > res = run(TSDB_ORDER_ASC, 100, &numOfBlocks);
+
+  std::vector<int32_t> expected = expectedTop(vals, true, 100);
+  ASSERT_EQ(res.size(), vals.size());
+  for (size_t i = 0; i < res.size(); ++i) {
+    EXPECT_EQ(res[i].second, expected[i]);
+    EXPECT_EQ(vals[res[i].first], res[i].second);
+  }
+  EXPECT_EQ(numOfBlocks, 2);
+}
+
+TEST_F(TopNTest, limitWithOffset) {
+  // the client asks each vnode for limit + offset rows, then skips the offset after the merge
+  std::vector<int32_t> vals;
+  for (int32_t i = 0; i < 200; ++i) {
+    vals.push_back((i * 37) % 211);
+  }
+  for (size_t i = 0; i < vals.size(); i += 16) {
+    addBlock(std::vector<int32_t>(vals.begin() + i, vals.begin() + std::min(i + 16, vals.size())), (int32_t)i);
+  }
+
+  const int64_t limit = 5, offset = 3;
+  int32_t numOfBlocks = 0;
+  std::vector<std::pair<int64_t, int32_t> > res = run(TSDB_ORDER_ASC, limit + offset, &numOfBlocks);
+
+  std::vector<int32_t> expected = expectedTop(vals, true, limit + offset);
+  ASSERT_EQ(res.size(), (size_t)(limit + offset));
+  for (size_t i = offset; i < res.size(); ++i) {
+    EXPECT_EQ(res[i].second, expected[i]);
+  }
+}
+
+TEST_F(TopNTest, ties) {
+  // many rows share the same value, only the number of each value kept matters
+  std::vector<int32_t> vals = {3, 1, 3, 2, 3, 1, 2, 3, 1, 3, 2, 1};
+  addBlock(std::vector<int32_t>(vals.begin(), vals.begin() + 5), 0);
+  addBlock(std::vector<int32_t>(vals.begin() + 5, vals.end()), 5);
+
+  int32_t numOfBlocks = 0;
+  std::vector<std::pair<int64_t, int32_t> > res = run(TSDB_ORDER_DESC, 7, &numOfBlocks);
+
+  std::vector<int32_t> expected = {3, 3, 3, 3, 3, 2, 2};
+  ASSERT_EQ(res.size(), expected.size());
+  std::vector<int64_t> ts;
+  for (size_t i = 0; i < res.size(); ++i) {
+    EXPECT_EQ(res[i].second, expected[i]);
+    EXPECT_EQ(vals[res[i].first], res[i].second);
+    ts.push_back(res[i].first);
+  }
+
+  // no row is returned twice
+  std::sort(ts.begin(), ts.end());
+  EXPECT_TRUE(std::unique(ts.begin(), ts.end()) == ts.end());
+}
+
+TEST_F(TopNTest, noUpstreamRows) {
+  int32_t numOfBlocks = 0;
+  std::vector<std::pair<int64_t, int32_t> > res = run(TSDB_ORDER_DESC, 10, &numOfBlocks);
+  EXPECT_TRUE(res.empty());
+  EXPECT_EQ(numOfBlocks, 0);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_RPC_COMP_H
+#define TDENGINE_RPC_COMP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "taosdef.h"
+
+// codec carried in the comp bits of SRpcHead
+#define RPC_COMP_NONE      0
+#define RPC_COMP_LZ4       1
+#define RPC_COMP_DEFLATE   2
+#define RPC_COMP_CODECS    3
+
+// value of tsRpcCompressAlgo only, the codec is chosen per message type by the observed ratio and speed
+#define RPC_COMP_ADAPTIVE  3
+
+// codecs other than lz4 are announced in the codecs of SRpcHead, a bit per codec, since an old peer decodes lz4 only
+#define RPC_COMP_CODEC_BIT(comp) ((uint8_t)(1u << (comp)))
+#define RPC_COMP_DECODABLE       RPC_COMP_CODEC_BIT(RPC_COMP_DEFLATE)
+
+bool    rpcIsValidCodec(int8_t comp);
+bool    rpcIsPeerCodec(int8_t comp, uint8_t peerCodecs);
+int32_t rpcCompressCont(uint8_t msgType, uint8_t peerCodecs, const char *pCont, int32_t contLen, char *buf,
+                        int32_t bufLen, int8_t *pComp);
+int32_t rpcDecompressCont(int8_t comp, const char *buf, int32_t bufLen, char *pCont, int32_t contLen);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_RPC_COMP_H
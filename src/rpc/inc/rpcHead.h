@@ -22,6 +22,8 @@ extern "C" {
 
 #define RPC_CONN_TCP    2
 
+#define RPC_FLAG_MUX    1  // in resflag, the TCP connection is shared by the rpc connections to the same end point
+
 extern int tsRpcOverhead;
 
 typedef struct {
@@ -51,7 +53,7 @@ typedef struct {
   uint32_t destIp;    // destination IP address, for NAT scenario
   char     user[TSDB_UNI_LEN]; // user ID 
   uint16_t port;      // for UDP only, port may be changed
-  char     empty[1];  // reserved
+  uint8_t  codecs;    // compression codecs other than lz4 the sender decodes, 0 from an old peer
   uint8_t  msgType;   // message type  
   int32_t  msgLen;    // message length including the header iteslf
   uint32_t msgVer;
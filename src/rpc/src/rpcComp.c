@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "lz4.h"
+#include "zlib.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "taosmsg.h"
+#include "rpcLog.h"
+#include "rpcComp.h"
+
+#define RPC_COMP_WARMUP          8    // messages of a type compressed by each codec in turn before choosing
+#define RPC_COMP_PROBE_INTERVAL  32   // the codecs not chosen are tried again once in this number of messages
+#define RPC_COMP_MIN_SAVING      50   // per mille, a message type saving less than this is sent uncompressed
+#define RPC_COMP_BETTER_RATIO    90   // percent, a slower codec is chosen only if its ratio is below this of lz4's
+
+typedef struct {
+  const char *name;
+  int32_t   (*compFp)(const char *src, int32_t srcLen, char *dst, int32_t dstLen);
+  int32_t   (*decompFp)(const char *src, int32_t srcLen, char *dst, int32_t dstLen);
+} SRpcCodec;
+
+typedef struct {
+  int32_t ratio;  // compressed size in per mille of the original size
+  int32_t speed;  // bytes compressed per microsecond, i.e. MB/s
+} SRpcCodecStat;
+
+typedef struct {
+  int32_t       count;
+  SRpcCodecStat codec[RPC_COMP_CODECS];
+} SRpcCompStat;
+
+static int32_t rpcLz4Compress(const char *src, int32_t srcLen, char *dst, int32_t dstLen) {
+  return LZ4_compress_default(src, dst, srcLen, dstLen);
+}
+
+static int32_t rpcLz4Decompress(const char *src, int32_t srcLen, char *dst, int32_t dstLen) {
+  return LZ4_decompress_safe(src, dst, srcLen, dstLen);
+}
+
+static int32_t rpcDeflateCompress(const char *src, int32_t srcLen, char *dst, int32_t dstLen) {
+  uLongf len = dstLen;
+  if (compress2((Bytef *)dst, &len, (const Bytef *)src, srcLen, tsRpcCompressLevel) != Z_OK) return 0;
+  return (int32_t)len;
+}
+
+static int32_t rpcDeflateDecompress(const char *src, int32_t srcLen, char *dst, int32_t dstLen) {
+  uLongf len = dstLen;
+  if (uncompress((Bytef *)dst, &len, (const Bytef *)src, srcLen) != Z_OK) return -1;
+  return (int32_t)len;
+}
+
+static SRpcCodec tsRpcCodecs[RPC_COMP_CODECS] = {
+  {"none",    NULL,               NULL},
+  {"lz4",     rpcLz4Compress,     rpcLz4Decompress},
+  {"deflate", rpcDeflateCompress, rpcDeflateDecompress},
+};
+
+// shared by all rpc instances and threads, a lost update only delays the adaption
+static SRpcCompStat tsRpcCompStat[TSDB_MSG_TYPE_MAX];
+
+bool rpcIsValidCodec(int8_t comp) {
+  return comp > RPC_COMP_NONE && comp < RPC_COMP_CODECS;
+}
+
+// whether the peer decodes the codec, any peer decodes lz4
+bool rpcIsPeerCodec(int8_t comp, uint8_t peerCodecs) {
+  if (comp == RPC_COMP_NONE || comp == RPC_COMP_LZ4) return true;
+  return rpcIsValidCodec(comp) && (peerCodecs & RPC_COMP_CODEC_BIT(comp)) != 0;
+}
+
+static int8_t rpcProbeCodec(int32_t round, uint8_t peerCodecs) {
+  int8_t comp = (int8_t)(RPC_COMP_LZ4 + round % (RPC_COMP_CODECS - 1));
+  return rpcIsPeerCodec(comp, peerCodecs) ? comp : RPC_COMP_LZ4;
+}
+
+static int8_t rpcChooseCodec(SRpcCompStat *pStat, uint8_t peerCodecs) {
+  int32_t count = atomic_fetch_add_32(&pStat->count, 1);
+
+  if (count < RPC_COMP_WARMUP) return rpcProbeCodec(count, peerCodecs);
+  if (count % RPC_COMP_PROBE_INTERVAL == 0) return rpcProbeCodec(count / RPC_COMP_PROBE_INTERVAL, peerCodecs);
+
+  SRpcCodecStat *pLz4 = &pStat->codec[RPC_COMP_LZ4];
+  SRpcCodecStat *pDeflate = &pStat->codec[RPC_COMP_DEFLATE];
+
+  int8_t  comp = RPC_COMP_LZ4;
+  int32_t ratio = pLz4->ratio;
+  if (rpcIsPeerCodec(RPC_COMP_DEFLATE, peerCodecs) && pDeflate->speed >= tsRpcCompressMinSpeed &&
+      pDeflate->ratio * 100 < pLz4->ratio * RPC_COMP_BETTER_RATIO) {
+    comp = RPC_COMP_DEFLATE;
+    ratio = pDeflate->ratio;
+  }
+
+  if (ratio > 1000 - RPC_COMP_MIN_SAVING) return RPC_COMP_NONE;
+  return comp;
+}
+
+static void rpcUpdateCodecStat(SRpcCodecStat *pStat, int32_t ratio, int32_t speed) {
+  if (pStat->speed == 0) {
+    pStat->ratio = ratio;
+    pStat->speed = speed;
+  } else {
+    pStat->ratio = (pStat->ratio * 3 + ratio) / 4;
+    pStat->speed = (pStat->speed * 3 + speed) / 4;
+  }
+}
+
+/*
+ * compress the content into buf by a codec the peer decodes, return the compressed length, or 0 if the message is sent
+ * uncompressed since the compressed content does not fit into bufLen bytes
+ */
+int32_t rpcCompressCont(uint8_t msgType, uint8_t peerCodecs, const char *pCont, int32_t contLen, char *buf,
+                        int32_t bufLen, int8_t *pComp) {
+  SRpcCompStat *pStat = (msgType < TSDB_MSG_TYPE_MAX) ? &tsRpcCompStat[msgType] : NULL;
+  int8_t        comp = (int8_t)tsRpcCompressAlgo;
+
+  if (bufLen <= 0) return 0;
+
+  if (comp == RPC_COMP_ADAPTIVE) {
+    if (pStat == NULL) return 0;
+    comp = rpcChooseCodec(pStat, peerCodecs);
+  }
+
+  if (!rpcIsValidCodec(comp)) return 0;
+  if (!rpcIsPeerCodec(comp, peerCodecs)) comp = RPC_COMP_LZ4;
+
+  SRpcCodec *pCodec = &tsRpcCodecs[comp];
+  int64_t    st = taosGetTimestampUs();
+  int32_t    compLen = (*pCodec->compFp)(pCont, contLen, buf, bufLen);
+  int64_t    cost = taosGetTimestampUs() - st;
+
+  if (compLen < 0) compLen = 0;
+
+  if (pStat != NULL) {
+    int32_t ratio = (compLen > 0) ? (int32_t)((int64_t)compLen * 1000 / contLen) : 1000;
+    int32_t speed = (int32_t)(contLen / ((cost > 0) ? cost : 1));
+    if (speed == 0) speed = 1;
+    rpcUpdateCodecStat(&pStat->codec[comp], ratio, speed);
+  }
+
+  tTrace("compress %s msg by %s, before:%d after:%d cost:%" PRId64 "us", (pStat != NULL) ? taosMsg[msgType] : "",
+         pCodec->name, contLen, compLen, cost);
+
+  *pComp = comp;
+  return compLen;
+}
+
+// return the decompressed length, or -1 if the content is corrupted
+int32_t rpcDecompressCont(int8_t comp, const char *buf, int32_t bufLen, char *pCont, int32_t contLen) {
+  if (!rpcIsValidCodec(comp)) return -1;
+
+  return (*tsRpcCodecs[comp].decompFp)(buf, bufLen, pCont, contLen);
+}
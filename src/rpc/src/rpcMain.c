@@ -19,7 +19,6 @@
 #include "tmempool.h"
 #include "ttimer.h"
 #include "tutil.h"
-#include "lz4.h"
 #include "tref.h"
 #include "taoserror.h"
 #include "tsocket.h"
@@ -32,6 +31,7 @@
 #include "rpcCache.h"
 #include "rpcTcp.h"
 #include "rpcHead.h"
+#include "rpcComp.h"
 
 #define RPC_MSG_OVERHEAD (sizeof(SRpcReqContext) + sizeof(SRpcHead) + sizeof(SRpcDigest)) 
 #define rpcHeadFromCont(cont) ((SRpcHead *) ((char*)cont - sizeof(SRpcHead)))
@@ -110,6 +110,7 @@ typedef struct SRpcConn {
   uint16_t  inTranId;       // transcation ID for incoming msg
   uint8_t   outType;        // message type for outgoing request
   uint8_t   inType;         // message type for incoming request  
+  uint8_t   peerCodecs;     // compression codecs other than lz4 the peer decodes
   void     *chandle;  // handle passed by TCP/UDP connection layer
   void     *ahandle;  // handle provided by upper app layter
   int       retry;    // number of retry for sending request
@@ -206,7 +207,8 @@ static void  rpcProcessIdleTimer(void *param, void *tmrId);
 static void  rpcProcessProgressTimer(void *param, void *tmrId);
 
 static void  rpcFreeMsg(void *msg);
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen);
+static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen, uint8_t msgType, uint8_t peerCodecs);
+static int32_t rpcRecompressRpcMsg(char* pCont, int32_t contLen, uint8_t msgType, uint8_t peerCodecs);
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead);
 static int   rpcAddAuthPart(SRpcConn *pConn, char *msg, int msgLen);
 static int   rpcCheckAuthentication(SRpcConn *pConn, char *msg, int msgLen);
@@ -388,7 +390,8 @@ void rpcSendRequest(void *shandle, const SRpcEpSet *pEpSet, SRpcMsg *pMsg, int64
   SRpcInfo       *pRpc = (SRpcInfo *)shandle;
   SRpcReqContext *pContext;
 
-  int contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
+  // the message is compressed once the connection tells the codecs the server decodes
+  int contLen = pMsg->contLen;
   pContext = (SRpcReqContext *) ((char*)pMsg->pCont-sizeof(SRpcHead)-sizeof(SRpcReqContext));
   pContext->ahandle = pMsg->ahandle;
   pContext->pRpc = (SRpcInfo *)shandle;
@@ -400,7 +403,7 @@ void rpcSendRequest(void *shandle, const SRpcEpSet *pEpSet, SRpcMsg *pMsg, int64
 
   pContext->connType = RPC_CONN_UDPC; 
 
-  if (contLen > tsRpcMaxUdpSize || tsRpcForceTcp) pContext->connType = RPC_CONN_TCPC;
+  if (contLen > tsRpcMaxUdpSize || tsRpcForceTcp || tsRpcMuxConns > 0) pContext->connType = RPC_CONN_TCPC;
 
   // connection type is application specific. 
   // for TDengine, all the query, show commands shall have TCP connection
@@ -432,7 +435,7 @@ void rpcSendResponse(const SRpcMsg *pRsp) {
   SRpcHead  *pHead = rpcHeadFromCont(pMsg->pCont);
   char      *msg = (char *)pHead;
 
-  pMsg->contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
+  pMsg->contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen, pConn->inType + 1, pConn->peerCodecs);
   msgLen = rpcMsgLenFromCont(pMsg->contLen);
 
   rpcLockConn(pConn);
@@ -660,6 +663,7 @@ static void rpcReleaseConn(SRpcConn *pConn) {
   pConn->peerId = 0;
   pConn->peerIp = 0;
   pConn->peerPort = 0;
+  pConn->peerCodecs = 0;
   pConn->pReqMsg = NULL;
   pConn->reqMsgLen = 0;
   pConn->pContext = NULL;
@@ -968,6 +972,11 @@ static SRpcConn *rpcProcessMsgHead(SRpcInfo *pRpc, SRecvInfo *pRecv, SRpcReqCont
     terrno = TSDB_CODE_RPC_INVALID_VERSION; return NULL;
   }
 
+  if (pHead->comp != RPC_COMP_NONE && !rpcIsValidCodec(pHead->comp)) {
+    tDebug("%s sid:%d, unsupported compression codec:%d %s", pRpc->label, sid, pHead->comp, taosMsg[pHead->msgType]);
+    terrno = TSDB_CODE_RPC_INVALID_VALUE; return NULL;
+  }
+
   pConn = rpcGetConnObj(pRpc, sid, pRecv);
   if (pConn == NULL) {
     tDebug("%s %p, failed to get connection obj(%s)", pRpc->label, (void *)pHead->ahandle, tstrerror(terrno)); 
@@ -986,6 +995,7 @@ static SRpcConn *rpcProcessMsgHead(SRpcInfo *pRpc, SRecvInfo *pRecv, SRpcReqCont
   pConn->peerIp = pRecv->ip; 
   pConn->peerPort = pRecv->port;
   if (pHead->port) pConn->peerPort = htons(pHead->port); 
+  pConn->peerCodecs = pHead->codecs;
 
   terrno = rpcCheckAuthentication(pConn, (char *)pHead, pRecv->msgLen);
 
@@ -1049,13 +1059,10 @@ static void rpcReportBrokenLinkToServer(SRpcConn *pConn) {
   }
 }
 
-static void rpcProcessBrokenLink(SRpcConn *pConn) {
-  if (pConn == NULL) return;
+static void rpcDoProcessBrokenLink(SRpcConn *pConn) {
   SRpcInfo *pRpc = pConn->pRpc;
   tDebug("%s, link is broken", pConn->info);
 
-  rpcLockConn(pConn);
-
   if (pConn->outType) {
     SRpcReqContext *pContext = pConn->pContext;
     pContext->code = TSDB_CODE_RPC_NETWORK_UNAVAIL;
@@ -1067,9 +1074,32 @@ static void rpcProcessBrokenLink(SRpcConn *pConn) {
   if (pConn->inType) rpcReportBrokenLinkToServer(pConn); 
 
   rpcReleaseConn(pConn);
+}
+
+static void rpcProcessBrokenLink(SRpcConn *pConn) {
+  if (pConn == NULL) return;
+
+  rpcLockConn(pConn);
+  rpcDoProcessBrokenLink(pConn);
   rpcUnlockConn(pConn);
 }
 
+// a multiplexed TCP connection is shared by many rpc connections, all of them are broken together
+static void rpcProcessBrokenChannel(SRpcInfo *pRpc, void *chandle) {
+  if (chandle == NULL) return;
+
+  for (int i = 1; i < pRpc->sessions; ++i) {
+    SRpcConn *pConn = pRpc->connList + i;
+    if (pConn->chandle != chandle) continue;
+
+    rpcLockConn(pConn);
+    if (pConn->user[0] && pConn->chandle == chandle) {
+      rpcDoProcessBrokenLink(pConn);
+    }
+    rpcUnlockConn(pConn);
+  }
+}
+
 static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
   SRpcHead  *pHead = (SRpcHead *)pRecv->msg;
   SRpcInfo  *pRpc = (SRpcInfo *)pRecv->shandle;
@@ -1082,6 +1112,7 @@ static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
 
   if (pRecv->msg == NULL) {
     rpcProcessBrokenLink(pConn);
+    rpcProcessBrokenChannel(pRpc, pRecv->chandle);
     return NULL;
   }
 
@@ -1286,7 +1317,6 @@ static void rpcSendErrorMsgToPeer(SRecvInfo *pRecv, int32_t code) {
 static void rpcSendReqToServer(SRpcInfo *pRpc, SRpcReqContext *pContext) {
   SRpcHead  *pHead = rpcHeadFromCont(pContext->pCont);
   char      *msg = (char *)pHead;
-  int        msgLen = rpcMsgLenFromCont(pContext->contLen);
   char       msgType = pContext->msgType;
 
   pContext->numOfTry++;
@@ -1297,6 +1327,22 @@ static void rpcSendReqToServer(SRpcInfo *pRpc, SRpcReqContext *pContext) {
     return;
   }
 
+  // a new connection knows no codec of the server but lz4, a message redirected to another server may be recompressed
+  int32_t contLen;
+  if (pHead->comp) {
+    contLen = rpcRecompressRpcMsg((char *)pContext->pCont, pContext->contLen, (uint8_t)msgType, pConn->peerCodecs);
+  } else {
+    contLen = rpcCompressRpcMsg((char *)pContext->pCont, pContext->contLen, (uint8_t)msgType, pConn->peerCodecs);
+  }
+  if (contLen < 0) {
+    rpcCloseConn(pConn);
+    pContext->code = TSDB_CODE_RPC_APP_ERROR;
+    taosTmrStart(rpcProcessConnError, 1, pContext, pRpc->tmrCtrl);
+    return;
+  }
+  pContext->contLen = contLen;
+  int msgLen = rpcMsgLenFromCont(pContext->contLen);
+
   pContext->pConn = pConn;
   pConn->ahandle = pContext->ahandle;
   rpcLockConn(pConn);
@@ -1334,6 +1380,9 @@ static void rpcSendMsgToPeer(SRpcConn *pConn, void *msg, int msgLen) {
   int        writtenLen = 0;
   SRpcHead  *pHead = (SRpcHead *)msg;
 
+  // let the server know the TCP connection is shared, it shall not be closed along with an rpc connection
+  pHead->resflag = (pConn->connType == RPC_CONN_TCPC && tsRpcMuxConns > 0)? RPC_FLAG_MUX:0;
+  pHead->codecs = RPC_COMP_DECODABLE;
   msgLen = rpcAddAuthPart(pConn, msg, msgLen);
 
   if ( rpcIsReq(pHead->msgType)) {
@@ -1450,36 +1499,35 @@ static void rpcProcessProgressTimer(void *param, void *tmrId) {
   rpcUnlockConn(pConn);
 }
 
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
+static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen, uint8_t msgType, uint8_t peerCodecs) {
   SRpcHead  *pHead = rpcHeadFromCont(pCont);
   int32_t    finalLen = 0;
   int        overhead = sizeof(SRpcComp);
+  int8_t     comp = RPC_COMP_NONE;
   
   if (!NEEDTO_COMPRESSS_MSG(contLen)) {
     return contLen;
   }
   
-  char *buf = malloc (contLen + overhead + 8);  // 8 extra bytes
+  char *buf = malloc (contLen + 8);  // 8 extra bytes
   if (buf == NULL) {
     tError("failed to allocate memory for rpc msg compression, contLen:%d", contLen);
     return contLen;
   }
   
-  int32_t compLen = LZ4_compress_default(pCont, buf, contLen, contLen + overhead);
-  tDebug("compress rpc msg, before:%d, after:%d, overhead:%d", contLen, compLen, overhead);
-  
   /*
    * only the compressed size is less than the value of contLen - overhead, the compression is applied
    * The first four bytes is set to 0, the second four bytes are utilized to keep the original length of message
    */
-  if (compLen > 0 && compLen < contLen - overhead) {
+  int32_t compLen = rpcCompressCont(msgType, peerCodecs, pCont, contLen, buf, contLen - overhead - 1, &comp);
+  if (compLen > 0) {
     SRpcComp *pComp = (SRpcComp *)pCont;
     pComp->reserved = 0; 
     pComp->contLen = htonl(contLen); 
     memcpy(pCont + overhead, buf, compLen);
     
-    pHead->comp = 1;
-    tDebug("compress rpc msg, before:%d, after:%d", contLen, compLen);
+    pHead->comp = comp;
+    tDebug("compress rpc msg, codec:%d before:%d, after:%d", comp, contLen, compLen);
     finalLen = compLen + overhead;
   } else {
     finalLen = contLen;
@@ -1489,6 +1537,35 @@ static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
   return finalLen;
 }
 
+/*
+ * compress the message again by a codec the peer decodes, the buffer of the content holds the original content as the
+ * message is compressed in place. Return the new content length, or -1 if out of memory
+ */
+static int32_t rpcRecompressRpcMsg(char* pCont, int32_t contLen, uint8_t msgType, uint8_t peerCodecs) {
+  SRpcHead  *pHead = rpcHeadFromCont(pCont);
+  SRpcComp  *pComp = (SRpcComp *)pCont;
+  int        overhead = sizeof(SRpcComp);
+
+  if (rpcIsPeerCodec(pHead->comp, peerCodecs)) return contLen;
+
+  int32_t origLen = htonl(pComp->contLen);
+  char   *buf = malloc(origLen);
+  if (buf == NULL) {
+    tError("failed to allocate memory for rpc msg recompression, contLen:%d", origLen);
+    return -1;
+  }
+
+  int32_t len = rpcDecompressCont(pHead->comp, pCont + overhead, contLen - overhead, buf, origLen);
+  assert(len == origLen);
+
+  memcpy(pCont, buf, origLen);
+  free(buf);
+  pHead->comp = RPC_COMP_NONE;
+  tDebug("recompress rpc msg for the peer, codecs:0x%x contLen:%d", peerCodecs, origLen);
+
+  return rpcCompressRpcMsg(pCont, origLen, msgType, peerCodecs);
+}
+
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
   int overhead = sizeof(SRpcComp);
   SRpcHead   *pNewHead = NULL;  
@@ -1502,14 +1579,15 @@ static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
   
     // prepare the temporary buffer to decompress message
     char *temp = (char *)malloc(contLen + RPC_MSG_OVERHEAD);
-    pNewHead = (SRpcHead *)(temp + sizeof(SRpcReqContext)); // reserve SRpcReqContext
   
-    if (pNewHead) {
+    if (temp) {
+      pNewHead = (SRpcHead *)(temp + sizeof(SRpcReqContext)); // reserve SRpcReqContext
       int compLen = rpcContLenFromMsg(pHead->msgLen) - overhead;
-      int origLen = LZ4_decompress_safe((char*)(pCont + overhead), (char *)pNewHead->content, compLen, contLen);
+      int origLen = rpcDecompressCont(pHead->comp, (char*)(pCont + overhead), compLen, (char *)pNewHead->content, contLen);
       assert(origLen == contLen);
     
       memcpy(pNewHead, pHead, sizeof(SRpcHead));
+      pNewHead->comp = RPC_COMP_NONE;
       pNewHead->msgLen = rpcMsgLenFromCont(origLen);
       rpcFreeMsg(pHead); // free the compressed message buffer
       pHead = pNewHead; 
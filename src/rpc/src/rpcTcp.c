@@ -18,10 +18,20 @@
 #include "tutil.h"
 #include "taosdef.h"
 #include "taoserror.h"
+#include "tglobal.h"
+#include "hash.h"
 #include "rpcLog.h"
 #include "rpcHead.h"
 #include "rpcTcp.h"
 
+#define TCP_SEND_BATCH_SIZE 64
+
+typedef struct SSendMsg {
+  struct SSendMsg *next;
+  int32_t          len;
+  char             data[];
+} SSendMsg;
+
 typedef struct SFdObj {
   void              *signature;
   SOCKET             fd;          // TCP socket FD
@@ -29,6 +39,12 @@ typedef struct SFdObj {
   uint32_t           ip;
   uint16_t           port;
   int16_t            closedByApp; // 1: already closed by App
+  int8_t             mux;         // 1: shared by all rpc connections to the end point
+  int8_t             sending;     // 1: a thread is writing, messages from other threads are queued
+  SSendMsg          *pSendHead;   // messages queued while a thread is writing
+  SSendMsg          *pSendTail;
+  pthread_mutex_t    sendMutex;
+  pthread_cond_t     sendCond;
   struct SThreadObj *pThreadObj;
   struct SFdObj     *prev;
   struct SFdObj     *next;
@@ -45,14 +61,26 @@ typedef struct SThreadObj {
   int             threadId;
   char            label[TSDB_LABEL_LEN];
   void           *shandle;  // handle passed by upper layer during server initialization
+  struct SClientObj *pClientObj;  // for TCP client only
   void           *(*processData)(SRecvInfo *pPacket);
 } SThreadObj;
 
+// the multiplexed connections to an end point
 typedef struct {
+  uint32_t ip;
+  uint16_t port;
+  int32_t  index;
+  SFdObj  *pFdObj[];
+} STcpEp;
+
+typedef struct SClientObj {
   char    label[TSDB_LABEL_LEN];
   int32_t index;
   int numOfThreads;
   SThreadObj **pThreadObj;
+  int32_t         numOfMuxConns;  // number of connections to each end point, 0: one connection per rpc connection
+  SHashObj       *pEps;           // ip:port -> STcpEp
+  pthread_mutex_t mutex;
 } SClientObj;
 
 typedef struct {
@@ -73,6 +101,9 @@ static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, SOCKET fd);
 static void    taosFreeFdObj(SFdObj *pFdObj);
 static void    taosReportBrokenLink(SFdObj *pFdObj);
 static void   *taosAcceptTcpConnection(void *arg);
+static SFdObj *taosOpenTcpMuxConnection(SClientObj *pClientObj, uint32_t ip, uint16_t port);
+static void    taosDetachTcpMuxConnection(SFdObj *pFdObj);
+static int     taosSendTcpMuxData(SFdObj *pFdObj, void *data, int len);
 
 void *taosInitTcpServer(uint32_t ip, uint16_t port, char *label, int numOfThreads, void *fp, void *shandle) {
   SServerObj *pServerObj;
@@ -312,6 +343,21 @@ void *taosInitTcpClient(uint32_t ip, uint16_t port, char *label, int numOfThread
     tError("TCP:%s no enough memory", label);
     tfree(pClientObj);
     terrno = TAOS_SYSTEM_ERROR(errno);
+    return NULL;
+  }
+
+  pClientObj->numOfMuxConns = tsRpcMuxConns;
+  pthread_mutex_init(&pClientObj->mutex, NULL);
+  if (pClientObj->numOfMuxConns > 0) {
+    pClientObj->pEps = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_UBIGINT), true, HASH_NO_LOCK);
+    if (pClientObj->pEps == NULL) {
+      tError("TCP:%s no enough memory", label);
+      pthread_mutex_destroy(&pClientObj->mutex);
+      tfree(pClientObj->pThreadObj);
+      tfree(pClientObj);
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      return NULL;
+    }
   }
 
   int code = 0;
@@ -335,6 +381,7 @@ void *taosInitTcpClient(uint32_t ip, uint16_t port, char *label, int numOfThread
     pThreadObj->stop    = false;
     tstrncpy(pThreadObj->label, label, sizeof(pThreadObj->label));
     pThreadObj->shandle = shandle;
+    pThreadObj->pClientObj = pClientObj;
     pThreadObj->processData = fp;
   }
 
@@ -365,7 +412,11 @@ void *taosInitTcpClient(uint32_t ip, uint16_t port, char *label, int numOfThread
     terrno = TAOS_SYSTEM_ERROR(errno);
     taosCleanUpTcpClient(pClientObj);
     pClientObj = NULL;
+  } else if (pClientObj->numOfMuxConns > 0) {
+    tDebug("%s TCP client is initialized, connections per end point:%d", label, pClientObj->numOfMuxConns);
   }
+
+  pthread_attr_destroy(&thattr);
   return pClientObj;
 }
 
@@ -385,6 +436,20 @@ void taosCleanUpTcpClient(void *chandle) {
     taosStopTcpThread(pThreadObj);
   }
 
+  // the multiplexed connections are already freed by the threads
+  if (pClientObj->pEps != NULL) {
+    void *pIter = taosHashIterate(pClientObj->pEps, NULL);
+    while (pIter) {
+      STcpEp *pEp = *(STcpEp **)pIter;
+      free(pEp);
+      pIter = taosHashIterate(pClientObj->pEps, pIter);
+    }
+
+    taosHashCleanup(pClientObj->pEps);
+  }
+
+  pthread_mutex_destroy(&pClientObj->mutex);
+
   tDebug("%s TCP client is cleaned up", pClientObj->label);
   tfree(pClientObj->pThreadObj);
   tfree(pClientObj);
@@ -392,6 +457,10 @@ void taosCleanUpTcpClient(void *chandle) {
 
 void *taosOpenTcpClientConnection(void *shandle, void *thandle, uint32_t ip, uint16_t port) {
   SClientObj *    pClientObj = shandle;
+  if (pClientObj->numOfMuxConns > 0) {
+    return taosOpenTcpMuxConnection(pClientObj, ip, port);
+  }
+
   int32_t index = atomic_load_32(&pClientObj->index) % pClientObj->numOfThreads;
     atomic_store_32(&pClientObj->index, index + 1);
   SThreadObj *pThreadObj = pClientObj->pThreadObj[index];
@@ -432,6 +501,12 @@ void taosCloseTcpConnection(void *chandle) {
   if (pFdObj == NULL || pFdObj->signature != pFdObj) return;
 
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
+
+  // the multiplexed connection is kept for other rpc connections, it is closed only if it is broken
+  if (pFdObj->mux) {
+    return;
+  }
+
   tDebug("%s %p TCP connection will be closed, FD:%p", pThreadObj->label, pFdObj->thandle, pFdObj);
 
   // pFdObj->thandle = NULL;
@@ -444,6 +519,10 @@ int taosSendTcpData(uint32_t ip, uint16_t port, void *data, int len, void *chand
   if (pFdObj == NULL || pFdObj->signature != pFdObj) return -1;
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
 
+  if (pFdObj->mux) {
+    return taosSendTcpMuxData(pFdObj, data, len);
+  }
+
   int ret = taosWriteMsg(pFdObj->fd, data, len);
   tTrace("%s %p TCP data is sent, FD:%p fd:%d bytes:%d", pThreadObj->label, pFdObj->thandle, pFdObj, pFdObj->fd, ret);
 
@@ -454,18 +533,24 @@ static void taosReportBrokenLink(SFdObj *pFdObj) {
 
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
 
+  // no more rpc connections can pick up the broken connection
+  if (pFdObj->mux) {
+    taosDetachTcpMuxConnection(pFdObj);
+  }
+
   // notify the upper layer, so it will clean the associated context
   if (pFdObj->closedByApp == 0) {
     shutdown(pFdObj->fd, SHUT_WR);
 
+    // all the rpc connections sharing a multiplexed connection are identified by the chandle
     SRecvInfo recvInfo;
     recvInfo.msg = NULL;
     recvInfo.msgLen = 0;
     recvInfo.ip = 0;
     recvInfo.port = 0;
     recvInfo.shandle = pThreadObj->shandle;
-    recvInfo.thandle = pFdObj->thandle;
-    recvInfo.chandle = NULL;
+    recvInfo.thandle = pFdObj->mux? NULL:pFdObj->thandle;
+    recvInfo.chandle = pFdObj->mux? pFdObj:NULL;
     recvInfo.connType = RPC_CONN_TCP;
     (*(pThreadObj->processData))(&recvInfo);
   }
@@ -509,6 +594,13 @@ static int taosReadTcpData(SFdObj *pFdObj, SRecvInfo *pInfo) {
 
   memcpy(msg, &rpcHead, sizeof(SRpcHead));
 
+  // the client shares the connection among rpc connections, responses shall be sent in the same way
+  if (rpcHead.resflag == RPC_FLAG_MUX && pFdObj->mux == 0) {
+    tDebug("%s FD:%p fd:%d TCP connection is multiplexed by the client", pThreadObj->label, pFdObj, pFdObj->fd);
+    pFdObj->mux = 1;
+    pFdObj->thandle = NULL;
+  }
+
   pInfo->msg = msg;
   pInfo->msgLen = msgLen;
   pInfo->ip = pFdObj->ip;
@@ -572,7 +664,11 @@ static void *taosProcessTcpData(void *param) {
         continue;
       }
 
-      pFdObj->thandle = (*(pThreadObj->processData))(&recvInfo);
+      // a multiplexed connection is not bound to any rpc connection, and it is not closed for a bad message
+      void *thandle = (*(pThreadObj->processData))(&recvInfo);
+      if (pFdObj->mux) continue;
+
+      pFdObj->thandle = thandle;
       if (pFdObj->thandle == NULL) taosFreeFdObj(pFdObj);
     }
 
@@ -609,10 +705,14 @@ static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, SOCKET fd) {
   pFdObj->fd = fd;
   pFdObj->pThreadObj = pThreadObj;
   pFdObj->signature = pFdObj;
+  pthread_mutex_init(&pFdObj->sendMutex, NULL);
+  pthread_cond_init(&pFdObj->sendCond, NULL);
 
   event.events = EPOLLIN | EPOLLRDHUP;
   event.data.ptr = pFdObj;
   if (epoll_ctl(pThreadObj->pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    pthread_mutex_destroy(&pFdObj->sendMutex);
+    pthread_cond_destroy(&pFdObj->sendCond);
     tfree(pFdObj);
     terrno = TAOS_SYSTEM_ERROR(errno);
     return NULL;
@@ -666,5 +766,196 @@ static void taosFreeFdObj(SFdObj *pFdObj) {
   tDebug("%s %p TCP connection is closed, FD:%p fd:%d numOfFds:%d",
           pThreadObj->label, pFdObj->thandle, pFdObj, pFdObj->fd, pThreadObj->numOfFds);
 
+  // wait for the writing thread to quit, and drop the messages not sent yet
+  pthread_mutex_lock(&pFdObj->sendMutex);
+  while (pFdObj->sending) {
+    pthread_cond_wait(&pFdObj->sendCond, &pFdObj->sendMutex);
+  }
+
+  while (pFdObj->pSendHead) {
+    SSendMsg *pMsg = pFdObj->pSendHead;
+    pFdObj->pSendHead = pMsg->next;
+    free(pMsg);
+  }
+  pthread_mutex_unlock(&pFdObj->sendMutex);
+
+  pthread_mutex_destroy(&pFdObj->sendMutex);
+  pthread_cond_destroy(&pFdObj->sendCond);
+
   tfree(pFdObj);
 }
+
+static SFdObj *taosOpenTcpMuxConnection(SClientObj *pClientObj, uint32_t ip, uint16_t port) {
+  uint64_t key = ((uint64_t)ip << 16) | port;
+  SFdObj  *pFdObj = NULL;
+
+  pthread_mutex_lock(&pClientObj->mutex);
+
+  STcpEp *pEp = NULL;
+  STcpEp **ppEp = taosHashGet(pClientObj->pEps, &key, sizeof(key));
+  if (ppEp != NULL) {
+    pEp = *ppEp;
+  } else {
+    pEp = calloc(1, sizeof(STcpEp) + sizeof(SFdObj *) * pClientObj->numOfMuxConns);
+    if (pEp == NULL || taosHashPut(pClientObj->pEps, &key, sizeof(key), &pEp, POINTER_BYTES) != 0) {
+      tError("%s failed to malloc TCP end point for 0x%x:%hu", pClientObj->label, ip, port);
+      pthread_mutex_unlock(&pClientObj->mutex);
+      tfree(pEp);
+      return NULL;
+    }
+
+    pEp->ip = ip;
+    pEp->port = port;
+  }
+
+  // rpc connections are spread over the connections to the end point in round robin
+  int32_t slot = pEp->index;
+  pEp->index = (pEp->index + 1) % pClientObj->numOfMuxConns;
+
+  pFdObj = pEp->pFdObj[slot];
+  if (pFdObj == NULL) {
+    int32_t     index = atomic_fetch_add_32(&pClientObj->index, 1) % pClientObj->numOfThreads;
+    SThreadObj *pThreadObj = pClientObj->pThreadObj[index];
+
+    SOCKET fd = taosOpenTcpClientSocket(ip, port, pThreadObj->ip);
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+    if (fd != (SOCKET)-1) {
+#else
+    if (fd > 0) {
+#endif
+      pFdObj = taosMallocFdObj(pThreadObj, fd);
+      if (pFdObj != NULL) {
+        pFdObj->ip = ip;
+        pFdObj->port = port;
+        pFdObj->mux = 1;
+        pEp->pFdObj[slot] = pFdObj;
+        tDebug("%s multiplexed TCP connection to 0x%x:%hu is created, slot:%d FD:%p numOfFds:%d", pThreadObj->label, ip,
+               port, slot, pFdObj, pThreadObj->numOfFds);
+      } else {
+        tError("%s failed to malloc client FdObj(%s)", pThreadObj->label, strerror(errno));
+        taosCloseSocket(fd);
+      }
+    }
+  }
+
+  pthread_mutex_unlock(&pClientObj->mutex);
+  return pFdObj;
+}
+
+static void taosDetachTcpMuxConnection(SFdObj *pFdObj) {
+  SClientObj *pClientObj = pFdObj->pThreadObj->pClientObj;
+  if (pClientObj == NULL) {  // server side
+    return;
+  }
+
+  uint64_t key = ((uint64_t)pFdObj->ip << 16) | pFdObj->port;
+
+  pthread_mutex_lock(&pClientObj->mutex);
+
+  STcpEp **ppEp = taosHashGet(pClientObj->pEps, &key, sizeof(key));
+  if (ppEp != NULL) {
+    STcpEp *pEp = *ppEp;
+    for (int32_t i = 0; i < pClientObj->numOfMuxConns; ++i) {
+      if (pEp->pFdObj[i] == pFdObj) {
+        pEp->pFdObj[i] = NULL;
+      }
+    }
+  }
+
+  pthread_mutex_unlock(&pClientObj->mutex);
+}
+
+/*
+ * Messages of all rpc connections sharing the connection are written by one thread at a time. The other threads
+ * queue their messages and return at once, and the writing thread sends all the queued messages in a batch with
+ * one system call before it quits.
+ */
+static int taosSendTcpMuxData(SFdObj *pFdObj, void *data, int len) {
+  SThreadObj *pThreadObj = pFdObj->pThreadObj;
+
+  pthread_mutex_lock(&pFdObj->sendMutex);
+
+  if (pFdObj->sending) {
+    SSendMsg *pMsg = malloc(sizeof(SSendMsg) + len);
+    if (pMsg == NULL) {
+      pthread_mutex_unlock(&pFdObj->sendMutex);
+      tError("%s FD:%p failed to malloc send msg, len:%d", pThreadObj->label, pFdObj, len);
+      return -1;
+    }
+
+    pMsg->next = NULL;
+    pMsg->len = len;
+    memcpy(pMsg->data, data, len);
+
+    if (pFdObj->pSendTail) {
+      pFdObj->pSendTail->next = pMsg;
+    } else {
+      pFdObj->pSendHead = pMsg;
+    }
+    pFdObj->pSendTail = pMsg;
+
+    pthread_mutex_unlock(&pFdObj->sendMutex);
+    return len;
+  }
+
+  pFdObj->sending = 1;
+  pthread_mutex_unlock(&pFdObj->sendMutex);
+
+  int ret = taosWriteMsg(pFdObj->fd, data, len);
+  int code = (ret == len) ? 0 : -1;
+
+  pthread_mutex_lock(&pFdObj->sendMutex);
+  while (pFdObj->pSendHead != NULL) {
+    SSendMsg *pHead = pFdObj->pSendHead;
+    pFdObj->pSendHead = NULL;
+    pFdObj->pSendTail = NULL;
+    pthread_mutex_unlock(&pFdObj->sendMutex);
+
+    SSocketBuf bufs[TCP_SEND_BATCH_SIZE];
+    SSendMsg  *msgs[TCP_SEND_BATCH_SIZE];
+    int32_t    num = 0;
+    int32_t    bytes = 0;
+
+    while (pHead != NULL) {
+      msgs[num] = pHead;
+      bufs[num].buf = pHead->data;
+      bufs[num].len = pHead->len;
+      bytes += pHead->len;
+      num++;
+
+      pHead = pHead->next;
+      if (num < TCP_SEND_BATCH_SIZE && pHead != NULL) {
+        continue;
+      }
+
+      if (code == 0 && taosWriteMsgv(pFdObj->fd, bufs, num) != bytes) {
+        code = -1;
+      }
+
+      tTrace("%s FD:%p fd:%d %d queued msgs are sent in batch, bytes:%d", pThreadObj->label, pFdObj, pFdObj->fd, num,
+             bytes);
+
+      for (int32_t i = 0; i < num; ++i) {
+        free(msgs[i]);
+      }
+
+      num = 0;
+      bytes = 0;
+    }
+
+    pthread_mutex_lock(&pFdObj->sendMutex);
+  }
+
+  // once a message is not sent completely, the following messages can not be parsed by the peer
+  if (code != 0) {
+    tError("%s FD:%p fd:%d failed to send data, the connection is shut down, reason:%s", pThreadObj->label, pFdObj,
+           pFdObj->fd, strerror(errno));
+    shutdown(pFdObj->fd, SHUT_RDWR);
+  }
+
+  pFdObj->sending = 0;
+  pthread_cond_broadcast(&pFdObj->sendCond);
+  pthread_mutex_unlock(&pFdObj->sendMutex);
+
+  return ret;
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+
+#include "os.h"
+#include "tglobal.h"
+#include "taosmsg.h"
+#include "rpcComp.h"
+
+namespace {
+
+class RpcCompTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    algo = tsRpcCompressAlgo;
+    minSpeed = tsRpcCompressMinSpeed;
+    tsRpcCompressMinSpeed = 0;
+  }
+
+  void TearDown() override {
+    tsRpcCompressAlgo = algo;
+    tsRpcCompressMinSpeed = minSpeed;
+  }
+
+  // compress and decompress the content, return the codec used, or RPC_COMP_NONE if it is sent uncompressed
+  static int8_t roundTrip(uint8_t msgType, uint8_t peerCodecs, const std::vector<char>& cont) {
+    std::vector<char> buf(cont.size());
+    int8_t            comp = RPC_COMP_NONE;
+    int32_t compLen = rpcCompressCont(msgType, peerCodecs, &cont[0], (int32_t)cont.size(), &buf[0], (int32_t)buf.size(),
+                                      &comp);
+    if (compLen <= 0) return RPC_COMP_NONE;
+
+    std::vector<char> orig(cont.size());
+    EXPECT_EQ(rpcDecompressCont(comp, &buf[0], compLen, &orig[0], (int32_t)orig.size()), (int32_t)cont.size());
+    EXPECT_EQ(orig, cont);
+    return comp;
+  }
+
+  int32_t algo;
+  int32_t minSpeed;
+};
+
+// rows of a table, compressible but not trivially
+std::vector<char> createRows(int32_t numOfRows) {
+  std::vector<char> cont;
+  char              row[64];
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int len = snprintf(row, sizeof(row), "%d,sensor%d,%d.%d;", 1600000000 + i, i % 10, i % 37, i % 7);
+    cont.insert(cont.end(), row, row + len);
+  }
+  return cont;
+}
+
+std::vector<char> createRandom(int32_t len) {
+  std::vector<char> cont(len);
+  srand(11);
+  for (int32_t i = 0; i < len; ++i) cont[i] = (char)(rand() & 0xFF);
+  return cont;
+}
+
+}  // namespace
+
+TEST_F(RpcCompTest, codecRoundTrip) {
+  std::vector<char> cont = createRows(2000);
+
+  tsRpcCompressAlgo = RPC_COMP_LZ4;
+  EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_SUBMIT, RPC_COMP_DECODABLE, cont), RPC_COMP_LZ4);
+
+  tsRpcCompressAlgo = RPC_COMP_DEFLATE;
+  EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_SUBMIT, RPC_COMP_DECODABLE, cont), RPC_COMP_DEFLATE);
+
+  // content not fitting into the buffer when compressed is sent as is
+  std::vector<char> random = createRandom(4096);
+  EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_SUBMIT, RPC_COMP_DECODABLE, random), RPC_COMP_NONE);
+}
+
+TEST_F(RpcCompTest, oldPeerGetsLz4) {
+  std::vector<char> cont = createRows(2000);
+
+  // a peer not announcing deflate decodes lz4 only
+  tsRpcCompressAlgo = RPC_COMP_DEFLATE;
+  EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_SUBMIT, 0, cont), RPC_COMP_LZ4);
+
+  EXPECT_TRUE(rpcIsPeerCodec(RPC_COMP_NONE, 0));
+  EXPECT_TRUE(rpcIsPeerCodec(RPC_COMP_LZ4, 0));
+  EXPECT_FALSE(rpcIsPeerCodec(RPC_COMP_DEFLATE, 0));
+  EXPECT_TRUE(rpcIsPeerCodec(RPC_COMP_DEFLATE, RPC_COMP_DECODABLE));
+  EXPECT_FALSE(rpcIsPeerCodec(RPC_COMP_CODECS, 0xFF));
+}
+
+TEST_F(RpcCompTest, invalidCodec) {
+  std::vector<char> buf(64, 0), orig(64);
+  EXPECT_FALSE(rpcIsValidCodec(RPC_COMP_NONE));
+  EXPECT_FALSE(rpcIsValidCodec(RPC_COMP_CODECS));
+  EXPECT_EQ(rpcDecompressCont(RPC_COMP_CODECS, &buf[0], 64, &orig[0], 64), -1);
+
+  // corrupted content is reported rather than decoded
+  EXPECT_LT(rpcDecompressCont(RPC_COMP_DEFLATE, &buf[0], 64, &orig[0], 64), 0);
+}
+
+TEST_F(RpcCompTest, adaptiveChoice) {
+  tsRpcCompressAlgo = RPC_COMP_ADAPTIVE;
+
+  // both codecs are tried in turn while warming up, then the one of the better ratio is used
+  std::vector<char> rows = createRows(4000);
+  int32_t           numOfDeflate = 0;
+  for (int32_t i = 0; i < 8; ++i) {
+    if (roundTrip(TSDB_MSG_TYPE_CM_STABLE_VGROUP, RPC_COMP_DECODABLE, rows) == RPC_COMP_DEFLATE) numOfDeflate++;
+  }
+  EXPECT_EQ(numOfDeflate, 4);
+  for (int32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_CM_STABLE_VGROUP, RPC_COMP_DECODABLE, rows), RPC_COMP_DEFLATE);
+  }
+
+  // an old peer never gets deflate, even while warming up
+  for (int32_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_QUERY, 0, rows), RPC_COMP_LZ4);
+  }
+
+  // a message type not saving is sent uncompressed once warmed up
+  std::vector<char> random = createRandom(8192);
+  for (int32_t i = 0; i < 8; ++i) roundTrip(TSDB_MSG_TYPE_FETCH, RPC_COMP_DECODABLE, random);
+  for (int32_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_FETCH, RPC_COMP_DECODABLE, random), RPC_COMP_NONE);
+  }
+
+  // a slow codec is not chosen
+  tsRpcCompressMinSpeed = INT32_MAX;
+  for (int32_t i = 0; i < 10; ++i) {
+    int8_t comp = (i < 8 && i % 2) ? RPC_COMP_DEFLATE : RPC_COMP_LZ4;
+    EXPECT_EQ(roundTrip(TSDB_MSG_TYPE_CM_SHOW, RPC_COMP_DECODABLE, rows), comp);
+  }
+}
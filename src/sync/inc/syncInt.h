@@ -30,12 +30,12 @@ extern "C" {
 #define sTrace(...) { if (sDebugFlag & DEBUG_TRACE) { taosPrintLog("SYN ", sDebugFlag, __VA_ARGS__); }}
 
 #define SYNC_TCP_THREADS 2
-#define SYNC_MAX_NUM 2
 
 #define SYNC_MAX_SIZE (TSDB_MAX_WAL_SIZE + sizeof(SWalHead) + sizeof(SSyncHead) + 16)
 #define SYNC_RECV_BUFFER_SIZE (5*1024*1024)
 
 #define SYNC_MAX_FWDS 4096
+#define SYNC_MAX_FWD_WINDOW 64
 #define SYNC_FWD_TIMER 300
 #define SYNC_ROLE_TIMER 15000             // ms
 #define SYNC_CHECK_INTERVAL 1000          // ms
@@ -86,6 +86,16 @@ typedef struct SsyncPeer {
   SOCKET   peerFd;          // forward FD
   int32_t  numOfRetrieves;  // number of retrieves tried
   int32_t  fileChanged;     // a flag to indicate file is changed during retrieving process
+  int32_t  syncCaps;        // TAOS_SYNC_CAP_XXX of the master restoring this node
+  char *   fwdBuf;          // forwards coalesced into the next batch
+  int32_t  fwdBufSize;
+  int32_t  fwdLen;
+  int32_t  fwdLastOffset;   // offset of the last forward in fwdBuf
+  int64_t  fwdTime;         // time the first forward of the next batch is coalesced
+  uint64_t ackVersion;      // forwards up to this version are acknowledged by the peer
+  int32_t  fwdBatches;      // batches sent and not acknowledged yet
+  int32_t  fwdBatchFirst;
+  uint64_t fwdBatchVer[SYNC_MAX_FWD_WINDOW];  // last version of each batch in flight
   int32_t  refCount;
   int8_t   isArb;
   int64_t  rid;
@@ -106,6 +116,7 @@ typedef struct SSyncNode {
   SSyncPeer *  pMaster;
   SRecvBuffer *pRecv;
   SSyncFwds *  pSyncFwds;  // saved forward info if quorum >1
+  uint64_t     ackVersion; // forwards up to this version are acknowledged to the master
   void *       pFwdTimer;
   void *       pRoleTimer;
   void *       pTsdb;
@@ -117,13 +128,13 @@ typedef struct SSyncNode {
   FStartSyncFile    startSyncFileFp;
   FStopSyncFile     stopSyncFileFp;
   FGetVersion       getVersionFp;
+  FGetDataSize      getDataSizeFp;
   FSendFile         sendFileFp;
   FRecvFile         recvFileFp;
   pthread_mutex_t   mutex;
 } SSyncNode;
 
 // sync module global
-extern int32_t tsSyncNum;
 extern char    tsNodeFqdn[TSDB_FQDN_LEN];
 extern char *  syncStatus[];
 
@@ -136,6 +147,24 @@ uint32_t   syncResolvePeerFqdn(SSyncPeer *pPeer);
 SSyncPeer *syncAcquirePeer(int64_t rid);
 void       syncReleasePeer(SSyncPeer *pPeer);
 
+// forwards between the master and its slaves
+int32_t    syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force);
+void       syncFlushNodeFwds(SSyncNode *pNode);
+void       syncCheckFwdInfos(SSyncNode *pNode, int64_t time);
+void       syncConfirmNodeForward(SSyncNode *pNode, uint64_t version, int32_t code, bool force);
+void       syncProcessForwardFromPeer(char *cont, SSyncPeer *pPeer);
+void       syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer);
+
+// recovery scheduler of the vnodes on this dnode
+int32_t    syncInitRecovery();
+void       syncCleanUpRecovery();
+void       syncRemoveExpiredRecoveries(int64_t now);
+bool       syncAcquireRecovery(int32_t vgId, uint64_t ver, uint64_t mver, int64_t size);
+void       syncUpdateRecovery(int32_t vgId, int8_t state, uint64_t ver);
+void       syncReleaseRecovery(int32_t vgId);
+void       syncGetRecoveryState(int32_t vgId, SSyncRecoveryInfo *pInfo);
+uint16_t   syncGetRecoveryRate(int32_t rate);
+
 #ifdef __cplusplus
 }
 #endif
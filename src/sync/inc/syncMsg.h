@@ -78,7 +78,8 @@ typedef struct {
   int8_t    sync;
   int8_t    reserved;
   uint16_t  tranId;
-  int8_t    reserverd[4];
+  uint16_t  fileRate;  // MB/s the master may stream files at, 0 for no limit
+  uint16_t  walRate;   // MB/s the master may stream wal at, 0 for no limit
 } SSyncRsp;
 
 typedef struct {
@@ -118,12 +119,20 @@ typedef struct {
 #define SYNC_PROTOCOL_VERSION 1
 #define SYNC_SIGNATURE ((uint16_t)(0xCDEF))
 
+// code in the head of a forward which is followed by more forwards of the same batch, the slave acknowledges
+// a batch once with the version of its last forward
+#define SYNC_FWD_MORE 1
+
+// code in the head of a sync-data msg, the TAOS_SYNC_CAP_XXX of the master, which is 0 from an old master
+#define SYNC_DATA_CAPS TAOS_SYNC_CAP_FILE_DIFF
+
 extern char *statusType[];
 
 uint16_t syncGenTranId();
 int32_t  syncCheckHead(SSyncHead *pHead);
 
 void syncBuildSyncFwdMsg(SSyncHead *pHead, int32_t vgId, int32_t len);
+void syncSetFwdMore(SSyncHead *pHead);
 void syncBuildSyncFwdRsp(SFwdRsp *pMsg, int32_t vgId, uint64_t version, int32_t code);
 void syncBuildSyncReqMsg(SSyncMsg *pMsg, int32_t vgId);
 void syncBuildSyncDataMsg(SSyncMsg *pMsg, int32_t vgId);
@@ -29,7 +29,6 @@
 #include "syncTcp.h"
 #include "syncInt.h"
 
-int32_t tsSyncNum = 0;  // number of sync in process in whole system
 char    tsNodeFqdn[TSDB_FQDN_LEN] = {0};
 
 static void *  tsTcpPool = NULL;
@@ -55,8 +54,9 @@ static void    syncMonitorFwdInfos(void *param, void *tmrId);
 static void    syncMonitorNodeRole(void *param, void *tmrId);
 static void    syncProcessFwdAck(SSyncNode *pNode, SFwdInfo *pFwdInfo, int32_t code);
 static int32_t syncSaveFwdInfo(SSyncNode *pNode, uint64_t version, void *mhandle);
+static void    syncResetPeerFwds(SSyncPeer *pPeer);
+static void    syncSendPeerFwds(SSyncPeer *pPeer, bool force);
 static void    syncRestartPeer(SSyncPeer *pPeer);
-static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force);
 
 static SSyncPeer *syncAddPeer(SSyncNode *pNode, const SNodeInfo *pInfo);
 static void       syncStartCheckPeerConn(SSyncPeer *pPeer);
@@ -126,6 +126,12 @@ int32_t syncInit() {
     return -1;
   }
 
+  if (syncInitRecovery() < 0) {
+    sError("failed to init recovery scheduler");
+    syncCleanUp();
+    return -1;
+  }
+
   tstrncpy(tsNodeFqdn, tsLocalFqdn, sizeof(tsNodeFqdn));
   sInfo("sync module initialized successfully");
 
@@ -158,6 +164,8 @@ void syncCleanUp() {
     tsPeerRefId = -1;
   }
 
+  syncCleanUpRecovery();
+
   sInfo("sync module is cleaned up");
 }
 
@@ -182,6 +190,7 @@ int64_t syncStart(const SSyncInfo *pInfo) {
   pNode->startSyncFileFp = pInfo->startSyncFileFp;
   pNode->stopSyncFileFp = pInfo->stopSyncFileFp;
   pNode->getVersionFp = pInfo->getVersionFp;
+  pNode->getDataSizeFp = pInfo->getDataSizeFp;
   pNode->sendFileFp = pInfo->sendFileFp;
   pNode->recvFileFp = pInfo->recvFileFp;
 
@@ -277,6 +286,9 @@ void syncStop(int64_t rid) {
   if (pNode->pFwdTimer) taosTmrStop(pNode->pFwdTimer);
   if (pNode->pRoleTimer) taosTmrStop(pNode->pRoleTimer);
 
+  // a running restore releases its slot when it is over, the status is checked before the self peer is removed
+  if (nodeSStatus == TAOS_SYNC_STATUS_INIT) syncReleaseRecovery(pNode->vgId);
+
   for (int32_t index = 0; index < pNode->replica; ++index) {
     pPeer = pNode->peerInfo[index];
     if (pPeer) syncRemovePeer(pPeer);
@@ -389,24 +401,54 @@ int32_t syncForwardToPeer(int64_t rid, void *data, void *mhandle, int32_t qtype,
   return code;
 }
 
+void syncFlushForward(int64_t rid) {
+  if (rid <= 0) return;
+
+  SSyncNode *pNode = syncAcquireNode(rid);
+  if (pNode == NULL) return;
+
+  syncFlushNodeFwds(pNode);
+
+  syncReleaseNode(pNode);
+}
+
+void syncFlushNodeFwds(SSyncNode *pNode) {
+  if (pNode->replica <= 1) return;
+
+  pthread_mutex_lock(&pNode->mutex);
+  for (int32_t i = 0; i < pNode->replica; ++i) {
+    SSyncPeer *pPeer = pNode->peerInfo[i];
+    if (pPeer != NULL) syncSendPeerFwds(pPeer, false);
+  }
+  pthread_mutex_unlock(&pNode->mutex);
+}
+
 void syncConfirmForward(int64_t rid, uint64_t _version, int32_t code, bool force) {
   SSyncNode *pNode = syncAcquireNode(rid);
   if (pNode == NULL) return;
 
+  syncConfirmNodeForward(pNode, _version, code, force);
+
+  syncReleaseNode(pNode);
+}
+
+void syncConfirmNodeForward(SSyncNode *pNode, uint64_t _version, int32_t code, bool force) {
   SSyncPeer *pPeer = pNode->pMaster;
-  if (pPeer && (pNode->quorum > 1 || force)) {
+  if (code == 0 && _version <= atomic_load_64(&pNode->ackVersion)) {
+    // a forward-rsp is cumulative, a later one was sent already
+    sTrace("vgId:%d, forward-rsp is covered, hver:%" PRIu64, pNode->vgId, _version);
+  } else if (pPeer && (pNode->quorum > 1 || force)) {
     SFwdRsp rsp;
     syncBuildSyncFwdRsp(&rsp, pNode->vgId, _version, code);
 
     if (taosWriteMsg(pPeer->peerFd, &rsp, sizeof(SFwdRsp)) == sizeof(SFwdRsp)) {
       sTrace("%s, forward-rsp is sent, code:0x%x hver:%" PRIu64, pPeer->id, code, _version);
+      if (code == 0 && _version > atomic_load_64(&pNode->ackVersion)) atomic_store_64(&pNode->ackVersion, _version);
     } else {
       sDebug("%s, failed to send forward-rsp, restart", pPeer->id);
       syncRestartConnection(pPeer);
     }
   }
-
-  syncReleaseNode(pNode);
 }
 
 void syncRecover(int64_t rid) {
@@ -450,6 +492,16 @@ int32_t syncGetNodesRole(int64_t rid, SNodesRole *pNodesRole) {
   return 0;
 }
 
+int32_t syncGetRecoveryInfo(int64_t rid, SSyncRecoveryInfo *pInfo) {
+  SSyncNode *pNode = syncAcquireNode(rid);
+  if (pNode == NULL) return -1;
+
+  syncGetRecoveryState(pNode->vgId, pInfo);
+
+  syncReleaseNode(pNode);
+  return 0;
+}
+
 static void syncAddArbitrator(SSyncNode *pNode) {
   SSyncPeer *pPeer = pNode->peerInfo[TAOS_SYNC_MAX_REPLICA];
 
@@ -519,6 +571,7 @@ static void syncFreePeer(void *param) {
   sDebug("%s, peer is freed, refCount:%d", pPeer->id, pPeer->refCount);
 
   syncReleaseNode(pPeer->pSyncNode);
+  tfree(pPeer->fwdBuf);
   tfree(pPeer);
 }
 
@@ -805,6 +858,7 @@ static void syncCheckRole(SSyncPeer *pPeer, SPeerStatus* peersStatus, int8_t new
 
   if (pMaster) {
     // master is there
+    if (pNode->pMaster != pMaster) atomic_store_64(&pNode->ackVersion, 0);
     pNode->pMaster = pMaster;
     sDebug("%s, it is the master, replica:%d sver:%" PRIu64, pMaster->id, pNode->replica, pMaster->version);
 
@@ -934,6 +988,7 @@ static void syncNotStarted(void *param, void *tmrId) {
   pPeer->timer = NULL;
   pPeer->sstatus = TAOS_SYNC_STATUS_INIT;
   sInfo("%s, sync conn is still not up, restart and set sstatus:%s", pPeer->id, syncStatus[pPeer->sstatus]);
+  if (nodeSStatus == TAOS_SYNC_STATUS_INIT) syncReleaseRecovery(pNode->vgId);
   syncRestartConnection(pPeer);
   pthread_mutex_unlock(&pNode->mutex);
 
@@ -965,10 +1020,13 @@ static void syncRecoverFromMaster(SSyncPeer *pPeer) {
   taosTmrStopA(&pPeer->timer);
 
   // Ensure the sync of mnode not interrupted
-  if (pNode->vgId != 1 && tsSyncNum >= SYNC_MAX_NUM) {
-    sInfo("%s, %d syncs are in process, try later", pPeer->id, tsSyncNum);
-    taosTmrReset(syncTryRecoverFromMaster, 500 + (pNode->vgId * 10) % 200, (void *)pPeer->rid, tsSyncTmrCtrl, &pPeer->timer);
-    return;
+  if (pNode->vgId != 1) {
+    int64_t size = pNode->getDataSizeFp ? (*pNode->getDataSizeFp)(pNode->vgId) : 0;
+    if (!syncAcquireRecovery(pNode->vgId, nodeVersion, pPeer->version, size)) {
+      sDebug("%s, recovery is queued, try later", pPeer->id);
+      taosTmrReset(syncTryRecoverFromMaster, 500 + (pNode->vgId * 10) % 200, (void *)pPeer->rid, tsSyncTmrCtrl, &pPeer->timer);
+      return;
+    }
   }
 
   sDebug("%s, try to sync", pPeer->id);
@@ -985,29 +1043,55 @@ static void syncRecoverFromMaster(SSyncPeer *pPeer) {
   }
 }
 
-static void syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
+void syncProcessFwdResponse(SFwdRsp *pFwdRsp, SSyncPeer *pPeer) {
   SSyncNode *pNode = pPeer->pSyncNode;
   SSyncFwds *pSyncFwds = pNode->pSyncFwds;
   SFwdInfo * pFwdInfo;
 
   sTrace("%s, forward-rsp is received, code:%x hver:%" PRIu64, pPeer->id, pFwdRsp->code, pFwdRsp->version);
-  SFwdInfo *pFirst = pSyncFwds->fwdInfo + pSyncFwds->first;
-
-  if (pFirst->version <= pFwdRsp->version && pSyncFwds->fwds > 0) {
-    // find the forwardInfo from first
+  if (pFwdRsp->code != 0 && pFwdRsp->version <= pPeer->ackVersion) {
+    // a failure of a forward covered by a cumulative forward-rsp already
     for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
       pFwdInfo = pSyncFwds->fwdInfo + (i + pSyncFwds->first) % SYNC_MAX_FWDS;
-      if (pFwdRsp->version == pFwdInfo->version) {
-        syncProcessFwdAck(pNode, pFwdInfo, pFwdRsp->code);
-        syncRemoveConfirmedFwdInfo(pNode);
-        return;
-      }
+      if (pFwdInfo->version < pFwdRsp->version) continue;
+      if (pFwdInfo->version > pFwdRsp->version) break;
+
+      syncProcessFwdAck(pNode, pFwdInfo, pFwdRsp->code);
+      syncRemoveConfirmedFwdInfo(pNode);
+      return;
     }
+
+    sError("%s, forward failed after it is acknowledged, code:0x%x hver:%" PRIu64 " ackVersion:%" PRIu64 ", restart",
+           pPeer->id, pFwdRsp->code, pFwdRsp->version, pPeer->ackVersion);
+    syncRestartConnection(pPeer);
+    return;
   }
+
+  if (pFwdRsp->version <= pPeer->ackVersion) return;
+
+  // a forward-rsp acknowledges all the forwards up to its version
+  for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
+    pFwdInfo = pSyncFwds->fwdInfo + (i + pSyncFwds->first) % SYNC_MAX_FWDS;
+    if (pFwdInfo->version > pFwdRsp->version) break;
+    if (pFwdInfo->version <= pPeer->ackVersion) continue;
+    syncProcessFwdAck(pNode, pFwdInfo, (pFwdInfo->version == pFwdRsp->version) ? pFwdRsp->code : 0);
+  }
+
+  pPeer->ackVersion = pFwdRsp->version;
+  syncRemoveConfirmedFwdInfo(pNode);
+
+  while (pPeer->fwdBatches > 0 && pPeer->fwdBatchVer[pPeer->fwdBatchFirst] <= pFwdRsp->version) {
+    pPeer->fwdBatchFirst = (pPeer->fwdBatchFirst + 1) % SYNC_MAX_FWD_WINDOW;
+    pPeer->fwdBatches--;
+  }
+
+  // the forwards held back by the window
+  syncSendPeerFwds(pPeer, false);
 }
 
-static void syncProcessForwardFromPeer(char *cont, SSyncPeer *pPeer) {
+void syncProcessForwardFromPeer(char *cont, SSyncPeer *pPeer) {
   SSyncNode *pNode = pPeer->pSyncNode;
+  SSyncHead *pSyncHead = (SSyncHead *)cont;
   SWalHead * pHead = (SWalHead *)(cont + sizeof(SSyncHead));
 
   sTrace("%s, forward is received, hver:%" PRIu64 ", len:%d", pPeer->id, pHead->version, pHead->len);
@@ -1016,7 +1100,11 @@ static void syncProcessForwardFromPeer(char *cont, SSyncPeer *pPeer) {
   if (nodeRole == TAOS_SYNC_ROLE_SLAVE) {
     // nodeVersion = pHead->version;
     code = (*pNode->writeToCacheFp)(pNode->vgId, pHead, TAOS_QTYPE_FWD, NULL);
-    syncConfirmForward(pNode->rid, pHead->version, code, false);
+
+    // a batch is acknowledged once by its last forward
+    if (code != 0 || pSyncHead->code != SYNC_FWD_MORE) {
+      syncConfirmNodeForward(pNode, pHead->version, code, false);
+    }
   } else {
     if (nodeSStatus != TAOS_SYNC_STATUS_INIT) {
       code = syncSaveIntoBuffer(pPeer, pHead);
@@ -1167,6 +1255,7 @@ static void syncSetupPeerConnection(SSyncPeer *pPeer) {
     sDebug("%s, connection to peer server is setup, pfd:%d sfd:%d tranId:%u", pPeer->id, connFd, pPeer->syncFd, msg.tranId);
     pPeer->peerFd = connFd;
     pPeer->role = TAOS_SYNC_ROLE_UNSYNCED;
+    syncResetPeerFwds(pPeer);
     pPeer->pConn = syncAllocateTcpConn(tsTcpPool, pPeer->rid, connFd);
     if (pPeer->isArb) {
       tsArbOnline = 1;
@@ -1215,6 +1304,7 @@ static void syncCreateRestoreDataThread(SSyncPeer *pPeer) {
     SSyncNode *pNode = pPeer->pSyncNode;
     nodeSStatus = TAOS_SYNC_STATUS_INIT;
     sError("%s, failed to create sync restore thread, set sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
+    syncReleaseRecovery(pNode->vgId);
     taosCloseSocket(pPeer->syncFd);
     syncReleasePeer(pPeer);
   } else {
@@ -1291,14 +1381,17 @@ static void syncProcessIncommingConnection(SOCKET connFd, uint32_t sourceIp) {
     // first packet tells what kind of link
     if (msg.head.type == TAOS_SMSG_SYNC_DATA) {
       pPeer->syncFd = connFd;
+      pPeer->syncCaps = msg.head.code;
       nodeSStatus = TAOS_SYNC_STATUS_START;
-      sInfo("%s, sync-data msg from master is received, tranId:%u, set sstatus:%s", pPeer->id, msg.tranId,
-            syncStatus[nodeSStatus]);
+      atomic_store_64(&pNode->ackVersion, 0);
+      sInfo("%s, sync-data msg from master is received, tranId:%u caps:0x%x, set sstatus:%s", pPeer->id, msg.tranId,
+            pPeer->syncCaps, syncStatus[nodeSStatus]);
       syncCreateRestoreDataThread(pPeer);
     } else {
       sDebug("%s, TCP connection is up, pfd:%d sfd:%d, old pfd:%d", pPeer->id, connFd, pPeer->syncFd, pPeer->peerFd);
       syncClosePeerConn(pPeer);
       pPeer->peerFd = connFd;
+      syncResetPeerFwds(pPeer);
       pPeer->pConn = syncAllocateTcpConn(tsTcpPool, pPeer->rid, connFd);
       sDebug("%s, ready to exchange data", pPeer->id);
       syncSendPeersStatusMsgToPeer(pPeer, 1, SYNC_STATUS_EXCHANGE_DATA, syncGenTranId());
@@ -1422,37 +1515,120 @@ static void syncMonitorFwdInfos(void *param, void *tmrId) {
   SSyncNode *pNode = syncAcquireNode(rid);
   if (pNode == NULL) return;
 
+  if (pNode->pSyncFwds) {
+    syncCheckFwdInfos(pNode, taosGetTimestampMs());
+    pNode->pFwdTimer = taosTmrStart(syncMonitorFwdInfos, SYNC_FWD_TIMER, (void *)pNode->rid, tsSyncTmrCtrl);
+  }
+
+  syncReleaseNode(pNode);
+}
+
+void syncCheckFwdInfos(SSyncNode *pNode, int64_t time) {
   SSyncFwds *pSyncFwds = pNode->pSyncFwds;
 
-  if (pSyncFwds) {
-    int64_t time = taosGetTimestampMs();
+  pthread_mutex_lock(&pNode->mutex);
+  for (int32_t i = 0; i < pNode->replica; ++i) {
+    SSyncPeer *pPeer = pNode->peerInfo[i];
+    if (pPeer == NULL || pPeer->fwdLen <= 0) continue;
 
-    if (pSyncFwds->fwds > 0) {
-      pthread_mutex_lock(&pNode->mutex);
-      for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
-        SFwdInfo *pFwdInfo = pSyncFwds->fwdInfo + (pSyncFwds->first + i) % SYNC_MAX_FWDS;
-        if (ABS(time - pFwdInfo->time) < 10000) break;
+    // not flushed by the app, or held back by the window for too long
+    if (time - pPeer->fwdTime >= SYNC_FWD_TIMER) syncSendPeerFwds(pPeer, true);
+  }
 
-        sDebug("vgId:%d, forward info expired, hver:%" PRIu64 " curtime:%" PRIu64 " savetime:%" PRIu64, pNode->vgId,
-               pFwdInfo->version, time, pFwdInfo->time);
-        syncProcessFwdAck(pNode, pFwdInfo, TSDB_CODE_SYN_CONFIRM_EXPIRED);
-      }
+  if (pSyncFwds->fwds > 0) {
+    for (int32_t i = 0; i < pSyncFwds->fwds; ++i) {
+      SFwdInfo *pFwdInfo = pSyncFwds->fwdInfo + (pSyncFwds->first + i) % SYNC_MAX_FWDS;
+      if (ABS(time - pFwdInfo->time) < 10000) break;
 
-      syncRemoveConfirmedFwdInfo(pNode);
-      pthread_mutex_unlock(&pNode->mutex);
+      sDebug("vgId:%d, forward info expired, hver:%" PRIu64 " curtime:%" PRIu64 " savetime:%" PRIu64, pNode->vgId,
+             pFwdInfo->version, time, pFwdInfo->time);
+      syncProcessFwdAck(pNode, pFwdInfo, TSDB_CODE_SYN_CONFIRM_EXPIRED);
     }
 
-    pNode->pFwdTimer = taosTmrStart(syncMonitorFwdInfos, SYNC_FWD_TIMER, (void *)pNode->rid, tsSyncTmrCtrl);
+    syncRemoveConfirmedFwdInfo(pNode);
   }
+  pthread_mutex_unlock(&pNode->mutex);
+}
 
-  syncReleaseNode(pNode);
+static void syncResetPeerFwds(SSyncPeer *pPeer) {
+  pPeer->fwdLen = 0;
+  pPeer->ackVersion = 0;
+  pPeer->fwdBatches = 0;
+  pPeer->fwdBatchFirst = 0;
 }
 
-static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force) {
+// forwards to a peer are coalesced and written out together by syncSendPeerFwds
+static int32_t syncAddPeerFwd(SSyncPeer *pPeer, SWalHead *pWalHead) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+  int32_t    fwdLen = sizeof(SSyncHead) + sizeof(SWalHead) + pWalHead->len;
+
+  if (pPeer->fwdLen + fwdLen > pPeer->fwdBufSize) {
+    int32_t size = MAX(pPeer->fwdLen + fwdLen, tsSyncFwdBatchSize);
+    char *  buf = realloc(pPeer->fwdBuf, size);
+    if (buf == NULL) return -1;
+
+    pPeer->fwdBuf = buf;
+    pPeer->fwdBufSize = size;
+  }
+
+  if (pPeer->fwdLen > 0) {
+    syncSetFwdMore((SSyncHead *)(pPeer->fwdBuf + pPeer->fwdLastOffset));
+  } else {
+    pPeer->fwdTime = taosGetTimestampMs();
+  }
+
+  SSyncHead *pSyncHead = (SSyncHead *)(pPeer->fwdBuf + pPeer->fwdLen);
+  syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead) + pWalHead->len);
+  memcpy(pSyncHead + 1, pWalHead, sizeof(SWalHead) + pWalHead->len);
+
+  pPeer->fwdLastOffset = pPeer->fwdLen;
+  pPeer->fwdLen += fwdLen;
+  return 0;
+}
+
+/*
+ * A slave acknowledges every batch if quorum > 1, at most tsSyncFwdWindow batches are in flight to it. The
+ * forwards added meanwhile are held back and sent as one larger batch, unless they reach tsSyncFwdBatchSize.
+ */
+static void syncSendPeerFwds(SSyncPeer *pPeer, bool force) {
+  SSyncNode *pNode = pPeer->pSyncNode;
+
+  if (pPeer->fwdLen <= 0) return;
+  if (pPeer->peerFd < 0) {
+    pPeer->fwdLen = 0;
+    return;
+  }
+
+  bool windowed = (pNode->quorum > 1 && pPeer->role == TAOS_SYNC_ROLE_SLAVE);
+  if (windowed && !force && pPeer->fwdBatches >= tsSyncFwdWindow && pPeer->fwdLen < tsSyncFwdBatchSize) {
+    sTrace("%s, forwards are held back, batches:%d len:%d", pPeer->id, pPeer->fwdBatches, pPeer->fwdLen);
+    return;
+  }
+
+  SWalHead *pLast = (SWalHead *)(pPeer->fwdBuf + pPeer->fwdLastOffset + sizeof(SSyncHead));
+  uint64_t  lastVer = pLast->version;
+  int32_t   fwdLen = pPeer->fwdLen;
+  pPeer->fwdLen = 0;
+
+  int32_t retLen = taosWriteMsg(pPeer->peerFd, pPeer->fwdBuf, fwdLen);
+  if (retLen == fwdLen) {
+    sTrace("%s, forwards are sent, role:%s sstatus:%s hver:%" PRIu64 " len:%d batches:%d", pPeer->id,
+           syncRole[pPeer->role], syncStatus[pPeer->sstatus], lastVer, fwdLen, pPeer->fwdBatches);
+    if (windowed) {
+      // once the ring is full, the batch is merged into the last one in flight
+      if (pPeer->fwdBatches < SYNC_MAX_FWD_WINDOW) pPeer->fwdBatches++;
+      pPeer->fwdBatchVer[(pPeer->fwdBatchFirst + pPeer->fwdBatches - 1) % SYNC_MAX_FWD_WINDOW] = lastVer;
+    }
+  } else {
+    sError("%s, failed to forward, role:%s sstatus:%s hver:%" PRIu64 " retLen:%d", pPeer->id, syncRole[pPeer->role],
+           syncStatus[pPeer->sstatus], lastVer, retLen);
+    syncRestartConnection(pPeer);
+  }
+}
+
+int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle, int32_t qtype, bool force) {
   SSyncPeer *pPeer;
-  SSyncHead *pSyncHead;
   SWalHead * pWalHead = data;
-  int32_t    fwdLen;
   int32_t    code = 0;
 
   if (pWalHead->version > nodeVersion + 1) {
@@ -1480,11 +1656,6 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
   // only msg from RPC or CQ can be forwarded
   if (qtype != TAOS_QTYPE_RPC && qtype != TAOS_QTYPE_CQ) return 0;
 
-    // a hacker way to improve the performance
-  pSyncHead = (SSyncHead *)(((char *)pWalHead) - sizeof(SSyncHead));
-  syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead) + pWalHead->len);
-  fwdLen = pSyncHead->len + sizeof(SSyncHead);  // include the WAL and SYNC head
-
   pthread_mutex_lock(&pNode->mutex);
 
   for (int32_t i = 0; i < pNode->replica; ++i) {
@@ -1502,15 +1673,16 @@ static int32_t syncForwardToPeerImpl(SSyncNode *pNode, void *data, void *mhandle
       }
     }
 
-    int32_t retLen = taosWriteMsg(pPeer->peerFd, pSyncHead, fwdLen);
-    if (retLen == fwdLen) {
-      sTrace("%s, forward is sent, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id, syncRole[pPeer->role],
-             syncStatus[pPeer->sstatus], pWalHead->version, pWalHead->len);
-    } else {
-      sError("%s, failed to forward, role:%s sstatus:%s hver:%" PRIu64 " retLen:%d", pPeer->id, syncRole[pPeer->role],
-             syncStatus[pPeer->sstatus], pWalHead->version, retLen);
+    if (syncAddPeerFwd(pPeer, pWalHead) != 0) {
+      sError("%s, failed to forward since no memory, role:%s sstatus:%s hver:%" PRIu64, pPeer->id,
+             syncRole[pPeer->role], syncStatus[pPeer->sstatus], pWalHead->version);
       syncRestartConnection(pPeer);
+      continue;
     }
+
+    sTrace("%s, forward is added, role:%s sstatus:%s hver:%" PRIu64 " contLen:%d", pPeer->id, syncRole[pPeer->role],
+           syncStatus[pPeer->sstatus], pWalHead->version, pWalHead->len);
+    if (pPeer->fwdLen >= tsSyncFwdBatchSize) syncSendPeerFwds(pPeer, false);
   }
 
   pthread_mutex_unlock(&pNode->mutex);
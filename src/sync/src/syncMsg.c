@@ -61,6 +61,11 @@ void syncBuildSyncFwdMsg(SSyncHead *pHead, int32_t vgId, int32_t len) {
   syncBuildHead(pHead);
 }
 
+void syncSetFwdMore(SSyncHead *pHead) {
+  pHead->code = SYNC_FWD_MORE;
+  taosCalcChecksumAppend(0, (uint8_t *)pHead, sizeof(SSyncHead));
+}
+
 void syncBuildSyncFwdRsp(SFwdRsp *pMsg, int32_t vgId, uint64_t _version, int32_t code) {
   pMsg->head.type = TAOS_SMSG_SYNC_FWD_RSP;
   pMsg->head.vgId = vgId;
@@ -84,10 +89,15 @@ static void syncBuildMsg(SSyncMsg *pMsg, int32_t vgId, ESyncMsgType type) {
 }
 
 void syncBuildSyncReqMsg(SSyncMsg *pMsg, int32_t vgId) { syncBuildMsg(pMsg, vgId, TAOS_SMSG_SYNC_REQ); }
-void syncBuildSyncDataMsg(SSyncMsg *pMsg, int32_t vgId) { syncBuildMsg(pMsg, vgId, TAOS_SMSG_SYNC_DATA); }
 void syncBuildSyncSetupMsg(SSyncMsg *pMsg, int32_t vgId) { syncBuildMsg(pMsg, vgId, TAOS_SMSG_SETUP); }
 void syncBuildSyncTestMsg(SSyncMsg *pMsg, int32_t vgId) { syncBuildMsg(pMsg, vgId, TAOS_SMSG_TEST); }
 
+void syncBuildSyncDataMsg(SSyncMsg *pMsg, int32_t vgId) {
+  syncBuildMsg(pMsg, vgId, TAOS_SMSG_SYNC_DATA);
+  pMsg->head.code = SYNC_DATA_CAPS;
+  taosCalcChecksumAppend(0, (uint8_t *)(&pMsg->head), sizeof(SSyncHead));
+}
+
 void syncBuildPeersStatus(SPeersStatus *pMsg, int32_t vgId) {
   pMsg->head.type = TAOS_SMSG_STATUS;
   pMsg->head.vgId = vgId;
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tlog.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "tarray.h"
+#include "ttimer.h"
+#include "tsync.h"
+#include "syncInt.h"
+
+// The vnodes of a dnode restored from their masters are scheduled here, so that a restarted dnode with many
+// vnodes restores at most tsSyncRecoveryNum of them at the same time. Vnodes waiting for a slot are queued,
+// the most stale ones first and, among those of similar staleness, the smallest ones first.
+
+#define SYNC_RECOVERY_QUEUE_TIMEOUT 5000   // ms, a queued vnode retries far more often than this
+#define SYNC_RECOVERY_START_TIMEOUT 10000  // ms, an admitted vnode gets the sync-data msg far sooner than this
+
+typedef struct {
+  int32_t  vgId;
+  int8_t   state;  // ESyncRecovery
+  uint64_t version;
+  uint64_t mversion;  // version of the master when the vnode is queued
+  int64_t  size;
+  int64_t  time;
+} SSyncRecovery;
+
+char *syncRecovery[] = {
+  "none",
+  "queued",
+  "start",
+  "file",
+  "wal",
+  "cache"
+};
+
+static SArray *         tsRecoveries = NULL;
+static pthread_mutex_t  tsRecoveryMutex;
+
+int32_t syncInitRecovery() {
+  tsRecoveries = taosArrayInit(TSDB_MIN_VNODES, sizeof(SSyncRecovery));
+  if (tsRecoveries == NULL) return -1;
+
+  pthread_mutex_init(&tsRecoveryMutex, NULL);
+  return 0;
+}
+
+void syncCleanUpRecovery() {
+  if (tsRecoveries == NULL) return;
+
+  taosArrayDestroy(tsRecoveries);
+  tsRecoveries = NULL;
+  pthread_mutex_destroy(&tsRecoveryMutex);
+}
+
+static uint64_t syncGetRecoveryLag(SSyncRecovery *pRecovery) {
+  return (pRecovery->mversion > pRecovery->version) ? pRecovery->mversion - pRecovery->version : 0;
+}
+
+// staleness counts by the power of 2 of the lag, so that a slightly more stale vnode does not go before a much
+// smaller one
+static int32_t syncGetRecoveryLevel(SSyncRecovery *pRecovery) {
+  uint64_t lag = syncGetRecoveryLag(pRecovery);
+  int32_t  level = 0;
+
+  while (lag > 0) {
+    level++;
+    lag >>= 1;
+  }
+
+  return level;
+}
+
+static bool syncRecoveryGoesBefore(SSyncRecovery *pRecovery1, SSyncRecovery *pRecovery2) {
+  int32_t level1 = syncGetRecoveryLevel(pRecovery1);
+  int32_t level2 = syncGetRecoveryLevel(pRecovery2);
+
+  if (level1 != level2) return level1 > level2;
+  if (pRecovery1->size != pRecovery2->size) return pRecovery1->size < pRecovery2->size;
+  return pRecovery1->vgId < pRecovery2->vgId;
+}
+
+static SSyncRecovery *syncGetRecovery(int32_t vgId) {
+  size_t size = taosArrayGetSize(tsRecoveries);
+  for (size_t i = 0; i < size; ++i) {
+    SSyncRecovery *pRecovery = taosArrayGet(tsRecoveries, i);
+    if (pRecovery->vgId == vgId) return pRecovery;
+  }
+
+  return NULL;
+}
+
+void syncRemoveExpiredRecoveries(int64_t now) {
+  for (size_t i = 0; i < taosArrayGetSize(tsRecoveries);) {
+    SSyncRecovery *pRecovery = taosArrayGet(tsRecoveries, i);
+    int64_t        elapsed = now - pRecovery->time;
+
+    if ((pRecovery->state == TAOS_SYNC_RECOVERY_QUEUED && elapsed > SYNC_RECOVERY_QUEUE_TIMEOUT) ||
+        (pRecovery->state == TAOS_SYNC_RECOVERY_START && elapsed > SYNC_RECOVERY_START_TIMEOUT)) {
+      sInfo("vgId:%d, recovery is expired in %s state", pRecovery->vgId, syncRecovery[pRecovery->state]);
+      taosArrayRemove(tsRecoveries, i);
+    } else {
+      i++;
+    }
+  }
+}
+
+static int32_t syncGetNumOfRunningRecoveries() {
+  int32_t num = 0;
+  size_t  size = taosArrayGetSize(tsRecoveries);
+  for (size_t i = 0; i < size; ++i) {
+    SSyncRecovery *pRecovery = taosArrayGet(tsRecoveries, i);
+    if (pRecovery->state != TAOS_SYNC_RECOVERY_QUEUED) num++;
+  }
+
+  return num;
+}
+
+// 1 for the queued vnode to be admitted next
+static int32_t syncGetRecoveryRank(SSyncRecovery *pRecovery) {
+  int32_t rank = 1;
+  size_t  size = taosArrayGetSize(tsRecoveries);
+  for (size_t i = 0; i < size; ++i) {
+    SSyncRecovery *pOther = taosArrayGet(tsRecoveries, i);
+    if (pOther == pRecovery || pOther->state != TAOS_SYNC_RECOVERY_QUEUED) continue;
+    if (syncRecoveryGoesBefore(pOther, pRecovery)) rank++;
+  }
+
+  return rank;
+}
+
+bool syncAcquireRecovery(int32_t vgId, uint64_t ver, uint64_t mver, int64_t size) {
+  int64_t now = taosGetTimestampMs();
+  bool    admitted = false;
+
+  pthread_mutex_lock(&tsRecoveryMutex);
+
+  syncRemoveExpiredRecoveries(now);
+
+  SSyncRecovery *pRecovery = syncGetRecovery(vgId);
+  if (pRecovery == NULL) {
+    SSyncRecovery recovery = {.vgId = vgId, .state = TAOS_SYNC_RECOVERY_QUEUED};
+    pRecovery = taosArrayPush(tsRecoveries, &recovery);
+    if (pRecovery == NULL) {
+      // no memory to queue it, let it go rather than block the recovery
+      pthread_mutex_unlock(&tsRecoveryMutex);
+      return true;
+    }
+  }
+
+  pRecovery->version = ver;
+  pRecovery->mversion = mver;
+  pRecovery->size = size;
+  pRecovery->time = now;
+
+  if (pRecovery->state != TAOS_SYNC_RECOVERY_QUEUED) {
+    admitted = true;
+  } else {
+    int32_t running = syncGetNumOfRunningRecoveries();
+    int32_t rank = syncGetRecoveryRank(pRecovery);
+    if (running + rank <= tsSyncRecoveryNum) {
+      pRecovery->state = TAOS_SYNC_RECOVERY_START;
+      admitted = true;
+      sInfo("vgId:%d, recovery is admitted, lag:%" PRIu64 " size:%" PRId64 " running:%d", vgId,
+            syncGetRecoveryLag(pRecovery), size, running + 1);
+    } else {
+      sDebug("vgId:%d, recovery is queued, lag:%" PRIu64 " size:%" PRId64 " rank:%d running:%d", vgId,
+             syncGetRecoveryLag(pRecovery), size, rank, running);
+    }
+  }
+
+  pthread_mutex_unlock(&tsRecoveryMutex);
+  return admitted;
+}
+
+void syncUpdateRecovery(int32_t vgId, int8_t state, uint64_t ver) {
+  pthread_mutex_lock(&tsRecoveryMutex);
+
+  SSyncRecovery *pRecovery = syncGetRecovery(vgId);
+  if (pRecovery == NULL) {
+    // expired before the restore starts, it takes a slot anyway
+    SSyncRecovery recovery = {.vgId = vgId, .mversion = ver};
+    pRecovery = taosArrayPush(tsRecoveries, &recovery);
+  }
+
+  if (pRecovery != NULL) {
+    pRecovery->state = state;
+    pRecovery->version = ver;
+    pRecovery->time = taosGetTimestampMs();
+  }
+
+  pthread_mutex_unlock(&tsRecoveryMutex);
+}
+
+void syncReleaseRecovery(int32_t vgId) {
+  pthread_mutex_lock(&tsRecoveryMutex);
+
+  size_t size = taosArrayGetSize(tsRecoveries);
+  for (size_t i = 0; i < size; ++i) {
+    SSyncRecovery *pRecovery = taosArrayGet(tsRecoveries, i);
+    if (pRecovery->vgId == vgId) {
+      sDebug("vgId:%d, recovery is released in %s state", vgId, syncRecovery[pRecovery->state]);
+      taosArrayRemove(tsRecoveries, i);
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&tsRecoveryMutex);
+}
+
+void syncGetRecoveryState(int32_t vgId, SSyncRecoveryInfo *pInfo) {
+  memset(pInfo, 0, sizeof(SSyncRecoveryInfo));
+
+  pthread_mutex_lock(&tsRecoveryMutex);
+
+  SSyncRecovery *pRecovery = syncGetRecovery(vgId);
+  if (pRecovery != NULL) {
+    pInfo->state = pRecovery->state;
+    pInfo->lag = syncGetRecoveryLag(pRecovery);
+    if (pRecovery->state == TAOS_SYNC_RECOVERY_QUEUED) pInfo->rank = syncGetRecoveryRank(pRecovery);
+  }
+
+  pthread_mutex_unlock(&tsRecoveryMutex);
+}
+
+// every restore gets an even share of the rate of the dnode
+uint16_t syncGetRecoveryRate(int32_t rate) {
+  if (rate <= 0) return 0;
+
+  int32_t num = MAX(tsSyncRecoveryNum, 1);
+  return (uint16_t)MAX(rate / num, 1);
+}
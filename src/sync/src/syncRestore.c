@@ -18,6 +18,7 @@
 #include "taoserror.h"
 #include "tlog.h"
 #include "tutil.h"
+#include "tglobal.h"
 #include "ttimer.h"
 #include "tsocket.h"
 #include "tqueue.h"
@@ -25,6 +26,13 @@
 #include "tsync.h"
 #include "syncInt.h"
 
+#define SYNC_RECOVERY_UPDATE_RECORDS 1024  // progress of wal restore is reported every so many records
+
+// the sync of mnode is not scheduled with vnodes
+static void syncSetRecoveryState(SSyncNode *pNode, int8_t state, uint64_t ver) {
+  if (pNode->vgId != 1) syncUpdateRecovery(pNode->vgId, state, ver);
+}
+
 static int32_t syncRecvFileVersion(SSyncPeer *pPeer, uint64_t *fversion) {
   SSyncNode *pNode = pPeer->pSyncNode;
 
@@ -52,7 +60,7 @@ static int32_t syncRecvFileVersion(SSyncPeer *pPeer, uint64_t *fversion) {
 static int32_t syncRestoreFile(SSyncPeer *pPeer, uint64_t *fversion) {
   SSyncNode *pNode = pPeer->pSyncNode;
 
-  if (pNode->recvFileFp && (*pNode->recvFileFp)(pNode->pTsdb, pPeer->syncFd) != 0) {
+  if (pNode->recvFileFp && (*pNode->recvFileFp)(pNode->pTsdb, pPeer->syncFd, pPeer->syncCaps) != 0) {
     sError("%s, failed to restore file", pPeer->id);
     return -1;
   }
@@ -69,6 +77,7 @@ static int32_t syncRestoreWal(SSyncPeer *pPeer, uint64_t *wver) {
   SSyncNode *pNode = pPeer->pSyncNode;
   int32_t    ret, code = -1;
   uint64_t   lastVer = 0;
+  int32_t    records = 0;
 
   SWalHead *pHead = calloc(SYNC_MAX_SIZE, 1);  // size for one record
   if (pHead == NULL) return -1;
@@ -105,6 +114,10 @@ static int32_t syncRestoreWal(SSyncPeer *pPeer, uint64_t *wver) {
       sError("%s, failed to restore record since %s, hver:%" PRIu64, pPeer->id, tstrerror(ret), pHead->version);
       break;
     }
+
+    if (++records % SYNC_RECOVERY_UPDATE_RECORDS == 0) {
+      syncSetRecoveryState(pNode, TAOS_SYNC_RECOVERY_WAL, lastVer);
+    }
   }
 
   if (code < 0) {
@@ -219,12 +232,21 @@ static int32_t syncRestoreDataStepByStep(SSyncPeer *pPeer) {
   uint64_t fversion = 0;
 
   sInfo("%s, start to restore, sstatus:%s", pPeer->id, syncStatus[pPeer->sstatus]);
+  syncSetRecoveryState(pNode, TAOS_SYNC_RECOVERY_FILE, nodeVersion);
+
+  // the master streams files and wal at the share of this dnode's rates
   SSyncRsp rsp = {.sync = 1, .tranId = syncGenTranId()};
+  if (pNode->vgId != 1) {
+    rsp.fileRate = htons(syncGetRecoveryRate(tsSyncFileRate));
+    rsp.walRate = htons(syncGetRecoveryRate(tsSyncWalRate));
+  }
+
   if (taosWriteMsg(pPeer->syncFd, &rsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp)) {
     sError("%s, failed to send sync rsp since %s", pPeer->id, strerror(errno));
     return -1;
   }
-  sDebug("%s, send sync rsp to peer, tranId:%u", pPeer->id, rsp.tranId);
+  sDebug("%s, send sync rsp to peer, tranId:%u fileRate:%u walRate:%u", pPeer->id, rsp.tranId, htons(rsp.fileRate),
+         htons(rsp.walRate));
 
   sInfo("%s, start to restore file, set sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
   (*pNode->startSyncFileFp)(pNode->vgId);
@@ -240,6 +262,7 @@ static int32_t syncRestoreDataStepByStep(SSyncPeer *pPeer) {
   nodeVersion = fversion;
 
   sInfo("%s, start to restore wal, fver:%" PRIu64, pPeer->id, nodeVersion);
+  syncSetRecoveryState(pNode, TAOS_SYNC_RECOVERY_WAL, nodeVersion);
   uint64_t wver = 0;
   code = syncRestoreWal(pPeer, &wver);  // lastwar
   if (code < 0) {
@@ -253,6 +276,7 @@ static int32_t syncRestoreDataStepByStep(SSyncPeer *pPeer) {
   }
 
   nodeSStatus = TAOS_SYNC_STATUS_CACHE;
+  syncSetRecoveryState(pNode, TAOS_SYNC_RECOVERY_CACHE, nodeVersion);
   sInfo("%s, start to insert buffered points, set sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
   if (syncProcessBufferedFwd(pPeer) < 0) {
     sError("%s, failed to insert buffered points", pPeer->id);
@@ -274,7 +298,6 @@ void *syncRestoreData(void *param) {
   SSyncNode *pNode = pPeer->pSyncNode;
 
   taosBlockSIGPIPE();
-  atomic_add_fetch_32(&tsSyncNum, 1);
   sInfo("%s, start to restore data, sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
 
   nodeRole = TAOS_SYNC_ROLE_SYNCING;
@@ -297,12 +320,12 @@ void *syncRestoreData(void *param) {
 
   (*pNode->notifyRoleFp)(pNode->vgId, nodeRole);
 
+  syncReleaseRecovery(pNode->vgId);
   nodeSStatus = TAOS_SYNC_STATUS_INIT;
   sInfo("%s, restore data over, set sstatus:%s", pPeer->id, syncStatus[nodeSStatus]);
 
   taosCloseSocket(pPeer->syncFd);
   syncCloseRecvBuffer(pNode);
-  atomic_sub_fetch_32(&tsSyncNum, 1);
 
   // The ref is obtained in both the create thread and the current thread, so it is released twice
   syncReleasePeer(pPeer);
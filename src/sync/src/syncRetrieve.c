@@ -364,7 +364,17 @@ static int64_t syncRetrieveWal(SSyncPeer *pPeer) {
   return code;
 }
 
-static int32_t syncRetrieveFirstPkt(SSyncPeer *pPeer) {
+// pace the sync link at the rate the restoring peer asks for, MB/s, 0 for no limit
+static void syncSetRetrieveRate(SSyncPeer *pPeer, uint16_t rate) {
+#ifdef SO_MAX_PACING_RATE
+  uint32_t bytes = (rate == 0) ? ~0U : (uint32_t)rate * 1024 * 1024;
+  if (taosSetSockOpt(pPeer->syncFd, SOL_SOCKET, SO_MAX_PACING_RATE, &bytes, sizeof(bytes)) != 0) {
+    sWarn("%s, failed to set retrieve rate:%u MB/s since %s", pPeer->id, rate, strerror(errno));
+  }
+#endif
+}
+
+static int32_t syncRetrieveFirstPkt(SSyncPeer *pPeer, SSyncRsp *pRsp) {
   SSyncNode *pNode = pPeer->pSyncNode;
 
   SSyncMsg msg;
@@ -376,19 +386,22 @@ static int32_t syncRetrieveFirstPkt(SSyncPeer *pPeer) {
   }
   sInfo("%s, send sync-data msg to peer, tranId:%u", pPeer->id, msg.tranId);
 
-  SSyncRsp rsp;
-  if (taosReadMsg(pPeer->syncFd, &rsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp)) {
+  if (taosReadMsg(pPeer->syncFd, pRsp, sizeof(SSyncRsp)) != sizeof(SSyncRsp)) {
     sError("%s, failed to read sync-data rsp since %s, tranId:%u", pPeer->id, strerror(errno), msg.tranId);
     return -1;
   }
 
-  sInfo("%s, recv sync-data rsp from peer, tranId:%u rsp-tranId:%u", pPeer->id, msg.tranId, rsp.tranId);
+  pRsp->fileRate = htons(pRsp->fileRate);
+  pRsp->walRate = htons(pRsp->walRate);
+  sInfo("%s, recv sync-data rsp from peer, tranId:%u rsp-tranId:%u fileRate:%u walRate:%u", pPeer->id, msg.tranId,
+        pRsp->tranId, pRsp->fileRate, pRsp->walRate);
   return 0;
 }
 
 static int32_t syncRetrieveDataStepByStep(SSyncPeer *pPeer) {
+  SSyncRsp rsp;
   sInfo("%s, start to retrieve, sstatus:%s", pPeer->id, syncStatus[pPeer->sstatus]);
-  if (syncRetrieveFirstPkt(pPeer) < 0) {
+  if (syncRetrieveFirstPkt(pPeer, &rsp) < 0) {
     sError("%s, failed to start retrieve", pPeer->id);
     return -1;
   }
@@ -396,6 +409,7 @@ static int32_t syncRetrieveDataStepByStep(SSyncPeer *pPeer) {
   pPeer->sversion = 0;
   pPeer->sstatus = TAOS_SYNC_STATUS_FILE;
   sInfo("%s, start to retrieve files, set sstatus:%s", pPeer->id, syncStatus[pPeer->sstatus]);
+  syncSetRetrieveRate(pPeer, rsp.fileRate);
   if (syncRetrieveFile(pPeer) != 0) {
     sError("%s, failed to retrieve files", pPeer->id);
     return -1;
@@ -405,6 +419,7 @@ static int32_t syncRetrieveDataStepByStep(SSyncPeer *pPeer) {
   if (pPeer->sversion == 0) pPeer->sversion = 1;
 
   sInfo("%s, start to retrieve wals", pPeer->id);
+  syncSetRetrieveRate(pPeer, rsp.walRate);
   int64_t code = syncRetrieveWal(pPeer);
   if (code < 0) {
     sError("%s, failed to retrieve wals, code:0x%" PRIx64, pPeer->id, code);
@@ -0,0 +1,400 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "os.h"
+#include "taoserror.h"
+#include "tglobal.h"
+#include "tsync.h"
+#include "syncInt.h"
+#include "syncMsg.h"
+
+namespace {
+
+typedef std::vector<std::pair<uint64_t, int32_t> > Confirms;
+
+struct Fwd {
+  uint64_t version;
+  bool     more;
+  bool     valid;
+};
+
+// A node of vgroup 2 with the peers connected by socket pairs, the other end of each pair is read by the test as the
+// peer would. Peers have no fqdn, restarting their connection does nothing.
+class SyncFwdTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    batchSize = tsSyncFwdBatchSize;
+    window = tsSyncFwdWindow;
+    confirms.clear();
+    writes = 0;
+  }
+
+  void TearDown() override {
+    for (int32_t i = 0; pNode != NULL && i < pNode->replica; ++i) {
+      SSyncPeer *pPeer = pNode->peerInfo[i];
+      if (pPeer->peerFd >= 0) {
+        close(pPeer->peerFd);
+        close(fds[i]);
+      }
+      free(pPeer->fwdBuf);
+      free(pPeer);
+    }
+
+    if (pNode != NULL) {
+      pthread_mutex_destroy(&pNode->mutex);
+      free(pNode->pSyncFwds);
+      free(pNode);
+    }
+
+    tsSyncFwdBatchSize = batchSize;
+    tsSyncFwdWindow = window;
+  }
+
+  void open(int8_t replica, int8_t quorum, int8_t role) {
+    pNode = (SSyncNode *)calloc(1, sizeof(SSyncNode));
+    pNode->replica = replica;
+    pNode->quorum = quorum;
+    pNode->selfIndex = 0;
+    pNode->vgId = 2;
+    pNode->pSyncFwds = (SSyncFwds *)calloc(1, sizeof(SSyncFwds) + SYNC_MAX_FWDS * sizeof(SFwdInfo));
+    pNode->writeToCacheFp = writeToCache;
+    pNode->confirmForward = confirmForward;
+    pthread_mutex_init(&pNode->mutex, NULL);
+
+    for (int32_t i = 0; i < replica; ++i) {
+      SSyncPeer *pPeer = (SSyncPeer *)calloc(1, sizeof(SSyncPeer));
+      pPeer->pSyncNode = pNode;
+      pPeer->peerFd = -1;
+      snprintf(pPeer->id, sizeof(pPeer->id), "vgId:2, peer:%d", i);
+      pNode->peerInfo[i] = pPeer;
+
+      if (i == 0) {
+        pPeer->role = role;
+        continue;
+      }
+
+      int sv[2];
+      ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sv), 0);
+      ASSERT_EQ(fcntl(sv[1], F_SETFL, O_NONBLOCK), 0);
+      pPeer->peerFd = sv[0];
+      pPeer->role = (role == TAOS_SYNC_ROLE_MASTER) ? TAOS_SYNC_ROLE_SLAVE : TAOS_SYNC_ROLE_MASTER;
+      pPeer->sstatus = TAOS_SYNC_STATUS_CACHE;
+      fds[i] = sv[1];
+    }
+
+    if (role == TAOS_SYNC_ROLE_SLAVE) pNode->pMaster = pNode->peerInfo[1];
+  }
+
+  // the master forwards a write from the app, the content of a forward is its version repeated
+  int32_t forward(uint64_t version, int32_t len = 100) {
+    std::vector<char> buf(sizeof(SWalHead) + len, (char)version);
+    SWalHead *        pHead = (SWalHead *)buf.data();
+    memset(pHead, 0, sizeof(SWalHead));
+    pHead->version = version;
+    pHead->len = len;
+    return syncForwardToPeerImpl(pNode, pHead, (void *)version, TAOS_QTYPE_RPC, false);
+  }
+
+  // the forwards written to the peer, in the order they are read by it
+  std::vector<Fwd> received(int32_t index) {
+    std::vector<char> buf;
+    char              chunk[4096];
+    ssize_t           len;
+    while ((len = read(fds[index], chunk, sizeof(chunk))) > 0) buf.insert(buf.end(), chunk, chunk + len);
+
+    std::vector<Fwd> fwds;
+    for (size_t offset = 0; offset < buf.size();) {
+      SSyncHead *pSyncHead = (SSyncHead *)(buf.data() + offset);
+      SWalHead * pHead = (SWalHead *)(pSyncHead + 1);
+      EXPECT_EQ(pSyncHead->type, TAOS_SMSG_SYNC_FWD);
+      EXPECT_EQ(pSyncHead->len, (int32_t)sizeof(SWalHead) + pHead->len);
+
+      Fwd fwd = {pHead->version, pSyncHead->code == SYNC_FWD_MORE, syncCheckHead(pSyncHead) == TSDB_CODE_SUCCESS};
+      fwds.push_back(fwd);
+      offset += sizeof(SSyncHead) + pSyncHead->len;
+    }
+
+    return fwds;
+  }
+
+  // the versions of the forwards received, checking a batch is ended by the last one received
+  std::vector<uint64_t> receivedBatch(int32_t index) {
+    std::vector<Fwd>      fwds = received(index);
+    std::vector<uint64_t> versions;
+    for (size_t i = 0; i < fwds.size(); ++i) {
+      EXPECT_TRUE(fwds[i].valid) << "hver " << fwds[i].version;
+      EXPECT_EQ(fwds[i].more, i + 1 < fwds.size()) << "hver " << fwds[i].version;
+      versions.push_back(fwds[i].version);
+    }
+    return versions;
+  }
+
+  // the forward-rsps written to the master by a slave
+  std::vector<SFwdRsp> receivedRsps(int32_t index) {
+    std::vector<SFwdRsp> rsps;
+    SFwdRsp              rsp;
+    while (read(fds[index], &rsp, sizeof(rsp)) == sizeof(rsp)) {
+      EXPECT_EQ(syncCheckHead(&rsp.head), TSDB_CODE_SUCCESS);
+      EXPECT_EQ(rsp.head.type, TAOS_SMSG_SYNC_FWD_RSP);
+      rsps.push_back(rsp);
+    }
+    return rsps;
+  }
+
+  void ack(int32_t index, uint64_t version, int32_t code = 0) {
+    SFwdRsp rsp;
+    syncBuildSyncFwdRsp(&rsp, pNode->vgId, version, code);
+    syncProcessFwdResponse(&rsp, pNode->peerInfo[index]);
+  }
+
+  static std::vector<uint64_t> versions(uint64_t first, uint64_t last) {
+    std::vector<uint64_t> result;
+    for (uint64_t v = first; v <= last; ++v) result.push_back(v);
+    return result;
+  }
+
+  static Confirms confirmed(uint64_t first, uint64_t last, int32_t code = 0) {
+    Confirms result;
+    for (uint64_t v = first; v <= last; ++v) result.push_back(std::make_pair(v, code));
+    return result;
+  }
+
+  static void confirmForward(int32_t vgId, void *mhandle, int32_t code) {
+    confirms.push_back(std::make_pair((uint64_t)mhandle, code));
+  }
+
+  static int32_t writeToCache(int32_t vgId, void *pHead, int32_t qtype, void *pMsg) {
+    writes++;
+    return 0;
+  }
+
+  static Confirms confirms;
+  static int32_t  writes;
+
+  SSyncNode *pNode = NULL;
+  int        fds[TAOS_SYNC_MAX_REPLICA];
+  int32_t    batchSize;
+  int32_t    window;
+};
+
+Confirms SyncFwdTest::confirms;
+int32_t  SyncFwdTest::writes;
+
+}  // namespace
+
+// the forwards of the writes in a queue go out as one batch when the app flushes them, each but the last says more
+// are coming
+TEST_F(SyncFwdTest, coalesceIntoOneBatch) {
+  open(3, 2, TAOS_SYNC_ROLE_MASTER);
+
+  for (uint64_t v = 1; v <= 5; ++v) EXPECT_EQ(forward(v), 1);
+  EXPECT_TRUE(received(1).empty());
+  EXPECT_TRUE(received(2).empty());
+
+  syncFlushNodeFwds(pNode);
+  EXPECT_EQ(receivedBatch(1), versions(1, 5));
+  EXPECT_EQ(receivedBatch(2), versions(1, 5));
+  EXPECT_EQ(pNode->peerInfo[1]->fwdBatches, 1);
+
+  // nothing is left to flush
+  syncFlushNodeFwds(pNode);
+  EXPECT_TRUE(received(1).empty());
+
+  // a batch reaching the batch size is sent without waiting for the flush
+  tsSyncFwdBatchSize = 1024;
+  EXPECT_EQ(forward(6, 500), 1);
+  EXPECT_TRUE(received(1).empty());
+  EXPECT_EQ(forward(7, 500), 1);
+  EXPECT_EQ(receivedBatch(1), versions(6, 7));
+  EXPECT_EQ(receivedBatch(2), versions(6, 7));
+
+  // an app without a sync node flushes nothing
+  syncFlushForward(0);
+  EXPECT_TRUE(confirms.empty());
+}
+
+// at most tsSyncFwdWindow batches are in flight to a slave, the forwards added meanwhile wait for an ack
+TEST_F(SyncFwdTest, windowHoldsBatches) {
+  tsSyncFwdWindow = 2;
+  open(3, 2, TAOS_SYNC_ROLE_MASTER);
+
+  for (uint64_t v = 1; v <= 2; ++v) {
+    forward(v);
+    syncFlushNodeFwds(pNode);
+    EXPECT_EQ(receivedBatch(1), versions(v, v));
+    EXPECT_EQ(receivedBatch(2), versions(v, v));
+  }
+
+  forward(3);
+  syncFlushNodeFwds(pNode);
+  forward(4);
+  syncFlushNodeFwds(pNode);
+  EXPECT_TRUE(received(1).empty());
+  EXPECT_TRUE(received(2).empty());
+  EXPECT_EQ(pNode->peerInfo[1]->fwdBatches, 2);
+
+  // the ack of a batch lets the forwards held back go as one batch, to this peer only
+  ack(1, 1);
+  EXPECT_EQ(receivedBatch(1), versions(3, 4));
+  EXPECT_TRUE(received(2).empty());
+  EXPECT_EQ(pNode->peerInfo[1]->fwdBatches, 2);
+
+  // a cumulative ack ends all the batches up to it
+  ack(2, 2);
+  EXPECT_EQ(receivedBatch(2), versions(3, 4));
+  ack(2, 4);
+  EXPECT_EQ(pNode->peerInfo[2]->fwdBatches, 0);
+
+  // the window does not hold back a batch reaching the batch size
+  tsSyncFwdBatchSize = 1024;
+  forward(5, 500);
+  forward(6, 500);
+  EXPECT_EQ(receivedBatch(1), versions(5, 6));
+  EXPECT_EQ(receivedBatch(2), versions(5, 6));
+}
+
+// the timer sends the forwards not flushed by the app, and the ones held back by the window for too long
+TEST_F(SyncFwdTest, timerFlush) {
+  tsSyncFwdWindow = 1;
+  open(2, 2, TAOS_SYNC_ROLE_MASTER);
+  SSyncPeer *pPeer = pNode->peerInfo[1];
+
+  forward(1);
+  forward(2);
+  syncCheckFwdInfos(pNode, pPeer->fwdTime + SYNC_FWD_TIMER - 1);
+  EXPECT_TRUE(received(1).empty());
+  syncCheckFwdInfos(pNode, pPeer->fwdTime + SYNC_FWD_TIMER);
+  EXPECT_EQ(receivedBatch(1), versions(1, 2));
+
+  forward(3);
+  syncFlushNodeFwds(pNode);
+  EXPECT_TRUE(received(1).empty());
+  syncCheckFwdInfos(pNode, pPeer->fwdTime + SYNC_FWD_TIMER);
+  EXPECT_EQ(receivedBatch(1), versions(3, 3));
+  EXPECT_EQ(pPeer->fwdBatches, 2);
+
+  // the forwards in flight are confirmed as they were
+  ack(1, 3);
+  EXPECT_EQ(confirms, confirmed(1, 3));
+  EXPECT_EQ(pPeer->fwdBatches, 0);
+}
+
+// an ack confirms every forward up to its version, each peer counts once toward the quorum
+TEST_F(SyncFwdTest, cumulativeAck) {
+  open(3, 3, TAOS_SYNC_ROLE_MASTER);
+
+  for (uint64_t v = 1; v <= 4; ++v) forward(v);
+  syncFlushNodeFwds(pNode);
+  EXPECT_EQ(receivedBatch(1), versions(1, 4));
+
+  ack(1, 2);
+  ack(1, 2);
+  ack(1, 4);
+  ack(1, 1);
+  EXPECT_TRUE(confirms.empty());
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 4);
+
+  ack(2, 3);
+  EXPECT_EQ(confirms, confirmed(1, 3));
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 1);
+
+  ack(2, 4);
+  EXPECT_EQ(confirms, confirmed(1, 4));
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 0);
+
+  // with a quorum of 2, the first ack confirms
+  confirms.clear();
+  pNode->quorum = 2;
+  for (uint64_t v = 5; v <= 6; ++v) forward(v);
+  syncFlushNodeFwds(pNode);
+  ack(2, 6);
+  EXPECT_EQ(confirms, confirmed(5, 6));
+  ack(1, 6);
+  EXPECT_EQ(confirms, confirmed(5, 6));
+}
+
+// a slave of an older version acks each forward of a batch, an ack of each is counted once
+TEST_F(SyncFwdTest, oldSlaveAcksEach) {
+  open(2, 2, TAOS_SYNC_ROLE_MASTER);
+
+  for (uint64_t v = 1; v <= 3; ++v) forward(v);
+  syncFlushNodeFwds(pNode);
+  EXPECT_EQ(receivedBatch(1), versions(1, 3));
+
+  ack(1, 1);
+  EXPECT_EQ(confirms, confirmed(1, 1));
+  ack(1, 2, TSDB_CODE_SYN_INVALID_VERSION);
+  ack(1, 3);
+
+  Confirms expected = confirmed(1, 1);
+  expected.push_back(std::make_pair(2, TSDB_CODE_SYN_INVALID_VERSION));
+  expected.push_back(std::make_pair(3, 0));
+  EXPECT_EQ(confirms, expected);
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 0);
+}
+
+// a failure reported after a cumulative ack still reaches the forward if it is not confirmed yet
+TEST_F(SyncFwdTest, errorAckAfterCumulativeAck) {
+  open(3, 3, TAOS_SYNC_ROLE_MASTER);
+
+  for (uint64_t v = 1; v <= 3; ++v) forward(v);
+  syncFlushNodeFwds(pNode);
+
+  ack(1, 3);
+  ack(1, 2, TSDB_CODE_SYN_INVALID_VERSION);
+
+  Confirms expected;
+  expected.push_back(std::make_pair(2, TSDB_CODE_SYN_INVALID_VERSION));
+  EXPECT_EQ(confirms, expected);
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 3);
+
+  ack(2, 3);
+  expected.push_back(std::make_pair(1, 0));
+  expected.push_back(std::make_pair(3, 0));
+  EXPECT_EQ(confirms, expected);
+  EXPECT_EQ(pNode->pSyncFwds->fwds, 0);
+
+  // the forward is gone, the failure only restarts the peer
+  ack(1, 1, TSDB_CODE_SYN_INVALID_VERSION);
+  EXPECT_EQ(confirms, expected);
+  EXPECT_EQ(pNode->peerInfo[1]->ackVersion, 3u);
+}
+
+// a slave acks a batch once by its last forward, and each forward of a master not flagging them
+TEST_F(SyncFwdTest, slaveAcksBatch) {
+  open(2, 2, TAOS_SYNC_ROLE_SLAVE);
+  SSyncPeer *pMaster = pNode->pMaster;
+
+  const size_t      msgLen = sizeof(SSyncHead) + sizeof(SWalHead);
+  std::vector<char> buf(3 * msgLen);
+  for (uint64_t v = 1; v <= 3; ++v) {
+    SSyncHead *pSyncHead = (SSyncHead *)(buf.data() + (v - 1) * msgLen);
+    SWalHead * pHead = (SWalHead *)(pSyncHead + 1);
+    pHead->version = v;
+    syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead));
+    if (v < 3) syncSetFwdMore(pSyncHead);
+  }
+
+  for (int32_t i = 0; i < 3; ++i) syncProcessForwardFromPeer(buf.data() + i * msgLen, pMaster);
+  EXPECT_EQ(writes, 3);
+
+  std::vector<SFwdRsp> rsps = receivedRsps(1);
+  ASSERT_EQ(rsps.size(), 1u);
+  EXPECT_EQ(rsps[0].version, 3u);
+  EXPECT_EQ(rsps[0].code, 0);
+
+  for (uint64_t v = 4; v <= 5; ++v) {
+    SSyncHead *pSyncHead = (SSyncHead *)buf.data();
+    SWalHead * pHead = (SWalHead *)(pSyncHead + 1);
+    pHead->version = v;
+    syncBuildSyncFwdMsg(pSyncHead, pNode->vgId, sizeof(SWalHead));
+    syncProcessForwardFromPeer(buf.data(), pMaster);
+  }
+
+  rsps = receivedRsps(1);
+  ASSERT_EQ(rsps.size(), 2u);
+  EXPECT_EQ(rsps[0].version, 4u);
+  EXPECT_EQ(rsps[1].version, 5u);
+}
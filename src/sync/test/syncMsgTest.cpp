@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "os.h"
+#include "taoserror.h"
+#include "tsync.h"
+#include "syncInt.h"
+#include "syncMsg.h"
+
+// the master announces its capabilities in the head of the sync-data msg, other msgs carry none
+TEST(SyncMsgTest, syncDataCaps) {
+  SSyncMsg msg;
+  syncBuildSyncDataMsg(&msg, 2);
+  EXPECT_EQ(syncCheckHead(&msg.head), TSDB_CODE_SUCCESS);
+  EXPECT_EQ(msg.head.type, TAOS_SMSG_SYNC_DATA);
+  EXPECT_TRUE(msg.head.code & TAOS_SYNC_CAP_FILE_DIFF);
+
+  syncBuildSyncReqMsg(&msg, 2);
+  EXPECT_EQ(syncCheckHead(&msg.head), TSDB_CODE_SUCCESS);
+  EXPECT_EQ(msg.head.code, 0);
+
+  // a head changed after the checksum is rejected
+  syncBuildSyncDataMsg(&msg, 2);
+  msg.head.code = 0;
+  EXPECT_EQ(syncCheckHead(&msg.head), TSDB_CODE_SYN_INVALID_CHECKSUM);
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "os.h"
+#include "tglobal.h"
+#include "ttimer.h"
+#include "tsync.h"
+#include "syncInt.h"
+
+namespace {
+
+class SyncRecoveryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    recoveryNum = tsSyncRecoveryNum;
+    ASSERT_EQ(syncInitRecovery(), 0);
+  }
+
+  void TearDown() override {
+    syncCleanUpRecovery();
+    tsSyncRecoveryNum = recoveryNum;
+  }
+
+  static SSyncRecoveryInfo getInfo(int32_t vgId) {
+    SSyncRecoveryInfo info;
+    syncGetRecoveryState(vgId, &info);
+    return info;
+  }
+
+  int32_t recoveryNum;
+};
+
+}  // namespace
+
+TEST_F(SyncRecoveryTest, boundedSlots) {
+  tsSyncRecoveryNum = 2;
+
+  EXPECT_TRUE(syncAcquireRecovery(2, 0, 100, 1000));
+  EXPECT_TRUE(syncAcquireRecovery(3, 0, 100, 1000));
+  EXPECT_FALSE(syncAcquireRecovery(4, 0, 100, 1000));
+
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_START);
+  EXPECT_EQ(getInfo(4).state, TAOS_SYNC_RECOVERY_QUEUED);
+  EXPECT_EQ(getInfo(4).rank, 1);
+
+  // an admitted vnode asking again keeps its slot
+  EXPECT_TRUE(syncAcquireRecovery(2, 0, 100, 1000));
+  EXPECT_FALSE(syncAcquireRecovery(4, 0, 100, 1000));
+
+  syncReleaseRecovery(2);
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_NONE);
+  EXPECT_TRUE(syncAcquireRecovery(4, 0, 100, 1000));
+  EXPECT_EQ(getInfo(4).state, TAOS_SYNC_RECOVERY_START);
+  EXPECT_EQ(getInfo(4).rank, 0);
+}
+
+TEST_F(SyncRecoveryTest, queueOrder) {
+  tsSyncRecoveryNum = 1;
+  ASSERT_TRUE(syncAcquireRecovery(10, 0, 1, 1));
+
+  // lag 100 is in a lower power of 2 than the others, 4100 and 5000 are in the same one
+  EXPECT_FALSE(syncAcquireRecovery(11, 0, 100, 10));
+  EXPECT_FALSE(syncAcquireRecovery(12, 0, 5000, 1000));
+  EXPECT_FALSE(syncAcquireRecovery(13, 0, 5000, 10));
+  EXPECT_FALSE(syncAcquireRecovery(14, 900, 5000, 5));
+
+  EXPECT_EQ(getInfo(14).rank, 1);
+  EXPECT_EQ(getInfo(13).rank, 2);
+  EXPECT_EQ(getInfo(12).rank, 3);
+  EXPECT_EQ(getInfo(11).rank, 4);
+  EXPECT_EQ(getInfo(14).lag, 4100u);
+
+  syncReleaseRecovery(10);
+
+  // only the head of the queue takes the free slot
+  EXPECT_FALSE(syncAcquireRecovery(11, 0, 100, 10));
+  EXPECT_FALSE(syncAcquireRecovery(13, 0, 5000, 10));
+  EXPECT_TRUE(syncAcquireRecovery(14, 900, 5000, 5));
+  EXPECT_EQ(getInfo(13).rank, 1);
+}
+
+TEST_F(SyncRecoveryTest, tieBreak) {
+  tsSyncRecoveryNum = 1;
+  ASSERT_TRUE(syncAcquireRecovery(2, 0, 1, 1));
+
+  // same staleness and size, the lower vgId goes first
+  EXPECT_FALSE(syncAcquireRecovery(9, 0, 300, 10));
+  EXPECT_FALSE(syncAcquireRecovery(7, 0, 300, 10));
+  EXPECT_EQ(getInfo(7).rank, 1);
+  EXPECT_EQ(getInfo(9).rank, 2);
+
+  // a vnode not lagging at all goes last
+  EXPECT_FALSE(syncAcquireRecovery(3, 500, 300, 1));
+  EXPECT_EQ(getInfo(3).lag, 0u);
+  EXPECT_EQ(getInfo(3).rank, 3);
+}
+
+TEST_F(SyncRecoveryTest, expiry) {
+  tsSyncRecoveryNum = 1;
+
+  ASSERT_TRUE(syncAcquireRecovery(2, 0, 100, 1));
+  ASSERT_FALSE(syncAcquireRecovery(3, 0, 100, 1));
+  ASSERT_FALSE(syncAcquireRecovery(4, 0, 100, 1));
+  syncUpdateRecovery(4, TAOS_SYNC_RECOVERY_FILE, 10);
+
+  int64_t now = taosGetTimestampMs();
+
+  syncRemoveExpiredRecoveries(now + 1000);
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_START);
+  EXPECT_EQ(getInfo(3).state, TAOS_SYNC_RECOVERY_QUEUED);
+
+  // a queued vnode which stops asking is dropped first
+  syncRemoveExpiredRecoveries(now + 6000);
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_START);
+  EXPECT_EQ(getInfo(3).state, TAOS_SYNC_RECOVERY_NONE);
+
+  // an admitted vnode which never starts gives its slot back, a running one never expires
+  syncRemoveExpiredRecoveries(now + 11000);
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_NONE);
+  EXPECT_EQ(getInfo(4).state, TAOS_SYNC_RECOVERY_FILE);
+
+  syncRemoveExpiredRecoveries(now + 3600 * 1000);
+  EXPECT_EQ(getInfo(4).state, TAOS_SYNC_RECOVERY_FILE);
+}
+
+TEST_F(SyncRecoveryTest, progress) {
+  tsSyncRecoveryNum = 1;
+
+  ASSERT_TRUE(syncAcquireRecovery(2, 100, 1100, 1));
+  EXPECT_EQ(getInfo(2).lag, 1000u);
+
+  syncUpdateRecovery(2, TAOS_SYNC_RECOVERY_FILE, 100);
+  syncUpdateRecovery(2, TAOS_SYNC_RECOVERY_WAL, 600);
+  EXPECT_EQ(getInfo(2).state, TAOS_SYNC_RECOVERY_WAL);
+  EXPECT_EQ(getInfo(2).lag, 500u);
+
+  syncUpdateRecovery(2, TAOS_SYNC_RECOVERY_CACHE, 1200);
+  EXPECT_EQ(getInfo(2).lag, 0u);
+
+  // a restore which starts after its entry expired takes a slot anyway
+  syncUpdateRecovery(5, TAOS_SYNC_RECOVERY_FILE, 100);
+  EXPECT_EQ(getInfo(5).state, TAOS_SYNC_RECOVERY_FILE);
+  EXPECT_FALSE(syncAcquireRecovery(6, 0, 100, 1));
+
+  syncReleaseRecovery(2);
+  EXPECT_FALSE(syncAcquireRecovery(6, 0, 100, 1));
+  syncReleaseRecovery(5);
+  EXPECT_TRUE(syncAcquireRecovery(6, 0, 100, 1));
+}
+
+TEST_F(SyncRecoveryTest, rateShare) {
+  tsSyncRecoveryNum = 4;
+  EXPECT_EQ(syncGetRecoveryRate(0), 0);
+  EXPECT_EQ(syncGetRecoveryRate(-1), 0);
+  EXPECT_EQ(syncGetRecoveryRate(10), 2);
+  EXPECT_EQ(syncGetRecoveryRate(3), 1);
+  EXPECT_EQ(syncGetRecoveryRate(4000), 1000);
+
+  tsSyncRecoveryNum = 1;
+  EXPECT_EQ(syncGetRecoveryRate(4000), 4000);
+
+  tsSyncRecoveryNum = 0;
+  EXPECT_EQ(syncGetRecoveryRate(7), 7);
+}
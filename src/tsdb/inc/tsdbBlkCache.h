@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_BLK_CACHE_H_
+#define _TD_TSDB_BLK_CACHE_H_
+
+// LRU cache of decompressed block columns of a vnode, keyed by (file, block offset, column id). Files are never
+// rewritten under the same name, so an entry never goes stale; the entries of removed files just age out.
+typedef struct {
+  pthread_mutex_t mutex;
+  int64_t         capacity;  // bytes
+  int64_t         size;      // bytes of the entries cached
+  int64_t         hits;
+  int64_t         misses;
+  int64_t         evicts;
+  SHashObj*       pEntries;  // key -> SBlkCacheEntry*
+  SList*          lruList;   // SBlkCacheEntry*, the most recently used at head
+} STsdbBlkCache;
+
+STsdbBlkCache* tsdbNewBlkCache(int64_t capacity);
+void           tsdbFreeBlkCache(STsdbBlkCache* pCache);
+void           tsdbClearBlkCache(STsdbBlkCache* pCache);
+bool           tsdbGetBlkCacheCol(STsdbBlkCache* pCache, SDFile* pDFile, int64_t offset, SDataCol* pDataCol,
+                                  int numOfRows, int maxPoints);
+void           tsdbPutBlkCacheCol(STsdbBlkCache* pCache, SDFile* pDFile, int64_t offset, SDataCol* pDataCol);
+void           tsdbGetBlkCacheStat(STsdbBlkCache* pCache, STsdbBlkCacheStat* pStat);
+
+#endif /* _TD_TSDB_BLK_CACHE_H_ */
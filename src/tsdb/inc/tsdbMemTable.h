@@ -31,12 +31,24 @@ typedef struct {
   SSkipListIterator *pIter;
 } SCommitIter;
 
+// Columnar copy of the rows of a table in memtable. It is kept only as long as rows come in strictly increasing key
+// order with one schema version, so its rows are always the same as the leading rows of the skiplist.
+typedef struct {
+  SRWLatch latch;
+  bool     sorted;     // false once an out-of-order, duplicate or deleted key is inserted, the chunks are freed then
+  int      sversion;   // schema version of all the rows
+  int      numOfRows;
+  int64_t  size;       // bytes of the chunks, counted in SMemTable.colBufSize
+  SArray*  aChunk;     // SDataCols*, the capacity doubles from chunk to chunk
+} SMemColBuf;
+
 struct STableData {
-  uint64_t   uid;
-  TSKEY      keyFirst;
-  TSKEY      keyLast;
-  int64_t    numOfRows;
-  SSkipList* pData;
+  uint64_t    uid;
+  TSKEY       keyFirst;
+  TSKEY       keyLast;
+  int64_t     numOfRows;
+  SSkipList*  pData;
+  SMemColBuf* pColBuf;  // NULL if columnarMemTable is disabled
   T_REF_DECLARE()
 };
 
@@ -69,8 +81,16 @@ int   tsdbAsyncCommit(STsdbRepo* pRepo);
 int   tsdbSyncCommitConfig(STsdbRepo* pRepo);
 int   tsdbLoadDataFromCache(STable* pTable, SSkipListIterator* pIter, TSKEY maxKey, int maxRowsToRead, SDataCols* pCols,
                             TKEY* filterKeys, int nFilterKeys, bool keepDup, SMergeInfo* pMergeInfo);
+int   tsdbLoadDataFromColBuf(STableData* pTableData, SSkipListIterator* pIter, TSKEY maxKey, int maxRowsToRead,
+                             SDataCols* pCols, SMergeInfo* pMergeInfo);
+int   tsdbColBufSeek(SMemColBuf* pColBuf, TSKEY key);
+SDataCols* tsdbColBufGetChunk(SMemColBuf* pColBuf, int row, int* pOffset);
 void* tsdbCommitData(STsdbRepo* pRepo);
 
+static FORCE_INLINE bool tsdbColBufSorted(STableData* pTableData) {
+  return pTableData != NULL && pTableData->pColBuf != NULL && pTableData->pColBuf->sorted;
+}
+
 static FORCE_INLINE SMemRow tsdbNextIterRow(SSkipListIterator* pIter) {
   if (pIter == NULL) return NULL;
 
@@ -28,6 +28,7 @@ typedef struct STable {
   STSchema*      tagSchema;
   SKVRow         tagVal;
   SSkipList*     pIndex;         // For TSDB_SUPER_TABLE, it is the skiplist index
+  SArray*        pTagIdx;        // For TSDB_SUPER_TABLE, SArray<STagIndex*> of the other tags, built on demand
   void*          eventHandler;   // TODO
   void*          streamHandler;  // TODO
   TSKEY          lastKey;
@@ -45,6 +46,14 @@ typedef struct STable {
   T_REF_DECLARE()
 } STable;
 
+// Hash index of a tag of a super table. It is built the first time a query filters the tag by equality, and kept up
+// to date under the write lock of meta from then on.
+typedef struct {
+  int16_t   colId;
+  int8_t    type;
+  SHashObj* map;  // tag value -> SBitmap* of the tids of the child tables with the value
+} STagIndex;
+
 typedef struct {
   pthread_rwlock_t rwLock;
 
@@ -89,6 +98,8 @@ int16_t    tsdbGetLastColumnsIndexByColId(STable* pTable, int16_t colId);
 int        tsdbUpdateLastColSchema(STable *pTable, STSchema *pNewSchema);
 STSchema*  tsdbGetTableLatestSchema(STable *pTable);
 void       tsdbFreeLastColumns(STable* pTable);
+STagIndex* tsdbGetTagIndex(STable* pSTable, int16_t colId, bool create);
+SBitmap*   tsdbGetTagIndexTables(STagIndex* pIndex, const void* val);
 
 static FORCE_INLINE int tsdbCompareSchemaVersion(const void *key1, const void *key2) {
   if (*(int16_t *)key1 < schemaVersion(*(STSchema **)key2)) {
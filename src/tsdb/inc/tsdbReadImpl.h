@@ -21,6 +21,7 @@
 #include "os.h"
 #include "tsdbFile.h"
 #include "tskiplist.h"
+#include "tbitmap.h"
 #include "tsdbMeta.h"
 
 typedef struct SReadH SReadH;
@@ -224,6 +225,7 @@ int   tsdbLoadBlockIdx(SReadH *pReadh);
 int   tsdbSetReadTable(SReadH *pReadh, STable *pTable);
 int   tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen);
 int   tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlockInfo);
+int   tsdbLoadSubBlockData(SReadH *pReadh, SBlock *pSubBlock, SDataCols *pDataCols);
 int   tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColsIds);
 int   tsdbLoadBlockStatis(SReadH *pReadh, SBlock *pBlock);
 int   tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock);
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _TD_TSDB_SYNC_H_
+#define _TD_TSDB_SYNC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// one block, or the aggregate part of one block, in a .data/.last/.smad/.smal file
+typedef struct {
+  uint64_t offset;
+  uint32_t len;
+  uint32_t crc;
+  uint32_t hash;
+} SSyncDigest;
+
+// a range of the remote file, either copied from the local file at the same offset or fetched from remote
+typedef struct {
+  uint64_t offset;
+  uint64_t len;
+  bool     local;
+} SSyncRange;
+
+void    tsdbSyncCalcDigest(SSyncDigest *pDigest, const void *pCont);
+int32_t tsdbSyncDiffDFile(void **ppBuf, SDFile *pLDFile, SDFile *pRDFile, SArray *aDigest, SArray *aRange);
+int32_t tsdbSyncMoveBaseFSet(STsdbRepo *pRepo, SDFileSet *pBaseSet, SDFileSet *pLSet, SDFileSet *pSet);
+void    tsdbSyncRestoreBaseFSet(SDFileSet *pBaseSet, SDFileSet *pLSet, bool received);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TD_TSDB_SYNC_H_ */
@@ -39,6 +39,7 @@
 #include "tlist.h"
 #include "hash.h"
 #include "tarray.h"
+#include "tbitmap.h"
 #include "tfs.h"
 #include "tsocket.h"
 
@@ -66,8 +67,12 @@ extern "C" {
 #include "tsdbCommit.h"
 // Compact
 #include "tsdbCompact.h"
+// Sync
+#include "tsdbSync.h"
 // Commit Queue
 #include "tsdbCommitQueue.h"
+// Block Cache
+#include "tsdbBlkCache.h"
 
 #include "tsdbRowMergeBuf.h"
 // Main definitions
@@ -96,6 +101,7 @@ struct STsdbRepo {
   int32_t         code;  // Commit code
 
   SMergeBuf       mergeBuf;  //used when update=2
+  STsdbBlkCache*  pBlkCache; // decompressed block columns, NULL if disabled
   int8_t          compactState;  // compact state: inCompact/noCompact/waitingCompact?
   pthread_t*      pthread;
 };
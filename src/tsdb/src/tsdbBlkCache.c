@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+typedef struct {
+  int64_t offset;  // block offset
+  int32_t colId;
+  char    fname[TSDB_FILENAME_LEN];
+} SBlkCacheKey;
+
+typedef struct {
+  SListNode *pNode;  // node in lruList
+  int32_t    len;    // data length of the column
+  int32_t    keyLen;
+  SBlkCacheKey key;
+  char         data[];
+} SBlkCacheEntry;
+
+#define TSDB_BLK_CACHE_KEY_LEN(k) ((int32_t)(offsetof(SBlkCacheKey, fname) + strlen((k)->fname)))
+#define TSDB_BLK_CACHE_ENTRY_SIZE(e) ((int64_t)sizeof(SBlkCacheEntry) + (e)->len)
+
+static int32_t tsdbInitBlkCacheKey(SBlkCacheKey *pKey, SDFile *pDFile, int64_t offset, int16_t colId);
+static void    tsdbRemoveBlkCacheEntry(STsdbBlkCache *pCache, SBlkCacheEntry *pEntry);
+
+STsdbBlkCache *tsdbNewBlkCache(int64_t capacity) {
+  STsdbBlkCache *pCache = (STsdbBlkCache *)calloc(1, sizeof(*pCache));
+  if (pCache == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  int code = pthread_mutex_init(&(pCache->mutex), NULL);
+  if (code != 0) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    free(pCache);
+    return NULL;
+  }
+
+  pCache->capacity = capacity;
+  pCache->pEntries = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  pCache->lruList = tdListNew(POINTER_BYTES);
+  if (pCache->pEntries == NULL || pCache->lruList == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbFreeBlkCache(pCache);
+    return NULL;
+  }
+
+  return pCache;
+}
+
+void tsdbFreeBlkCache(STsdbBlkCache *pCache) {
+  if (pCache) {
+    if (pCache->lruList) tsdbClearBlkCache(pCache);
+    taosHashCleanup(pCache->pEntries);
+    tdListFree(pCache->lruList);
+    pthread_mutex_destroy(&(pCache->mutex));
+    free(pCache);
+  }
+}
+
+void tsdbClearBlkCache(STsdbBlkCache *pCache) {
+  pthread_mutex_lock(&(pCache->mutex));
+
+  SListNode *pNode = NULL;
+  while ((pNode = tdListPopHead(pCache->lruList)) != NULL) {
+    SBlkCacheEntry *pEntry = NULL;
+    tdListNodeGetData(pCache->lruList, pNode, &pEntry);
+    free(pEntry);
+    listNodeFree(pNode);
+  }
+  taosHashClear(pCache->pEntries);
+  pCache->size = 0;
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+/**
+ * Load the column of the block at offset of the file from cache. On hit the data of pDataCol is set as if it was
+ * just decoded from the file.
+ */
+bool tsdbGetBlkCacheCol(STsdbBlkCache *pCache, SDFile *pDFile, int64_t offset, SDataCol *pDataCol, int numOfRows,
+                        int maxPoints) {
+  SBlkCacheKey key;
+  int32_t      keyLen = tsdbInitBlkCacheKey(&key, pDFile, offset, pDataCol->colId);
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  SBlkCacheEntry **ppEntry = taosHashGet(pCache->pEntries, &key, keyLen);
+  if (ppEntry == NULL) {
+    pCache->misses++;
+    pthread_mutex_unlock(&(pCache->mutex));
+    return false;
+  }
+
+  SBlkCacheEntry *pEntry = *ppEntry;
+  if (tdAllocMemForCol(pDataCol, maxPoints) < 0 || pDataCol->spaceSize < pEntry->len) {
+    pCache->misses++;
+    pthread_mutex_unlock(&(pCache->mutex));
+    return false;
+  }
+
+  memcpy(pDataCol->pData, pEntry->data, pEntry->len);
+  pDataCol->len = pEntry->len;
+
+  tdListPopNode(pCache->lruList, pEntry->pNode);
+  tdListPrependNode(pCache->lruList, pEntry->pNode);
+  pCache->hits++;
+
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  if (IS_VAR_DATA_TYPE(pDataCol->type)) {
+    dataColSetOffset(pDataCol, numOfRows);
+  }
+
+  return true;
+}
+
+// Keep a copy of the column just decoded, evicting the least recently used columns to make room
+void tsdbPutBlkCacheCol(STsdbBlkCache *pCache, SDFile *pDFile, int64_t offset, SDataCol *pDataCol) {
+  // a column larger than 1/8 of the cache would flush too many others out
+  if (((int64_t)sizeof(SBlkCacheEntry) + pDataCol->len) * 8 > pCache->capacity) return;
+
+  SBlkCacheEntry *pEntry = (SBlkCacheEntry *)malloc(sizeof(SBlkCacheEntry) + pDataCol->len);
+  if (pEntry == NULL) return;
+
+  pEntry->keyLen = tsdbInitBlkCacheKey(&(pEntry->key), pDFile, offset, pDataCol->colId);
+  pEntry->len = pDataCol->len;
+  memcpy(pEntry->data, pDataCol->pData, pDataCol->len);
+
+  pthread_mutex_lock(&(pCache->mutex));
+
+  // another query may have loaded the same column meanwhile
+  if (taosHashGet(pCache->pEntries, &(pEntry->key), pEntry->keyLen) != NULL) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  while (pCache->size + TSDB_BLK_CACHE_ENTRY_SIZE(pEntry) > pCache->capacity) {
+    SListNode *pTail = tsListGetTail(pCache->lruList);
+    if (pTail == NULL) break;
+
+    SBlkCacheEntry *pVictim = NULL;
+    tdListNodeGetData(pCache->lruList, pTail, &pVictim);
+    tsdbRemoveBlkCacheEntry(pCache, pVictim);
+    pCache->evicts++;
+  }
+
+  if (tdListPrepend(pCache->lruList, &pEntry) < 0) {
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+  pEntry->pNode = tdListGetHead(pCache->lruList);
+
+  if (taosHashPut(pCache->pEntries, &(pEntry->key), pEntry->keyLen, &pEntry, POINTER_BYTES) < 0) {
+    listNodeFree(tdListPopNode(pCache->lruList, pEntry->pNode));
+    pthread_mutex_unlock(&(pCache->mutex));
+    free(pEntry);
+    return;
+  }
+
+  pCache->size += TSDB_BLK_CACHE_ENTRY_SIZE(pEntry);
+
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+void tsdbGetBlkCacheStat(STsdbBlkCache *pCache, STsdbBlkCacheStat *pStat) {
+  pthread_mutex_lock(&(pCache->mutex));
+  pStat->size = pCache->size;
+  pStat->hits = pCache->hits;
+  pStat->misses = pCache->misses;
+  pStat->evicts = pCache->evicts;
+  pthread_mutex_unlock(&(pCache->mutex));
+}
+
+static int32_t tsdbInitBlkCacheKey(SBlkCacheKey *pKey, SDFile *pDFile, int64_t offset, int16_t colId) {
+  pKey->offset = offset;
+  pKey->colId = colId;
+  tstrncpy(pKey->fname, TSDB_FILE_FULL_NAME(pDFile), TSDB_FILENAME_LEN);
+  return TSDB_BLK_CACHE_KEY_LEN(pKey);
+}
+
+// The caller should hold the mutex
+static void tsdbRemoveBlkCacheEntry(STsdbBlkCache *pCache, SBlkCacheEntry *pEntry) {
+  taosHashRemove(pCache->pEntries, &(pEntry->key), pEntry->keyLen);
+  listNodeFree(tdListPopNode(pCache->lruList, pEntry->pNode));
+  pCache->size -= TSDB_BLK_CACHE_ENTRY_SIZE(pEntry);
+  free(pEntry);
+}
@@ -42,8 +42,26 @@ typedef struct {
   SArray *     aSupBlk;  // Table super-block array
   SArray *     aSubBlk;  // table sub-block array
   SDataCols *  pDataCols;
+  SDataCols *  aSubDCols[TSDB_MAX_SUBBLOCKS];  // sub-blocks of a merged block beyond the two of readh
 } SCommitH;
 
+// A file set to handle in parallel commit, tasks are kept in fid order
+typedef struct {
+  SDFileSet *pSet;    // existing FSET, NULL if a new one is created
+  int        fid;
+  bool       hasMem;  // has memory data to commit, or only retention is applied
+  bool       committed;
+  SDFileSet  wSet;    // FSET written by the worker
+} SCommitFTask;
+
+typedef struct {
+  STsdbRepo *pRepo;
+  SRtn       rtn;
+  SArray *   aTask;  // SCommitFTask array
+  int32_t    nextTask;
+  int32_t    code;
+} SCommitFCtx;
+
 #define TSDB_COMMIT_REPO(ch) TSDB_READ_REPO(&(ch->readh))
 #define TSDB_COMMIT_REPO_ID(ch) REPO_ID(TSDB_READ_REPO(&(ch->readh)))
 #define TSDB_COMMIT_WRITE_FSET(ch) (&((ch)->wSet))
@@ -64,12 +82,15 @@ static int  tsdbUpdateMetaRecord(STsdbFS *pfs, SMFile *pMFile, uint64_t uid, voi
 static int  tsdbDropMetaRecord(STsdbFS *pfs, SMFile *pMFile, uint64_t uid);
 static int  tsdbCompactMetaFile(STsdbRepo *pRepo, STsdbFS *pfs, SMFile *pMFile);
 static int  tsdbCommitTSData(STsdbRepo *pRepo);
+static int  tsdbCommitTSDataParallel(STsdbRepo *pRepo);
+static void *tsdbCommitFSetWorker(void *arg);
 static void tsdbStartCommit(STsdbRepo *pRepo);
 static void tsdbEndCommit(STsdbRepo *pRepo, int eno);
 static int  tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid);
 static int  tsdbCreateCommitIters(SCommitH *pCommith);
 static void tsdbDestroyCommitIters(SCommitH *pCommith);
 static void tsdbSeekCommitIter(SCommitH *pCommith, TSKEY key);
+static int  tsdbResetCommitIters(SCommitH *pCommith, TSKEY key);
 static int  tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo);
 static void tsdbDestroyCommitH(SCommitH *pCommith);
 static int  tsdbGetFidLevel(int fid, SRtn *pRtn);
@@ -82,15 +103,15 @@ static int  tsdbCommitMemData(SCommitH *pCommith, SCommitIter *pIter, TSKEY keyL
 static int  tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx);
 static int  tsdbMoveBlock(SCommitH *pCommith, int bidx);
 static int  tsdbCommitAddBlock(SCommitH *pCommith, const SBlock *pSupBlock, const SBlock *pSubBlocks, int nSubBlocks);
-static int  tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SDataCols *pDataCols, TSKEY keyLimit,
+static int  tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SBlock *pBlock, TSKEY keyLimit,
                                bool isLastOneBlock);
 static void tsdbResetCommitFile(SCommitH *pCommith);
 static void tsdbResetCommitTable(SCommitH *pCommith);
 static int  tsdbSetAndOpenCommitFile(SCommitH *pCommith, SDFileSet *pSet, int fid);
 static void tsdbCloseCommitFile(SCommitH *pCommith, bool hasError);
 static bool tsdbCanAddSubBlock(SCommitH *pCommith, SBlock *pBlock, SMergeInfo *pInfo);
-static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIter *pCommitIter, SDataCols *pTarget,
-                                      TSKEY maxKey, int maxRows, int8_t update);
+static void tsdbLoadAndMergeFromCache(SDataCols **aSubDCols, int *aIters, int nSubBlocks, SCommitIter *pCommitIter,
+                                      SDataCols *pTarget, TSKEY maxKey, int maxRows, int8_t update);
 
 void *tsdbCommitData(STsdbRepo *pRepo) {
   if (pRepo->imem == NULL) {
@@ -617,6 +638,10 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
     return 0;
   }
 
+  if (tsNumOfFSetCommitThreads > 1) {
+    return tsdbCommitTSDataParallel(pRepo);
+  }
+
   // Resource initialization
   if (tsdbInitCommitH(&commith, pRepo) < 0) {
     return -1;
@@ -669,6 +694,11 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
         return -1;
       }
 
+      if (tsdbUpdateDFileSet(REPO_FS(pRepo), &(commith.wSet)) < 0) {
+        tsdbDestroyCommitH(&commith);
+        return -1;
+      }
+
       fid = tsdbNextCommitFid(&commith);
     }
   }
@@ -677,13 +707,202 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
   return 0;
 }
 
+/*
+ * File sets are independent of each other, so they can be committed concurrently. The main thread walks the memory
+ * and disk file sets in fid order to make a task list, a bounded number of workers commit the tasks with memory data,
+ * each with its own commit handle, and the results are added to the new FS status in fid order at the end.
+ */
+static int tsdbCommitTSDataParallel(STsdbRepo *pRepo) {
+  STsdbCfg *  pCfg = REPO_CFG(pRepo);
+  SCommitH    commith;
+  SCommitFCtx ctx;
+  SDFileSet * pSet = NULL;
+  int         fid;
+  int         nCommit = 0;
+  int         code = 0;
+  TSKEY       minKey, maxKey;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.pRepo = pRepo;
+
+  if (tsdbInitCommitH(&commith, pRepo) < 0) {
+    return -1;
+  }
+  ctx.rtn = commith.rtn;
+
+  ctx.aTask = taosArrayInit(16, sizeof(SCommitFTask));
+  if (ctx.aTask == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbDestroyCommitH(&commith);
+    return -1;
+  }
+
+  // Skip expired memory data and expired FSET
+  if (tsdbResetCommitIters(&commith, commith.rtn.minKey) < 0) {
+    taosArrayDestroy(ctx.aTask);
+    tsdbDestroyCommitH(&commith);
+    return -1;
+  }
+  while ((pSet = tsdbFSIterNext(&(commith.fsIter)))) {
+    if (pSet->fid < commith.rtn.minFid) {
+      tsdbInfo("vgId:%d FSET %d on level %d disk id %d expires, remove it", REPO_ID(pRepo), pSet->fid,
+               TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet));
+    } else {
+      break;
+    }
+  }
+
+  // Make the task list, in the same order as the sequential commit
+  fid = tsdbNextCommitFid(&(commith));
+  while (true) {
+    if (pSet == NULL && fid == TSDB_IVLD_FID) break;
+
+    SCommitFTask task = {0};
+    if (pSet && (fid == TSDB_IVLD_FID || pSet->fid < fid)) {
+      task.pSet = pSet;
+      task.fid = pSet->fid;
+      task.hasMem = false;
+      pSet = tsdbFSIterNext(&(commith.fsIter));
+    } else {
+      if (pSet == NULL || pSet->fid > fid) {
+        task.pSet = NULL;
+        task.fid = fid;
+      } else {
+        task.pSet = pSet;
+        task.fid = pSet->fid;
+        pSet = tsdbFSIterNext(&(commith.fsIter));
+      }
+      task.hasMem = true;
+      nCommit++;
+
+      // Jump over the memory data of this fid without walking it
+      tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, task.fid, &minKey, &maxKey);
+      if (tsdbResetCommitIters(&commith, maxKey + 1) < 0) {
+        taosArrayDestroy(ctx.aTask);
+        tsdbDestroyCommitH(&commith);
+        return -1;
+      }
+      fid = tsdbNextCommitFid(&commith);
+    }
+
+    if (taosArrayPush(ctx.aTask, &task) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      taosArrayDestroy(ctx.aTask);
+      tsdbDestroyCommitH(&commith);
+      return -1;
+    }
+  }
+
+  // The planning handle is not needed any more, but the FSET pointers stay valid until the FS txn ends
+  tsdbDestroyCommitH(&commith);
+
+  int ntasks = (int)taosArrayGetSize(ctx.aTask);
+  int nworkers = MIN(tsNumOfFSetCommitThreads, nCommit);
+  tsdbDebug("vgId:%d commit %d FSETs with %d workers, %d FSETs to apply retention", REPO_ID(pRepo), nCommit, nworkers,
+            ntasks - nCommit);
+
+  if (nworkers == 1) {
+    tsdbCommitFSetWorker(&ctx);
+  } else if (nworkers > 1) {
+    pthread_t *threads = (pthread_t *)calloc(nworkers, sizeof(pthread_t));
+    if (threads == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      taosArrayDestroy(ctx.aTask);
+      return -1;
+    }
+
+    int nstarted = 0;
+    for (; nstarted < nworkers; nstarted++) {
+      if (pthread_create(threads + nstarted, NULL, tsdbCommitFSetWorker, &ctx) != 0) {
+        tsdbWarn("vgId:%d failed to create FSET commit worker since %s", REPO_ID(pRepo), strerror(errno));
+        break;
+      }
+    }
+
+    // Commit in the current thread if no worker could be started
+    if (nstarted == 0) tsdbCommitFSetWorker(&ctx);
+
+    for (int i = 0; i < nstarted; i++) {
+      pthread_join(threads[i], NULL);
+    }
+    free(threads);
+  }
+
+  code = ctx.code;
+
+  // Apply the results in fid order. On error the written FSETs are still added, so ending the FS txn with error
+  // removes them from disk.
+  for (int i = 0; i < ntasks; i++) {
+    SCommitFTask *pTask = (SCommitFTask *)taosArrayGet(ctx.aTask, i);
+
+    if (pTask->hasMem) {
+      if (pTask->committed && tsdbUpdateDFileSet(REPO_FS(pRepo), &(pTask->wSet)) < 0) {
+        code = terrno;
+      }
+    } else if (code == 0) {
+      if (tsdbApplyRtnOnFSet(pRepo, pTask->pSet, &(ctx.rtn)) < 0) {
+        code = terrno;
+      }
+    }
+  }
+
+  taosArrayDestroy(ctx.aTask);
+
+  if (code != 0) {
+    terrno = code;
+    return -1;
+  }
+
+  return 0;
+}
+
+static void *tsdbCommitFSetWorker(void *arg) {
+  SCommitFCtx *pCtx = (SCommitFCtx *)arg;
+  STsdbRepo *  pRepo = pCtx->pRepo;
+  STsdbCfg *   pCfg = REPO_CFG(pRepo);
+  SCommitH     commith;
+  TSKEY        minKey, maxKey;
+
+  setThreadName("tsdbCommitFSet");
+
+  if (tsdbInitCommitH(&commith, pRepo) < 0) {
+    atomic_val_compare_exchange_32(&(pCtx->code), 0, terrno);
+    return NULL;
+  }
+  commith.rtn = pCtx->rtn;
+
+  while (atomic_load_32(&(pCtx->code)) == 0) {
+    int idx = atomic_fetch_add_32(&(pCtx->nextTask), 1);
+    if (idx >= taosArrayGetSize(pCtx->aTask)) break;
+
+    SCommitFTask *pTask = (SCommitFTask *)taosArrayGet(pCtx->aTask, idx);
+    if (!pTask->hasMem) continue;
+
+    tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, pTask->fid, &minKey, &maxKey);
+    if (tsdbResetCommitIters(&commith, MAX(minKey, pCtx->rtn.minKey)) < 0 ||
+        tsdbCommitToFile(&commith, pTask->pSet, pTask->fid) < 0) {
+      tsdbError("vgId:%d failed to commit FSET %d since %s", REPO_ID(pRepo), pTask->fid, tstrerror(terrno));
+      atomic_val_compare_exchange_32(&(pCtx->code), 0, terrno);
+      break;
+    }
+
+    pTask->wSet = commith.wSet;
+    pTask->committed = true;
+  }
+
+  tsdbDestroyCommitH(&commith);
+  return NULL;
+}
+
 static void tsdbStartCommit(STsdbRepo *pRepo) {
   SMemTable *pMem = pRepo->imem;
 
   ASSERT(pMem->numOfRows > 0 || listNEles(pMem->actList) > 0);
 
-  tsdbInfo("vgId:%d start to commit! keyFirst %" PRId64 " keyLast %" PRId64 " numOfRows %" PRId64 " meta rows: %d",
-           REPO_ID(pRepo), pMem->keyFirst, pMem->keyLast, pMem->numOfRows, listNEles(pMem->actList));
+  tsdbInfo("vgId:%d start to commit! keyFirst %" PRId64 " keyLast %" PRId64 " numOfRows %" PRId64
+           " meta rows: %d column buffer bytes: %" PRId64,
+           REPO_ID(pRepo), pMem->keyFirst, pMem->keyLast, pMem->numOfRows, listNEles(pMem->actList),
+           pMem->colBufSize);
 
   tsdbStartFSTxn(pRepo, pMem->pointsAdd, pMem->storageAdd);
 
@@ -767,10 +986,6 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
   // Close commit file
   tsdbCloseCommitFile(pCommith, false);
 
-  if (tsdbUpdateDFileSet(REPO_FS(pRepo), &(pCommith->wSet)) < 0) {
-    return -1;
-  }
-
   return 0;
 }
 
@@ -838,6 +1053,28 @@ static void tsdbSeekCommitIter(SCommitH *pCommith, TSKEY key) {
   }
 }
 
+// Position the iterators at the first key not less than key, without walking the keys before it
+static int tsdbResetCommitIters(SCommitH *pCommith, TSKEY key) {
+  SMemTable *pMem = TSDB_COMMIT_REPO(pCommith)->imem;
+
+  for (int i = 0; i < pCommith->niters; i++) {
+    SCommitIter *pIter = pCommith->iters + i;
+    if (pIter->pTable == NULL || pIter->pIter == NULL) continue;
+
+    tSkipListDestroyIter(pIter->pIter);
+    pIter->pIter = tSkipListCreateIterFromVal(pMem->tData[i]->pData, (const char *)(&key), TSDB_DATA_TYPE_TIMESTAMP,
+                                              TSDB_ORDER_ASC);
+    if (pIter->pIter == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    tSkipListIterNext(pIter->pIter);
+  }
+
+  return 0;
+}
+
 static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
   STsdbCfg *pCfg = REPO_CFG(pRepo);
 
@@ -891,6 +1128,9 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
 }
 
 static void tsdbDestroyCommitH(SCommitH *pCommith) {
+  for (int i = 0; i < TSDB_MAX_SUBBLOCKS; i++) {
+    pCommith->aSubDCols[i] = tdFreeDataCols(pCommith->aSubDCols[i]);
+  }
   pCommith->pDataCols = tdFreeDataCols(pCommith->pDataCols);
   pCommith->aSubBlk = taosArrayDestroy(pCommith->aSubBlk);
   pCommith->aSupBlk = taosArrayDestroy(pCommith->aSupBlk);
@@ -1260,10 +1500,15 @@ static int tsdbCommitMemData(SCommitH *pCommith, SCommitIter *pIter, TSKEY keyLi
   SDFile *   pDFile;
   bool       isLast;
   SBlock     block;
+  STableData *pTableData = pRepo->imem->tData[TABLE_TID(pIter->pTable)];
 
   while (true) {
-    tsdbLoadDataFromCache(pIter->pTable, pIter->pIter, keyLimit, defaultRows, pCommith->pDataCols, NULL, 0,
-                          pCfg->update, &mInfo);
+    if (tsdbColBufSorted(pTableData)) {
+      tsdbLoadDataFromColBuf(pTableData, pIter->pIter, keyLimit, defaultRows, pCommith->pDataCols, &mInfo);
+    } else {
+      tsdbLoadDataFromCache(pIter->pTable, pIter->pIter, keyLimit, defaultRows, pCommith->pDataCols, NULL, 0,
+                            pCfg->update, &mInfo);
+    }
 
     if (pCommith->pDataCols->numOfRows <= 0) break;
 
@@ -1349,8 +1594,7 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
 
     if (tsdbCommitAddBlock(pCommith, &supBlock, subBlocks, supBlock.numOfSubBlocks) < 0) return -1;
   } else {
-    if (tsdbLoadBlockData(&(pCommith->readh), pBlock, NULL) < 0) return -1;
-    if (tsdbMergeBlockData(pCommith, pIter, pCommith->readh.pDCols[0], keyLimit, bidx == (nBlocks - 1)) < 0) return -1;
+    if (tsdbMergeBlockData(pCommith, pIter, pBlock, keyLimit, bidx == (nBlocks - 1)) < 0) return -1;
   }
 
   return 0;
@@ -1409,17 +1653,50 @@ static int tsdbCommitAddBlock(SCommitH *pCommith, const SBlock *pSupBlock, const
   return 0;
 }
 
-static int tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SDataCols *pDataCols, TSKEY keyLimit, bool isLastOneBlock) {
+// The SDataCols to load the idx-th sub-block of a merged block into. They are kept in the commit handle for all the
+// tables of the commit: the first two are the ones of the read handle, the others are allocated the first time a
+// block has that many sub-blocks.
+static SDataCols *tsdbGetSubBlockDCols(SCommitH *pCommith, int idx) {
+  if (idx < 2) return pCommith->readh.pDCols[idx];
+
+  if (pCommith->aSubDCols[idx] == NULL) {
+    pCommith->aSubDCols[idx] = tdNewDataCols(0, REPO_CFG(TSDB_COMMIT_REPO(pCommith))->maxRowsPerFileBlock);
+  }
+  return pCommith->aSubDCols[idx];
+}
+
+// Merge the block with the memtable rows and write out the result. The sub-blocks are not merged into one SDataCols
+// ahead, but merged together with the memtable rows as they are written out block by block of defaultRows, so only
+// the sub-blocks as they are and one output block are in memory.
+static int tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SBlock *pBlock, TSKEY keyLimit,
+                              bool isLastOneBlock) {
   STsdbRepo *pRepo = TSDB_COMMIT_REPO(pCommith);
   STsdbCfg * pCfg = REPO_CFG(pRepo);
+  STSchema * pSchema = tsdbGetTableSchemaImpl(pIter->pTable, false, false, -1, -1);
+  SDataCols *aSubDCols[TSDB_MAX_SUBBLOCKS] = {0};
+  int        aIters[TSDB_MAX_SUBBLOCKS] = {0};
+  int        nSubBlocks = pBlock->numOfSubBlocks;
+  SBlock *   pSubBlock = pBlock;
   SBlock     block;
   SDFile *   pDFile;
   bool       isLast;
   int32_t    defaultRows = TSDB_COMMIT_DEFAULT_ROWS(pCommith);
 
-  int biter = 0;
+  ASSERT(nSubBlocks > 0 && nSubBlocks <= TSDB_MAX_SUBBLOCKS);
+  if (nSubBlocks > 1) pSubBlock = POINTER_SHIFT(pCommith->readh.pBlkInfo, pBlock->offset);
+
+  for (int i = 0; i < nSubBlocks; i++, pSubBlock++) {
+    aSubDCols[i] = tsdbGetSubBlockDCols(pCommith, i);
+    if (aSubDCols[i] == NULL || tdInitDataCols(aSubDCols[i], pSchema) < 0) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    if (tsdbLoadSubBlockData(&(pCommith->readh), pSubBlock, aSubDCols[i]) < 0) return -1;
+  }
+
   while (true) {
-    tsdbLoadAndMergeFromCache(pCommith->readh.pDCols[0], &biter, pIter, pCommith->pDataCols, keyLimit, defaultRows,
+    tsdbLoadAndMergeFromCache(aSubDCols, aIters, nSubBlocks, pIter, pCommith->pDataCols, keyLimit, defaultRows,
                               pCfg->update);
 
     if (pCommith->pDataCols->numOfRows == 0) break;
@@ -1444,17 +1721,72 @@ static int tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SDataCols
   return 0;
 }
 
-static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIter *pCommitIter, SDataCols *pTarget,
-                                     TSKEY maxKey, int maxRows, int8_t update) {
+static void tsdbSkipSubBlocksRow(SDataCols **aSubDCols, int *aIters, int nSubBlocks, TSKEY key) {
+  for (int i = 0; i < nSubBlocks; i++) {
+    if (aIters[i] < aSubDCols[i]->numOfRows && dataColsKeyAt(aSubDCols[i], aIters[i]) == key) aIters[i]++;
+  }
+}
+
+// Append the row of key merged from the sub-blocks to pTarget without counting it in pTarget->numOfRows, and move
+// the sub-blocks past the key. The sub-blocks are merged from the oldest to the newest as tdMergeDataCols does.
+// Return false if no row is left, as the row is deleted.
+static bool tsdbAppendSubBlocksRow(SDataCols **aSubDCols, int *aIters, int nSubBlocks, TSKEY key, SDataCols *pTarget,
+                                   bool forceSetNull) {
+  int  aSrcs[TSDB_MAX_SUBBLOCKS];
+  int  nSrcs = 0;
+  bool hasRow = false;
+
+  for (int i = 0; i < nSubBlocks; i++) {
+    if (aIters[i] >= aSubDCols[i]->numOfRows || dataColsKeyAt(aSubDCols[i], aIters[i]) != key) continue;
+
+    if (TKEY_IS_DELETED(dataColsTKeyAt(aSubDCols[i], aIters[i])) && hasRow) {
+      nSrcs = 0;
+      hasRow = false;
+    } else {
+      aSrcs[nSrcs++] = i;
+      hasRow = true;
+    }
+  }
+
+  for (int c = 0; hasRow && c < pTarget->numOfCols; c++) {
+    const void *value = NULL;
+
+    for (int j = 0; j < nSrcs; j++) {
+      SDataCol *pCol = aSubDCols[aSrcs[j]]->cols + c;
+      if (j == 0) {
+        value = tdGetColDataOfRow(pCol, aIters[aSrcs[j]]);
+      } else if (pCol->len > 0 && !isNull(pCol->pData, pCol->type)) {
+        value = tdGetColDataOfRow(pCol, aIters[aSrcs[j]]);
+      } else if (forceSetNull) {
+        value = getNullValue(pCol->type);
+      }
+    }
+
+    dataColAppendVal(pTarget->cols + c, value, pTarget->numOfRows, pTarget->maxPoints, 0);
+  }
+
+  tsdbSkipSubBlocksRow(aSubDCols, aIters, nSubBlocks, key);
+  return hasRow;
+}
+
+static void tsdbLoadAndMergeFromCache(SDataCols **aSubDCols, int *aIters, int nSubBlocks, SCommitIter *pCommitIter,
+                                      SDataCols *pTarget, TSKEY maxKey, int maxRows, int8_t update) {
   TSKEY     key1 = INT64_MAX;
   TSKEY     key2 = INT64_MAX;
   STSchema *pSchema = NULL;
 
-  ASSERT(maxRows > 0 && dataColsKeyLast(pDataCols) <= maxKey);
+  ASSERT(maxRows > 0);
   tdResetDataCols(pTarget);
 
   while (true) {
-    key1 = (*iter >= pDataCols->numOfRows) ? INT64_MAX : dataColsKeyAt(pDataCols, *iter);
+    key1 = INT64_MAX;
+    for (int i = 0; i < nSubBlocks; i++) {
+      if (aIters[i] < aSubDCols[i]->numOfRows) {
+        ASSERT(dataColsKeyAt(aSubDCols[i], aIters[i]) <= maxKey);
+        key1 = MIN(key1, dataColsKeyAt(aSubDCols[i], aIters[i]));
+      }
+    }
+
     SMemRow row = tsdbNextIterRow(pCommitIter->pIter);
     if (row == NULL || memRowKey(row) > maxKey) {
       key2 = INT64_MAX;
@@ -1465,36 +1797,24 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
     if (key1 == INT64_MAX && key2 == INT64_MAX) break;
 
     if (key1 < key2) {
-      for (int i = 0; i < pDataCols->numOfCols; i++) {
-        //TODO: dataColAppendVal may fail
-        dataColAppendVal(pTarget->cols + i, tdGetColDataOfRow(pDataCols->cols + i, *iter), pTarget->numOfRows,
-                         pTarget->maxPoints, 0);
+      if (tsdbAppendSubBlocksRow(aSubDCols, aIters, nSubBlocks, key1, pTarget, update != TD_ROW_PARTIAL_UPDATE)) {
+        pTarget->numOfRows++;
       }
-
-      pTarget->numOfRows++;
-      (*iter)++;
-    } else if (key1 > key2) {
-      if (pSchema == NULL || schemaVersion(pSchema) != memRowVersion(row)) {
-        pSchema =
-            tsdbGetTableSchemaImpl(pCommitIter->pTable, false, false, memRowVersion(row), (int8_t)memRowType(row));
-        ASSERT(pSchema != NULL);
-      }
-
-      tdAppendMemRowToDataCol(row, pSchema, pTarget, true, 0);
-
-      tSkipListIterNext(pCommitIter->pIter);
     } else {
-      if (update != TD_ROW_OVERWRITE_UPDATE) {
-        //copy disk data
-        for (int i = 0; i < pDataCols->numOfCols; i++) {
-          //TODO: dataColAppendVal may fail
-          dataColAppendVal(pTarget->cols + i, tdGetColDataOfRow(pDataCols->cols + i, *iter), pTarget->numOfRows,
-                           pTarget->maxPoints, 0);
+      bool hasRow = false;
+      if (key1 == key2) {
+        if (update == TD_ROW_OVERWRITE_UPDATE) {
+          tsdbSkipSubBlocksRow(aSubDCols, aIters, nSubBlocks, key1);
+        } else {
+          //copy disk data
+          hasRow =
+              tsdbAppendSubBlocksRow(aSubDCols, aIters, nSubBlocks, key1, pTarget, update != TD_ROW_PARTIAL_UPDATE);
         }
-
-        if(update == TD_ROW_DISCARD_UPDATE) pTarget->numOfRows++;
       }
-      if (update != TD_ROW_DISCARD_UPDATE) {
+
+      if (hasRow && update == TD_ROW_DISCARD_UPDATE) {
+        pTarget->numOfRows++;
+      } else {
         //copy mem data
         if (pSchema == NULL || schemaVersion(pSchema) != memRowVersion(row)) {
           pSchema =
@@ -1502,10 +1822,9 @@ static void tsdbLoadAndMergeFromCache(SDataCols *pDataCols, int *iter, SCommitIt
           ASSERT(pSchema != NULL);
         }
 
-        tdAppendMemRowToDataCol(row, pSchema, pTarget, update == TD_ROW_OVERWRITE_UPDATE,
-                                update != TD_ROW_PARTIAL_UPDATE ? 0 : -1);
+        tdAppendMemRowToDataCol(row, pSchema, pTarget, !hasRow, hasRow ? -1 : 0);
       }
-      (*iter)++;
+
       tSkipListIterNext(pCommitIter->pIter);
     }
 
@@ -223,6 +223,35 @@ void tsdbReportStat(void *repo, int64_t *totalPoints, int64_t *totalStorage, int
   *compStorage = pRepo->stat.compStorage;
 }
 
+int64_t tsdbGetDataSize(STsdbRepo *repo) {
+  STsdbFS *  pfs = REPO_FS(repo);
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+  int64_t    size = 0;
+
+  if (tsdbRLockFS(pfs) < 0) return 0;
+
+  tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter))) {
+    for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+      size += TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pSet, ftype))->size;
+    }
+  }
+
+  tsdbUnLockFS(pfs);
+  return size;
+}
+
+void tsdbReportBlkCacheStat(void *repo, STsdbBlkCacheStat *pStat) {
+  ASSERT(repo != NULL);
+  STsdbRepo *pRepo = repo;
+  if (pRepo->pBlkCache == NULL) {
+    memset(pStat, 0, sizeof(*pStat));
+  } else {
+    tsdbGetBlkCacheStat(pRepo->pBlkCache, pStat);
+  }
+}
+
 int32_t tsdbConfigRepo(STsdbRepo *repo, STsdbCfg *pCfg) {
   // TODO: think about multithread cases
   if (tsdbCheckAndSetDefaultCfg(pCfg) < 0) return -1;
@@ -607,11 +636,21 @@ static STsdbRepo *tsdbNewRepo(STsdbCfg *pCfg, STsdbAppH *pAppH) {
     return NULL;
   }
 
+  if (tsBlockCacheSize > 0) {
+    pRepo->pBlkCache = tsdbNewBlkCache((int64_t)tsBlockCacheSize * 1024 * 1024);
+    if (pRepo->pBlkCache == NULL) {
+      tsdbError("vgId:%d failed to create block cache since %s", REPO_ID(pRepo), tstrerror(terrno));
+      tsdbFreeRepo(pRepo);
+      return NULL;
+    }
+  }
+
   return pRepo;
 }
 
 static void tsdbFreeRepo(STsdbRepo *pRepo) {
   if (pRepo) {
+    tsdbFreeBlkCache(pRepo->pBlkCache);
     tsdbFreeFS(pRepo->fs);
     tsdbFreeBufPool(pRepo->pPool);
     tsdbFreeMeta(pRepo->tsdbMeta);
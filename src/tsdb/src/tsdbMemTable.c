@@ -21,6 +21,8 @@
 
 #define TSDB_DATA_SKIPLIST_LEVEL 5
 #define TSDB_MAX_INSERT_BATCH 512
+#define TSDB_COL_BUF_MIN_ROWS 64
+#define TSDB_COL_BUF_MAX_ROWS 4096
 
 typedef struct {
   int32_t  totalLen;
@@ -38,6 +40,12 @@ static SMemTable *  tsdbNewMemTable(STsdbRepo *pRepo);
 static void         tsdbFreeMemTable(SMemTable *pMemTable);
 static STableData*  tsdbNewTableData(STsdbCfg *pCfg, STable *pTable);
 static void         tsdbFreeTableData(STableData *pTableData);
+static SMemColBuf * tsdbNewColBuf();
+static void         tsdbFreeColBuf(SMemColBuf *pColBuf);
+static void         tsdbClearColBuf(SMemTable *pMemTable, SMemColBuf *pColBuf);
+static bool         tsdbCanAppendToColBuf(STable *pTable, SMemColBuf *pColBuf, SSubmitBlk *pBlock);
+static void         tsdbAppendToColBuf(STsdbRepo *pRepo, STable *pTable, SMemColBuf *pColBuf, SSubmitBlk *pBlock);
+static void         tsdbAppendColBufRows(SDataCols *pCols, SDataCols *pChunk, int offset, int nRows);
 static char *       tsdbGetTsTupleKey(const void *data);
 static int          tsdbAdjustMemMaxTables(SMemTable *pMemTable, int maxTables);
 static int          tsdbAppendTableRowToCols(STable *pTable, SDataCols *pCols, STSchema **ppSchema, SMemRow row);
@@ -463,6 +471,122 @@ int tsdbLoadDataFromCache(STable *pTable, SSkipListIterator *pIter, TSKEY maxKey
   return 0;
 }
 
+/**
+ * The same as tsdbLoadDataFromCache without filter keys, but copy the rows from the column buffer of the table in
+ * column blocks. The column buffer must be sorted, so there are no duplicate or deleted keys to handle.
+ */
+int tsdbLoadDataFromColBuf(STableData *pTableData, SSkipListIterator *pIter, TSKEY maxKey, int maxRowsToRead,
+                           SDataCols *pCols, SMergeInfo *pMergeInfo) {
+  ASSERT(maxRowsToRead > 0 && pCols != NULL);
+  SMemColBuf *pColBuf = pTableData->pColBuf;
+  SMergeInfo  mInfo;
+
+  if (pMergeInfo == NULL) pMergeInfo = &mInfo;
+
+  memset(pMergeInfo, 0, sizeof(*pMergeInfo));
+  pMergeInfo->keyFirst = INT64_MAX;
+  pMergeInfo->keyLast = INT64_MIN;
+  tdResetDataCols(pCols);
+
+  if (pIter == NULL) return 0;
+
+  SMemRow row = tsdbNextIterRow(pIter);
+  if (row == NULL) return 0;
+
+  taosRLockLatch(&(pColBuf->latch));
+  ASSERT(pColBuf->sorted);
+
+  int maxRows = MIN(maxRowsToRead, pCols->maxPoints);
+  int start = tsdbColBufSeek(pColBuf, memRowKey(row));
+  int end = start;
+
+  while (pCols->numOfRows < maxRows && end < pColBuf->numOfRows) {
+    int        offset = 0;
+    SDataCols *pChunk = tsdbColBufGetChunk(pColBuf, end, &offset);
+    int        nRows = MIN(pChunk->numOfRows - offset, maxRows - pCols->numOfRows);
+
+    if (dataColsKeyAt(pChunk, offset + nRows - 1) > maxKey) {
+      // only part of the rows are in key range
+      int lo = offset, hi = offset + nRows - 1;
+      while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (dataColsKeyAt(pChunk, mid) > maxKey) {
+          hi = mid;
+        } else {
+          lo = mid + 1;
+        }
+      }
+      nRows = lo - offset;
+      if (nRows > 0) tsdbAppendColBufRows(pCols, pChunk, offset, nRows);
+      end += nRows;
+      break;
+    }
+
+    tsdbAppendColBufRows(pCols, pChunk, offset, nRows);
+    end += nRows;
+  }
+
+  // the skiplist holds the same rows in the same order, move it past the rows copied
+  for (int i = start; i < end; i++) {
+    tSkipListIterNext(pIter);
+  }
+
+  taosRUnLockLatch(&(pColBuf->latch));
+
+  if (pCols->numOfRows > 0) {
+    pMergeInfo->rowsInserted = pCols->numOfRows;
+    pMergeInfo->nOperations = pCols->numOfRows;
+    pMergeInfo->keyFirst = dataColsKeyFirst(pCols);
+    pMergeInfo->keyLast = dataColsKeyLast(pCols);
+  }
+
+  return 0;
+}
+
+// Return the index of the first row whose key is not less than key, the caller should hold the latch
+int tsdbColBufSeek(SMemColBuf *pColBuf, TSKEY key) {
+  size_t nChunks = taosArrayGetSize(pColBuf->aChunk);
+  int    row = 0;
+
+  for (size_t i = 0; i < nChunks; i++) {
+    SDataCols *pChunk = *(SDataCols **)taosArrayGet(pColBuf->aChunk, i);
+    if (pChunk->numOfRows == 0 || dataColsKeyLast(pChunk) < key) {
+      row += pChunk->numOfRows;
+      continue;
+    }
+
+    int lo = 0, hi = pChunk->numOfRows - 1;
+    while (lo < hi) {
+      int mid = (lo + hi) / 2;
+      if (dataColsKeyAt(pChunk, mid) >= key) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return row + lo;
+  }
+
+  return row;
+}
+
+// Return the chunk holding the row, and the position of the row in it
+SDataCols *tsdbColBufGetChunk(SMemColBuf *pColBuf, int row, int *pOffset) {
+  size_t nChunks = taosArrayGetSize(pColBuf->aChunk);
+
+  for (size_t i = 0; i < nChunks; i++) {
+    SDataCols *pChunk = *(SDataCols **)taosArrayGet(pColBuf->aChunk, i);
+    if (row < pChunk->numOfRows) {
+      *pOffset = row;
+      return pChunk;
+    }
+    row -= pChunk->numOfRows;
+  }
+
+  ASSERT(false);
+  return NULL;
+}
+
 // ---------------- LOCAL FUNCTIONS ----------------
 static SMemTable* tsdbNewMemTable(STsdbRepo *pRepo) {
   STsdbMeta *pMeta = pRepo->tsdbMeta;
@@ -545,6 +669,16 @@ static STableData *tsdbNewTableData(STsdbCfg *pCfg, STable *pTable) {
     return NULL;
   }
 
+  if (tsColumnarMemTable) {
+    pTableData->pColBuf = tsdbNewColBuf();
+    if (pTableData->pColBuf == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      tSkipListDestroy(pTableData->pData);
+      free(pTableData);
+      return NULL;
+    }
+  }
+
   T_REF_INC(pTableData);
 
   return pTableData;
@@ -555,11 +689,184 @@ static void tsdbFreeTableData(STableData *pTableData) {
     int32_t ref = T_REF_DEC(pTableData);
     if (ref == 0) {
       tSkipListDestroy(pTableData->pData);
+      tsdbFreeColBuf(pTableData->pColBuf);
       free(pTableData);
     }
   }
 }
 
+static SMemColBuf *tsdbNewColBuf() {
+  SMemColBuf *pColBuf = (SMemColBuf *)calloc(1, sizeof(*pColBuf));
+  if (pColBuf == NULL) return NULL;
+
+  pColBuf->aChunk = taosArrayInit(4, sizeof(SDataCols *));
+  if (pColBuf->aChunk == NULL) {
+    free(pColBuf);
+    return NULL;
+  }
+
+  taosInitRWLatch(&(pColBuf->latch));
+  pColBuf->sorted = true;
+  pColBuf->sversion = -1;
+
+  return pColBuf;
+}
+
+static void tsdbFreeColBuf(SMemColBuf *pColBuf) {
+  if (pColBuf) {
+    for (size_t i = 0; i < taosArrayGetSize(pColBuf->aChunk); i++) {
+      tdFreeDataCols(*(SDataCols **)taosArrayGet(pColBuf->aChunk, i));
+    }
+    taosArrayDestroy(pColBuf->aChunk);
+    free(pColBuf);
+  }
+}
+
+// Drop the column copy for good, the caller should hold the write latch
+static void tsdbClearColBuf(SMemTable *pMemTable, SMemColBuf *pColBuf) {
+  pMemTable->colBufSize -= pColBuf->size;
+  pColBuf->size = 0;
+  pColBuf->sorted = false;
+  pColBuf->numOfRows = 0;
+  for (size_t i = 0; i < taosArrayGetSize(pColBuf->aChunk); i++) {
+    tdFreeDataCols(*(SDataCols **)taosArrayGet(pColBuf->aChunk, i));
+  }
+  taosArrayClear(pColBuf->aChunk);
+}
+
+// Check if all rows of the block come after the rows in the column buffer in strictly increasing key order, with the
+// same schema version
+static bool tsdbCanAppendToColBuf(STable *pTable, SMemColBuf *pColBuf, SSubmitBlk *pBlock) {
+  SSubmitBlkIter blkIter = {0};
+  SMemRow        row = NULL;
+  int            sversion = pColBuf->sversion;
+  TSKEY          lastKey = INT64_MIN;
+
+  if (pColBuf->numOfRows > 0) {
+    lastKey = dataColsKeyLast(*(SDataCols **)taosArrayGetLast(pColBuf->aChunk));
+  }
+
+  tsdbInitSubmitBlkIter(pBlock, &blkIter);
+  while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
+    if (memRowDeleted(row) || memRowKey(row) <= lastKey) return false;
+    if (sversion < 0) {
+      STSchema *pSchema = tsdbGetTableSchemaImpl(pTable, false, false, memRowVersion(row), (int8_t)memRowType(row));
+      if (pSchema == NULL || schemaVersion(pSchema) != memRowVersion(row)) return false;
+      sversion = memRowVersion(row);
+    } else if (memRowVersion(row) != sversion) {
+      return false;
+    }
+    lastKey = memRowKey(row);
+  }
+
+  return true;
+}
+
+static SDataCols *tsdbNewColBufChunk(STSchema *pSchema, int maxRows) {
+  SDataCols *pChunk = tdNewDataCols(schemaNCols(pSchema), maxRows);
+  if (pChunk == NULL) return NULL;
+
+  if (tdInitDataCols(pChunk, pSchema) < 0) {
+    tdFreeDataCols(pChunk);
+    return NULL;
+  }
+
+  // allocate all the space at once, so appending a row never fails
+  for (int i = 0; i < pChunk->numOfCols; i++) {
+    if (tdAllocMemForCol(pChunk->cols + i, maxRows) < 0) {
+      tdFreeDataCols(pChunk);
+      return NULL;
+    }
+  }
+
+  return pChunk;
+}
+
+static int64_t tsdbColBufChunkSize(SDataCols *pChunk) {
+  int64_t size = sizeof(SDataCols) + sizeof(SDataCol) * pChunk->maxCols;
+  for (int i = 0; i < pChunk->numOfCols; i++) {
+    size += pChunk->cols[i].spaceSize;
+  }
+  return size;
+}
+
+// Append the rows of the block, which have been inserted into the skiplist, to the column buffer. The column buffers
+// of a memtable take at most as many bytes as the buffer pool, a table needing more drops its own.
+static void tsdbAppendToColBuf(STsdbRepo *pRepo, STable *pTable, SMemColBuf *pColBuf, SSubmitBlk *pBlock) {
+  SMemTable *    pMemTable = pRepo->mem;
+  int64_t        maxSize = (int64_t)pRepo->pPool->bufBlockSize * pRepo->pPool->tBufBlocks;
+  SSubmitBlkIter blkIter = {0};
+  SMemRow        row = NULL;
+  STSchema *     pSchema = NULL;
+  SDataCols *    pChunk = NULL;
+
+  tsdbInitSubmitBlkIter(pBlock, &blkIter);
+  if (blkIter.row == NULL) return;
+
+  pSchema = tsdbGetTableSchemaImpl(pTable, false, false, memRowVersion(blkIter.row), (int8_t)memRowType(blkIter.row));
+  ASSERT(pSchema != NULL);
+
+  taosWLockLatch(&(pColBuf->latch));
+
+  pColBuf->sversion = schemaVersion(pSchema);
+  if (taosArrayGetSize(pColBuf->aChunk) > 0) {
+    pChunk = *(SDataCols **)taosArrayGetLast(pColBuf->aChunk);
+  }
+
+  while ((row = tsdbGetSubmitBlkNext(&blkIter)) != NULL) {
+    if (pChunk == NULL || pChunk->numOfRows >= pChunk->maxPoints) {
+      int maxRows = (pChunk == NULL) ? TSDB_COL_BUF_MIN_ROWS : MIN(pChunk->maxPoints * 2, TSDB_COL_BUF_MAX_ROWS);
+      pChunk = tsdbNewColBufChunk(pSchema, maxRows);
+      if (pChunk != NULL && pMemTable->colBufSize + tsdbColBufChunkSize(pChunk) > maxSize) {
+        tsdbDebug("vgId:%d table %s tid %d uid %" PRIu64 " drop the column buffer of %d rows since memtable column "
+                  "buffers exceed %" PRId64 " bytes",
+                  REPO_ID(pRepo), TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), TABLE_UID(pTable), pColBuf->numOfRows,
+                  maxSize);
+        tdFreeDataCols(pChunk);
+        tsdbClearColBuf(pMemTable, pColBuf);
+        break;
+      }
+
+      if (pChunk == NULL || taosArrayPush(pColBuf->aChunk, &pChunk) == NULL) {
+        // not fatal, the rows are in the skiplist anyway
+        tdFreeDataCols(pChunk);
+        tsdbClearColBuf(pMemTable, pColBuf);
+        break;
+      }
+
+      int64_t size = tsdbColBufChunkSize(pChunk);
+      pColBuf->size += size;
+      pMemTable->colBufSize += size;
+    }
+
+    tdAppendMemRowToDataCol(row, pSchema, pChunk, true, 0);
+    pColBuf->numOfRows++;
+  }
+
+  taosWUnLockLatch(&(pColBuf->latch));
+}
+
+// Copy rows of a chunk to pCols column by column, columns not in the chunk are set to NULL
+static void tsdbAppendColBufRows(SDataCols *pCols, SDataCols *pChunk, int offset, int nRows) {
+  int scol = 0;
+
+  for (int dcol = 0; dcol < pCols->numOfCols; dcol++) {
+    SDataCol *pDataCol = pCols->cols + dcol;
+
+    while (scol < pChunk->numOfCols && pChunk->cols[scol].colId < pDataCol->colId) scol++;
+
+    if (scol < pChunk->numOfCols && pChunk->cols[scol].colId == pDataCol->colId) {
+      dataColAppendRange(pDataCol, pChunk->cols + scol, offset, nRows, pCols->numOfRows, pCols->maxPoints);
+    } else {
+      for (int i = 0; i < nRows; i++) {
+        dataColAppendVal(pDataCol, getNullValue(pDataCol->type), pCols->numOfRows + i, pCols->maxPoints, 0);
+      }
+    }
+  }
+
+  pCols->numOfRows += nRows;
+}
+
 static char *tsdbGetTsTupleKey(const void *data) { return memRowTuple((SMemRow)data); }
 
 static int tsdbAdjustMemMaxTables(SMemTable *pMemTable, int maxTables) {
@@ -814,6 +1121,7 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
     if (pTableData != NULL) {
       taosWLockLatch(&(pMemTable->latch));
       pMemTable->tData[TABLE_TID(pTable)] = NULL;
+      if (pTableData->pColBuf != NULL) pMemTable->colBufSize -= pTableData->pColBuf->size;
       tsdbFreeTableData(pTableData);
       taosWUnLockLatch(&(pMemTable->latch));
     }
@@ -830,6 +1138,21 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
 
   ASSERT((pTableData != NULL) && pTableData->uid == TABLE_UID(pTable));
 
+  // the column buffer is dropped before any out-of-order row gets into the skiplist, so a reader never sees it
+  // holding rows different from the skiplist
+  SMemColBuf *pColBuf = pTableData->pColBuf;
+  bool        colAppend = false;
+  if (pColBuf != NULL && pColBuf->sorted) {
+    colAppend = tsdbCanAppendToColBuf(pTable, pColBuf, pBlock);
+    if (!colAppend) {
+      tsdbDebug("vgId:%d table %s tid %d uid %" PRIu64 " drop the column buffer of %d rows since out-of-order rows",
+                REPO_ID(pRepo), TABLE_CHAR_NAME(pTable), TABLE_TID(pTable), TABLE_UID(pTable), pColBuf->numOfRows);
+      taosWLockLatch(&(pColBuf->latch));
+      tsdbClearColBuf(pMemTable, pColBuf);
+      taosWUnLockLatch(&(pColBuf->latch));
+    }
+  }
+
   SMemRow lastRow = NULL;
   int64_t osize = SL_SIZE(pTableData->pData);
   tsdbSetupSkipListHookFns(pTableData->pData, pRepo, pTable, &points, &lastRow);
@@ -837,6 +1160,16 @@ static int tsdbInsertDataToTable(STsdbRepo* pRepo, SSubmitBlk* pBlock, int32_t *
   int64_t dsize = SL_SIZE(pTableData->pData) - osize;
   (*pAffectedRows) += points;
 
+  if (colAppend) {
+    tsdbAppendToColBuf(pRepo, pTable, pColBuf, pBlock);
+    if (pColBuf->sorted && pColBuf->numOfRows != SL_SIZE(pTableData->pData)) {
+      // some rows did not get into the skiplist, e.g. out of memory
+      taosWLockLatch(&(pColBuf->latch));
+      tsdbClearColBuf(pMemTable, pColBuf);
+      taosWUnLockLatch(&(pColBuf->latch));
+    }
+  }
+
 
   if(lastRow != NULL) {
     TSKEY lastRowKey = memRowKey(lastRow);
@@ -16,6 +16,7 @@
 
 #define TSDB_SUPER_TABLE_SL_LEVEL 5
 #define DEFAULT_TAG_INDEX_COLUMN 0
+#define TSDB_NUM_OF_TAG_INDEXES(t) (((t)->pTagIdx == NULL) ? 0 : taosArrayGetSize((t)->pTagIdx))
 
 static char *  getTagIndexKey(const void *pData);
 static STable *tsdbNewTable();
@@ -25,6 +26,10 @@ static int     tsdbAddTableToMeta(STsdbRepo *pRepo, STable *pTable, bool addIdx,
 static void    tsdbRemoveTableFromMeta(STsdbRepo *pRepo, STable *pTable, bool rmFromIdx, bool lock);
 static int     tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper);
 static int     tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable);
+static STagIndex *tsdbNewTagIndex(STable *pSTable, int16_t colId, int8_t type);
+static void    tsdbFreeTagIndex(STagIndex *pIndex);
+static int     tsdbAddTableIntoTagIndex(STagIndex *pIndex, STable *pTable);
+static void    tsdbRemoveTableFromTagIndex(STagIndex *pIndex, STable *pTable);
 static int     tsdbInitTableCfg(STableCfg *config, ETableType type, uint64_t uid, int32_t tid);
 static int     tsdbTableSetSchema(STableCfg *config, STSchema *pSchema, bool dup);
 static int     tsdbTableSetName(STableCfg *config, char *name, bool dup);
@@ -392,17 +397,24 @@ int tsdbUpdateTableTagValue(STsdbRepo *repo, SUpdateTableTagValMsg *pMsg) {
   // STColumn *pCol = bsearch(&(pMsg->colId), pMsg->data, pMsg->numOfTags, sizeof(STColumn), colIdCompar);
   // ASSERT(pCol != NULL);
 
+  // Tag indexes are built by queries under the read lock of meta, so the write lock is always needed to keep the
+  // index of the tag, if any, in step with the value
+  tsdbWLockRepoMeta(pRepo);
+  STagIndex *pTagIndex = isChangeIndexCol ? NULL : tsdbGetTagIndex(pTable->pSuper, pMsg->colId, false);
   if (isChangeIndexCol) {
-    tsdbWLockRepoMeta(pRepo);
     tsdbRemoveTableFromIndex(pMeta, pTable);
+  } else if (pTagIndex != NULL) {
+    tsdbRemoveTableFromTagIndex(pTagIndex, pTable);
   }
   TSDB_WLOCK_TABLE(pTable);
   tdSetKVRowDataOfCol(&(pTable->tagVal), pMsg->colId, pMsg->type, POINTER_SHIFT(pMsg->data, pMsg->schemaLen));
   TSDB_WUNLOCK_TABLE(pTable);
   if (isChangeIndexCol) {
     tsdbAddTableIntoIndex(pMeta, pTable, false);
-    tsdbUnlockRepoMeta(pRepo);
+  } else if (pTagIndex != NULL) {
+    tsdbAddTableIntoTagIndex(pTagIndex, pTable);
   }
+  tsdbUnlockRepoMeta(pRepo);
 
   // Update on file
   int tlen1 = (pNewSchema) ? tsdbGetTableEncodeSize(TSDB_UPDATE_META, pTable->pSuper) : 0;
@@ -924,6 +936,10 @@ static void tsdbFreeTable(STable *pTable) {
     kvRowFree(pTable->tagVal);
 
     tSkipListDestroy(pTable->pIndex);
+    for (size_t i = 0; i < TSDB_NUM_OF_TAG_INDEXES(pTable); i++) {
+      tsdbFreeTagIndex(taosArrayGetP(pTable->pTagIdx, i));
+    }
+    taosArrayDestroy(pTable->pTagIdx);
     taosTZfree(pTable->lastRow);    
     tfree(pTable->sql);
 
@@ -1056,6 +1072,9 @@ static int tsdbAddTableIntoIndex(STsdbMeta *pMeta, STable *pTable, bool refSuper
   pTable->pSuper = pSTable;
 
   tSkipListPut(pSTable->pIndex, (void *)pTable);
+  for (size_t i = 0; i < TSDB_NUM_OF_TAG_INDEXES(pSTable); i++) {
+    if (tsdbAddTableIntoTagIndex(taosArrayGetP(pSTable->pTagIdx, i), pTable) < 0) return -1;
+  }
 
   if (refSuper) T_REF_INC(pSTable);
   return 0;
@@ -1083,9 +1102,174 @@ static int tsdbRemoveTableFromIndex(STsdbMeta *pMeta, STable *pTable) {
   }
 
   taosArrayDestroy(res);
+
+  for (size_t i = 0; i < TSDB_NUM_OF_TAG_INDEXES(pSTable); i++) {
+    tsdbRemoveTableFromTagIndex(taosArrayGetP(pSTable->pTagIdx, i), pTable);
+  }
   return 0;
 }
 
+/**
+ * Get the hash index of a tag of the super table. The caller should hold the lock of meta. If the index does not
+ * exist and create is set, it is built from the child tables, as long as the tag type can be indexed and the super
+ * table has less than maxTagIndexes indexes.
+ */
+STagIndex *tsdbGetTagIndex(STable *pSTable, int16_t colId, bool create) {
+  STagIndex *pIndex = NULL;
+
+  TSDB_RLOCK_TABLE(pSTable);
+  for (size_t i = 0; i < TSDB_NUM_OF_TAG_INDEXES(pSTable); i++) {
+    STagIndex *p = taosArrayGetP(pSTable->pTagIdx, i);
+    if (p->colId == colId) {
+      pIndex = p;
+      break;
+    }
+  }
+  STColumn *pCol = tdGetColOfID(pSTable->tagSchema, colId);
+  int8_t    type = (pCol != NULL) ? colType(pCol) : TSDB_DATA_TYPE_NULL;
+  size_t    nIndexes = TSDB_NUM_OF_TAG_INDEXES(pSTable);
+  TSDB_RUNLOCK_TABLE(pSTable);
+
+  if (pIndex != NULL || !create) return pIndex;
+
+  // float values equal in comparison may differ in bytes
+  if (pCol == NULL || type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE) return NULL;
+  if ((int32_t)nIndexes >= tsMaxTagIndexes) return NULL;
+
+  // Build it out of the latch, the child tables do not change under the lock of meta
+  STagIndex *pNew = tsdbNewTagIndex(pSTable, colId, type);
+  if (pNew == NULL) return NULL;
+
+  TSDB_WLOCK_TABLE(pSTable);
+  // another query may have built it meanwhile
+  for (size_t i = 0; i < TSDB_NUM_OF_TAG_INDEXES(pSTable); i++) {
+    STagIndex *p = taosArrayGetP(pSTable->pTagIdx, i);
+    if (p->colId == colId) {
+      pIndex = p;
+      break;
+    }
+  }
+  if (pIndex == NULL) {
+    if (pSTable->pTagIdx == NULL) pSTable->pTagIdx = taosArrayInit(4, POINTER_BYTES);
+    if (pSTable->pTagIdx != NULL && taosArrayPush(pSTable->pTagIdx, &pNew) != NULL) {
+      pIndex = pNew;
+      pNew = NULL;
+    }
+  }
+  TSDB_WUNLOCK_TABLE(pSTable);
+
+  tsdbFreeTagIndex(pNew);
+  return pIndex;
+}
+
+// Get the tids of the child tables whose tag is val, NULL if none
+SBitmap *tsdbGetTagIndexTables(STagIndex *pIndex, const void *val) {
+  size_t    len = IS_VAR_DATA_TYPE(pIndex->type) ? varDataTLen(val) : TYPE_BYTES[pIndex->type];
+  SBitmap **ppTids = taosHashGet(pIndex->map, val, len);
+  return (ppTids == NULL) ? NULL : *ppTids;
+}
+
+static STagIndex *tsdbNewTagIndex(STable *pSTable, int16_t colId, int8_t type) {
+  STagIndex *pIndex = (STagIndex *)calloc(1, sizeof(*pIndex));
+  if (pIndex == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pIndex->colId = colId;
+  pIndex->type = type;
+  pIndex->map = taosHashInit(1024, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  if (pIndex->map == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbFreeTagIndex(pIndex);
+    return NULL;
+  }
+
+  SSkipListIterator *pIter = tSkipListCreateIter(pSTable->pIndex);
+  if (pIter == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbFreeTagIndex(pIndex);
+    return NULL;
+  }
+
+  while (tSkipListIterNext(pIter)) {
+    STable *pTable = (STable *)SL_GET_NODE_DATA(tSkipListIterGet(pIter));
+    if (tsdbAddTableIntoTagIndex(pIndex, pTable) < 0) {
+      tSkipListDestroyIter(pIter);
+      tsdbFreeTagIndex(pIndex);
+      return NULL;
+    }
+  }
+
+  tSkipListDestroyIter(pIter);
+
+  tsdbDebug("tag index of column %d of table %s is built, %d values", colId, TABLE_CHAR_NAME(pSTable),
+            taosHashGetSize(pIndex->map));
+  return pIndex;
+}
+
+static void tsdbFreeTagIndex(STagIndex *pIndex) {
+  if (pIndex) {
+    void *p = taosHashIterate(pIndex->map, NULL);
+    while (p) {
+      tBitmapDestroy(*(SBitmap **)p);
+      p = taosHashIterate(pIndex->map, p);
+    }
+    taosHashCleanup(pIndex->map);
+    free(pIndex);
+  }
+}
+
+static void *tsdbGetTagIndexKey(STagIndex *pIndex, STable *pTable, size_t *len) {
+  void *val = tdGetKVRowValOfCol(pTable->tagVal, pIndex->colId);
+  if (val == NULL) {
+    // treat the column as NULL if we cannot find it
+    val = (void *)getNullValue(pIndex->type);
+  }
+
+  *len = IS_VAR_DATA_TYPE(pIndex->type) ? varDataTLen(val) : TYPE_BYTES[pIndex->type];
+  return val;
+}
+
+static int tsdbAddTableIntoTagIndex(STagIndex *pIndex, STable *pTable) {
+  size_t len = 0;
+  void * key = tsdbGetTagIndexKey(pIndex, pTable, &len);
+
+  SBitmap **ppTids = taosHashGet(pIndex->map, key, len);
+  if (ppTids == NULL) {
+    SBitmap *pTids = tBitmapCreate();
+    if (pTids == NULL || taosHashPut(pIndex->map, key, len, &pTids, POINTER_BYTES) < 0) {
+      tBitmapDestroy(pTids);
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+    ppTids = taosHashGet(pIndex->map, key, len);
+  }
+
+  if (tBitmapAdd(*ppTids, (uint32_t)TABLE_TID(pTable)) < 0) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+static void tsdbRemoveTableFromTagIndex(STagIndex *pIndex, STable *pTable) {
+  size_t len = 0;
+  void * key = tsdbGetTagIndexKey(pIndex, pTable, &len);
+
+  SBitmap **ppTids = taosHashGet(pIndex->map, key, len);
+  if (ppTids == NULL) return;
+
+  SBitmap *pTids = *ppTids;
+  tBitmapRemove(pTids, (uint32_t)TABLE_TID(pTable));
+
+  if (tBitmapCardinality(pTids) == 0) {
+    taosHashRemove(pIndex->map, key, len);
+    tBitmapDestroy(pTids);
+  }
+}
+
 static int tsdbInitTableCfg(STableCfg *config, ETableType type, uint64_t uid, int32_t tid) {
   if (type != TSDB_CHILD_TABLE && type != TSDB_NORMAL_TABLE && type != TSDB_STREAM_TABLE) {
     terrno = TSDB_CODE_TDB_INVALID_TABLE_TYPE;
@@ -90,6 +90,8 @@ typedef struct STableCheckInfo {
   bool          initBuf;        // whether to initialize the in-memory skip list iterator or not
   SSkipListIterator* iter;      // mem buffer skip list iterator
   SSkipListIterator* iiter;     // imem buffer skip list iterator
+  STableData*   pMemData;       // table data in mem, iter walks its skiplist
+  STableData*   pIMemData;      // table data in imem, iiter walks its skiplist
 } STableCheckInfo;
 
 typedef struct STableBlockInfo {
@@ -110,6 +112,10 @@ typedef struct SIOCostSummary {
   int64_t checkForNextTime;
   int64_t headFileLoad;
   int64_t headFileLoadTime;
+  int64_t dataBlocks;
+  int64_t lastBlocks;
+  int64_t cacheBlocks;
+  int64_t decompSize;
 } SIOCostSummary;
 
 typedef struct STsdbQueryHandle {
@@ -136,6 +142,7 @@ typedef struct STsdbQueryHandle {
   SFSIter        fileIter;
   SReadH         rhelper;
   STableBlockInfo* pDataBlockInfo;
+  int32_t        prefetchSlot;     // the last block of pDataBlockInfo that has been prefetched
   SDataCols     *pDataCols;        // in order to hold current file data block
   int32_t        allocSize;        // allocated data block size
   SMemRef       *pMemRef;
@@ -169,7 +176,7 @@ static int32_t doGetExternalRow(STsdbQueryHandle* pQueryHandle, int16_t type, SM
 static void*   doFreeColumnInfoData(SArray* pColumnInfoData);
 static void*   destroyTableCheckInfo(SArray* pTableCheckInfo);
 static bool    tsdbGetExternalRow(TsdbQueryHandleT pHandle);
-static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo);
+static int32_t tsdbQueryTableList(STsdbMeta* pMeta, STable* pTable, SArray* pRes, void* filterInfo);
 
 static void tsdbInitDataBlockLoadInfo(SDataBlockLoadInfo* pBlockLoadInfo) {
   pBlockLoadInfo->slot = -1;
@@ -337,6 +344,8 @@ static void resetCheckInfo(STsdbQueryHandle* pQueryHandle) {
     pCheckInfo->iter    = tSkipListDestroyIter(pCheckInfo->iter);
     pCheckInfo->iiter   = tSkipListDestroyIter(pCheckInfo->iiter);
     pCheckInfo->initBuf = false;
+    pCheckInfo->pMemData  = NULL;
+    pCheckInfo->pIMemData = NULL;
 
     if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
       assert(pCheckInfo->lastKey >= pQueryHandle->window.skey);
@@ -719,6 +728,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
       TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
       pCheckInfo->iter =
           tSkipListCreateIterFromVal(pMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->pMemData = pMem;
     }
   }
 
@@ -728,6 +738,7 @@ static bool initTableMemIterator(STsdbQueryHandle* pHandle, STableCheckInfo* pCh
       TKEY tLastKey = keyToTkey(pCheckInfo->lastKey);
       pCheckInfo->iiter =
           tSkipListCreateIterFromVal(pIMem->pData, (const char*)&tLastKey, TSDB_DATA_TYPE_TIMESTAMP, order);
+      pCheckInfo->pIMemData = pIMem;
     }
   }
 
@@ -1010,6 +1021,7 @@ static bool hasMoreDataInCache(STsdbQueryHandle* pHandle) {
     SWAP(win->skey, win->ekey, TSKEY);
   }
 
+  pHandle->cost.cacheBlocks += 1;
   return true;
 }
 
@@ -1207,6 +1219,16 @@ static int32_t doLoadFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBloc
     }
   }
 
+  if (pBlock->last) {
+    pQueryHandle->cost.lastBlocks += 1;
+  } else {
+    pQueryHandle->cost.dataBlocks += 1;
+  }
+
+  for (int32_t i = 0; i < pCols->numOfCols; ++i) {
+    pQueryHandle->cost.decompSize += pCols->cols[i].len;
+  }
+
   int64_t elapsedTime = (taosGetTimestampUs() - st);
   pQueryHandle->cost.blockLoadTime += elapsedTime;
 
@@ -2275,6 +2297,7 @@ static int32_t createDataBlocksInfo(STsdbQueryHandle* pQueryHandle, int32_t numO
 }
 
 static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exists);
+static void    prefetchDataBlocks(STsdbQueryHandle* pQueryHandle);
 
 static int32_t getDataBlockRv(STsdbQueryHandle* pQueryHandle, STableBlockInfo* pNext, bool *exists) {
   int32_t step = ASCENDING_TRAVERSE(pQueryHandle->order)? 1 : -1;
@@ -2294,6 +2317,7 @@ static int32_t getDataBlockRv(STsdbQueryHandle* pQueryHandle, STableBlockInfo* p
       cur->slot += step;
       cur->mixBlock = false;
       cur->blockCompleted = false;
+      prefetchDataBlocks(pQueryHandle);
       pNext = &pQueryHandle->pDataBlockInfo[cur->slot];
     }
   }
@@ -2383,10 +2407,40 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
   cur->slot = ASCENDING_TRAVERSE(pQueryHandle->order)? 0:pQueryHandle->numOfBlocks-1;
   cur->fid = pQueryHandle->pFileGroup->fid;
 
+  pQueryHandle->prefetchSlot = cur->slot;
+  prefetchDataBlocks(pQueryHandle);
+
   STableBlockInfo* pBlockInfo = &pQueryHandle->pDataBlockInfo[cur->slot];
   return getDataBlockRv(pQueryHandle, pBlockInfo, exists);
 }
 
+/*
+ * Keep the OS reading the next tsQueryPrefetchBlocks blocks of the file in background, while the current one is
+ * processed. The whole block is prefetched, since the offsets of its columns are unknown before its head is read.
+ * A block with sub-blocks is skipped, its offset refers to the sub-block list in the head file.
+ */
+static void prefetchDataBlocks(STsdbQueryHandle* pQueryHandle) {
+  if (tsQueryPrefetchBlocks <= 0) return;
+
+  SQueryFilePos* cur = &pQueryHandle->cur;
+  bool           asc = ASCENDING_TRAVERSE(pQueryHandle->order);
+  int32_t        step = asc ? 1 : -1;
+
+  int32_t end = cur->slot + step * tsQueryPrefetchBlocks;
+  if (end >= pQueryHandle->numOfBlocks) end = pQueryHandle->numOfBlocks - 1;
+  if (end < 0) end = 0;
+
+  for (int32_t slot = pQueryHandle->prefetchSlot + step; asc ? (slot <= end) : (slot >= end); slot += step) {
+    SBlock* pBlock = pQueryHandle->pDataBlockInfo[slot].compBlock;
+    pQueryHandle->prefetchSlot = slot;
+    if (pBlock->numOfSubBlocks > 1) continue;
+
+    SDFile* pDFile = pBlock->last ? TSDB_READ_LAST_FILE(&pQueryHandle->rhelper)
+                                  : TSDB_READ_DATA_FILE(&pQueryHandle->rhelper);
+    taosReadAhead(TSDB_FILE_FD(pDFile), (int64_t)pBlock->offset, pBlock->len);
+  }
+}
+
 static bool isEndFileDataBlock(SQueryFilePos* cur, int32_t numOfBlocks, bool ascTrav) {
   assert(cur != NULL && numOfBlocks > 0);
   return (cur->slot == numOfBlocks - 1 && ascTrav) || (cur->slot == 0 && !ascTrav);
@@ -2401,6 +2455,8 @@ static void moveToNextDataBlockInCurrentFile(STsdbQueryHandle* pQueryHandle) {
   cur->slot += step;
   cur->mixBlock       = false;
   cur->blockCompleted = false;
+
+  prefetchDataBlocks(pQueryHandle);
 }
 
 int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist* pTableBlockInfo) {
@@ -2593,6 +2649,114 @@ static UNUSED_FUNC void changeQueryHandleForInterpQuery(TsdbQueryHandleT pHandle
   taosArrayPush(pQueryHandle->pTableCheckInfo, &info);
 }
 
+/*
+ * Copy the leading rows in ascending order from the column buffer of the table, if only one of mem and imem has rows
+ * left and its column buffer is sorted. The skiplist iterator is moved past the rows copied, so the row by row path
+ * continues with the rest.
+ */
+static int readRowsFromColBuf(STableCheckInfo* pCheckInfo, TSKEY maxKey, int maxRowsToRead, STimeWindow* win,
+                              STsdbQueryHandle* pQueryHandle) {
+  SSkipListIterator* pIter = NULL;
+  STableData*        pTableData = NULL;
+
+  bool memEmpty = (pCheckInfo->iter == NULL) || (tSkipListIterGet(pCheckInfo->iter) == NULL);
+  bool imemEmpty = (pCheckInfo->iiter == NULL) || (tSkipListIterGet(pCheckInfo->iiter) == NULL);
+  if (!memEmpty && imemEmpty) {
+    pIter = pCheckInfo->iter;
+    pTableData = pCheckInfo->pMemData;
+  } else if (memEmpty && !imemEmpty) {
+    pIter = pCheckInfo->iiter;
+    pTableData = pCheckInfo->pIMemData;
+  } else {
+    return 0;
+  }
+
+  SMemColBuf* pColBuf = (pTableData == NULL) ? NULL : pTableData->pColBuf;
+  if (pColBuf == NULL) return 0;
+
+  taosRLockLatch(&pColBuf->latch);
+  if (!pColBuf->sorted) {
+    taosRUnLockLatch(&pColBuf->latch);
+    return 0;
+  }
+
+  int32_t numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
+  int     start = tsdbColBufSeek(pColBuf, memRowKey(tsdbNextIterRow(pIter)));
+  int     numOfRows = 0;
+
+  while (numOfRows < maxRowsToRead && start + numOfRows < pColBuf->numOfRows) {
+    int        offset = 0;
+    SDataCols* pChunk = tsdbColBufGetChunk(pColBuf, start + numOfRows, &offset);
+    int        nRows = MIN(pChunk->numOfRows - offset, maxRowsToRead - numOfRows);
+    bool       beyond = false;
+
+    if (dataColsKeyAt(pChunk, offset + nRows - 1) > maxKey) {
+      int lo = offset, hi = offset + nRows - 1;
+      while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (dataColsKeyAt(pChunk, mid) > maxKey) {
+          hi = mid;
+        } else {
+          lo = mid + 1;
+        }
+      }
+      nRows = lo - offset;
+      beyond = true;
+    }
+
+    if (nRows > 0) {
+      for (int32_t i = 0; i < numOfCols; ++i) {
+        SColumnInfoData* pColInfo = taosArrayGet(pQueryHandle->pColumns, i);
+        char*            pData = (char*)pColInfo->pData + numOfRows * pColInfo->info.bytes;
+        SDataCol*        pDataCol = NULL;
+
+        for (int32_t j = 0; j < pChunk->numOfCols; ++j) {
+          if (pChunk->cols[j].colId == pColInfo->info.colId) {
+            pDataCol = pChunk->cols + j;
+            break;
+          }
+        }
+
+        if (pDataCol == NULL || isAllRowsNull(pDataCol)) {
+          setNullN(pData, pColInfo->info.type, pColInfo->info.bytes, nRows);
+        } else if (pColInfo->info.colId == PRIMARYKEY_TIMESTAMP_COL_INDEX) {
+          for (int32_t k = 0; k < nRows; ++k) {
+            ((TSKEY*)pData)[k] = dataColsKeyAt(pChunk, offset + k);
+          }
+        } else if (IS_VAR_DATA_TYPE(pColInfo->info.type)) {
+          for (int32_t k = 0; k < nRows; ++k) {
+            const void* value = tdGetColDataOfRow(pDataCol, offset + k);
+            memcpy(pData + k * pColInfo->info.bytes, value, varDataTLen(value));
+          }
+        } else {
+          memcpy(pData, tdGetColDataOfRow(pDataCol, offset), (size_t)nRows * pColInfo->info.bytes);
+        }
+      }
+
+      if (numOfRows == 0) {
+        win->skey = dataColsKeyAt(pChunk, offset);
+      }
+      win->ekey = dataColsKeyAt(pChunk, offset + nRows - 1);
+      numOfRows += nRows;
+    }
+
+    if (beyond) break;
+  }
+
+  // the skiplist holds the same rows in the same order, as long as the latch is held
+  for (int i = 0; i < numOfRows; ++i) {
+    tSkipListIterNext(pIter);
+  }
+
+  taosRUnLockLatch(&pColBuf->latch);
+
+  if (numOfRows > 0) {
+    pCheckInfo->chosen = (pIter == pCheckInfo->iter) ? CHECKINFO_CHOSEN_MEM : CHECKINFO_CHOSEN_IMEM;
+  }
+
+  return numOfRows;
+}
+
 static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int maxRowsToRead, STimeWindow* win,
                                  STsdbQueryHandle* pQueryHandle) {
   int     numOfRows = 0;
@@ -2605,6 +2769,13 @@ static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int
   int16_t rv = -1;
   STSchema* pSchema = NULL;
 
+  if (ASCENDING_TRAVERSE(pQueryHandle->order)) {
+    numOfRows = readRowsFromColBuf(pCheckInfo, maxKey, maxRowsToRead, win, pQueryHandle);
+    if (numOfRows >= maxRowsToRead) {
+      goto _end;
+    }
+  }
+
   do {
     SMemRow row = getSMemRowInTableMem(pCheckInfo, pQueryHandle->order, pCfg->update, NULL);
     if (row == NULL) {
@@ -2637,6 +2808,7 @@ static int tsdbReadRowsFromCache(STableCheckInfo* pCheckInfo, TSKEY maxKey, int
 
   } while(moveToNextRowInMem(pCheckInfo));
 
+_end:
   assert(numOfRows <= maxRowsToRead);
 
   // if the buffer is not full in case of descending order query, move the data in the front of the buffer
@@ -3689,7 +3861,7 @@ int32_t tsdbQuerySTableByTagCond(STsdbRepo* tsdb, uint64_t uid, TSKEY skey, cons
     goto _error;
   }
 
-  tsdbQueryTableList(pTable, res, filterInfo);
+  tsdbQueryTableList(tsdbGetMeta(tsdb), pTable, res, filterInfo);
 
   filterFreeInfo(filterInfo);
 
@@ -3815,6 +3987,18 @@ static void* destroyTableCheckInfo(SArray* pTableCheckInfo) {
   return NULL;
 }
 
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost* pCost) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  if (pQueryHandle == NULL) {
+    return;
+  }
+
+  pCost->dataBlocks  += pQueryHandle->cost.dataBlocks;
+  pCost->lastBlocks  += pQueryHandle->cost.lastBlocks;
+  pCost->cacheBlocks += pQueryHandle->cost.cacheBlocks;
+  pCost->decompSize  += pQueryHandle->cost.decompSize;
+}
+
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
   if (pQueryHandle == NULL) {
@@ -3847,8 +4031,10 @@ void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
 
   SIOCostSummary* pCost = &pQueryHandle->cost;
 
-  tsdbDebug("%p :io-cost summary: head-file read cnt:%"PRIu64", head-file time:%"PRIu64" us, statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, 0x%"PRIx64,
-      pQueryHandle, pCost->headFileLoad, pCost->headFileLoadTime, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime, pQueryHandle->qId);
+  tsdbDebug("%p :io-cost summary: head-file read cnt:%"PRIu64", head-file time:%"PRIu64" us, statis-info:%"PRId64" us, datablock:%" PRId64" us, check data:%"PRId64" us, "
+      "data blocks:%"PRId64", last blocks:%"PRId64", cache blocks:%"PRId64", decompressed:%"PRId64" bytes, 0x%"PRIx64,
+      pQueryHandle, pCost->headFileLoad, pCost->headFileLoadTime, pCost->statisInfoLoadTime, pCost->blockLoadTime, pCost->checkForNextTime,
+      pCost->dataBlocks, pCost->lastBlocks, pCost->cacheBlocks, pCost->decompSize, pQueryHandle->qId);
 
   tfree(pQueryHandle);
 }
@@ -3972,7 +4158,44 @@ static void queryIndexlessColumn(SSkipList* pSkipList, void* filterInfo, SArray*
 }
 
 
-static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo) {
+static bool tsdbLookupTagIndex(void* param, int16_t colId, const void* val, const SBitmap** ids) {
+  STagIndex* pIndex = tsdbGetTagIndex((STable*)param, colId, true);
+  if (pIndex == NULL) return false;
+
+  *ids = tsdbGetTagIndexTables(pIndex, val);
+  return true;
+}
+
+// The tables in the bitmap are only candidates, as the index key is the raw bytes of the value and the units not
+// resolved by index are not applied
+static void queryTagIndex(STsdbMeta* pMeta, SBitmap* pTids, void* filterInfo, SArray* res) {
+  int8_t*     addToResult = NULL;
+  SBitmapIter iter;
+  uint32_t    tid = 0;
+
+  tBitmapIterInit(&iter, pTids);
+  while (tBitmapIterNext(&iter, &tid)) {
+    STable* pTable = (tid < (uint32_t)pMeta->maxTables) ? pMeta->tables[tid] : NULL;
+    if (pTable == NULL) continue;
+
+    SSkipListNode node = {.pData = pTable};
+
+    filterSetColFieldData(filterInfo, &node, tsdbGetTagDataFromId);
+    bool all = filterExecute(filterInfo, 1, &addToResult, NULL, 0);
+
+    if (all || (addToResult && *addToResult)) {
+      STableKeyInfo info = {.pTable = (void*)pTable, .lastKey = TSKEY_INITIAL_VAL};
+      taosArrayPush(res, &info);
+    }
+  }
+
+  tfree(addToResult);
+
+  tsdbDebug("filter tag index, %" PRIu64 " candidates, %" PRIzu " tables qualified", tBitmapCardinality(pTids),
+            taosArrayGetSize(res));
+}
+
+static int32_t tsdbQueryTableList(STsdbMeta* pMeta, STable* pTable, SArray* pRes, void* filterInfo) {
   STSchema*   pTSSchema = pTable->tagSchema;
   bool indexQuery = false;
   SSkipList *pSkipList = pTable->pIndex;
@@ -3981,6 +4204,17 @@ static int32_t tsdbQueryTableList(STable* pTable, SArray* pRes, void* filterInfo
 
   if (indexQuery) {
     queryIndexedColumn(pSkipList, filterInfo, pRes);
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SBitmap* pTids = NULL;
+  if (tsMaxTagIndexes > 0) {
+    filterGetIndexCandidates(filterInfo, pTable, tsdbLookupTagIndex, &pTids);
+  }
+
+  if (pTids != NULL) {
+    queryTagIndex(pMeta, pTids, filterInfo, pRes);
+    tBitmapDestroy(pTids);
   } else {
     queryIndexlessColumn(pSkipList, filterInfo, pRes);
   }
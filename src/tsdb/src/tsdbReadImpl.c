@@ -396,6 +396,12 @@ int tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo) {
   return 0;
 }
 
+// Load one sub-block into pDataCols without merging it with the others, pDataCols shall be initialized with the
+// schema of the table
+int tsdbLoadSubBlockData(SReadH *pReadh, SBlock *pSubBlock, SDataCols *pDataCols) {
+  return tsdbLoadBlockDataImpl(pReadh, pSubBlock, pDataCols);
+}
+
 int tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColsIds) {
   ASSERT(pBlock->numOfSubBlocks > 0);
   int8_t update = pReadh->pRepo->config.update;
@@ -841,6 +847,11 @@ static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBloc
   STsdbCfg * pCfg = REPO_CFG(pRepo);
   int        tsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
 
+  if (pRepo->pBlkCache != NULL && tsdbGetBlkCacheCol(pRepo->pBlkCache, pDFile, pBlock->offset, pDataCol,
+                                                      pBlock->numOfRows, pCfg->maxRowsPerFileBlock)) {
+    return 0;
+  }
+
   if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), pBlockCol->len) < 0) return -1;
   if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), tsize) < 0) return -1;
 
@@ -874,5 +885,9 @@ static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBloc
     return -1;
   }
 
+  if (pRepo->pBlkCache != NULL) {
+    tsdbPutBlkCacheCol(pRepo->pBlkCache, pDFile, pBlock->offset, pDataCol);
+  }
+
   return 0;
 }
@@ -16,14 +16,25 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "taoserror.h"
+#include "hashfunc.h"
+#include "tsync.h"
 #include "tsdbint.h"
 
+// decision of the receiver on a fileset offered by the sender
+#define TSDB_SYNC_FSET_SKIP 0  // keep the local fileset
+#define TSDB_SYNC_FSET_COPY 1  // copy the files as a whole
+#define TSDB_SYNC_FSET_DIFF 2  // exchange block digests and copy only the ranges not found locally
+
+#define TSDB_SYNC_COPY_STEP (1024 * 1024)
+
 // Sync handle
 typedef struct {
   STsdbRepo *pRepo;
   SRtn       rtn;
   SOCKET     socketFd;
+  int32_t    caps;  // TAOS_SYNC_CAP_XXX of the sender
   void *     pBuf;
+  void *     pBlkBuf;
   bool       mfChanged;
   SMFile *   pmf;
   SMFile     mf;
@@ -39,14 +50,17 @@ static int32_t tsdbSyncSendMeta(SSyncH *pSynch);
 static int32_t tsdbSyncRecvMeta(SSyncH *pSynch);
 static int32_t tsdbSendMetaInfo(SSyncH *pSynch);
 static int32_t tsdbRecvMetaInfo(SSyncH *pSynch);
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend);
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend);
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision);
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision);
 static int32_t tsdbSyncSendDFileSetArray(SSyncH *pSynch);
 static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch);
 static bool    tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2);
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet);
 static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch);
+static int32_t tsdbLoadDFileSetDigests(SSyncH *pSynch, SDFileSet *pSet, SArray *aDigest[]);
+static int32_t tsdbSyncSendDFileDiff(SSyncH *pSynch, SDFile *pDFile, SArray *aDigest);
+static int32_t tsdbSyncRecvDFileDiff(SSyncH *pSynch, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile);
 static int     tsdbReload(STsdbRepo *pRepo, bool isMfChanged);
 
 int32_t tsdbSyncSend(void *tsdb, SOCKET socketFd) {
@@ -78,13 +92,14 @@ _err:
   return -1;
 }
 
-int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
+int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd, int32_t caps) {
   STsdbRepo *pRepo = (STsdbRepo *)tsdb;
   SSyncH synch = {0};
 
   pRepo->state = TSDB_STATE_OK;
 
   tsdbInitSyncH(&synch, pRepo, socketFd);
+  synch.caps = caps;
   tsem_wait(&(pRepo->readyToCommit));
   tsdbStartFSTxn(pRepo, 0, 0);
 
@@ -99,6 +114,8 @@ int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
   }
 
   tsdbEndFSTxn(pRepo);
+  // Files received from the master may reuse the names of local files
+  if (pRepo->pBlkCache) tsdbClearBlkCache(pRepo->pBlkCache);
   tsem_post(&(pRepo->readyToCommit));
   tsdbDestroySyncH(&synch);
 
@@ -109,6 +126,7 @@ int32_t tsdbSyncRecv(void *tsdb, SOCKET socketFd) {
 
 _err:
   tsdbEndFSTxnWithError(REPO_FS(pRepo));
+  if (pRepo->pBlkCache) tsdbClearBlkCache(pRepo->pBlkCache);
   tsem_post(&(pRepo->readyToCommit));
   tsdbDestroySyncH(&synch);
   return -1;
@@ -120,11 +138,14 @@ static void tsdbInitSyncH(SSyncH *pSyncH, STsdbRepo *pRepo, SOCKET socketFd) {
   tsdbGetRtnSnap(pRepo, &(pSyncH->rtn));
 }
 
-static void tsdbDestroySyncH(SSyncH *pSyncH) { taosTZfree(pSyncH->pBuf); }
+static void tsdbDestroySyncH(SSyncH *pSyncH) {
+  taosTZfree(pSyncH->pBuf);
+  taosTZfree(pSyncH->pBlkBuf);
+}
 
 static int32_t tsdbSyncSendMeta(SSyncH *pSynch) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool       toSendMeta = false;
+  uint8_t    toSendMeta = 0;
   SMFile     mf;
 
   // Send meta info to remote
@@ -327,9 +348,8 @@ static int32_t tsdbRecvMetaInfo(SSyncH *pSynch) {
   return 0;
 }
 
-static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
+static int32_t tsdbSendDecision(SSyncH *pSynch, uint8_t decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = toSend;
 
   int32_t writeLen = sizeof(uint8_t);
   int32_t ret = taosWriteMsg(pSynch->socketFd, (void *)(&decision), writeLen);
@@ -342,19 +362,17 @@ static int32_t tsdbSendDecision(SSyncH *pSynch, bool toSend) {
   return 0;
 }
 
-static int32_t tsdbRecvDecision(SSyncH *pSynch, bool *toSend) {
+static int32_t tsdbRecvDecision(SSyncH *pSynch, uint8_t *decision) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  uint8_t    decision = 0;
 
   int32_t readLen = sizeof(uint8_t);
-  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)(&decision), readLen);
+  int32_t ret = taosReadMsg(pSynch->socketFd, (void *)decision, readLen);
   if (ret != readLen) {
     terrno = TAOS_SYSTEM_ERROR(errno);
     tsdbError("vgId:%d, failed to recv decison, ret:%d readLen:%d", REPO_ID(pRepo), ret, readLen);
     return -1;
   }
 
-  *toSend = decision;
   return 0;
 }
 
@@ -423,7 +441,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           return -1;
         }
 
-        if (tsdbSendDecision(pSynch, false) < 0) {
+        if (tsdbSendDecision(pSynch, TSDB_SYNC_FSET_SKIP) < 0) {
           tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
           return -1;
         }
@@ -432,7 +450,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
         int fidLevel = tsdbGetFidLevel(pSynch->pdf->fid, &(pSynch->rtn));
         if (fidLevel < 0) {  // expired fileset
           tsdbInfo("vgId:%d, fileset:%d will be skipped as expired", REPO_ID(pRepo), pSynch->pdf->fid);
-          if (tsdbSendDecision(pSynch, false) < 0) {
+          if (tsdbSendDecision(pSynch, TSDB_SYNC_FSET_SKIP) < 0) {
             tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
             return -1;
           }
@@ -446,13 +464,6 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
           }
           // Next loop
           continue;
-        } else {
-          tsdbInfo("vgId:%d, fileset:%d will be received", REPO_ID(pRepo), pSynch->pdf->fid);
-          // Notify remote to send there file here
-          if (tsdbSendDecision(pSynch, true) < 0) {
-            tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
-            return -1;
-          }
         }
 
         // Create local files and copy from remote
@@ -468,9 +479,29 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
 
         tsdbInitDFileSet(&fset, did, REPO_ID(pRepo), pSynch->pdf->fid, FS_TXN_VERSION(pfs), pSynch->pdf->ver);
 
+        // The local fileset of the same fid usually holds most of the remote blocks already, e.g. when this replica
+        // only missed the last commits, so only the blocks not found locally are copied. A sender not able to diff the
+        // files is asked for the whole fileset.
+        SDFileSet  baseSet;
+        SDFileSet *pBaseSet = NULL;
+        if ((pSynch->caps & TAOS_SYNC_CAP_FILE_DIFF) && pLSet && pLSet->fid == pSynch->pdf->fid && tsdbFSetIsOk(pLSet)) {
+          if (tsdbSyncMoveBaseFSet(pRepo, &baseSet, pLSet, &fset) == 0) {
+            pBaseSet = &baseSet;
+          }
+        }
+
+        uint8_t decision = (pBaseSet != NULL) ? TSDB_SYNC_FSET_DIFF : TSDB_SYNC_FSET_COPY;
+        tsdbInfo("vgId:%d, fileset:%d will be received, decision:%d", REPO_ID(pRepo), pSynch->pdf->fid, decision);
+        // Notify remote to send there file here
+        if (tsdbSendDecision(pSynch, decision) < 0) {
+          tsdbError("vgId:%d, failed to send decision since %s", REPO_ID(pRepo), tstrerror(terrno));
+          return -1;
+        }
+
         // Create new FSET
         if (tsdbCreateDFileSet(&fset, false) < 0) {
           tsdbError("vgId:%d, failed to create fileset since %s", REPO_ID(pRepo), tstrerror(terrno));
+          if (pBaseSet) tsdbSyncRestoreBaseFSet(&baseSet, pLSet, false);
           return -1;
         }
 
@@ -482,14 +513,25 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
                    pDFile->f.aname, pDFile->info.size, pRDFile->info.size);
 
           int64_t writeLen = pRDFile->info.size;
-          int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
-          if (ret != writeLen) {
-            terrno = TAOS_SYSTEM_ERROR(errno);
-            tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
-                      pDFile->f.aname, tstrerror(terrno), ret, writeLen);
-            tsdbCloseDFileSet(&fset);
-            tsdbRemoveDFileSet(&fset);
-            return -1;
+          if (pBaseSet != NULL) {
+            SDFile *pLDFile = (ftype < tsdbGetNFiles(pBaseSet)) ? TSDB_DFILE_IN_SET(pBaseSet, ftype) : NULL;
+            if (tsdbSyncRecvDFileDiff(pSynch, pLDFile, pDFile, pRDFile) < 0) {
+              tsdbError("vgId:%d, failed to recv file:%s since %s", REPO_ID(pRepo), pDFile->f.aname, tstrerror(terrno));
+              tsdbCloseDFileSet(&fset);
+              tsdbRemoveDFileSet(&fset);
+              tsdbSyncRestoreBaseFSet(&baseSet, pLSet, false);
+              return -1;
+            }
+          } else {
+            int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, writeLen);
+            if (ret != writeLen) {
+              terrno = TAOS_SYSTEM_ERROR(errno);
+              tsdbError("vgId:%d, failed to recv file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
+                        pDFile->f.aname, tstrerror(terrno), ret, writeLen);
+              tsdbCloseDFileSet(&fset);
+              tsdbRemoveDFileSet(&fset);
+              return -1;
+            }
           }
 
           // Update new file info
@@ -498,6 +540,7 @@ static int32_t tsdbSyncRecvDFileSetArray(SSyncH *pSynch) {
         }
 
         tsdbCloseDFileSet(&fset);
+        if (pBaseSet) tsdbSyncRestoreBaseFSet(&baseSet, pLSet, true);
         if (tsdbUpdateDFileSet(pfs, &fset) < 0) {
           tsdbInfo("vgId:%d, fileset:%d failed to update since %s", REPO_ID(pRepo), fset.fid, tstrerror(terrno));
           return -1;
@@ -567,7 +610,8 @@ static bool tsdbIsTowFSetSame(SDFileSet *pSet1, SDFileSet *pSet2) {
 
 static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
   STsdbRepo *pRepo = pSynch->pRepo;
-  bool toSend = false;
+  uint8_t    decision = TSDB_SYNC_FSET_SKIP;
+  SArray *   aDigest[TSDB_FILE_MAX] = {0};
 
   // skip expired fileset
   if (pSet && tsdbGetFidLevel(pSet->fid, &(pSynch->rtn)) < 0) {
@@ -586,45 +630,68 @@ static int32_t tsdbSyncSendDFileSet(SSyncH *pSynch, SDFileSet *pSet) {
     return 0;
   }
 
-  if (tsdbRecvDecision(pSynch, &toSend) < 0) {
+  if (tsdbRecvDecision(pSynch, &decision) < 0) {
     tsdbError("vgId:%d, failed to recv decision while send fileset:%d since %s", REPO_ID(pRepo), pSet->fid,
               tstrerror(terrno));
     return -1;
   }
 
-  if (toSend) {
-    tsdbInfo("vgId:%d, fileset:%d will be sent", REPO_ID(pRepo), pSet->fid);
+  if (decision == TSDB_SYNC_FSET_SKIP) {
+    tsdbInfo("vgId:%d, fileset:%d is same, no need to send", REPO_ID(pRepo), pSet->fid);
+    return 0;
+  }
 
-    for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
-      SDFile df = *TSDB_DFILE_IN_SET(pSet, ftype);
-      
-      if (tsdbOpenDFile(&df, O_RDONLY) < 0) {
-        tsdbError("vgId:%d, failed to file:%s since %s", REPO_ID(pRepo), df.f.aname, tstrerror(terrno));
-        return -1;
-      }
+  tsdbInfo("vgId:%d, fileset:%d will be sent, decision:%d", REPO_ID(pRepo), pSet->fid, decision);
+
+  if (decision == TSDB_SYNC_FSET_DIFF && tsdbLoadDFileSetDigests(pSynch, pSet, aDigest) < 0) {
+    tsdbError("vgId:%d, failed to load digests of fileset:%d since %s", REPO_ID(pRepo), pSet->fid, tstrerror(terrno));
+    goto _err;
+  }
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+    SDFile df = *TSDB_DFILE_IN_SET(pSet, ftype);
 
-      int64_t writeLen = df.info.size;
-      tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), df.f.aname, writeLen);
+    if (tsdbOpenDFile(&df, O_RDONLY) < 0) {
+      tsdbError("vgId:%d, failed to file:%s since %s", REPO_ID(pRepo), df.f.aname, tstrerror(terrno));
+      goto _err;
+    }
+
+    int64_t writeLen = df.info.size;
+    tsdbInfo("vgId:%d, file:%s will be sent, size:%" PRId64, REPO_ID(pRepo), df.f.aname, writeLen);
 
+    if (decision == TSDB_SYNC_FSET_DIFF) {
+      if (tsdbSyncSendDFileDiff(pSynch, &df, aDigest[ftype]) < 0) {
+        tsdbError("vgId:%d, failed to send file:%s since %s", REPO_ID(pRepo), df.f.aname, tstrerror(terrno));
+        tsdbCloseDFile(&df);
+        goto _err;
+      }
+    } else {
       int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(&df), 0, writeLen);
       if (ret != writeLen) {
         terrno = TAOS_SYSTEM_ERROR(errno);
         tsdbError("vgId:%d, failed to send file:%s since %s, ret:%" PRId64 " writeLen:%" PRId64, REPO_ID(pRepo),
                   df.f.aname, tstrerror(terrno), ret, writeLen);
         tsdbCloseDFile(&df);
-        return -1;
+        goto _err;
       }
-
-      tsdbInfo("vgId:%d, file:%s is sent", REPO_ID(pRepo), df.f.aname);
-      tsdbCloseDFile(&df);
     }
 
-    tsdbInfo("vgId:%d, fileset:%d is sent", REPO_ID(pRepo), pSet->fid);
-  } else {
-    tsdbInfo("vgId:%d, fileset:%d is same, no need to send", REPO_ID(pRepo), pSet->fid);
+    tsdbInfo("vgId:%d, file:%s is sent", REPO_ID(pRepo), df.f.aname);
+    tsdbCloseDFile(&df);
   }
 
+  tsdbInfo("vgId:%d, fileset:%d is sent", REPO_ID(pRepo), pSet->fid);
+
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    taosArrayDestroy(aDigest[ftype]);
+  }
   return 0;
+
+_err:
+  for (TSDB_FILE_T ftype = 0; ftype < TSDB_FILE_MAX; ftype++) {
+    taosArrayDestroy(aDigest[ftype]);
+  }
+  return -1;
 }
 
 static int32_t tsdbSendDFileSetInfo(SSyncH *pSynch, SDFileSet *pSet) {
@@ -703,6 +770,503 @@ static int32_t tsdbRecvDFileSetInfo(SSyncH *pSynch) {
   return 0;
 }
 
+static int tsdbCompareSyncDigest(const void *a, const void *b) {
+  uint64_t offset1 = ((SSyncDigest *)a)->offset;
+  uint64_t offset2 = ((SSyncDigest *)b)->offset;
+
+  if (offset1 < offset2) return -1;
+  if (offset1 > offset2) return 1;
+  return 0;
+}
+
+static void *tsdbSyncReadBlock(void **ppBuf, SDFile *pDFile, uint64_t offset, uint32_t len) {
+  if (tsdbMakeRoom(ppBuf, len) < 0) return NULL;
+
+  if (tsdbSeekDFile(pDFile, offset, SEEK_SET) < 0) return NULL;
+
+  int64_t nread = tsdbReadDFile(pDFile, *ppBuf, len);
+  if (nread < 0) return NULL;
+  if (nread < len) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    return NULL;
+  }
+
+  return *ppBuf;
+}
+
+void tsdbSyncCalcDigest(SSyncDigest *pDigest, const void *pCont) {
+  pDigest->crc = taosCalcChecksum(0, (const uint8_t *)pCont, pDigest->len);
+  pDigest->hash = MurmurHash3_32((const char *)pCont, pDigest->len);
+}
+
+static int32_t tsdbAddSyncDigest(SArray *aDigest, uint64_t offset, uint32_t len) {
+  SSyncDigest digest = {.offset = offset, .len = len};
+  if (taosArrayPush(aDigest, &digest) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * The digests of a file are the offsets, lengths and checksums of the blocks the head file refers to, sorted by
+ * offset. The file header and the bytes no block refers to are not in the digests and always fetched from remote.
+ */
+static int32_t tsdbLoadDFileSetDigests(SSyncH *pSynch, SDFileSet *pSet, SArray *aDigest[]) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  SReadH     readh;
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+    aDigest[ftype] = taosArrayInit(1024, sizeof(SSyncDigest));
+    if (aDigest[ftype] == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  if (tsdbInitReadH(&readh, pRepo) < 0) return -1;
+
+  if (tsdbSetAndOpenReadFSet(&readh, pSet) < 0 || tsdbLoadBlockIdx(&readh) < 0) {
+    tsdbDestroyReadH(&readh);
+    return -1;
+  }
+
+  bool hasAggr = tsdbGetNFiles(pSet) > TSDB_FILE_SMAL;
+  for (size_t i = 0; i < taosArrayGetSize(readh.aBlkIdx); i++) {
+    uint32_t blkInfoLen = 0;
+
+    readh.pBlkIdx = taosArrayGet(readh.aBlkIdx, i);
+    if (tsdbLoadBlockInfo(&readh, NULL, &blkInfoLen) < 0) {
+      tsdbDestroyReadH(&readh);
+      return -1;
+    }
+
+    // super blocks followed by sub-blocks, a super block with sub-blocks has no data of its own
+    size_t nBlocks = (blkInfoLen - sizeof(SBlockInfo)) / sizeof(SBlock);
+    for (size_t j = 0; j < nBlocks; j++) {
+      SBlock *pBlock = readh.pBlkInfo->blocks + j;
+      if (pBlock->numOfSubBlocks > 1) continue;
+
+      if (tsdbAddSyncDigest(aDigest[pBlock->last ? TSDB_FILE_LAST : TSDB_FILE_DATA], pBlock->offset, pBlock->len) <
+          0) {
+        tsdbDestroyReadH(&readh);
+        return -1;
+      }
+
+      if (hasAggr && pBlock->blkVer > TSDB_SBLK_VER_0 && pBlock->aggrStat &&
+          tsdbAddSyncDigest(aDigest[pBlock->last ? TSDB_FILE_SMAL : TSDB_FILE_SMAD], pBlock->aggrOffset,
+                            (uint32_t)tsdbBlockAggrSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer)) < 0) {
+        tsdbDestroyReadH(&readh);
+        return -1;
+      }
+    }
+  }
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+    SArray *pArray = aDigest[ftype];
+    SDFile *pDFile = TSDB_DFILE_IN_SET(TSDB_READ_FSET(&readh), ftype);
+    size_t  nDigests = 0;
+    int64_t end = 0;
+
+    taosArraySort(pArray, tsdbCompareSyncDigest);
+    for (size_t i = 0; i < taosArrayGetSize(pArray); i++) {
+      SSyncDigest *pDigest = taosArrayGet(pArray, i);
+
+      // skip the blocks out of the file or overlapped with the previous one
+      if (pDigest->offset < end || pDigest->offset + pDigest->len > pDFile->info.size) continue;
+
+      void *pCont = tsdbSyncReadBlock(&(pSynch->pBlkBuf), pDFile, pDigest->offset, pDigest->len);
+      if (pCont == NULL) {
+        tsdbError("vgId:%d, failed to read block of file:%s at offset:%" PRIu64 " since %s", REPO_ID(pRepo),
+                  TSDB_FILE_FULL_NAME(pDFile), pDigest->offset, tstrerror(terrno));
+        tsdbDestroyReadH(&readh);
+        return -1;
+      }
+
+      tsdbSyncCalcDigest(pDigest, pCont);
+      end = pDigest->offset + pDigest->len;
+      *(SSyncDigest *)taosArrayGet(pArray, nDigests++) = *pDigest;
+    }
+    taosArraySetSize(pArray, nDigests);
+  }
+
+  tsdbDestroyReadH(&readh);
+  return 0;
+}
+
+// send the tlen - sizeof(TSCKSUM) bytes encoded after the length field of the sync buffer with a checksum
+static int32_t tsdbSyncSendMsg(SSyncH *pSynch, uint32_t tlen) {
+  void *ptr = SYNC_BUFFER(pSynch);
+  taosEncodeFixedU32(&ptr, tlen);
+  taosCalcChecksumAppend(0, (uint8_t *)ptr, tlen);
+
+  int32_t writeLen = tlen + sizeof(uint32_t);
+  int32_t ret = taosWriteMsg(pSynch->socketFd, SYNC_BUFFER(pSynch), writeLen);
+  if (ret != writeLen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to send sync msg, ret:%d writeLen:%d", REPO_ID(pSynch->pRepo), ret, writeLen);
+    return -1;
+  }
+
+  return 0;
+}
+
+// receive a message sent by tsdbSyncSendMsg into the sync buffer
+static int32_t tsdbSyncRecvMsg(SSyncH *pSynch, uint32_t *tlen) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  char       buf[sizeof(uint32_t)];
+
+  int32_t ret = taosReadMsg(pSynch->socketFd, buf, sizeof(uint32_t));
+  if (ret != sizeof(uint32_t)) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  taosDecodeFixedU32(buf, tlen);
+  if (*tlen < sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    return -1;
+  }
+
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), *tlen) < 0) return -1;
+
+  ret = taosReadMsg(pSynch->socketFd, SYNC_BUFFER(pSynch), *tlen);
+  if (ret != *tlen) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tsdbError("vgId:%d, failed to recv sync msg, ret:%d readLen:%u", REPO_ID(pRepo), ret, *tlen);
+    return -1;
+  }
+
+  if (!taosCheckChecksumWhole((uint8_t *)SYNC_BUFFER(pSynch), *tlen)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    tsdbError("vgId:%d, failed to checksum while recv sync msg since %s", REPO_ID(pRepo), tstrerror(terrno));
+    return -1;
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncSendDigests(SSyncH *pSynch, SArray *aDigest) {
+  uint32_t nDigests = (aDigest != NULL) ? (uint32_t)taosArrayGetSize(aDigest) : 0;
+  uint32_t tlen = sizeof(uint32_t) + nDigests * (sizeof(uint64_t) + sizeof(uint32_t) * 3) + sizeof(TSCKSUM);
+
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), tlen + sizeof(uint32_t)) < 0) return -1;
+
+  void *ptr = POINTER_SHIFT(SYNC_BUFFER(pSynch), sizeof(uint32_t));
+  taosEncodeFixedU32(&ptr, nDigests);
+  for (uint32_t i = 0; i < nDigests; i++) {
+    SSyncDigest *pDigest = taosArrayGet(aDigest, i);
+    taosEncodeFixedU64(&ptr, pDigest->offset);
+    taosEncodeFixedU32(&ptr, pDigest->len);
+    taosEncodeFixedU32(&ptr, pDigest->crc);
+    taosEncodeFixedU32(&ptr, pDigest->hash);
+  }
+
+  return tsdbSyncSendMsg(pSynch, tlen);
+}
+
+static int32_t tsdbSyncRecvDigests(SSyncH *pSynch, SArray *aDigest) {
+  uint32_t tlen = 0;
+  uint32_t nDigests = 0;
+
+  if (tsdbSyncRecvMsg(pSynch, &tlen) < 0) return -1;
+
+  void *ptr = taosDecodeFixedU32(SYNC_BUFFER(pSynch), &nDigests);
+  if (tlen != sizeof(uint32_t) + nDigests * (sizeof(uint64_t) + sizeof(uint32_t) * 3) + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < nDigests; i++) {
+    SSyncDigest digest;
+    ptr = taosDecodeFixedU64(ptr, &digest.offset);
+    ptr = taosDecodeFixedU32(ptr, &digest.len);
+    ptr = taosDecodeFixedU32(ptr, &digest.crc);
+    ptr = taosDecodeFixedU32(ptr, &digest.hash);
+    if (taosArrayPush(aDigest, &digest) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+// only the ranges to fetch from remote are sent
+static int32_t tsdbSyncSendRanges(SSyncH *pSynch, SArray *aRange) {
+  uint32_t nRanges = 0;
+  for (size_t i = 0; i < taosArrayGetSize(aRange); i++) {
+    if (!((SSyncRange *)taosArrayGet(aRange, i))->local) nRanges++;
+  }
+
+  uint32_t tlen = sizeof(uint32_t) + nRanges * sizeof(uint64_t) * 2 + sizeof(TSCKSUM);
+  if (tsdbMakeRoom((void **)(&SYNC_BUFFER(pSynch)), tlen + sizeof(uint32_t)) < 0) return -1;
+
+  void *ptr = POINTER_SHIFT(SYNC_BUFFER(pSynch), sizeof(uint32_t));
+  taosEncodeFixedU32(&ptr, nRanges);
+  for (size_t i = 0; i < taosArrayGetSize(aRange); i++) {
+    SSyncRange *pRange = taosArrayGet(aRange, i);
+    if (pRange->local) continue;
+    taosEncodeFixedU64(&ptr, pRange->offset);
+    taosEncodeFixedU64(&ptr, pRange->len);
+  }
+
+  return tsdbSyncSendMsg(pSynch, tlen);
+}
+
+static int32_t tsdbSyncRecvRanges(SSyncH *pSynch, SArray *aRange) {
+  uint32_t tlen = 0;
+  uint32_t nRanges = 0;
+
+  if (tsdbSyncRecvMsg(pSynch, &tlen) < 0) return -1;
+
+  void *ptr = taosDecodeFixedU32(SYNC_BUFFER(pSynch), &nRanges);
+  if (tlen != sizeof(uint32_t) + nRanges * sizeof(uint64_t) * 2 + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_MESSED_MSG;
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < nRanges; i++) {
+    SSyncRange range = {.local = false};
+    ptr = taosDecodeFixedU64(ptr, &range.offset);
+    ptr = taosDecodeFixedU64(ptr, &range.len);
+    if (taosArrayPush(aRange, &range) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int32_t tsdbSyncSendDFileDiff(SSyncH *pSynch, SDFile *pDFile, SArray *aDigest) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  SArray *   aRange = NULL;
+  int64_t    sendLen = 0;
+
+  if (tsdbSyncSendDigests(pSynch, aDigest) < 0) return -1;
+
+  aRange = taosArrayInit(64, sizeof(SSyncRange));
+  if (aRange == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  if (tsdbSyncRecvRanges(pSynch, aRange) < 0) {
+    taosArrayDestroy(aRange);
+    return -1;
+  }
+
+  for (size_t i = 0; i < taosArrayGetSize(aRange); i++) {
+    SSyncRange *pRange = taosArrayGet(aRange, i);
+    int64_t     offset = pRange->offset;
+
+    if (pRange->offset + pRange->len > pDFile->info.size) {
+      terrno = TSDB_CODE_TDB_MESSED_MSG;
+      taosArrayDestroy(aRange);
+      return -1;
+    }
+
+    int64_t ret = taosSendFile(pSynch->socketFd, TSDB_FILE_FD(pDFile), &offset, pRange->len);
+    if (ret != pRange->len) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to send range of file:%s, offset:%" PRIu64 " len:%" PRIu64 " ret:%" PRId64,
+                REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile), pRange->offset, pRange->len, ret);
+      taosArrayDestroy(aRange);
+      return -1;
+    }
+    sendLen += ret;
+  }
+
+  tsdbInfo("vgId:%d, file:%s blocks:%d ranges:%d, %" PRId64 " of %" PRIu64 " bytes are sent", REPO_ID(pRepo),
+           TSDB_FILE_FULL_NAME(pDFile), aDigest ? (int32_t)taosArrayGetSize(aDigest) : 0,
+           (int32_t)taosArrayGetSize(aRange), sendLen, pDFile->info.size);
+
+  taosArrayDestroy(aRange);
+  return 0;
+}
+
+static int32_t tsdbAddSyncRange(SArray *aRange, uint64_t offset, uint64_t len, bool local) {
+  if (len == 0) return 0;
+
+  size_t size = taosArrayGetSize(aRange);
+  if (size > 0) {
+    SSyncRange *pLast = taosArrayGet(aRange, size - 1);
+    if (pLast->local == local && pLast->offset + pLast->len == offset) {
+      pLast->len += len;
+      return 0;
+    }
+  }
+
+  SSyncRange range = {.offset = offset, .len = len, .local = local};
+  if (taosArrayPush(aRange, &range) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+ * Split the remote file into the ranges whose blocks are found at the same offset of the local file and the ranges to
+ * fetch from remote.
+ */
+int32_t tsdbSyncDiffDFile(void **ppBuf, SDFile *pLDFile, SDFile *pRDFile, SArray *aDigest, SArray *aRange) {
+  uint64_t end = 0;
+  SDFile   df;
+
+  if (pLDFile != NULL && pLDFile->info.size > 0 && taosArrayGetSize(aDigest) > 0) {
+    df = *pLDFile;
+    TSDB_FILE_SET_CLOSED(&df);
+    if (tsdbOpenDFile(&df, O_RDONLY) < 0) return -1;
+
+    for (size_t i = 0; i < taosArrayGetSize(aDigest); i++) {
+      SSyncDigest *pDigest = taosArrayGet(aDigest, i);
+      if (pDigest->offset < end || pDigest->offset + pDigest->len > pRDFile->info.size) continue;
+      if (pDigest->offset + pDigest->len > df.info.size) continue;
+
+      void *pCont = tsdbSyncReadBlock(ppBuf, &df, pDigest->offset, pDigest->len);
+      if (pCont == NULL) {
+        tsdbCloseDFile(&df);
+        return -1;
+      }
+
+      SSyncDigest digest = {.offset = pDigest->offset, .len = pDigest->len};
+      tsdbSyncCalcDigest(&digest, pCont);
+      if (digest.crc != pDigest->crc || digest.hash != pDigest->hash) continue;
+
+      if (tsdbAddSyncRange(aRange, end, pDigest->offset - end, false) < 0 ||
+          tsdbAddSyncRange(aRange, pDigest->offset, pDigest->len, true) < 0) {
+        tsdbCloseDFile(&df);
+        return -1;
+      }
+      end = pDigest->offset + pDigest->len;
+    }
+
+    tsdbCloseDFile(&df);
+  }
+
+  return tsdbAddSyncRange(aRange, end, pRDFile->info.size - end, false);
+}
+
+static int32_t tsdbSyncRecvDFileDiff(SSyncH *pSynch, SDFile *pLDFile, SDFile *pDFile, SDFile *pRDFile) {
+  STsdbRepo *pRepo = pSynch->pRepo;
+  SArray *   aDigest = taosArrayInit(1024, sizeof(SSyncDigest));
+  SArray *   aRange = taosArrayInit(64, sizeof(SSyncRange));
+  SDFile     df;
+  int64_t    recvLen = 0;
+
+  TSDB_FILE_SET_CLOSED(&df);
+  if (aDigest == NULL || aRange == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    goto _err;
+  }
+
+  if (tsdbSyncRecvDigests(pSynch, aDigest) < 0) goto _err;
+  if (tsdbSyncDiffDFile(&(pSynch->pBlkBuf), pLDFile, pRDFile, aDigest, aRange) < 0) goto _err;
+  if (tsdbSyncSendRanges(pSynch, aRange) < 0) goto _err;
+
+  // the ranges are written in order, interleaving the local copies with the bytes sent by remote
+  for (size_t i = 0; i < taosArrayGetSize(aRange); i++) {
+    SSyncRange *pRange = taosArrayGet(aRange, i);
+
+    if (!pRange->local) {
+      int64_t ret = taosCopyFds(pSynch->socketFd, pDFile->fd, pRange->len);
+      if (ret != pRange->len) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        tsdbError("vgId:%d, failed to recv range of file:%s, offset:%" PRIu64 " len:%" PRIu64 " ret:%" PRId64,
+                  REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile), pRange->offset, pRange->len, ret);
+        goto _err;
+      }
+      recvLen += ret;
+      continue;
+    }
+
+    if (TSDB_FILE_CLOSED(&df)) {
+      df = *pLDFile;
+      TSDB_FILE_SET_CLOSED(&df);
+      if (tsdbOpenDFile(&df, O_RDONLY) < 0) goto _err;
+    }
+
+    for (uint64_t copied = 0; copied < pRange->len;) {
+      uint32_t len = (uint32_t)MIN(pRange->len - copied, TSDB_SYNC_COPY_STEP);
+      void *   pCont = tsdbSyncReadBlock(&(pSynch->pBlkBuf), &df, pRange->offset + copied, len);
+      if (pCont == NULL || tsdbWriteDFile(pDFile, pCont, len) < 0) {
+        tsdbError("vgId:%d, failed to copy range of file:%s to file:%s since %s", REPO_ID(pRepo),
+                  TSDB_FILE_FULL_NAME(&df), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno));
+        goto _err;
+      }
+      copied += len;
+    }
+  }
+
+  tsdbInfo("vgId:%d, file:%s blocks:%d ranges:%d, %" PRId64 " of %" PRIu64 " bytes are received", REPO_ID(pRepo),
+           TSDB_FILE_FULL_NAME(pDFile), (int32_t)taosArrayGetSize(aDigest), (int32_t)taosArrayGetSize(aRange), recvLen,
+           pRDFile->info.size);
+
+  tsdbCloseDFile(&df);
+  taosArrayDestroy(aDigest);
+  taosArrayDestroy(aRange);
+  return 0;
+
+_err:
+  tsdbCloseDFile(&df);
+  taosArrayDestroy(aDigest);
+  taosArrayDestroy(aRange);
+  return -1;
+}
+
+/*
+ * The .data/.last/.smad/.smal files carry no version in their names, so the received files may replace the local files
+ * they are diffed against. Such local files are moved aside and read from there until the fileset is received.
+ */
+int32_t tsdbSyncMoveBaseFSet(STsdbRepo *pRepo, SDFileSet *pBaseSet, SDFileSet *pLSet, SDFileSet *pSet) {
+  *pBaseSet = *pLSet;
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pBaseSet); ftype++) {
+    SDFile *pBaseFile = TSDB_DFILE_IN_SET(pBaseSet, ftype);
+    if (ftype >= tsdbGetNFiles(pSet) || strcmp(TSDB_FILE_FULL_NAME(pBaseFile),
+                                              TSDB_FILE_FULL_NAME(TSDB_DFILE_IN_SET(pSet, ftype))) != 0) {
+      continue;
+    }
+
+    char aname[TSDB_FILENAME_LEN + 8];
+    int  len = snprintf(aname, sizeof(aname), "%s.sync", TSDB_FILE_FULL_NAME(pBaseFile));
+    if (len >= TSDB_FILENAME_LEN) {
+      tsdbSyncRestoreBaseFSet(pBaseSet, pLSet, false);
+      return -1;
+    }
+
+    if (rename(TSDB_FILE_FULL_NAME(pBaseFile), aname) < 0) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      tsdbError("vgId:%d, failed to move file:%s aside since %s", REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pBaseFile),
+                tstrerror(terrno));
+      tsdbSyncRestoreBaseFSet(pBaseSet, pLSet, false);
+      return -1;
+    }
+    memcpy(pBaseFile->f.aname, aname, len + 1);
+  }
+
+  return 0;
+}
+
+// remove the local files moved aside once the fileset is received, or move them back
+void tsdbSyncRestoreBaseFSet(SDFileSet *pBaseSet, SDFileSet *pLSet, bool received) {
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pBaseSet); ftype++) {
+    SDFile *pBaseFile = TSDB_DFILE_IN_SET(pBaseSet, ftype);
+    SDFile *pLFile = TSDB_DFILE_IN_SET(pLSet, ftype);
+    if (strcmp(TSDB_FILE_FULL_NAME(pBaseFile), TSDB_FILE_FULL_NAME(pLFile)) == 0) continue;
+
+    if (received) {
+      (void)remove(TSDB_FILE_FULL_NAME(pBaseFile));
+    } else {
+      (void)rename(TSDB_FILE_FULL_NAME(pBaseFile), TSDB_FILE_FULL_NAME(pLFile));
+    }
+    tstrncpy(pBaseFile->f.aname, TSDB_FILE_FULL_NAME(pLFile), TSDB_FILENAME_LEN);
+  }
+}
+
 static int tsdbReload(STsdbRepo *pRepo, bool isMfChanged) {
   // TODO: may need to stop and restart stream
   // if (isMfChanged) {
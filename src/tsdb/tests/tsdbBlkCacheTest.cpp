@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+SDataCol* newIntCol(int32_t numOfRows, int32_t base) {
+  SDataCol* pCol = (SDataCol*)calloc(1, sizeof(SDataCol));
+  pCol->type = TSDB_DATA_TYPE_INT;
+  pCol->colId = 2;
+  pCol->bytes = sizeof(int32_t);
+  tdAllocMemForCol(pCol, numOfRows);
+  for (int32_t i = 0; i < numOfRows; ++i) ((int32_t*)pCol->pData)[i] = base + i;
+  pCol->len = numOfRows * sizeof(int32_t);
+  return pCol;
+}
+
+void freeCol(SDataCol* pCol) {
+  tfree(pCol->pData);
+  free(pCol);
+}
+
+const char* fname1 = "v2f1800ver1.data";
+const char* fname2 = "v2f1800ver2.data";
+
+int64_t entrySize(int32_t numOfRows) {
+  void*     pCache = tsdbTestNewBlkCache(1024 * 1024);
+  SDataCol* pCol = newIntCol(numOfRows, 0);
+  tsdbTestPutBlkCacheCol(pCache, fname1, 0, pCol);
+  freeCol(pCol);
+
+  STsdbBlkCacheStat stat;
+  tsdbTestGetBlkCacheStat(pCache, &stat);
+  tsdbTestFreeBlkCache(pCache);
+  return stat.size;
+}
+
+bool getCol(void* pCache, const char* fname, int64_t offset, int32_t numOfRows, int32_t* first) {
+  SDataCol* pCol = newIntCol(numOfRows, -1);
+  bool      hit = tsdbTestGetBlkCacheCol(pCache, fname, offset, pCol, numOfRows);
+  if (hit) *first = ((int32_t*)pCol->pData)[0];
+  freeCol(pCol);
+  return hit;
+}
+
+}  // namespace
+
+TEST(tsdbBlkCacheTest, evictLeastRecentlyUsed) {
+  const int32_t rows = 100;
+  int64_t       size = entrySize(rows);
+  ASSERT_GT(size, rows * (int64_t)sizeof(int32_t));
+
+  // room for 8 columns exactly
+  void*          pCache = tsdbTestNewBlkCache(size * 8);
+
+  for (int64_t offset = 0; offset < 8; ++offset) {
+    SDataCol* pCol = newIntCol(rows, (int32_t)offset * 1000);
+    tsdbTestPutBlkCacheCol(pCache, fname1, offset, pCol);
+    freeCol(pCol);
+  }
+
+  STsdbBlkCacheStat stat;
+  tsdbTestGetBlkCacheStat(pCache, &stat);
+  EXPECT_EQ(stat.size, size * 8);
+  EXPECT_EQ(stat.evicts, 0);
+
+  // offset 0 is used again, so offset 1 is the least recently used one
+  int32_t first = 0;
+  EXPECT_TRUE(getCol(pCache, fname1, 0, rows, &first));
+  EXPECT_EQ(first, 0);
+
+  SDataCol* pCol = newIntCol(rows, 8000);
+  tsdbTestPutBlkCacheCol(pCache, fname1, 8, pCol);
+  freeCol(pCol);
+
+  EXPECT_TRUE(getCol(pCache, fname1, 0, rows, &first));
+  EXPECT_FALSE(getCol(pCache, fname1, 1, rows, &first));
+  EXPECT_TRUE(getCol(pCache, fname1, 8, rows, &first));
+  EXPECT_EQ(first, 8000);
+
+  tsdbTestGetBlkCacheStat(pCache, &stat);
+  EXPECT_EQ(stat.size, size * 8);
+  EXPECT_EQ(stat.evicts, 1);
+  EXPECT_EQ(stat.hits, 3);
+  EXPECT_EQ(stat.misses, 1);
+
+  tsdbTestFreeBlkCache(pCache);
+}
+
+TEST(tsdbBlkCacheTest, largeColumnNotCached) {
+  const int32_t rows = 100;
+  int64_t       size = entrySize(rows);
+
+  void*          pCache = tsdbTestNewBlkCache(size * 8 - 1);
+
+  SDataCol* pCol = newIntCol(rows, 0);
+  tsdbTestPutBlkCacheCol(pCache, fname1, 0, pCol);
+  freeCol(pCol);
+
+  int32_t first = 0;
+  EXPECT_FALSE(getCol(pCache, fname1, 0, rows, &first));
+
+  STsdbBlkCacheStat stat;
+  tsdbTestGetBlkCacheStat(pCache, &stat);
+  EXPECT_EQ(stat.size, 0);
+
+  tsdbTestFreeBlkCache(pCache);
+}
+
+// A reader gets a copy of the entry, so the column it holds stays valid when the entry is evicted or the cache is
+// cleared, and the entry does not change with the column it was put from.
+TEST(tsdbBlkCacheTest, readerHoldsCopy) {
+  const int32_t rows = 100;
+  int64_t       size = entrySize(rows);
+
+  void*          pCache = tsdbTestNewBlkCache(size * 8);
+
+  SDataCol* pSrc = newIntCol(rows, 7);
+  tsdbTestPutBlkCacheCol(pCache, fname1, 0, pSrc);
+  ((int32_t*)pSrc->pData)[0] = -7;
+
+  SDataCol* pCol = newIntCol(rows, -1);
+  ASSERT_TRUE(tsdbTestGetBlkCacheCol(pCache, fname1, 0, pCol, rows));
+
+  for (int64_t offset = 1; offset <= 8; ++offset) tsdbTestPutBlkCacheCol(pCache, fname1, offset, pSrc);
+  tsdbTestClearBlkCache(pCache);
+
+  EXPECT_EQ(pCol->len, rows * (int32_t)sizeof(int32_t));
+  for (int32_t i = 0; i < rows; ++i) EXPECT_EQ(((int32_t*)pCol->pData)[i], 7 + i);
+
+  freeCol(pCol);
+  freeCol(pSrc);
+
+  STsdbBlkCacheStat stat;
+  tsdbTestGetBlkCacheStat(pCache, &stat);
+  EXPECT_EQ(stat.size, 0);
+
+  tsdbTestFreeBlkCache(pCache);
+}
+
+// A commit writes the changed blocks to new offsets or new file versions, so the columns cached before it are not
+// found for the blocks after it
+TEST(tsdbBlkCacheTest, newFileVersionMisses) {
+  const int32_t rows = 100;
+  int64_t       size = entrySize(rows);
+
+  void*          pCache = tsdbTestNewBlkCache(size * 8);
+
+  SDataCol* pCol = newIntCol(rows, 0);
+  tsdbTestPutBlkCacheCol(pCache, fname1, 4096, pCol);
+  freeCol(pCol);
+
+  int32_t first = 0;
+  EXPECT_TRUE(getCol(pCache, fname1, 4096, rows, &first));
+  EXPECT_FALSE(getCol(pCache, fname2, 4096, rows, &first));
+  EXPECT_FALSE(getCol(pCache, fname1, 8192, rows, &first));
+
+  tsdbTestFreeBlkCache(pCache);
+}
+
+TEST(tsdbBlkCacheTest, commitInvalidates) {
+  const int32_t vgId = 41;
+  const int32_t tid = 1;
+  const int32_t uid = 4101;
+
+  int32_t blockCacheSize = tsBlockCacheSize;
+  tsBlockCacheSize = 1;
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  tsBlockCacheSize = blockCacheSize;
+  ASSERT_NE(pRepo, nullptr);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  TSKEY        base = tsdbTestBaseKey();
+  TsdbTestRows rows;
+  for (int32_t i = 0; i < 1000; ++i) rows.push_back(std::make_pair(base + i, i));
+  ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, rows), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  EXPECT_EQ(tsdbTestRead(pRepo, uid, base, base + 10000), rows);
+
+  STsdbBlkCacheStat stat1, stat2;
+  tsdbReportBlkCacheStat(pRepo, &stat1);
+  EXPECT_GT(stat1.size, 0);
+  EXPECT_GT(stat1.misses, 0);
+
+  // the second read is served from the cache
+  EXPECT_EQ(tsdbTestRead(pRepo, uid, base, base + 10000), rows);
+  tsdbReportBlkCacheStat(pRepo, &stat2);
+  EXPECT_GT(stat2.hits, stat1.hits);
+  EXPECT_EQ(stat2.misses, stat1.misses);
+
+  // overwrite rows in the middle of the committed blocks
+  TsdbTestRows updates;
+  for (int32_t i = 150; i < 450; i += 3) {
+    updates.push_back(std::make_pair(base + i, -i));
+    rows[i].second = -i;
+  }
+  ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, updates), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  EXPECT_EQ(tsdbTestRead(pRepo, uid, base, base + 10000), rows);
+  EXPECT_EQ(tsdbTestRead(pRepo, uid, base, base + 10000), rows);
+
+  tsdbTestCloseRepo(pRepo, vgId);
+}
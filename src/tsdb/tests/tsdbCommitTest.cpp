@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int kMaxBlocks = 64;
+
+std::vector<int> getSubBlocks(STsdbRepo* pRepo, uint64_t uid) {
+  int              nSubBlocks[kMaxBlocks];
+  int              nBlocks = tsdbTestGetSubBlocks(pRepo, uid, nSubBlocks, kMaxBlocks);
+  std::vector<int> res;
+  EXPECT_GE(nBlocks, 0);
+  for (int i = 0; i < nBlocks && i < kMaxBlocks; ++i) res.push_back(nSubBlocks[i]);
+  return res;
+}
+
+TsdbTestRows toRows(const std::map<TSKEY, int32_t>& data) { return TsdbTestRows(data.begin(), data.end()); }
+
+int commit(STsdbRepo* pRepo, int32_t fsetCommitThreads) {
+  int32_t threads = tsNumOfFSetCommitThreads;
+  tsNumOfFSetCommitThreads = fsetCommitThreads;
+  int code = tsdbSyncCommit(pRepo);
+  tsNumOfFSetCommitThreads = threads;
+  return code;
+}
+
+}  // namespace
+
+// Each commit of a few out-of-order rows into a committed block adds a sub-block, until the block has the max number
+// of sub-blocks. The next commit merges all of them with the memtable rows into a new block.
+TEST(tsdbCommitTest, mergeSubBlocks) {
+  const int32_t vgId = 51;
+  const int32_t tid = 1;
+  const int32_t uid = 5101;
+
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  ASSERT_NE(pRepo, nullptr);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  TSKEY                    base = tsdbTestBaseKey();
+  std::map<TSKEY, int32_t> data;
+  TsdbTestRows             rows;
+  for (int32_t i = 0; i < 100; ++i) {
+    rows.push_back(std::make_pair(base + 2 * i, i));
+    data[base + 2 * i] = i;
+  }
+  ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, rows), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+  EXPECT_EQ(getSubBlocks(pRepo, uid), std::vector<int>(1, 1));
+
+  for (int32_t round = 1; round <= 10; ++round) {
+    // new keys between the committed ones, and overwrites of committed keys
+    TsdbTestRows updates;
+    for (int32_t j = 4; j >= 0; --j) {
+      TSKEY key = base + 2 * (round * 7 + j * 13) % 200 + 1;
+      updates.push_back(std::make_pair(key, round * 1000 + j));
+    }
+    for (int32_t j = 0; j < 3; ++j) {
+      updates.push_back(std::make_pair(base + 2 * ((round * 11 + j * 29) % 100), -round * 1000 - j));
+    }
+
+    // the client submits the rows of a table sorted by key
+    std::sort(updates.begin(), updates.end());
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, updates), 0);
+    ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+    for (size_t i = 0; i < updates.size(); ++i) data[updates[i].first] = updates[i].second;
+
+    // the 8th commit finds the block with the max number of sub-blocks and merges them
+    int expected = (round < 8) ? round + 1 : round - 7;
+    EXPECT_EQ(getSubBlocks(pRepo, uid), std::vector<int>(1, expected)) << "round " << round;
+    EXPECT_EQ(tsdbTestRead(pRepo, uid, base, base + 10000), toRows(data)) << "round " << round;
+  }
+
+  tsdbTestCloseRepo(pRepo, vgId);
+}
+
+// The file sets committed by several threads hold the same rows in the same blocks as committed one by one
+TEST(tsdbCommitTest, parallelFSetCommit) {
+  const int32_t vgIds[2] = {52, 53};
+  const int32_t threads[2] = {1, 4};
+  const int32_t uids[3] = {5201, 5202, 5203};
+  const int64_t day = tsTickPerDay[TSDB_TIME_PRECISION_MILLI];
+
+  STsdbRepo* pRepos[2];
+  for (int i = 0; i < 2; ++i) {
+    pRepos[i] = tsdbTestOpenRepo(vgIds[i], 200);
+    ASSERT_NE(pRepos[i], nullptr);
+    for (int t = 0; t < 3; ++t) ASSERT_EQ(tsdbTestCreateTable(pRepos[i], t + 1, uids[t]), 0);
+  }
+
+  TSKEY                    base = tsdbTestBaseKey();
+  TSKEY                    skey = base - 200 * day;
+  std::map<TSKEY, int32_t> data[3];
+
+  // 1: rows of every table over 30 file sets, 2: rows between and over them in every third file set and in older
+  // ones, 3: rows of one table in a few file sets, the others are kept as they are
+  for (int32_t round = 1; round <= 3; ++round) {
+    for (int t = 0; t < 3; ++t) {
+      if (round == 3 && t != 1) continue;
+
+      TsdbTestRows rows;
+      for (int32_t d = (round == 3) ? 40 : 0; d < ((round == 2) ? 180 : 150); d += (round == 1) ? 5 : 15) {
+        for (int32_t j = 0; j < 20; ++j) {
+          TSKEY key = base - d * day + t * 1000 + j * 10 + ((round == 1) ? 0 : j % 2);
+          rows.push_back(std::make_pair(key, round * 100000 + d * 100 + j));
+        }
+      }
+
+      std::sort(rows.begin(), rows.end());
+      for (int i = 0; i < 2; ++i) ASSERT_EQ(tsdbTestInsert(pRepos[i], t + 1, uids[t], rows), 0);
+      for (size_t k = 0; k < rows.size(); ++k) data[t][rows[k].first] = rows[k].second;
+    }
+
+    for (int i = 0; i < 2; ++i) ASSERT_EQ(commit(pRepos[i], threads[i]), 0);
+
+    for (int t = 0; t < 3; ++t) {
+      EXPECT_EQ(tsdbTestRead(pRepos[1], uids[t], skey, base + day), toRows(data[t])) << "round " << round;
+      EXPECT_EQ(tsdbTestRead(pRepos[0], uids[t], skey, base + day), toRows(data[t])) << "round " << round;
+      EXPECT_EQ(getSubBlocks(pRepos[1], uids[t]), getSubBlocks(pRepos[0], uids[t])) << "round " << round;
+    }
+  }
+
+  // the rows span 180 days, a block in each of the 10 day file sets at least
+  EXPECT_GE(getSubBlocks(pRepos[1], uids[0]).size(), 17u);
+
+  for (int i = 0; i < 2; ++i) tsdbTestCloseRepo(pRepos[i], vgIds[i]);
+}
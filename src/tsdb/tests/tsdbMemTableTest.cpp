@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+// in-order rows inserted in batches of growing sizes, so they span column buffer chunks of different capacities
+TsdbTestRows insertInOrder(STsdbRepo* pRepo, int32_t tid, uint64_t uid, TSKEY base) {
+  TsdbTestRows rows;
+  int32_t      i = 0;
+  for (int32_t batch = 1; batch <= 9; ++batch) {
+    TsdbTestRows batchRows;
+    for (int32_t j = 0; j < batch * 37; ++j, ++i) batchRows.push_back(std::make_pair(base + 3 * i, i * 7 - 100));
+    EXPECT_EQ(tsdbTestInsert(pRepo, tid, uid, batchRows), 0);
+    rows.insert(rows.end(), batchRows.begin(), batchRows.end());
+  }
+  return rows;
+}
+
+TsdbTestRows subRows(const TsdbTestRows& rows, TSKEY skey, TSKEY ekey) {
+  TsdbTestRows res;
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (rows[i].first >= skey && rows[i].first <= ekey) res.push_back(rows[i]);
+  }
+  return res;
+}
+
+}  // namespace
+
+// The column buffer mirrors the memtable rows of a table, reads and commits from it return the same rows as from a
+// memtable without it
+TEST(tsdbMemTableTest, columnarSameRows) {
+  const int32_t vgIds[2] = {61, 62};
+  const int32_t tid = 1;
+  const int32_t uid = 6101;
+  int8_t        columnarMemTable = tsColumnarMemTable;
+
+  STsdbRepo*   pRepos[2];
+  TsdbTestRows rows[2];
+  TSKEY        base = tsdbTestBaseKey();
+  for (int i = 0; i < 2; ++i) {
+    tsColumnarMemTable = (i == 0) ? 1 : 0;
+    pRepos[i] = tsdbTestOpenRepo(vgIds[i], 200);
+    ASSERT_NE(pRepos[i], nullptr);
+    ASSERT_EQ(tsdbTestCreateTable(pRepos[i], tid, uid), 0);
+    rows[i] = insertInOrder(pRepos[i], tid, uid, base);
+  }
+  tsColumnarMemTable = columnarMemTable;
+
+  EXPECT_GT(tsdbTestGetColBufSize(pRepos[0]), 0);
+  EXPECT_EQ(tsdbTestGetColBufSize(pRepos[1]), 0);
+
+  TSKEY ekey = rows[0].back().first;
+  TSKEY ranges[][2] = {{base, ekey}, {base + 100, base + 1000}, {base + 1, base + 1}, {ekey - 10, ekey + 10}};
+  for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r) {
+    TsdbTestRows res = tsdbTestRead(pRepos[0], uid, ranges[r][0], ranges[r][1]);
+    EXPECT_EQ(res, tsdbTestRead(pRepos[1], uid, ranges[r][0], ranges[r][1])) << "range " << r;
+    EXPECT_EQ(res, subRows(rows[0], ranges[r][0], ranges[r][1])) << "range " << r;
+  }
+
+  // the rows committed from the column buffer are the same
+  for (int i = 0; i < 2; ++i) ASSERT_EQ(tsdbSyncCommit(pRepos[i]), 0);
+  EXPECT_EQ(tsdbTestRead(pRepos[0], uid, base, ekey), tsdbTestRead(pRepos[1], uid, base, ekey));
+  EXPECT_EQ(tsdbTestRead(pRepos[0], uid, base, ekey), rows[0]);
+
+  for (int i = 0; i < 2; ++i) tsdbTestCloseRepo(pRepos[i], vgIds[i]);
+}
+
+// An out-of-order row drops the column buffer of its table, and its bytes are no longer counted by the memtable
+TEST(tsdbMemTableTest, columnarOutOfOrder) {
+  const int32_t vgId = 63;
+  const int32_t uids[2] = {6301, 6302};
+  int8_t        columnarMemTable = tsColumnarMemTable;
+
+  // the option is read as the table data of the memtable are created
+  tsColumnarMemTable = 1;
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  ASSERT_NE(pRepo, nullptr);
+
+  TSKEY        base = tsdbTestBaseKey();
+  TsdbTestRows rows[2];
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, uids[0]), 0);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 2, uids[1]), 0);
+  rows[0] = insertInOrder(pRepo, 1, uids[0], base);
+  int64_t size = tsdbTestGetColBufSize(pRepo);
+  EXPECT_GT(size, 0);
+  rows[1] = insertInOrder(pRepo, 2, uids[1], base);
+  tsColumnarMemTable = columnarMemTable;
+  EXPECT_EQ(tsdbTestGetColBufSize(pRepo), 2 * size);
+
+  TsdbTestRows outOfOrder;
+  outOfOrder.push_back(std::make_pair(base + 1, 12345));
+  outOfOrder.push_back(std::make_pair(base + 3, -1));
+  ASSERT_EQ(tsdbTestInsert(pRepo, 2, uids[1], outOfOrder), 0);
+  rows[1].insert(rows[1].begin() + 1, outOfOrder[0]);
+  rows[1][2].second = -1;
+  EXPECT_EQ(tsdbTestGetColBufSize(pRepo), size);
+
+  TSKEY ekey = rows[0].back().first;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(tsdbTestRead(pRepo, uids[i], base, ekey), rows[i]) << "table " << i;
+  }
+
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(tsdbTestRead(pRepo, uids[i], base, ekey), rows[i]) << "table " << i;
+  }
+
+  tsdbTestCloseRepo(pRepo, vgId);
+}
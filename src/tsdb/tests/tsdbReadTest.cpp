@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+TsdbTestRows read(STsdbRepo* pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, int32_t order, int32_t prefetchBlocks) {
+  int32_t blocks = tsQueryPrefetchBlocks;
+  tsQueryPrefetchBlocks = prefetchBlocks;
+  TsdbTestRows rows = (order == TSDB_ORDER_ASC) ? tsdbTestRead(pRepo, uid, skey, ekey, order)
+                                                : tsdbTestRead(pRepo, uid, ekey, skey, order);
+  tsQueryPrefetchBlocks = blocks;
+
+  // the rows of a block loaded as a whole keep their order in a descending scan
+  std::sort(rows.begin(), rows.end());
+  return rows;
+}
+
+TsdbTestRows subRows(const std::map<TSKEY, int32_t>& data, TSKEY skey, TSKEY ekey) {
+  return TsdbTestRows(data.lower_bound(skey), data.upper_bound(ekey));
+}
+
+}  // namespace
+
+// The blocks read ahead of the scan are not the ones scanned: a query returns the same rows with any prefetch depth,
+// in both orders, over blocks of the data and last files, blocks with sub-blocks, and rows still in the memtable
+TEST(tsdbReadTest, prefetchSameRows) {
+  const int32_t vgId = 71;
+  const int32_t uids[2] = {7101, 7102};
+  const int64_t day = tsTickPerDay[TSDB_TIME_PRECISION_MILLI];
+  const int32_t depths[] = {0, 1, 4, 1000};
+
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  ASSERT_NE(pRepo, nullptr);
+  for (int t = 0; t < 2; ++t) ASSERT_EQ(tsdbTestCreateTable(pRepo, t + 1, uids[t]), 0);
+
+  TSKEY                    base = tsdbTestBaseKey();
+  TSKEY                    skey = base - 25 * day;
+  std::map<TSKEY, int32_t> data[2];
+
+  // 1: 20 full blocks of each table in each of 3 file sets, with a few rows left for the last file, 2: out-of-order
+  // rows committed as sub-blocks, 3: rows kept in the memtable
+  for (int32_t round = 1; round <= 3; ++round) {
+    for (int t = 0; t < 2; ++t) {
+      TsdbTestRows rows;
+      for (int32_t d = 0; d < 30; d += 10) {
+        int32_t n = (round == 1) ? 4005 : 30;
+        for (int32_t j = 0; j < n; ++j) {
+          TSKEY key = skey + d * day + ((round == 1) ? 2 * j : 2 * (j * 131 + round * 17) % 8000 + 1);
+          rows.push_back(std::make_pair(key, round * 100000 + t * 10000 + j));
+        }
+      }
+
+      std::sort(rows.begin(), rows.end());
+      ASSERT_EQ(tsdbTestInsert(pRepo, t + 1, uids[t], rows), 0);
+      for (size_t k = 0; k < rows.size(); ++k) data[t][rows[k].first] = rows[k].second;
+    }
+
+    if (round < 3) {
+      ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+    }
+  }
+
+  TSKEY ekey = skey + 30 * day;
+  TSKEY ranges[][2] = {{skey, ekey}, {skey + 1000, skey + 5000}, {skey + 9 * day, skey + 21 * day}, {skey + 7, skey + 7}};
+  for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r) {
+    for (int t = 0; t < 2; ++t) {
+      TsdbTestRows expected = subRows(data[t], ranges[r][0], ranges[r][1]);
+      for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); ++i) {
+        EXPECT_EQ(read(pRepo, uids[t], ranges[r][0], ranges[r][1], TSDB_ORDER_ASC, depths[i]), expected)
+            << "range " << r << ", table " << t << ", prefetch " << depths[i];
+        EXPECT_EQ(read(pRepo, uids[t], ranges[r][0], ranges[r][1], TSDB_ORDER_DESC, depths[i]), expected)
+            << "range " << r << ", table " << t << ", prefetch " << depths[i] << ", desc";
+      }
+    }
+  }
+
+  tsdbTestCloseRepo(pRepo, vgId);
+}
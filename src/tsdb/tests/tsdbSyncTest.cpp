@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+struct Range {
+  int64_t offset;
+  int64_t len;
+  bool    local;
+};
+
+class TsdbSyncDiffTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    snprintf(dir, sizeof(dir), "/tmp/tsdbSyncTest-XXXXXX");
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    lname = std::string(dir) + "/local.data";
+    rname = std::string(dir) + "/remote.data";
+  }
+
+  void TearDown() override { taosRemoveDir(dir); }
+
+  // a file of the given blocks, each filled with its byte
+  static void writeFile(const std::string& fname, const std::string& blocks, int64_t blockLen) {
+    FILE* fp = fopen(fname.c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    for (size_t i = 0; i < blocks.size(); i++) {
+      std::string block(blockLen, blocks[i]);
+      fwrite(block.data(), 1, block.size(), fp);
+    }
+    fclose(fp);
+  }
+
+  // the ranges of the remote file, whose blocks are all offered as digests
+  std::vector<Range> diff(const char* local, int64_t nBlocks, int64_t blockLen) {
+    std::vector<int64_t> blocks;
+    for (int64_t i = 0; i < nBlocks; i++) {
+      blocks.push_back(i * blockLen);
+      blocks.push_back(blockLen);
+    }
+
+    int64_t ranges[3 * 16];
+    int     nRanges = tsdbTestSyncDiffDFile(local, rname.c_str(), blocks.empty() ? NULL : &blocks[0], (int)nBlocks,
+                                            ranges, 16);
+    std::vector<Range> res;
+    for (int i = 0; i < nRanges && i < 16; i++) {
+      Range range = {ranges[3 * i], ranges[3 * i + 1], ranges[3 * i + 2] != 0};
+      res.push_back(range);
+    }
+    EXPECT_GE(nRanges, 0);
+    return res;
+  }
+
+  char        dir[32];
+  std::string lname;
+  std::string rname;
+};
+
+void expectRange(const Range& range, int64_t offset, int64_t len, bool local) {
+  EXPECT_EQ(range.offset, offset);
+  EXPECT_EQ(range.len, len);
+  EXPECT_EQ(range.local, local);
+}
+
+bool fileExists(const std::string& fname) { return access(fname.c_str(), F_OK) == 0; }
+
+}  // namespace
+
+TEST_F(TsdbSyncDiffTest, equalFile) {
+  writeFile(lname, "abcd", 100);
+  writeFile(rname, "abcd", 100);
+
+  std::vector<Range> ranges = diff(lname.c_str(), 4, 100);
+  ASSERT_EQ(ranges.size(), 1u);
+  expectRange(ranges[0], 0, 400, true);
+}
+
+TEST_F(TsdbSyncDiffTest, appendedFile) {
+  writeFile(lname, "abc", 100);
+  writeFile(rname, "abcde", 100);
+
+  std::vector<Range> ranges = diff(lname.c_str(), 5, 100);
+  ASSERT_EQ(ranges.size(), 2u);
+  expectRange(ranges[0], 0, 300, true);
+  expectRange(ranges[1], 300, 200, false);
+}
+
+TEST_F(TsdbSyncDiffTest, truncatedFile) {
+  // the local file is longer than the remote one, only the remote size is rebuilt
+  writeFile(lname, "abcde", 100);
+  writeFile(rname, "abc", 100);
+
+  std::vector<Range> ranges = diff(lname.c_str(), 3, 100);
+  ASSERT_EQ(ranges.size(), 1u);
+  expectRange(ranges[0], 0, 300, true);
+
+  // and a remote block changed at the end of a shorter file is fetched
+  writeFile(rname, "abx", 100);
+  ranges = diff(lname.c_str(), 3, 100);
+  ASSERT_EQ(ranges.size(), 2u);
+  expectRange(ranges[0], 0, 200, true);
+  expectRange(ranges[1], 200, 100, false);
+}
+
+TEST_F(TsdbSyncDiffTest, middleChangedFile) {
+  writeFile(lname, "abcdef", 100);
+  writeFile(rname, "abxyef", 100);
+
+  std::vector<Range> ranges = diff(lname.c_str(), 6, 100);
+  ASSERT_EQ(ranges.size(), 3u);
+  expectRange(ranges[0], 0, 200, true);
+  expectRange(ranges[1], 200, 200, false);
+  expectRange(ranges[2], 400, 200, true);
+}
+
+TEST_F(TsdbSyncDiffTest, noLocalFile) {
+  writeFile(rname, "abc", 100);
+
+  std::vector<Range> ranges = diff(NULL, 3, 100);
+  ASSERT_EQ(ranges.size(), 1u);
+  expectRange(ranges[0], 0, 300, false);
+
+  // without digests, e.g. the header of a file, the whole file is fetched
+  writeFile(lname, "abc", 100);
+  ranges = diff(lname.c_str(), 0, 100);
+  ASSERT_EQ(ranges.size(), 1u);
+  expectRange(ranges[0], 0, 300, false);
+}
+
+TEST(TsdbSyncBaseFSetTest, moveAndRestore) {
+  int32_t    vgId = 5;
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  ASSERT_NE(pRepo, nullptr);
+
+  void* pLSet = tsdbTestCreateDFileSet(vgId, 1800, 1);
+  ASSERT_NE(pLSet, nullptr);
+  int nFiles = tsdbTestGetNFiles(pLSet);
+
+  // the received fileset reuses the names of the local files, which are moved aside and restored on failure
+  void* pBaseSet = tsdbTestSyncMoveBaseFSet(pRepo, pLSet, pLSet);
+  ASSERT_NE(pBaseSet, nullptr);
+  for (int ftype = 0; ftype < nFiles; ftype++) {
+    std::string fname = tsdbTestGetDFileName(pLSet, ftype);
+    EXPECT_EQ(std::string(tsdbTestGetDFileName(pBaseSet, ftype)), fname + ".sync");
+    EXPECT_FALSE(fileExists(fname));
+    EXPECT_TRUE(fileExists(fname + ".sync"));
+  }
+
+  tsdbTestSyncRestoreBaseFSet(pBaseSet, pLSet, false);
+  for (int ftype = 0; ftype < nFiles; ftype++) {
+    std::string fname = tsdbTestGetDFileName(pLSet, ftype);
+    EXPECT_TRUE(fileExists(fname));
+    EXPECT_FALSE(fileExists(fname + ".sync"));
+  }
+
+  // once received, the files moved aside are removed
+  pBaseSet = tsdbTestSyncMoveBaseFSet(pRepo, pLSet, pLSet);
+  ASSERT_NE(pBaseSet, nullptr);
+  tsdbTestSyncRestoreBaseFSet(pBaseSet, pLSet, true);
+  for (int ftype = 0; ftype < nFiles; ftype++) {
+    std::string fname = tsdbTestGetDFileName(pLSet, ftype);
+    EXPECT_FALSE(fileExists(fname));
+    EXPECT_FALSE(fileExists(fname + ".sync"));
+  }
+
+  tsdbTestRemoveDFileSet(pLSet);
+  tsdbTestCloseRepo(pRepo, vgId);
+}
+
+TEST(TsdbSyncBaseFSetTest, differentNamesNotMoved) {
+  int32_t    vgId = 6;
+  STsdbRepo* pRepo = tsdbTestOpenRepo(vgId, 200);
+  ASSERT_NE(pRepo, nullptr);
+
+  void* pLSet = tsdbTestCreateDFileSet(vgId, 1800, 1);
+  void* pSet = tsdbTestCreateDFileSet(vgId, 1800, 2);
+  ASSERT_NE(pLSet, nullptr);
+  ASSERT_NE(pSet, nullptr);
+
+  // the files of another version are read in place
+  void* pBaseSet = tsdbTestSyncMoveBaseFSet(pRepo, pLSet, pSet);
+  ASSERT_NE(pBaseSet, nullptr);
+  for (int ftype = 0; ftype < tsdbTestGetNFiles(pLSet); ftype++) {
+    EXPECT_STREQ(tsdbTestGetDFileName(pBaseSet, ftype), tsdbTestGetDFileName(pLSet, ftype));
+    EXPECT_TRUE(fileExists(tsdbTestGetDFileName(pLSet, ftype)));
+  }
+
+  // and kept when the fileset is received, the fs removes them with the old fileset
+  tsdbTestSyncRestoreBaseFSet(pBaseSet, pLSet, true);
+  for (int ftype = 0; ftype < tsdbTestGetNFiles(pLSet); ftype++) {
+    EXPECT_TRUE(fileExists(tsdbTestGetDFileName(pLSet, ftype)));
+  }
+
+  tsdbTestRemoveDFileSet(pLSet);
+  tsdbTestRemoveDFileSet(pSet);
+  tsdbTestCloseRepo(pRepo, vgId);
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+static void tsdbTestInitDFile(SDFile *pDFile, const char *fname) {
+  memset(pDFile, 0, sizeof(*pDFile));
+  tstrncpy(TSDB_FILE_FULL_NAME(pDFile), fname, TSDB_FILENAME_LEN);
+}
+
+void *tsdbTestNewBlkCache(int64_t capacity) { return tsdbNewBlkCache(capacity); }
+
+void tsdbTestFreeBlkCache(void *pCache) { tsdbFreeBlkCache(pCache); }
+
+void tsdbTestClearBlkCache(void *pCache) { tsdbClearBlkCache(pCache); }
+
+void tsdbTestPutBlkCacheCol(void *pCache, const char *fname, int64_t offset, SDataCol *pDataCol) {
+  SDFile dFile;
+  tsdbTestInitDFile(&dFile, fname);
+  tsdbPutBlkCacheCol(pCache, &dFile, offset, pDataCol);
+}
+
+bool tsdbTestGetBlkCacheCol(void *pCache, const char *fname, int64_t offset, SDataCol *pDataCol, int numOfRows) {
+  SDFile dFile;
+  tsdbTestInitDFile(&dFile, fname);
+  return tsdbGetBlkCacheCol(pCache, &dFile, offset, pDataCol, numOfRows, numOfRows);
+}
+
+void tsdbTestGetBlkCacheStat(void *pCache, STsdbBlkCacheStat *pStat) { tsdbGetBlkCacheStat(pCache, pStat); }
+
+static int tsdbTestInitDFileOfSize(SDFile *pDFile, const char *fname) {
+  struct stat fileStat;
+  tsdbTestInitDFile(pDFile, fname);
+  TSDB_FILE_SET_CLOSED(pDFile);
+  if (stat(fname, &fileStat) < 0) return -1;
+  pDFile->info.size = fileStat.st_size;
+  return 0;
+}
+
+int tsdbTestSyncDiffDFile(const char *lname, const char *rname, const int64_t *blocks, int nBlocks, int64_t *ranges,
+                          int maxRanges) {
+  SDFile  lfile, rfile;
+  SArray *aDigest = taosArrayInit(16, sizeof(SSyncDigest));
+  SArray *aRange = taosArrayInit(16, sizeof(SSyncRange));
+  void *  pBuf = NULL;
+  int     nRanges = -1;
+
+  if (tsdbTestInitDFileOfSize(&rfile, rname) < 0 || (lname && tsdbTestInitDFileOfSize(&lfile, lname) < 0)) goto _end;
+
+  // the digests of the remote blocks, as sent by the master
+  if (tsdbOpenDFile(&rfile, O_RDONLY) < 0) goto _end;
+  for (int i = 0; i < nBlocks; i++) {
+    SSyncDigest digest = {.offset = (uint64_t)blocks[2 * i], .len = (uint32_t)blocks[2 * i + 1]};
+    if (tsdbMakeRoom(&pBuf, digest.len) < 0 || tsdbSeekDFile(&rfile, digest.offset, SEEK_SET) < 0 ||
+        tsdbReadDFile(&rfile, pBuf, digest.len) < digest.len) {
+      tsdbCloseDFile(&rfile);
+      goto _end;
+    }
+    tsdbSyncCalcDigest(&digest, pBuf);
+    taosArrayPush(aDigest, &digest);
+  }
+  tsdbCloseDFile(&rfile);
+
+  if (tsdbSyncDiffDFile(&pBuf, lname ? &lfile : NULL, &rfile, aDigest, aRange) < 0) goto _end;
+
+  nRanges = (int)taosArrayGetSize(aRange);
+  for (int i = 0; i < nRanges && i < maxRanges; i++) {
+    SSyncRange *pRange = taosArrayGet(aRange, i);
+    ranges[3 * i] = pRange->offset;
+    ranges[3 * i + 1] = pRange->len;
+    ranges[3 * i + 2] = pRange->local;
+  }
+
+_end:
+  taosTZfree(pBuf);
+  taosArrayDestroy(aDigest);
+  taosArrayDestroy(aRange);
+  return nRanges;
+}
+
+void *tsdbTestCreateDFileSet(int vid, int fid, uint32_t ver) {
+  SDiskID    did = {.level = 0, .id = 0};
+  SDFileSet *pSet = calloc(1, sizeof(SDFileSet));
+  if (pSet == NULL) return NULL;
+
+  tsdbInitDFileSet(pSet, did, vid, fid, ver, TSDB_LATEST_FSET_VER);
+  if (tsdbCreateDFileSet(pSet, true) < 0) {
+    free(pSet);
+    return NULL;
+  }
+  tsdbCloseDFileSet(pSet);
+  return pSet;
+}
+
+void tsdbTestRemoveDFileSet(void *pSet) {
+  tsdbRemoveDFileSet(pSet);
+  free(pSet);
+}
+
+int tsdbTestGetNFiles(void *pSet) { return tsdbGetNFiles((SDFileSet *)pSet); }
+
+const char *tsdbTestGetDFileName(void *pSet, int ftype) {
+  return TSDB_FILE_FULL_NAME(TSDB_DFILE_IN_SET((SDFileSet *)pSet, ftype));
+}
+
+void *tsdbTestSyncMoveBaseFSet(STsdbRepo *pRepo, void *pLSet, void *pSet) {
+  SDFileSet *pBaseSet = calloc(1, sizeof(SDFileSet));
+  if (pBaseSet == NULL) return NULL;
+  if (tsdbSyncMoveBaseFSet(pRepo, pBaseSet, pLSet, pSet) < 0) {
+    free(pBaseSet);
+    return NULL;
+  }
+  return pBaseSet;
+}
+
+void tsdbTestSyncRestoreBaseFSet(void *pBaseSet, void *pLSet, bool received) {
+  tsdbSyncRestoreBaseFSet(pBaseSet, pLSet, received);
+  free(pBaseSet);
+}
+
+int tsdbTestGetSubBlocks(STsdbRepo *pRepo, uint64_t uid, int *nSubBlocks, int maxBlocks) {
+  STable *   pTable = tsdbGetTableByUid(tsdbGetMeta(pRepo), uid);
+  SReadH     readh;
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+  int        nBlocks = 0;
+
+  if (pTable == NULL || tsdbInitReadH(&readh, pRepo) < 0) return -1;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter)) != NULL && nBlocks >= 0) {
+    if (tsdbSetAndOpenReadFSet(&readh, pSet) < 0) {
+      nBlocks = -1;
+      break;
+    }
+
+    if (tsdbLoadBlockIdx(&readh) < 0 || tsdbSetReadTable(&readh, pTable) < 0 ||
+        (readh.pBlkIdx != NULL && tsdbLoadBlockInfo(&readh, NULL, NULL) < 0)) {
+      nBlocks = -1;
+    } else if (readh.pBlkIdx != NULL) {
+      for (int i = 0; i < (int)readh.pBlkIdx->numOfBlocks; i++) {
+        if (nBlocks < maxBlocks) nSubBlocks[nBlocks] = readh.pBlkInfo->blocks[i].numOfSubBlocks;
+        nBlocks++;
+      }
+    }
+
+    tsdbCloseAndUnsetFSet(&readh);
+  }
+
+  tsdbDestroyReadH(&readh);
+  return nBlocks;
+}
+
+int64_t tsdbTestGetColBufSize(STsdbRepo *pRepo) { return (pRepo->mem == NULL) ? 0 : pRepo->mem->colBufSize; }
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include "tsdbTestUtil.h"
+#include "tfs.h"
+#include "tname.h"
+#include "tarray.h"
+#include "tscompression.h"
+
+namespace {
+
+class TsdbTestEnv : public ::testing::Environment {
+ public:
+  void SetUp() override {
+    snprintf(dir, sizeof(dir), "/tmp/tsdbTest-XXXXXX");
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    SDiskCfg diskCfg = {{0}, 0, 1};
+    tstrncpy(diskCfg.dir, dir, TSDB_FILENAME_LEN);
+    ASSERT_EQ(tfsInit(&diskCfg, 1), 0);
+
+    char vnodeDir[TSDB_FILENAME_LEN];
+    snprintf(vnodeDir, sizeof(vnodeDir), "%s/vnode", dir);
+    ASSERT_EQ(taosMkDir(vnodeDir, 0755), 0);
+
+    ASSERT_EQ(tsdbInitCommitQueue(), 0);
+  }
+
+  void TearDown() override {
+    tsdbDestroyCommitQueue();
+    tfsDestroy();
+    taosRemoveDir(dir);
+  }
+
+  char dir[32];
+};
+
+::testing::Environment* const tsdbTestEnv = ::testing::AddGlobalTestEnvironment(new TsdbTestEnv);
+
+STSchema* tsdbTestNewSchema() {
+  STSchemaBuilder builder;
+  if (tdInitTSchemaBuilder(&builder, 0) < 0) return NULL;
+  tdAddColToSchema(&builder, TSDB_DATA_TYPE_TIMESTAMP, PRIMARYKEY_TIMESTAMP_COL_INDEX, TSDB_KEYSIZE);
+  tdAddColToSchema(&builder, TSDB_DATA_TYPE_INT, PRIMARYKEY_TIMESTAMP_COL_INDEX + 1, sizeof(int32_t));
+  STSchema* pSchema = tdGetSchemaFromBuilder(&builder);
+  tdDestroyTSchemaBuilder(&builder);
+  return pSchema;
+}
+
+}  // namespace
+
+TSKEY tsdbTestBaseKey() {
+  int64_t day = tsTickPerDay[TSDB_TIME_PRECISION_MILLI];
+  return (taosGetTimestampMs() / day - 5) * day;
+}
+
+STsdbRepo* tsdbTestOpenRepo(int32_t vgId, int32_t maxRowsPerFileBlock) {
+  char dir[TSDB_FILENAME_LEN];
+  snprintf(dir, sizeof(dir), "vnode/vnode%d", vgId);
+  if (tfsMkdir(dir) < 0 || tsdbCreateRepo(vgId) < 0) return NULL;
+
+  STsdbCfg cfg = {0};
+  cfg.tsdbId = vgId;
+  cfg.cacheBlockSize = 1;
+  cfg.totalBlocks = 4;
+  cfg.daysPerFile = 10;
+  cfg.keep = 3650;
+  cfg.keep1 = 3650;
+  cfg.keep2 = 3650;
+  cfg.minRowsPerFileBlock = TSDB_MIN_MIN_ROW_FBLOCK;
+  cfg.maxRowsPerFileBlock = maxRowsPerFileBlock;
+  cfg.precision = TSDB_TIME_PRECISION_MILLI;
+  cfg.compression = TWO_STAGE_COMP;
+  cfg.update = TD_ROW_OVERWRITE_UPDATE;
+  cfg.cacheLastRow = 0;
+
+  STsdbAppH appH = {0};
+  return tsdbOpenRepo(&cfg, &appH);
+}
+
+void tsdbTestCloseRepo(STsdbRepo* pRepo, int32_t vgId) {
+  if (pRepo != NULL) tsdbCloseRepo(pRepo, 0);
+  tsdbDropRepo(vgId);
+}
+
+int tsdbTestCreateTable(STsdbRepo* pRepo, int32_t tid, uint64_t uid) {
+  STSchema* pSchema = tsdbTestNewSchema();
+  if (pSchema == NULL) return -1;
+
+  char name[TSDB_TABLE_NAME_LEN];
+  snprintf(name, sizeof(name), "t%d", tid);
+
+  STableCfg cfg = {};
+  cfg.type = TSDB_NORMAL_TABLE;
+  cfg.name = name;
+  cfg.tableId.uid = uid;
+  cfg.tableId.tid = tid;
+  cfg.schema = pSchema;
+
+  int code = tsdbCreateTable(pRepo, &cfg);
+  tdFreeSchema(pSchema);
+  return code;
+}
+
+// submit the rows in blocks of the network byte order, as the vnode receives them
+int tsdbTestInsert(STsdbRepo* pRepo, int32_t tid, uint64_t uid, const TsdbTestRows& rows) {
+  const int32_t rowsPerMsg = 1000;
+  const int32_t rowLen = TD_MEM_ROW_DATA_HEAD_SIZE + TSDB_KEYSIZE + sizeof(int32_t);
+
+  STSchema* pSchema = tsdbTestNewSchema();
+  if (pSchema == NULL) return -1;
+
+  SSubmitMsg* pMsg = (SSubmitMsg*)calloc(1, sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + rowsPerMsg * rowLen);
+  if (pMsg == NULL) {
+    tdFreeSchema(pSchema);
+    return -1;
+  }
+
+  int code = 0;
+  for (size_t start = 0; start < rows.size() && code == 0; start += rowsPerMsg) {
+    size_t      end = std::min(start + rowsPerMsg, rows.size());
+    SSubmitBlk* pBlock = (SSubmitBlk*)pMsg->blocks;
+    int32_t     dataLen = 0;
+
+    for (size_t i = start; i < end; ++i) {
+      SMemRow row = (SMemRow)POINTER_SHIFT(pBlock->data, dataLen);
+      memRowSetType(row, SMEM_ROW_DATA);
+      SDataRow dataRow = (SDataRow)memRowDataBody(row);
+      tdInitDataRow(dataRow, pSchema);
+      tdAppendColVal(dataRow, &rows[i].first, TSDB_DATA_TYPE_TIMESTAMP, schemaColAt(pSchema, 0)->offset);
+      tdAppendColVal(dataRow, &rows[i].second, TSDB_DATA_TYPE_INT, schemaColAt(pSchema, 1)->offset);
+      dataLen += memRowTLen(row);
+    }
+
+    pBlock->uid = htobe64(uid);
+    pBlock->tid = htonl(tid);
+    pBlock->sversion = htonl(0);
+    pBlock->dataLen = htonl(dataLen);
+    pBlock->schemaLen = 0;
+    pBlock->numOfRows = htons((int16_t)(end - start));
+
+    pMsg->header.vgId = htonl(tsdbGetCfg(pRepo)->tsdbId);
+    pMsg->length = htonl((int32_t)(sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + dataLen));
+    pMsg->numOfBlocks = htonl(1);
+
+    SShellSubmitRspMsg rsp = {0};
+    if (tsdbInsertData(pRepo, pMsg, &rsp) < 0) code = -1;
+  }
+
+  free(pMsg);
+  tdFreeSchema(pSchema);
+  return code;
+}
+
+TsdbTestRows tsdbTestRead(STsdbRepo* pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, int32_t order) {
+  TsdbTestRows    rows;
+  STableGroupInfo groupInfo = {0};
+  if (tsdbGetOneTableGroup(pRepo, uid, skey, &groupInfo) != TSDB_CODE_SUCCESS) return rows;
+
+  SColumnInfo colList[2] = {};
+  colList[0].colId = PRIMARYKEY_TIMESTAMP_COL_INDEX;
+  colList[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  colList[0].bytes = TSDB_KEYSIZE;
+  colList[1].colId = PRIMARYKEY_TIMESTAMP_COL_INDEX + 1;
+  colList[1].type = TSDB_DATA_TYPE_INT;
+  colList[1].bytes = sizeof(int32_t);
+
+  STsdbQueryCond cond = {};
+  cond.twindow.skey = skey;
+  cond.twindow.ekey = ekey;
+  cond.order = order;
+  cond.numOfCols = 2;
+  cond.colList = colList;
+  cond.type = BLOCK_LOAD_OFFSET_SEQ_ORDER;
+
+  SMemRef          memRef = {};
+  TsdbQueryHandleT pHandle = tsdbQueryTables(pRepo, &cond, &groupInfo, 0, &memRef);
+  if (pHandle != NULL) {
+    while (tsdbNextDataBlock(pHandle)) {
+      SDataBlockInfo info;
+      tsdbRetrieveDataBlockInfo((TsdbQueryHandleT*)pHandle, &info);
+      SArray* pCols = tsdbRetrieveDataBlock((TsdbQueryHandleT*)pHandle, NULL);
+      if (pCols == NULL) break;
+
+      SColumnInfoData* pTsCol = (SColumnInfoData*)taosArrayGet(pCols, 0);
+      SColumnInfoData* pValCol = (SColumnInfoData*)taosArrayGet(pCols, 1);
+      for (int32_t i = 0; i < info.rows; ++i) {
+        rows.push_back(std::make_pair(((TSKEY*)pTsCol->pData)[i], ((int32_t*)pValCol->pData)[i]));
+      }
+    }
+    tsdbCleanupQueryHandle(pHandle);
+  }
+
+  tsdbDestroyTableGroup(&groupInfo);
+  return rows;
+}
@@ -0,0 +1,52 @@
+#ifndef TDENGINE_TSDB_TEST_UTIL_H
+#define TDENGINE_TSDB_TEST_UTIL_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "os.h"
+#include "taosdef.h"
+#include "tglobal.h"
+#include "tsdb.h"
+
+// Helpers to run a tsdb repo on a temporary directory. The tables have the schema (ts timestamp, v int).
+typedef std::vector<std::pair<TSKEY, int32_t> > TsdbTestRows;
+
+STsdbRepo*   tsdbTestOpenRepo(int32_t vgId, int32_t maxRowsPerFileBlock);
+void         tsdbTestCloseRepo(STsdbRepo* pRepo, int32_t vgId);
+int          tsdbTestCreateTable(STsdbRepo* pRepo, int32_t tid, uint64_t uid);
+int          tsdbTestInsert(STsdbRepo* pRepo, int32_t tid, uint64_t uid, const TsdbTestRows& rows);
+// rows are returned in the order of the scan
+TsdbTestRows tsdbTestRead(STsdbRepo* pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, int32_t order = TSDB_ORDER_ASC);
+
+// a key in the middle of a file set not yet expired
+TSKEY tsdbTestBaseKey();
+
+// Wrappers of the tsdb internals, in tsdbTestInt.c. Files are given by their full names.
+extern "C" {
+void* tsdbTestNewBlkCache(int64_t capacity);
+void  tsdbTestFreeBlkCache(void* pCache);
+void  tsdbTestClearBlkCache(void* pCache);
+void  tsdbTestPutBlkCacheCol(void* pCache, const char* fname, int64_t offset, SDataCol* pDataCol);
+bool  tsdbTestGetBlkCacheCol(void* pCache, const char* fname, int64_t offset, SDataCol* pDataCol, int numOfRows);
+void  tsdbTestGetBlkCacheStat(void* pCache, STsdbBlkCacheStat* pStat);
+
+// blocks are given as (offset, len) pairs, the ranges are returned as (offset, len, local) triples
+int         tsdbTestSyncDiffDFile(const char* lname, const char* rname, const int64_t* blocks, int nBlocks,
+                                  int64_t* ranges, int maxRanges);
+void*       tsdbTestCreateDFileSet(int vid, int fid, uint32_t ver);
+void        tsdbTestRemoveDFileSet(void* pSet);
+int         tsdbTestGetNFiles(void* pSet);
+const char* tsdbTestGetDFileName(void* pSet, int ftype);
+void*       tsdbTestSyncMoveBaseFSet(STsdbRepo* pRepo, void* pLSet, void* pSet);
+void        tsdbTestSyncRestoreBaseFSet(void* pBaseSet, void* pLSet, bool received);
+
+// the number of sub-blocks of each block of the table in the file sets, returns the number of blocks
+int tsdbTestGetSubBlocks(STsdbRepo* pRepo, uint64_t uid, int* nSubBlocks, int maxBlocks);
+
+// bytes of the column buffers of the memtable
+int64_t tsdbTestGetColBufSize(STsdbRepo* pRepo);
+}
+
+#endif  // TDENGINE_TSDB_TEST_UTIL_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TBITMAP_H
+#define TDENGINE_TBITMAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Compressed bitmap of uint32_t ids, in the layout of roaring bitmaps: the ids are split by their high 16 bits into
+ * containers, and a container keeps the low 16 bits as a sorted array while it has at most 4096 ids, or as a plain
+ * bitmap of 8KB beyond that.
+ */
+typedef struct SBitmapContainer {
+  uint16_t key;       // high 16 bits of the ids
+  bool     dense;     // data is a bitmap instead of a sorted array
+  int32_t  num;       // number of ids
+  int32_t  capacity;  // capacity of the array, in ids
+  void *   data;
+} SBitmapContainer;
+
+typedef struct SBitmap {
+  int32_t           num;
+  int32_t           capacity;
+  SBitmapContainer *containers;  // sorted by key
+} SBitmap;
+
+typedef struct SBitmapIter {
+  const SBitmap *pBitmap;
+  int32_t        container;
+  int32_t        pos;  // next position in the container
+} SBitmapIter;
+
+SBitmap *tBitmapCreate();
+void     tBitmapDestroy(SBitmap *pBitmap);
+SBitmap *tBitmapDup(const SBitmap *pBitmap);
+
+/**
+ * Add the id, return -1 if out of memory.
+ */
+int32_t  tBitmapAdd(SBitmap *pBitmap, uint32_t id);
+void     tBitmapRemove(SBitmap *pBitmap, uint32_t id);
+bool     tBitmapContains(const SBitmap *pBitmap, uint32_t id);
+uint64_t tBitmapCardinality(const SBitmap *pBitmap);
+
+/**
+ * Keep in pDst only the ids also in pSrc, or add to pDst all the ids of pSrc. Return -1 if out of memory, pDst is
+ * left with a subset of the result then.
+ */
+int32_t tBitmapAnd(SBitmap *pDst, const SBitmap *pSrc);
+int32_t tBitmapOr(SBitmap *pDst, const SBitmap *pSrc);
+
+/**
+ * Iterate the ids in ascending order:
+ *   SBitmapIter iter = {0};
+ *   tBitmapIterInit(&iter, pBitmap);
+ *   while (tBitmapIterNext(&iter, &id)) { ... }
+ */
+void tBitmapIterInit(SBitmapIter *pIter, const SBitmap *pBitmap);
+bool tBitmapIterNext(SBitmapIter *pIter, uint32_t *id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TBITMAP_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TFIXEDHASH_H
+#define TDENGINE_TFIXEDHASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+#include "tarray.h"
+
+/*
+ * Hash table for keys and data of a fixed length, without lock, update or removal. The slots are open addressed with
+ * linear probing and only hold the hash value and the index of an entry, while the entries, the key followed by the
+ * aligned data, are appended to pages that are never moved. So there is no allocation per element, growing the table does
+ * not touch the keys, and the address of the data stays valid until the table is destroyed.
+ */
+typedef struct SFixedHashSlot {
+  uint32_t hashVal;
+  uint32_t index;  // index of the entry plus one, 0 for an empty slot
+} SFixedHashSlot;
+
+typedef struct SFixedHashObj {
+  int32_t         keyLen;
+  int32_t         dataLen;
+  int32_t         dataOffset;  // the data is aligned to 8 bytes after the key
+  int32_t         entrySize;
+  int32_t         pageShift;  // a page holds (1 << pageShift) entries
+  size_t          capacity;  // number of slots, power of 2
+  size_t          size;      // number of entries
+  SFixedHashSlot *slots;
+  SArray         *pPages;
+} SFixedHashObj;
+
+SFixedHashObj *taosFixedHashInit(int32_t keyLen, int32_t dataLen, size_t capacity);
+void           taosFixedHashCleanup(SFixedHashObj *pHashObj);
+
+/**
+ * Return the data of the key, or NULL if the key does not exist.
+ */
+void *taosFixedHashGet(SFixedHashObj *pHashObj, const void *key);
+
+/**
+ * Find the key and add it with a copy of data if it does not exist, so a lookup followed by an insertion only
+ * probes once. Return the data of the key, the existing one is not overwritten, or NULL if out of memory.
+ */
+void *taosFixedHashPut(SFixedHashObj *pHashObj, const void *key, const void *data, bool *exist);
+
+size_t taosFixedHashGetSize(const SFixedHashObj *pHashObj);
+size_t taosFixedHashGetMemSize(const SFixedHashObj *pHashObj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TFIXEDHASH_H
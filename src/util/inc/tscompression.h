@@ -50,6 +50,16 @@ extern "C" {
 #define HEAD_MODE(x)  x%2
 #define HEAD_ALGO(x)  x/2
 
+// decode kernels, the best one supported by the cpu is picked on first use
+#define TSDB_DECODE_KERNEL_SCALAR 0
+#define TSDB_DECODE_KERNEL_SSE42  1
+#define TSDB_DECODE_KERNEL_AVX2   2
+
+// returns the kernel actually in effect, which is downgraded if the cpu does not support the requested one
+extern int         tsSetDecodeKernel(int kernel);
+extern int         tsGetDecodeKernel();
+extern const char *tsGetDecodeKernelName(int kernel);
+
 extern int tsCompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsDecompressINTImp(const char *const input, const int nelements, char *const output, const char type);
 extern int tsCompressBoolImp(const char *const input, const int nelements, char *const output);
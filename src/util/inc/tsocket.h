@@ -24,8 +24,14 @@ extern "C" {
 #include "wepoll.h"
 #endif
 
+typedef struct {
+  void   *buf;
+  int32_t len;
+} SSocketBuf;
+
 int32_t taosReadn(SOCKET sock, char *buffer, int32_t len);
 int32_t taosWriteMsg(SOCKET fd, void *ptr, int32_t nbytes);
+int32_t taosWriteMsgv(SOCKET fd, SSocketBuf *bufs, int32_t num);
 int32_t taosReadMsg(SOCKET fd, void *ptr, int32_t nbytes);
 int32_t taosNonblockwrite(SOCKET fd, char *ptr, int32_t nbytes);
 int64_t taosCopyFds(SOCKET sfd, int32_t dfd, int64_t len);
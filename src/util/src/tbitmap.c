@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tbitmap.h"
+
+#define BITMAP_ARRAY_MAX 4096   // an array container larger than this takes more space than a bitmap
+#define BITMAP_WORDS     1024   // 65536 bits
+#define BITMAP_HIGH(id)  ((uint16_t)((id) >> 16))
+#define BITMAP_LOW(id)   ((uint16_t)((id)&0xFFFF))
+
+static FORCE_INLINE int32_t popcount64(uint64_t v) {
+  v = v - ((v >> 1) & 0x5555555555555555ULL);
+  v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+  v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (int32_t)((v * 0x0101010101010101ULL) >> 56);
+}
+
+static int32_t countBits(const uint64_t *words) {
+  int32_t num = 0;
+  for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+    num += popcount64(words[i]);
+  }
+  return num;
+}
+
+// Position of val in the sorted array, or the position to insert it at, negated minus 1
+static int32_t searchArray(const uint16_t *array, int32_t num, uint16_t val) {
+  int32_t low = 0, high = num - 1;
+  while (low <= high) {
+    int32_t  mid = (low + high) >> 1;
+    uint16_t v = array[mid];
+    if (v < val) {
+      low = mid + 1;
+    } else if (v > val) {
+      high = mid - 1;
+    } else {
+      return mid;
+    }
+  }
+  return -(low + 1);
+}
+
+static int32_t searchContainer(const SBitmap *pBitmap, uint16_t key) {
+  int32_t low = 0, high = pBitmap->num - 1;
+  while (low <= high) {
+    int32_t  mid = (low + high) >> 1;
+    uint16_t k = pBitmap->containers[mid].key;
+    if (k < key) {
+      low = mid + 1;
+    } else if (k > key) {
+      high = mid - 1;
+    } else {
+      return mid;
+    }
+  }
+  return -(low + 1);
+}
+
+static bool containerContains(const SBitmapContainer *pCont, uint16_t val) {
+  if (pCont->dense) {
+    return (((uint64_t *)pCont->data)[val >> 6] >> (val & 63)) & 1;
+  }
+  return searchArray((uint16_t *)pCont->data, pCont->num, val) >= 0;
+}
+
+static int32_t containerToDense(SBitmapContainer *pCont) {
+  uint64_t *words = (uint64_t *)calloc(BITMAP_WORDS, sizeof(uint64_t));
+  if (words == NULL) return -1;
+
+  uint16_t *array = (uint16_t *)pCont->data;
+  for (int32_t i = 0; i < pCont->num; ++i) {
+    words[array[i] >> 6] |= (1ULL << (array[i] & 63));
+  }
+
+  free(pCont->data);
+  pCont->data = words;
+  pCont->dense = true;
+  pCont->capacity = 0;
+  return 0;
+}
+
+static int32_t containerToArray(SBitmapContainer *pCont) {
+  uint16_t *array = (uint16_t *)malloc(sizeof(uint16_t) * MAX(pCont->num, 1));
+  if (array == NULL) return -1;
+
+  uint64_t *words = (uint64_t *)pCont->data;
+  int32_t   n = 0;
+  for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+    uint64_t w = words[i];
+    while (w != 0) {
+      array[n++] = (uint16_t)((i << 6) + BUILDIN_CTZL(w));
+      w &= w - 1;
+    }
+  }
+
+  free(pCont->data);
+  pCont->data = array;
+  pCont->dense = false;
+  pCont->capacity = MAX(pCont->num, 1);
+  return 0;
+}
+
+static int32_t containerDup(SBitmapContainer *pDst, const SBitmapContainer *pSrc) {
+  size_t size = pSrc->dense ? sizeof(uint64_t) * BITMAP_WORDS : sizeof(uint16_t) * MAX(pSrc->num, 1);
+
+  *pDst = *pSrc;
+  pDst->data = malloc(size);
+  if (pDst->data == NULL) return -1;
+  memcpy(pDst->data, pSrc->data, size);
+  if (!pSrc->dense) pDst->capacity = MAX(pSrc->num, 1);
+  return 0;
+}
+
+SBitmap *tBitmapCreate() { return (SBitmap *)calloc(1, sizeof(SBitmap)); }
+
+void tBitmapDestroy(SBitmap *pBitmap) {
+  if (pBitmap == NULL) return;
+
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    free(pBitmap->containers[i].data);
+  }
+  free(pBitmap->containers);
+  free(pBitmap);
+}
+
+SBitmap *tBitmapDup(const SBitmap *pBitmap) {
+  SBitmap *pNew = tBitmapCreate();
+  if (pNew == NULL) return NULL;
+
+  if (pBitmap->num > 0) {
+    pNew->containers = (SBitmapContainer *)malloc(sizeof(SBitmapContainer) * pBitmap->num);
+    if (pNew->containers == NULL) {
+      tBitmapDestroy(pNew);
+      return NULL;
+    }
+    pNew->capacity = pBitmap->num;
+
+    for (int32_t i = 0; i < pBitmap->num; ++i) {
+      if (containerDup(&pNew->containers[i], &pBitmap->containers[i]) < 0) {
+        tBitmapDestroy(pNew);
+        return NULL;
+      }
+      pNew->num++;
+    }
+  }
+
+  return pNew;
+}
+
+static int32_t bitmapReserve(SBitmap *pBitmap, int32_t num) {
+  if (num <= pBitmap->capacity) return 0;
+
+  int32_t capacity = MAX(pBitmap->capacity * 2, 4);
+  while (capacity < num) capacity *= 2;
+
+  SBitmapContainer *containers = realloc(pBitmap->containers, sizeof(SBitmapContainer) * capacity);
+  if (containers == NULL) return -1;
+
+  pBitmap->containers = containers;
+  pBitmap->capacity = capacity;
+  return 0;
+}
+
+int32_t tBitmapAdd(SBitmap *pBitmap, uint32_t id) {
+  uint16_t key = BITMAP_HIGH(id);
+  uint16_t val = BITMAP_LOW(id);
+
+  int32_t idx = searchContainer(pBitmap, key);
+  if (idx < 0) {
+    idx = -idx - 1;
+    if (bitmapReserve(pBitmap, pBitmap->num + 1) < 0) return -1;
+
+    uint16_t *array = (uint16_t *)malloc(sizeof(uint16_t) * 4);
+    if (array == NULL) return -1;
+
+    memmove(&pBitmap->containers[idx + 1], &pBitmap->containers[idx],
+            sizeof(SBitmapContainer) * (pBitmap->num - idx));
+    SBitmapContainer *pCont = &pBitmap->containers[idx];
+    pCont->key = key;
+    pCont->dense = false;
+    pCont->num = 0;
+    pCont->capacity = 4;
+    pCont->data = array;
+    pBitmap->num++;
+  }
+
+  SBitmapContainer *pCont = &pBitmap->containers[idx];
+  if (pCont->dense) {
+    uint64_t *word = &((uint64_t *)pCont->data)[val >> 6];
+    uint64_t  bit = (1ULL << (val & 63));
+    if ((*word & bit) == 0) {
+      *word |= bit;
+      pCont->num++;
+    }
+    return 0;
+  }
+
+  int32_t pos = searchArray((uint16_t *)pCont->data, pCont->num, val);
+  if (pos >= 0) return 0;
+  pos = -pos - 1;
+
+  if (pCont->num >= BITMAP_ARRAY_MAX) {
+    if (containerToDense(pCont) < 0) return -1;
+    ((uint64_t *)pCont->data)[val >> 6] |= (1ULL << (val & 63));
+    pCont->num++;
+    return 0;
+  }
+
+  if (pCont->num >= pCont->capacity) {
+    int32_t   capacity = MIN(pCont->capacity * 2, BITMAP_ARRAY_MAX);
+    uint16_t *array = (uint16_t *)realloc(pCont->data, sizeof(uint16_t) * capacity);
+    if (array == NULL) return -1;
+    pCont->data = array;
+    pCont->capacity = capacity;
+  }
+
+  uint16_t *array = (uint16_t *)pCont->data;
+  memmove(&array[pos + 1], &array[pos], sizeof(uint16_t) * (pCont->num - pos));
+  array[pos] = val;
+  pCont->num++;
+  return 0;
+}
+
+static void bitmapRemoveContainer(SBitmap *pBitmap, int32_t idx) {
+  free(pBitmap->containers[idx].data);
+  memmove(&pBitmap->containers[idx], &pBitmap->containers[idx + 1],
+          sizeof(SBitmapContainer) * (pBitmap->num - idx - 1));
+  pBitmap->num--;
+}
+
+void tBitmapRemove(SBitmap *pBitmap, uint32_t id) {
+  uint16_t val = BITMAP_LOW(id);
+
+  int32_t idx = searchContainer(pBitmap, BITMAP_HIGH(id));
+  if (idx < 0) return;
+
+  SBitmapContainer *pCont = &pBitmap->containers[idx];
+  if (pCont->dense) {
+    uint64_t *word = &((uint64_t *)pCont->data)[val >> 6];
+    uint64_t  bit = (1ULL << (val & 63));
+    if ((*word & bit) == 0) return;
+    *word &= ~bit;
+    pCont->num--;
+    // failing to shrink just keeps the bitmap form
+    if (pCont->num <= BITMAP_ARRAY_MAX / 2) containerToArray(pCont);
+  } else {
+    uint16_t *array = (uint16_t *)pCont->data;
+    int32_t   pos = searchArray(array, pCont->num, val);
+    if (pos < 0) return;
+    memmove(&array[pos], &array[pos + 1], sizeof(uint16_t) * (pCont->num - pos - 1));
+    pCont->num--;
+  }
+
+  if (pCont->num == 0) bitmapRemoveContainer(pBitmap, idx);
+}
+
+bool tBitmapContains(const SBitmap *pBitmap, uint32_t id) {
+  int32_t idx = searchContainer(pBitmap, BITMAP_HIGH(id));
+  if (idx < 0) return false;
+  return containerContains(&pBitmap->containers[idx], BITMAP_LOW(id));
+}
+
+uint64_t tBitmapCardinality(const SBitmap *pBitmap) {
+  uint64_t num = 0;
+  for (int32_t i = 0; i < pBitmap->num; ++i) {
+    num += pBitmap->containers[i].num;
+  }
+  return num;
+}
+
+// Intersect pDst with pSrc in place
+static int32_t containerAnd(SBitmapContainer *pDst, const SBitmapContainer *pSrc) {
+  if (pDst->dense && pSrc->dense) {
+    uint64_t *      dst = (uint64_t *)pDst->data;
+    const uint64_t *src = (const uint64_t *)pSrc->data;
+    for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+      dst[i] &= src[i];
+    }
+    pDst->num = countBits(dst);
+    if (pDst->num <= BITMAP_ARRAY_MAX && pDst->num > 0) return containerToArray(pDst);
+    return 0;
+  }
+
+  if (pDst->dense) {
+    // the result is never larger than the array of pSrc
+    uint16_t *array = (uint16_t *)malloc(sizeof(uint16_t) * MAX(pSrc->num, 1));
+    if (array == NULL) return -1;
+
+    const uint16_t *src = (const uint16_t *)pSrc->data;
+    int32_t         n = 0;
+    for (int32_t i = 0; i < pSrc->num; ++i) {
+      if (containerContains(pDst, src[i])) array[n++] = src[i];
+    }
+
+    free(pDst->data);
+    pDst->data = array;
+    pDst->dense = false;
+    pDst->num = n;
+    pDst->capacity = MAX(pSrc->num, 1);
+    return 0;
+  }
+
+  uint16_t *dst = (uint16_t *)pDst->data;
+  int32_t   n = 0;
+  if (pSrc->dense) {
+    for (int32_t i = 0; i < pDst->num; ++i) {
+      if (containerContains(pSrc, dst[i])) dst[n++] = dst[i];
+    }
+  } else {
+    const uint16_t *src = (const uint16_t *)pSrc->data;
+    int32_t         i = 0, j = 0;
+    while (i < pDst->num && j < pSrc->num) {
+      if (dst[i] < src[j]) {
+        i++;
+      } else if (dst[i] > src[j]) {
+        j++;
+      } else {
+        dst[n++] = dst[i];
+        i++;
+        j++;
+      }
+    }
+  }
+  pDst->num = n;
+  return 0;
+}
+
+// Union pSrc into pDst in place
+static int32_t containerOr(SBitmapContainer *pDst, const SBitmapContainer *pSrc) {
+  if (!pDst->dense && !pSrc->dense && pDst->num + pSrc->num <= BITMAP_ARRAY_MAX) {
+    uint16_t *array = (uint16_t *)malloc(sizeof(uint16_t) * MAX(pDst->num + pSrc->num, 1));
+    if (array == NULL) return -1;
+
+    const uint16_t *dst = (const uint16_t *)pDst->data;
+    const uint16_t *src = (const uint16_t *)pSrc->data;
+    int32_t         i = 0, j = 0, n = 0;
+    while (i < pDst->num && j < pSrc->num) {
+      if (dst[i] < src[j]) {
+        array[n++] = dst[i++];
+      } else if (dst[i] > src[j]) {
+        array[n++] = src[j++];
+      } else {
+        array[n++] = dst[i++];
+        j++;
+      }
+    }
+    while (i < pDst->num) array[n++] = dst[i++];
+    while (j < pSrc->num) array[n++] = src[j++];
+
+    free(pDst->data);
+    pDst->data = array;
+    pDst->capacity = MAX(pDst->num + pSrc->num, 1);
+    pDst->num = n;
+    return 0;
+  }
+
+  if (!pDst->dense && containerToDense(pDst) < 0) return -1;
+
+  uint64_t *dst = (uint64_t *)pDst->data;
+  if (pSrc->dense) {
+    const uint64_t *src = (const uint64_t *)pSrc->data;
+    for (int32_t i = 0; i < BITMAP_WORDS; ++i) {
+      dst[i] |= src[i];
+    }
+  } else {
+    const uint16_t *src = (const uint16_t *)pSrc->data;
+    for (int32_t i = 0; i < pSrc->num; ++i) {
+      dst[src[i] >> 6] |= (1ULL << (src[i] & 63));
+    }
+  }
+  pDst->num = countBits(dst);
+
+  if (pDst->num <= BITMAP_ARRAY_MAX) return containerToArray(pDst);
+  return 0;
+}
+
+int32_t tBitmapAnd(SBitmap *pDst, const SBitmap *pSrc) {
+  int32_t i = 0, j = 0, n = 0;
+  int32_t code = 0;
+
+  while (i < pDst->num) {
+    SBitmapContainer *pCont = &pDst->containers[i];
+    while (j < pSrc->num && pSrc->containers[j].key < pCont->key) j++;
+
+    if (code == 0 && j < pSrc->num && pSrc->containers[j].key == pCont->key) {
+      if (containerAnd(pCont, &pSrc->containers[j]) < 0) {
+        code = -1;
+        pCont->num = 0;
+      }
+    } else {
+      pCont->num = 0;
+    }
+
+    if (pCont->num == 0) {
+      free(pCont->data);
+    } else {
+      pDst->containers[n++] = *pCont;
+    }
+    i++;
+  }
+
+  pDst->num = n;
+  return code;
+}
+
+int32_t tBitmapOr(SBitmap *pDst, const SBitmap *pSrc) {
+  int32_t i = 0;
+  for (int32_t j = 0; j < pSrc->num; ++j) {
+    const SBitmapContainer *pSrcCont = &pSrc->containers[j];
+    while (i < pDst->num && pDst->containers[i].key < pSrcCont->key) i++;
+
+    if (i < pDst->num && pDst->containers[i].key == pSrcCont->key) {
+      if (containerOr(&pDst->containers[i], pSrcCont) < 0) return -1;
+      continue;
+    }
+
+    if (bitmapReserve(pDst, pDst->num + 1) < 0) return -1;
+
+    SBitmapContainer cont;
+    if (containerDup(&cont, pSrcCont) < 0) return -1;
+
+    memmove(&pDst->containers[i + 1], &pDst->containers[i], sizeof(SBitmapContainer) * (pDst->num - i));
+    pDst->containers[i] = cont;
+    pDst->num++;
+  }
+
+  return 0;
+}
+
+void tBitmapIterInit(SBitmapIter *pIter, const SBitmap *pBitmap) {
+  pIter->pBitmap = pBitmap;
+  pIter->container = 0;
+  pIter->pos = 0;
+}
+
+bool tBitmapIterNext(SBitmapIter *pIter, uint32_t *id) {
+  const SBitmap *pBitmap = pIter->pBitmap;
+
+  while (pIter->container < pBitmap->num) {
+    const SBitmapContainer *pCont = &pBitmap->containers[pIter->container];
+    uint32_t                high = ((uint32_t)pCont->key) << 16;
+
+    if (!pCont->dense) {
+      if (pIter->pos < pCont->num) {
+        *id = high | ((uint16_t *)pCont->data)[pIter->pos++];
+        return true;
+      }
+    } else {
+      // pos is the next bit to look at
+      const uint64_t *words = (const uint64_t *)pCont->data;
+      while (pIter->pos < BITMAP_WORDS * 64) {
+        uint64_t w = words[pIter->pos >> 6] >> (pIter->pos & 63);
+        if (w != 0) {
+          pIter->pos += BUILDIN_CTZL(w);
+          *id = high | (uint32_t)(pIter->pos++);
+          return true;
+        }
+        pIter->pos = ((pIter->pos >> 6) + 1) << 6;
+      }
+    }
+
+    pIter->container++;
+    pIter->pos = 0;
+  }
+
+  return false;
+}
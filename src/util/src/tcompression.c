@@ -66,6 +66,434 @@ static const int TEST_NUMBER = 1;
 #define ZIGZAG_ENCODE(T, v) ((u##T)((v) >> (sizeof(T) * 8 - 1))) ^ (((u##T)(v)) << 1)  // zigzag encode
 #define ZIGZAG_DECODE(T, v) ((v) >> 1) ^ -((T)((v)&1))                                 // zigzag decode
 
+/* ----------------------------------------------Decode Kernels
+ * ----------------------------------------------
+ * Each decoder is split into a serial parse stage, which unpacks the variable length stream into
+ * fixed width words, and a scan stage, which rebuilds the values from the words (zigzag decode
+ * with prefix sums, or prefix xor). The scan stages and the bool bitmap have no per element
+ * branches, so they come in SSE4.2 and AVX2 flavours selected once at runtime. The scalar kernels
+ * are the fallback and the reference for the on-disk format.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(WINDOWS)
+#define TD_DECODE_SIMD
+#include <immintrin.h>
+#define TD_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define SIMPLE8B_MAX_ELEMS 240
+#define DECODE_CHUNK_SIZE  1024
+
+static const char simple8bBitPerInteger[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
+static const int  simple8bSelectorToElems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+
+typedef struct {
+  int         kernel;
+  const char *name;
+  // unpack simple8b words into zigzag values, stop once a chunk is filled or remain values are read
+  int (*simple8bUnpack)(const char **ip, uint64_t *output, int remain);
+  // zigzag decode and prefix sum, output may alias input
+  void (*zigzagSum)(const uint64_t *input, int64_t *output, int n, int64_t *prev);
+  // zigzag decode and two levels of prefix sum in place (delta of delta)
+  void (*deltaOfDeltaSum)(uint64_t *data, int n, int64_t *prevDelta, int64_t *prevValue);
+  // prefix xor in place
+  void (*xorScan64)(uint64_t *data, int n, uint64_t *prev);
+  void (*xorScan32)(uint32_t *data, int n, uint32_t *prev);
+  // decode the 2-bit bool bitmap, returns the number of values decoded
+  int (*boolBitmap)(const char *input, int nelements, char *output);
+} SDecodeKernels;
+
+static int simple8bUnpackScalar(const char **ip, uint64_t *output, int remain) {
+  const char *p = *ip;
+  int         count = 0;
+
+  while (count < remain && count < DECODE_CHUNK_SIZE) {
+    uint64_t w = 0;
+    memcpy(&w, p, LONG_BYTES);
+    p += LONG_BYTES;
+
+    int selector = (int)(w & INT64MASK(4));
+    int bit = simple8bBitPerInteger[selector];
+    int elems = MIN(simple8bSelectorToElems[selector], remain - count);
+
+    if (bit == 0) {
+      memset(output + count, 0, elems * sizeof(uint64_t));
+    } else {
+      for (int i = 0; i < elems; i++) {
+        output[count + i] = (w >> (4 + bit * i)) & INT64MASK(bit);
+      }
+    }
+    count += elems;
+  }
+
+  *ip = p;
+  return count;
+}
+
+static void zigzagSumScalar(const uint64_t *input, int64_t *output, int n, int64_t *prev) {
+  uint64_t value = (uint64_t)(*prev);
+  for (int i = 0; i < n; i++) {
+    value += (uint64_t)(ZIGZAG_DECODE(int64_t, input[i]));
+    output[i] = (int64_t)value;
+  }
+  *prev = (int64_t)value;
+}
+
+static void deltaOfDeltaSumScalar(uint64_t *data, int n, int64_t *prevDelta, int64_t *prevValue) {
+  uint64_t delta = (uint64_t)(*prevDelta);
+  uint64_t value = (uint64_t)(*prevValue);
+  for (int i = 0; i < n; i++) {
+    delta += (uint64_t)(ZIGZAG_DECODE(int64_t, data[i]));
+    value += delta;
+    data[i] = value;
+  }
+  *prevDelta = (int64_t)delta;
+  *prevValue = (int64_t)value;
+}
+
+static void xorScan64Scalar(uint64_t *data, int n, uint64_t *prev) {
+  uint64_t value = *prev;
+  for (int i = 0; i < n; i++) {
+    value ^= data[i];
+    data[i] = value;
+  }
+  *prev = value;
+}
+
+static void xorScan32Scalar(uint32_t *data, int n, uint32_t *prev) {
+  uint32_t value = *prev;
+  for (int i = 0; i < n; i++) {
+    value ^= data[i];
+    data[i] = value;
+  }
+  *prev = value;
+}
+
+static FORCE_INLINE char decodeBoolValue(uint8_t ele) {
+  if (ele == 1) {
+    return 1;
+  } else if (ele == 2) {
+    return TSDB_DATA_BOOL_NULL;
+  } else {
+    return 0;
+  }
+}
+
+static int boolBitmapScalar(const char *input, int nelements, char *output) {
+  int ele_per_byte = BITS_PER_BYTE / 2;
+  int nbytes = nelements / ele_per_byte;
+
+  for (int i = 0; i < nbytes; i++) {
+    uint8_t b = (uint8_t)input[i];
+    output[0] = decodeBoolValue(b & INT8MASK(2));
+    output[1] = decodeBoolValue((b >> 2) & INT8MASK(2));
+    output[2] = decodeBoolValue((b >> 4) & INT8MASK(2));
+    output[3] = decodeBoolValue((b >> 6) & INT8MASK(2));
+    output += ele_per_byte;
+  }
+
+  return nbytes * ele_per_byte;
+}
+
+static const SDecodeKernels tsDecodeKernelsScalar = {
+    TSDB_DECODE_KERNEL_SCALAR, "scalar",        simple8bUnpackScalar, zigzagSumScalar, deltaOfDeltaSumScalar,
+    xorScan64Scalar,           xorScan32Scalar, boolBitmapScalar};
+
+#ifdef TD_DECODE_SIMD
+// bytes 0..3 of each group of four hold the 2-bit fields 0..3 of one input byte
+#define BOOL_FIELD_MASK  0xC0300C03
+#define BOOL_FIELD_TRUE  0x40100401
+#define BOOL_FIELD_NULL  0x80200802
+
+TD_TARGET_SSE42 static FORCE_INLINE __m128i zigzagDecodeSse42(__m128i x) {
+  __m128i sign = _mm_sub_epi64(_mm_setzero_si128(), _mm_and_si128(x, _mm_set1_epi64x(1)));
+  return _mm_xor_si128(_mm_srli_epi64(x, 1), sign);
+}
+
+TD_TARGET_SSE42 static void zigzagSumSse42(const uint64_t *input, int64_t *output, int n, int64_t *prev) {
+  __m128i carry = _mm_set1_epi64x(*prev);
+  int     i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = zigzagDecodeSse42(_mm_loadu_si128((const __m128i *)(input + i)));
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, carry);
+    _mm_storeu_si128((__m128i *)(output + i), x);
+    carry = _mm_unpackhi_epi64(x, x);
+  }
+
+  *prev = _mm_cvtsi128_si64(carry);
+  zigzagSumScalar(input + i, output + i, n - i, prev);
+}
+
+TD_TARGET_SSE42 static void deltaOfDeltaSumSse42(uint64_t *data, int n, int64_t *prevDelta, int64_t *prevValue) {
+  __m128i carryDelta = _mm_set1_epi64x(*prevDelta);
+  __m128i carryValue = _mm_set1_epi64x(*prevValue);
+  int     i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = zigzagDecodeSse42(_mm_loadu_si128((const __m128i *)(data + i)));
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, carryDelta);
+    carryDelta = _mm_unpackhi_epi64(x, x);
+
+    x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+    x = _mm_add_epi64(x, carryValue);
+    carryValue = _mm_unpackhi_epi64(x, x);
+    _mm_storeu_si128((__m128i *)(data + i), x);
+  }
+
+  *prevDelta = _mm_cvtsi128_si64(carryDelta);
+  *prevValue = _mm_cvtsi128_si64(carryValue);
+  deltaOfDeltaSumScalar(data + i, n - i, prevDelta, prevValue);
+}
+
+TD_TARGET_SSE42 static void xorScan64Sse42(uint64_t *data, int n, uint64_t *prev) {
+  __m128i carry = _mm_set1_epi64x(*prev);
+  int     i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(data + i));
+    x = _mm_xor_si128(x, _mm_slli_si128(x, 8));
+    x = _mm_xor_si128(x, carry);
+    _mm_storeu_si128((__m128i *)(data + i), x);
+    carry = _mm_unpackhi_epi64(x, x);
+  }
+
+  *prev = (uint64_t)_mm_cvtsi128_si64(carry);
+  xorScan64Scalar(data + i, n - i, prev);
+}
+
+TD_TARGET_SSE42 static void xorScan32Sse42(uint32_t *data, int n, uint32_t *prev) {
+  __m128i carry = _mm_set1_epi32(*prev);
+  int     i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(data + i));
+    x = _mm_xor_si128(x, _mm_slli_si128(x, 4));
+    x = _mm_xor_si128(x, _mm_slli_si128(x, 8));
+    x = _mm_xor_si128(x, carry);
+    _mm_storeu_si128((__m128i *)(data + i), x);
+    carry = _mm_shuffle_epi32(x, 0xFF);
+  }
+
+  *prev = (uint32_t)_mm_cvtsi128_si32(carry);
+  xorScan32Scalar(data + i, n - i, prev);
+}
+
+TD_TARGET_SSE42 static int boolBitmapSse42(const char *input, int nelements, char *output) {
+  const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+  const __m128i mask = _mm_set1_epi32(BOOL_FIELD_MASK);
+  const __m128i trueBits = _mm_set1_epi32(BOOL_FIELD_TRUE);
+  const __m128i nullBits = _mm_set1_epi32(BOOL_FIELD_NULL);
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i null = _mm_set1_epi8(TSDB_DATA_BOOL_NULL);
+  int           i = 0;
+
+  for (; i + 16 <= nelements; i += 16) {
+    int32_t packed = 0;
+    memcpy(&packed, input + i / 4, sizeof(int32_t));
+
+    __m128i x = _mm_and_si128(_mm_shuffle_epi8(_mm_cvtsi32_si128(packed), spread), mask);
+    __m128i v = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(x, trueBits), one),
+                             _mm_and_si128(_mm_cmpeq_epi8(x, nullBits), null));
+    _mm_storeu_si128((__m128i *)(output + i), v);
+  }
+
+  return i + boolBitmapScalar(input + i / 4, nelements - i, output + i);
+}
+
+TD_TARGET_AVX2 static FORCE_INLINE __m256i zigzagDecodeAvx2(__m256i x) {
+  __m256i sign = _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_and_si256(x, _mm256_set1_epi64x(1)));
+  return _mm256_xor_si256(_mm256_srli_epi64(x, 1), sign);
+}
+
+// [a, b, c, d] -> [a, a+b, a+b+c, a+b+c+d]
+TD_TARGET_AVX2 static FORCE_INLINE __m256i prefixSum64Avx2(__m256i x) {
+  const __m256i zero = _mm256_setzero_si256();
+  x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+  x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+  return x;
+}
+
+TD_TARGET_AVX2 static FORCE_INLINE __m256i prefixXor64Avx2(__m256i x) {
+  const __m256i zero = _mm256_setzero_si256();
+  x = _mm256_xor_si256(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03));
+  x = _mm256_xor_si256(x, _mm256_blend_epi32(_mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x0F));
+  return x;
+}
+
+TD_TARGET_AVX2 static int simple8bUnpackAvx2(const char **ip, uint64_t *output, int remain) {
+  const char *p = *ip;
+  int         count = 0;
+
+  while (count < remain && count < DECODE_CHUNK_SIZE) {
+    uint64_t w = 0;
+    memcpy(&w, p, LONG_BYTES);
+    p += LONG_BYTES;
+
+    int selector = (int)(w & INT64MASK(4));
+    int bit = simple8bBitPerInteger[selector];
+    int elems = MIN(simple8bSelectorToElems[selector], remain - count);
+    int i = 0;
+
+    if (bit == 0) {
+      memset(output + count, 0, elems * sizeof(uint64_t));
+      count += elems;
+      continue;
+    }
+
+    const __m256i word = _mm256_set1_epi64x((int64_t)w);
+    const __m256i mask = _mm256_set1_epi64x((int64_t)INT64MASK(bit));
+    const __m256i step = _mm256_set1_epi64x(4 * bit);
+    __m256i       shift = _mm256_setr_epi64x(4, 4 + bit, 4 + 2 * bit, 4 + 3 * bit);
+    for (; i + 4 <= elems; i += 4) {
+      _mm256_storeu_si256((__m256i *)(output + count + i), _mm256_and_si256(_mm256_srlv_epi64(word, shift), mask));
+      shift = _mm256_add_epi64(shift, step);
+    }
+    for (; i < elems; i++) {
+      output[count + i] = (w >> (4 + bit * i)) & INT64MASK(bit);
+    }
+    count += elems;
+  }
+
+  *ip = p;
+  return count;
+}
+
+TD_TARGET_AVX2 static void zigzagSumAvx2(const uint64_t *input, int64_t *output, int n, int64_t *prev) {
+  __m256i carry = _mm256_set1_epi64x(*prev);
+  int     i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = zigzagDecodeAvx2(_mm256_loadu_si256((const __m256i *)(input + i)));
+    x = _mm256_add_epi64(prefixSum64Avx2(x), carry);
+    _mm256_storeu_si256((__m256i *)(output + i), x);
+    carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  *prev = _mm_cvtsi128_si64(_mm256_castsi256_si128(carry));
+  zigzagSumScalar(input + i, output + i, n - i, prev);
+}
+
+TD_TARGET_AVX2 static void deltaOfDeltaSumAvx2(uint64_t *data, int n, int64_t *prevDelta, int64_t *prevValue) {
+  __m256i carryDelta = _mm256_set1_epi64x(*prevDelta);
+  __m256i carryValue = _mm256_set1_epi64x(*prevValue);
+  int     i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = zigzagDecodeAvx2(_mm256_loadu_si256((const __m256i *)(data + i)));
+    x = _mm256_add_epi64(prefixSum64Avx2(x), carryDelta);
+    carryDelta = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+
+    x = _mm256_add_epi64(prefixSum64Avx2(x), carryValue);
+    carryValue = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+    _mm256_storeu_si256((__m256i *)(data + i), x);
+  }
+
+  *prevDelta = _mm_cvtsi128_si64(_mm256_castsi256_si128(carryDelta));
+  *prevValue = _mm_cvtsi128_si64(_mm256_castsi256_si128(carryValue));
+  deltaOfDeltaSumScalar(data + i, n - i, prevDelta, prevValue);
+}
+
+TD_TARGET_AVX2 static void xorScan64Avx2(uint64_t *data, int n, uint64_t *prev) {
+  __m256i carry = _mm256_set1_epi64x((int64_t)(*prev));
+  int     i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256i x = prefixXor64Avx2(_mm256_loadu_si256((const __m256i *)(data + i)));
+    x = _mm256_xor_si256(x, carry);
+    _mm256_storeu_si256((__m256i *)(data + i), x);
+    carry = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+  }
+
+  *prev = (uint64_t)_mm_cvtsi128_si64(_mm256_castsi256_si128(carry));
+  xorScan64Scalar(data + i, n - i, prev);
+}
+
+TD_TARGET_AVX2 static void xorScan32Avx2(uint32_t *data, int n, uint32_t *prev) {
+  const __m256i lane3 = _mm256_set1_epi32(3);
+  const __m256i lane7 = _mm256_set1_epi32(7);
+  __m256i       carry = _mm256_set1_epi32((int32_t)(*prev));
+  int           i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(data + i));
+    // prefix xor inside each 128-bit lane, then carry the low lane into the high one
+    x = _mm256_xor_si256(x, _mm256_slli_si256(x, 4));
+    x = _mm256_xor_si256(x, _mm256_slli_si256(x, 8));
+    x = _mm256_xor_si256(x, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(x, lane3), 0xF0));
+    x = _mm256_xor_si256(x, carry);
+    _mm256_storeu_si256((__m256i *)(data + i), x);
+    carry = _mm256_permutevar8x32_epi32(x, lane7);
+  }
+
+  *prev = (uint32_t)_mm_cvtsi128_si32(_mm256_castsi256_si128(carry));
+  xorScan32Scalar(data + i, n - i, prev);
+}
+
+TD_TARGET_AVX2 static int boolBitmapAvx2(const char *input, int nelements, char *output) {
+  const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                          4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+  const __m256i mask = _mm256_set1_epi32(BOOL_FIELD_MASK);
+  const __m256i trueBits = _mm256_set1_epi32(BOOL_FIELD_TRUE);
+  const __m256i nullBits = _mm256_set1_epi32(BOOL_FIELD_NULL);
+  const __m256i one = _mm256_set1_epi8(1);
+  const __m256i null = _mm256_set1_epi8(TSDB_DATA_BOOL_NULL);
+  int           i = 0;
+
+  for (; i + 32 <= nelements; i += 32) {
+    int64_t packed = 0;
+    memcpy(&packed, input + i / 4, sizeof(int64_t));
+
+    __m256i x = _mm256_and_si256(_mm256_shuffle_epi8(_mm256_set1_epi64x(packed), spread), mask);
+    __m256i v = _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(x, trueBits), one),
+                                _mm256_and_si256(_mm256_cmpeq_epi8(x, nullBits), null));
+    _mm256_storeu_si256((__m256i *)(output + i), v);
+  }
+
+  return i + boolBitmapScalar(input + i / 4, nelements - i, output + i);
+}
+
+static const SDecodeKernels tsDecodeKernelsSse42 = {
+    TSDB_DECODE_KERNEL_SSE42, "sse4.2",       simple8bUnpackScalar, zigzagSumSse42, deltaOfDeltaSumSse42,
+    xorScan64Sse42,           xorScan32Sse42, boolBitmapSse42};
+
+static const SDecodeKernels tsDecodeKernelsAvx2 = {
+    TSDB_DECODE_KERNEL_AVX2, "avx2",        simple8bUnpackAvx2, zigzagSumAvx2, deltaOfDeltaSumAvx2,
+    xorScan64Avx2,           xorScan32Avx2, boolBitmapAvx2};
+#endif
+
+static pthread_once_t        tsDecodeKernelInit = PTHREAD_ONCE_INIT;
+static const SDecodeKernels *tsDecodeKernels = &tsDecodeKernelsScalar;
+
+static const SDecodeKernels *tsGetDecodeKernelsImpl(int kernel) {
+#ifdef TD_DECODE_SIMD
+  __builtin_cpu_init();
+  if (kernel >= TSDB_DECODE_KERNEL_AVX2 && __builtin_cpu_supports("avx2")) return &tsDecodeKernelsAvx2;
+  if (kernel >= TSDB_DECODE_KERNEL_SSE42 && __builtin_cpu_supports("sse4.2")) return &tsDecodeKernelsSse42;
+#endif
+  return &tsDecodeKernelsScalar;
+}
+
+static void tsResolveDecodeKernels() { tsDecodeKernels = tsGetDecodeKernelsImpl(TSDB_DECODE_KERNEL_AVX2); }
+
+static FORCE_INLINE const SDecodeKernels *tsGetDecodeKernels() {
+  pthread_once(&tsDecodeKernelInit, tsResolveDecodeKernels);
+  return tsDecodeKernels;
+}
+
+int tsSetDecodeKernel(int kernel) {
+  pthread_once(&tsDecodeKernelInit, tsResolveDecodeKernels);
+  tsDecodeKernels = tsGetDecodeKernelsImpl(kernel);
+  uDebug("decode kernel is set to %s", tsDecodeKernels->name);
+  return tsDecodeKernels->kernel;
+}
+
+int tsGetDecodeKernel() { return tsGetDecodeKernels()->kernel; }
+
+const char *tsGetDecodeKernelName(int kernel) { return tsGetDecodeKernelsImpl(kernel)->name; }
+
 #ifdef TD_TSZ
 bool lossyFloat  = false;
 bool lossyDouble = false;
@@ -258,63 +686,37 @@ int tsDecompressINTImp(const char *const input, const int nelements, char *const
     return nelements * word_length;
   }
 
-  // Selector value:              0    1   2   3   4   5   6   7   8  9  10  11
-  // 12  13  14  15
-  char bit_per_integer[] = {0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 12, 15, 20, 30, 60};
-  int  selector_to_elems[] = {240, 120, 60, 30, 20, 15, 12, 10, 8, 7, 6, 5, 4, 3, 2, 1};
+  const SDecodeKernels *pKernels = tsGetDecodeKernels();
 
+  uint64_t    buffer[DECODE_CHUNK_SIZE + SIMPLE8B_MAX_ELEMS];
   const char *ip = input + 1;
-  int         count = 0;
-  int         _pos = 0;
   int64_t     prev_value = 0;
 
-  while (1) {
-    if (count == nelements) break;
+  for (int count = 0; count < nelements;) {
+    int n = (*pKernels->simple8bUnpack)(&ip, buffer, nelements - count);
 
-    uint64_t w = 0;
-    memcpy(&w, ip, LONG_BYTES);
-
-    char selector = (char)(w & INT64MASK(4));  // selector = 4
-    char bit = bit_per_integer[(int)selector];      // bit = 3
-    int  elems = selector_to_elems[(int)selector];
-
-    for (int i = 0; i < elems; i++) {
-      uint64_t zigzag_value;
-
-      if (selector == 0 || selector == 1) {
-        zigzag_value = 0;
-      } else {
-        zigzag_value = ((w >> (4 + bit * i)) & INT64MASK(bit));
-      }
-      int64_t diff = ZIGZAG_DECODE(int64_t, zigzag_value);
-      int64_t curr_value = diff + prev_value;
-      prev_value = curr_value;
+    if (type == TSDB_DATA_TYPE_BIGINT) {
+      (*pKernels->zigzagSum)(buffer, (int64_t *)output + count, n, &prev_value);
+    } else {
+      int64_t *values = (int64_t *)buffer;
+      (*pKernels->zigzagSum)(buffer, values, n, &prev_value);
 
       switch (type) {
-        case TSDB_DATA_TYPE_BIGINT:
-          *((int64_t *)output + _pos) = (int64_t)curr_value;
-          _pos++;
-          break;
         case TSDB_DATA_TYPE_INT:
-          *((int32_t *)output + _pos) = (int32_t)curr_value;
-          _pos++;
+          for (int i = 0; i < n; i++) *((int32_t *)output + count + i) = (int32_t)values[i];
           break;
         case TSDB_DATA_TYPE_SMALLINT:
-          *((int16_t *)output + _pos) = (int16_t)curr_value;
-          _pos++;
+          for (int i = 0; i < n; i++) *((int16_t *)output + count + i) = (int16_t)values[i];
           break;
         case TSDB_DATA_TYPE_TINYINT:
-          *((int8_t *)output + _pos) = (int8_t)curr_value;
-          _pos++;
+          for (int i = 0; i < n; i++) *((int8_t *)output + count + i) = (int8_t)values[i];
           break;
         default:
           perror("Wrong integer types.\n");
           return -1;
       }
-      count++;
-      if (count == nelements) break;
     }
-    ip += LONG_BYTES;
+    count += n;
   }
 
   return nelements * word_length;
@@ -358,19 +760,18 @@ int tsDecompressBoolImp(const char *const input, const int nelements, char *cons
   int ipos = -1, opos = 0;
   int ele_per_byte = BITS_PER_BYTE / 2;
 
-  for (int i = 0; i < nelements; i++) {
+  // whole bytes go through the bitmap kernel, the partial tail byte is decoded here
+  int done = (*tsGetDecodeKernels()->boolBitmap)(input, nelements, output);
+  ipos = done / ele_per_byte - 1;
+  opos = done;
+
+  for (int i = done; i < nelements; i++) {
     if (i % ele_per_byte == 0) {
       ipos++;
     }
 
     uint8_t ele = (input[ipos] >> (2 * (i % ele_per_byte))) & INT8MASK(2);
-    if (ele == 1) {
-      output[opos++] = 1;
-    } else if (ele == 2) {
-      output[opos++] = TSDB_DATA_BOOL_NULL;
-    } else {
-      output[opos++] = 0;
-    }
+    output[opos++] = decodeBoolValue(ele);
   }
 
   return nelements;
@@ -567,6 +968,30 @@ _exit_over:
   return nelements * LONG_BYTES + 1;
 }
 
+static const uint64_t timestampByteMask[] = {0x0,
+                                             0xFF,
+                                             0xFFFF,
+                                             0xFFFFFF,
+                                             0xFFFFFFFF,
+                                             0xFFFFFFFFFF,
+                                             0xFFFFFFFFFFFF,
+                                             0xFFFFFFFFFFFFFF,
+                                             0xFFFFFFFFFFFFFFFF};
+
+static FORCE_INLINE uint64_t decodeTimestampValue(const char *const input, int *const ipos, uint8_t nbytes) {
+  uint64_t dd = 0;
+  if (is_bigendian()) {
+    memcpy(((char *)(&dd)) + LONG_BYTES - nbytes, input + *ipos, nbytes);
+  } else {
+    // same as a memcpy into the low bytes, without a library call per value
+    for (int i = 0; i < nbytes; i++) {
+      dd |= ((uint64_t)(uint8_t)input[*ipos + i]) << (BITS_PER_BYTE * i);
+    }
+  }
+  *ipos += nbytes;
+  return dd;
+}
+
 int tsDecompressTimestampImp(const char *const input, const int nelements, char *const output) {
   assert(nelements >= 0);
   if (nelements == 0) return 0;
@@ -575,62 +1000,45 @@ int tsDecompressTimestampImp(const char *const input, const int nelements, char
     memcpy(output, input + 1, nelements * LONG_BYTES);
     return nelements * LONG_BYTES;
   } else if (input[0] == 1) {  // Decompress
-    int64_t *ostream = (int64_t *)output;
+    uint64_t *ostream = (uint64_t *)output;
 
     int     ipos = 1, opos = 0;
-    int8_t  nbytes = 0;
     int64_t prev_value = 0;
     int64_t prev_delta = 0;
-    int64_t delta_of_delta = 0;
 
-    while (1) {
-      uint8_t flags = input[ipos++];
-      // Decode dd1
-      uint64_t dd1 = 0;
-      nbytes = flags & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd1)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd1, input + ipos, nbytes);
-        }
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd1);
-      }
-      ipos += nbytes;
-      if (opos == 0) {
-        prev_value = delta_of_delta;
-        prev_delta = 0;
-        ostream[opos++] = delta_of_delta;
-      } else {
-        prev_delta = delta_of_delta + prev_delta;
-        prev_value = prev_value + prev_delta;
-        ostream[opos++] = prev_value;
-      }
-      if (opos == nelements) return nelements * LONG_BYTES;
-
-      // Decode dd2
-      uint64_t dd2 = 0;
-      nbytes = (flags >> 4) & INT8MASK(4);
-      if (nbytes == 0) {
-        delta_of_delta = 0;
-      } else {
-        if (is_bigendian()) {
-          memcpy(((char *)(&dd2)) + LONG_BYTES - nbytes, input + ipos, nbytes);
-        } else {
-          memcpy(&dd2, input + ipos, nbytes);
-        }
-        // zigzag_decoding
-        delta_of_delta = ZIGZAG_DECODE(int64_t, dd2);
+    // Unpack the zigzag encoded delta of delta values in place, then rebuild the timestamps. While at
+    // least 8 more pairs follow, their flag bytes guarantee a full word can be loaded and masked.
+    int i = 0;
+    if (!is_bigendian()) {
+      for (; i + 8 < nelements / 2; i++) {
+        uint8_t  flags = input[ipos++];
+        uint8_t  nbytes = flags & INT8MASK(4);
+        uint64_t dd = 0;
+        memcpy(&dd, input + ipos, LONG_BYTES);
+        ostream[opos++] = dd & timestampByteMask[nbytes];
+        ipos += nbytes;
+
+        nbytes = (flags >> 4) & INT8MASK(4);
+        memcpy(&dd, input + ipos, LONG_BYTES);
+        ostream[opos++] = dd & timestampByteMask[nbytes];
+        ipos += nbytes;
       }
-      ipos += nbytes;
-      prev_delta = delta_of_delta + prev_delta;
-      prev_value = prev_value + prev_delta;
-      ostream[opos++] = prev_value;
-      if (opos == nelements) return nelements * LONG_BYTES;
+    }
+    for (; i < nelements / 2; i++) {
+      uint8_t flags = input[ipos++];
+      ostream[opos++] = decodeTimestampValue(input, &ipos, flags & INT8MASK(4));
+      ostream[opos++] = decodeTimestampValue(input, &ipos, (flags >> 4) & INT8MASK(4));
+    }
+    if (nelements % 2 == 1) {
+      uint8_t flags = input[ipos++];
+      ostream[opos++] = decodeTimestampValue(input, &ipos, flags & INT8MASK(4));
     }
 
+    // The encoder starts from prev_delta = -ts[0], so the first delta of delta is ts[0] itself.
+    prev_value = (int64_t)(ZIGZAG_DECODE(int64_t, ostream[0]));
+    prev_delta = (int64_t)(0 - (uint64_t)prev_value);
+    (*tsGetDecodeKernels()->deltaOfDeltaSum)(ostream, nelements, &prev_delta, &prev_value);
+    return nelements * LONG_BYTES;
   } else {
     assert(0);
     return -1;
@@ -748,7 +1156,7 @@ uint64_t decodeDoubleValue(const char *const input, int *const ipos, uint8_t fla
 
 int tsDecompressDoubleImp(const char *const input, const int nelements, char *const output) {
   // output stream
-  double *ostream = (double *)output;
+  uint64_t *ostream = (uint64_t *)output;
 
   if (input[0] == 1) {
     memcpy(output, input + 1, nelements * DOUBLE_BYTES);
@@ -760,6 +1168,7 @@ int tsDecompressDoubleImp(const char *const input, const int nelements, char *co
   int      opos = 0;
   uint64_t prev_value = 0;
 
+  // Unpack the xor differences in place, then restore the values with a prefix xor.
   for (int i = 0; i < nelements; i++) {
     if (i % 2 == 0) {
       flags = input[ipos++];
@@ -768,19 +1177,10 @@ int tsDecompressDoubleImp(const char *const input, const int nelements, char *co
     uint8_t flag = flags & INT8MASK(4);
     flags >>= 4;
 
-    uint64_t diff = decodeDoubleValue(input, &ipos, flag);
-    union {
-      uint64_t bits;
-      double   real;
-    } curr;
-
-    uint64_t predicted = prev_value;
-    curr.bits = predicted ^ diff;
-    prev_value = curr.bits;
-
-    ostream[opos++] = curr.real;
+    ostream[opos++] = decodeDoubleValue(input, &ipos, flag);
   }
 
+  (*tsGetDecodeKernels()->xorScan64)(ostream, nelements, &prev_value);
   return nelements * DOUBLE_BYTES;
 }
 
@@ -894,7 +1294,7 @@ uint32_t decodeFloatValue(const char *const input, int *const ipos, uint8_t flag
 }
 
 int tsDecompressFloatImp(const char *const input, const int nelements, char *const output) {
-  float *ostream = (float *)output;
+  uint32_t *ostream = (uint32_t *)output;
 
   if (input[0] == 1) {
     memcpy(output, input + 1, nelements * FLOAT_BYTES);
@@ -906,6 +1306,7 @@ int tsDecompressFloatImp(const char *const input, const int nelements, char *con
   int      opos = 0;
   uint32_t prev_value = 0;
 
+  // Unpack the xor differences in place, then restore the values with a prefix xor.
   for (int i = 0; i < nelements; i++) {
     if (i % 2 == 0) {
       flags = input[ipos++];
@@ -914,19 +1315,10 @@ int tsDecompressFloatImp(const char *const input, const int nelements, char *con
     uint8_t flag = flags & INT8MASK(4);
     flags >>= 4;
 
-    uint32_t diff = decodeFloatValue(input, &ipos, flag);
-    union {
-      uint32_t bits;
-      float    real;
-    } curr;
-
-    uint32_t predicted = prev_value;
-    curr.bits = predicted ^ diff;
-    prev_value = curr.bits;
-
-    ostream[opos++] = curr.real;
+    ostream[opos++] = decodeFloatValue(input, &ipos, flag);
   }
 
+  (*tsGetDecodeKernels()->xorScan32)(ostream, nelements, &prev_value);
   return nelements * FLOAT_BYTES;
 }
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "taoserror.h"
+#include "tfixedhash.h"
+#include "tutil.h"
+
+#define FIXED_HASH_PAGE_SIZE   (64 * 1024)
+#define FIXED_HASH_MAX_ENTRIES (UINT32_MAX - 1)
+
+// grow the slots once they are more than 70% occupied, probes get long quickly beyond that
+#define FIXED_HASH_NEED_RESIZE(_h) ((_h)->size * 10 >= (_h)->capacity * 7)
+
+#define FIXED_HASH_PAGE_ENTRIES(_h) (1u << (_h)->pageShift)
+
+#define GET_FIXED_HASH_ENTRY(_h, _index)                                                    \
+  ((char *)taosArrayGetP((_h)->pPages, (_index) >> (_h)->pageShift) +                       \
+   (size_t)((_index) & (FIXED_HASH_PAGE_ENTRIES(_h) - 1)) * (_h)->entrySize)
+
+#define GET_FIXED_HASH_DATA(_h, _index) (GET_FIXED_HASH_ENTRY(_h, _index) + (_h)->dataOffset)
+
+// mix the key by words of 8 bytes, the keys are short so this is much cheaper than MurmurHash3
+static uint32_t fixedHashKey(const void *key, int32_t len) {
+  const char *p = key;
+  uint64_t    h = 0x9E3779B97F4A7C15ULL ^ (uint64_t)len;
+
+  for (; len >= 8; len -= 8, p += 8) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+  }
+
+  if (len > 0) {
+    uint64_t w = 0;
+    memcpy(&w, p, len);
+    h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 32;
+  }
+
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 29;
+  return (uint32_t)h;
+}
+
+static size_t fixedHashCapacity(size_t capacity) {
+  size_t n = 16;
+  while (n < capacity) {
+    n <<= 1;
+  }
+  return n;
+}
+
+SFixedHashObj *taosFixedHashInit(int32_t keyLen, int32_t dataLen, size_t capacity) {
+  assert(keyLen > 0 && dataLen >= 0);
+
+  SFixedHashObj *pHashObj = calloc(1, sizeof(SFixedHashObj));
+  if (pHashObj == NULL) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  pHashObj->keyLen = keyLen;
+  pHashObj->dataLen = dataLen;
+  pHashObj->dataOffset = ALIGN8(keyLen);
+  pHashObj->entrySize = ALIGN8(pHashObj->dataOffset + dataLen);
+  while (((size_t)pHashObj->entrySize << (pHashObj->pageShift + 1)) <= FIXED_HASH_PAGE_SIZE) {
+    pHashObj->pageShift++;
+  }
+  pHashObj->capacity = fixedHashCapacity(capacity);
+  pHashObj->slots = calloc(pHashObj->capacity, sizeof(SFixedHashSlot));
+  pHashObj->pPages = taosArrayInit(4, POINTER_BYTES);
+
+  if (pHashObj->slots == NULL || pHashObj->pPages == NULL) {
+    taosFixedHashCleanup(pHashObj);
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  return pHashObj;
+}
+
+static void fixedHashFreePage(void *p) {
+  free(*(char **)p);
+}
+
+void taosFixedHashCleanup(SFixedHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  taosArrayDestroyEx(pHashObj->pPages, fixedHashFreePage);
+  tfree(pHashObj->slots);
+  free(pHashObj);
+}
+
+// return the slot of the key, or the empty slot where it should be put
+static SFixedHashSlot *fixedHashFindSlot(SFixedHashObj *pHashObj, const void *key, uint32_t hashVal) {
+  size_t mask = pHashObj->capacity - 1;
+
+  for (size_t i = hashVal & mask;; i = (i + 1) & mask) {
+    SFixedHashSlot *pSlot = &pHashObj->slots[i];
+    if (pSlot->index == 0) {
+      return pSlot;
+    }
+
+    if (pSlot->hashVal == hashVal &&
+        memcmp(GET_FIXED_HASH_ENTRY(pHashObj, pSlot->index - 1), key, pHashObj->keyLen) == 0) {
+      return pSlot;
+    }
+  }
+}
+
+static int32_t fixedHashResize(SFixedHashObj *pHashObj) {
+  size_t          capacity = pHashObj->capacity << 1;
+  SFixedHashSlot *slots = calloc(capacity, sizeof(SFixedHashSlot));
+  if (slots == NULL) {
+    return -1;
+  }
+
+  // the hash values are kept in the slots, so the keys are not read again
+  for (size_t i = 0; i < pHashObj->capacity; ++i) {
+    SFixedHashSlot *pSlot = &pHashObj->slots[i];
+    if (pSlot->index == 0) {
+      continue;
+    }
+
+    size_t j = pSlot->hashVal & (capacity - 1);
+    while (slots[j].index != 0) {
+      j = (j + 1) & (capacity - 1);
+    }
+    slots[j] = *pSlot;
+  }
+
+  free(pHashObj->slots);
+  pHashObj->slots = slots;
+  pHashObj->capacity = capacity;
+  return 0;
+}
+
+void *taosFixedHashGet(SFixedHashObj *pHashObj, const void *key) {
+  SFixedHashSlot *pSlot = fixedHashFindSlot(pHashObj, key, fixedHashKey(key, pHashObj->keyLen));
+  if (pSlot->index == 0) {
+    return NULL;
+  }
+
+  return GET_FIXED_HASH_DATA(pHashObj, pSlot->index - 1);
+}
+
+void *taosFixedHashPut(SFixedHashObj *pHashObj, const void *key, const void *data, bool *exist) {
+  // a failure to grow only makes the probes longer, but one slot is always left empty to stop the probing
+  if (FIXED_HASH_NEED_RESIZE(pHashObj) && fixedHashResize(pHashObj) != 0 && pHashObj->size + 1 >= pHashObj->capacity) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  uint32_t        hashVal = fixedHashKey(key, pHashObj->keyLen);
+  SFixedHashSlot *pSlot = fixedHashFindSlot(pHashObj, key, hashVal);
+
+  if (pSlot->index != 0) {
+    *exist = true;
+    return GET_FIXED_HASH_DATA(pHashObj, pSlot->index - 1);
+  }
+
+  *exist = false;
+  if (pHashObj->size >= FIXED_HASH_MAX_ENTRIES) {
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  if ((pHashObj->size & (FIXED_HASH_PAGE_ENTRIES(pHashObj) - 1)) == 0) {
+    char *pPage = malloc((size_t)FIXED_HASH_PAGE_ENTRIES(pHashObj) * pHashObj->entrySize);
+    if (pPage == NULL || taosArrayPush(pHashObj->pPages, &pPage) == NULL) {
+      tfree(pPage);
+      terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+      return NULL;
+    }
+  }
+
+  char *pEntry = GET_FIXED_HASH_ENTRY(pHashObj, pHashObj->size);
+  char *pData = pEntry + pHashObj->dataOffset;
+  memcpy(pEntry, key, pHashObj->keyLen);
+  if (data != NULL) {
+    memcpy(pData, data, pHashObj->dataLen);
+  } else {
+    memset(pData, 0, pHashObj->dataLen);
+  }
+
+  pSlot->hashVal = hashVal;
+  pSlot->index = (uint32_t)(++pHashObj->size);
+  return pData;
+}
+
+size_t taosFixedHashGetSize(const SFixedHashObj *pHashObj) {
+  return (pHashObj == NULL) ? 0 : pHashObj->size;
+}
+
+size_t taosFixedHashGetMemSize(const SFixedHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return 0;
+  }
+
+  return pHashObj->capacity * sizeof(SFixedHashSlot) +
+         taosArrayGetSize(pHashObj->pPages) * (size_t)FIXED_HASH_PAGE_ENTRIES(pHashObj) * pHashObj->entrySize +
+         sizeof(SFixedHashObj);
+}
@@ -143,6 +143,71 @@ int32_t taosWriteMsg(SOCKET fd, void *buf, int32_t nbytes) {
   return (nbytes - nleft);
 }
 
+#define TSDB_SOCKET_MAX_IOV 64
+
+/*
+ * write the buffers in order with as few system calls as possible, returns the total number of bytes written,
+ * or -1 if any of the buffers can not be written completely
+ */
+int32_t taosWriteMsgv(SOCKET fd, SSocketBuf *bufs, int32_t num) {
+  int32_t total = 0;
+
+#if defined(_TD_WINDOWS_64) || defined(_TD_WINDOWS_32)
+  for (int32_t i = 0; i < num; ++i) {
+    if (taosWriteMsg(fd, bufs[i].buf, bufs[i].len) != bufs[i].len) {
+      return -1;
+    }
+
+    total += bufs[i].len;
+  }
+#else
+  struct iovec iov[TSDB_SOCKET_MAX_IOV];
+
+  int32_t index = 0;
+  while (index < num) {
+    int32_t cnt = MIN(num - index, TSDB_SOCKET_MAX_IOV);
+    int64_t left = 0;
+    for (int32_t i = 0; i < cnt; ++i) {
+      iov[i].iov_base = bufs[index + i].buf;
+      iov[i].iov_len  = bufs[index + i].len;
+      left += bufs[index + i].len;
+    }
+
+    struct iovec *pIov = iov;
+    int32_t       iovcnt = cnt;
+    while (left > 0) {
+      ssize_t nwritten = writev(fd, pIov, iovcnt);
+      if (nwritten <= 0) {
+        if (errno == EINTR) continue;
+        return -1;
+      }
+
+      left -= nwritten;
+
+      // skip the buffers that are written completely, and adjust the one partially written
+      while (iovcnt > 0 && nwritten >= (ssize_t)pIov->iov_len) {
+        nwritten -= pIov->iov_len;
+        pIov++;
+        iovcnt--;
+      }
+
+      if (iovcnt > 0) {
+        pIov->iov_base = (char *)pIov->iov_base + nwritten;
+        pIov->iov_len -= nwritten;
+      }
+    }
+
+    for (int32_t i = 0; i < cnt; ++i) {
+      total += bufs[index + i].len;
+    }
+
+    index += cnt;
+  }
+#endif
+
+  return total;
+}
+
 int32_t taosReadMsg(SOCKET fd, void *buf, int32_t nbytes) {
   int32_t nleft, nread;
   char *  ptr = (char *)buf;
@@ -0,0 +1,7 @@
+char version[12] = "2.3.1.0";
+char compatible_version[12] = "2.0.0.0";
+char gitinfo[48] = "0fdd4c00fca5210ec89a26cc10f28e9448b61ff6";
+char gitinfoOfInternal[48] = "0fdd4c00fca5210ec89a26cc10f28e9448b61ff6";
+char buildinfo[64] = "Built at 2026-10-17 12:53:27";
+
+void libtaos_2_3_1_0_Linux_x32_stable() {};
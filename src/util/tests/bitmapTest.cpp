@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "os.h"
+#include "tbitmap.h"
+
+namespace {
+
+void checkEqual(const SBitmap *pBitmap, const std::set<uint32_t> &expected) {
+  ASSERT_EQ(tBitmapCardinality(pBitmap), expected.size());
+
+  SBitmapIter           iter;
+  uint32_t              id;
+  std::vector<uint32_t> ids;
+  tBitmapIterInit(&iter, pBitmap);
+  while (tBitmapIterNext(&iter, &id)) {
+    ids.push_back(id);
+  }
+  ASSERT_EQ(ids, std::vector<uint32_t>(expected.begin(), expected.end()));
+}
+
+// ids clustered around a few high keys, so containers go through both the array and the bitmap form
+SBitmap *generate(std::mt19937 &rng, int num, uint32_t range, std::set<uint32_t> &ids) {
+  SBitmap *pBitmap = tBitmapCreate();
+  for (int i = 0; i < num; ++i) {
+    uint32_t id = (rng() % 3) * 65536 + rng() % range;
+    EXPECT_EQ(tBitmapAdd(pBitmap, id), 0);
+    ids.insert(id);
+  }
+  return pBitmap;
+}
+
+}  // namespace
+
+TEST(testCase, bitmap_add_remove) {
+  std::mt19937       rng(1);
+  std::set<uint32_t> ids;
+  SBitmap *          pBitmap = tBitmapCreate();
+
+  for (int i = 0; i < 20000; ++i) {
+    uint32_t id = rng() % 70000;
+    tBitmapAdd(pBitmap, id);
+    ids.insert(id);
+  }
+  checkEqual(pBitmap, ids);
+
+  for (uint32_t id = 0; id < 70000; ++id) {
+    ASSERT_EQ(tBitmapContains(pBitmap, id), ids.count(id) > 0) << id;
+  }
+
+  for (int i = 0; i < 30000; ++i) {
+    uint32_t id = rng() % 70000;
+    tBitmapRemove(pBitmap, id);
+    ids.erase(id);
+  }
+  checkEqual(pBitmap, ids);
+
+  for (uint32_t id = 0; id < 70000; ++id) {
+    tBitmapRemove(pBitmap, id);
+  }
+  ASSERT_EQ(pBitmap->num, 0);
+
+  tBitmapAdd(pBitmap, 0xFFFFFFFF);
+  ASSERT_TRUE(tBitmapContains(pBitmap, 0xFFFFFFFF));
+  checkEqual(pBitmap, std::set<uint32_t>{0xFFFFFFFF});
+
+  tBitmapDestroy(pBitmap);
+}
+
+TEST(testCase, bitmap_and_or) {
+  std::mt19937 rng(2);
+  const int    kSizes[] = {0, 10, 3000, 5000, 30000};
+
+  for (int n1 : kSizes) {
+    for (int n2 : kSizes) {
+      std::set<uint32_t> s1, s2, sAnd, sOr;
+      SBitmap *          b1 = generate(rng, n1, 20000, s1);
+      SBitmap *          b2 = generate(rng, n2, 20000, s2);
+
+      std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(), std::inserter(sAnd, sAnd.begin()));
+      std::set_union(s1.begin(), s1.end(), s2.begin(), s2.end(), std::inserter(sOr, sOr.begin()));
+
+      SBitmap *bAnd = tBitmapDup(b1);
+      ASSERT_EQ(tBitmapAnd(bAnd, b2), 0);
+      checkEqual(bAnd, sAnd);
+
+      SBitmap *bOr = tBitmapDup(b1);
+      ASSERT_EQ(tBitmapOr(bOr, b2), 0);
+      checkEqual(bOr, sOr);
+
+      checkEqual(b1, s1);
+      checkEqual(b2, s2);
+
+      tBitmapDestroy(b1);
+      tBitmapDestroy(b2);
+      tBitmapDestroy(bAnd);
+      tBitmapDestroy(bOr);
+    }
+  }
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "taosdef.h"
+#include "tscompression.h"
+
+/*
+ * Decode throughput of each codec with every decode kernel the cpu supports.
+ * usage: compressBench [-n rows per block] [-l loops]
+ */
+
+typedef struct {
+  const char *name;
+  int         bytes;
+  int         type;
+} SCodec;
+
+static SCodec codecs[] = {
+    {"timestamp", LONG_BYTES, TSDB_DATA_TYPE_TIMESTAMP}, {"bigint", LONG_BYTES, TSDB_DATA_TYPE_BIGINT},
+    {"int", INT_BYTES, TSDB_DATA_TYPE_INT},              {"smallint", SHORT_BYTES, TSDB_DATA_TYPE_SMALLINT},
+    {"tinyint", CHAR_BYTES, TSDB_DATA_TYPE_TINYINT},     {"bool", CHAR_BYTES, TSDB_DATA_TYPE_BOOL},
+    {"float", FLOAT_BYTES, TSDB_DATA_TYPE_FLOAT},        {"double", DOUBLE_BYTES, TSDB_DATA_TYPE_DOUBLE},
+};
+
+static void generateData(SCodec *pCodec, char *data, int rows) {
+  int64_t ts = 1600000000000L;
+  int64_t v = 0;
+  double  d = 20.0;
+
+  for (int i = 0; i < rows; i++) {
+    v += rand() % 64 - 32;
+    d += (rand() % 1000) / 100.0 - 5.0;
+    switch (pCodec->type) {
+      case TSDB_DATA_TYPE_TIMESTAMP:
+        ts += 1000 + ((rand() % 10 == 0) ? rand() % 20 : 0);
+        ((int64_t *)data)[i] = ts;
+        break;
+      case TSDB_DATA_TYPE_BIGINT:
+        ((int64_t *)data)[i] = v;
+        break;
+      case TSDB_DATA_TYPE_INT:
+        ((int32_t *)data)[i] = (int32_t)v;
+        break;
+      case TSDB_DATA_TYPE_SMALLINT:
+        ((int16_t *)data)[i] = (int16_t)v;
+        break;
+      case TSDB_DATA_TYPE_TINYINT:
+        ((int8_t *)data)[i] = (int8_t)v;
+        break;
+      case TSDB_DATA_TYPE_BOOL:
+        data[i] = (rand() % 8 == 0) ? TSDB_DATA_BOOL_NULL : rand() % 2;
+        break;
+      case TSDB_DATA_TYPE_FLOAT:
+        ((float *)data)[i] = (float)d;
+        break;
+      case TSDB_DATA_TYPE_DOUBLE:
+        ((double *)data)[i] = d;
+        break;
+    }
+  }
+}
+
+static int compressData(SCodec *pCodec, const char *input, int rows, char *output) {
+  switch (pCodec->type) {
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return tsCompressTimestampImp(input, rows, output);
+    case TSDB_DATA_TYPE_BOOL:
+      return tsCompressBoolImp(input, rows, output);
+    case TSDB_DATA_TYPE_FLOAT:
+      return tsCompressFloatImp(input, rows, output);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return tsCompressDoubleImp(input, rows, output);
+    default:
+      return tsCompressINTImp(input, rows, output, (char)pCodec->type);
+  }
+}
+
+static int decompressData(SCodec *pCodec, const char *input, int rows, char *output) {
+  switch (pCodec->type) {
+    case TSDB_DATA_TYPE_TIMESTAMP:
+      return tsDecompressTimestampImp(input, rows, output);
+    case TSDB_DATA_TYPE_BOOL:
+      return tsDecompressBoolImp(input, rows, output);
+    case TSDB_DATA_TYPE_FLOAT:
+      return tsDecompressFloatImp(input, rows, output);
+    case TSDB_DATA_TYPE_DOUBLE:
+      return tsDecompressDoubleImp(input, rows, output);
+    default:
+      return tsDecompressINTImp(input, rows, output, (char)pCodec->type);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  int rows = 4096;
+  int loops = 20000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      rows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      loops = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options]\n", argv[0]);
+      printf("  [-n rows]: rows per block, default:%d\n", rows);
+      printf("  [-l loops]: decode loops per codec and kernel, default:%d\n", loops);
+      exit(0);
+    }
+  }
+
+  char *data = malloc((size_t)rows * LONG_BYTES);
+  char *comp = malloc((size_t)rows * LONG_BYTES + 64);
+  char *out = malloc((size_t)rows * LONG_BYTES + 64);
+
+  printf("%-10s %-8s %10s %12s\n", "codec", "kernel", "ratio", "GB/s");
+
+  for (int c = 0; c < tListLen(codecs); ++c) {
+    SCodec *pCodec = &codecs[c];
+    generateData(pCodec, data, rows);
+    int compLen = compressData(pCodec, data, rows, comp);
+
+    for (int kernel = TSDB_DECODE_KERNEL_SCALAR; kernel <= TSDB_DECODE_KERNEL_AVX2; ++kernel) {
+      if (tsSetDecodeKernel(kernel) != kernel) continue;
+
+      int64_t st = taosGetTimestampUs();
+      for (int l = 0; l < loops; ++l) {
+        decompressData(pCodec, comp, rows, out);
+      }
+      int64_t el = taosGetTimestampUs() - st;
+
+      if (memcmp(out, data, (size_t)rows * pCodec->bytes) != 0) {
+        printf("%-10s %-8s decoded data mismatch\n", pCodec->name, tsGetDecodeKernelName(kernel));
+        continue;
+      }
+
+      double bytes = (double)rows * pCodec->bytes * loops;
+      printf("%-10s %-8s %10.2f %12.3f\n", pCodec->name, tsGetDecodeKernelName(kernel),
+             (double)rows * pCodec->bytes / compLen, bytes / (el > 0 ? el : 1) / 1000.0);
+    }
+  }
+
+  free(data);
+  free(comp);
+  free(out);
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+
+#include "os.h"
+#include "tscompression.h"
+
+namespace {
+
+const int kNumOfRows[] = {0, 1, 2, 3, 5, 15, 16, 17, 33, 239, 240, 241, 1023, 1024, 1025, 4096, 10007};
+const int kKernels[] = {TSDB_DECODE_KERNEL_SCALAR, TSDB_DECODE_KERNEL_SSE42, TSDB_DECODE_KERNEL_AVX2};
+
+typedef int (*CompressFp)(const char *const input, const int nelements, char *const output);
+typedef int (*DecompressFp)(const char *const input, const int nelements, char *const output);
+
+// decode the same compressed stream with every kernel and compare against the original input
+void checkAllKernels(const char *input, int nelements, int bytes, CompressFp compress, DecompressFp decompress) {
+  std::vector<char> comp(nelements * bytes + 64);
+  std::vector<char> out(nelements * bytes + 64);
+
+  compress(input, nelements, comp.data());
+
+  for (int kernel : kKernels) {
+    tsSetDecodeKernel(kernel);
+    memset(out.data(), 0x7f, out.size());
+    int len = decompress(comp.data(), nelements, out.data());
+    ASSERT_EQ(len, nelements * bytes) << tsGetDecodeKernelName(kernel);
+    ASSERT_EQ(memcmp(out.data(), input, len), 0) << tsGetDecodeKernelName(kernel) << " rows:" << nelements;
+  }
+
+  tsSetDecodeKernel(TSDB_DECODE_KERNEL_AVX2);
+}
+
+int compressBigint(const char *const input, const int nelements, char *const output) {
+  return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_BIGINT);
+}
+int decompressBigint(const char *const input, const int nelements, char *const output) {
+  return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_BIGINT);
+}
+int compressInt(const char *const input, const int nelements, char *const output) {
+  return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_INT);
+}
+int decompressInt(const char *const input, const int nelements, char *const output) {
+  return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_INT);
+}
+int compressSmallint(const char *const input, const int nelements, char *const output) {
+  return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_SMALLINT);
+}
+int decompressSmallint(const char *const input, const int nelements, char *const output) {
+  return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_SMALLINT);
+}
+int compressTinyint(const char *const input, const int nelements, char *const output) {
+  return tsCompressINTImp(input, nelements, output, TSDB_DATA_TYPE_TINYINT);
+}
+int decompressTinyint(const char *const input, const int nelements, char *const output) {
+  return tsDecompressINTImp(input, nelements, output, TSDB_DATA_TYPE_TINYINT);
+}
+
+}  // namespace
+
+TEST(testCase, decompress_timestamp_kernels) {
+  std::mt19937_64 rng(1);
+
+  for (int rows : kNumOfRows) {
+    std::vector<int64_t> ts(rows);
+    int64_t              v = 1600000000000L;
+    for (int i = 0; i < rows; i++) {
+      v += 1000 + (rng() % 7 == 0 ? (int64_t)(rng() % 100000) - 50000 : 0);
+      ts[i] = v;
+    }
+    checkAllKernels((const char *)ts.data(), rows, LONG_BYTES, tsCompressTimestampImp, tsDecompressTimestampImp);
+  }
+}
+
+TEST(testCase, decompress_integer_kernels) {
+  std::mt19937_64 rng(2);
+
+  for (int rows : kNumOfRows) {
+    std::vector<int64_t> i64(rows);
+    std::vector<int32_t> i32(rows);
+    std::vector<int16_t> i16(rows);
+    std::vector<int8_t>  i8(rows);
+
+    int64_t v = 0;
+    for (int i = 0; i < rows; i++) {
+      // mix long constant runs with jumps of every width, to hit all the simple8b selectors
+      int shape = (i / 300) % 4;
+      if (shape == 1) {
+        v += (int64_t)(rng() % 3) - 1;
+      } else if (shape == 2) {
+        v += (int64_t)(rng() % (1L << (rng() % 40))) - (1L << 20);
+      } else if (shape == 3) {
+        v = (int64_t)(rng() % (1L << 57)) - (1L << 56);
+      }
+      i64[i] = v;
+      i32[i] = (int32_t)v;
+      i16[i] = (int16_t)v;
+      i8[i] = (int8_t)v;
+    }
+
+    checkAllKernels((const char *)i64.data(), rows, LONG_BYTES, compressBigint, decompressBigint);
+    checkAllKernels((const char *)i32.data(), rows, INT_BYTES, compressInt, decompressInt);
+    checkAllKernels((const char *)i16.data(), rows, SHORT_BYTES, compressSmallint, decompressSmallint);
+    checkAllKernels((const char *)i8.data(), rows, CHAR_BYTES, compressTinyint, decompressTinyint);
+  }
+}
+
+TEST(testCase, decompress_bool_kernels) {
+  std::mt19937_64 rng(3);
+
+  for (int rows : kNumOfRows) {
+    std::vector<char> b(rows);
+    for (int i = 0; i < rows; i++) {
+      int r = rng() % 5;
+      b[i] = (r == 0) ? TSDB_DATA_BOOL_NULL : (r % 2);
+    }
+    checkAllKernels(b.data(), rows, CHAR_BYTES, tsCompressBoolImp, tsDecompressBoolImp);
+  }
+}
+
+TEST(testCase, decompress_float_kernels) {
+  std::mt19937_64 rng(4);
+
+  for (int rows : kNumOfRows) {
+    std::vector<float>  f(rows);
+    std::vector<double> d(rows);
+    double              v = 20.0;
+    for (int i = 0; i < rows; i++) {
+      v += (rng() % 2 == 0) ? 0 : ((double)(rng() % 1000) / 100.0 - 5.0);
+      f[i] = (float)v;
+      d[i] = v;
+    }
+    checkAllKernels((const char *)f.data(), rows, FLOAT_BYTES, tsCompressFloatImp, tsDecompressFloatImp);
+    checkAllKernels((const char *)d.data(), rows, DOUBLE_BYTES, tsCompressDoubleImp, tsDecompressDoubleImp);
+  }
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os.h"
+#include "hash.h"
+#include "taosdef.h"
+#include "tfixedhash.h"
+
+/*
+ * Lookup-or-insert time of the chained hash table and the fixed hash table, with the group by keys of the query
+ * executor. usage: fixedHashBench [-n lookups] [-c distinct keys]
+ */
+
+typedef struct {
+  int64_t  val;
+  uint64_t groupId;
+} SKey;
+
+int main(int argc, char *argv[]) {
+  int num = 2000000;
+  int card = 500000;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      num = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      card = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options]\n", argv[0]);
+      printf("  [-n lookups]: number of lookups, default:%d\n", num);
+      printf("  [-c keys]: number of distinct keys, default:%d\n", card);
+      exit(0);
+    }
+  }
+
+  if (num <= 0 || card <= 0) {
+    printf("invalid number of lookups or keys\n");
+    exit(1);
+  }
+
+  SKey *keys = malloc((size_t)num * sizeof(SKey));
+  srand(7);
+  for (int i = 0; i < num; ++i) {
+    keys[i].val = rand() % card;
+    keys[i].groupId = 0;
+  }
+
+  int64_t   st = taosGetTimestampUs();
+  SHashObj *pHash = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, HASH_NO_LOCK);
+  for (int i = 0; i < num; ++i) {
+    void **p = taosHashGet(pHash, &keys[i], sizeof(SKey));
+    if (p == NULL) {
+      void *v = &keys[i];
+      taosHashPut(pHash, &keys[i], sizeof(SKey), &v, POINTER_BYTES);
+    }
+  }
+  int64_t chainedCost = taosGetTimestampUs() - st;
+  size_t  chainedSize = taosHashGetSize(pHash);
+  size_t  chainedMem = taosHashGetMemSize(pHash);
+  taosHashCleanup(pHash);
+
+  st = taosGetTimestampUs();
+  SFixedHashObj *pHashObj = taosFixedHashInit(sizeof(SKey), POINTER_BYTES, 64);
+  for (int i = 0; i < num; ++i) {
+    bool  exist = false;
+    void *v = &keys[i];
+    taosFixedHashPut(pHashObj, &keys[i], &v, &exist);
+  }
+  int64_t fixedCost = taosGetTimestampUs() - st;
+  size_t  fixedSize = taosFixedHashGetSize(pHashObj);
+  size_t  fixedMem = taosFixedHashGetMemSize(pHashObj);
+  taosFixedHashCleanup(pHashObj);
+
+  if (fixedSize != chainedSize) {
+    printf("number of keys mismatch, chained hash:%zu fixed hash:%zu\n", chainedSize, fixedSize);
+  }
+
+  printf("%d lookups of %zu keys\n", num, chainedSize);
+  printf("%-8s %10s %12s\n", "hash", "time(s)", "memory(KB)");
+  printf("%-8s %10.3f %12.1f\n", "chained", chainedCost / 1e6, chainedMem / 1024.0);
+  printf("%-8s %10.3f %12.1f\n", "fixed", fixedCost / 1e6, fixedMem / 1024.0);
+
+  free(keys);
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "os.h"
+#include "taosdef.h"
+#include "tfixedhash.h"
+#include "tutil.h"
+
+namespace {
+
+// group by key of the query executor: the column value followed by the table group id
+struct SKey {
+  int64_t  val;
+  uint64_t groupId;
+};
+
+}  // namespace
+
+TEST(testCase, fixedHash_put_get) {
+  SFixedHashObj *pHashObj = taosFixedHashInit(sizeof(SKey), sizeof(int64_t), 4);
+  ASSERT_TRUE(pHashObj != NULL);
+
+  std::mt19937                       rng(1);
+  std::map<std::pair<int64_t, uint64_t>, int64_t> expected;
+  std::vector<int64_t *>             addr;
+
+  for (int64_t i = 0; i < 200000; ++i) {
+    SKey key = {(int64_t)(rng() % 100000), rng() % 3};
+    bool exist = false;
+
+    int64_t *p = (int64_t *)taosFixedHashPut(pHashObj, &key, &i, &exist);
+    ASSERT_TRUE(p != NULL);
+
+    auto it = expected.find(std::make_pair(key.val, key.groupId));
+    ASSERT_EQ(exist, it != expected.end());
+    if (!exist) {
+      expected[std::make_pair(key.val, key.groupId)] = i;
+      addr.push_back(p);
+    }
+    ASSERT_EQ(*p, expected[std::make_pair(key.val, key.groupId)]);
+  }
+
+  ASSERT_EQ(taosFixedHashGetSize(pHashObj), expected.size());
+
+  for (auto &kv : expected) {
+    SKey     key = {kv.first.first, kv.first.second};
+    int64_t *p = (int64_t *)taosFixedHashGet(pHashObj, &key);
+    ASSERT_TRUE(p != NULL);
+    ASSERT_EQ(*p, kv.second);
+  }
+
+  // the data is never moved by growing the table
+  for (size_t i = 0; i < addr.size(); ++i) {
+    SKey key;
+    memcpy(&key, (char *)addr[i] - sizeof(SKey), sizeof(SKey));
+    ASSERT_EQ(taosFixedHashGet(pHashObj, &key), addr[i]);
+  }
+
+  SKey missing = {-1, 0};
+  ASSERT_TRUE(taosFixedHashGet(pHashObj, &missing) == NULL);
+  ASSERT_GT(taosFixedHashGetMemSize(pHashObj), expected.size() * (sizeof(SKey) + sizeof(int64_t)));
+
+  taosFixedHashCleanup(pHashObj);
+}
+
+TEST(testCase, fixedHash_odd_key) {
+  // keys that are not a multiple of 8 bytes, and no data at all, as the distinct operator uses it
+  SFixedHashObj *pHashObj = taosFixedHashInit(13, 0, 16);
+  char           key[13] = {0};
+
+  for (int32_t i = 0; i < 10000; ++i) {
+    memset(key, 0, sizeof(key));
+    snprintf(key, sizeof(key), "k%d", i % 5000);
+    bool exist = false;
+    ASSERT_TRUE(taosFixedHashPut(pHashObj, key, NULL, &exist) != NULL);
+    ASSERT_EQ(exist, i >= 5000);
+  }
+
+  ASSERT_EQ(taosFixedHashGetSize(pHashObj), 5000);
+  taosFixedHashCleanup(pHashObj);
+}
+
+TEST(testCase, fixedHash_aligned_data) {
+  // the data follows the key at the next multiple of 8 bytes, so a pointer or an int64 in it is aligned
+  SFixedHashObj *pHashObj = taosFixedHashInit(13, sizeof(int64_t), 16);
+  char           key[13] = {0};
+
+  for (int64_t i = 0; i < 3000; ++i) {
+    memset(key, 0, sizeof(key));
+    snprintf(key, sizeof(key), "k%" PRId64, i);
+    bool     exist = false;
+    int64_t *p = (int64_t *)taosFixedHashPut(pHashObj, key, &i, &exist);
+    ASSERT_TRUE(p != NULL);
+    ASSERT_FALSE(exist);
+    ASSERT_EQ((uintptr_t)p % 8, 0u);
+    ASSERT_EQ(*p, i);
+  }
+
+  for (int64_t i = 0; i < 3000; ++i) {
+    memset(key, 0, sizeof(key));
+    snprintf(key, sizeof(key), "k%" PRId64, i);
+    int64_t *p = (int64_t *)taosFixedHashGet(pHashObj, key);
+    ASSERT_TRUE(p != NULL);
+    ASSERT_EQ((uintptr_t)p % 8, 0u);
+    ASSERT_EQ(*p, i);
+  }
+
+  taosFixedHashCleanup(pHashObj);
+}
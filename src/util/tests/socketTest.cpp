@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "os.h"
+#include "tsocket.h"
+
+namespace {
+
+std::vector<char> readAll(int fd, size_t len) {
+  std::vector<char> data(len);
+  size_t            offset = 0;
+  while (offset < len) {
+    ssize_t n = read(fd, data.data() + offset, len - offset);
+    if (n <= 0) break;
+    offset += n;
+  }
+  data.resize(offset);
+  return data;
+}
+
+}  // namespace
+
+// more buffers than one writev call takes, and larger than the socket buffer, so writes are partial
+TEST(testCase, socket_write_msgv) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  int sndbuf = 4096;
+  setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+  std::mt19937                   rng(1);
+  std::vector<std::vector<char>> msgs;
+  std::vector<char>              expected;
+  for (int i = 0; i < 200; ++i) {
+    std::vector<char> msg(rng() % 20000 + 1);
+    for (auto &c : msg) c = (char)rng();
+    expected.insert(expected.end(), msg.begin(), msg.end());
+    msgs.push_back(msg);
+  }
+
+  std::vector<SSocketBuf> bufs;
+  for (auto &msg : msgs) {
+    bufs.push_back({msg.data(), (int32_t)msg.size()});
+  }
+
+  std::vector<char> received;
+  std::thread       reader([&]() { received = readAll(fds[1], expected.size()); });
+
+  EXPECT_EQ(taosWriteMsgv(fds[0], bufs.data(), (int32_t)bufs.size()), (int32_t)expected.size());
+  reader.join();
+
+  EXPECT_EQ(received, expected);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(testCase, socket_write_msgv_closed) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  close(fds[1]);
+
+  signal(SIGPIPE, SIG_IGN);
+
+  char       data[16] = {0};
+  SSocketBuf buf = {data, sizeof(data)};
+  EXPECT_EQ(taosWriteMsgv(fds[0], &buf, 1), -1);
+
+  close(fds[0]);
+}
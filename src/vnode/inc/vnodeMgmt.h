@@ -30,6 +30,7 @@ void*   vnodeGetWal(void *pVnode);
 
 int32_t vnodeGetVnodeList(int32_t vnodeList[], int32_t *numOfVnodes);
 void    vnodeBuildStatusMsg(void *pStatus);
+int32_t vnodeBuildStatMsg(void *pStatus);
 void    vnodeSetAccess(SVgroupAccess *pAccess, int32_t numOfVnodes);
 
 void    vnodeAddIntoHash(SVnodeObj* pVnode);
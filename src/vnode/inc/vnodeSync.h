@@ -30,8 +30,10 @@ void     vnodeStopSyncFile(int32_t vgId, uint64_t fversion);
 void     vnodeConfirmForard(int32_t vgId, void *wparam, int32_t code);
 int32_t  vnodeWriteToCache(int32_t vgId, void *wparam, int32_t qtype, void *rparam);
 int32_t  vnodeGetVersion(int32_t vgId, uint64_t *fver, uint64_t *wver);
+int64_t  vnodeGetDataSize(int32_t vgId);
 
 void     vnodeConfirmForward(void *pVnode, uint64_t version, int32_t code, bool force);
+void     vnodeFlushForward(void *pVnode);
 
 #ifdef __cplusplus
 }
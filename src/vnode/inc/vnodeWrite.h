@@ -28,6 +28,7 @@ int32_t vnodeWriteToWQueue(void *pVnode, void *pHead, int32_t qtype, void *pRpcM
 void    vnodeFreeFromWQueue(void *pVnode, SVWriteMsg *pWrite);
 int32_t vnodeProcessWrite(void *pVnode, void *pHead, int32_t qtype, void *pRspRet);
 void    vnodeWaitWriteCompleted(SVnodeObj *pVnode);
+int32_t vnodeRestoreWal(SVnodeObj *pVnode);
 
 #ifdef __cplusplus
 }
@@ -28,6 +28,7 @@
 #include "vnodeMgmt.h"
 #include "vnodeWorker.h"
 #include "vnodeBackup.h"
+#include "vnodeWrite.h"
 #include "vnodeMain.h"
 
 static int32_t vnodeProcessTsdbStatus(void *arg, int32_t status, int32_t eno);
@@ -354,13 +355,14 @@ int32_t vnodeOpen(int32_t vgId) {
 
   sprintf(temp, "%s/wal", walRootDir);
   pVnode->walCfg.vgId = pVnode->vgId;
+  pVnode->walCfg.groupCommitSize = tsWalGroupCommitSize * 1024;
   pVnode->wal = walOpen(temp, &pVnode->walCfg);
   if (pVnode->wal == NULL) { 
     vnodeCleanUp(pVnode);
     return terrno;
   }
 
-  walRestore(pVnode->wal, pVnode, vnodeProcessWrite);
+  vnodeRestoreWal(pVnode);
   if (pVnode->version == 0) {
     pVnode->fversion = 0;
     pVnode->version = walGetVersion(pVnode->wal);
@@ -401,6 +403,7 @@ int32_t vnodeOpen(int32_t vgId) {
   syncInfo.startSyncFileFp = vnodeStartSyncFile;
   syncInfo.stopSyncFileFp = vnodeStopSyncFile;
   syncInfo.getVersionFp = vnodeGetVersion;
+  syncInfo.getDataSizeFp = vnodeGetDataSize;
   syncInfo.sendFileFp = tsdbSyncSend;
   syncInfo.recvFileFp = tsdbSyncRecv;
   syncInfo.pTsdb = pVnode->tsdb;
@@ -199,6 +199,43 @@ void vnodeBuildStatusMsg(void *param) {
   }
 }
 
+// Append the statistics of the vnodes in load[] to the status msg, the length appended is returned
+int32_t vnodeBuildStatMsg(void *param) {
+  SStatusMsg *   pStatus = param;
+  SVnodeStatMsg *pStatMsg = (SVnodeStatMsg *)&pStatus->load[pStatus->openVnodes];
+  SVnodeStat *   pStat = (SVnodeStat *)pStatMsg->stats;
+
+  for (int32_t i = 0; i < pStatus->openVnodes; ++i, ++pStat) {
+    int32_t           vgId = htonl(pStatus->load[i].vgId);
+    STsdbBlkCacheStat blkCacheStat = {0};
+    SSyncRecoveryInfo recoveryInfo = {0};
+
+    SVnodeObj *pVnode = vnodeAcquire(vgId);
+    if (pVnode != NULL) {
+      if (!vnodeInClosingStatus(pVnode)) {
+        if (pVnode->tsdb) tsdbReportBlkCacheStat(pVnode->tsdb, &blkCacheStat);
+        if (pVnode->sync > 0) syncGetRecoveryInfo(pVnode->sync, &recoveryInfo);
+      }
+      vnodeRelease(pVnode);
+    }
+
+    pStat->vgId = htonl(vgId);
+    pStat->blkCacheSize = htobe64(blkCacheStat.size);
+    pStat->blkCacheHits = htobe64(blkCacheStat.hits);
+    pStat->blkCacheMisses = htobe64(blkCacheStat.misses);
+    pStat->blkCacheEvicts = htobe64(blkCacheStat.evicts);
+    pStat->syncState = recoveryInfo.state;
+    pStat->syncRank = htonl(recoveryInfo.rank);
+    pStat->syncLag = htobe64(recoveryInfo.lag);
+  }
+
+  pStatMsg->statLen = htons(sizeof(SVnodeStat));
+  pStatMsg->numOfStats = htons(pStatus->openVnodes);
+  pStatMsg->reserved = 0;
+
+  return (int32_t)(sizeof(SVnodeStatMsg) + pStatus->openVnodes * sizeof(SVnodeStat));
+}
+
 void vnodeSetAccess(SVgroupAccess *pAccess, int32_t numOfVnodes) {
   for (int32_t i = 0; i < numOfVnodes; ++i) {
     pAccess[i].vgId = htonl(pAccess[i].vgId);
@@ -119,6 +119,7 @@ static SVReadMsg *vnodeBuildVReadMsg(SVnodeObj *pVnode, void *pCont, int32_t con
   }
 
   pRead->qtype = qtype;
+  pRead->enqueueTs = taosGetTimestampUs();
   atomic_add_fetch_32(&pVnode->refCount, 1);
 
   return pRead;
@@ -180,9 +181,10 @@ static int32_t vnodePutItemIntoReadQueue(SVnodeObj *pVnode, void **qhandle, void
  */
 static int32_t vnodeDumpQueryResult(SRspRet *pRet, void *pVnode, uint64_t qId, void **handle, bool *freeHandle, void *ahandle) {
   bool continueExec = false;
+  bool completed = false;
 
   int32_t code = TSDB_CODE_SUCCESS;
-  if ((code = qDumpRetrieveResult(*handle, (SRetrieveTableRsp **)&pRet->rsp, &pRet->len, &continueExec)) == TSDB_CODE_SUCCESS) {
+  if ((code = qDumpRetrieveResult(*handle, (SRetrieveTableRsp **)&pRet->rsp, &pRet->len, &continueExec, &completed)) == TSDB_CODE_SUCCESS) {
     if (continueExec) {
       *freeHandle = false;
       code = vnodePutItemIntoReadQueue(pVnode, handle, ahandle);
@@ -192,9 +194,14 @@ static int32_t vnodeDumpQueryResult(SRspRet *pRet, void *pVnode, uint64_t qId, v
       } else {
         pRet->qhandle = *handle;
       }
-    } else {
+    } else if (completed) {
       *freeHandle = true;
       vTrace("QInfo:0x%"PRIx64"-%p exec completed, free handle:%d", qId, *handle, *freeHandle);
+    } else {
+      // the prefetched result is returned, and the query thread goes on with the qhandle by itself
+      *freeHandle = false;
+      vTrace("QInfo:0x%"PRIx64"-%p prefetched result returned, query continues", qId, *handle);
+      qReleaseQInfo(((SVnodeObj *)pVnode)->qMgmt, (void **)&handle, false);
     }
   } else {
     SRetrieveTableRsp *pRsp = (SRetrieveTableRsp *)rpcMallocCont(sizeof(SRetrieveTableRsp));
@@ -235,6 +242,7 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
 
   int32_t code = TSDB_CODE_SUCCESS;
   void ** handle = NULL;
+  int64_t waitTime = taosGetTimestampUs() - pRead->enqueueTs;
 
   if (contLen != 0) {
     qinfo_t pQInfo = NULL;
@@ -263,6 +271,7 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
       } else {
         assert(*handle == pQInfo);
         pRsp->qId = htobe64(qId);
+        qAddReadQueueWaitTime(pQInfo, waitTime);
       }
 
       if (handle != NULL &&
@@ -297,6 +306,7 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
     uint64_t qId = 0;
 
     vTrace("vgId:%d, QInfo:%p, dnode continues to exec query", pVnode->vgId, *qhandle);
+    qAddReadQueueWaitTime(*qhandle, waitTime);
 
     // In the retrieve blocking model, only 50% CPU will be used in query processing
     if (tsRetrieveBlockingModel) {
@@ -304,8 +314,15 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
       qReleaseQInfo(pVnode->qMgmt, (void **)&qhandle, false);
     } else {
       bool freehandle = false;
+      bool continueExec = false;
+      bool prefetched = false;
       bool buildRes = qTableQuery(*qhandle, &qId);  // do execute query
 
+      // no retrieve request is waiting, build the result ahead of it if the prefetch is enabled
+      if (!buildRes) {
+        prefetched = qPrefetchQueryResult(*qhandle, &buildRes, &continueExec);
+      }
+
       // build query rsp, the retrieve request has reached here already
       if (buildRes) {
         // update the connection info according to the retrieve connection
@@ -320,6 +337,17 @@ static int32_t vnodeProcessQueryMsg(SVnodeObj *pVnode, SVReadMsg *pRead) {
 
         // NOTE: set return code to be TSDB_CODE_QRY_HAS_RSP to notify dnode to return msg to client
         code = TSDB_CODE_QRY_HAS_RSP;
+      } else if (prefetched) {
+        // the prefetch queue is not full, go on to produce the next result. Otherwise the query is resumed by the
+        // retrieve request, and the qhandle should not be freed even if the query is completed, since the prefetched
+        // results are not retrieved yet.
+        if (continueExec) {
+          if (vnodePutItemIntoReadQueue(pVnode, qhandle, pRead->rpcHandle) == TSDB_CODE_SUCCESS) {
+            return code;
+          }
+
+          freehandle = true;
+        }
       } else {
         //void *h1 = qGetResultRetrieveMsg(*qhandle);
 
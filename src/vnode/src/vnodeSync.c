@@ -174,7 +174,22 @@ int32_t vnodeGetVersion(int32_t vgId, uint64_t *fver, uint64_t *wver) {
   return code;
 }
 
+int64_t vnodeGetDataSize(int32_t vgId) {
+  SVnodeObj *pVnode = vnodeAcquireNotClose(vgId);
+  if (pVnode == NULL) return 0;
+
+  int64_t size = (pVnode->tsdb != NULL) ? tsdbGetDataSize(pVnode->tsdb) : 0;
+
+  vnodeRelease(pVnode);
+  return size;
+}
+
 void vnodeConfirmForward(void *vparam, uint64_t version, int32_t code, bool force) {
   SVnodeObj *pVnode = vparam;
   syncConfirmForward(pVnode->sync, version, code, force);
 }
+
+void vnodeFlushForward(void *vparam) {
+  SVnodeObj *pVnode = vparam;
+  syncFlushForward(pVnode->sync);
+}
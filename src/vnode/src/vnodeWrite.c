@@ -26,6 +26,15 @@
 
 #define MAX_QUEUED_MSG_NUM 100000
 #define MAX_QUEUED_MSG_SIZE 1024*1024*1024  //1GB
+#define RESTORE_BATCH_SIZE  1024*1024  //1MB
+
+// consecutive submit records restored from wal are merged into one submit msg to be inserted at once
+typedef struct {
+  SVnodeObj *pVnode;
+  SArray *   pRecords;  // SWalHead *, copies of the records merged
+  int32_t    size;      // total size of the blocks of the records
+  uint64_t   version;   // version of the last record merged
+} SRestoreBatch;
 
 extern void *  tsDnodeTmr;
 static int32_t (*vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_MAX])(SVnodeObj *, void *pCont, SRspRet *);
@@ -168,6 +177,130 @@ static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *pR
   return code;
 }
 
+static void vnodeClearRestoreBatch(SRestoreBatch *pBatch) {
+  for (int32_t i = 0; i < taosArrayGetSize(pBatch->pRecords); ++i) {
+    free(taosArrayGetP(pBatch->pRecords, i));
+  }
+  taosArrayClear(pBatch->pRecords);
+  pBatch->size = 0;
+}
+
+static int32_t vnodeFlushRestoreBatch(SRestoreBatch *pBatch) {
+  SVnodeObj *pVnode = pBatch->pVnode;
+  int32_t    num = (int32_t)taosArrayGetSize(pBatch->pRecords);
+  int32_t    code = 0;
+
+  if (num == 0) return 0;
+
+  if (num > 1) {
+    int32_t   len = sizeof(SSubmitMsg) + pBatch->size;
+    SWalHead *pHead = malloc(sizeof(SWalHead) + len);
+    if (pHead != NULL) {
+      // the version of the merged msg is the last one, as the version of vnode after all the records applied
+      memcpy(pHead, taosArrayGetP(pBatch->pRecords, num - 1), sizeof(SWalHead));
+      pHead->len = len;
+
+      SSubmitMsg *pMsg = (SSubmitMsg *)pHead->cont;
+      SSubmitMsg *pFirst = (SSubmitMsg *)((SWalHead *)taosArrayGetP(pBatch->pRecords, 0))->cont;
+      char *      pBlocks = pMsg->blocks;
+      int32_t     numOfBlocks = 0;
+
+      pMsg->header.vgId = pFirst->header.vgId;
+      pMsg->header.contLen = htonl(len);
+      pMsg->length = htonl(len);
+      for (int32_t i = 0; i < num; ++i) {
+        SSubmitMsg *pSrc = (SSubmitMsg *)((SWalHead *)taosArrayGetP(pBatch->pRecords, i))->cont;
+        int32_t     size = htonl(pSrc->length) - sizeof(SSubmitMsg);
+        memcpy(pBlocks, pSrc->blocks, size);
+        pBlocks += size;
+        numOfBlocks += htonl(pSrc->numOfBlocks);
+      }
+      pMsg->numOfBlocks = htonl(numOfBlocks);
+
+      uint64_t vver = pVnode->version;
+      code = vnodeProcessWrite(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+      free(pHead);
+
+      if (code >= 0) {
+        vTrace("vgId:%d, %d submit records are restored at once, vver:%" PRIu64, pVnode->vgId, num, pVnode->version);
+        vnodeClearRestoreBatch(pBatch);
+        return code;
+      }
+
+      // one bad record fails the whole merged msg, so apply them one by one to keep the others. The blocks inserted
+      // before the failure are inserted again, which is fine as rows of the same timestamp are merged
+      vDebug("vgId:%d, failed to restore %d merged submit records since %s, restore them one by one", pVnode->vgId,
+             num, tstrerror(code));
+      pVnode->version = vver;
+    }
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    code = vnodeProcessWrite(pVnode, taosArrayGetP(pBatch->pRecords, i), TAOS_QTYPE_WAL, NULL);
+  }
+
+  vnodeClearRestoreBatch(pBatch);
+  return code;
+}
+
+static int32_t vnodeRestoreWalRecord(void *param, void *wparam, int32_t qtype, void *rparam) {
+  SRestoreBatch *pBatch = param;
+  SVnodeObj *    pVnode = pBatch->pVnode;
+  SWalHead *     pHead = wparam;
+  int32_t        size = 0;
+
+  if (pHead->version <= MAX(pVnode->version, pBatch->version)) return 0;
+
+  if (pHead->msgType == TSDB_MSG_TYPE_SUBMIT && pHead->len > sizeof(SSubmitMsg)) {
+    int32_t length = htonl(((SSubmitMsg *)pHead->cont)->length);
+    if (length > sizeof(SSubmitMsg) && length <= pHead->len) size = length - sizeof(SSubmitMsg);
+  }
+
+  if (size == 0 || size > RESTORE_BATCH_SIZE) {
+    vnodeFlushRestoreBatch(pBatch);
+    return vnodeProcessWrite(pVnode, pHead, qtype, rparam);
+  }
+
+  if (pBatch->size + size > RESTORE_BATCH_SIZE) {
+    vnodeFlushRestoreBatch(pBatch);
+  }
+
+  SWalHead *pRecord = malloc(sizeof(SWalHead) + pHead->len);
+  if (pRecord == NULL || taosArrayPush(pBatch->pRecords, &pRecord) == NULL) {
+    free(pRecord);
+    vnodeFlushRestoreBatch(pBatch);
+    return vnodeProcessWrite(pVnode, pHead, qtype, rparam);
+  }
+
+  memcpy(pRecord, pHead, sizeof(SWalHead) + pHead->len);
+  pBatch->size += size;
+  pBatch->version = pHead->version;
+  return 0;
+}
+
+int32_t vnodeRestoreWal(SVnodeObj *pVnode) {
+  SRestoreBatch batch = {.pVnode = pVnode};
+  int32_t       code = 0;
+
+  batch.pRecords = taosArrayInit(64, sizeof(SWalHead *));
+  if (batch.pRecords == NULL) {
+    code = walRestore(pVnode->wal, pVnode, vnodeProcessWrite);
+  } else {
+    code = walRestore(pVnode->wal, &batch, vnodeRestoreWalRecord);
+    vnodeFlushRestoreBatch(&batch);
+    taosArrayDestroy(batch.pRecords);
+  }
+
+  SWalRestoreStat stat = {0};
+  walGetRestoreStat(pVnode->wal, &stat);
+  if (stat.records > 0) {
+    vInfo("vgId:%d, %" PRId64 " records of %" PRId64 " bytes are restored from wal in %" PRId64 " ms, vver:%" PRIu64,
+          pVnode->vgId, stat.records, stat.appliedBytes, stat.elapsedMs, pVnode->version);
+  }
+
+  return code;
+}
+
 static int32_t vnodeCheckWal(SVnodeObj *pVnode) {
   if (pVnode->isCommiting == 0) {
     return tsdbCheckWal(pVnode->tsdb, (uint32_t)(walGetFSize(pVnode->wal) >> 20));
@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 #include "tlog.h"
+#include "twal.h"
 
 extern int32_t wDebugFlag;
 
@@ -40,6 +41,10 @@ extern int32_t wDebugFlag;
 #define WAL_FILE_LEN   (WAL_PATH_LEN + 32)
 #define WAL_FILE_NUM   1 // 3
 
+#define WAL_RESTORE_READ_SIZE  (4 * 1024 * 1024)   // size of each read while restoring
+#define WAL_RESTORE_QUEUE_SIZE (64 * 1024 * 1024)  // max size of the records read ahead of being applied
+#define WAL_RESTORE_LOG_MS     10000
+
 typedef struct {
   uint64_t version;
   int64_t  fileId;
@@ -50,6 +55,13 @@ typedef struct {
   int32_t  level;
   int32_t  fsyncPeriod;
   int32_t  fsyncSeq;
+  int32_t  bufSize;  // capacity of buf, 0 if records are written through
+  int32_t  bufLen;   // length of the records gathered in buf
+  int32_t  bufCode;  // error of writing out buf, kept until reported by walFsync
+  char *   buf;
+  uint64_t failedVer;  // version of the first record lost in writing out buf, valid if bufCode is set
+  uint64_t batchVer;   // version of the first record written since the last walFsync
+  SWalRestoreStat restore;
   int8_t   stop;
   int8_t   reserved[3];
   char     path[WAL_PATH_LEN];
@@ -60,6 +72,7 @@ typedef struct {
 int32_t walGetNextFile(SWal *pWal, int64_t *nextFileId);
 int32_t walGetOldFile(SWal *pWal, int64_t curFileId, int32_t minDiff, int64_t *oldFileId);
 int32_t walGetNewFile(SWal *pWal, int64_t *newFileId);
+int32_t walFlushBuf(SWal *pWal);
 
 #ifdef __cplusplus
 }
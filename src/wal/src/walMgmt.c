@@ -75,6 +75,7 @@ void *walOpen(char *path, SWalCfg *pCfg) {
   pWal->level = pCfg->walLevel;
   pWal->keep = pCfg->keep;
   pWal->fsyncPeriod = pCfg->fsyncPeriod;
+  pWal->bufSize = pCfg->groupCommitSize;
   tstrncpy(pWal->path, path, sizeof(pWal->path));
   pthread_mutex_init(&pWal->mutex, NULL);
 
@@ -92,7 +93,8 @@ void *walOpen(char *path, SWalCfg *pCfg) {
     return NULL;
   }
 
-  wDebug("vgId:%d, wal:%p is opened, level:%d fsyncPeriod:%d", pWal->vgId, pWal, pWal->level, pWal->fsyncPeriod);
+  wDebug("vgId:%d, wal:%p is opened, level:%d fsyncPeriod:%d groupCommitSize:%d", pWal->vgId, pWal, pWal->level,
+         pWal->fsyncPeriod, pWal->bufSize);
 
   return pWal;
 }
@@ -133,6 +135,7 @@ void walClose(void *handle) {
 
   SWal *pWal = handle;
   pthread_mutex_lock(&pWal->mutex);
+  walFlushBuf(pWal);
   tfClose(pWal->tfd);
   pthread_mutex_unlock(&pWal->mutex);
   taosRemoveRef(tsWal.refId, pWal->rid);
@@ -154,6 +157,7 @@ static void walFreeObj(void *wal) {
 
   tfClose(pWal->tfd);
   pthread_mutex_destroy(&pWal->mutex);
+  tfree(pWal->buf);
   tfree(pWal);
 }
 
@@ -181,6 +185,11 @@ static void walFsyncAll() {
   while (pWal) {
     if (walNeedFsync(pWal)) {
       wTrace("vgId:%d, do fsync, level:%d seq:%d rseq:%d", pWal->vgId, pWal->level, pWal->fsyncSeq, tsWal.seq);
+      if (pWal->bufSize > 0) {
+        pthread_mutex_lock(&pWal->mutex);
+        walFlushBuf(pWal);
+        pthread_mutex_unlock(&pWal->mutex);
+      }
       int32_t code = tfFsync(pWal->tfd);
       if (code != 0) {
         wError("vgId:%d, file:%s, failed to fsync since %s", pWal->vgId, pWal->name, strerror(code));
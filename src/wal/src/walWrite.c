@@ -20,6 +20,7 @@
 #include "taosmsg.h"
 #include "tchecksum.h"
 #include "tfile.h"
+#include "tlist.h"
 #include "twal.h"
 #include "walInt.h"
 
@@ -39,6 +40,7 @@ int32_t walRenew(void *handle) {
   pthread_mutex_lock(&pWal->mutex);
 
   if (tfValid(pWal->tfd)) {
+    walFlushBuf(pWal);
     tfClose(pWal->tfd);
     wDebug("vgId:%d, file:%s, it is closed while renew", pWal->vgId, pWal->name);
   }
@@ -97,6 +99,8 @@ void walRemoveAllOldFiles(void *handle) {
 
   pthread_mutex_lock(&pWal->mutex);
   
+  // the records are removed with the files anyway
+  pWal->bufLen = 0;
   tfClose(pWal->tfd);
   wDebug("vgId:%d, file:%s, it is closed before remove all wals", pWal->vgId, pWal->name);
 
@@ -157,13 +161,30 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 
   pthread_mutex_lock(&pWal->mutex);
 
-  if (tfWrite(pWal->tfd, pHead, contLen) != contLen) {
-    code = TAOS_SYSTEM_ERROR(errno);
-    wError("vgId:%d, file:%s, failed to write since %s", pWal->vgId, pWal->name, strerror(errno));
+  // failing to allocate the buffer just falls back to write through
+  if (pWal->bufSize > 0 && pWal->buf == NULL) {
+    pWal->buf = malloc(pWal->bufSize);
+  }
+
+  if (pWal->buf != NULL && contLen <= pWal->bufSize) {
+    if (pWal->bufLen + contLen > pWal->bufSize) code = walFlushBuf(pWal);
+    if (code == 0) {
+      memcpy(pWal->buf + pWal->bufLen, pHead, contLen);
+      pWal->bufLen += contLen;
+    }
   } else {
+    code = walFlushBuf(pWal);
+    if (code == 0 && tfWrite(pWal->tfd, pHead, contLen) != contLen) {
+      code = TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, file:%s, failed to write since %s", pWal->vgId, pWal->name, strerror(errno));
+    }
+  }
+
+  if (code == 0) {
     wTrace("vgId:%d, write wal, fileId:%" PRId64 " tfd:%" PRId64 " hver:%" PRId64 " wver:%" PRIu64 " len:%d", pWal->vgId,
            pWal->fileId, pWal->tfd, pHead->version, pWal->version, pHead->len);
     pWal->version = pHead->version;
+    if (pWal->batchVer == 0) pWal->batchVer = pHead->version;
   }
 
   pthread_mutex_unlock(&pWal->mutex);
@@ -173,16 +194,76 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
   return code;
 }
 
-void walFsync(void *handle, bool forceFsync) {
+// Write out the records gathered since the last call with one write, and fsync if required. An error means the
+// records written since the last call from the version *pFailedVer on may be lost, the writers of them shall not be
+// acknowledged as succeeded. The records before it are written out.
+int32_t walFsync(void *handle, bool forceFsync, uint64_t *pFailedVer) {
   SWal *pWal = handle;
-  if (pWal == NULL || !tfValid(pWal->tfd)) return;
+  if (pWal == NULL || !tfValid(pWal->tfd)) return 0;
+
+  pthread_mutex_lock(&pWal->mutex);
+  walFlushBuf(pWal);
+  int32_t  code = pWal->bufCode;
+  uint64_t failedVer = pWal->failedVer;
+  uint64_t batchVer = pWal->batchVer;
+  pWal->bufCode = 0;
+  pWal->failedVer = 0;
+  pWal->batchVer = 0;
+  pthread_mutex_unlock(&pWal->mutex);
 
   if (forceFsync || (pWal->level == TAOS_WAL_FSYNC && pWal->fsyncPeriod == 0)) {
     wTrace("vgId:%d, fileId:%" PRId64 ", do fsync", pWal->vgId, pWal->fileId);
     if (tfFsync(pWal->tfd) < 0) {
       wError("vgId:%d, fileId:%" PRId64 ", fsync failed since %s", pWal->vgId, pWal->fileId, strerror(errno));
+      // none of the records since the last call is known to be on disk
+      if (code == 0) code = TAOS_SYSTEM_ERROR(errno);
+      failedVer = batchVer;
+    }
+  }
+
+  if (code != 0 && pFailedVer != NULL) *pFailedVer = failedVer;
+  return code;
+}
+
+// The caller should hold the mutex. If only part of buf is written out, the records written out completely are kept
+// and the file is cut at the end of them, so a record torn by the failure is not restored.
+int32_t walFlushBuf(SWal *pWal) {
+  if (pWal->bufLen <= 0) return 0;
+
+  int32_t code = 0;
+  int64_t offset = tfLseek(pWal->tfd, 0, SEEK_CUR);
+  if (tfWrite(pWal->tfd, pWal->buf, pWal->bufLen) != pWal->bufLen) {
+    code = TAOS_SYSTEM_ERROR(errno);
+    wError("vgId:%d, file:%s, failed to write %d bytes since %s", pWal->vgId, pWal->name, pWal->bufLen,
+           strerror(errno));
+
+    int64_t written = 0;
+    if (offset >= 0) written = MAX(tfLseek(pWal->tfd, 0, SEEK_CUR) - offset, 0);
+
+    int32_t pos = 0;
+    while (pos < pWal->bufLen) {
+      SWalHead *pHead = (SWalHead *)(pWal->buf + pos);
+      int32_t   contLen = pHead->len + sizeof(SWalHead);
+      if (pos + contLen > written) break;
+      pos += contLen;
+    }
+
+    if (written > pos && (tfFtruncate(pWal->tfd, offset + pos) < 0 || tfLseek(pWal->tfd, offset + pos, SEEK_SET) < 0)) {
+      wError("vgId:%d, file:%s, failed to cut the torn record at offset %" PRId64 " since %s", pWal->vgId, pWal->name,
+             offset + pos, strerror(errno));
+      pos = 0;
     }
+
+    if (pWal->bufCode == 0) {
+      pWal->bufCode = code;
+      pWal->failedVer = ((SWalHead *)(pWal->buf + pos))->version;
+    }
+  } else {
+    wTrace("vgId:%d, fileId:%" PRId64 ", write out %d bytes of wal", pWal->vgId, pWal->fileId, pWal->bufLen);
   }
+
+  pWal->bufLen = 0;
+  return code;
 }
 
 int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
@@ -193,6 +274,18 @@ int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
   int32_t code = 0;
   int64_t fileId = -1;
 
+  memset(&pWal->restore, 0, sizeof(pWal->restore));
+  pWal->restore.startMs = taosGetTimestampMs();
+  while (walGetNextFile(pWal, &fileId) >= 0) {
+    if (fileId == pWal->fileId) continue;
+
+    char        walName[WAL_FILE_LEN];
+    struct stat fstat;
+    snprintf(walName, sizeof(walName), "%s/%s%" PRId64, pWal->path, WAL_PREFIX, fileId);
+    if (stat(walName, &fstat) == 0) pWal->restore.totalBytes += fstat.st_size;
+  }
+
+  fileId = -1;
   while ((code = walGetNextFile(pWal, &fileId)) >= 0) {
     if (fileId == pWal->fileId) continue;
 
@@ -211,6 +304,14 @@ int32_t walRestore(void *handle, void *pVnode, FWalWrite writeFp) {
     count++;
   }
 
+  SWalRestoreStat *pStat = &pWal->restore;
+  pStat->elapsedMs = taosGetTimestampMs() - pStat->startMs;
+  if (pStat->records > 0) {
+    wInfo("vgId:%d, %" PRId64 " records of %" PRId64 " bytes are restored in %" PRId64 " ms, %.2f MB/s", pWal->vgId,
+          pStat->records, pStat->appliedBytes, pStat->elapsedMs,
+          pStat->appliedBytes / 1048576.0 / MAX(pStat->elapsedMs, 1) * 1000);
+  }
+
   if (pWal->keep != TAOS_WAL_KEEP) return TSDB_CODE_SUCCESS;
 
   if (count == 0) {
@@ -239,6 +340,9 @@ int32_t walGetWalFile(void *handle, char *fileName, int64_t *fileId) {
 
   pthread_mutex_lock(&(pWal->mutex));
 
+  // the file shall contain all the records written so far for sync
+  walFlushBuf(pWal);
+
   int32_t code = walGetNextFile(pWal, fileId);
   if (code >= 0) {
     sprintf(fileName, "wal/%s%" PRId64, WAL_PREFIX, *fileId);
@@ -251,22 +355,83 @@ int32_t walGetWalFile(void *handle, char *fileName, int64_t *fileId) {
   return code;
 }
 
+typedef struct {
+  int64_t tfd;
+  int64_t offset;  // offset of buf in the file
+  int32_t pos;
+  int32_t len;
+  char *  buf;
+} SWalReader;
+
+// Records are read and validated by a reader thread, and queued up to WAL_RESTORE_QUEUE_SIZE bytes ahead of the
+// thread calling walRestore which applies them
+typedef struct {
+  SWal *          pWal;
+  char *          name;
+  int64_t         fileId;
+  SWalReader      reader;
+  SList *         records;  // SWalHead *, malloced
+  int64_t         queuedSize;
+  int32_t         code;
+  int8_t          done;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  notEmpty;
+  pthread_cond_t  notFull;
+} SWalRestoreCtx;
+
+static int32_t walReaderRead(SWalReader *pReader, void *data, int32_t len) {
+  int32_t n = 0;
+  while (n < len) {
+    if (pReader->pos >= pReader->len) {
+      pReader->offset += pReader->len;
+      pReader->pos = 0;
+      pReader->len = 0;
+
+      int64_t ret = tfRead(pReader->tfd, pReader->buf, WAL_RESTORE_READ_SIZE);
+      if (ret < 0) return -1;
+      if (ret == 0) break;
+      pReader->len = (int32_t)ret;
+    }
+
+    int32_t size = MIN(len - n, pReader->len - pReader->pos);
+    memcpy((char *)data + n, pReader->buf + pReader->pos, size);
+    pReader->pos += size;
+    n += size;
+  }
+
+  return n;
+}
+
+static int32_t walReaderSeek(SWalReader *pReader, int64_t offset) {
+  if (offset >= pReader->offset && offset <= pReader->offset + pReader->len) {
+    pReader->pos = (int32_t)(offset - pReader->offset);
+    return 0;
+  }
+
+  if (tfLseek(pReader->tfd, offset, SEEK_SET) < 0) return -1;
+  pReader->offset = offset;
+  pReader->pos = 0;
+  pReader->len = 0;
+  return 0;
+}
+
 static void walFtruncate(SWal *pWal, int64_t tfd, int64_t offset) {
   tfFtruncate(tfd, offset);
   tfFsync(tfd);
 }
 
-static int32_t walSkipCorruptedRecord(SWal *pWal, SWalHead *pHead, int64_t tfd, int64_t *offset) {
+static int32_t walSkipCorruptedRecord(SWal *pWal, SWalHead *pHead, SWalReader *pReader, int64_t *offset) {
   int64_t pos = *offset;
   while (1) {
     pos++;
 
-    if (tfLseek(tfd, pos, SEEK_SET) < 0) {
+    if (walReaderSeek(pReader, pos) < 0) {
       wError("vgId:%d, failed to seek from corrupted wal file since %s", pWal->vgId, strerror(errno));
       return TSDB_CODE_WAL_FILE_CORRUPTED;
     }
 
-    if (tfRead(tfd, pHead, sizeof(SWalHead)) <= 0) {
+    if (walReaderRead(pReader, pHead, sizeof(SWalHead)) <= 0) {
       wError("vgId:%d, read to end of corrupted wal file, offset:%" PRId64, pWal->vgId, pos);
       return TSDB_CODE_WAL_FILE_CORRUPTED;
     }
@@ -283,7 +448,11 @@ static int32_t walSkipCorruptedRecord(SWal *pWal, SWalHead *pHead, int64_t tfd,
     }
 
     if (pHead->sver >= 1) {
-      if (tfRead(tfd, pHead->cont, pHead->len) < pHead->len) {
+      if (pHead->len < 0 || pHead->len > WAL_MAX_SIZE - sizeof(SWalHead)) {
+        continue;
+      }
+
+      if (walReaderRead(pReader, pHead->cont, pHead->len) < pHead->len) {
 	wError("vgId:%d, read to end of corrupted wal file, offset:%" PRId64, pWal->vgId, pos);
 	return TSDB_CODE_WAL_FILE_CORRUPTED;
       }
@@ -417,29 +586,40 @@ static int walSMemRowCheck(SWalHead *pHead) {
   return 0;
 }
 
-static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
-  int32_t size = WAL_MAX_SIZE;
-  void *  buffer = tmalloc(size);
-  if (buffer == NULL) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    return TAOS_SYSTEM_ERROR(errno);
+static int32_t walPushRestoreRecord(SWalRestoreCtx *pCtx, SWalHead *pHead) {
+  int32_t   size = sizeof(SWalHead) + pHead->len;
+  SWalHead *pRecord = malloc(size);
+  if (pRecord == NULL) return TAOS_SYSTEM_ERROR(errno);
+  memcpy(pRecord, pHead, size);
+
+  pthread_mutex_lock(&pCtx->mutex);
+  while (pCtx->queuedSize > 0 && pCtx->queuedSize + size > WAL_RESTORE_QUEUE_SIZE) {
+    pthread_cond_wait(&pCtx->notFull, &pCtx->mutex);
   }
 
-  int64_t tfd = tfOpen(name, O_RDWR);
-  if (!tfValid(tfd)) {
-    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
-    tfree(buffer);
-    return TAOS_SYSTEM_ERROR(errno);
-  } else {
-    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
+  if (tdListAppend(pCtx->records, &pRecord) < 0) {
+    pthread_mutex_unlock(&pCtx->mutex);
+    free(pRecord);
+    return TAOS_SYSTEM_ERROR(ENOMEM);
   }
 
-  int32_t   code = TSDB_CODE_SUCCESS;
-  int64_t   offset = 0;
-  SWalHead *pHead = buffer;
+  pCtx->queuedSize += size;
+  pthread_cond_signal(&pCtx->notEmpty);
+  pthread_mutex_unlock(&pCtx->mutex);
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t walReadWalFile(SWalRestoreCtx *pCtx, SWalHead *pHead) {
+  SWal *      pWal = pCtx->pWal;
+  SWalReader *pReader = &pCtx->reader;
+  char *      name = pCtx->name;
+  int32_t     size = WAL_MAX_SIZE;
+  int32_t     code = TSDB_CODE_SUCCESS;
+  int64_t     offset = 0;
 
   while (1) {
-    int32_t ret = (int32_t)tfRead(tfd, pHead, sizeof(SWalHead));
+    int32_t ret = walReaderRead(pReader, pHead, sizeof(SWalHead));
     if (ret == 0) break;
 
     if (ret < 0) {
@@ -450,7 +630,7 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
 
     if (ret < sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, failed to read wal head, ret is %d", pWal->vgId, name, ret);
-      walFtruncate(pWal, tfd, offset);
+      walFtruncate(pWal, pReader->tfd, offset);
       break;
     }
 
@@ -458,9 +638,9 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
     if ((pHead->sver == 0 && !walValidateChecksum(pHead)) || pHead->sver < 0 || pHead->sver > 2) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
              pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+      code = walSkipCorruptedRecord(pWal, pHead, pReader, &offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+        walFtruncate(pWal, pReader->tfd, offset);
         break;
       }
     }
@@ -468,14 +648,14 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
     if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
              pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+      code = walSkipCorruptedRecord(pWal, pHead, pReader, &offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+        walFtruncate(pWal, pReader->tfd, offset);
         break;
       }
     }
 
-    ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
+    ret = walReaderRead(pReader, pHead->cont, pHead->len);
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
       code = TAOS_SYSTEM_ERROR(errno);
@@ -491,9 +671,9 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
     if ((pHead->sver >= 1) && !walValidateChecksum(pHead)) {
       wError("vgId:%d, file:%s, wal whole cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
              pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+      code = walSkipCorruptedRecord(pWal, pHead, pReader, &offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+        walFtruncate(pWal, pReader->tfd, offset);
         break;
       }
     }
@@ -502,9 +682,9 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
     if (!taosCheckChecksumWhole((uint8_t *)pHead, sizeof(SWalHead))) {
       wError("vgId:%d, file:%s, wal head cksum is messed up, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
              pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+      code = walSkipCorruptedRecord(pWal, pHead, pReader, &offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+        walFtruncate(pWal, pReader->tfd, offset);
         break;
       }
     }
@@ -512,14 +692,14 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
     if (pHead->len < 0 || pHead->len > size - sizeof(SWalHead)) {
       wError("vgId:%d, file:%s, wal head len out of range, hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, name,
              pHead->version, pHead->len, offset);
-      code = walSkipCorruptedRecord(pWal, pHead, tfd, &offset);
+      code = walSkipCorruptedRecord(pWal, pHead, pReader, &offset);
       if (code != TSDB_CODE_SUCCESS) {
-        walFtruncate(pWal, tfd, offset);
+        walFtruncate(pWal, pReader->tfd, offset);
         break;
       }
     }
 
-    ret = (int32_t)tfRead(tfd, pHead->cont, pHead->len);
+    ret = walReaderRead(pReader, pHead->cont, pHead->len);
     if (ret < 0) {
       wError("vgId:%d, file:%s, failed to read wal body since %s", pWal->vgId, name, strerror(errno));
       code = TAOS_SYSTEM_ERROR(errno);
@@ -535,27 +715,142 @@ static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, ch
 #endif
     offset = offset + sizeof(SWalHead) + pHead->len;
 
-    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-           pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
-
-    pWal->version = pHead->version;
+    wTrace("vgId:%d, read wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId, pCtx->fileId,
+           pHead->version, pHead->len, offset);
 
-    // wInfo("writeFp: %ld", offset);
     if (0 != walSMemRowCheck(pHead)) {
-      wError("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d offset:%" PRId64,
-             pWal->vgId, fileId, pHead->version, pWal->version, pHead->len, offset);
-      tfClose(tfd);
-      tfree(buffer);
-      return TAOS_SYSTEM_ERROR(errno);
+      wError("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " len:%d offset:%" PRId64, pWal->vgId,
+             pCtx->fileId, pHead->version, pHead->len, offset);
+      code = TAOS_SYSTEM_ERROR(errno);
+      break;
     }
+
+    code = walPushRestoreRecord(pCtx, pHead);
+    if (code != TSDB_CODE_SUCCESS) break;
+
+    atomic_store_64(&pWal->restore.readBytes, pWal->restore.readBytes + sizeof(SWalHead) + pHead->len);
+  }
+
+  return code;
+}
+
+static void *walRestoreThreadFunc(void *param) {
+  SWalRestoreCtx *pCtx = param;
+  int32_t         code = TSDB_CODE_SUCCESS;
+  setThreadName("walRestore");
+
+  void *buffer = tmalloc(WAL_MAX_SIZE);
+  if (buffer == NULL) {
+    code = TAOS_SYSTEM_ERROR(errno);
+  } else {
+    code = walReadWalFile(pCtx, buffer);
+    tfree(buffer);
+  }
+
+  pthread_mutex_lock(&pCtx->mutex);
+  pCtx->code = code;
+  pCtx->done = 1;
+  pthread_cond_signal(&pCtx->notEmpty);
+  pthread_mutex_unlock(&pCtx->mutex);
+
+  return NULL;
+}
+
+static SWalHead *walPopRestoreRecord(SWalRestoreCtx *pCtx) {
+  SWalHead *pHead = NULL;
+
+  pthread_mutex_lock(&pCtx->mutex);
+  while (listNEles(pCtx->records) == 0 && !pCtx->done) {
+    pthread_cond_wait(&pCtx->notEmpty, &pCtx->mutex);
+  }
+
+  SListNode *pNode = tdListPopHead(pCtx->records);
+  if (pNode != NULL) {
+    tdListNodeGetData(pCtx->records, pNode, &pHead);
+    listNodeFree(pNode);
+    pCtx->queuedSize -= sizeof(SWalHead) + pHead->len;
+    pthread_cond_signal(&pCtx->notFull);
+  }
+  pthread_mutex_unlock(&pCtx->mutex);
+
+  return pHead;
+}
+
+static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId) {
+  SWalRestoreCtx ctx = {.pWal = pWal, .name = name, .fileId = fileId};
+  SWalRestoreStat *pStat = &pWal->restore;
+
+  ctx.reader.buf = tmalloc(WAL_RESTORE_READ_SIZE);
+  ctx.records = tdListNew(sizeof(SWalHead *));
+  if (ctx.reader.buf == NULL || ctx.records == NULL) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    tfree(ctx.reader.buf);
+    tdListFree(ctx.records);
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  ctx.reader.tfd = tfOpen(name, O_RDWR);
+  if (!tfValid(ctx.reader.tfd)) {
+    wError("vgId:%d, file:%s, failed to open for restore since %s", pWal->vgId, name, strerror(errno));
+    tfree(ctx.reader.buf);
+    tdListFree(ctx.records);
+    return TAOS_SYSTEM_ERROR(errno);
+  } else {
+    wDebug("vgId:%d, file:%s, open for restore", pWal->vgId, name);
+  }
+
+  pthread_mutex_init(&ctx.mutex, NULL);
+  pthread_cond_init(&ctx.notEmpty, NULL);
+  pthread_cond_init(&ctx.notFull, NULL);
+
+  pthread_attr_t thAttr;
+  pthread_attr_init(&thAttr);
+  pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+  if (pthread_create(&ctx.thread, &thAttr, walRestoreThreadFunc, &ctx) != 0) {
+    wError("vgId:%d, file:%s, failed to create restore thread since %s", pWal->vgId, name, strerror(errno));
+    ctx.code = TAOS_SYSTEM_ERROR(errno);
+    ctx.done = 1;
+  }
+  pthread_attr_destroy(&thAttr);
+
+  int64_t   lastLogMs = taosGetTimestampMs();
+  SWalHead *pHead = NULL;
+
+  while ((pHead = walPopRestoreRecord(&ctx)) != NULL) {
+    wTrace("vgId:%d, restore wal, fileId:%" PRId64 " hver:%" PRIu64 " wver:%" PRIu64 " len:%d", pWal->vgId, fileId,
+           pHead->version, pWal->version, pHead->len);
+
+    pWal->version = pHead->version;
     (*writeFp)(pVnode, pHead, TAOS_QTYPE_WAL, NULL);
+
+    pStat->appliedBytes += sizeof(SWalHead) + pHead->len;
+    pStat->records++;
+    free(pHead);
+
+    int64_t nowMs = taosGetTimestampMs();
+    if (nowMs - lastLogMs >= WAL_RESTORE_LOG_MS) {
+      lastLogMs = nowMs;
+      pStat->elapsedMs = nowMs - pStat->startMs;
+      wInfo("vgId:%d, file:%s, restore progress, applied:%" PRId64 " of %" PRId64 " bytes, read ahead:%" PRId64
+            " bytes, records:%" PRId64 ", %.2f MB/s",
+            pWal->vgId, name, pStat->appliedBytes, pStat->totalBytes, pStat->readBytes - pStat->appliedBytes,
+            pStat->records, pStat->appliedBytes / 1048576.0 / MAX(pStat->elapsedMs, 1) * 1000);
+    }
+  }
+
+  if (taosCheckPthreadValid(ctx.thread)) {
+    pthread_join(ctx.thread, NULL);
   }
 
-  tfClose(tfd);
-  tfree(buffer);
+  tfClose(ctx.reader.tfd);
+  tfree(ctx.reader.buf);
+  tdListFree(ctx.records);
+  pthread_cond_destroy(&ctx.notFull);
+  pthread_cond_destroy(&ctx.notEmpty);
+  pthread_mutex_destroy(&ctx.mutex);
 
   wDebug("vgId:%d, file:%s, it is closed after restore", pWal->vgId, name);
-  return code;
+  return ctx.code;
 }
 
 uint64_t walGetVersion(twalh param) {
@@ -583,7 +878,14 @@ int64_t walGetFSize(twalh handle) {
   if (pWal == NULL) return 0;
   struct stat _fstat;
   if (tfStat(pWal->tfd, &_fstat) == 0) {
-    return _fstat.st_size;
+    return _fstat.st_size + pWal->bufLen;
   };
   return 0;
-}
\ No newline at end of file
+}
+void walGetRestoreStat(twalh handle, SWalRestoreStat *pStat) {
+  SWal *pWal = handle;
+  if (pWal == NULL) return;
+
+  *pStat = pWal->restore;
+  pStat->readBytes = atomic_load_64(&pWal->restore.readBytes);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// replay throughput of walRestore: write the records into a wal, then time restoring them
+
+#include "os.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "tlog.h"
+#include "twal.h"
+#include "tfile.h"
+
+static int64_t  restored = 0;
+static int32_t  cost = 0;  // microseconds to apply a record
+static uint64_t dummy = 0;
+
+static int applyRecord(void *pVnode, void *data, int type, void *pMsg) {
+  SWalHead *pHead = data;
+
+  if (cost > 0) {
+    int64_t end = taosGetTimestampUs() + cost;
+    while (taosGetTimestampUs() < end) {
+      dummy += pHead->version;
+    }
+  }
+
+  restored++;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  char path[128] = "/tmp/walBench";
+  int  rows = 1000000;
+  int  size = 1024;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      tstrncpy(path, argv[++i], sizeof(path));
+    } else if (strcmp(argv[i], "-r") == 0 && i < argc - 1) {
+      rows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-s") == 0 && i < argc - 1) {
+      size = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      cost = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-p path]: wal file path default is:%s\n", path);
+      printf("  [-r rows]: number of records, default is:%d\n", rows);
+      printf("  [-s size]: size of each record, default is:%d\n", size);
+      printf("  [-c cost]: microseconds to apply each record, default is:%d\n", cost);
+      printf("  [-h help]: print out this help\n\n");
+      exit(0);
+    }
+  }
+
+  taosInitLog("walBench.log", 100000, 10);
+  tfInit();
+  walInit();
+
+  SWalCfg walCfg = {0};
+  walCfg.walLevel = TAOS_WAL_WRITE;
+  walCfg.keep = TAOS_WAL_NOT_KEEP;
+
+  void *pWal = walOpen(path, &walCfg);
+  if (pWal == NULL || walRenew(pWal) != 0) {
+    printf("failed to open wal\n");
+    exit(-1);
+  }
+
+  SWalHead *pHead = calloc(1, sizeof(SWalHead) + size);
+  int64_t   start = taosGetTimestampUs();
+  for (int i = 0; i < rows; ++i) {
+    pHead->version = i + 1;
+    pHead->len = size;
+    walWrite(pWal, pHead);
+  }
+  walFsync(pWal, true, NULL);
+  walClose(pWal);
+
+  double  bytes = (double)rows * (sizeof(SWalHead) + size);
+  int64_t elapsed = MAX(taosGetTimestampUs() - start, 1);
+  printf("write %d records of %d bytes in %.3f s, %.2f MB/s\n", rows, size, elapsed / 1e6,
+         bytes / 1048576.0 / elapsed * 1e6);
+
+  pWal = walOpen(path, &walCfg);
+  if (pWal == NULL) {
+    printf("failed to open wal\n");
+    exit(-1);
+  }
+
+  start = taosGetTimestampUs();
+  if (walRestore(pWal, NULL, applyRecord) < 0) {
+    printf("failed to restore wal\n");
+    exit(-1);
+  }
+  elapsed = MAX(taosGetTimestampUs() - start, 1);
+
+  SWalRestoreStat stat = {0};
+  walGetRestoreStat(pWal, &stat);
+  printf("restore %" PRId64 " records of %" PRId64 " bytes in %.3f s, %.2f MB/s, %.0f records/s\n", restored,
+         stat.appliedBytes, elapsed / 1e6, stat.appliedBytes / 1048576.0 / elapsed * 1e6, restored * 1e6 / elapsed);
+  if (cost > 0) {
+    printf("apply cost %.3f s, overhead of reading %.3f s\n", restored * cost / 1e6,
+           (elapsed - restored * cost) / 1e6);
+  }
+
+  walRemoveAllOldFiles(pWal);
+  walClose(pWal);
+  walCleanUp();
+  tfCleanup();
+  free(pHead);
+
+  return 0;
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/resource.h>
+
+#include <string>
+#include <vector>
+
+#include "os.h"
+#include "taoserror.h"
+#include "tfile.h"
+#include "twal.h"
+
+namespace {
+
+const int32_t kRecordLen = 100;
+const int64_t kContLen = sizeof(SWalHead) + kRecordLen;
+
+class WalGroupCommitTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    tfInit();
+    walInit();
+  }
+
+  static void TearDownTestCase() {
+    walCleanUp();
+    tfCleanup();
+  }
+
+  void SetUp() override {
+    snprintf(dir, sizeof(dir), "/tmp/walGroupCommitTest-XXXXXX");
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    path = std::string(dir) + "/wal";
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.vgId = 2;
+    cfg.walLevel = TAOS_WAL_FSYNC;
+    cfg.fsyncPeriod = 0;
+    cfg.keep = TAOS_WAL_KEEP;
+    cfg.groupCommitSize = 64 * 1024;
+
+    pHead = (SWalHead*)calloc(1, kContLen);
+  }
+
+  void TearDown() override {
+    walClose(pWal);
+    free(pHead);
+    taosRemoveDir(dir);
+  }
+
+  // open the wal as the vnode does, and return the versions of the records restored from it
+  std::vector<uint64_t> open() {
+    walClose(pWal);
+    restored.clear();
+    pWal = walOpen((char*)path.c_str(), &cfg);
+    EXPECT_NE(pWal, nullptr);
+    EXPECT_EQ(walRestore(pWal, this, restoreRecord), 0);
+    return restored;
+  }
+
+  int32_t write(uint64_t version) {
+    memset(pHead, 0, kContLen);
+    pHead->version = version;
+    pHead->len = kRecordLen;
+    memset(pHead->cont, (int)version, kRecordLen);
+    return walWrite(pWal, pHead);
+  }
+
+  // size of the wal file on disk, there is only one as the wal is kept
+  int64_t fileSize() {
+    DIR* pDir = opendir(path.c_str());
+    if (pDir == NULL) return -1;
+
+    int64_t        size = -1;
+    struct dirent* pEntry;
+    while ((pEntry = readdir(pDir)) != NULL) {
+      struct stat fstat;
+      std::string name = path + "/" + pEntry->d_name;
+      if (stat(name.c_str(), &fstat) == 0 && S_ISREG(fstat.st_mode)) size = fstat.st_size;
+    }
+
+    closedir(pDir);
+    return size;
+  }
+
+  static int32_t restoreRecord(void* ahandle, void* pData, int32_t qtype, void* pMsg) {
+    WalGroupCommitTest* pTest = (WalGroupCommitTest*)ahandle;
+    SWalHead*           pRecord = (SWalHead*)pData;
+    EXPECT_EQ(pRecord->len, kRecordLen);
+    EXPECT_EQ(pRecord->cont[kRecordLen - 1], (char)pRecord->version);
+    pTest->restored.push_back(pRecord->version);
+    return 0;
+  }
+
+  char                  dir[40];
+  std::string           path;
+  SWalCfg               cfg;
+  SWalHead*             pHead = NULL;
+  void*                 pWal = NULL;
+  std::vector<uint64_t> restored;
+};
+
+std::vector<uint64_t> versions(uint64_t first, uint64_t last) {
+  std::vector<uint64_t> res;
+  for (uint64_t v = first; v <= last; ++v) res.push_back(v);
+  return res;
+}
+
+}  // namespace
+
+TEST_F(WalGroupCommitTest, recordsWrittenOutByFsync) {
+  EXPECT_TRUE(open().empty());
+
+  for (uint64_t v = 1; v <= 10; ++v) ASSERT_EQ(write(v), 0);
+
+  // the records are kept in the buffer until walFsync writes them out together
+  EXPECT_EQ(fileSize(), 0);
+  uint64_t failedVer = 0;
+  EXPECT_EQ(walFsync(pWal, false, &failedVer), 0);
+  EXPECT_EQ(fileSize(), 10 * kContLen);
+
+  // a full buffer is written out before the record that does not fit
+  int32_t perBuf = (int32_t)(cfg.groupCommitSize / kContLen);
+  for (uint64_t v = 11; v <= 10 + (uint64_t)perBuf + 1; ++v) ASSERT_EQ(write(v), 0);
+  EXPECT_EQ(fileSize(), (10 + perBuf) * kContLen);
+  EXPECT_EQ(walFsync(pWal, true, &failedVer), 0);
+
+  EXPECT_EQ(open(), versions(1, 11 + perBuf));
+}
+
+// The file takes only part of the records of a batch: the records written out completely are kept and reported as
+// durable, the torn one is cut off, and the wal goes on after it
+TEST_F(WalGroupCommitTest, partialWriteFailure) {
+  EXPECT_TRUE(open().empty());
+
+  for (uint64_t v = 1; v <= 5; ++v) ASSERT_EQ(write(v), 0);
+  uint64_t failedVer = 0;
+  ASSERT_EQ(walFsync(pWal, false, &failedVer), 0);
+  int64_t size = fileSize();
+  ASSERT_EQ(size, 5 * kContLen);
+
+  for (uint64_t v = 6; v <= 10; ++v) ASSERT_EQ(write(v), 0);
+
+  // writes beyond the limit fail with EFBIG instead of raising SIGXFSZ
+  struct rlimit limit, fsizeLimit;
+  ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &limit), 0);
+  fsizeLimit = limit;
+  fsizeLimit.rlim_cur = size + 2 * kContLen + kContLen / 2;
+  sighandler_t handler = signal(SIGXFSZ, SIG_IGN);
+  ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &fsizeLimit), 0);
+
+  int32_t code = walFsync(pWal, false, &failedVer);
+
+  setrlimit(RLIMIT_FSIZE, &limit);
+  signal(SIGXFSZ, handler);
+
+  EXPECT_EQ(code, TAOS_SYSTEM_ERROR(EFBIG));
+  EXPECT_EQ(failedVer, 8u);
+  EXPECT_EQ(fileSize(), size + 2 * kContLen);
+
+  // the error is reported once, the next batch goes on
+  for (uint64_t v = 11; v <= 12; ++v) ASSERT_EQ(write(v), 0);
+  EXPECT_EQ(walFsync(pWal, false, &failedVer), 0);
+
+  std::vector<uint64_t> expected = versions(1, 7);
+  expected.push_back(11);
+  expected.push_back(12);
+  EXPECT_EQ(open(), expected);
+}
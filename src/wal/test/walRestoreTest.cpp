@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "os.h"
+#include "taoserror.h"
+#include "tfile.h"
+#include "twal.h"
+
+namespace {
+
+const int32_t kMaxRecordLen = 256 * 1024;
+
+// The records are restored by a reader thread ahead of the callback. They shall reach it as they are written, in
+// order, as they did when the callback read the file itself.
+class WalRestoreTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    tfInit();
+    walInit();
+  }
+
+  static void TearDownTestCase() {
+    walCleanUp();
+    tfCleanup();
+  }
+
+  void SetUp() override {
+    snprintf(dir, sizeof(dir), "/tmp/walRestoreTest-XXXXXX");
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    path = std::string(dir) + "/wal";
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.vgId = 3;
+    cfg.walLevel = TAOS_WAL_FSYNC;
+    cfg.fsyncPeriod = 0;
+    cfg.keep = TAOS_WAL_KEEP;
+    cfg.groupCommitSize = 64 * 1024;
+
+    pHead = (SWalHead*)calloc(1, sizeof(SWalHead) + kMaxRecordLen);
+  }
+
+  void TearDown() override {
+    walClose(pWal);
+    free(pHead);
+    taosRemoveDir(dir);
+  }
+
+  // open the wal as the vnode does, and return the versions of the records restored from it
+  std::vector<uint64_t> open() {
+    walClose(pWal);
+    restored.clear();
+    pWal = walOpen((char*)path.c_str(), &cfg);
+    EXPECT_NE(pWal, nullptr);
+    EXPECT_EQ(walRestore(pWal, this, restoreRecord), 0);
+    return restored;
+  }
+
+  int32_t write(uint64_t version, int32_t len) {
+    memset(pHead, 0, sizeof(SWalHead));
+    pHead->version = version;
+    pHead->len = len;
+    memset(pHead->cont, (int)version, len);
+    return walWrite(pWal, pHead);
+  }
+
+  // the content of a record is its version repeated
+  static int32_t restoreRecord(void* ahandle, void* pData, int32_t qtype, void* pMsg) {
+    WalRestoreTest* pTest = (WalRestoreTest*)ahandle;
+    SWalHead*       pRecord = (SWalHead*)pData;
+
+    // a slow callback lets the reader fill its queue
+    if (pTest->restored.empty()) taosMsleep(pTest->firstApplyMs);
+
+    int32_t i = 0;
+    while (i < pRecord->len && pRecord->cont[i] == (char)pRecord->version) ++i;
+    EXPECT_EQ(i, pRecord->len) << "version " << pRecord->version;
+
+    pTest->restored.push_back(pRecord->version);
+    return 0;
+  }
+
+  char                  dir[40];
+  std::string           path;
+  SWalCfg               cfg;
+  SWalHead*             pHead = NULL;
+  void*                 pWal = NULL;
+  int32_t               firstApplyMs = 0;
+  std::vector<uint64_t> restored;
+};
+
+}  // namespace
+
+// Records of up to 256KB, buffered or written through, span many reads of the reader and more than its queue holds
+TEST_F(WalRestoreTest, pipelinedReadInOrder) {
+  EXPECT_TRUE(open().empty());
+
+  std::vector<uint64_t> expected;
+  int64_t               bytes = 0;
+  for (uint64_t v = 1; bytes < 80 * 1024 * 1024; ++v) {
+    int32_t len = 1 + (int32_t)((v * 7919) % kMaxRecordLen);
+    ASSERT_EQ(write(v, len), 0);
+    expected.push_back(v);
+    bytes += sizeof(SWalHead) + len;
+  }
+  ASSERT_EQ(walFsync(pWal, true, NULL), 0);
+
+  firstApplyMs = 500;
+  EXPECT_EQ(open(), expected);
+
+  SWalRestoreStat stat;
+  walGetRestoreStat(pWal, &stat);
+  EXPECT_EQ(stat.records, (int64_t)expected.size());
+  EXPECT_EQ(stat.totalBytes, bytes);
+  EXPECT_EQ(stat.readBytes, bytes);
+  EXPECT_EQ(stat.appliedBytes, bytes);
+}
+
+// A record whose checksum does not match is skipped, the reader goes on from the next one
+TEST_F(WalRestoreTest, corruptedRecordSkipped) {
+  const int32_t len = 1000;
+  const int64_t contLen = sizeof(SWalHead) + len;
+
+  EXPECT_TRUE(open().empty());
+  for (uint64_t v = 1; v <= 20; ++v) ASSERT_EQ(write(v, len), 0);
+  ASSERT_EQ(walFsync(pWal, true, NULL), 0);
+  walClose(pWal);
+  pWal = NULL;
+
+  // the wal keeps the records in its only file
+  std::string name = path + "/wal0";
+  FILE*       fp = fopen(name.c_str(), "r+");
+  ASSERT_NE(fp, nullptr);
+  ASSERT_EQ(fseek(fp, 9 * contLen + sizeof(SWalHead) + len / 2, SEEK_SET), 0);
+  ASSERT_EQ(fputc(0x7f, fp), 0x7f);
+  fclose(fp);
+
+  std::vector<uint64_t> expected;
+  for (uint64_t v = 1; v <= 20; ++v) {
+    if (v != 10) expected.push_back(v);
+  }
+  EXPECT_EQ(open(), expected);
+}